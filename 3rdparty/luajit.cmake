@@ -0,0 +1,27 @@
+include(ExternalProject)
+
+set(LUAJIT_SRC_PATH "${CMAKE_BINARY_DIR}/_deps/src/luajit")
+set(LUAJIT_BUILD_PATH "${LUAJIT_SRC_PATH}/src")
+set(LUAJIT_INCLUDE_PATH "${LUAJIT_SRC_PATH}/src")
+
+# Notes:
+# - the makefile of LuaJIT doesn't support out of tree builds, the library is built in place
+# - only the static library is built, the default optimization flags of LuaJIT are preserved as they are set via CCOPT
+ExternalProject_Add(
+        luajit
+        GIT_REPOSITORY    https://github.com/LuaJIT/LuaJIT.git
+        GIT_TAG           v2.1.0-beta3 # v2.1 @ 2017-05-01
+        PREFIX ${CMAKE_BINARY_DIR}/_deps
+        CONFIGURE_COMMAND ""
+        BUILD_COMMAND
+        make -C ${LUAJIT_BUILD_PATH} libluajit.a BUILDMODE=static CFLAGS="-fPIC"
+        INSTALL_COMMAND "")
+
+set(LUAJIT_LIBRARY_DIRS "${LUAJIT_BUILD_PATH}")
+set(LUAJIT_INCLUDE_DIRS "${LUAJIT_INCLUDE_PATH}")
+set(LUAJIT_LIBRARIES_STATIC "libluajit.a")
+
+list(APPEND DEPS_LIST_LIBRARIES "dl" "m")
+list(APPEND DEPS_LIST_LIBRARIES_PRIVATE "${LUAJIT_LIBRARIES_STATIC}")
+list(APPEND DEPS_LIST_INCLUDE_DIRS "${LUAJIT_INCLUDE_DIRS}")
+list(APPEND DEPS_LIST_LIBRARY_DIRS "${LUAJIT_LIBRARY_DIRS}")
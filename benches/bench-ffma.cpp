@@ -36,6 +36,9 @@
 #define TEST_WARMPUP_HUGEPAGES_CACHE_COUNT 33856
 #define TEST_ALLOCATIONS_COUNT_PER_THREAD (16 * 1024)
 
+// No results are recorded for the per-slice free list that replaced the per-object slot metadata, it hasn't been
+// benchmarked yet on a machine with enough hugepages so the impact of the change is still inconclusive.
+
 // It is possible to control the amount of threads used for the test tuning the two defines below
 #define TEST_THREADS_RANGE_BEGIN (1)
 #define TEST_THREADS_RANGE_END (utils_cpu_count())
@@ -178,6 +181,55 @@ static void memory_allocation_ffma_fragment_memory(benchmark::State& state) {
     }
 }
 
+static void memory_allocation_ffma_memory_overhead(benchmark::State& state) {
+    size_t object_size_min = state.range(0);
+    size_t object_size_max = state.range(1);
+    uint32_t objects_count = state.range(2);
+    uint64_t requested_bytes = 0, allocated_bytes = 0, slices_inuse_count = 0;
+
+    thread_current_set_affinity(state.thread_index());
+
+    // The sizes are random but the seed is fixed to allow the results to be compared between different runs
+    std::mt19937 g(objects_count);
+    std::uniform_int_distribution<size_t> object_size_distribution(object_size_min, object_size_max);
+    std::vector<size_t> object_sizes = std::vector<size_t>(objects_count);
+    std::vector<void*> memptrs = std::vector<void*>(objects_count);
+
+    for(long int i = 0; i < objects_count; i++) {
+        object_sizes[i] = object_size_distribution(g);
+        requested_bytes += object_sizes[i];
+        allocated_bytes += ffma_predefined_object_sizes[ffma_index_by_object_size(object_sizes[i])];
+    }
+
+    for (auto _ : state) {
+        for(long int i = 0; i < objects_count; i++) {
+            benchmark::DoNotOptimize((memptrs[i] = ffma_mem_alloc(object_sizes[i])));
+        }
+
+        // The memory actually used is measured using the slices in use, it includes the wasted space of the objects
+        // and the metadata of the slices
+        state.PauseTiming();
+        ffma_t **ffmas = ffma_thread_cache_get();
+        slices_inuse_count = 0;
+        for(int i = 0; i < FFMA_PREDEFINED_OBJECT_SIZES_COUNT; i++) {
+            slices_inuse_count += ffmas[i]->metrics.slices_inuse_count;
+        }
+        state.ResumeTiming();
+
+        for(long int i = 0; i < objects_count; i++) {
+            ffma_mem_free(memptrs[i]);
+        }
+    }
+
+    state.counters["requested_bytes"] = (double)requested_bytes;
+    state.counters["allocated_bytes"] = (double)allocated_bytes;
+    state.counters["allocated_overhead_pct"] =
+            ((double)(allocated_bytes - requested_bytes) / (double)requested_bytes) * 100.0;
+    state.counters["hugepages_bytes"] = (double)(slices_inuse_count * HUGEPAGE_SIZE_2MB);
+    state.counters["hugepages_overhead_pct"] =
+            ((double)((slices_inuse_count * HUGEPAGE_SIZE_2MB) - requested_bytes) / (double)requested_bytes) * 100.0;
+}
+
 static void memory_allocation_os_malloc_only_alloc(benchmark::State& state) {
     size_t object_size = state.range(0);
     uint32_t objects_count = state.range(1);
@@ -297,9 +349,11 @@ static void memory_allocation_os_malloc_fragment_memory(benchmark::State& state)
 static void BenchArguments(benchmark::internal::Benchmark* b) {
     b
             ->ArgsProduct({
-                { FFMA_OBJECT_SIZE_16, FFMA_OBJECT_SIZE_32, FFMA_OBJECT_SIZE_64, FFMA_OBJECT_SIZE_128, FFMA_OBJECT_SIZE_256,
-                  FFMA_OBJECT_SIZE_512, FFMA_OBJECT_SIZE_1024, FFMA_OBJECT_SIZE_2048, FFMA_OBJECT_SIZE_4096,
-                  FFMA_OBJECT_SIZE_8192, FFMA_OBJECT_SIZE_16384, FFMA_OBJECT_SIZE_32768, FFMA_OBJECT_SIZE_65536 },
+                { FFMA_OBJECT_SIZE_16, FFMA_OBJECT_SIZE_32, FFMA_OBJECT_SIZE_48, FFMA_OBJECT_SIZE_64,
+                  FFMA_OBJECT_SIZE_80, FFMA_OBJECT_SIZE_96, FFMA_OBJECT_SIZE_112, FFMA_OBJECT_SIZE_128,
+                  FFMA_OBJECT_SIZE_160, FFMA_OBJECT_SIZE_256, FFMA_OBJECT_SIZE_384, FFMA_OBJECT_SIZE_512,
+                  FFMA_OBJECT_SIZE_1024, FFMA_OBJECT_SIZE_2048, FFMA_OBJECT_SIZE_4096, FFMA_OBJECT_SIZE_8192,
+                  FFMA_OBJECT_SIZE_16384, FFMA_OBJECT_SIZE_24576, FFMA_OBJECT_SIZE_32768, FFMA_OBJECT_SIZE_65536 },
                 { TEST_ALLOCATIONS_COUNT_PER_THREAD }
             })
             ->ThreadRange(TEST_THREADS_RANGE_BEGIN, TEST_THREADS_RANGE_END)
@@ -308,6 +362,19 @@ static void BenchArguments(benchmark::internal::Benchmark* b) {
             ->DisplayAggregatesOnly(false);
 }
 
+static void BenchArgumentsMemoryOverhead(benchmark::internal::Benchmark* b) {
+    // Ranges of object sizes, the allocated sizes are uniformly distributed within the range
+    b
+            ->Args({ 16, 64, TEST_ALLOCATIONS_COUNT_PER_THREAD })
+            ->Args({ 16, 256, TEST_ALLOCATIONS_COUNT_PER_THREAD })
+            ->Args({ 65, 128, TEST_ALLOCATIONS_COUNT_PER_THREAD })
+            ->Args({ 256, 4096, TEST_ALLOCATIONS_COUNT_PER_THREAD })
+            ->Args({ 4096, 65536, TEST_ALLOCATIONS_COUNT_PER_THREAD / 4 })
+            ->Iterations(1)
+            ->Repetitions(5)
+            ->DisplayAggregatesOnly(false);
+}
+
 // Warmup the hugepages cache, has to be done only once, forces iterations and repetitions to 1 to do not waste time
 BENCHMARK(memory_allocation_ffma_hugepages_warmup_cache)
         ->Iterations(1)
@@ -319,6 +386,8 @@ BENCHMARK(memory_allocation_ffma_alloc_and_free)
         ->Apply(BenchArguments);
 BENCHMARK(memory_allocation_ffma_fragment_memory)
         ->Apply(BenchArguments);
+BENCHMARK(memory_allocation_ffma_memory_overhead)
+        ->Apply(BenchArgumentsMemoryOverhead);
 
 BENCHMARK(memory_allocation_os_malloc_only_alloc)
         ->Apply(BenchArguments);
@@ -118,6 +118,13 @@ public:
                 return;
             }
 
+            if (state.range(2) == 1 && !BenchmarkSupport::CheckIfNumaModeAvailable()) {
+                sprintf(error_message, "The NUMA mode requires at least 2 numa nodes");
+                ((::benchmark::State &) state).SkipWithError(error_message);
+
+                return;
+            }
+
             // Initialize the key set
             static_keyset_slots = test_support_init_keyset_slots(
                     this->_requested_keyset_size,
@@ -125,7 +132,7 @@ public:
                     544498304);
 
             // Setup the hashtable
-            static_hashtable = test_support_init_hashtable(state.range(0));
+            static_hashtable = BenchmarkSupport::InitHashtable(state.range(0), state.range(2) == 1);
 
             if (!static_hashtable) {
                 sprintf(
@@ -329,6 +336,13 @@ public:
                 return;
             }
 
+            if (state.range(2) == 1 && !BenchmarkSupport::CheckIfNumaModeAvailable()) {
+                sprintf(error_message, "The NUMA mode requires at least 2 numa nodes");
+                ((::benchmark::State &) state).SkipWithError(error_message);
+
+                return;
+            }
+
             // Initialize the key set
             static_keyset_slots = test_support_init_keyset_slots(
                     this->_requested_keyset_size,
@@ -336,7 +350,7 @@ public:
                     544498304);
 
             // Setup the hashtable
-            static_hashtable = test_support_init_hashtable(state.range(0));
+            static_hashtable = BenchmarkSupport::InitHashtable(state.range(0), state.range(2) == 1);
 
             if (!static_hashtable) {
                 sprintf(
@@ -536,6 +550,8 @@ static void BenchArguments(benchmark::internal::Benchmark* b) {
             ->ArgsProduct({
                                   { 0x0000FFFFu, 0x000FFFFFu, 0x001FFFFFu, 0x007FFFFFu },
                                   { 50, 75 },
+                                  // NUMA mode, the hashtable is interleaved across the numa nodes
+                                  { 0, 1 },
                           })
             ->ThreadRange(TEST_THREADS_RANGE_BEGIN, TEST_THREADS_RANGE_END)
             ->Iterations(1)
@@ -0,0 +1,364 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#include <arpa/inet.h>
+
+#include <benchmark/benchmark.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_sorted_set.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+
+#include "benchmark-program.hpp"
+
+// Compares the range queries by score of the sorted sets, stored as a B+tree mapped on the chunks of the storage db,
+// with the skiplist used by Redis, both are populated with the same members and scores.
+#define TEST_SORTED_SET_MEMBERS_COUNT (1024 * 1024)
+#define TEST_SORTED_SET_RANDOM_SEED 544498304
+
+#define TEST_SKIPLIST_MAX_LEVEL 32
+#define TEST_SKIPLIST_P 0.25
+
+typedef struct bench_skiplist_node bench_skiplist_node_t;
+struct bench_skiplist_node {
+    char *member;
+    size_t member_length;
+    double score;
+    bench_skiplist_node_t *backward;
+    struct {
+        bench_skiplist_node_t *forward;
+        uint64_t span;
+    } level[];
+};
+
+typedef struct bench_skiplist bench_skiplist_t;
+struct bench_skiplist {
+    bench_skiplist_node_t *header;
+    uint64_t length;
+    int level;
+};
+
+static bench_skiplist_node_t *bench_skiplist_node_new(
+        int level,
+        double score,
+        char *member,
+        size_t member_length) {
+    auto node = (bench_skiplist_node_t*)malloc(
+            sizeof(bench_skiplist_node_t) + (level * sizeof(bench_skiplist_node_t::level[0])));
+    node->score = score;
+    node->member = member;
+    node->member_length = member_length;
+
+    return node;
+}
+
+static bench_skiplist_t *bench_skiplist_new() {
+    auto skiplist = (bench_skiplist_t*)malloc(sizeof(bench_skiplist_t));
+    skiplist->level = 1;
+    skiplist->length = 0;
+    skiplist->header = bench_skiplist_node_new(TEST_SKIPLIST_MAX_LEVEL, 0, nullptr, 0);
+
+    for(int level = 0; level < TEST_SKIPLIST_MAX_LEVEL; level++) {
+        skiplist->header->level[level].forward = nullptr;
+        skiplist->header->level[level].span = 0;
+    }
+    skiplist->header->backward = nullptr;
+
+    return skiplist;
+}
+
+static void bench_skiplist_free(
+        bench_skiplist_t *skiplist) {
+    bench_skiplist_node_t *node = skiplist->header->level[0].forward;
+
+    free(skiplist->header);
+    while(node) {
+        bench_skiplist_node_t *next = node->level[0].forward;
+        free(node->member);
+        free(node);
+        node = next;
+    }
+
+    free(skiplist);
+}
+
+static int bench_skiplist_compare(
+        bench_skiplist_node_t *node,
+        double score,
+        char *member,
+        size_t member_length) {
+    if (node->score != score) {
+        return node->score < score ? -1 : 1;
+    }
+
+    int result = memcmp(node->member, member, MIN(node->member_length, member_length));
+    if (result != 0) {
+        return result;
+    }
+
+    return node->member_length < member_length ? -1 : (node->member_length > member_length ? 1 : 0);
+}
+
+static void bench_skiplist_insert(
+        bench_skiplist_t *skiplist,
+        std::mt19937_64 &random_generator,
+        double score,
+        char *member,
+        size_t member_length) {
+    bench_skiplist_node_t *update[TEST_SKIPLIST_MAX_LEVEL], *node;
+    uint64_t rank[TEST_SKIPLIST_MAX_LEVEL];
+    int level;
+
+    node = skiplist->header;
+    for(int i = skiplist->level - 1; i >= 0; i--) {
+        rank[i] = i == (skiplist->level - 1) ? 0 : rank[i + 1];
+        while (node->level[i].forward &&
+                bench_skiplist_compare(node->level[i].forward, score, member, member_length) < 0) {
+            rank[i] += node->level[i].span;
+            node = node->level[i].forward;
+        }
+        update[i] = node;
+    }
+
+    level = 1;
+    while((random_generator() & 0xFFFF) < (TEST_SKIPLIST_P * 0xFFFF) && level < TEST_SKIPLIST_MAX_LEVEL) {
+        level++;
+    }
+
+    if (level > skiplist->level) {
+        for (int i = skiplist->level; i < level; i++) {
+            rank[i] = 0;
+            update[i] = skiplist->header;
+            update[i]->level[i].span = skiplist->length;
+        }
+        skiplist->level = level;
+    }
+
+    node = bench_skiplist_node_new(level, score, member, member_length);
+    for(int i = 0; i < level; i++) {
+        node->level[i].forward = update[i]->level[i].forward;
+        update[i]->level[i].forward = node;
+
+        node->level[i].span = update[i]->level[i].span - (rank[0] - rank[i]);
+        update[i]->level[i].span = (rank[0] - rank[i]) + 1;
+    }
+
+    for (int i = level; i < skiplist->level; i++) {
+        update[i]->level[i].span++;
+    }
+
+    node->backward = (update[0] == skiplist->header) ? nullptr : update[0];
+    if (node->level[0].forward) {
+        node->level[0].forward->backward = node;
+    }
+
+    skiplist->length++;
+}
+
+static bench_skiplist_node_t *bench_skiplist_first_in_range(
+        bench_skiplist_t *skiplist,
+        double score_min) {
+    bench_skiplist_node_t *node = skiplist->header;
+
+    for(int i = skiplist->level - 1; i >= 0; i--) {
+        while (node->level[i].forward && node->level[i].forward->score < score_min) {
+            node = node->level[i].forward;
+        }
+    }
+
+    return node->level[0].forward;
+}
+
+// Built only once and shared by all the benchmarks as populating 1M members takes a while
+static storage_db_t *static_db = nullptr;
+static storage_db_entry_index_t static_entry_index = { 0 };
+static bench_skiplist_t *static_skiplist = nullptr;
+
+static void bench_module_redis_sorted_set_worker_context_setup(
+        storage_db_t *db) {
+    worker_context_t *worker_context;
+    if ((worker_context = worker_context_get()) == nullptr) {
+        // This assigned memory will be lost but this is a benchmark and we don't care
+        worker_context = (worker_context_t *)ffma_mem_alloc(sizeof(worker_context_t));
+        worker_context_set(worker_context);
+    }
+
+    worker_context->worker_index = 0;
+    worker_context->workers_count = 1;
+    worker_context->db = db;
+}
+
+static bool bench_module_redis_sorted_set_populate() {
+    module_redis_command_helper_sorted_set_t sorted_set;
+    std::mt19937_64 random_generator(TEST_SORTED_SET_RANDOM_SEED);
+
+    if (static_db) {
+        return true;
+    }
+
+    storage_db_config_t *db_config = storage_db_config_new();
+    db_config->max_keys = 1024;
+    db_config->backend_type = STORAGE_DB_BACKEND_TYPE_MEMORY;
+    static_db = storage_db_new(db_config, 1);
+    if (!static_db) {
+        storage_db_config_free(db_config);
+        return false;
+    }
+
+    bench_module_redis_sorted_set_worker_context_setup(static_db);
+
+    static_skiplist = bench_skiplist_new();
+    module_redis_command_helper_sorted_set_init(&sorted_set);
+
+    for(uint64_t member_index = 0; member_index < TEST_SORTED_SET_MEMBERS_COUNT; member_index++) {
+        bool inserted;
+        char *member = (char*)malloc(32);
+        size_t member_length = snprintf(member, 32, "member_%08lu", member_index);
+        double score = (double)(random_generator() % TEST_SORTED_SET_MEMBERS_COUNT);
+
+        if (!module_redis_command_helper_sorted_set_update(
+                static_db,
+                &sorted_set,
+                member,
+                member_length,
+                score,
+                &inserted)) {
+            module_redis_command_helper_sorted_set_cleanup(&sorted_set);
+            return false;
+        }
+
+        bench_skiplist_insert(static_skiplist, random_generator, score, member, member_length);
+    }
+
+    static_entry_index.value = module_redis_command_helper_sorted_set_serialize(static_db, &sorted_set);
+    module_redis_command_helper_sorted_set_cleanup(&sorted_set);
+
+    return static_entry_index.value != nullptr;
+}
+
+static void module_redis_sorted_set_range_by_score(benchmark::State& state) {
+    module_redis_command_helper_sorted_set_t sorted_set;
+    module_redis_command_helper_sorted_set_iter_t iter;
+    std::mt19937_64 random_generator(TEST_SORTED_SET_RANDOM_SEED);
+    uint64_t range_length = state.range(0);
+
+    if (!bench_module_redis_sorted_set_populate()) {
+        state.SkipWithError("Unable to populate the sorted set");
+        return;
+    }
+
+    bench_module_redis_sorted_set_worker_context_setup(static_db);
+
+    for (auto _ : state) {
+        uint64_t rank;
+        double score_min = (double)(random_generator() % TEST_SORTED_SET_MEMBERS_COUNT);
+
+        // As ZRANGEBYSCORE, the sorted set is loaded, the position of the minimum score is searched and the range is
+        // iterated
+        if (!module_redis_command_helper_sorted_set_load(static_db, &static_entry_index, &sorted_set)) {
+            state.SkipWithError("Unable to load the sorted set");
+            break;
+        }
+
+        if (!module_redis_command_helper_sorted_set_count_below(
+                static_db,
+                &sorted_set,
+                score_min,
+                false,
+                &rank) ||
+            !module_redis_command_helper_sorted_set_iter_init(static_db, &sorted_set, rank, &iter)) {
+            module_redis_command_helper_sorted_set_cleanup(&sorted_set);
+            state.SkipWithError("Unable to search the sorted set");
+            break;
+        }
+
+        for(uint64_t index = 0; index < range_length && rank + index < sorted_set.count; index++) {
+            double score;
+            char *member;
+            size_t member_length;
+
+            if (!module_redis_command_helper_sorted_set_iter_next(
+                    static_db,
+                    &iter,
+                    &score,
+                    &member,
+                    &member_length)) {
+                break;
+            }
+
+            benchmark::DoNotOptimize(member);
+            benchmark::DoNotOptimize(score);
+        }
+
+        module_redis_command_helper_sorted_set_iter_cleanup(&iter);
+        module_redis_command_helper_sorted_set_cleanup(&sorted_set);
+    }
+
+    state.SetItemsProcessed((int64_t)state.iterations() * range_length);
+}
+
+static void skiplist_range_by_score(benchmark::State& state) {
+    std::mt19937_64 random_generator(TEST_SORTED_SET_RANDOM_SEED);
+    uint64_t range_length = state.range(0);
+
+    if (!bench_module_redis_sorted_set_populate()) {
+        state.SkipWithError("Unable to populate the skiplist");
+        return;
+    }
+
+    for (auto _ : state) {
+        double score_min = (double)(random_generator() % TEST_SORTED_SET_MEMBERS_COUNT);
+        bench_skiplist_node_t *node = bench_skiplist_first_in_range(static_skiplist, score_min);
+
+        for(uint64_t index = 0; index < range_length && node; index++) {
+            benchmark::DoNotOptimize(node->member);
+            benchmark::DoNotOptimize(node->score);
+            node = node->level[0].forward;
+        }
+    }
+
+    state.SetItemsProcessed((int64_t)state.iterations() * range_length);
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->Arg(10)->Arg(100)->Arg(1000);
+}
+
+BENCHMARK(module_redis_sorted_set_range_by_score)
+    ->Apply(BenchArguments);
+BENCHMARK(skiplist_range_by_score)
+    ->Apply(BenchArguments);
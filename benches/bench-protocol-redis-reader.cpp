@@ -0,0 +1,195 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstring>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program.hpp"
+
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+
+class PipelinedCommandsFixture : public benchmark::Fixture {
+private:
+    char *buffer = nullptr;
+    size_t length = 0;
+    int commands_count = 0;
+
+public:
+    char* GetBuffer() {
+        return this->buffer;
+    }
+
+    size_t GetLength() {
+        return this->length;
+    }
+
+    int GetCommandsCount() {
+        return this->commands_count;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        char command[] = "*2\r\n$3\r\nGET\r\n$16\r\nkey_000000000000\r\n";
+        size_t command_length = strlen(command);
+
+        this->commands_count = (int)state.range(0);
+        this->length = command_length * this->commands_count;
+        this->buffer = (char*)malloc(this->length);
+
+        for(int index = 0; index < this->commands_count; index++) {
+            memcpy(this->buffer + (command_length * index), command, command_length);
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        free(this->buffer);
+        this->length = 0;
+        this->commands_count = 0;
+    }
+};
+
+// The current reader parses at most one argument per invocation, the context is reset after every command as done by
+// the redis module before the batch reader was introduced
+BENCHMARK_DEFINE_F(PipelinedCommandsFixture, ProtocolRedisReaderRead)(benchmark::State& state) {
+    protocol_redis_reader_context_t context = { };
+    protocol_redis_reader_op_t ops[8] = { };
+    uint8_t ops_size = sizeof(ops) / sizeof(protocol_redis_reader_op_t);
+
+    for (auto _ : state) {
+        size_t offset = 0;
+
+        protocol_redis_reader_context_reset(&context);
+        while(offset < this->GetLength()) {
+            int32_t ops_found = protocol_redis_reader_read(
+                    this->GetBuffer() + offset,
+                    this->GetLength() - offset,
+                    &context,
+                    ops,
+                    ops_size);
+
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                offset += ops[op_index].data_read_len;
+            }
+
+            if (context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED) {
+                protocol_redis_reader_context_reset(&context);
+            }
+        }
+
+        benchmark::DoNotOptimize(offset);
+    }
+
+    state.SetItemsProcessed(state.iterations() * this->GetCommandsCount());
+}
+
+BENCHMARK_DEFINE_F(PipelinedCommandsFixture, ProtocolRedisReaderReadBatch)(benchmark::State& state) {
+    protocol_redis_reader_context_t context = { };
+    protocol_redis_reader_op_t ops[64] = { };
+    uint8_t ops_size = sizeof(ops) / sizeof(protocol_redis_reader_op_t);
+
+    for (auto _ : state) {
+        size_t offset = 0;
+
+        protocol_redis_reader_context_reset(&context);
+        while(offset < this->GetLength()) {
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    this->GetBuffer() + offset,
+                    this->GetLength() - offset,
+                    &context,
+                    ops,
+                    ops_size);
+
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                offset += ops[op_index].data_read_len;
+            }
+        }
+
+        benchmark::DoNotOptimize(offset);
+    }
+
+    state.SetItemsProcessed(state.iterations() * this->GetCommandsCount());
+}
+
+BENCHMARK_DEFINE_F(PipelinedCommandsFixture, ProtocolRedisReaderIndexNewlinesSw)(benchmark::State& state) {
+    uint32_t newlines[PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE];
+    size_t scanned_length;
+
+    for (auto _ : state) {
+        size_t offset = 0;
+
+        while(offset < this->GetLength()) {
+            benchmark::DoNotOptimize(PROTOCOL_REDIS_READER_NAME_IMPL(index_newlines, sw)(
+                    this->GetBuffer() + offset,
+                    this->GetLength() - offset,
+                    newlines,
+                    PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE,
+                    &scanned_length));
+            offset += scanned_length;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * this->GetLength());
+}
+
+BENCHMARK_DEFINE_F(PipelinedCommandsFixture, ProtocolRedisReaderIndexNewlinesAvx2)(benchmark::State& state) {
+    uint32_t newlines[PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE];
+    size_t scanned_length;
+
+    for (auto _ : state) {
+        size_t offset = 0;
+
+        while(offset < this->GetLength()) {
+            benchmark::DoNotOptimize(PROTOCOL_REDIS_READER_NAME_IMPL(index_newlines, avx2)(
+                    this->GetBuffer() + offset,
+                    this->GetLength() - offset,
+                    newlines,
+                    PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE,
+                    &scanned_length));
+            offset += scanned_length;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * this->GetLength());
+}
+
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+BENCHMARK_DEFINE_F(PipelinedCommandsFixture, ProtocolRedisReaderIndexNewlinesAvx512bw)(benchmark::State& state) {
+    uint32_t newlines[PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE];
+    size_t scanned_length;
+
+    for (auto _ : state) {
+        size_t offset = 0;
+
+        while(offset < this->GetLength()) {
+            benchmark::DoNotOptimize(PROTOCOL_REDIS_READER_NAME_IMPL(index_newlines, avx512bw)(
+                    this->GetBuffer() + offset,
+                    this->GetLength() - offset,
+                    newlines,
+                    PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE,
+                    &scanned_length));
+            offset += scanned_length;
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * this->GetLength());
+}
+#endif
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->Arg(1)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+}
+
+BENCHMARK_REGISTER_F(PipelinedCommandsFixture, ProtocolRedisReaderRead)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(PipelinedCommandsFixture, ProtocolRedisReaderReadBatch)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(PipelinedCommandsFixture, ProtocolRedisReaderIndexNewlinesSw)->Apply(BenchArguments);
+BENCHMARK_REGISTER_F(PipelinedCommandsFixture, ProtocolRedisReaderIndexNewlinesAvx2)->Apply(BenchArguments);
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+BENCHMARK_REGISTER_F(PipelinedCommandsFixture, ProtocolRedisReaderIndexNewlinesAvx512bw)->Apply(BenchArguments);
+#endif
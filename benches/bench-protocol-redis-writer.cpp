@@ -0,0 +1,155 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdio>
+#include <cstring>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark-program.hpp"
+
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_writer.h"
+
+// The amount of replies written per iteration, the send buffer is reused as it would happen with pipelined commands
+#define BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION 64
+
+class ProtocolRedisWriterFixture : public benchmark::Fixture {
+private:
+    char *buffer = nullptr;
+    size_t buffer_length = 0;
+    char *value = nullptr;
+    size_t value_length = 0;
+
+public:
+    char* GetBuffer() {
+        return this->buffer;
+    }
+
+    [[nodiscard]] size_t GetBufferLength() const {
+        return this->buffer_length;
+    }
+
+    char* GetValue() {
+        return this->value;
+    }
+
+    [[nodiscard]] size_t GetValueLength() const {
+        return this->value_length;
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        this->value_length = state.range(0);
+        this->value = (char*)malloc(this->value_length);
+        memset(this->value, 'a', this->value_length);
+
+        this->buffer_length = (this->value_length + 32) * BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION;
+        this->buffer = (char*)malloc(this->buffer_length);
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        free(this->buffer);
+        free(this->value);
+        this->buffer = nullptr;
+        this->value = nullptr;
+        this->buffer_length = 0;
+        this->value_length = 0;
+    }
+};
+
+// Baseline, the header of the blob string is formatted with snprintf
+BENCHMARK_DEFINE_F(ProtocolRedisWriterFixture, BlobStringSnprintf)(benchmark::State& state) {
+    for (auto _ : state) {
+        char *buffer = this->GetBuffer();
+        char *buffer_end = buffer + this->GetBufferLength();
+
+        for(int index = 0; index < BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION; index++) {
+            buffer += snprintf(buffer, buffer_end - buffer, "$%lu\r\n", this->GetValueLength());
+            memcpy(buffer, this->GetValue(), this->GetValueLength());
+            buffer += this->GetValueLength();
+            *buffer++ = '\r';
+            *buffer++ = '\n';
+        }
+
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION);
+}
+
+BENCHMARK_DEFINE_F(ProtocolRedisWriterFixture, BlobString)(benchmark::State& state) {
+    for (auto _ : state) {
+        char *buffer = this->GetBuffer();
+        char *buffer_end = buffer + this->GetBufferLength();
+
+        for(int index = 0; index < BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION; index++) {
+            buffer = protocol_redis_writer_write_blob_string(
+                    buffer,
+                    buffer_end - buffer,
+                    this->GetValue(),
+                    (int)this->GetValueLength());
+        }
+
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION);
+}
+
+BENCHMARK_DEFINE_F(ProtocolRedisWriterFixture, Number)(benchmark::State& state) {
+    for (auto _ : state) {
+        char *buffer = this->GetBuffer();
+        char *buffer_end = buffer + this->GetBufferLength();
+
+        for(int index = 0; index < BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION; index++) {
+            buffer = protocol_redis_writer_write_number(
+                    buffer,
+                    buffer_end - buffer,
+                    (long)this->GetValueLength());
+        }
+
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION);
+}
+
+BENCHMARK_DEFINE_F(ProtocolRedisWriterFixture, Ok)(benchmark::State& state) {
+    for (auto _ : state) {
+        char *buffer = this->GetBuffer();
+        char *buffer_end = buffer + this->GetBufferLength();
+
+        for(int index = 0; index < BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION; index++) {
+            buffer = protocol_redis_writer_write_ok(
+                    buffer,
+                    buffer_end - buffer);
+        }
+
+        benchmark::DoNotOptimize(buffer);
+    }
+
+    state.SetItemsProcessed(state.iterations() * BENCH_PROTOCOL_REDIS_WRITER_REPLIES_PER_ITERATION);
+}
+
+// The values up to 1023 bytes use the precomputed headers, 4096 takes the generic path
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->Arg(8)->Arg(64)->Arg(512)->Arg(4096);
+}
+
+BENCHMARK_REGISTER_F(ProtocolRedisWriterFixture, BlobStringSnprintf)
+        ->Apply(BenchArguments);
+
+BENCHMARK_REGISTER_F(ProtocolRedisWriterFixture, BlobString)
+        ->Apply(BenchArguments);
+
+BENCHMARK_REGISTER_F(ProtocolRedisWriterFixture, Number)
+        ->Apply(BenchArguments);
+
+BENCHMARK_REGISTER_F(ProtocolRedisWriterFixture, Ok)
+        ->Arg(0);
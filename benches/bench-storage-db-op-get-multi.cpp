@@ -0,0 +1,240 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <cstdint>
+#include <cstring>
+#include <numa.h>
+
+#include <benchmark/benchmark.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "log/log.h"
+#include "clock.h"
+#include "memory_fences.h"
+#include "config.h"
+#include "xalloc.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "memory_allocator/ffma.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+
+#include "benchmark-program.hpp"
+
+// The keyset is larger than the caches to be able to measure the effect of the prefetching, the requested keys are
+// spread across the whole keyset as it would happen with the MGET commands sent by different clients
+#define BENCH_STORAGE_DB_OP_GET_MULTI_MAX_KEYS          (0x003FFFFFu)
+#define BENCH_STORAGE_DB_OP_GET_MULTI_KEYSET_SIZE       (BENCH_STORAGE_DB_OP_GET_MULTI_MAX_KEYS / 2)
+#define BENCH_STORAGE_DB_OP_GET_MULTI_KEY_STRIDE        (7919)
+#define BENCH_STORAGE_DB_OP_GET_MULTI_VALUE             "b_value"
+
+class StorageDbOpGetMultiFixture : public benchmark::Fixture {
+private:
+    storage_db_t *_db = nullptr;
+    storage_db_key_and_key_length_t *_keys = nullptr;
+    uint64_t _keys_count = 0;
+
+public:
+    storage_db_t *GetDb() {
+        return this->_db;
+    }
+
+    storage_db_key_and_key_length_t *GetKeys() {
+        return this->_keys;
+    }
+
+    [[nodiscard]] uint64_t GetKeysCount() const {
+        return this->_keys_count;
+    }
+
+    bool SetValue(
+            char *key,
+            size_t key_length) {
+        size_t value_length = strlen(BENCH_STORAGE_DB_OP_GET_MULTI_VALUE);
+
+        storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_allocate(this->_db, value_length);
+        if (!chunk_sequence) {
+            return false;
+        }
+
+        if (!storage_db_chunk_write(
+                this->_db,
+                storage_db_chunk_sequence_get(chunk_sequence, 0),
+                0,
+                BENCH_STORAGE_DB_OP_GET_MULTI_VALUE,
+                value_length)) {
+            return false;
+        }
+
+        // The hashtable takes ownership of the key so a copy is passed
+        char *key_copy = (char*)xalloc_alloc(key_length + 1);
+        strncpy(key_copy, key, key_length + 1);
+
+        return storage_db_op_set(
+                this->_db,
+                key_copy,
+                key_length,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+                chunk_sequence,
+                STORAGE_DB_ENTRY_NO_EXPIRY);
+    }
+
+    void SetUp(const ::benchmark::State& state) override {
+        worker_context_t *worker_context;
+
+        // Set up the worker context, as it's required by the storage db
+        if ((worker_context = worker_context_get()) == nullptr) {
+            // This assigned memory will be lost but this is a benchmark and we don't care
+            worker_context = (worker_context_t *)ffma_mem_alloc_zero(sizeof(worker_context_t));
+            worker_context_set(worker_context);
+        }
+
+        storage_db_config_t *db_config = storage_db_config_new();
+        db_config->max_keys = BENCH_STORAGE_DB_OP_GET_MULTI_MAX_KEYS;
+        db_config->backend_type = STORAGE_DB_BACKEND_TYPE_MEMORY;
+        this->_db = storage_db_new(db_config, 1);
+
+        if (!this->_db) {
+            storage_db_config_free(db_config);
+            ((::benchmark::State &)state).SkipWithError("Failed to allocate the storage db, unable to continue");
+            return;
+        }
+
+        worker_context->worker_index = 0;
+        worker_context->workers_count = 1;
+        worker_context->db = this->_db;
+
+        this->_keys_count = BENCH_STORAGE_DB_OP_GET_MULTI_KEYSET_SIZE;
+        this->_keys = (storage_db_key_and_key_length_t*)xalloc_alloc(
+                sizeof(storage_db_key_and_key_length_t) * this->_keys_count);
+
+        for(uint64_t key_index = 0; key_index < this->_keys_count; key_index++) {
+            char key[32] = { 0 };
+            size_t key_length = snprintf(key, sizeof(key), "key_%010lu", key_index);
+
+            this->_keys[key_index].key = (char*)xalloc_alloc(key_length + 1);
+            this->_keys[key_index].key_size = key_length;
+            strncpy(this->_keys[key_index].key, key, key_length + 1);
+
+            if (!this->SetValue(key, key_length)) {
+                ((::benchmark::State &)state).SkipWithError("Failed to populate the storage db, unable to continue");
+                return;
+            }
+        }
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        if (this->_keys) {
+            for(uint64_t key_index = 0; key_index < this->_keys_count; key_index++) {
+                xalloc_free(this->_keys[key_index].key);
+            }
+
+            xalloc_free(this->_keys);
+        }
+
+        if (this->_db) {
+            storage_db_free(this->_db, 1);
+        }
+
+        this->_db = nullptr;
+        this->_keys = nullptr;
+        this->_keys_count = 0;
+    }
+};
+
+BENCHMARK_DEFINE_F(StorageDbOpGetMultiFixture, storage_db_get_entry_index_for_read_loop)(benchmark::State& state) {
+    storage_db_t *db = this->GetDb();
+    storage_db_key_and_key_length_t *keys = this->GetKeys();
+    uint64_t keys_count = this->GetKeysCount();
+    uint32_t mget_keys_count = state.range(0);
+    uint64_t key_index = 0;
+
+    for (auto _ : state) {
+        for(uint32_t index = 0; index < mget_keys_count; index++) {
+            key_index = (key_index + BENCH_STORAGE_DB_OP_GET_MULTI_KEY_STRIDE) % keys_count;
+
+            storage_db_entry_index_t *entry_index = storage_db_get_entry_index_for_read(
+                    db,
+                    keys[key_index].key,
+                    keys[key_index].key_size);
+
+            if (unlikely(!entry_index)) {
+                state.SkipWithError("Key not found");
+                break;
+            }
+
+            benchmark::DoNotOptimize(entry_index);
+            storage_db_entry_index_status_decrease_readers_counter(entry_index, nullptr);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * mget_keys_count);
+}
+
+BENCHMARK_DEFINE_F(StorageDbOpGetMultiFixture, storage_db_op_get_multi)(benchmark::State& state) {
+    storage_db_t *db = this->GetDb();
+    storage_db_key_and_key_length_t *keys = this->GetKeys();
+    uint64_t keys_count = this->GetKeysCount();
+    uint32_t mget_keys_count = state.range(0);
+    uint64_t key_index = 0;
+
+    // The keys requested by the MGET are not contiguous in the keyset, as done by the redis module the list is built
+    // upfront and passed to the storage db
+    auto mget_keys = (storage_db_key_and_key_length_t*)xalloc_alloc(
+            sizeof(storage_db_key_and_key_length_t) * mget_keys_count);
+    auto entry_indexes = (storage_db_entry_index_t**)xalloc_alloc(
+            sizeof(storage_db_entry_index_t*) * mget_keys_count);
+
+    for (auto _ : state) {
+        for(uint32_t index = 0; index < mget_keys_count; index++) {
+            key_index = (key_index + BENCH_STORAGE_DB_OP_GET_MULTI_KEY_STRIDE) % keys_count;
+            mget_keys[index] = keys[key_index];
+        }
+
+        storage_db_op_get_multi(
+                db,
+                mget_keys,
+                mget_keys_count,
+                entry_indexes);
+
+        for(uint32_t index = 0; index < mget_keys_count; index++) {
+            if (unlikely(!entry_indexes[index])) {
+                state.SkipWithError("Key not found");
+                break;
+            }
+
+            benchmark::DoNotOptimize(entry_indexes[index]);
+            storage_db_entry_index_status_decrease_readers_counter(entry_indexes[index], nullptr);
+        }
+    }
+
+    xalloc_free(mget_keys);
+    xalloc_free(entry_indexes);
+
+    state.SetItemsProcessed(state.iterations() * mget_keys_count);
+}
+
+static void BenchArguments(benchmark::internal::Benchmark* b) {
+    b->Arg(16)->Arg(64)->Arg(256);
+}
+
+BENCHMARK_REGISTER_F(StorageDbOpGetMultiFixture, storage_db_get_entry_index_for_read_loop)
+        ->Apply(BenchArguments);
+
+BENCHMARK_REGISTER_F(StorageDbOpGetMultiFixture, storage_db_op_get_multi)
+        ->Apply(BenchArguments);
@@ -14,10 +14,13 @@
 #include "misc.h"
 #include "exttypes.h"
 #include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
 #include "log/log.h"
 #include "clock.h"
 #include "memory_fences.h"
 #include "config.h"
+#include "xalloc.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
 #include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
@@ -27,11 +30,11 @@
 #include "storage/channel/storage_channel.h"
 #include "storage/db/storage_db.h"
 #include "utils_cpu.h"
-#include "ffiber/iber.h"
+#include "fiber/fiber.h"
 #include "worker/worker_stats.h"
 #include "worker/worker_context.h"
 
-#include "../tests/support.h"
+#include "../tests/unit_tests/support.h"
 #include "benchmark-support.hpp"
 
 #include "benchmark-program.hpp"
@@ -79,6 +82,39 @@ public:
         return this->_requested_keyset_size;
     }
 
+    bool SetValue(
+            storage_db_t *db,
+            char *key,
+            size_t key_length) {
+        storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_allocate(
+                db,
+                this->_value_buffer_length);
+        if (!chunk_sequence) {
+            return false;
+        }
+
+        if (!storage_db_chunk_write(
+                db,
+                storage_db_chunk_sequence_get(chunk_sequence, 0),
+                0,
+                this->_value_buffer,
+                this->_value_buffer_length)) {
+            return false;
+        }
+
+        // The hashtable takes ownership of the key so a copy is passed
+        char *key_copy = (char*)xalloc_alloc(key_length + 1);
+        strncpy(key_copy, key, key_length + 1);
+
+        return storage_db_op_set(
+                db,
+                key_copy,
+                key_length,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+                chunk_sequence,
+                STORAGE_DB_ENTRY_NO_EXPIRY);
+    }
+
     void SetUp(const ::benchmark::State& state) override {
         char error_message[150] = {0};
 
@@ -174,12 +210,10 @@ public:
                 uint64_t key_index = state.thread_index();
                 key_index < this->_requested_keyset_size;
                 key_index += state.threads()) {
-            bool result = storage_db_set_small_value(
+            bool result = this->SetValue(
                     (storage_db*)static_db,
                     static_keyset_slots[key_index].key,
-                    static_keyset_slots[key_index].key_length,
-                    this->_value_buffer,
-                    this->_value_buffer_length);
+                    static_keyset_slots[key_index].key_length);
 
             if (!result) {
                 sprintf(
@@ -348,7 +382,7 @@ BENCHMARK_DEFINE_F(StorageDbOpGetFixture, storage_db_op_get_different_keys)(benc
             }
 
             // Only <= 64kb values so no need to iterate over the chunks
-            storage_db_chunk_info_t *chunk_info = storage_db_entry_value_chunk_get(entry_index, 0);
+            storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(entry_index->value, 0);
 
             char *buffer;
 
@@ -442,7 +476,7 @@ BENCHMARK_DEFINE_F(StorageDbOpGetFixture, storage_db_op_get_same_keys)(benchmark
             }
 
             // Only <= 64kb values so no need to iterate over the chunks
-            storage_db_chunk_info_t *chunk_info = storage_db_entry_value_chunk_get(entry_index, 0);
+            storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(entry_index->value, 0);
 
             char *buffer;
 
@@ -465,6 +499,82 @@ BENCHMARK_DEFINE_F(StorageDbOpGetFixture, storage_db_op_get_same_keys)(benchmark
     }
 }
 
+BENCHMARK_DEFINE_F(StorageDbOpGetFixture, storage_db_op_get_hot_key)(benchmark::State& state) {
+    uint64_t requested_keyset_size;
+    test_support_keyset_slot_t *keyset_slots;
+    worker_context_t *worker_context;
+    bool unpinned = state.range(2) == 1;
+    char error_message[150] = { 0 };
+
+    test_support_set_thread_affinity(state.thread_index());
+
+    // Set up the worker context, as it's required by the storage db, this has to be done here as the worker_context
+    // is stored in a thread variable an the threads are managed internally by the benchmarking library and therefore
+    // they can be recycled or re-created.
+    if ((worker_context = worker_context_get()) == nullptr) {
+        // This assigned memory will be lost but this is a benchmark and we don't care
+        worker_context = (worker_context_t *)ffma_mem_alloc(sizeof(worker_context_t));
+        worker_context_set(worker_context);
+    }
+
+    // Setup the worker as needed
+    worker_context->worker_index = state.thread_index();
+    worker_context->workers_count = this->GetWorkersCount();
+    worker_context->db = this->GetDb();
+
+    // Fetch the information from the fixtures needed for the test
+    keyset_slots = this->GetKeysetSlots();
+    requested_keyset_size = this->GetRequestedKeysetSize();
+
+    // All the threads read the same key over and over, with the readers counter the cache line of the entry index
+    // bounces between the cores at every read, with the unpinned reads, protected by the epoch of the worker, the entry
+    // index is only read.
+    // No key is deleted during the benchmark so the unpinned reads don't need an epoch gc to be set up.
+    for (auto _ : state) {
+        for(
+                uint64_t key_index = 0;
+                key_index < requested_keyset_size;
+                key_index++) {
+            storage_db_entry_index_t *entry_index;
+
+            if (unpinned) {
+                entry_index = storage_db_get_entry_index_for_read_unpinned(
+                        worker_context->db,
+                        keyset_slots[0].key,
+                        keyset_slots[0].key_length);
+            } else {
+                entry_index = storage_db_get_entry_index_for_read(
+                        worker_context->db,
+                        keyset_slots[0].key,
+                        keyset_slots[0].key_length);
+            }
+
+            if (unlikely(!entry_index)) {
+                sprintf(
+                        error_message,
+                        "Can't find the key <%s (%d)> for the thread <%d>",
+                        keyset_slots[0].key,
+                        keyset_slots[0].key_length,
+                        state.thread_index());
+                state.SkipWithError(error_message);
+                break;
+            }
+
+            storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(entry_index->value, 0);
+
+            char *buffer;
+            benchmark::DoNotOptimize((buffer = storage_db_entry_chunk_read_fast_from_memory(worker_context->db, chunk_info)));
+
+            if (!unpinned) {
+                storage_db_entry_index_status_decrease_readers_counter(entry_index, nullptr);
+            }
+        }
+    }
+
+    state.counters["unpinned"] = unpinned;
+    state.SetItemsProcessed(state.iterations() * requested_keyset_size);
+}
+
 static void BenchArguments(benchmark::internal::Benchmark* b) {
     b
             ->ArgsProduct({
@@ -484,3 +594,19 @@ BENCHMARK_REGISTER_F(StorageDbOpGetFixture, storage_db_op_get_different_keys)
 
 BENCHMARK_REGISTER_F(StorageDbOpGetFixture, storage_db_op_get_same_keys)
         ->Apply(BenchArguments);
+
+static void BenchArgumentsHotKey(benchmark::internal::Benchmark* b) {
+    b
+            ->ArgsProduct({
+                           { 0x0000FFFFu, 0x000FFFFFu },
+                           { 50 },
+                           { 0, 1 },
+                   })
+            ->ThreadRange(TEST_THREADS_RANGE_BEGIN, TEST_THREADS_RANGE_END)
+            ->Iterations(1)
+            ->Repetitions(25)
+            ->DisplayAggregatesOnly(false);
+}
+
+BENCHMARK_REGISTER_F(StorageDbOpGetFixture, storage_db_op_get_hot_key)
+        ->Apply(BenchArgumentsHotKey);
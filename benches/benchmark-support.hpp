@@ -20,6 +20,7 @@
 #include "log/log.h"
 
 #include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/mcmp/hashtable_config.h"
 
 #define BENCHES_MAX_THREADS_PER_CORE        32
 
@@ -31,6 +32,24 @@ public:
         return (threads / utils_cpu_count()) > max_threads_per_core;
     }
 
+    static bool CheckIfNumaModeAvailable() {
+        return numa_available() != -1 && numa_num_configured_nodes() > 1;
+    }
+
+    static hashtable_t* InitHashtable(uint64_t initial_size, bool numa_interleaved) {
+        hashtable_config_t* hashtable_config = hashtable_mcmp_config_init();
+        hashtable_config->initial_size = initial_size;
+        hashtable_config->can_auto_resize = false;
+
+        // In NUMA mode the memory of the hashtable is interleaved across all the numa nodes, as done by the storage db
+        if (numa_interleaved) {
+            hashtable_config->numa_aware = true;
+            hashtable_config->numa_nodes_bitmask = numa_all_nodes_ptr;
+        }
+
+        return hashtable_mcmp_init(hashtable_config);
+    }
+
     static void CollectHashtableStats(
             hashtable_t* hashtable,
             uint64_t* return_used_chunks,
@@ -93,6 +112,7 @@ public:
         state.counters["total_buckets"] = (double)hashtable->ht_current->buckets_count;
         state.counters["keys_count"] = keys_count;
         state.counters["requested_load_factor"] = requested_load_factor;
+        state.counters["numa_interleaved"] = hashtable->config->numa_aware ? 1 : 0;
         state.counters["total_chunks"] = (double)hashtable->ht_current->chunks_count;
         state.counters["used_chunks"] = (double)used_chunks;
         state.counters["load_factor_chunks"] = load_factor_chunks;
@@ -90,12 +90,19 @@ struct config_module_network_tls {
     config_module_network_tls_max_version_t max_version;
 };
 
+typedef struct config_module_redis_cluster config_module_redis_cluster_t;
+struct config_module_redis_cluster {
+    char *announce_address;
+    uint16_t announce_port;
+};
+
 typedef struct config_module_redis config_module_redis_t;
 struct config_module_redis {
     uint32_t max_key_length;
     uint32_t max_command_length;
     uint32_t max_command_arguments;
     bool strict_parsing;
+    config_module_redis_cluster_t *cluster;
 };
 
 typedef struct config_module_network config_module_network_t;
@@ -155,6 +162,21 @@ struct config_database_file {
     uint32_t shard_size_mb;
 };
 
+enum config_database_aof_fsync {
+    CONFIG_DATABASE_AOF_FSYNC_ALWAYS,
+    CONFIG_DATABASE_AOF_FSYNC_EVERYSEC,
+    CONFIG_DATABASE_AOF_FSYNC_NO,
+};
+typedef enum config_database_aof_fsync config_database_aof_fsync_t;
+
+typedef struct config_database_aof config_database_aof_t;
+struct config_database_aof {
+    char *path;
+    config_database_aof_fsync_t fsync;
+    uint32_t rewrite_percentage;
+    uint32_t rewrite_min_size_mb;
+};
+
 typedef struct config_database config_database_t;
 struct config_database {
     uint32_t max_keys;
@@ -162,6 +184,7 @@ struct config_database {
     union {
         config_database_file_t *file;
     };
+    config_database_aof_t *aof;
 };
 
 typedef struct config config_t;
@@ -103,6 +103,17 @@ const cyaml_schema_field_t config_module_network_tls_schema[] = {
         CYAML_FIELD_END
 };
 
+// Schema for config -> modules -> module -> redis -> cluster
+const cyaml_schema_field_t config_module_redis_cluster_schema[] = {
+        CYAML_FIELD_STRING_PTR(
+                "announce_address", CYAML_FLAG_POINTER,
+                config_module_redis_cluster_t, announce_address, 0, CYAML_UNLIMITED),
+        CYAML_FIELD_UINT(
+                "announce_port", CYAML_FLAG_DEFAULT | CYAML_FLAG_OPTIONAL,
+                config_module_redis_cluster_t, announce_port),
+        CYAML_FIELD_END
+};
+
 // Schema for config -> modules -> module -> redis
 const cyaml_schema_field_t config_module_redis_schema[] = {
         CYAML_FIELD_UINT(
@@ -117,6 +128,9 @@ const cyaml_schema_field_t config_module_redis_schema[] = {
         CYAML_FIELD_BOOL(
                 "strict_parsing", CYAML_FLAG_DEFAULT,
                 config_module_redis_t, strict_parsing),
+        CYAML_FIELD_MAPPING_PTR(
+                "cluster", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_module_redis_t, cluster, config_module_redis_cluster_schema),
         CYAML_FIELD_END
 };
 
@@ -218,6 +232,31 @@ const cyaml_schema_field_t config_storage_file_schema[] = {
                 config_database_file_t, shard_size_mb),
         CYAML_FIELD_END
 };
+// Allowed strings for for config -> database -> aof -> fsync
+const cyaml_strval_t config_database_aof_fsync_schema_strings[] = {
+        { "always", CONFIG_DATABASE_AOF_FSYNC_ALWAYS },
+        { "everysec", CONFIG_DATABASE_AOF_FSYNC_EVERYSEC },
+        { "no", CONFIG_DATABASE_AOF_FSYNC_NO },
+};
+
+// Schema for config -> database -> aof
+const cyaml_schema_field_t config_database_aof_schema[] = {
+        CYAML_FIELD_STRING_PTR(
+                "path", CYAML_FLAG_POINTER,
+                config_database_aof_t, path, 0, CYAML_UNLIMITED),
+        CYAML_FIELD_ENUM(
+                "fsync", CYAML_FLAG_DEFAULT | CYAML_FLAG_STRICT,
+                config_database_aof_t, fsync, config_database_aof_fsync_schema_strings,
+                CYAML_ARRAY_LEN(config_database_aof_fsync_schema_strings)),
+        CYAML_FIELD_UINT(
+                "rewrite_percentage", CYAML_FLAG_DEFAULT,
+                config_database_aof_t, rewrite_percentage),
+        CYAML_FIELD_UINT(
+                "rewrite_min_size_mb", CYAML_FLAG_DEFAULT,
+                config_database_aof_t, rewrite_min_size_mb),
+        CYAML_FIELD_END
+};
+
 // Schema for config -> storage
 const cyaml_schema_field_t config_database_schema[] = {
         CYAML_FIELD_UINT(
@@ -230,6 +269,9 @@ const cyaml_schema_field_t config_database_schema[] = {
         CYAML_FIELD_MAPPING_PTR(
                 "file", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
                 config_database_t, file, config_storage_file_schema),
+        CYAML_FIELD_MAPPING_PTR(
+                "aof", CYAML_FLAG_POINTER | CYAML_FLAG_OPTIONAL,
+                config_database_t, aof, config_database_aof_schema),
         CYAML_FIELD_END
 };
 
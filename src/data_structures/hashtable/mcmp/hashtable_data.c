@@ -72,6 +72,8 @@ bool hashtable_mcmp_data_numa_interleave_memory(
         return false;
     }
 
+    // numa_interleave_memory doesn't return a value, errno has to be reset to detect a failure
+    errno = 0;
     numa_interleave_memory(
             (void*)hashtable_data->half_hashes_chunk,
             hashtable_data->half_hashes_chunk_size,
@@ -81,6 +83,7 @@ bool hashtable_mcmp_data_numa_interleave_memory(
         return false;
     }
 
+    errno = 0;
     numa_interleave_memory(
             (void*)hashtable_data->keys_values,
             hashtable_data->keys_values_size,
@@ -92,8 +92,12 @@ bool hashtable_mcmp_op_delete(
         half_hashes_chunk = &hashtable_data->half_hashes_chunk[chunk_index];
 
         transaction_acquire(&transaction);
-        if (unlikely(!transaction_spinlock_lock(&half_hashes_chunk->write_lock, &transaction))) {
-            return false;
+
+        // The chunk might already be owned if a parent transaction is set (e.g. a transaction of the redis module)
+        if (likely(!transaction_spinlock_is_owned_by_transaction(&half_hashes_chunk->write_lock, &transaction))) {
+            if (unlikely(!transaction_spinlock_lock(&half_hashes_chunk->write_lock, &transaction))) {
+                return false;
+            }
         }
 
         // The hashtable_mcmp_support_op_search_key operation is lockless, it's necessary to set the lock and validate
@@ -106,6 +110,7 @@ bool hashtable_mcmp_op_delete(
             }
 
             half_hashes_chunk->metadata.is_full = 0;
+            half_hashes_chunk->metadata.changes_counter++;
             half_hashes_chunk->half_hashes[chunk_slot_index].slot_id = 0;
 
             MEMORY_FENCE_STORE();
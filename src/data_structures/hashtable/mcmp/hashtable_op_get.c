@@ -24,6 +24,7 @@
 #include "hashtable.h"
 #include "hashtable_op_get.h"
 #include "hashtable_support_hash.h"
+#include "hashtable_support_index.h"
 #include "hashtable_support_op.h"
 
 bool hashtable_mcmp_op_get(
@@ -31,7 +32,20 @@ bool hashtable_mcmp_op_get(
         hashtable_key_data_t *key,
         hashtable_key_size_t key_size,
         hashtable_value_data_t *data) {
-    hashtable_hash_t hash;
+    return hashtable_mcmp_op_get_by_hash(
+            hashtable,
+            hashtable_mcmp_support_hash_calculate(key, key_size),
+            key,
+            key_size,
+            data);
+}
+
+bool hashtable_mcmp_op_get_by_hash(
+        hashtable_t *hashtable,
+        hashtable_hash_t hash,
+        hashtable_key_data_t *key,
+        hashtable_key_size_t key_size,
+        hashtable_value_data_t *data) {
     hashtable_chunk_index_t chunk_index = 0;
     hashtable_chunk_slot_index_t chunk_slot_index = 0;
     hashtable_key_value_volatile_t* key_value = 0;
@@ -39,8 +53,6 @@ bool hashtable_mcmp_op_get(
     bool data_found = false;
     *data = 0;
 
-    hash = hashtable_mcmp_support_hash_calculate(key, key_size);
-
     LOG_DI("key (%d) = %s", key_size, key);
     LOG_DI("hash = 0x%016x", hash);
 
@@ -102,3 +114,51 @@ bool hashtable_mcmp_op_get(
 
     return data_found;
 }
+
+void hashtable_mcmp_op_get_version(
+        hashtable_t *hashtable,
+        hashtable_key_data_t *key,
+        hashtable_key_size_t key_size,
+        hashtable_mcmp_op_version_t *version) {
+    hashtable_chunk_slot_index_t chunk_slot_index = 0;
+    hashtable_key_value_volatile_t* key_value = 0;
+    hashtable_hash_t hash = hashtable_mcmp_support_hash_calculate(key, key_size);
+    hashtable_data_volatile_t* hashtable_data = hashtable->ht_current;
+
+    // The changes counter of the chunk is increased every time a key in it is updated or deleted, it's a cheap version
+    // shared by all the keys in the chunk. As it's only 8 bits the value is returned as well, a key is considered
+    // unchanged only if both match. If the key doesn't exist the chunk where it would be inserted first is used.
+    // To get a consistent version the caller has to own the lock of the chunk the key belongs to.
+    version->value = 0;
+    if (hashtable_mcmp_support_op_search_key(
+            hashtable_data,
+            key,
+            key_size,
+            hash,
+            &version->chunk_index,
+            &chunk_slot_index,
+            &key_value)) {
+        MEMORY_FENCE_LOAD();
+        version->value = key_value->data;
+    } else {
+        version->chunk_index = HASHTABLE_TO_CHUNK_INDEX(
+                hashtable_mcmp_support_index_from_hash(hashtable_data->buckets_count, hash));
+    }
+
+    version->changes_counter = hashtable_data->half_hashes_chunk[version->chunk_index].metadata.changes_counter;
+}
+
+void hashtable_mcmp_op_get_prefetch(
+        hashtable_t *hashtable,
+        hashtable_hash_t hash) {
+    hashtable_data_volatile_t* hashtable_data = hashtable->ht_current;
+
+    // Only the half hashes chunk of the current hashtable data is prefetched, it's the first memory access carried out
+    // by the search and the only one that can be calculated from the hash alone, if the hashtable is resizing the old
+    // hashtable data will be accessed without prefetching
+    hashtable_bucket_index_t bucket_index =
+            hashtable_mcmp_support_index_from_hash(hashtable_data->buckets_count, hash);
+    hashtable_chunk_index_t chunk_index = bucket_index / HASHTABLE_MCMP_HALF_HASHES_CHUNK_SLOTS_COUNT;
+
+    __builtin_prefetch((void*)&hashtable_data->half_hashes_chunk[chunk_index], 0, 3);
+}
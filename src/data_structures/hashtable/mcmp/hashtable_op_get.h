@@ -5,12 +5,36 @@
 extern "C" {
 #endif
 
+typedef struct hashtable_mcmp_op_version hashtable_mcmp_op_version_t;
+struct hashtable_mcmp_op_version {
+    hashtable_chunk_index_t chunk_index;
+    uint8_t changes_counter;
+    hashtable_value_data_t value;
+};
+
 bool hashtable_mcmp_op_get(
         hashtable_t *hashtable,
         hashtable_key_data_t *key,
         hashtable_key_size_t key_size,
         hashtable_value_data_t *data);
 
+bool hashtable_mcmp_op_get_by_hash(
+        hashtable_t *hashtable,
+        hashtable_hash_t hash,
+        hashtable_key_data_t *key,
+        hashtable_key_size_t key_size,
+        hashtable_value_data_t *data);
+
+void hashtable_mcmp_op_get_version(
+        hashtable_t *hashtable,
+        hashtable_key_data_t *key,
+        hashtable_key_size_t key_size,
+        hashtable_mcmp_op_version_t *version);
+
+void hashtable_mcmp_op_get_prefetch(
+        hashtable_t *hashtable,
+        hashtable_hash_t hash);
+
 #ifdef __cplusplus
 }
 #endif
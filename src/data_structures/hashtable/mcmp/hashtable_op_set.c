@@ -6,6 +6,7 @@
  * of the BSD license.  See the LICENSE file for details.
  **/
 
+#include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdatomic.h>
@@ -19,37 +20,132 @@
 #include "transaction.h"
 #include "transaction_spinlock.h"
 #include "log/log.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
 
 #include "hashtable.h"
 #include "hashtable_op_set.h"
 #include "hashtable_support_hash.h"
+#include "hashtable_support_index.h"
 #include "hashtable_support_op.h"
 #include "hashtable_thread_counters.h"
 
+static int hashtable_mcmp_op_set_chunk_index_compare(
+        const void *a,
+        const void *b) {
+    hashtable_chunk_index_t chunk_index_a = *(hashtable_chunk_index_t*)a;
+    hashtable_chunk_index_t chunk_index_b = *(hashtable_chunk_index_t*)b;
+
+    return chunk_index_a < chunk_index_b ? -1 : (chunk_index_a > chunk_index_b ? 1 : 0);
+}
+
 bool hashtable_mcmp_op_set(
         hashtable_t *hashtable,
         hashtable_key_data_t *key,
         hashtable_key_size_t key_size,
         hashtable_value_data_t new_value,
         hashtable_value_data_t *previous_value) {
+    transaction_t transaction = { 0 };
+
+    transaction_acquire(&transaction);
+
+    bool res = hashtable_mcmp_op_set_by_hash_in_transaction(
+            hashtable,
+            &transaction,
+            hashtable_mcmp_support_hash_calculate(key, key_size),
+            key,
+            key_size,
+            new_value,
+            previous_value);
+
+    // Will perform the memory fence for us
+    transaction_release(&transaction);
+
+    return res;
+}
+
+bool hashtable_mcmp_op_set_lock_chunks_by_hashes(
+        hashtable_t *hashtable,
+        transaction_t *transaction,
+        hashtable_hash_t *hashes,
+        uint32_t hashes_count) {
+    bool result_res = false;
+    hashtable_data_volatile_t *hashtable_data = hashtable->ht_current;
+    hashtable_chunk_index_t locked_up_to_chunk_index = 0;
+    bool locked_any_chunk = false;
+    hashtable_chunk_index_t *chunk_indexes = ffma_mem_alloc(sizeof(hashtable_chunk_index_t) * hashes_count);
+
+    for(uint32_t index = 0; index < hashes_count; index++) {
+        chunk_indexes[index] = HASHTABLE_TO_CHUNK_INDEX(
+                hashtable_mcmp_support_index_from_hash(hashtable_data->buckets_count, hashes[index]));
+    }
+
+    qsort(
+            chunk_indexes,
+            hashes_count,
+            sizeof(hashtable_chunk_index_t),
+            hashtable_mcmp_op_set_chunk_index_compare);
+
+    // When a key has to be inserted the search probes forward, locking every chunk from the home chunk of the key up
+    // to the one with a free slot, so the whole probe window of each key is locked upfront. The windows are locked
+    // in ascending order, the same order followed by the search, and the overlapping parts are skipped, therefore
+    // multiple transactions locking overlapping sets of chunks can't deadlock and the inserts carried out afterwards
+    // will never have to lock additional chunks.
+    for(uint32_t index = 0; index < hashes_count; index++) {
+        hashtable_chunk_index_t chunk_index = chunk_indexes[index];
+        hashtable_chunk_index_t chunk_index_end = chunk_index + HASHTABLE_HALF_HASHES_CHUNK_SEARCH_MAX;
+
+        assert(chunk_index_end <= hashtable_data->chunks_count);
+
+        if (locked_any_chunk && chunk_index <= locked_up_to_chunk_index) {
+            chunk_index = locked_up_to_chunk_index + 1;
+        }
+
+        for(; chunk_index < chunk_index_end; chunk_index++) {
+            hashtable_half_hashes_chunk_volatile_t *half_hashes_chunk =
+                    &hashtable_data->half_hashes_chunk[chunk_index];
+
+            // The chunk might already be owned if a parent transaction is set (e.g. a transaction of the redis module)
+            if (likely(!transaction_spinlock_is_owned_by_transaction(&half_hashes_chunk->write_lock, transaction))) {
+                if (unlikely(!transaction_spinlock_lock(&half_hashes_chunk->write_lock, transaction))) {
+                    goto end;
+                }
+            }
+
+            locked_up_to_chunk_index = chunk_index;
+            locked_any_chunk = true;
+        }
+    }
+
+    result_res = true;
+
+end:
+    ffma_mem_free(chunk_indexes);
+
+    return result_res;
+}
+
+bool hashtable_mcmp_op_set_by_hash_in_transaction(
+        hashtable_t *hashtable,
+        transaction_t *transaction,
+        hashtable_hash_t hash,
+        hashtable_key_data_t *key,
+        hashtable_key_size_t key_size,
+        hashtable_value_data_t new_value,
+        hashtable_value_data_t *previous_value) {
     bool created_new = true;
     bool key_inlined = false;
-    hashtable_hash_t hash;
     hashtable_half_hashes_chunk_volatile_t* half_hashes_chunk = 0;
     hashtable_chunk_index_t chunk_index = 0;
     hashtable_chunk_slot_index_t chunk_slot_index = 0;
     hashtable_key_value_volatile_t* key_value = 0;
-    transaction_t transaction = { 0 };
-
-    hash = hashtable_mcmp_support_hash_calculate(key, key_size);
 
     LOG_DI("key (%d) = %s", key_size, key);
     LOG_DI("hash = 0x%016x", hash);
 
     assert(*key != 0);
 
-    transaction_acquire(&transaction);
-
     // TODO: there is no support for resizing right now but when creating a new item the function must be aware that
     //       it has to be created in the new hashtable and not in the one being looked into
     bool ret = hashtable_mcmp_support_op_search_key_or_create_new(
@@ -58,7 +154,7 @@ bool hashtable_mcmp_op_set(
             key_size,
             hash,
             true,
-            &transaction,
+            transaction,
             &created_new,
             &chunk_index,
             &half_hashes_chunk,
@@ -70,7 +166,6 @@ bool hashtable_mcmp_op_set(
     LOG_DI("key_value =  0x%016x", key_value);
 
     if (ret == false) {
-        transaction_release(&transaction);
         LOG_DI("key not found or not created, continuing");
         return false;
     }
@@ -128,12 +223,8 @@ bool hashtable_mcmp_op_set(
         LOG_DI("key_value->flags = %d", key_value->flags);
     }
 
-    // Will perform the memory fence for us
-    transaction_release(&transaction);
-
-    LOG_DI("unlocking half_hashes_chunk 0x%016x", half_hashes_chunk);
-
-    // Validate if the passed key can be freed because unused or because inlined
+    // The locked chunks are released by the caller together with the transaction, the key can be freed right away
+    // as it's not going to be accessed anymore if unused or inlined
     if (!created_new || key_inlined) {
         xalloc_free(key);
     }
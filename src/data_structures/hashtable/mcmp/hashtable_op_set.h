@@ -12,6 +12,21 @@ bool hashtable_mcmp_op_set(
         hashtable_value_data_t new_value,
         hashtable_value_data_t *current_value);
 
+bool hashtable_mcmp_op_set_lock_chunks_by_hashes(
+        hashtable_t *hashtable,
+        transaction_t *transaction,
+        hashtable_hash_t *hashes,
+        uint32_t hashes_count);
+
+bool hashtable_mcmp_op_set_by_hash_in_transaction(
+        hashtable_t *hashtable,
+        transaction_t *transaction,
+        hashtable_hash_t hash,
+        hashtable_key_data_t *key,
+        hashtable_key_size_t key_size,
+        hashtable_value_data_t new_value,
+        hashtable_value_data_t *current_value);
+
 #ifdef __cplusplus
 }
 #endif
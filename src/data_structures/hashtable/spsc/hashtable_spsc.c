@@ -214,3 +214,50 @@ void *hashtable_spsc_op_iter(
     hashtable_spsc_bucket_t *buckets = hashtable_spsc_get_buckets(hashtable);
     return buckets[*bucket_index].value;
 }
+
+hashtable_spsc_t *hashtable_spsc_upsize_cs(
+        hashtable_spsc_t *hashtable) {
+    hashtable_spsc_bucket_count_t buckets_count = hashtable->buckets_count;
+    hashtable_spsc_bucket_t *buckets = hashtable_spsc_get_buckets(hashtable);
+
+    // The keys are not copied, the new hashtable points to the same memory, so both can't own them
+    assert(!hashtable->free_keys_on_deallocation);
+
+    // The hashtable can't grow, a new hashtable twice as big is allocated and the entries are moved in it, if they
+    // still don't fit because of the max range the size is doubled again
+    while(true) {
+        void *bucket_value;
+        bool moved = true;
+        hashtable_spsc_bucket_index_t bucket_index = 0;
+
+        if (unlikely(buckets_count > UINT32_MAX / 4)) {
+            return NULL;
+        }
+
+        buckets_count *= 2;
+        hashtable_spsc_t *hashtable_new = hashtable_spsc_new(
+                buckets_count,
+                hashtable->max_range,
+                hashtable->stop_on_not_set,
+                false);
+
+        while((bucket_value = hashtable_spsc_op_iter(hashtable, &bucket_index)) != NULL) {
+            if (unlikely(!hashtable_spsc_op_try_set_cs(
+                    hashtable_new,
+                    buckets[bucket_index].key,
+                    buckets[bucket_index].key_length,
+                    bucket_value))) {
+                moved = false;
+                break;
+            }
+
+            bucket_index++;
+        }
+
+        if (likely(moved)) {
+            return hashtable_new;
+        }
+
+        hashtable_spsc_free(hashtable_new);
+    }
+}
@@ -249,6 +249,9 @@ void *hashtable_spsc_op_iter(
         hashtable_spsc_t *hashtable,
         hashtable_spsc_bucket_index_t *bucket_index);
 
+hashtable_spsc_t *hashtable_spsc_upsize_cs(
+        hashtable_spsc_t *hashtable);
+
 #ifdef __cplusplus
 }
 #endif
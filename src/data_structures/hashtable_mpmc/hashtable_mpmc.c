@@ -41,15 +41,18 @@ static thread_local epoch_operation_queue_t *thread_local_epoch_operation_queue_
 FUNCTION_CTOR(hashtable_mpmc_epoch_gc_object_type_hashtable_key_value_destructor_cb_init, {
     epoch_gc_register_object_type_destructor_cb(
             EPOCH_GC_OBJECT_TYPE_HASHTABLE_KEY_VALUE,
-            hashtable_mpmc_epoch_gc_object_type_hashtable_key_value_destructor_cb);
+            hashtable_mpmc_epoch_gc_object_type_hashtable_key_value_destructor_cb,
+            NULL);
     epoch_gc_register_object_type_destructor_cb(
             EPOCH_GC_OBJECT_TYPE_HASHTABLE_DATA,
-            hashtable_mpmc_epoch_gc_object_type_hashtable_data_destructor_cb);
+            hashtable_mpmc_epoch_gc_object_type_hashtable_data_destructor_cb,
+            NULL);
 })
 
 void hashtable_mpmc_epoch_gc_object_type_hashtable_key_value_destructor_cb(
         uint8_t staged_objects_count,
-        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]) {
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data) {
     for(uint8_t index = 0; index < staged_objects_count; index++) {
         hashtable_mpmc_data_key_value_t *key_value = staged_objects[index].data.object;
         if (!key_value->key_is_embedded) {
@@ -62,7 +65,8 @@ void hashtable_mpmc_epoch_gc_object_type_hashtable_key_value_destructor_cb(
 
 void hashtable_mpmc_epoch_gc_object_type_hashtable_data_destructor_cb(
         uint8_t staged_objects_count,
-        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]) {
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data) {
     for(uint8_t index = 0; index < staged_objects_count; index++) {
         hashtable_mpmc_data_t *hashtable_mpmc_data = staged_objects[index].data.object;
         hashtable_mpmc_data_free(hashtable_mpmc_data);
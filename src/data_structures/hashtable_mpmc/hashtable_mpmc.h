@@ -128,11 +128,13 @@ typedef enum hashtable_mpmc_result hashtable_mpmc_result_t;
 
 void hashtable_mpmc_epoch_gc_object_type_hashtable_key_value_destructor_cb(
         uint8_t staged_objects_count,
-        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]);
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data);
 
 void hashtable_mpmc_epoch_gc_object_type_hashtable_data_destructor_cb(
         uint8_t staged_objects_count,
-        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]);
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data);
 
 void hashtable_mpmc_thread_epoch_operation_queue_hashtable_key_value_init();
 
@@ -76,6 +76,37 @@ bool queue_mpmc_push(
     return true;
 }
 
+void queue_mpmc_push_nodes(
+        queue_mpmc_t *queue_mpmc,
+        queue_mpmc_node_t *node_first,
+        queue_mpmc_node_t *node_last,
+        uint32_t nodes_count) {
+    assert(node_first != NULL && node_last != NULL && nodes_count > 0);
+
+    queue_mpmc_versioned_head_t head_expected = {
+            ._packed = queue_mpmc->head._packed
+    };
+    queue_mpmc_versioned_head_t head_new = {
+            .data = {
+                    .node = node_first,
+            },
+    };
+
+    // The nodes are already linked together by the caller, which also owns their memory, so the whole chain is
+    // attached to the head with a single atomic operation
+    do {
+        head_new.data.length = head_expected.data.length + nodes_count;
+        head_new.data.version = head_expected.data.version + 1;
+        node_last->next = (queue_mpmc_node_t*)head_expected.data.node;
+    } while (!__atomic_compare_exchange_n(
+            &queue_mpmc->head._packed,
+            &head_expected._packed,
+            head_new._packed,
+            true,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE));
+}
+
 void *queue_mpmc_pop(
         queue_mpmc_t *queue_mpmc) {
     queue_mpmc_versioned_head_t head_expected, head_new;
@@ -109,6 +140,48 @@ void *queue_mpmc_pop(
     return data;
 }
 
+queue_mpmc_node_t *queue_mpmc_pop_all(
+        queue_mpmc_t *queue_mpmc) {
+    queue_mpmc_versioned_head_t head_expected, head_new;
+    queue_mpmc_node_t *node, *node_reversed = NULL;
+
+    head_expected._packed = queue_mpmc->head._packed;
+
+    // Detaches the whole list of nodes with a single atomic operation, the consumer can then process them without
+    // having to touch the head of the queue for each element
+    do {
+        if (head_expected.data.node == NULL) {
+            return NULL;
+        }
+
+        head_new.data.node = NULL;
+        head_new.data.version = head_expected.data.version + 1;
+        head_new.data.length = 0;
+    } while (!__atomic_compare_exchange_n(
+            &queue_mpmc->head._packed,
+            &head_expected._packed,
+            head_new._packed,
+            true,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE));
+
+    // The nodes are pushed on the head so the list is reversed to return them in the same order they were pushed
+    node = (queue_mpmc_node_t*)head_expected.data.node;
+    while(node != NULL) {
+        queue_mpmc_node_t *node_next = node->next;
+        node->next = node_reversed;
+        node_reversed = node;
+        node = node_next;
+    }
+
+    return node_reversed;
+}
+
+void queue_mpmc_node_free(
+        queue_mpmc_node_t *node) {
+    xalloc_free(node);
+}
+
 uint32_t queue_mpmc_get_length(
         queue_mpmc_t *queue_mpmc) {
     MEMORY_FENCE_LOAD();
@@ -41,9 +41,21 @@ bool queue_mpmc_push(
         queue_mpmc_t *queue_mpmc,
         void *data);
 
+void queue_mpmc_push_nodes(
+        queue_mpmc_t *queue_mpmc,
+        queue_mpmc_node_t *node_first,
+        queue_mpmc_node_t *node_last,
+        uint32_t nodes_count);
+
 void *queue_mpmc_pop(
         queue_mpmc_t *queue_mpmc);
 
+queue_mpmc_node_t *queue_mpmc_pop_all(
+        queue_mpmc_t *queue_mpmc);
+
+void queue_mpmc_node_free(
+        queue_mpmc_node_t *node);
+
 uint32_t queue_mpmc_get_length(
         queue_mpmc_t *queue_mpmc);
 
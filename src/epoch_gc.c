@@ -33,6 +33,9 @@ thread_local epoch_gc_thread_t *thread_local_epoch_gc[EPOCH_GC_OBJECT_TYPE_MAX]
 epoch_gc_staged_object_destructor_cb_t* epoch_gc_staged_object_destructor_cb[EPOCH_GC_OBJECT_TYPE_MAX] = {
         NULL
 };
+void* epoch_gc_staged_object_destructor_cb_user_data[EPOCH_GC_OBJECT_TYPE_MAX] = {
+        NULL
+};
 
 #if DEBUG == 1
 epoch_gc_thread_t** epoch_gc_get_thread_local_epoch_gc() {
@@ -64,13 +67,16 @@ void epoch_gc_free(
 
 void epoch_gc_register_object_type_destructor_cb(
         epoch_gc_object_type_t object_type,
-        epoch_gc_staged_object_destructor_cb_t *destructor_cb) {
+        epoch_gc_staged_object_destructor_cb_t *destructor_cb,
+        void *user_data) {
     epoch_gc_staged_object_destructor_cb[object_type] = destructor_cb;
+    epoch_gc_staged_object_destructor_cb_user_data[object_type] = user_data;
 }
 
 void epoch_gc_unregister_object_type_destructor_cb(
         epoch_gc_object_type_t object_type) {
     epoch_gc_staged_object_destructor_cb[object_type] = NULL;
+    epoch_gc_staged_object_destructor_cb_user_data[object_type] = NULL;
 }
 
 void epoch_gc_thread_append_new_staged_objects_ring(
@@ -199,6 +205,11 @@ void epoch_gc_thread_get_instance(
     assert((*epoch_gc)->object_type == object_type);
 }
 
+bool epoch_gc_thread_is_registered_local(
+        epoch_gc_object_type_t object_type) {
+    return thread_local_epoch_gc[object_type] != NULL;
+}
+
 bool epoch_gc_thread_is_terminated(
         epoch_gc_thread_t *epoch_gc_thread) {
     MEMORY_FENCE_LOAD();
@@ -248,7 +259,7 @@ uint32_t epoch_gc_thread_collect(
     while((epoch_gc_thread_item = double_linked_list_iter_next(
             epoch_gc->thread_list, epoch_gc_thread_item)) != NULL) {
         MEMORY_FENCE_LOAD();
-        uint64_t thread_epoch = epoch_gc_thread->epoch;
+        uint64_t thread_epoch = ((epoch_gc_thread_t*)epoch_gc_thread_item->data)->epoch;
 
         if (thread_epoch < epoch) {
             epoch = thread_epoch;
@@ -286,7 +297,9 @@ uint32_t epoch_gc_thread_collect(
             deleted_counter++;
             if (staged_objects_to_delete_counter == ARRAY_SIZE(staged_objects_to_delete)) {
                 epoch_gc_staged_object_destructor_cb[epoch_gc->object_type](
-                        staged_objects_to_delete_counter, staged_objects_to_delete);
+                        staged_objects_to_delete_counter,
+                        staged_objects_to_delete,
+                        epoch_gc_staged_object_destructor_cb_user_data[epoch_gc->object_type]);
                 staged_objects_to_delete_counter = 0;
             }
         }
@@ -340,7 +353,9 @@ uint32_t epoch_gc_thread_collect(
                 staged_objects_to_delete_counter++;
                 if (staged_objects_to_delete_counter == ARRAY_SIZE(staged_objects_to_delete)) {
                     epoch_gc_staged_object_destructor_cb[epoch_gc->object_type](
-                            staged_objects_to_delete_counter, staged_objects_to_delete);
+                            staged_objects_to_delete_counter,
+                            staged_objects_to_delete,
+                            epoch_gc_staged_object_destructor_cb_user_data[epoch_gc->object_type]);
                     staged_objects_to_delete_counter = 0;
                 }
 
@@ -385,7 +400,9 @@ uint32_t epoch_gc_thread_collect(
 
     if (staged_objects_to_delete_counter > 0) {
         epoch_gc_staged_object_destructor_cb[epoch_gc->object_type](
-                staged_objects_to_delete_counter, staged_objects_to_delete);
+                staged_objects_to_delete_counter,
+                staged_objects_to_delete,
+                epoch_gc_staged_object_destructor_cb_user_data[epoch_gc->object_type]);
     }
 
     return deleted_counter;
@@ -404,10 +421,22 @@ bool epoch_gc_stage_object(
 
     epoch_gc_thread_get_instance(object_type, &epoch_gc, &epoch_gc_thread);
 
+    return epoch_gc_stage_object_with_epoch(object_type, object, epoch_gc_thread->epoch);
+}
+
+bool epoch_gc_stage_object_with_epoch(
+        epoch_gc_object_type_t object_type,
+        void* object,
+        uint64_t epoch) {
+    epoch_gc_t *epoch_gc = NULL;
+    epoch_gc_thread_t *epoch_gc_thread = NULL;
+
+    epoch_gc_thread_get_instance(object_type, &epoch_gc, &epoch_gc_thread);
+
     // Allocate the staged pointer
     epoch_gc_staged_object_t staged_object = {
             .data = {
-                    .epoch = epoch_gc_thread->epoch,
+                    .epoch = epoch,
                     .object = object,
             }
     };
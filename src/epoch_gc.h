@@ -13,7 +13,7 @@ extern "C" {
 enum epoch_gc_object_type {
     EPOCH_GC_OBJECT_TYPE_HASHTABLE_KEY_VALUE,
     EPOCH_GC_OBJECT_TYPE_HASHTABLE_DATA,
-    EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL, // to be used with values smaller than 64kb
+    EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL, // to be used with the embedded values
     EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_SMALL, // to be used with values smaller than 64kb
     EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_MEDIUM, // to be used with values smaller than 1MB
     EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE, // to be used with values smaller than 16MB
@@ -51,7 +51,8 @@ union epoch_gc_staged_object {
 
 typedef void (epoch_gc_staged_object_destructor_cb_t)(
         uint8_t,
-        epoch_gc_staged_object_t[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]);
+        epoch_gc_staged_object_t[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data);
 
 #if DEBUG == 1
 // Used only for testing and debugging
@@ -68,7 +69,8 @@ void epoch_gc_free(
 
 void epoch_gc_register_object_type_destructor_cb(
         epoch_gc_object_type_t object_type,
-        epoch_gc_staged_object_destructor_cb_t *destructor_cb);
+        epoch_gc_staged_object_destructor_cb_t *destructor_cb,
+        void *user_data);
 
 void epoch_gc_unregister_object_type_destructor_cb(
         epoch_gc_object_type_t object_type);
@@ -99,6 +101,9 @@ void epoch_gc_thread_get_instance(
         epoch_gc_t **epoch_gc,
         epoch_gc_thread_t **epoch_gc_thread);
 
+bool epoch_gc_thread_is_registered_local(
+        epoch_gc_object_type_t object_type);
+
 bool epoch_gc_thread_is_terminated(
         epoch_gc_thread_t *epoch_gc_thread);
 
@@ -131,6 +136,11 @@ bool epoch_gc_stage_object(
         epoch_gc_object_type_t object_type,
         void* object);
 
+bool epoch_gc_stage_object_with_epoch(
+        epoch_gc_object_type_t object_type,
+        void* object,
+        uint64_t epoch);
+
 #ifdef __cplusplus
 }
 #endif
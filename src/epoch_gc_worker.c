@@ -21,6 +21,8 @@
 #include "spinlock.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
 #include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
 #include "epoch_gc.h"
 
 #include "epoch_gc_worker.h"
@@ -128,16 +130,22 @@ uint32_t epoch_gc_worker_collect_staged_objects(
         bool force) {
     uint32_t collected_objects = 0;
 
+    if (unlikely(force)) {
+        // Force an epoch advance to be able to collect everything, the objects are collected only when all the threads
+        // have moved past their epoch so all the threads have to be advanced before starting to collect
+        for(
+                uint32_t epoch_gc_thread_list_index = 0;
+                epoch_gc_thread_list_index < epoch_gc_thread_list_length;
+                epoch_gc_thread_list_index++) {
+            epoch_gc_thread_advance_epoch_tsc(epoch_gc_thread_list_cache[epoch_gc_thread_list_index]);
+        }
+    }
+
     // Iterate over the cached epoch gc threads
     for(
             uint32_t epoch_gc_thread_list_index = 0;
             epoch_gc_thread_list_index < epoch_gc_thread_list_length;
             epoch_gc_thread_list_index++) {
-        if (unlikely(force)) {
-            // Force an epoch advance to be able to collect everything
-            epoch_gc_thread_advance_epoch_tsc(epoch_gc_thread_list_cache[epoch_gc_thread_list_index]);
-        }
-
         collected_objects += epoch_gc_thread_collect_all(
                 epoch_gc_thread_list_cache[epoch_gc_thread_list_index]);
     }
@@ -202,6 +210,10 @@ void epoch_gc_worker_main_loop(
                 epoch_gc_thread_list_cache,
                 epoch_gc_thread_list_index,
                 false);
+
+        // The destructors free objects owned by the workers, the batches are passed back to the owners after every
+        // collection as they would otherwise be held until full
+        ffma_thread_cache_different_thread_batches_flush();
         MEMORY_FENCE_STORE();
     } while(!epoch_gc_worker_should_terminate(epoch_gc_worker_context));
 
@@ -216,6 +228,7 @@ void epoch_gc_worker_main_loop(
             epoch_gc_thread_list_cache,
             epoch_gc_thread_list_index,
             true);
+    ffma_thread_cache_different_thread_batches_flush();
     MEMORY_FENCE_STORE();
 
     // Unregister and free all the epoch_gc_thread
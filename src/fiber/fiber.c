@@ -25,18 +25,146 @@
 
 #define TAG "fiber"
 
-void fiber_stack_protection(
-        fiber_t *fiber,
-        bool enable) {
-    int stack_usage_flags = enable ? PROT_NONE : PROT_READ | PROT_WRITE;
+thread_local fiber_stack_pool_t fiber_stack_pool = {
+        .head = NULL,
+        .count = 0,
+        .committed_count = 0
+};
+
+void *fiber_stack_pool_pop(
+        size_t stack_size) {
+    fiber_stack_pool_entry_t *entry = fiber_stack_pool.head;
+
+    // All the fibers are normally created with the same stack size, if the stack at the head of the pool doesn't match
+    // a new one gets mapped
+    if (entry == NULL || entry->stack_size != stack_size) {
+        return NULL;
+    }
+
+    fiber_stack_pool.head = entry->next;
+    fiber_stack_pool.count--;
+
+    if (!entry->pages_released) {
+        fiber_stack_pool.committed_count--;
+    }
+
+    return entry->stack_base;
+}
+
+bool fiber_stack_pool_push(
+        void *stack_base,
+        size_t stack_size) {
+    if (fiber_stack_pool.count == FIBER_STACK_POOL_MAX_SIZE) {
+        return false;
+    }
+
+    // The entry is stored in the top page of the stack, the fiber has touched it for sure so no additional memory
+    // gets committed. The pages used by the fiber are kept as they are, they are released later, if the pool holds too
+    // many committed stacks, by fiber_stack_pool_release_pages.
+    fiber_stack_pool_entry_t *entry = stack_base + stack_size - sizeof(fiber_stack_pool_entry_t);
+    entry->stack_base = stack_base;
+    entry->stack_size = stack_size;
+    entry->pages_released = false;
+    entry->next = fiber_stack_pool.head;
+
+    fiber_stack_pool.head = entry;
+    fiber_stack_pool.count++;
+    fiber_stack_pool.committed_count++;
+
+    return true;
+}
+
+void fiber_stack_pool_release_pages() {
+    fiber_stack_pool_entry_t *entry;
+    uint32_t committed_count = 0;
+
+    if (likely(fiber_stack_pool.committed_count <= FIBER_STACK_POOL_COMMITTED_MAX_SIZE)) {
+        return;
+    }
+
+    // The stacks at the head of the pool are the first ones to be reused so they are kept committed, the pages used by
+    // the fibers on the others, between the guard page and the top page, are given back to the kernel, otherwise a
+    // stack that went deep once would keep its memory committed while sitting in the pool. The mapping is private and
+    // anonymous so they will be zero-filled on the next touch.
+    size_t page_size = xalloc_get_page_size();
+    for(entry = fiber_stack_pool.head; entry != NULL; entry = entry->next) {
+        if (entry->pages_released) {
+            continue;
+        }
+
+        if (committed_count < FIBER_STACK_POOL_COMMITTED_MAX_SIZE || madvise(
+                entry->stack_base + page_size,
+                entry->stack_size - (page_size * 2),
+                MADV_DONTNEED) != 0) {
+            committed_count++;
+            continue;
+        }
+
+        entry->pages_released = true;
+    }
+
+    fiber_stack_pool.committed_count = committed_count;
+}
+
+void fiber_stack_pool_free() {
+    void *stack_base;
+    size_t stack_size;
+    fiber_stack_pool_entry_t *entry;
+
+    while((entry = fiber_stack_pool.head) != NULL) {
+        fiber_stack_pool.head = entry->next;
+        stack_base = entry->stack_base;
+        stack_size = entry->stack_size;
+
+        munmap(stack_base, stack_size);
+    }
+
+    fiber_stack_pool.count = 0;
+    fiber_stack_pool.committed_count = 0;
+}
+
+void *fiber_stack_alloc(
+        size_t stack_size) {
+    void *stack_base;
+
+    if ((stack_base = fiber_stack_pool_pop(stack_size)) != NULL) {
+        return stack_base;
+    }
+
+    // The stack is mapped with MAP_NORESERVE, the kernel commits only the pages actually touched by the fiber.
+    // The guard page is protected only once, when the stack is mapped, and stays protected while the stack is in the
+    // pool.
+    stack_base = mmap(
+            NULL,
+            stack_size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK,
+            -1,
+            0);
 
-    if (mprotect(fiber->stack_base, xalloc_get_page_size(), stack_usage_flags) != 0) {
+    if (stack_base == MAP_FAILED) {
+        fatal(TAG, "Unable to allocate the fiber stack");
+    }
+
+    if (mprotect(stack_base, xalloc_get_page_size(), PROT_NONE) != 0) {
         if (errno == ENOMEM) {
-            fatal(TAG, "Unable to protect/unprotect fiber stack, review the value of /proc/sys/vm/max_map_count");
+            fatal(TAG, "Unable to protect fiber stack, review the value of /proc/sys/vm/max_map_count");
         }
 
-        fatal(TAG, "Unable to protect/unprotect fiber stack");
+        fatal(TAG, "Unable to protect fiber stack");
     }
+
+    return stack_base;
+}
+
+void fiber_stack_free(
+        void *stack_base,
+        size_t stack_size) {
+    if (fiber_stack_pool_push(stack_base, stack_size)) {
+        return;
+    }
+
+    munmap(stack_base, stack_size);
 }
 
 fiber_t *fiber_new(
@@ -59,7 +187,7 @@ fiber_t *fiber_new(
     }
 
     fiber_t *fiber = xalloc_alloc_zero(sizeof(fiber_t));
-    void *stack_base = xalloc_alloc_aligned_zero(page_size, stack_size);
+    void *stack_base = fiber_stack_alloc(stack_size);
 
     // Align the stack_pointer to 16 bytes and add some padding as required by the ABI
     void* stack_pointer = (void*)((uintptr_t)(stack_base + stack_size) & -16L);
@@ -100,16 +228,13 @@ fiber_t *fiber_new(
 #error "unsupported architecture"
 #endif
 
-    fiber_stack_protection(fiber, true);
-
     return fiber;
 }
 
 void fiber_free(
         fiber_t *fiber) {
-    fiber_stack_protection(fiber, false);
+    fiber_stack_free(fiber->stack_base, fiber->stack_size);
 
     xalloc_free(fiber->name);
-    xalloc_free(fiber->stack_base);
     xalloc_free(fiber);
 }
@@ -13,6 +13,30 @@ extern "C" {
 #error "unsupported architecture"
 #endif
 
+// The stacks of the terminated fibers are kept in a per thread pool, up to this amount, to be reused by the new fibers
+#define FIBER_STACK_POOL_MAX_SIZE 256
+
+// The pooled stacks keep their pages committed, to be reused as they are, up to this amount, the pages of the others are
+// given back to the kernel by fiber_stack_pool_release_pages
+#define FIBER_STACK_POOL_COMMITTED_MAX_SIZE 32
+
+typedef struct fiber_stack_pool_entry fiber_stack_pool_entry_t;
+struct fiber_stack_pool_entry {
+    void *stack_base;
+    size_t stack_size;
+    bool pages_released;
+    fiber_stack_pool_entry_t *next;
+};
+
+typedef struct fiber_stack_pool fiber_stack_pool_t;
+struct fiber_stack_pool {
+    fiber_stack_pool_entry_t *head;
+    uint32_t count;
+    uint32_t committed_count;
+};
+
+extern thread_local fiber_stack_pool_t fiber_stack_pool;
+
 typedef struct fiber fiber_t;
 typedef void (fiber_start_fp_t)(fiber_t* fiber_from, fiber_t* fiber_to);
 
@@ -37,6 +61,9 @@ struct fiber {
     char *name;
     bool terminate;
     int error_number;
+    fiber_t *ready_next;
+    // The parent of the transactions acquired by the fiber, it's kept per fiber as the fiber can yield while it's set
+    struct transaction *parent_transaction;
     union {
         void* ptr_value;
         int int_value;
@@ -67,9 +94,23 @@ extern void fiber_context_swap(
         fiber_t *fiber_context_from,
         fiber_t *fiber_context_to);
 
-void fiber_stack_protection(
-        fiber_t* fiber,
-        bool enable);
+void *fiber_stack_pool_pop(
+        size_t stack_size);
+
+bool fiber_stack_pool_push(
+        void *stack_base,
+        size_t stack_size);
+
+void fiber_stack_pool_release_pages();
+
+void fiber_stack_pool_free();
+
+void *fiber_stack_alloc(
+        size_t stack_size);
+
+void fiber_stack_free(
+        void *stack_base,
+        size_t stack_size);
 
 fiber_t* fiber_new(
         char *name,
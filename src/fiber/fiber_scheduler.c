@@ -19,6 +19,7 @@
 #endif
 
 #include "misc.h"
+#include "clock.h"
 #include "xalloc.h"
 #include "log/log.h"
 #include "fatal.h"
@@ -35,6 +36,11 @@ thread_local fiber_scheduler_stack_t fiber_scheduler_stack = {
         .index = -1,
         .size = 0
 };
+thread_local fiber_scheduler_ready_queue_t fiber_scheduler_ready_queue = {
+        .head = NULL,
+        .tail = NULL,
+        .count = 0
+};
 
 void fiber_scheduler_free() {
     if (fiber_scheduler_stack.list) {
@@ -125,6 +131,89 @@ void fiber_scheduler_terminate_current_fiber() {
     fiber->terminate = true;
 }
 
+bool fiber_scheduler_can_yield() {
+    // Only a fiber can yield, the index 0 of the stack is always the scheduler
+    return fiber_scheduler_stack.index > 0;
+}
+
+void fiber_scheduler_yield() {
+    fiber_t *fiber;
+
+    if (!fiber_scheduler_can_yield()) {
+        return;
+    }
+
+    // The fiber is appended to the ready queue and the execution is switched back, the worker loop will switch to it
+    // again once it has processed the pending events
+    fiber = fiber_scheduler_get_current();
+    fiber->ready_next = NULL;
+
+    if (fiber_scheduler_ready_queue.tail) {
+        fiber_scheduler_ready_queue.tail->ready_next = fiber;
+    } else {
+        fiber_scheduler_ready_queue.head = fiber;
+    }
+    fiber_scheduler_ready_queue.tail = fiber;
+    fiber_scheduler_ready_queue.count++;
+
+    fiber_scheduler_switch_back();
+}
+
+bool fiber_scheduler_has_ready_fibers() {
+    return fiber_scheduler_ready_queue.head != NULL;
+}
+
+void fiber_scheduler_resume_ready_fibers() {
+    fiber_t *fiber;
+
+    // Only the fibers already in the queue are resumed, the ones yielding again while being resumed are processed at
+    // the next iteration of the worker loop to avoid starving the events
+    uint32_t count = fiber_scheduler_ready_queue.count;
+    while(count-- > 0) {
+        fiber = fiber_scheduler_ready_queue.head;
+        fiber_scheduler_ready_queue.head = fiber->ready_next;
+        if (fiber_scheduler_ready_queue.head == NULL) {
+            fiber_scheduler_ready_queue.tail = NULL;
+        }
+        fiber_scheduler_ready_queue.count--;
+
+        fiber->ready_next = NULL;
+        fiber_scheduler_switch_to(fiber);
+    }
+}
+
+void fiber_scheduler_yield_budget_init(
+        fiber_scheduler_yield_budget_t *yield_budget,
+        uint32_t check_interval) {
+    yield_budget->started_at_ms = clock_monotonic_int64_ms();
+    yield_budget->iterations = 0;
+    yield_budget->check_interval = check_interval;
+}
+
+bool fiber_scheduler_yield_budget_check(
+        fiber_scheduler_yield_budget_t *yield_budget) {
+    // The clock is read only once every check_interval iterations to keep the cost of the check negligible
+    if (likely(++yield_budget->iterations < yield_budget->check_interval)) {
+        return false;
+    }
+
+    yield_budget->iterations = 0;
+
+    if (clock_monotonic_int64_ms() - yield_budget->started_at_ms < FIBER_SCHEDULER_YIELD_BUDGET_MS) {
+        return false;
+    }
+
+    if (!fiber_scheduler_can_yield()) {
+        return false;
+    }
+
+    fiber_scheduler_yield();
+
+    yield_budget->started_at_ms = clock_monotonic_int64_ms();
+
+    return true;
+}
+
 void fiber_scheduler_switch_to(
         fiber_t *fiber) {
     fiber_t* previous_fiber;
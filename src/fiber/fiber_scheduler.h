@@ -10,6 +10,9 @@ extern "C" {
 #define FIBER_SCHEDULER_FIBER_NAME "scheduler"
 #define FIBER_SCHEDULER_COST_WARNINGS_LIMIT 10
 
+// Time a fiber running a long operation can keep the worker busy before yielding to let the other fibers run
+#define FIBER_SCHEDULER_YIELD_BUDGET_MS 2
+
 typedef void (fiber_scheduler_entrypoint_fp_t)(void *user_data);
 
 typedef struct fiber_scheduler_stack fiber_scheduler_stack_t;
@@ -19,6 +22,20 @@ struct fiber_scheduler_stack {
     int8_t size;
 };
 
+typedef struct fiber_scheduler_ready_queue fiber_scheduler_ready_queue_t;
+struct fiber_scheduler_ready_queue {
+    fiber_t *head;
+    fiber_t *tail;
+    uint32_t count;
+};
+
+typedef struct fiber_scheduler_yield_budget fiber_scheduler_yield_budget_t;
+struct fiber_scheduler_yield_budget {
+    int64_t started_at_ms;
+    uint32_t iterations;
+    uint32_t check_interval;
+};
+
 typedef struct fiber_scheduler_new_fiber_user_data fiber_scheduler_new_fiber_user_data_t;
 struct fiber_scheduler_new_fiber_user_data {
     fiber_scheduler_entrypoint_fp_t* caller_entrypoint_fp;
@@ -67,6 +84,21 @@ void fiber_scheduler_reset_error();
 
 void fiber_scheduler_terminate_current_fiber();
 
+bool fiber_scheduler_can_yield();
+
+void fiber_scheduler_yield();
+
+bool fiber_scheduler_has_ready_fibers();
+
+void fiber_scheduler_resume_ready_fibers();
+
+void fiber_scheduler_yield_budget_init(
+        fiber_scheduler_yield_budget_t *yield_budget,
+        uint32_t check_interval);
+
+bool fiber_scheduler_yield_budget_check(
+        fiber_scheduler_yield_budget_t *yield_budget);
+
 #ifdef __cplusplus
 }
 #endif
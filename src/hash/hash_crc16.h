@@ -0,0 +1,16 @@
+#ifndef CACHEGRAND_HASH_CRC16_H
+#define CACHEGRAND_HASH_CRC16_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint16_t hash_crc16(
+        const char* data,
+        size_t data_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_HASH_CRC16_H
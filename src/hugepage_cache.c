@@ -28,6 +28,27 @@
 
 hugepage_cache_t* hugepage_cache_per_numa_node = NULL;
 
+/**
+ * The hugepages can be freed by a thread running on a different numa node than the one that allocated them, to avoid
+ * handing out remote memory the hugepages are always returned to the cache of the numa node backing them.
+ */
+static uint32_t hugepage_cache_numa_node_index_by_hugepage_addr(
+        void* hugepage_addr) {
+    uint32_t numa_node_index;
+    uint32_t numa_node_count = utils_numa_node_configured_count();
+
+    if (likely(numa_node_count == 1)) {
+        return 0;
+    }
+
+    numa_node_index = utils_numa_node_index_by_memptr(hugepage_addr);
+    if (unlikely(numa_node_index >= numa_node_count)) {
+        numa_node_index = thread_get_current_numa_node_index();
+    }
+
+    return numa_node_index;
+}
+
 hugepage_cache_t* hugepage_cache_init() {
     hugepage_cache_t* hugepage_cache;
     int numa_node_count = utils_numa_node_configured_count();
@@ -37,6 +58,11 @@ hugepage_cache_t* hugepage_cache_init() {
         hugepage_cache = &hugepage_cache_per_numa_node[numa_node_index];
         hugepage_cache->numa_node_index = numa_node_index;
         hugepage_cache->free_queue = queue_mpmc_init();
+
+        // The single hugepages are kept in free_queue, the first queue of the runs is never used
+        for(int run_index = 1; run_index < HUGEPAGE_CACHE_RUN_HUGEPAGES_COUNT_MAX; run_index++) {
+            hugepage_cache->free_runs_queues[run_index] = queue_mpmc_init();
+        }
     }
 
     return hugepage_cache_per_numa_node;
@@ -53,6 +79,16 @@ void hugepage_cache_free() {
         }
 
         queue_mpmc_free(queue);
+
+        for(int run_index = 1; run_index < HUGEPAGE_CACHE_RUN_HUGEPAGES_COUNT_MAX; run_index++) {
+            void *run_addr;
+            queue = hugepage_cache_per_numa_node[numa_node_index].free_runs_queues[run_index];
+            while((run_addr = queue_mpmc_pop(queue)) != NULL) {
+                xalloc_hugepage_free(run_addr, HUGEPAGE_SIZE_2MB * (run_index + 1));
+            }
+
+            queue_mpmc_free(queue);
+        }
     }
 
     xalloc_free(hugepage_cache_per_numa_node);
@@ -66,7 +102,7 @@ void hugepage_cache_push(void* hugepage_addr) {
     assert(hugepage_cache_per_numa_node != NULL);
     assert(hugepage_addr != NULL);
 
-    uint32_t numa_node_index = thread_get_current_numa_node_index();
+    uint32_t numa_node_index = hugepage_cache_numa_node_index_by_hugepage_addr(hugepage_addr);
     hugepage_cache = &hugepage_cache_per_numa_node[numa_node_index];
 
     queue_mpmc_push(hugepage_cache->free_queue, hugepage_addr);
@@ -92,3 +128,70 @@ void* hugepage_cache_pop() {
 
     return hugepage_addr;
 }
+
+void hugepage_cache_push_run(
+        void* run_addr,
+        uint32_t hugepages_count) {
+    hugepage_cache_t* hugepage_cache;
+
+    assert(hugepage_cache_per_numa_node != NULL);
+    assert(run_addr != NULL);
+    assert(hugepages_count > 0);
+
+    if (hugepages_count == 1) {
+        hugepage_cache_push(run_addr);
+        return;
+    }
+
+    if (unlikely(hugepages_count > HUGEPAGE_CACHE_RUN_HUGEPAGES_COUNT_MAX)) {
+        xalloc_hugepage_free(run_addr, HUGEPAGE_SIZE_2MB * hugepages_count);
+        return;
+    }
+
+    uint32_t numa_node_index = hugepage_cache_numa_node_index_by_hugepage_addr(run_addr);
+    hugepage_cache = &hugepage_cache_per_numa_node[numa_node_index];
+
+    // The hugepages are accounted before the run is pushed, a concurrent pop can only make the count higher than the
+    // actual one and cause a run to be unmapped a bit earlier
+    uint32_t free_runs_hugepages_count = __sync_add_and_fetch(
+            &hugepage_cache->free_runs_hugepages_count,
+            hugepages_count);
+    if (unlikely(free_runs_hugepages_count > HUGEPAGE_CACHE_RUNS_HUGEPAGES_COUNT_BUDGET)) {
+        __sync_sub_and_fetch(&hugepage_cache->free_runs_hugepages_count, hugepages_count);
+        xalloc_hugepage_free(run_addr, HUGEPAGE_SIZE_2MB * hugepages_count);
+        return;
+    }
+
+    queue_mpmc_push(hugepage_cache->free_runs_queues[hugepages_count - 1], run_addr);
+}
+
+void* hugepage_cache_pop_run(
+        uint32_t hugepages_count) {
+    hugepage_cache_t* hugepage_cache;
+    void* run_addr = NULL;
+
+    assert(hugepage_cache_per_numa_node != NULL);
+    assert(hugepages_count > 0);
+
+    if (hugepages_count == 1) {
+        return hugepage_cache_pop();
+    }
+
+    if (likely(hugepages_count <= HUGEPAGE_CACHE_RUN_HUGEPAGES_COUNT_MAX)) {
+        uint32_t numa_node_index = thread_get_current_numa_node_index();
+        hugepage_cache = &hugepage_cache_per_numa_node[numa_node_index];
+
+        run_addr = queue_mpmc_pop(hugepage_cache->free_runs_queues[hugepages_count - 1]);
+
+        if (run_addr != NULL) {
+            __sync_sub_and_fetch(&hugepage_cache->free_runs_hugepages_count, hugepages_count);
+        }
+    }
+
+    // A single mapping is used for the whole run to have the hugepages contiguous
+    if (unlikely(run_addr == NULL)) {
+        run_addr = xalloc_hugepage_alloc(HUGEPAGE_SIZE_2MB * hugepages_count);
+    }
+
+    return run_addr;
+}
@@ -5,10 +5,20 @@
 extern "C" {
 #endif
 
+// The runs of contiguous hugepages, used for the objects too large to fit in a single hugepage, are cached per amount
+// of hugepages up to this size, the larger ones are mapped and unmapped every time
+#define HUGEPAGE_CACHE_RUN_HUGEPAGES_COUNT_MAX 32
+
+// Maximum amount of hugepages kept in the cached runs per numa node, the runs freed once the budget is exhausted are
+// unmapped as the cache is per length and a run cached for a length can't serve the others
+#define HUGEPAGE_CACHE_RUNS_HUGEPAGES_COUNT_BUDGET 128
+
 typedef struct hugepage_cache hugepage_cache_t;
 struct hugepage_cache {
     int numa_node_index;
     queue_mpmc_t *free_queue;
+    queue_mpmc_t *free_runs_queues[HUGEPAGE_CACHE_RUN_HUGEPAGES_COUNT_MAX];
+    uint32_volatile_t free_runs_hugepages_count;
 };
 
 hugepage_cache_t* hugepage_cache_init();
@@ -20,6 +30,13 @@ void hugepage_cache_push(
 
 void* hugepage_cache_pop();
 
+void hugepage_cache_push_run(
+        void* run_addr,
+        uint32_t hugepages_count);
+
+void* hugepage_cache_pop_run(
+        uint32_t hugepages_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -189,23 +189,25 @@ bool ffma_is_enabled() {
 
 uint8_t ffma_index_by_object_size(
         size_t object_size) {
-    assert(object_size <= FFMA_OBJECT_SIZE_MAX);
+    assert(object_size <= FFMA_OBJECT_SIZE_EXTENT_MAX);
 
     if (object_size < FFMA_OBJECT_SIZE_MIN) {
         object_size = FFMA_OBJECT_SIZE_MIN;
     }
 
-    // Round up the object_size to the next power of 2
-    size_t rounded_up_object_size = object_size;
-    rounded_up_object_size--;
-    rounded_up_object_size |= rounded_up_object_size >> 1;
-    rounded_up_object_size |= rounded_up_object_size >> 2;
-    rounded_up_object_size |= rounded_up_object_size >> 4;
-    rounded_up_object_size |= rounded_up_object_size >> 8;
-    rounded_up_object_size |= rounded_up_object_size >> 16;
-    rounded_up_object_size++;
+    // Up to 64 bytes the classes are 16 bytes apart
+    if (object_size <= FFMA_OBJECT_SIZE_64) {
+        return ((object_size + FFMA_OBJECT_SIZE_16 - 1) >> 4) - 1;
+    }
+
+    // From 64 bytes onwards each power of 2 is split in 4 classes, the position of the most significant bit provides
+    // the power of 2 and the two bits after it the quarter, the object_size is decremented by one to map the sizes
+    // matching a class exactly to it and not to the next one
+    size_t object_size_minus_one = object_size - 1;
+    uint8_t msb_index = 63 - __builtin_clzl(object_size_minus_one);
+    uint8_t quarter = (object_size_minus_one >> (msb_index - 2)) & 0x03;
 
-    return 32 - __builtin_clz(rounded_up_object_size) - (32 - __builtin_clz(FFMA_OBJECT_SIZE_MIN));
+    return 4 + ((msb_index - 6) << 2) + quarter;
 }
 
 ffma_t* ffma_thread_cache_get_ffma_by_size(
@@ -215,12 +217,11 @@ ffma_t* ffma_thread_cache_get_ffma_by_size(
 
 ffma_t* ffma_init(
         size_t object_size) {
-    assert(object_size <= FFMA_OBJECT_SIZE_MAX);
+    assert(object_size <= FFMA_OBJECT_SIZE_EXTENT_MAX);
 
     ffma_t* ffma = (ffma_t*)xalloc_alloc_zero(sizeof(ffma_t));
 
     ffma->object_size = object_size;
-    ffma->slots = double_linked_list_init();
     ffma->slices = double_linked_list_init();
     ffma->metrics.slices_inuse_count = 0;
     ffma->metrics.objects_inuse_count = 0;
@@ -236,14 +237,41 @@ ffma_t* ffma_init(
     return ffma;
 }
 
+void ffma_free_slots_from_other_threads(
+        ffma_t* ffma) {
+    queue_mpmc_node_t *node, *node_next;
+
+    // The objects freed by the other threads are returned to the slices, first the ones already fetched from the queue
+    // and then the ones still in it
+    for(int pass = 0; pass < 2; pass++) {
+        node = pass == 0
+                ? ffma->free_ffma_slots_from_other_threads
+                : queue_mpmc_pop_all(ffma->free_ffma_slots_queue_from_other_threads);
+
+        while(node != NULL) {
+            // The node is stored in the memory of the object, has to be read before the object is returned
+            node_next = node->next;
+            ffma_slice_t* ffma_slice = ffma_slice_from_memptr(node);
+            ffma_mem_free_hugepages_current_thread(ffma, ffma_slice, node);
+            node = node_next;
+        }
+    }
+
+    ffma->free_ffma_slots_from_other_threads = NULL;
+}
+
 bool ffma_free(
         ffma_t* ffma) {
     double_linked_list_item_t* item;
-    ffma_slot_t *ffma_slot;
 
     ffma->ffma_freed = true;
     MEMORY_FENCE_STORE();
 
+    // The objects owned by other threads freed via this allocator are passed back to them
+    ffma_mem_free_hugepages_different_thread_batches_flush(ffma);
+
+    ffma_free_slots_from_other_threads(ffma);
+
     // If there are objects in use they are most likely owned in use in some other threads and therefore the memory
     // can't be freed. The ownership of the operation fall upon the thread that will return the last object.
     // Not optimal, as it would be better to use a dying thread to free up memory instead of an in-use thread.
@@ -256,11 +284,8 @@ bool ffma_free(
         return false;
     }
 
-    // Clean up the free list
-    while((ffma_slot = queue_mpmc_pop(ffma->free_ffma_slots_queue_from_other_threads)) != NULL) {
-        ffma_slice_t* ffma_slice = ffma_slice_from_memptr(ffma_slot->data.memptr);
-        ffma_mem_free_hugepages_current_thread(ffma, ffma_slice, ffma_slot);
-    }
+    // Clean up the free list, objects might have been pushed in the meantime
+    ffma_free_slots_from_other_threads(ffma);
 
     // Can't iterate using the normal double_linked_list_iter_next as the double_linked_list_item is embedded in the
     // hugepage and the hugepage is going to get freed
@@ -272,7 +297,6 @@ bool ffma_free(
     }
 
     double_linked_list_free(ffma->slices);
-    double_linked_list_free(ffma->slots);
 
 #if FFMA_DEBUG_ALLOCS_FREES == 1
     // Do nothing really, it's to ensure that the memory will get always freed if the condition checked is not 1
@@ -292,11 +316,9 @@ size_t ffma_slice_calculate_usable_hugepage_size() {
     return usable_hugepage_size;
 }
 
-uint32_t ffma_slice_calculate_data_offset(
-        size_t usable_hugepage_size,
-        size_t object_size) {
-    uint32_t slots_count = (int)(usable_hugepage_size / (object_size + sizeof(ffma_slot_t)));
-    size_t data_offset = sizeof(ffma_slice_t) + (slots_count * sizeof(ffma_slot_t));
+uint32_t ffma_slice_calculate_data_offset() {
+    // The slice doesn't hold any per object metadata, the data start right after it aligned to the page size
+    size_t data_offset = sizeof(ffma_slice_t);
     data_offset += ffma_os_page_size - (data_offset % ffma_os_page_size);
 
     return data_offset;
@@ -318,9 +340,7 @@ ffma_slice_t* ffma_slice_init(
     ffma_slice_t* ffma_slice = (ffma_slice_t*)memptr;
 
     size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
-    uint32_t data_offset = ffma_slice_calculate_data_offset(
-            usable_hugepage_size,
-            ffma->object_size);
+    uint32_t data_offset = ffma_slice_calculate_data_offset();
     uint32_t slots_count = ffma_slice_calculate_slots_count(
             usable_hugepage_size,
             data_offset,
@@ -329,45 +349,14 @@ ffma_slice_t* ffma_slice_init(
     ffma_slice->data.ffma = ffma;
     ffma_slice->data.page_addr = memptr;
     ffma_slice->data.data_addr = (uintptr_t)memptr + data_offset;
+    ffma_slice->data.data_unused_addr = ffma_slice->data.data_addr;
+    ffma_slice->data.free_list = NULL;
     ffma_slice->data.metrics.objects_total_count = slots_count;
     ffma_slice->data.metrics.objects_inuse_count = 0;
-    ffma_slice->data.available = true;
 
     return ffma_slice;
 }
 
-void ffma_slice_add_slots_to_per_thread_metadata_slots(
-        ffma_t* ffma,
-        ffma_slice_t* ffma_slice) {
-    ffma_slot_t* ffma_slot;
-    for(uint32_t index = 0; index < ffma_slice->data.metrics.objects_total_count; index++) {
-        ffma_slot = &ffma_slice->data.slots[index];
-        ffma_slot->data.available = true;
-        ffma_slot->data.memptr = (void*)(ffma_slice->data.data_addr + (index * ffma->object_size));
-
-#if DEBUG == 1
-        ffma_slot->data.allocs = 0;
-        ffma_slot->data.frees = 0;
-#endif
-
-        double_linked_list_unshift_item(
-                ffma->slots,
-                &ffma_slot->double_linked_list_item);
-    }
-}
-
-void ffma_slice_remove_slots_from_per_thread_metadata_slots(
-        ffma_t* ffma,
-        ffma_slice_t* ffma_slice) {
-    ffma_slot_t* ffma_slot;
-    for(uint32_t index = 0; index < ffma_slice->data.metrics.objects_total_count; index++) {
-        ffma_slot = &ffma_slice->data.slots[index];
-        double_linked_list_remove_item(
-                ffma->slots,
-                &ffma_slot->double_linked_list_item);
-    }
-}
-
 ffma_slice_t* ffma_slice_from_memptr(
         void* memptr) {
     ffma_slice_t* ffma_slice = memptr - ((uintptr_t)memptr % HUGEPAGE_SIZE_2MB);
@@ -377,10 +366,6 @@ ffma_slice_t* ffma_slice_from_memptr(
 void ffma_slice_make_available(
         ffma_t* ffma,
         ffma_slice_t* ffma_slice) {
-    ffma_slice_remove_slots_from_per_thread_metadata_slots(
-            ffma,
-            ffma_slice);
-
     ffma->metrics.slices_inuse_count--;
 
     double_linked_list_remove_item(
@@ -388,32 +373,17 @@ void ffma_slice_make_available(
             &ffma_slice->double_linked_list_item);
 }
 
-ffma_slot_t* ffma_slot_from_memptr(
-        ffma_t* ffma,
-        ffma_slice_t* ffma_slice,
-        void* memptr) {
-    uint16_t object_index = ((uintptr_t)memptr - (uintptr_t)ffma_slice->data.data_addr) / ffma->object_size;
-    ffma_slot_t* slot = &ffma_slice->data.slots[object_index];
-
-    return slot;
-}
-
 void ffma_grow(
         ffma_t* ffma,
         void* memptr) {
-    // Initialize the new slice and set it to non-available because it's going to be immediately used
+    // Initialize the new slice and put it at the head as it's going to be immediately used
     ffma_slice_t* ffma_slice = ffma_slice_init(
             ffma,
             memptr);
-    ffma_slice->data.available = false;
 
-    // Add all the slots to the double linked list
-    ffma_slice_add_slots_to_per_thread_metadata_slots(
-            ffma,
-            ffma_slice);
     ffma->metrics.slices_inuse_count++;
 
-    double_linked_list_push_item(
+    double_linked_list_unshift_item(
             ffma->slices,
             &ffma_slice->double_linked_list_item);
 }
@@ -421,41 +391,40 @@ void ffma_grow(
 void* ffma_mem_alloc_hugepages(
         ffma_t* ffma,
         size_t size) {
-    assert(size <= FFMA_OBJECT_SIZE_MAX);
+    assert(size <= FFMA_OBJECT_SIZE_EXTENT_MAX);
 
-    double_linked_list_t* slots_list;
-    double_linked_list_item_t* slots_head_item;
-    ffma_slot_t* ffma_slot = NULL;
-    ffma_slice_t* ffma_slice = NULL;
+    void* memptr;
+    ffma_slice_t* ffma_slice;
 
-    // Always tries first to get a slow from the local cache, it's faster
-    slots_list = ffma->slots;
-    slots_head_item = slots_list->head;
-    ffma_slot = (ffma_slot_t*)slots_head_item;
+    // The slices with free objects are always at the head, if the head is full all the slices are full
+    ffma_slice = (ffma_slice_t*)ffma->slices->head;
 
-    // If it can't get the slot from the local cache tries to fetch if from the free list which is a bit slower as it
-    // involves atomic operations, on the other end it requires less operation to be prepared as e.g. it is already on
-    // the correct side of the slots double linked list
+    // If there are no free objects in the slices tries to fetch them from the free list, the objects are already
+    // accounted as in use and therefore don't have to be returned to their slices.
+    // The whole free list is fetched with a single atomic operation and then consumed locally.
     if (
-            (ffma_slot == NULL || ffma_slot->data.available == false) &&
-            (ffma_slot = queue_mpmc_pop(ffma->free_ffma_slots_queue_from_other_threads)) != NULL) {
-        assert(ffma_slot->data.memptr != NULL);
-        ffma_slot->data.available = false;
+            (ffma_slice == NULL ||
+             ffma_slice->data.metrics.objects_inuse_count == ffma_slice->data.metrics.objects_total_count) &&
+            (ffma->free_ffma_slots_from_other_threads != NULL ||
+             (ffma->free_ffma_slots_from_other_threads =
+                     queue_mpmc_pop_all(ffma->free_ffma_slots_queue_from_other_threads)) != NULL)) {
+        queue_mpmc_node_t *node = ffma->free_ffma_slots_from_other_threads;
+        ffma->free_ffma_slots_from_other_threads = node->next;
+        memptr = node;
 
 #if DEBUG == 1
-        ffma_slot->data.allocs++;
-
 #if defined(HAS_VALGRIND)
-        ffma_slice = ffma_slice_from_memptr(ffma_slot->data.memptr);
-        VALGRIND_MEMPOOL_ALLOC(ffma_slice->data.page_addr, ffma_slot->data.memptr, size);
+        ffma_slice = ffma_slice_from_memptr(memptr);
+        VALGRIND_MEMPOOL_ALLOC(ffma_slice->data.page_addr, memptr, size);
 #endif
 #endif
 
         // To keep the code and avoid convoluted ifs, the code returns here
-        return ffma_slot->data.memptr;
+        return memptr;
     }
 
-    if (ffma_slot == NULL || ffma_slot->data.available == false) {
+    if (ffma_slice == NULL ||
+        ffma_slice->data.metrics.objects_inuse_count == ffma_slice->data.metrics.objects_total_count) {
         void* hugepage_addr = hugepage_cache_pop();
 
 #if DEBUG == 1
@@ -473,31 +442,38 @@ void* ffma_mem_alloc_hugepages(
                 ffma,
                 hugepage_addr);
 
-        slots_head_item = slots_list->head;
-        ffma_slot = (ffma_slot_t*)slots_head_item;
+        ffma_slice = (ffma_slice_t*)ffma->slices->head;
     }
 
-    assert(ffma_slot->data.memptr != NULL);
-    assert(ffma_slot->data.allocs == ffma_slot->data.frees);
+    // The objects freed are reused first, as they are most likely still in the cache, and only when there are none the
+    // objects never used are handed out
+    if (ffma_slice->data.free_list != NULL) {
+        memptr = ffma_slice->data.free_list;
+        ffma_slice->data.free_list = *(void**)memptr;
+    } else {
+        memptr = (void*)ffma_slice->data.data_unused_addr;
+        ffma_slice->data.data_unused_addr += ffma->object_size;
+    }
 
-    double_linked_list_move_item_to_tail(slots_list, slots_head_item);
+    assert(memptr != NULL);
 
-    ffma_slice = ffma_slice_from_memptr(ffma_slot->data.memptr);
     ffma_slice->data.metrics.objects_inuse_count++;
     ffma->metrics.objects_inuse_count++;
 
-    ffma_slot->data.available = false;
-#if DEBUG == 1
-    ffma_slot->data.allocs++;
+    // If the slice is full it's moved to the tail to have the slices with free objects always at the head
+    if (ffma_slice->data.metrics.objects_inuse_count == ffma_slice->data.metrics.objects_total_count) {
+        double_linked_list_move_item_to_tail(ffma->slices, &ffma_slice->double_linked_list_item);
+    }
 
+#if DEBUG == 1
 #if defined(HAS_VALGRIND)
-    VALGRIND_MEMPOOL_ALLOC(ffma_slice->data.page_addr, ffma_slot->data.memptr, size);
+    VALGRIND_MEMPOOL_ALLOC(ffma_slice->data.page_addr, memptr, size);
 #endif
 #endif
 
     MEMORY_FENCE_STORE();
 
-    return ffma_slot->data.memptr;
+    return memptr;
 }
 
 void* ffma_mem_alloc_zero(
@@ -513,44 +489,57 @@ void* ffma_mem_alloc_zero(
 void ffma_mem_free_hugepages_current_thread(
         ffma_t* ffma,
         ffma_slice_t* ffma_slice,
-        ffma_slot_t* ffma_slot) {
-    bool can_free_ffma_slice = false;
-    // Update the availability and the metrics
+        void* memptr) {
+    bool ffma_slice_was_full =
+            ffma_slice->data.metrics.objects_inuse_count == ffma_slice->data.metrics.objects_total_count;
+
+    // Push the object on the free list of the slice, the pointer to the next free object is stored in the object itself
+    *(void**)memptr = ffma_slice->data.free_list;
+    ffma_slice->data.free_list = memptr;
+
+    // Update the metrics
     ffma_slice->data.metrics.objects_inuse_count--;
     ffma->metrics.objects_inuse_count--;
-    ffma_slot->data.available = true;
-
-    // Move the slot back to the head because it's available
-    double_linked_list_move_item_to_head(
-            ffma->slots,
-            &ffma_slot->double_linked_list_item);
 
-    // If the slice is empty and for the currently core there is already another empty slice, make the current
-    // slice available for other cores in the same numa node
+    // If the slice is empty return the hugepage, otherwise if it was full move it back to the head because now it has a
+    // free object
     if (ffma_slice->data.metrics.objects_inuse_count == 0) {
         ffma_slice_make_available(ffma, ffma_slice);
-        can_free_ffma_slice = true;
-    }
 
-    if (can_free_ffma_slice) {
 #if DEBUG == 1
 #if defined(HAS_VALGRIND)
         VALGRIND_DESTROY_MEMPOOL(ffma_slice->data.page_addr);
 #endif
 #endif
         hugepage_cache_push(ffma_slice->data.page_addr);
+    } else if (ffma_slice_was_full) {
+        double_linked_list_move_item_to_head(
+                ffma->slices,
+                &ffma_slice->double_linked_list_item);
     }
 
     MEMORY_FENCE_STORE();
 }
 
-void ffma_mem_free_hugepages_different_thread(
-        ffma_t* ffma,
-        ffma_slot_t* ffma_slot) {
-    if (unlikely(!queue_mpmc_push(ffma->free_ffma_slots_queue_from_other_threads, ffma_slot))) {
-        FATAL(TAG, "Can't pass the slot to free to the owning thread, unable to continue");
+void ffma_mem_free_hugepages_different_thread_batch_flush(
+        ffma_different_thread_free_batch_t *batch) {
+    ffma_t *ffma = batch->ffma;
+
+    if (batch->count == 0) {
+        return;
     }
 
+    queue_mpmc_push_nodes(
+            ffma->free_ffma_slots_queue_from_other_threads,
+            batch->head,
+            batch->tail,
+            batch->count);
+
+    batch->ffma = NULL;
+    batch->head = NULL;
+    batch->tail = NULL;
+    batch->count = 0;
+
     // To determine which thread can clean up the data the code simply checks if objects_inuse_count - length of the
     // free_ffma_slots_queue queue is equals to 0, if it is this thread can perform the final clean up.
     // The objects_inuse_count is not atomic but memory fences are in use
@@ -566,28 +555,78 @@ void ffma_mem_free_hugepages_different_thread(
     }
 }
 
+void ffma_mem_free_hugepages_different_thread_batches_flush(
+        ffma_t *ffma) {
+    for(int i = 0; i < FFMA_DIFFERENT_THREAD_FREE_BATCHES_COUNT; i++) {
+        ffma_mem_free_hugepages_different_thread_batch_flush(&ffma->different_thread_free_batches[i]);
+    }
+}
+
+void ffma_thread_cache_different_thread_batches_flush() {
+    ffma_t **thread_ffmas = ffma_thread_cache_get();
+
+    if (unlikely(!thread_ffmas)) {
+        return;
+    }
+
+    for(int i = 0; i < FFMA_PREDEFINED_OBJECT_SIZES_COUNT; i++) {
+        ffma_mem_free_hugepages_different_thread_batches_flush(thread_ffmas[i]);
+    }
+}
+
+void ffma_mem_free_hugepages_different_thread(
+        ffma_t* ffma,
+        void* memptr) {
+    // The batches are kept by the allocator of the current thread for the same object size, the batch is picked using
+    // the address of the owning allocator
+    ffma_t *ffma_current_thread = ffma_thread_cache_get_ffma_by_size(ffma->object_size);
+    uint32_t batch_index =
+            ((uintptr_t)ffma * 0x9E3779B97F4A7C15ULL) >> (64 - __builtin_ctz(FFMA_DIFFERENT_THREAD_FREE_BATCHES_COUNT));
+    ffma_different_thread_free_batch_t *batch = &ffma_current_thread->different_thread_free_batches[batch_index];
+
+    if (unlikely(batch->ffma != ffma)) {
+        ffma_mem_free_hugepages_different_thread_batch_flush(batch);
+        batch->ffma = ffma;
+    }
+
+    queue_mpmc_node_t *node = memptr;
+    node->data = memptr;
+    node->next = batch->head;
+    batch->head = node;
+    if (batch->tail == NULL) {
+        batch->tail = node;
+    }
+    batch->count++;
+
+    // If the owning thread has been terminated the batch is passed right away to let the last object returned trigger
+    // the clean-up of the allocator
+    MEMORY_FENCE_LOAD();
+    if (unlikely(batch->count == FFMA_DIFFERENT_THREAD_FREE_BATCH_SIZE || ffma->ffma_freed)) {
+        ffma_mem_free_hugepages_different_thread_batch_flush(batch);
+    }
+}
+
 void ffma_mem_free_hugepages(
         void* memptr) {
-    // Acquire the ffma_slice, the ffma, the ffma_slot and the thread_metadata related to the memory to be
-    // freed. The slice holds a pointer to the memory allocator so the slot will always be put back into the correct thread
+    // Acquire the ffma_slice and the ffma related to the memory to be freed. The slice holds a pointer to the memory
+    // allocator so the object will always be put back into the correct thread
     ffma_slice_t* ffma_slice =
             ffma_slice_from_memptr(memptr);
     ffma_t* ffma =
             ffma_slice->data.ffma;
-    ffma_slot_t* ffma_slot =
-            ffma_slot_from_memptr(
-                    ffma,
-                    ffma_slice,
-                    memptr);
 
-    // Test to catch double free
-    assert(ffma_slot->data.available == false);
+    // The large objects are not owned by any allocator, the hugepages can be returned right away by any thread
+    if (unlikely(ffma == NULL)) {
+        ffma_mem_free_large(ffma_slice);
+        return;
+    }
+
+    // Test to catch pointers not pointing to the beginning of an object
+    assert(((uintptr_t)memptr - ffma_slice->data.data_addr) % ffma->object_size == 0);
 
 #if DEBUG == 1
-    ffma_slot->data.frees++;
-
 #if defined(HAS_VALGRIND)
-    VALGRIND_MEMPOOL_FREE(ffma_slice->data.page_addr, ffma_slot->data.memptr);
+    VALGRIND_MEMPOOL_FREE(ffma_slice->data.page_addr, memptr);
 #endif
 #endif
 
@@ -597,10 +636,55 @@ void ffma_mem_free_hugepages(
             ffma->object_size);
     if (unlikely(is_different_thread)) {
         // This is slow path as it involves always atomic ops and potentially also a spinlock
-        ffma_mem_free_hugepages_different_thread(ffma, ffma_slot);
+        ffma_mem_free_hugepages_different_thread(ffma, memptr);
     } else {
-        ffma_mem_free_hugepages_current_thread(ffma, ffma_slice, ffma_slot);
+        ffma_mem_free_hugepages_current_thread(ffma, ffma_slice, memptr);
+    }
+}
+
+size_t ffma_mem_alloc_large_calculate_hugepages_count(
+        size_t size) {
+    size_t run_size = ffma_slice_calculate_data_offset() + size;
+    return (run_size + HUGEPAGE_SIZE_2MB - 1) / HUGEPAGE_SIZE_2MB;
+}
+
+void* ffma_mem_alloc_large(
+        size_t size) {
+    size_t hugepages_count = ffma_mem_alloc_large_calculate_hugepages_count(size);
+    void* run_addr = hugepage_cache_pop_run(hugepages_count);
+
+    if (!run_addr) {
+        LOG_E(TAG, "Unable to allocate %lu bytes of memory, no hugepages available", size);
+        return NULL;
     }
+
+    // The slice at the beginning of the run is used only to recognize the large object when it's freed, the object
+    // starts after it as for the objects allocated in the slices so ffma_slice_from_memptr works for both
+    ffma_slice_t* ffma_slice = (ffma_slice_t*)run_addr;
+    ffma_slice->data.ffma = NULL;
+    ffma_slice->data.page_addr = run_addr;
+    ffma_slice->data.data_addr = (uintptr_t)run_addr + ffma_slice_calculate_data_offset();
+    ffma_slice->data.data_unused_addr = (uintptr_t)run_addr + (hugepages_count * HUGEPAGE_SIZE_2MB);
+    ffma_slice->data.free_list = NULL;
+    ffma_slice->data.metrics.objects_total_count = 1;
+    ffma_slice->data.metrics.objects_inuse_count = 1;
+
+    MEMORY_FENCE_STORE();
+
+    return (void*)ffma_slice->data.data_addr;
+}
+
+void ffma_mem_free_large(
+        ffma_slice_t *ffma_slice) {
+    size_t hugepages_count =
+            (ffma_slice->data.data_unused_addr - (uintptr_t)ffma_slice->data.page_addr) / HUGEPAGE_SIZE_2MB;
+
+    assert(ffma_slice->data.ffma == NULL);
+    assert(ffma_slice->data.metrics.objects_inuse_count == 1);
+
+    ffma_slice->data.metrics.objects_inuse_count = 0;
+
+    hugepage_cache_push_run(ffma_slice->data.page_addr, hugepages_count);
 }
 
 void* ffma_mem_alloc_xalloc(
@@ -624,8 +708,12 @@ void* ffma_mem_alloc(
             ffma_thread_cache_set(ffma_thread_cache_init());
         }
 
-        ffma_t *ffma = ffma_thread_cache_get()[ffma_index_by_object_size(size)];
-        memptr = ffma_mem_alloc_hugepages(ffma, size);
+        if (unlikely(size > FFMA_OBJECT_SIZE_EXTENT_MAX)) {
+            memptr = ffma_mem_alloc_large(size);
+        } else {
+            ffma_t *ffma = ffma_thread_cache_get()[ffma_index_by_object_size(size)];
+            memptr = ffma_mem_alloc_hugepages(ffma, size);
+        }
     } else {
         memptr = ffma_mem_alloc_xalloc(size);
     }
@@ -13,44 +13,145 @@ extern "C" {
 #warning "the fast fixed memory allocator built with allocs/frees debugging, will cause issues with valgrind and might hide bugs, use with caution!"
 #endif
 
+// The sizes below 64 bytes are multiples of 16 bytes, from 64 bytes onwards each power of 2 is split in 4 classes
+// (quarter power of 2 sizes) to cap the memory wasted per object to 25%, all the sizes are multiple of 16 bytes to
+// keep the objects 16 bytes aligned. ffma_index_by_object_size relies on this layout to map a size to its class.
 #define FFMA_OBJECT_SIZE_16     0x00000010
 #define FFMA_OBJECT_SIZE_32     0x00000020
+#define FFMA_OBJECT_SIZE_48     0x00000030
 #define FFMA_OBJECT_SIZE_64     0x00000040
+#define FFMA_OBJECT_SIZE_80     0x00000050
+#define FFMA_OBJECT_SIZE_96     0x00000060
+#define FFMA_OBJECT_SIZE_112    0x00000070
 #define FFMA_OBJECT_SIZE_128    0x00000080
+#define FFMA_OBJECT_SIZE_160    0x000000a0
+#define FFMA_OBJECT_SIZE_192    0x000000c0
+#define FFMA_OBJECT_SIZE_224    0x000000e0
 #define FFMA_OBJECT_SIZE_256    0x00000100
+#define FFMA_OBJECT_SIZE_320    0x00000140
+#define FFMA_OBJECT_SIZE_384    0x00000180
+#define FFMA_OBJECT_SIZE_448    0x000001c0
 #define FFMA_OBJECT_SIZE_512    0x00000200
+#define FFMA_OBJECT_SIZE_640    0x00000280
+#define FFMA_OBJECT_SIZE_768    0x00000300
+#define FFMA_OBJECT_SIZE_896    0x00000380
 #define FFMA_OBJECT_SIZE_1024   0x00000400
+#define FFMA_OBJECT_SIZE_1280   0x00000500
+#define FFMA_OBJECT_SIZE_1536   0x00000600
+#define FFMA_OBJECT_SIZE_1792   0x00000700
 #define FFMA_OBJECT_SIZE_2048   0x00000800
+#define FFMA_OBJECT_SIZE_2560   0x00000a00
+#define FFMA_OBJECT_SIZE_3072   0x00000c00
+#define FFMA_OBJECT_SIZE_3584   0x00000e00
 #define FFMA_OBJECT_SIZE_4096   0x00001000
+#define FFMA_OBJECT_SIZE_5120   0x00001400
+#define FFMA_OBJECT_SIZE_6144   0x00001800
+#define FFMA_OBJECT_SIZE_7168   0x00001c00
 #define FFMA_OBJECT_SIZE_8192   0x00002000
+#define FFMA_OBJECT_SIZE_10240  0x00002800
+#define FFMA_OBJECT_SIZE_12288  0x00003000
+#define FFMA_OBJECT_SIZE_14336  0x00003800
 #define FFMA_OBJECT_SIZE_16384  0x00004000
+#define FFMA_OBJECT_SIZE_20480  0x00005000
+#define FFMA_OBJECT_SIZE_24576  0x00006000
+#define FFMA_OBJECT_SIZE_28672  0x00007000
 #define FFMA_OBJECT_SIZE_32768  0x00008000
+#define FFMA_OBJECT_SIZE_40960  0x0000a000
+#define FFMA_OBJECT_SIZE_49152  0x0000c000
+#define FFMA_OBJECT_SIZE_57344  0x0000e000
 #define FFMA_OBJECT_SIZE_65536  0x00010000
 
-#define FFMA_PREDEFINED_OBJECT_SIZES    FFMA_OBJECT_SIZE_16, FFMA_OBJECT_SIZE_32, FFMA_OBJECT_SIZE_64, \
-                                        FFMA_OBJECT_SIZE_128, FFMA_OBJECT_SIZE_256, FFMA_OBJECT_SIZE_512, \
-                                        FFMA_OBJECT_SIZE_1024, FFMA_OBJECT_SIZE_2048, FFMA_OBJECT_SIZE_4096, \
-                                        FFMA_OBJECT_SIZE_8192, FFMA_OBJECT_SIZE_16384, FFMA_OBJECT_SIZE_32768, \
-                                        FFMA_OBJECT_SIZE_65536
+// The extent classes, larger than FFMA_OBJECT_SIZE_MAX but smaller than an hugepage, follow the same quarter power of 2
+// layout. A slice holds only a few of these objects but it's still shared among them, a run of hugepages would instead
+// round up each object to a whole hugepage.
+#define FFMA_OBJECT_SIZE_81920   0x00014000
+#define FFMA_OBJECT_SIZE_98304   0x00018000
+#define FFMA_OBJECT_SIZE_114688  0x0001c000
+#define FFMA_OBJECT_SIZE_131072  0x00020000
+#define FFMA_OBJECT_SIZE_163840  0x00028000
+#define FFMA_OBJECT_SIZE_196608  0x00030000
+#define FFMA_OBJECT_SIZE_229376  0x00038000
+#define FFMA_OBJECT_SIZE_262144  0x00040000
+#define FFMA_OBJECT_SIZE_327680  0x00050000
+#define FFMA_OBJECT_SIZE_393216  0x00060000
+#define FFMA_OBJECT_SIZE_458752  0x00070000
+#define FFMA_OBJECT_SIZE_524288  0x00080000
+#define FFMA_OBJECT_SIZE_655360  0x000a0000
+#define FFMA_OBJECT_SIZE_786432  0x000c0000
+#define FFMA_OBJECT_SIZE_917504  0x000e0000
+#define FFMA_OBJECT_SIZE_1048576 0x00100000
+
+#define FFMA_PREDEFINED_OBJECT_SIZES    FFMA_OBJECT_SIZE_16, FFMA_OBJECT_SIZE_32, FFMA_OBJECT_SIZE_48, \
+                                        FFMA_OBJECT_SIZE_64, FFMA_OBJECT_SIZE_80, FFMA_OBJECT_SIZE_96, \
+                                        FFMA_OBJECT_SIZE_112, FFMA_OBJECT_SIZE_128, FFMA_OBJECT_SIZE_160, \
+                                        FFMA_OBJECT_SIZE_192, FFMA_OBJECT_SIZE_224, FFMA_OBJECT_SIZE_256, \
+                                        FFMA_OBJECT_SIZE_320, FFMA_OBJECT_SIZE_384, FFMA_OBJECT_SIZE_448, \
+                                        FFMA_OBJECT_SIZE_512, FFMA_OBJECT_SIZE_640, FFMA_OBJECT_SIZE_768, \
+                                        FFMA_OBJECT_SIZE_896, FFMA_OBJECT_SIZE_1024, FFMA_OBJECT_SIZE_1280, \
+                                        FFMA_OBJECT_SIZE_1536, FFMA_OBJECT_SIZE_1792, FFMA_OBJECT_SIZE_2048, \
+                                        FFMA_OBJECT_SIZE_2560, FFMA_OBJECT_SIZE_3072, FFMA_OBJECT_SIZE_3584, \
+                                        FFMA_OBJECT_SIZE_4096, FFMA_OBJECT_SIZE_5120, FFMA_OBJECT_SIZE_6144, \
+                                        FFMA_OBJECT_SIZE_7168, FFMA_OBJECT_SIZE_8192, FFMA_OBJECT_SIZE_10240, \
+                                        FFMA_OBJECT_SIZE_12288, FFMA_OBJECT_SIZE_14336, FFMA_OBJECT_SIZE_16384, \
+                                        FFMA_OBJECT_SIZE_20480, FFMA_OBJECT_SIZE_24576, FFMA_OBJECT_SIZE_28672, \
+                                        FFMA_OBJECT_SIZE_32768, FFMA_OBJECT_SIZE_40960, FFMA_OBJECT_SIZE_49152, \
+                                        FFMA_OBJECT_SIZE_57344, FFMA_OBJECT_SIZE_65536
+#define FFMA_PREDEFINED_EXTENT_OBJECT_SIZES     FFMA_OBJECT_SIZE_81920, FFMA_OBJECT_SIZE_98304, \
+                                                FFMA_OBJECT_SIZE_114688, FFMA_OBJECT_SIZE_131072, \
+                                                FFMA_OBJECT_SIZE_163840, FFMA_OBJECT_SIZE_196608, \
+                                                FFMA_OBJECT_SIZE_229376, FFMA_OBJECT_SIZE_262144, \
+                                                FFMA_OBJECT_SIZE_327680, FFMA_OBJECT_SIZE_393216, \
+                                                FFMA_OBJECT_SIZE_458752, FFMA_OBJECT_SIZE_524288, \
+                                                FFMA_OBJECT_SIZE_655360, FFMA_OBJECT_SIZE_786432, \
+                                                FFMA_OBJECT_SIZE_917504, FFMA_OBJECT_SIZE_1048576
 #define FFMA_PREDEFINED_OBJECT_SIZES_COUNT (sizeof(ffma_predefined_object_sizes) / sizeof(uint32_t))
 
 #define FFMA_OBJECT_SIZE_MIN    (((int[]){ FFMA_PREDEFINED_OBJECT_SIZES })[0])
-#define FFMA_OBJECT_SIZE_MAX    (((int[]){ FFMA_PREDEFINED_OBJECT_SIZES })[FFMA_PREDEFINED_OBJECT_SIZES_COUNT - 1])
+#define FFMA_OBJECT_SIZE_MAX    FFMA_OBJECT_SIZE_65536
 
-static const uint32_t ffma_predefined_object_sizes[] = { FFMA_PREDEFINED_OBJECT_SIZES };
+// The objects up to this size are allocated from the extent classes, the larger ones in a run of contiguous hugepages
+#define FFMA_OBJECT_SIZE_EXTENT_MAX FFMA_OBJECT_SIZE_1048576
+
+// The objects freed by a thread different from the one owning them are batched per owner, the batches are passed to
+// the owner when full, when the batch slot is needed for a different owner or when explicitly flushed (e.g. by the
+// worker timer). The amount of batches has to be a power of 2.
+#define FFMA_DIFFERENT_THREAD_FREE_BATCHES_COUNT 16
+#define FFMA_DIFFERENT_THREAD_FREE_BATCH_SIZE 64
+
+static const uint32_t ffma_predefined_object_sizes[] = {
+        FFMA_PREDEFINED_OBJECT_SIZES,
+        FFMA_PREDEFINED_EXTENT_OBJECT_SIZES
+};
 
 typedef struct fast_memory_allocator ffma_t;
+
+// The freed objects are linked together using their own memory as queue_mpmc_node_t, the smallest object size is large
+// enough to hold it, so the batch can be pushed to the owner without allocating memory
+typedef struct ffma_different_thread_free_batch ffma_different_thread_free_batch_t;
+struct ffma_different_thread_free_batch {
+    ffma_t *ffma;
+    queue_mpmc_node_t *head;
+    queue_mpmc_node_t *tail;
+    uint32_t count;
+};
+
 struct fast_memory_allocator {
-    // The slots and the slices are sorted per availability
-    double_linked_list_t *slots;
+    // The slices with free objects are kept at the head, the full ones at the tail
     double_linked_list_t *slices;
     queue_mpmc_t *free_ffma_slots_queue_from_other_threads;
 
+    // The objects freed by the other threads already fetched from the queue, they are fetched all together when the
+    // slices are full and used before fetching again from the queue
+    queue_mpmc_node_t *free_ffma_slots_from_other_threads;
+
+    // The batches of objects, owned by other threads, freed by the thread owning this allocator
+    ffma_different_thread_free_batch_t different_thread_free_batches[FFMA_DIFFERENT_THREAD_FREE_BATCHES_COUNT];
+
     // When the thread owning an instance of an allocator is terminated, other threads might still own some memory it
     // initialized and therefore some support is needed there.
     // When a thread sends back memory to a thread it has to check if it has been terminated and if yes, process the
     // free_ffma_slots_queue, free up the  slots, check if the slice owning the
-    // ffma_slot is then empty, and in case return the hugepage.
+    // object is then empty, and in case return the hugepage.
     // All these operations have to be carried out under the external_thread_lock spinlock to avoid contention.
     bool_volatile_t ffma_freed;
 
@@ -67,27 +168,19 @@ struct fast_memory_allocator {
 #endif
 };
 
-// It's necessary to use a union for ffma_slot_t and ffma_slice_t as the double_linked_list_item_t is being embedded
-// to avoid allocating an empty pointer to data wasting 8 bytes.
+// It's necessary to use a union for ffma_slice_t as the double_linked_list_item_t is being embedded to avoid allocating
+// an empty pointer to data wasting 8 bytes.
 // Currently, double_linked_list_item_t contains 3 pointers, prev, next and data, so a void* padding[2] is necessary to
 // do not overwrite prev and next, if the struct behind double_linked_list_item_t changes it's necessary to update the
-// data structures below.
-
-typedef union {
-    double_linked_list_item_t double_linked_list_item;
-    struct {
-        void *padding[2];
-        void *memptr;
-#if DEBUG==1
-        bool available:1;
-        int32_t allocs:31;
-        int32_t frees:31;
-#else
-        bool available;
-#endif
-    } data;
-} ffma_slot_t;
-
+// data structure below.
+//
+// The slice doesn't keep any metadata per object, the free objects are linked together storing in their own memory the
+// pointer to the next one (free_list) and the objects never used are handed out in order (data_unused_addr), so the
+// slice doesn't have to be initialized upfront and an allocation or a free only touch the slice and the object.
+//
+// The objects larger than FFMA_OBJECT_SIZE_EXTENT_MAX are allocated on their own in a run of contiguous hugepages, the run
+// starts with a slice without an allocator (ffma set to NULL) and data_unused_addr pointing to the end of the run, so
+// the free can find out the amount of hugepages to return to the hugepage cache.
 typedef union {
     double_linked_list_item_t double_linked_list_item;
     struct {
@@ -95,12 +188,12 @@ typedef union {
         ffma_t *ffma;
         void *page_addr;
         uintptr_t data_addr;
-        bool available;
+        uintptr_t data_unused_addr;
+        void *free_list;
         struct {
             uint32_t objects_total_count;
             uint32_t objects_inuse_count;
         } metrics;
-        ffma_slot_t slots[];
     } __attribute__((aligned(64))) data;
 } ffma_slice_t;
 
@@ -131,6 +224,9 @@ ffma_t* ffma_thread_cache_get_ffma_by_size(
 ffma_t* ffma_init(
         size_t object_size);
 
+void ffma_free_slots_from_other_threads(
+        ffma_t *ffma);
+
 bool ffma_free(
         ffma_t *ffma);
 
@@ -139,9 +235,7 @@ uint8_t ffma_index_by_object_size(
 
 size_t ffma_slice_calculate_usable_hugepage_size();
 
-uint32_t ffma_slice_calculate_data_offset(
-        size_t usable_hugepage_size,
-        size_t object_size);
+uint32_t ffma_slice_calculate_data_offset();
 
 uint32_t ffma_slice_calculate_slots_count(
         size_t usable_hugepage_size,
@@ -152,14 +246,6 @@ ffma_slice_t* ffma_slice_init(
         ffma_t *ffma,
         void *memptr);
 
-void ffma_slice_add_slots_to_per_thread_metadata_slots(
-        ffma_t *ffma,
-        ffma_slice_t *ffma_slice);
-
-void ffma_slice_remove_slots_from_per_thread_metadata_slots(
-        ffma_t *ffma,
-        ffma_slice_t *ffma_slice);
-
 ffma_slice_t* ffma_slice_from_memptr(
         void *memptr);
 
@@ -167,11 +253,6 @@ void ffma_slice_make_available(
         ffma_t *ffma,
         ffma_slice_t *ffma_slice);
 
-ffma_slot_t* ffma_slot_from_memptr(
-        ffma_t *ffma,
-        ffma_slice_t *ffma_slice,
-        void *memptr);
-
 void ffma_grow(
         ffma_t *ffma,
         void *memptr);
@@ -184,15 +265,33 @@ void* ffma_mem_alloc_hugepages(
 void ffma_mem_free_hugepages_current_thread(
         ffma_t* ffma,
         ffma_slice_t* ffma_slice,
-        ffma_slot_t* ffma_slot);
+        void *memptr);
+
+void ffma_mem_free_hugepages_different_thread_batch_flush(
+        ffma_different_thread_free_batch_t *batch);
+
+void ffma_mem_free_hugepages_different_thread_batches_flush(
+        ffma_t *ffma);
+
+void ffma_thread_cache_different_thread_batches_flush();
 
 void ffma_mem_free_hugepages_different_thread(
         ffma_t* ffma,
-        ffma_slot_t* ffma_slot);
+        void *memptr);
 
 void ffma_mem_free_hugepages(
         void *memptr);
 
+size_t ffma_mem_alloc_large_calculate_hugepages_count(
+        size_t size);
+
+__attribute__((malloc))
+void* ffma_mem_alloc_large(
+        size_t size);
+
+void ffma_mem_free_large(
+        ffma_slice_t *ffma_slice);
+
 __attribute__((malloc))
 void* ffma_mem_alloc_xalloc(
         size_t size);
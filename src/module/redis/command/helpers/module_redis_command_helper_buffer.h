@@ -0,0 +1,63 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_BUFFER_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The buffers used to load or serialize the data types (hashes, sets, etc.) spanning over multiple chunks, or to read
+// the values from a long string, can be bigger than the biggest object that ffma can allocate, in this case they are
+// allocated with xalloc. The size has to be passed back when the buffer is freed to pick the right allocator.
+
+static inline __attribute__((always_inline)) void *module_redis_command_helper_buffer_alloc(
+        size_t size) {
+    return likely(size <= FFMA_OBJECT_SIZE_MAX)
+        ? ffma_mem_alloc(size)
+        : xalloc_alloc(size);
+}
+
+static inline __attribute__((always_inline)) void *module_redis_command_helper_buffer_alloc_zero(
+        size_t size) {
+    return likely(size <= FFMA_OBJECT_SIZE_MAX)
+        ? ffma_mem_alloc_zero(size)
+        : xalloc_alloc_zero(size);
+}
+
+static inline __attribute__((always_inline)) void module_redis_command_helper_buffer_free(
+        void *buffer,
+        size_t size) {
+    if (likely(size <= FFMA_OBJECT_SIZE_MAX)) {
+        ffma_mem_free(buffer);
+    } else {
+        xalloc_free(buffer);
+    }
+}
+
+static inline __attribute__((always_inline)) void *module_redis_command_helper_buffer_realloc(
+        void *buffer,
+        size_t current_size,
+        size_t new_size,
+        bool zero_new_memory) {
+    void *new_buffer = module_redis_command_helper_buffer_alloc(new_size);
+
+    // Unlike ffma_mem_realloc, the buffer passed is always freed, even if the allocation fails
+    if (likely(new_buffer && buffer)) {
+        memcpy(new_buffer, buffer, MIN(current_size, new_size));
+    }
+
+    if (buffer) {
+        module_redis_command_helper_buffer_free(buffer, current_size);
+    }
+
+    if (likely(new_buffer) && zero_new_memory && new_size > current_size) {
+        memset((char*)new_buffer + current_size, 0, new_size - current_size);
+    }
+
+    return new_buffer;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_BUFFER_H
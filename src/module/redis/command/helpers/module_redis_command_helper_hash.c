@@ -0,0 +1,1227 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "hash/hash_fnv1.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+
+#include "module_redis_command_helper_buffer.h"
+#include "module_redis_command_helper_varint.h"
+#include "module_redis_command_helper_hash.h"
+
+#define TAG "module_redis_command_helper_hash"
+
+// The buffers of the nodes being changed are big enough to let a node grow over the max size by a few entries before
+// being split, they are reallocated only for the entries bigger than a node
+#define MODULE_REDIS_COMMAND_HELPER_HASH_NODE_BUFFER_SIZE (MODULE_REDIS_COMMAND_HELPER_HASH_NODE_MAX_SIZE * 2)
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_hash_field_hash(
+        char *field,
+        size_t field_length) {
+    return fnv_32_hash(field, field_length);
+}
+
+static inline __attribute__((always_inline)) size_t module_redis_command_helper_hash_entry_length(
+        size_t field_length,
+        size_t value_length) {
+    return sizeof(uint32_t) +
+        module_redis_command_helper_varint_length(field_length) + field_length +
+        module_redis_command_helper_varint_length(value_length) + value_length;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_hash_entry_read(
+        char *ptr,
+        char *end,
+        uint32_t *field_hash,
+        char **field,
+        uint32_t *field_length,
+        char **value,
+        uint32_t *value_length) {
+    if (unlikely(ptr + sizeof(uint32_t) > end)) {
+        return NULL;
+    }
+
+    memcpy(field_hash, ptr, sizeof(uint32_t));
+    ptr += sizeof(uint32_t);
+
+    if (unlikely((ptr = module_redis_command_helper_varint_read(ptr, end, field_length)) == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(ptr + *field_length > end)) {
+        return NULL;
+    }
+
+    *field = ptr;
+    ptr += *field_length;
+
+    if (unlikely((ptr = module_redis_command_helper_varint_read(ptr, end, value_length)) == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(ptr + *value_length > end)) {
+        return NULL;
+    }
+
+    *value = ptr;
+
+    return ptr + *value_length;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_hash_entry_write(
+        char *ptr,
+        uint32_t field_hash,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length) {
+    memcpy(ptr, &field_hash, sizeof(uint32_t));
+    ptr = module_redis_command_helper_varint_write(ptr + sizeof(uint32_t), field_length);
+    memcpy(ptr, field, field_length);
+    ptr = module_redis_command_helper_varint_write(ptr + field_length, value_length);
+    memcpy(ptr, value, value_length);
+
+    return ptr + value_length;
+}
+
+static inline __attribute__((always_inline)) uint32_t *module_redis_command_helper_hash_node_offsets(
+        char *data) {
+    return (uint32_t*)data;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_hash_node_entries(
+        char *data,
+        uint32_t count) {
+    return data + (sizeof(uint32_t) * count);
+}
+
+static inline __attribute__((always_inline)) bool module_redis_command_helper_hash_node_entry_read(
+        char *data,
+        size_t length,
+        uint32_t count,
+        uint32_t position,
+        uint32_t *field_hash,
+        char **field,
+        uint32_t *field_length,
+        char **value,
+        uint32_t *value_length) {
+    char *entries = module_redis_command_helper_hash_node_entries(data, count);
+    uint32_t offset = module_redis_command_helper_hash_node_offsets(data)[position];
+
+    if (unlikely(entries + offset >= data + length)) {
+        return false;
+    }
+
+    return module_redis_command_helper_hash_entry_read(
+            entries + offset,
+            data + length,
+            field_hash,
+            field,
+            field_length,
+            value,
+            value_length) != NULL;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_hash_node_entry_hash(
+        char *data,
+        uint32_t count,
+        uint32_t position) {
+    uint32_t field_hash;
+    memcpy(
+            &field_hash,
+            module_redis_command_helper_hash_node_entries(data, count) +
+                module_redis_command_helper_hash_node_offsets(data)[position],
+            sizeof(uint32_t));
+
+    return field_hash;
+}
+
+static uint32_t module_redis_command_helper_hash_node_lower_bound(
+        char *data,
+        uint32_t count,
+        uint32_t field_hash) {
+    uint32_t low = 0, high = count;
+
+    while(low < high) {
+        uint32_t mid = low + ((high - low) >> 1);
+        if (module_redis_command_helper_hash_node_entry_hash(data, count, mid) < field_hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static bool module_redis_command_helper_hash_node_search(
+        char *data,
+        size_t length,
+        uint32_t count,
+        uint32_t field_hash,
+        char *field,
+        size_t field_length,
+        uint32_t *position,
+        bool *found) {
+    uint32_t entry_field_hash, entry_field_length, entry_value_length;
+    char *entry_field, *entry_value;
+
+    *found = false;
+
+    if (unlikely(sizeof(uint32_t) * (size_t)count > length)) {
+        return false;
+    }
+
+    // The entries with the same hash follow each other, if the field is not found the position returned is after the
+    // last one of them which is where the field has to be inserted
+    for(
+            *position = module_redis_command_helper_hash_node_lower_bound(data, count, field_hash);
+            *position < count;
+            (*position)++) {
+        if (unlikely(!module_redis_command_helper_hash_node_entry_read(
+                data,
+                length,
+                count,
+                *position,
+                &entry_field_hash,
+                &entry_field,
+                &entry_field_length,
+                &entry_value,
+                &entry_value_length))) {
+            return false;
+        }
+
+        if (entry_field_hash != field_hash) {
+            break;
+        }
+
+        if (entry_field_length == field_length && memcmp(entry_field, field, field_length) == 0) {
+            *found = true;
+            break;
+        }
+    }
+
+    return true;
+}
+
+static void module_redis_command_helper_hash_node_entry_insert(
+        char *buffer,
+        uint32_t *count,
+        uint32_t *length,
+        uint32_t position,
+        uint32_t field_hash,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length) {
+    uint32_t *offsets = module_redis_command_helper_hash_node_offsets(buffer);
+    size_t entry_length = module_redis_command_helper_hash_entry_length(field_length, value_length);
+    size_t entries_length = *length - (sizeof(uint32_t) * *count);
+    uint32_t entry_offset = position < *count ? offsets[position] : entries_length;
+    char *entries = module_redis_command_helper_hash_node_entries(buffer, *count);
+    char *entries_new = module_redis_command_helper_hash_node_entries(buffer, *count + 1);
+
+    // The entries following the new one are moved further than the ones before it to make room for both the new offset
+    // and the new entry, they have to be moved first to avoid overwriting the others
+    memmove(
+            entries_new + entry_offset + entry_length,
+            entries + entry_offset,
+            entries_length - entry_offset);
+    memmove(entries_new, entries, entry_offset);
+
+    for(uint32_t index = *count; index > position; index--) {
+        offsets[index] = offsets[index - 1] + entry_length;
+    }
+    offsets[position] = entry_offset;
+
+    module_redis_command_helper_hash_entry_write(
+            entries_new + entry_offset,
+            field_hash,
+            field,
+            field_length,
+            value,
+            value_length);
+
+    (*count)++;
+    *length += sizeof(uint32_t) + entry_length;
+}
+
+static void module_redis_command_helper_hash_node_entry_remove(
+        char *buffer,
+        uint32_t *count,
+        uint32_t *length,
+        uint32_t position) {
+    uint32_t *offsets = module_redis_command_helper_hash_node_offsets(buffer);
+    size_t entries_length = *length - (sizeof(uint32_t) * *count);
+    uint32_t entry_offset = offsets[position];
+    size_t entry_length = (position + 1 < *count ? offsets[position + 1] : entries_length) - entry_offset;
+    char *entries = module_redis_command_helper_hash_node_entries(buffer, *count);
+    char *entries_new = module_redis_command_helper_hash_node_entries(buffer, *count - 1);
+
+    // The offsets have to be updated before moving the entries as the last offset gets overwritten
+    for(uint32_t index = position; index < *count - 1; index++) {
+        offsets[index] = offsets[index + 1] - entry_length;
+    }
+
+    memmove(entries_new, entries, entry_offset);
+    memmove(
+            entries_new + entry_offset,
+            entries + entry_offset + entry_length,
+            entries_length - entry_offset - entry_length);
+
+    (*count)--;
+    *length -= sizeof(uint32_t) + entry_length;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_hash_keys_bound(
+        uint32_t *keys,
+        uint32_t count,
+        uint32_t key,
+        bool upper) {
+    uint32_t low = 0, high = count;
+
+    while(low < high) {
+        uint32_t mid = low + ((high - low) >> 1);
+        if (keys[mid] < key || (upper && keys[mid] == key)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_hash_nodes_chunk_index(
+        module_redis_command_helper_hash_t *hash,
+        uint32_t node_index) {
+    return hash->editable
+        ? hash->nodes.chunk_indexes[node_index]
+        : 1 + node_index;
+}
+
+static void module_redis_command_helper_hash_nodes_arrays_free(
+        module_redis_command_helper_hash_nodes_t *nodes) {
+    if (nodes->keys) {
+        module_redis_command_helper_buffer_free(nodes->keys, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->counts) {
+        module_redis_command_helper_buffer_free(nodes->counts, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->chunk_indexes) {
+        module_redis_command_helper_buffer_free(nodes->chunk_indexes, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->lengths) {
+        module_redis_command_helper_buffer_free(nodes->lengths, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->buffers_sizes) {
+        module_redis_command_helper_buffer_free(nodes->buffers_sizes, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->buffers) {
+        module_redis_command_helper_buffer_free(nodes->buffers, sizeof(char*) * nodes->size);
+    }
+}
+
+static bool module_redis_command_helper_hash_nodes_arrays_alloc(
+        module_redis_command_helper_hash_nodes_t *nodes,
+        uint32_t size) {
+    nodes->size = size;
+    nodes->keys = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->counts = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->chunk_indexes = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->lengths = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->buffers_sizes = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->buffers = module_redis_command_helper_buffer_alloc_zero(sizeof(char*) * size);
+
+    if (unlikely(!nodes->keys || !nodes->counts || !nodes->chunk_indexes || !nodes->lengths ||
+            !nodes->buffers_sizes || !nodes->buffers)) {
+        module_redis_command_helper_hash_nodes_arrays_free(nodes);
+        memset(nodes, 0, sizeof(module_redis_command_helper_hash_nodes_t));
+        return false;
+    }
+
+    return true;
+}
+
+static void module_redis_command_helper_hash_nodes_free(
+        module_redis_command_helper_hash_nodes_t *nodes) {
+    if (nodes->buffers) {
+        for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+            if (nodes->buffers[node_index]) {
+                module_redis_command_helper_buffer_free(
+                        nodes->buffers[node_index],
+                        nodes->buffers_sizes[node_index]);
+            }
+        }
+    }
+
+    module_redis_command_helper_hash_nodes_arrays_free(nodes);
+
+    memset(nodes, 0, sizeof(module_redis_command_helper_hash_nodes_t));
+}
+
+static bool module_redis_command_helper_hash_nodes_reserve(
+        module_redis_command_helper_hash_nodes_t *nodes,
+        uint32_t count) {
+    module_redis_command_helper_hash_nodes_t nodes_new = { 0 };
+
+    if (likely(nodes->count + count <= nodes->size)) {
+        return true;
+    }
+
+    if (unlikely(nodes->count + count > MODULE_REDIS_COMMAND_HELPER_HASH_NODES_MAX)) {
+        return false;
+    }
+
+    // The new arrays are all allocated before touching the current ones, if an allocation fails the nodes are left
+    // untouched and will be freed by the cleanup
+    if (unlikely(!module_redis_command_helper_hash_nodes_arrays_alloc(
+            &nodes_new,
+            MIN(MAX(nodes->size * 2, nodes->count + count), MODULE_REDIS_COMMAND_HELPER_HASH_NODES_MAX)))) {
+        return false;
+    }
+
+    if (nodes->count > 0) {
+        memcpy(nodes_new.keys, nodes->keys, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.counts, nodes->counts, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.chunk_indexes, nodes->chunk_indexes, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.lengths, nodes->lengths, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.buffers_sizes, nodes->buffers_sizes, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.buffers, nodes->buffers, sizeof(char*) * nodes->count);
+    }
+    nodes_new.count = nodes->count;
+
+    // The buffers of the nodes have been moved to the new arrays, only the current arrays have to be freed
+    module_redis_command_helper_hash_nodes_arrays_free(nodes);
+    *nodes = nodes_new;
+
+    return true;
+}
+
+static bool module_redis_command_helper_hash_nodes_insert(
+        module_redis_command_helper_hash_nodes_t *nodes,
+        uint32_t node_index,
+        uint32_t key,
+        size_t buffer_size) {
+    // The new nodes are always backed by a buffer, they will be written out when the hash is serialized
+    char *buffer = module_redis_command_helper_buffer_alloc(buffer_size);
+    if (unlikely(!buffer)) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_command_helper_hash_nodes_reserve(nodes, 1))) {
+        module_redis_command_helper_buffer_free(buffer, buffer_size);
+        return false;
+    }
+
+    uint32_t move_count = nodes->count - node_index;
+    memmove(&nodes->keys[node_index + 1], &nodes->keys[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->counts[node_index + 1], &nodes->counts[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->chunk_indexes[node_index + 1], &nodes->chunk_indexes[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->lengths[node_index + 1], &nodes->lengths[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers_sizes[node_index + 1], &nodes->buffers_sizes[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers[node_index + 1], &nodes->buffers[node_index], sizeof(char*) * move_count);
+
+    nodes->keys[node_index] = key;
+    nodes->counts[node_index] = 0;
+    nodes->chunk_indexes[node_index] = 0;
+    nodes->lengths[node_index] = 0;
+    nodes->buffers_sizes[node_index] = buffer_size;
+    nodes->buffers[node_index] = buffer;
+    nodes->count++;
+
+    return true;
+}
+
+static void module_redis_command_helper_hash_nodes_remove(
+        module_redis_command_helper_hash_nodes_t *nodes,
+        uint32_t node_index) {
+    if (nodes->buffers[node_index]) {
+        module_redis_command_helper_buffer_free(nodes->buffers[node_index], nodes->buffers_sizes[node_index]);
+    }
+
+    uint32_t move_count = nodes->count - node_index - 1;
+    memmove(&nodes->keys[node_index], &nodes->keys[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->counts[node_index], &nodes->counts[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->chunk_indexes[node_index], &nodes->chunk_indexes[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->lengths[node_index], &nodes->lengths[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers_sizes[node_index], &nodes->buffers_sizes[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers[node_index], &nodes->buffers[node_index + 1], sizeof(char*) * move_count);
+
+    nodes->count--;
+    nodes->buffers[nodes->count] = NULL;
+}
+
+static bool module_redis_command_helper_hash_nodes_prepare_buffer(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        uint32_t node_index,
+        size_t length_extra) {
+    module_redis_command_helper_hash_nodes_t *nodes = &hash->nodes;
+    size_t length_required = nodes->lengths[node_index] + length_extra;
+
+    if (nodes->buffers[node_index]) {
+        if (likely(length_required <= nodes->buffers_sizes[node_index])) {
+            return true;
+        }
+
+        char *buffer = module_redis_command_helper_buffer_realloc(
+                nodes->buffers[node_index],
+                nodes->buffers_sizes[node_index],
+                length_required,
+                false);
+
+        // The buffer passed is freed even if the allocation fails, the node can't be used anymore but the hash is
+        // going to be thrown away by the caller
+        nodes->buffers[node_index] = buffer;
+        nodes->buffers_sizes[node_index] = length_required;
+
+        return buffer != NULL;
+    }
+
+    size_t buffer_size = MAX(length_required, MODULE_REDIS_COMMAND_HELPER_HASH_NODE_BUFFER_SIZE);
+    char *buffer = module_redis_command_helper_buffer_alloc(buffer_size);
+    if (unlikely(!buffer)) {
+        return false;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+            hash->chunk_sequence,
+            nodes->chunk_indexes[node_index]);
+    if (unlikely(!storage_db_chunk_read(db, chunk_info, buffer, 0, chunk_info->chunk_length))) {
+        module_redis_command_helper_buffer_free(buffer, buffer_size);
+        return false;
+    }
+
+    nodes->buffers[node_index] = buffer;
+    nodes->buffers_sizes[node_index] = buffer_size;
+    nodes->lengths[node_index] = chunk_info->chunk_length;
+
+    return true;
+}
+
+static bool module_redis_command_helper_hash_nodes_split(
+        module_redis_command_helper_hash_nodes_t *nodes,
+        uint32_t node_index) {
+    // The node is split in pieces filled up to half of the max size, as in a B+tree, so the next inserts will not
+    // cause another split straight away, the entries bigger than half of a node get a node on their own
+    while(nodes->lengths[node_index] > MODULE_REDIS_COMMAND_HELPER_HASH_NODE_MAX_SIZE &&
+          nodes->counts[node_index] > 1) {
+        char *buffer = nodes->buffers[node_index];
+        uint32_t count = nodes->counts[node_index];
+        uint32_t *offsets = module_redis_command_helper_hash_node_offsets(buffer);
+        size_t entries_length = nodes->lengths[node_index] - (sizeof(uint32_t) * count);
+        uint32_t split_position = 1;
+
+        while(split_position < count - 1 &&
+              (sizeof(uint32_t) * (split_position + 1)) + offsets[split_position + 1] <=
+                MODULE_REDIS_COMMAND_HELPER_HASH_NODE_MAX_SIZE / 2) {
+            split_position++;
+        }
+
+        uint32_t new_count = count - split_position;
+        uint32_t split_offset = offsets[split_position];
+        size_t new_length = (sizeof(uint32_t) * new_count) + (entries_length - split_offset);
+
+        if (unlikely(!module_redis_command_helper_hash_nodes_insert(
+                nodes,
+                node_index + 1,
+                module_redis_command_helper_hash_node_entry_hash(buffer, count, split_position),
+                MAX(new_length, MODULE_REDIS_COMMAND_HELPER_HASH_NODE_BUFFER_SIZE)))) {
+            return false;
+        }
+
+        char *new_buffer = nodes->buffers[node_index + 1];
+        uint32_t *new_offsets = module_redis_command_helper_hash_node_offsets(new_buffer);
+        for(uint32_t index = 0; index < new_count; index++) {
+            new_offsets[index] = offsets[split_position + index] - split_offset;
+        }
+
+        memcpy(
+                module_redis_command_helper_hash_node_entries(new_buffer, new_count),
+                module_redis_command_helper_hash_node_entries(buffer, count) + split_offset,
+                entries_length - split_offset);
+        nodes->counts[node_index + 1] = new_count;
+        nodes->lengths[node_index + 1] = new_length;
+
+        // The entries left in the node are moved back as there are fewer offsets
+        memmove(
+                module_redis_command_helper_hash_node_entries(buffer, split_position),
+                module_redis_command_helper_hash_node_entries(buffer, count),
+                split_offset);
+        nodes->counts[node_index] = split_position;
+        nodes->lengths[node_index] = (sizeof(uint32_t) * split_position) + split_offset;
+
+        node_index++;
+    }
+
+    return true;
+}
+
+static bool module_redis_command_helper_hash_node_load(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        uint32_t node_index,
+        module_redis_command_helper_hash_node_t *node) {
+    memset(node, 0, sizeof(module_redis_command_helper_hash_node_t));
+
+    if (unlikely(node_index >= hash->nodes.count)) {
+        return false;
+    }
+
+    node->count = hash->nodes.counts[node_index];
+
+    if (hash->editable && hash->nodes.buffers[node_index]) {
+        node->data = hash->nodes.buffers[node_index];
+        node->length = hash->nodes.lengths[node_index];
+        return true;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+            hash->chunk_sequence,
+            module_redis_command_helper_hash_nodes_chunk_index(hash, node_index));
+
+    node->data = storage_db_get_chunk_data(db, chunk_info, &node->data_allocated);
+    if (unlikely(!node->data)) {
+        return false;
+    }
+
+    node->length = chunk_info->chunk_length;
+
+    if (unlikely(sizeof(uint32_t) * (size_t)node->count > node->length)) {
+        return false;
+    }
+
+    return true;
+}
+
+static void module_redis_command_helper_hash_node_cleanup(
+        module_redis_command_helper_hash_node_t *node) {
+    if (node->data_allocated) {
+        ffma_mem_free(node->data);
+    }
+
+    node->data = NULL;
+    node->data_allocated = false;
+}
+
+static bool module_redis_command_helper_hash_locate(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        uint32_t field_hash,
+        char *field,
+        size_t field_length,
+        module_redis_command_helper_hash_node_t *node,
+        uint32_t *node_index,
+        uint32_t *position,
+        bool *found) {
+    module_redis_command_helper_hash_nodes_t *nodes = &hash->nodes;
+    uint32_t node_index_start = module_redis_command_helper_hash_keys_bound(
+            nodes->keys,
+            nodes->count,
+            field_hash,
+            false);
+
+    *found = false;
+    *node_index = 0;
+    *position = 0;
+
+    // The key of a node is the hash of its first entry, the entries with the same hash might be spread over more nodes
+    // when a node is split so all the nodes with a key lower or equal to the hash have to be checked starting from the
+    // one before the first having the key equal to the hash. If the field is not found the last node checked and the
+    // position returned are where the field has to be inserted.
+    for(
+            uint32_t node_index_check = node_index_start > 0 ? node_index_start - 1 : 0;
+            node_index_check < nodes->count && nodes->keys[node_index_check] <= field_hash;
+            node_index_check++) {
+        module_redis_command_helper_hash_node_cleanup(node);
+
+        if (unlikely(!module_redis_command_helper_hash_node_load(db, hash, node_index_check, node))) {
+            return false;
+        }
+
+        if (unlikely(!module_redis_command_helper_hash_node_search(
+                node->data,
+                node->length,
+                node->count,
+                field_hash,
+                field,
+                field_length,
+                position,
+                found))) {
+            return false;
+        }
+
+        *node_index = node_index_check;
+
+        if (*found) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_hash_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_hash_t *hash) {
+    module_redis_command_helper_hash_header_t *header;
+    storage_db_chunk_sequence_t *chunk_sequence = entry_index->value;
+
+    memset(hash, 0, sizeof(module_redis_command_helper_hash_t));
+
+    if (unlikely(chunk_sequence->count < 1)) {
+        return false;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, 0);
+    if (unlikely(chunk_info->chunk_length < sizeof(module_redis_command_helper_hash_header_t))) {
+        return false;
+    }
+
+    hash->header_data = storage_db_get_chunk_data(db, chunk_info, &hash->header_data_allocated);
+    if (unlikely(!hash->header_data)) {
+        return false;
+    }
+
+    header = (module_redis_command_helper_hash_header_t*)hash->header_data;
+
+    if (unlikely(chunk_sequence->count != 1 + header->nodes_count ||
+            chunk_info->chunk_length != sizeof(module_redis_command_helper_hash_header_t) +
+                ((sizeof(uint32_t) * 2) * header->nodes_count))) {
+        module_redis_command_helper_hash_cleanup(hash);
+        return false;
+    }
+
+    hash->chunk_sequence = chunk_sequence;
+    hash->count = header->count;
+
+    // The arrays of the header are used in place until the hash is edited
+    hash->nodes.keys = (uint32_t*)(hash->header_data + sizeof(module_redis_command_helper_hash_header_t));
+    hash->nodes.counts = hash->nodes.keys + header->nodes_count;
+    hash->nodes.count = header->nodes_count;
+
+    return true;
+}
+
+void module_redis_command_helper_hash_init(
+        module_redis_command_helper_hash_t *hash) {
+    memset(hash, 0, sizeof(module_redis_command_helper_hash_t));
+
+    hash->editable = true;
+}
+
+bool module_redis_command_helper_hash_edit_begin(
+        module_redis_command_helper_hash_t *hash) {
+    module_redis_command_helper_hash_nodes_t nodes_edit = { 0 };
+    module_redis_command_helper_hash_nodes_t *nodes = &hash->nodes;
+
+    if (hash->editable) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_hash_nodes_arrays_alloc(
+            &nodes_edit,
+            MIN(nodes->count + 16, MODULE_REDIS_COMMAND_HELPER_HASH_NODES_MAX)))) {
+        return false;
+    }
+
+    nodes_edit.count = nodes->count;
+
+    for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+        nodes_edit.keys[node_index] = nodes->keys[node_index];
+        nodes_edit.counts[node_index] = nodes->counts[node_index];
+        nodes_edit.chunk_indexes[node_index] = 1 + node_index;
+        nodes_edit.lengths[node_index] = storage_db_chunk_sequence_get(
+                hash->chunk_sequence,
+                nodes_edit.chunk_indexes[node_index])->chunk_length;
+        nodes_edit.buffers_sizes[node_index] = 0;
+    }
+
+    // The lookup node might point to the data of a node that is going to be edited
+    module_redis_command_helper_hash_node_cleanup(&hash->lookup_node);
+
+    hash->nodes = nodes_edit;
+    hash->editable = true;
+
+    return true;
+}
+
+void module_redis_command_helper_hash_cleanup(
+        module_redis_command_helper_hash_t *hash) {
+    module_redis_command_helper_hash_node_cleanup(&hash->lookup_node);
+
+    if (hash->editable) {
+        module_redis_command_helper_hash_nodes_free(&hash->nodes);
+    }
+
+    if (hash->header_data_allocated) {
+        ffma_mem_free(hash->header_data);
+    }
+
+    memset(hash, 0, sizeof(module_redis_command_helper_hash_t));
+}
+
+bool module_redis_command_helper_hash_get(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        char *field,
+        size_t field_length,
+        char **value,
+        size_t *value_length,
+        bool *found) {
+    uint32_t node_index, position;
+    uint32_t entry_field_hash, entry_field_length, entry_value_length;
+    char *entry_field;
+
+    // The value returned points into the data of the lookup node, it's valid until the next lookup or change
+    if (unlikely(!module_redis_command_helper_hash_locate(
+            db,
+            hash,
+            module_redis_command_helper_hash_field_hash(field, field_length),
+            field,
+            field_length,
+            &hash->lookup_node,
+            &node_index,
+            &position,
+            found))) {
+        return false;
+    }
+
+    if (!*found) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_hash_node_entry_read(
+            hash->lookup_node.data,
+            hash->lookup_node.length,
+            hash->lookup_node.count,
+            position,
+            &entry_field_hash,
+            &entry_field,
+            &entry_field_length,
+            value,
+            &entry_value_length))) {
+        return false;
+    }
+
+    *value_length = entry_value_length;
+
+    return true;
+}
+
+bool module_redis_command_helper_hash_iter_init(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        uint32_t field_hash_start,
+        module_redis_command_helper_hash_iter_t *iter) {
+    memset(iter, 0, sizeof(module_redis_command_helper_hash_iter_t));
+    iter->hash = hash;
+
+    if (hash->nodes.count == 0) {
+        return true;
+    }
+
+    iter->node_index = module_redis_command_helper_hash_keys_bound(
+            hash->nodes.keys,
+            hash->nodes.count,
+            field_hash_start,
+            false);
+    iter->node_index = iter->node_index > 0 ? iter->node_index - 1 : 0;
+
+    if (unlikely(!module_redis_command_helper_hash_node_load(db, hash, iter->node_index, &iter->node))) {
+        return false;
+    }
+
+    iter->position = module_redis_command_helper_hash_node_lower_bound(
+            iter->node.data,
+            iter->node.count,
+            field_hash_start);
+
+    return true;
+}
+
+bool module_redis_command_helper_hash_iter_next(
+        storage_db_t *db,
+        module_redis_command_helper_hash_iter_t *iter,
+        uint32_t *field_hash,
+        char **field,
+        size_t *field_length,
+        char **value,
+        size_t *value_length) {
+    uint32_t entry_field_hash, entry_field_length, entry_value_length;
+
+    while(iter->node.data == NULL || iter->position >= iter->node.count) {
+        if (iter->node.data) {
+            module_redis_command_helper_hash_node_cleanup(&iter->node);
+            iter->node_index++;
+        }
+
+        if (iter->node_index >= iter->hash->nodes.count) {
+            return false;
+        }
+
+        if (unlikely(!module_redis_command_helper_hash_node_load(db, iter->hash, iter->node_index, &iter->node))) {
+            return false;
+        }
+
+        iter->position = 0;
+    }
+
+    if (unlikely(!module_redis_command_helper_hash_node_entry_read(
+            iter->node.data,
+            iter->node.length,
+            iter->node.count,
+            iter->position,
+            &entry_field_hash,
+            field,
+            &entry_field_length,
+            value,
+            &entry_value_length))) {
+        return false;
+    }
+
+    if (field_hash) {
+        *field_hash = entry_field_hash;
+    }
+
+    *field_length = entry_field_length;
+    *value_length = entry_value_length;
+    iter->position++;
+
+    return true;
+}
+
+void module_redis_command_helper_hash_iter_cleanup(
+        module_redis_command_helper_hash_iter_t *iter) {
+    module_redis_command_helper_hash_node_cleanup(&iter->node);
+}
+
+bool module_redis_command_helper_hash_set(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length,
+        bool *inserted) {
+    bool found;
+    uint32_t node_index, position;
+    module_redis_command_helper_hash_node_t node = { 0 };
+    module_redis_command_helper_hash_nodes_t *nodes = &hash->nodes;
+    uint32_t field_hash = module_redis_command_helper_hash_field_hash(field, field_length);
+    size_t entry_length = module_redis_command_helper_hash_entry_length(field_length, value_length);
+
+    assert(hash->editable);
+
+    *inserted = false;
+
+    if (unlikely(!module_redis_command_helper_hash_entry_fits(field_length, value_length))) {
+        return false;
+    }
+
+    // The lookup node might point to the buffer of the node being changed
+    module_redis_command_helper_hash_node_cleanup(&hash->lookup_node);
+
+    if (nodes->count == 0) {
+        if (unlikely(!module_redis_command_helper_hash_nodes_insert(
+                nodes,
+                0,
+                field_hash,
+                MODULE_REDIS_COMMAND_HELPER_HASH_NODE_BUFFER_SIZE))) {
+            return false;
+        }
+    }
+
+    bool result = module_redis_command_helper_hash_locate(
+            db,
+            hash,
+            field_hash,
+            field,
+            field_length,
+            &node,
+            &node_index,
+            &position,
+            &found);
+    module_redis_command_helper_hash_node_cleanup(&node);
+
+    if (unlikely(!result)) {
+        return false;
+    }
+
+    // Only the node containing the field is copied to be modified
+    if (unlikely(!module_redis_command_helper_hash_nodes_prepare_buffer(
+            db,
+            hash,
+            node_index,
+            sizeof(uint32_t) + entry_length))) {
+        return false;
+    }
+
+    if (found) {
+        module_redis_command_helper_hash_node_entry_remove(
+                nodes->buffers[node_index],
+                &nodes->counts[node_index],
+                &nodes->lengths[node_index],
+                position);
+    }
+
+    module_redis_command_helper_hash_node_entry_insert(
+            nodes->buffers[node_index],
+            &nodes->counts[node_index],
+            &nodes->lengths[node_index],
+            position,
+            field_hash,
+            field,
+            field_length,
+            value,
+            value_length);
+
+    if (position == 0) {
+        nodes->keys[node_index] = field_hash;
+    }
+
+    if (!found) {
+        hash->count++;
+        *inserted = true;
+    }
+
+    if (nodes->lengths[node_index] > MODULE_REDIS_COMMAND_HELPER_HASH_NODE_MAX_SIZE) {
+        return module_redis_command_helper_hash_nodes_split(nodes, node_index);
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_hash_delete(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        char *field,
+        size_t field_length,
+        bool *deleted) {
+    uint32_t node_index, position;
+    module_redis_command_helper_hash_node_t node = { 0 };
+    module_redis_command_helper_hash_nodes_t *nodes = &hash->nodes;
+
+    assert(hash->editable);
+
+    // The lookup node might point to the buffer of the node being changed
+    module_redis_command_helper_hash_node_cleanup(&hash->lookup_node);
+
+    bool result = module_redis_command_helper_hash_locate(
+            db,
+            hash,
+            module_redis_command_helper_hash_field_hash(field, field_length),
+            field,
+            field_length,
+            &node,
+            &node_index,
+            &position,
+            deleted);
+    module_redis_command_helper_hash_node_cleanup(&node);
+
+    if (unlikely(!result)) {
+        return false;
+    }
+
+    if (!*deleted) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_hash_nodes_prepare_buffer(db, hash, node_index, 0))) {
+        return false;
+    }
+
+    module_redis_command_helper_hash_node_entry_remove(
+            nodes->buffers[node_index],
+            &nodes->counts[node_index],
+            &nodes->lengths[node_index],
+            position);
+
+    if (nodes->counts[node_index] == 0) {
+        module_redis_command_helper_hash_nodes_remove(nodes, node_index);
+    } else if (position == 0) {
+        nodes->keys[node_index] = module_redis_command_helper_hash_node_entry_hash(
+                nodes->buffers[node_index],
+                nodes->counts[node_index],
+                0);
+    }
+
+    hash->count--;
+
+    return true;
+}
+
+storage_db_chunk_sequence_t *module_redis_command_helper_hash_serialize(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash) {
+    bool result = false;
+    char *header_data = NULL;
+    storage_db_chunk_index_t chunk_index = 0;
+    storage_db_chunk_sequence_t *chunk_sequence;
+    module_redis_command_helper_hash_nodes_t *nodes = &hash->nodes;
+    size_t header_length = sizeof(module_redis_command_helper_hash_header_t) +
+            ((sizeof(uint32_t) * 2) * nodes->count);
+
+    assert(hash->editable);
+
+    if (unlikely(nodes->count > MODULE_REDIS_COMMAND_HELPER_HASH_NODES_MAX)) {
+        return NULL;
+    }
+
+    chunk_sequence = storage_db_chunk_sequence_new(1 + nodes->count);
+    if (unlikely(!chunk_sequence)) {
+        return NULL;
+    }
+
+    header_data = module_redis_command_helper_buffer_alloc(header_length);
+    if (unlikely(!header_data)) {
+        goto end;
+    }
+
+    module_redis_command_helper_hash_header_t *header = (module_redis_command_helper_hash_header_t*)header_data;
+    header->nodes_count = nodes->count;
+    header->reserved = 0;
+    header->count = hash->count;
+
+    uint32_t *keys = (uint32_t*)(header_data + sizeof(module_redis_command_helper_hash_header_t));
+    if (nodes->count > 0) {
+        memcpy(keys, nodes->keys, sizeof(uint32_t) * nodes->count);
+        memcpy(keys + nodes->count, nodes->counts, sizeof(uint32_t) * nodes->count);
+    }
+
+    storage_db_chunk_info_t *chunk_info_header = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+    if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info_header, header_length))) {
+        goto end;
+    }
+
+    chunk_index++;
+    chunk_sequence->size += header_length;
+
+    if (unlikely(!storage_db_chunk_write(db, chunk_info_header, 0, header_data, header_length))) {
+        goto end;
+    }
+
+    for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (nodes->buffers[node_index]) {
+            if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info, nodes->lengths[node_index]))) {
+                goto end;
+            }
+
+            chunk_index++;
+
+            if (unlikely(!storage_db_chunk_write(
+                    db,
+                    chunk_info,
+                    0,
+                    nodes->buffers[node_index],
+                    nodes->lengths[node_index]))) {
+                goto end;
+            }
+        } else {
+            // The nodes not touched by the update are shared with the current version of the hash
+            if (unlikely(!storage_db_chunk_data_share(
+                    db,
+                    storage_db_chunk_sequence_get(hash->chunk_sequence, nodes->chunk_indexes[node_index]),
+                    chunk_info))) {
+                goto end;
+            }
+
+            chunk_index++;
+        }
+
+        chunk_sequence->size += chunk_info->chunk_length;
+    }
+
+    assert(chunk_index == chunk_sequence->count);
+
+    result = true;
+
+end:
+    if (header_data) {
+        module_redis_command_helper_buffer_free(header_data, header_length);
+    }
+
+    if (unlikely(!result)) {
+        // Only the chunks already initialized have to be freed
+        chunk_sequence->count = chunk_index;
+        storage_db_chunk_sequence_free(db, chunk_sequence);
+        ffma_mem_free(chunk_sequence);
+        chunk_sequence = NULL;
+    }
+
+    return chunk_sequence;
+}
+
+char *module_redis_command_helper_hash_long_string_read(
+        storage_db_t *db,
+        module_redis_long_string_t *long_string) {
+    size_t buffer_offset = 0;
+    storage_db_chunk_sequence_t *chunk_sequence = long_string->chunk_sequence;
+    char *buffer = module_redis_command_helper_buffer_alloc(MAX(chunk_sequence->size, 1));
+
+    if (unlikely(!buffer)) {
+        return NULL;
+    }
+
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (unlikely(!storage_db_chunk_read(
+                db,
+                chunk_info,
+                buffer + buffer_offset,
+                0,
+                chunk_info->chunk_length))) {
+            module_redis_command_helper_buffer_free(buffer, MAX(chunk_sequence->size, 1));
+            return NULL;
+        }
+
+        buffer_offset += chunk_info->chunk_length;
+    }
+
+    return buffer;
+}
@@ -0,0 +1,157 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HASH_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The hashes are stored as a sequence of nodes mapped on the chunks of the value of the entry index (so they work
+// transparently with every storage backend)
+//   chunk 0 (header) | chunk 1 (node 0) | chunk 2 (node 1) | ... | chunk n (node n - 1)
+// the header contains the number of fields of the hash followed by the first hash and the amount of entries of every
+// node packed in arrays
+//   header | nodes_keys[n] | nodes_counts[n]
+//
+// The entries are distributed in the nodes by the hash of their field and are kept ordered by hash, each entry is the
+// hash of the field followed by the field and the value prefixed by their length encoded as varint. The nodes start
+// with the offsets of their entries so a lookup is a binary search over the keys of the nodes followed by a binary
+// search over the offsets of the entries of a single node
+//   node | entries_offsets[count] | entries
+//
+// As for the lists and the sorted sets the nodes are immutable, an update builds a new chunk sequence with the new
+// version of the nodes changed and shares the data of all the other nodes with the previous version of the hash, so
+// HSET, HDEL or HINCRBY copy only the nodes containing the fields being changed and never the whole hash.
+#define MODULE_REDIS_COMMAND_HELPER_HASH_NODE_MAX_SIZE (16 * 1024)
+#define MODULE_REDIS_COMMAND_HELPER_HASH_NODES_MAX \
+    ((FFMA_OBJECT_SIZE_MAX / sizeof(storage_db_chunk_info_t)) - 1)
+// An entry bigger than the size of a node gets a dedicated node, which has still to fit in a chunk together with its
+// offset, the hash of the field and the lengths of the field and of the value, up to 3 bytes each as varint
+#define MODULE_REDIS_COMMAND_HELPER_HASH_ENTRY_MAX_LENGTH \
+    (STORAGE_DB_CHUNK_MAX_SIZE - (sizeof(uint32_t) * 2) - 6)
+
+typedef struct module_redis_command_helper_hash_header module_redis_command_helper_hash_header_t;
+struct module_redis_command_helper_hash_header {
+    uint32_t nodes_count;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+// When the hash is being edited the arrays are copied out of the header and the nodes being changed get their own
+// buffer, the chunk indexes point to the chunks of the current version of the nodes not changed (0, the header, for
+// the new nodes).
+typedef struct module_redis_command_helper_hash_nodes module_redis_command_helper_hash_nodes_t;
+struct module_redis_command_helper_hash_nodes {
+    uint32_t *keys;
+    uint32_t *counts;
+    uint32_t *chunk_indexes;
+    uint32_t *lengths;
+    uint32_t *buffers_sizes;
+    char **buffers;
+    uint32_t count;
+    uint32_t size;
+};
+
+typedef struct module_redis_command_helper_hash_node module_redis_command_helper_hash_node_t;
+struct module_redis_command_helper_hash_node {
+    char *data;
+    size_t length;
+    bool data_allocated;
+    uint32_t count;
+};
+
+typedef struct module_redis_command_helper_hash module_redis_command_helper_hash_t;
+struct module_redis_command_helper_hash {
+    storage_db_chunk_sequence_t *chunk_sequence;
+    char *header_data;
+    bool header_data_allocated;
+    bool editable;
+    uint64_t count;
+    module_redis_command_helper_hash_nodes_t nodes;
+    // The node of the last lookup, the values returned by module_redis_command_helper_hash_get point into its data
+    module_redis_command_helper_hash_node_t lookup_node;
+};
+
+typedef struct module_redis_command_helper_hash_iter module_redis_command_helper_hash_iter_t;
+struct module_redis_command_helper_hash_iter {
+    module_redis_command_helper_hash_t *hash;
+    module_redis_command_helper_hash_node_t node;
+    uint32_t node_index;
+    uint32_t position;
+};
+
+static inline __attribute__((always_inline)) bool module_redis_command_helper_hash_entry_fits(
+        size_t field_length,
+        size_t value_length) {
+    return field_length + value_length <= MODULE_REDIS_COMMAND_HELPER_HASH_ENTRY_MAX_LENGTH;
+}
+
+bool module_redis_command_helper_hash_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_hash_t *hash);
+
+void module_redis_command_helper_hash_init(
+        module_redis_command_helper_hash_t *hash);
+
+bool module_redis_command_helper_hash_edit_begin(
+        module_redis_command_helper_hash_t *hash);
+
+void module_redis_command_helper_hash_cleanup(
+        module_redis_command_helper_hash_t *hash);
+
+bool module_redis_command_helper_hash_get(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        char *field,
+        size_t field_length,
+        char **value,
+        size_t *value_length,
+        bool *found);
+
+bool module_redis_command_helper_hash_iter_init(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        uint32_t field_hash_start,
+        module_redis_command_helper_hash_iter_t *iter);
+
+bool module_redis_command_helper_hash_iter_next(
+        storage_db_t *db,
+        module_redis_command_helper_hash_iter_t *iter,
+        uint32_t *field_hash,
+        char **field,
+        size_t *field_length,
+        char **value,
+        size_t *value_length);
+
+void module_redis_command_helper_hash_iter_cleanup(
+        module_redis_command_helper_hash_iter_t *iter);
+
+bool module_redis_command_helper_hash_set(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        char *field,
+        size_t field_length,
+        char *value,
+        size_t value_length,
+        bool *inserted);
+
+bool module_redis_command_helper_hash_delete(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash,
+        char *field,
+        size_t field_length,
+        bool *deleted);
+
+storage_db_chunk_sequence_t *module_redis_command_helper_hash_serialize(
+        storage_db_t *db,
+        module_redis_command_helper_hash_t *hash);
+
+char *module_redis_command_helper_hash_long_string_read(
+        storage_db_t *db,
+        module_redis_long_string_t *long_string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_HASH_H
@@ -0,0 +1,1085 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_buffer.h"
+#include "module_redis_command_helper_varint.h"
+#include "module_redis_command_helper_list.h"
+
+#define TAG "module_redis_command_helper_list"
+
+static inline __attribute__((always_inline)) size_t module_redis_command_helper_list_node_payload_length(
+        module_redis_command_helper_list_node_t *node) {
+    return node->length - sizeof(module_redis_command_helper_list_node_header_t);
+}
+
+size_t module_redis_command_helper_list_element_encoded_length(
+        size_t element_length) {
+    return module_redis_command_helper_varint_length(element_length) + element_length;
+}
+
+bool module_redis_command_helper_list_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_list_t *list) {
+    module_redis_command_helper_list_header_t header;
+    storage_db_chunk_sequence_t *chunk_sequence = entry_index->value;
+
+    memset(list, 0, sizeof(module_redis_command_helper_list_t));
+
+    if (unlikely(chunk_sequence->count < 1)) {
+        return false;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, 0);
+    if (unlikely(chunk_info->chunk_length != sizeof(module_redis_command_helper_list_header_t))) {
+        return false;
+    }
+
+    if (unlikely(!storage_db_chunk_read(db, chunk_info, (char*)&header, 0, sizeof(header)))) {
+        return false;
+    }
+
+    list->chunk_sequence = chunk_sequence;
+    list->count = header.count;
+    list->nodes_count = chunk_sequence->count - 1;
+
+    return true;
+}
+
+bool module_redis_command_helper_list_node_load(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        uint32_t node_index,
+        module_redis_command_helper_list_node_t *node) {
+    memset(node, 0, sizeof(module_redis_command_helper_list_node_t));
+
+    if (unlikely(node_index >= list->nodes_count)) {
+        return false;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(list->chunk_sequence, node_index + 1);
+    if (unlikely(chunk_info->chunk_length < sizeof(module_redis_command_helper_list_node_header_t))) {
+        return false;
+    }
+
+    node->data = storage_db_get_chunk_data(db, chunk_info, &node->data_allocated);
+    if (unlikely(!node->data)) {
+        return false;
+    }
+
+    node->length = chunk_info->chunk_length;
+    node->count = ((module_redis_command_helper_list_node_header_t*)node->data)->count;
+
+    return true;
+}
+
+void module_redis_command_helper_list_node_cleanup(
+        module_redis_command_helper_list_node_t *node) {
+    if (node->data_allocated) {
+        ffma_mem_free(node->data);
+    }
+
+    node->data = NULL;
+    node->data_allocated = false;
+}
+
+bool module_redis_command_helper_list_node_iter(
+        module_redis_command_helper_list_node_t *node,
+        char **iter_ptr,
+        char **element,
+        size_t *element_length) {
+    uint32_t length;
+    char *node_end = node->data + node->length;
+    char *element_ptr = *iter_ptr == NULL
+            ? node->data + sizeof(module_redis_command_helper_list_node_header_t)
+            : *iter_ptr;
+
+    if (element_ptr >= node_end) {
+        return false;
+    }
+
+    if (unlikely((element_ptr = module_redis_command_helper_varint_read(element_ptr, node_end, &length)) == NULL)) {
+        return false;
+    }
+
+    if (unlikely(element_ptr + length > node_end)) {
+        return false;
+    }
+
+    *element = element_ptr;
+    *element_length = length;
+    *iter_ptr = element_ptr + length;
+
+    return true;
+}
+
+bool module_redis_command_helper_list_node_count(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        uint32_t node_index,
+        uint16_t *count) {
+    module_redis_command_helper_list_node_header_t node_header;
+
+    // Only the header of the node is read, with the file backend the rest of the node is not touched
+    if (unlikely(!storage_db_chunk_read(
+            db,
+            storage_db_chunk_sequence_get(list->chunk_sequence, node_index + 1),
+            (char*)&node_header,
+            0,
+            sizeof(node_header)))) {
+        return false;
+    }
+
+    *count = node_header.count;
+
+    return true;
+}
+
+bool module_redis_command_helper_list_find(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        uint64_t index,
+        uint32_t *node_index,
+        uint64_t *node_first_element_index) {
+    uint16_t count;
+
+    if (unlikely(index >= list->count)) {
+        return false;
+    }
+
+    // The nodes are scanned starting from the nearest end of the list, the elements at the edges (the most common case
+    // for a list) are found after reading just one node header
+    if (index < list->count / 2) {
+        uint64_t first_element_index = 0;
+        for(uint32_t current_node_index = 0; current_node_index < list->nodes_count; current_node_index++) {
+            if (unlikely(!module_redis_command_helper_list_node_count(db, list, current_node_index, &count))) {
+                return false;
+            }
+
+            if (index < first_element_index + count) {
+                *node_index = current_node_index;
+                *node_first_element_index = first_element_index;
+                return true;
+            }
+
+            first_element_index += count;
+        }
+    } else {
+        uint64_t first_element_index = list->count;
+        for(uint32_t current_node_index = list->nodes_count; current_node_index > 0; current_node_index--) {
+            if (unlikely(!module_redis_command_helper_list_node_count(db, list, current_node_index - 1, &count))) {
+                return false;
+            }
+
+            first_element_index -= count;
+
+            if (index >= first_element_index) {
+                *node_index = current_node_index - 1;
+                *node_first_element_index = first_element_index;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool module_redis_command_helper_list_normalize_range(
+        module_redis_command_helper_list_t *list,
+        int64_t start,
+        int64_t stop,
+        uint64_t *range_start,
+        uint64_t *range_end) {
+    int64_t count = (int64_t)list->count;
+
+    if (start < 0) {
+        start = MAX(count + start, 0);
+    }
+
+    if (stop < 0) {
+        stop = count + stop;
+    }
+
+    if (stop >= count) {
+        stop = count - 1;
+    }
+
+    if (start > stop || start >= count) {
+        *range_start = *range_end = 0;
+        return false;
+    }
+
+    *range_start = start;
+    *range_end = stop + 1;
+
+    return true;
+}
+
+static bool module_redis_command_helper_list_send_node_reverse(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_list_node_t *node,
+        uint16_t element_start,
+        uint16_t element_end) {
+    bool result = false;
+    char *iter_ptr = NULL, *element;
+    size_t element_length;
+    uint16_t element_index = 0;
+
+    // The elements can be decoded only from the head of the node, the offsets are collected to send them backward
+    uint16_t *offsets = module_redis_command_helper_buffer_alloc(sizeof(uint16_t) * element_end);
+    if (unlikely(!offsets)) {
+        return false;
+    }
+
+    while(element_index < element_end && module_redis_command_helper_list_node_iter(
+            node,
+            &iter_ptr,
+            &element,
+            &element_length)) {
+        offsets[element_index++] = (uint16_t)(iter_ptr - node->data);
+    }
+
+    if (unlikely(element_index != element_end)) {
+        goto end;
+    }
+
+    for(element_index = element_end; element_index > element_start; element_index--) {
+        iter_ptr = element_index - 1 == 0
+                ? NULL
+                : node->data + offsets[element_index - 2];
+
+        if (unlikely(!module_redis_command_helper_list_node_iter(node, &iter_ptr, &element, &element_length))) {
+            goto end;
+        }
+
+        if (unlikely(!module_redis_connection_send_blob_string(connection_context, element, element_length))) {
+            goto end;
+        }
+    }
+
+    result = true;
+
+end:
+    module_redis_command_helper_buffer_free(offsets, sizeof(uint16_t) * element_end);
+
+    return result;
+}
+
+bool module_redis_command_helper_list_send_range(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_list_t *list,
+        uint64_t range_start,
+        uint64_t range_end,
+        bool reverse) {
+    bool result = false;
+    uint32_t node_index;
+    uint64_t node_first_element_index;
+    storage_db_t *db = connection_context->db;
+    module_redis_command_helper_list_node_t node = { 0 };
+
+    if (range_start >= range_end) {
+        return true;
+    }
+
+    // The elements are written into the send buffer straight from the nodes, one node at time
+    if (likely(!reverse)) {
+        if (unlikely(!module_redis_command_helper_list_find(
+                db,
+                list,
+                range_start,
+                &node_index,
+                &node_first_element_index))) {
+            return false;
+        }
+
+        uint64_t element_index = node_first_element_index;
+        for(; node_index < list->nodes_count && element_index < range_end; node_index++) {
+            char *iter_ptr = NULL, *element;
+            size_t element_length;
+
+            if (unlikely(!module_redis_command_helper_list_node_load(db, list, node_index, &node))) {
+                goto end;
+            }
+
+            while(element_index < range_end && module_redis_command_helper_list_node_iter(
+                    &node,
+                    &iter_ptr,
+                    &element,
+                    &element_length)) {
+                if (element_index >= range_start) {
+                    if (unlikely(!module_redis_connection_send_blob_string(
+                            connection_context,
+                            element,
+                            element_length))) {
+                        goto end;
+                    }
+                }
+
+                element_index++;
+            }
+
+            module_redis_command_helper_list_node_cleanup(&node);
+        }
+
+        result = element_index == range_end;
+    } else {
+        if (unlikely(!module_redis_command_helper_list_find(
+                db,
+                list,
+                range_end - 1,
+                &node_index,
+                &node_first_element_index))) {
+            return false;
+        }
+
+        uint64_t element_index = range_end;
+        for(node_index++; node_index > 0 && element_index > range_start; node_index--) {
+            if (unlikely(!module_redis_command_helper_list_node_load(db, list, node_index - 1, &node))) {
+                goto end;
+            }
+
+            uint64_t node_element_start = MAX(range_start, node_first_element_index);
+            if (unlikely(!module_redis_command_helper_list_send_node_reverse(
+                    connection_context,
+                    &node,
+                    node_element_start - node_first_element_index,
+                    element_index - node_first_element_index))) {
+                goto end;
+            }
+
+            element_index = node_element_start;
+            module_redis_command_helper_list_node_cleanup(&node);
+
+            if (node_index > 1 && element_index > range_start) {
+                uint16_t count;
+                if (unlikely(!module_redis_command_helper_list_node_count(db, list, node_index - 2, &count))) {
+                    goto end;
+                }
+                node_first_element_index -= count;
+            }
+        }
+
+        result = element_index == range_start;
+    }
+
+end:
+    module_redis_command_helper_list_node_cleanup(&node);
+
+    return result;
+}
+
+void module_redis_command_helper_list_builder_cleanup(
+        module_redis_command_helper_list_builder_t *builder) {
+    if (!builder->nodes) {
+        return;
+    }
+
+    for(uint32_t node_index = 0; node_index < builder->nodes_count; node_index++) {
+        module_redis_command_helper_buffer_free(
+                builder->nodes[node_index].buffer,
+                builder->nodes[node_index].buffer_size);
+    }
+
+    module_redis_command_helper_buffer_free(
+            builder->nodes,
+            sizeof(module_redis_command_helper_list_builder_node_t) * builder->nodes_size);
+    builder->nodes = NULL;
+    builder->nodes_count = 0;
+    builder->nodes_size = 0;
+    builder->count = 0;
+}
+
+bool module_redis_command_helper_list_builder_fits(
+        module_redis_command_helper_list_builder_t *builder,
+        size_t length) {
+    size_t node_length = builder->nodes_count == 0
+            ? sizeof(module_redis_command_helper_list_node_header_t)
+            : builder->nodes[builder->nodes_count - 1].length;
+
+    return node_length + length <= MODULE_REDIS_COMMAND_HELPER_LIST_NODE_MAX_SIZE;
+}
+
+static char *module_redis_command_helper_list_builder_reserve(
+        module_redis_command_helper_list_builder_t *builder,
+        size_t element_length) {
+    module_redis_command_helper_list_builder_node_t *node = NULL;
+    size_t encoded_length = module_redis_command_helper_list_element_encoded_length(element_length);
+
+    if (unlikely(element_length > MODULE_REDIS_COMMAND_HELPER_LIST_ELEMENT_MAX_LENGTH)) {
+        return NULL;
+    }
+
+    if (builder->nodes_count > 0) {
+        node = &builder->nodes[builder->nodes_count - 1];
+
+        if (node->length + encoded_length > node->buffer_size || node->count == UINT16_MAX) {
+            node = NULL;
+        }
+    }
+
+    if (node == NULL) {
+        if (unlikely(builder->nodes_count == MODULE_REDIS_COMMAND_HELPER_LIST_NODES_MAX)) {
+            return NULL;
+        }
+
+        if (builder->nodes_count == builder->nodes_size) {
+            uint32_t new_size = builder->nodes_size == 0 ? 4 : builder->nodes_size * 2;
+            module_redis_command_helper_list_builder_node_t *new_nodes = module_redis_command_helper_buffer_alloc(
+                    sizeof(module_redis_command_helper_list_builder_node_t) * new_size);
+
+            // If the allocation fails the builder is left untouched, the nodes are freed by the cleanup
+            if (unlikely(!new_nodes)) {
+                return NULL;
+            }
+
+            if (builder->nodes) {
+                memcpy(
+                        new_nodes,
+                        builder->nodes,
+                        sizeof(module_redis_command_helper_list_builder_node_t) * builder->nodes_count);
+                module_redis_command_helper_buffer_free(
+                        builder->nodes,
+                        sizeof(module_redis_command_helper_list_builder_node_t) * builder->nodes_size);
+            }
+
+            builder->nodes = new_nodes;
+            builder->nodes_size = new_size;
+        }
+
+        // The elements bigger than a node get a node sized to fit them
+        size_t buffer_size = MAX(
+                MODULE_REDIS_COMMAND_HELPER_LIST_NODE_MAX_SIZE,
+                sizeof(module_redis_command_helper_list_node_header_t) + encoded_length);
+        char *buffer = module_redis_command_helper_buffer_alloc(buffer_size);
+        if (unlikely(!buffer)) {
+            return NULL;
+        }
+
+        node = &builder->nodes[builder->nodes_count++];
+        node->buffer = buffer;
+        node->buffer_size = buffer_size;
+        node->length = sizeof(module_redis_command_helper_list_node_header_t);
+        node->count = 0;
+    }
+
+    char *element_ptr = module_redis_command_helper_varint_write(node->buffer + node->length, element_length);
+    node->length += encoded_length;
+    node->count++;
+    builder->count++;
+
+    ((module_redis_command_helper_list_node_header_t*)node->buffer)->count = node->count;
+
+    return element_ptr;
+}
+
+bool module_redis_command_helper_list_builder_append(
+        module_redis_command_helper_list_builder_t *builder,
+        char *element,
+        size_t element_length) {
+    char *element_ptr = module_redis_command_helper_list_builder_reserve(builder, element_length);
+
+    if (unlikely(!element_ptr)) {
+        return false;
+    }
+
+    memcpy(element_ptr, element, element_length);
+
+    return true;
+}
+
+bool module_redis_command_helper_list_builder_append_long_string(
+        storage_db_t *db,
+        module_redis_command_helper_list_builder_t *builder,
+        module_redis_long_string_t *long_string) {
+    storage_db_chunk_sequence_t *chunk_sequence = long_string->chunk_sequence;
+    char *element_ptr = module_redis_command_helper_list_builder_reserve(builder, chunk_sequence->size);
+
+    if (unlikely(!element_ptr)) {
+        return false;
+    }
+
+    // The chunks of the argument are read directly into the node
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (unlikely(!storage_db_chunk_read(
+                db,
+                chunk_info,
+                element_ptr,
+                0,
+                chunk_info->chunk_length))) {
+            return false;
+        }
+
+        element_ptr += chunk_info->chunk_length;
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_list_builder_append_node(
+        module_redis_command_helper_list_builder_t *builder,
+        module_redis_command_helper_list_node_t *node,
+        uint16_t element_start,
+        uint16_t element_end) {
+    char *iter_ptr = NULL, *element;
+    size_t element_length;
+    uint16_t element_index = 0;
+
+    while(element_index < element_end && module_redis_command_helper_list_node_iter(
+            node,
+            &iter_ptr,
+            &element,
+            &element_length)) {
+        if (element_index >= element_start) {
+            if (unlikely(!module_redis_command_helper_list_builder_append(builder, element, element_length))) {
+                return false;
+            }
+        }
+
+        element_index++;
+    }
+
+    return element_index == element_end;
+}
+
+bool module_redis_command_helper_list_builder_fits_node(
+        module_redis_command_helper_list_builder_t *builder,
+        module_redis_command_helper_list_node_t *node) {
+    return module_redis_command_helper_list_builder_fits(
+            builder,
+            module_redis_command_helper_list_node_payload_length(node));
+}
+
+static bool module_redis_command_helper_list_compose_write_builder(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        storage_db_chunk_index_t *chunk_index,
+        module_redis_command_helper_list_builder_t *builder) {
+    if (!builder) {
+        return true;
+    }
+
+    for(uint32_t node_index = 0; node_index < builder->nodes_count; node_index++) {
+        module_redis_command_helper_list_builder_node_t *node = &builder->nodes[node_index];
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, *chunk_index);
+
+        if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info, node->length))) {
+            return false;
+        }
+
+        (*chunk_index)++;
+        chunk_sequence->size += node->length;
+
+        if (unlikely(!storage_db_chunk_write(db, chunk_info, 0, node->buffer, node->length))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+storage_db_chunk_sequence_t *module_redis_command_helper_list_compose(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        module_redis_command_helper_list_builder_t *builder_head,
+        uint32_t node_index_start,
+        uint32_t node_index_end,
+        module_redis_command_helper_list_builder_t *builder_tail,
+        uint64_t count) {
+    bool result = false;
+    storage_db_chunk_index_t chunk_index = 0;
+    storage_db_chunk_sequence_t *chunk_sequence;
+    module_redis_command_helper_list_header_t header = { .count = count };
+    size_t nodes_count =
+            (builder_head ? builder_head->nodes_count : 0) +
+            (node_index_end - node_index_start) +
+            (builder_tail ? builder_tail->nodes_count : 0);
+
+    assert(node_index_start <= node_index_end);
+    assert(node_index_end <= list->nodes_count);
+
+    if (unlikely(nodes_count > MODULE_REDIS_COMMAND_HELPER_LIST_NODES_MAX)) {
+        return NULL;
+    }
+
+    chunk_sequence = storage_db_chunk_sequence_new(1 + nodes_count);
+    if (unlikely(!chunk_sequence)) {
+        return NULL;
+    }
+
+    storage_db_chunk_info_t *chunk_info_header = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+    if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info_header, sizeof(header)))) {
+        goto end;
+    }
+
+    chunk_index++;
+    chunk_sequence->size += sizeof(header);
+
+    if (unlikely(!storage_db_chunk_write(db, chunk_info_header, 0, (char*)&header, sizeof(header)))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_list_compose_write_builder(
+            db,
+            chunk_sequence,
+            &chunk_index,
+            builder_head))) {
+        goto end;
+    }
+
+    // The nodes not touched by the update are shared with the current version of the list
+    for(uint32_t node_index = node_index_start; node_index < node_index_end; node_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (unlikely(!storage_db_chunk_data_share(
+                db,
+                storage_db_chunk_sequence_get(list->chunk_sequence, node_index + 1),
+                chunk_info))) {
+            goto end;
+        }
+
+        chunk_index++;
+        chunk_sequence->size += chunk_info->chunk_length;
+    }
+
+    if (unlikely(!module_redis_command_helper_list_compose_write_builder(
+            db,
+            chunk_sequence,
+            &chunk_index,
+            builder_tail))) {
+        goto end;
+    }
+
+    assert(chunk_index == chunk_sequence->count);
+
+    result = true;
+
+end:
+    if (unlikely(!result)) {
+        // Only the chunks already initialized have to be freed
+        chunk_sequence->count = chunk_index;
+        storage_db_chunk_sequence_free(db, chunk_sequence);
+        ffma_mem_free(chunk_sequence);
+        chunk_sequence = NULL;
+    }
+
+    return chunk_sequence;
+}
+
+bool module_redis_command_helper_list_push(
+        module_redis_connection_context_t *connection_context,
+        char **key,
+        size_t *key_length,
+        module_redis_long_string_t *elements,
+        int elements_count,
+        bool head) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    uint32_t node_index_start = 0, node_index_end = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_chunk_sequence_t *chunk_sequence_new = NULL;
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    module_redis_command_helper_list_t list = { 0 };
+    module_redis_command_helper_list_node_t node = { 0 };
+    module_redis_command_helper_list_builder_t builder = { 0 };
+    storage_db_t *db = connection_context->db;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            db,
+            &transaction,
+            *key,
+            *key_length,
+            &rmw_status,
+            &current_entry_index))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR push failed");
+
+        goto end;
+    }
+
+    if (likely(current_entry_index)) {
+        current_entry_index = storage_db_op_rmw_current_entry_index_prep_for_read(
+                db,
+                &rmw_status,
+                current_entry_index);
+
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    MODULE_REDIS_ERROR_WRONGTYPE);
+
+            goto end;
+        }
+
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+
+        if (unlikely(!module_redis_command_helper_list_load(db, current_entry_index, &list))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR push failed");
+
+            goto end;
+        }
+    }
+
+    node_index_start = 0;
+    node_index_end = list.nodes_count;
+
+    for(int index = 0; index < elements_count; index++) {
+        if (unlikely(elements[index].chunk_sequence->size > MODULE_REDIS_COMMAND_HELPER_LIST_ELEMENT_MAX_LENGTH)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR element too large");
+
+            goto end;
+        }
+    }
+
+    if (head) {
+        // LPUSH inserts the elements one after the other at the head of the list, so they end up in reverse order
+        for(int index = elements_count - 1; index >= 0; index--) {
+            if (unlikely(!module_redis_command_helper_list_builder_append_long_string(db, &builder, &elements[index]))) {
+                goto end_error;
+            }
+        }
+
+        // The first node is re-packed together with the new elements only if it fits, otherwise it's shared as is
+        if (list.nodes_count > 0) {
+            if (unlikely(!module_redis_command_helper_list_node_load(db, &list, 0, &node))) {
+                goto end_error;
+            }
+
+            if (module_redis_command_helper_list_builder_fits_node(&builder, &node)) {
+                if (unlikely(!module_redis_command_helper_list_builder_append_node(&builder, &node, 0, node.count))) {
+                    goto end_error;
+                }
+
+                node_index_start++;
+            }
+        }
+    } else {
+        if (list.nodes_count > 0) {
+            if (unlikely(!module_redis_command_helper_list_node_load(db, &list, list.nodes_count - 1, &node))) {
+                goto end_error;
+            }
+
+            if (module_redis_command_helper_list_builder_fits(
+                    &builder,
+                    (node.length - sizeof(module_redis_command_helper_list_node_header_t)) +
+                    module_redis_command_helper_list_element_encoded_length(elements[0].chunk_sequence->size))) {
+                if (unlikely(!module_redis_command_helper_list_builder_append_node(&builder, &node, 0, node.count))) {
+                    goto end_error;
+                }
+
+                node_index_end--;
+            }
+        }
+
+        for(int index = 0; index < elements_count; index++) {
+            if (unlikely(!module_redis_command_helper_list_builder_append_long_string(db, &builder, &elements[index]))) {
+                goto end_error;
+            }
+        }
+    }
+
+    chunk_sequence_new = module_redis_command_helper_list_compose(
+            db,
+            &list,
+            head ? &builder : NULL,
+            node_index_start,
+            node_index_end,
+            head ? NULL : &builder,
+            list.count + elements_count);
+    if (unlikely(!chunk_sequence_new)) {
+        goto end_error;
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update(
+            db,
+            &rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST,
+            chunk_sequence_new,
+            expiry_time_ms))) {
+        goto end_error;
+    }
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    *key = NULL;
+    *key_length = 0;
+    chunk_sequence_new = NULL;
+    abort_rmw = false;
+
+    return_res = module_redis_connection_send_number(connection_context, (int64_t)(list.count + elements_count));
+    goto end;
+
+end_error:
+    return_res = module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR push failed");
+
+end:
+
+    module_redis_command_helper_list_node_cleanup(&node);
+    module_redis_command_helper_list_builder_cleanup(&builder);
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    if (current_entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+    }
+
+    if (unlikely(chunk_sequence_new)) {
+        storage_db_chunk_sequence_free(db, chunk_sequence_new);
+        ffma_mem_free(chunk_sequence_new);
+    }
+
+    return return_res;
+}
+
+bool module_redis_command_helper_list_pop(
+        module_redis_connection_context_t *connection_context,
+        char **key,
+        size_t *key_length,
+        bool has_count,
+        int64_t count,
+        bool head) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    uint32_t node_index_start = 0, node_index_end = 0;
+    uint64_t remaining;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_chunk_sequence_t *chunk_sequence_new = NULL;
+    module_redis_command_helper_list_t list = { 0 };
+    module_redis_command_helper_list_node_t node = { 0 };
+    module_redis_command_helper_list_builder_t builder = { 0 };
+    storage_db_t *db = connection_context->db;
+
+    if (unlikely(has_count && count < 0)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR value is out of range, must be positive");
+    }
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            db,
+            &transaction,
+            *key,
+            *key_length,
+            &rmw_status,
+            &current_entry_index))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR pop failed");
+
+        goto end;
+    }
+
+    if (unlikely(!current_entry_index)) {
+        return_res = has_count
+                ? module_redis_connection_send_array_null(connection_context)
+                : module_redis_connection_send_string_null(connection_context);
+        goto end;
+    }
+
+    current_entry_index = storage_db_op_rmw_current_entry_index_prep_for_read(
+            db,
+            &rmw_status,
+            current_entry_index);
+
+    if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                MODULE_REDIS_ERROR_WRONGTYPE);
+
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_list_load(db, current_entry_index, &list))) {
+        goto end_error;
+    }
+
+    if (!has_count) {
+        count = 1;
+    } else if (count == 0) {
+        return_res = module_redis_connection_send_array_header(connection_context, 0);
+        goto end;
+    }
+
+    count = MIN((uint64_t)count, list.count);
+
+    node_index_start = 0;
+    node_index_end = list.nodes_count;
+    remaining = count;
+
+    // The nodes entirely popped are simply dropped, only the node popped partially has to be re-packed
+    while(remaining > 0) {
+        uint16_t node_count;
+        uint32_t node_index = head ? node_index_start : node_index_end - 1;
+
+        if (unlikely(!module_redis_command_helper_list_node_count(db, &list, node_index, &node_count))) {
+            goto end_error;
+        }
+
+        if (node_count > remaining) {
+            if (unlikely(!module_redis_command_helper_list_node_load(db, &list, node_index, &node))) {
+                goto end_error;
+            }
+
+            if (unlikely(!module_redis_command_helper_list_builder_append_node(
+                    &builder,
+                    &node,
+                    head ? remaining : 0,
+                    head ? node_count : node_count - remaining))) {
+                goto end_error;
+            }
+
+            module_redis_command_helper_list_node_cleanup(&node);
+            remaining = 0;
+        } else {
+            remaining -= node_count;
+        }
+
+        if (head) {
+            node_index_start++;
+        } else {
+            node_index_end--;
+        }
+    }
+
+    if (list.count == (uint64_t)count) {
+        storage_db_op_rmw_commit_delete(db, &rmw_status);
+    } else {
+        chunk_sequence_new = module_redis_command_helper_list_compose(
+                db,
+                &list,
+                head ? &builder : NULL,
+                node_index_start,
+                node_index_end,
+                head ? NULL : &builder,
+                list.count - count);
+        if (unlikely(!chunk_sequence_new)) {
+            goto end_error;
+        }
+
+        if (unlikely(!storage_db_op_rmw_commit_update(
+                db,
+                &rmw_status,
+                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST,
+                chunk_sequence_new,
+                current_entry_index->expiry_time_ms))) {
+            goto end_error;
+        }
+
+        *key = NULL;
+        *key_length = 0;
+        chunk_sequence_new = NULL;
+    }
+
+    transaction_release(&transaction);
+    release_transaction = false;
+    abort_rmw = false;
+
+    // The popped elements are sent from the previous version of the list, it can't be freed as the readers counter has
+    // been incremented by storage_db_op_rmw_current_entry_index_prep_for_read
+    if (has_count) {
+        if (unlikely(!module_redis_connection_send_array_header(connection_context, count))) {
+            goto end;
+        }
+    }
+
+    return_res = module_redis_command_helper_list_send_range(
+            connection_context,
+            &list,
+            head ? 0 : list.count - count,
+            head ? count : list.count,
+            !head);
+    goto end;
+
+end_error:
+    return_res = module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR pop failed");
+
+end:
+
+    module_redis_command_helper_list_node_cleanup(&node);
+    module_redis_command_helper_list_builder_cleanup(&builder);
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    if (current_entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+    }
+
+    if (unlikely(chunk_sequence_new)) {
+        storage_db_chunk_sequence_free(db, chunk_sequence_new);
+        ffma_mem_free(chunk_sequence_new);
+    }
+
+    return return_res;
+}
@@ -0,0 +1,172 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LIST_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The lists are stored as a sequence of packed nodes mapped on the chunks of the value of the entry index (so they work
+// transparently with every storage backend)
+//   chunk 0 (header) | chunk 1 (node 0) | chunk 2 (node 1) | ... | chunk n (node n - 1)
+// the header contains the number of elements of the list, each node contains the number of elements packed in it
+// followed by the elements prefixed by their length encoded as varint.
+//
+// The nodes are immutable, an update builds a new chunk sequence re-packing only the nodes at the edges being changed
+// and sharing the data of all the other nodes with the previous version of the list (see storage_db_chunk_data_share),
+// so pushes and pops copy at most one node plus the array of the chunks and never allocate memory per element.
+#define MODULE_REDIS_COMMAND_HELPER_LIST_NODE_MAX_SIZE (8 * 1024)
+#define MODULE_REDIS_COMMAND_HELPER_LIST_NODES_MAX \
+    ((FFMA_OBJECT_SIZE_MAX / sizeof(storage_db_chunk_info_t)) - 1)
+// The elements bigger than the size of a node get a dedicated node, which has still to fit in a chunk, 3 bytes are
+// needed to encode the length of the element as varint
+#define MODULE_REDIS_COMMAND_HELPER_LIST_ELEMENT_MAX_LENGTH \
+    (STORAGE_DB_CHUNK_MAX_SIZE - sizeof(module_redis_command_helper_list_node_header_t) - 3)
+
+typedef struct module_redis_command_helper_list_header module_redis_command_helper_list_header_t;
+struct module_redis_command_helper_list_header {
+    uint64_t count;
+};
+
+typedef struct module_redis_command_helper_list_node_header module_redis_command_helper_list_node_header_t;
+struct module_redis_command_helper_list_node_header {
+    uint16_t count;
+};
+
+typedef struct module_redis_command_helper_list module_redis_command_helper_list_t;
+struct module_redis_command_helper_list {
+    storage_db_chunk_sequence_t *chunk_sequence;
+    uint64_t count;
+    uint32_t nodes_count;
+};
+
+typedef struct module_redis_command_helper_list_node module_redis_command_helper_list_node_t;
+struct module_redis_command_helper_list_node {
+    char *data;
+    size_t length;
+    bool data_allocated;
+    uint16_t count;
+};
+
+typedef struct module_redis_command_helper_list_builder_node module_redis_command_helper_list_builder_node_t;
+struct module_redis_command_helper_list_builder_node {
+    char *buffer;
+    size_t buffer_size;
+    size_t length;
+    uint16_t count;
+};
+
+typedef struct module_redis_command_helper_list_builder module_redis_command_helper_list_builder_t;
+struct module_redis_command_helper_list_builder {
+    module_redis_command_helper_list_builder_node_t *nodes;
+    uint32_t nodes_count;
+    uint32_t nodes_size;
+    uint64_t count;
+};
+
+size_t module_redis_command_helper_list_element_encoded_length(
+        size_t element_length);
+
+bool module_redis_command_helper_list_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_list_t *list);
+
+bool module_redis_command_helper_list_node_load(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        uint32_t node_index,
+        module_redis_command_helper_list_node_t *node);
+
+void module_redis_command_helper_list_node_cleanup(
+        module_redis_command_helper_list_node_t *node);
+
+bool module_redis_command_helper_list_node_iter(
+        module_redis_command_helper_list_node_t *node,
+        char **iter_ptr,
+        char **element,
+        size_t *element_length);
+
+bool module_redis_command_helper_list_node_count(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        uint32_t node_index,
+        uint16_t *count);
+
+bool module_redis_command_helper_list_find(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        uint64_t index,
+        uint32_t *node_index,
+        uint64_t *node_first_element_index);
+
+bool module_redis_command_helper_list_normalize_range(
+        module_redis_command_helper_list_t *list,
+        int64_t start,
+        int64_t stop,
+        uint64_t *range_start,
+        uint64_t *range_end);
+
+bool module_redis_command_helper_list_send_range(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_list_t *list,
+        uint64_t range_start,
+        uint64_t range_end,
+        bool reverse);
+
+void module_redis_command_helper_list_builder_cleanup(
+        module_redis_command_helper_list_builder_t *builder);
+
+bool module_redis_command_helper_list_builder_append(
+        module_redis_command_helper_list_builder_t *builder,
+        char *element,
+        size_t element_length);
+
+bool module_redis_command_helper_list_builder_append_long_string(
+        storage_db_t *db,
+        module_redis_command_helper_list_builder_t *builder,
+        module_redis_long_string_t *long_string);
+
+bool module_redis_command_helper_list_builder_append_node(
+        module_redis_command_helper_list_builder_t *builder,
+        module_redis_command_helper_list_node_t *node,
+        uint16_t element_start,
+        uint16_t element_end);
+
+bool module_redis_command_helper_list_builder_fits(
+        module_redis_command_helper_list_builder_t *builder,
+        size_t length);
+
+bool module_redis_command_helper_list_builder_fits_node(
+        module_redis_command_helper_list_builder_t *builder,
+        module_redis_command_helper_list_node_t *node);
+
+storage_db_chunk_sequence_t *module_redis_command_helper_list_compose(
+        storage_db_t *db,
+        module_redis_command_helper_list_t *list,
+        module_redis_command_helper_list_builder_t *builder_head,
+        uint32_t node_index_start,
+        uint32_t node_index_end,
+        module_redis_command_helper_list_builder_t *builder_tail,
+        uint64_t count);
+
+bool module_redis_command_helper_list_push(
+        module_redis_connection_context_t *connection_context,
+        char **key,
+        size_t *key_length,
+        module_redis_long_string_t *elements,
+        int elements_count,
+        bool head);
+
+bool module_redis_command_helper_list_pop(
+        module_redis_connection_context_t *connection_context,
+        char **key,
+        size_t *key_length,
+        bool has_count,
+        int64_t count,
+        bool head);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_LIST_H
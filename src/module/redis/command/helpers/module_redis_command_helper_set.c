@@ -0,0 +1,1670 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "pow2.h"
+#include "utils_string.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "hash/hash_fnv1.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_buffer.h"
+#include "module_redis_command_helper_varint.h"
+#include "module_redis_command_helper_set.h"
+
+#define TAG "module_redis_command_helper_set"
+
+// The buffers of the nodes being changed are big enough to let a node grow over the max size by a few members before
+// being split, they are reallocated only for the members bigger than a node
+#define MODULE_REDIS_COMMAND_HELPER_SET_NODE_BUFFER_SIZE (MODULE_REDIS_COMMAND_HELPER_SET_NODE_MAX_SIZE * 2)
+
+typedef struct module_redis_command_helper_set_entry module_redis_command_helper_set_entry_t;
+struct module_redis_command_helper_set_entry {
+    char *member;
+    uint32_t member_length;
+    uint32_t hash;
+};
+
+IFUNC_WRAPPER_RESOLVE(MODULE_REDIS_COMMAND_HELPER_SET_NAME_IFUNC(intset_intersect)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return MODULE_REDIS_COMMAND_HELPER_SET_NAME_IMPL(intset_intersect, avx2);
+    }
+#endif
+
+    return MODULE_REDIS_COMMAND_HELPER_SET_NAME_IMPL(intset_intersect, sw);
+}
+
+uint32_t IFUNC_WRAPPER(MODULE_REDIS_COMMAND_HELPER_SET_NAME_IFUNC(intset_intersect),
+                       (int64_t *a, uint32_t a_count, int64_t *b, uint32_t b_count, int64_t *result));
+
+IFUNC_WRAPPER_RESOLVE(MODULE_REDIS_COMMAND_HELPER_SET_NAME_IFUNC(node_find)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return MODULE_REDIS_COMMAND_HELPER_SET_NAME_IMPL(node_find, avx2);
+    }
+#endif
+
+    return MODULE_REDIS_COMMAND_HELPER_SET_NAME_IMPL(node_find, sw);
+}
+
+int64_t IFUNC_WRAPPER(MODULE_REDIS_COMMAND_HELPER_SET_NAME_IFUNC(node_find),
+                      (module_redis_command_helper_set_node_t *node, char *member, size_t member_length,
+                       uint32_t member_hash));
+
+bool module_redis_command_helper_set_member_to_int64(
+        char *member,
+        size_t member_length,
+        int64_t *value) {
+    uint64_t number = 0;
+    bool negative = false;
+
+    // Only the canonical representation of the integers can be stored in an intset, otherwise the members returned
+    // wouldn't match the ones added (e.g. +1, 01 or -0)
+    if (unlikely(member_length == 0 || member_length > MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH)) {
+        return false;
+    }
+
+    if (*member == '-') {
+        negative = true;
+        member++;
+        member_length--;
+
+        if (unlikely(member_length == 0)) {
+            return false;
+        }
+    }
+
+    if (*member == '0' && (member_length > 1 || negative)) {
+        return false;
+    }
+
+    for(; member_length > 0; member_length--, member++) {
+        if (*member < '0' || *member > '9') {
+            return false;
+        }
+
+        if (unlikely(number > (UINT64_MAX - 9) / 10)) {
+            return false;
+        }
+
+        number = (number * 10) + (*member - '0');
+    }
+
+    if (negative) {
+        if (unlikely(number > (uint64_t)INT64_MAX + 1)) {
+            return false;
+        }
+
+        *value = (int64_t)(0 - number);
+    } else {
+        if (unlikely(number > (uint64_t)INT64_MAX)) {
+            return false;
+        }
+
+        *value = (int64_t)number;
+    }
+
+    return true;
+}
+
+size_t module_redis_command_helper_set_int64_to_member(
+        int64_t value,
+        char *buffer) {
+    char digits[MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH];
+    size_t digits_count = 0, length = 0;
+    uint64_t number = value < 0
+            ? 0 - (uint64_t)value
+            : (uint64_t)value;
+
+    do {
+        digits[digits_count++] = (char)('0' + (number % 10));
+        number /= 10;
+    } while(number > 0);
+
+    if (value < 0) {
+        buffer[length++] = '-';
+    }
+
+    while(digits_count > 0) {
+        buffer[length++] = digits[--digits_count];
+    }
+
+    return length;
+}
+
+static bool module_redis_command_helper_set_intset_search(
+        int64_t *integers,
+        uint32_t count,
+        int64_t value,
+        uint32_t *position) {
+    uint32_t low = 0, high = count;
+
+    while(low < high) {
+        uint32_t middle = low + ((high - low) / 2);
+
+        if (integers[middle] < value) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    *position = low;
+
+    return low < count && integers[low] == value;
+}
+
+
+static inline __attribute__((always_inline)) size_t module_redis_command_helper_set_node_index_size(
+        uint32_t groups_count) {
+    return (sizeof(module_redis_command_helper_set_group_t) +
+        (sizeof(uint32_t) * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS)) * (size_t)groups_count;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_set_node_groups_count(
+        uint32_t count) {
+    return pow2_next(MAX(
+            1,
+            (count + MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_LOAD - 1) /
+            MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_LOAD));
+}
+
+static inline __attribute__((always_inline)) size_t module_redis_command_helper_set_entry_length(
+        size_t member_length) {
+    return module_redis_command_helper_varint_length(member_length) + member_length;
+}
+
+static bool module_redis_command_helper_set_node_view(
+        char *data,
+        size_t length,
+        module_redis_command_helper_set_node_t *node) {
+    module_redis_command_helper_set_node_header_t *node_header;
+
+    if (unlikely(length < sizeof(module_redis_command_helper_set_node_header_t))) {
+        return false;
+    }
+
+    node_header = (module_redis_command_helper_set_node_header_t*)data;
+
+    if (unlikely(!pow2_is(node_header->groups_count) ||
+            length < sizeof(module_redis_command_helper_set_node_header_t) +
+                module_redis_command_helper_set_node_index_size(node_header->groups_count))) {
+        return false;
+    }
+
+    node->data = data;
+    node->length = length;
+    node->count = node_header->count;
+    node->groups_count = node_header->groups_count;
+    node->groups = (module_redis_command_helper_set_group_t*)(data + sizeof(module_redis_command_helper_set_node_header_t));
+    node->entries_offsets = (uint32_t*)(node->groups + node->groups_count);
+    node->entries_start = (char*)(node->entries_offsets +
+            (node->groups_count * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS));
+    node->entries_end = data + length;
+
+    return true;
+}
+
+static void module_redis_command_helper_set_node_cleanup(
+        module_redis_command_helper_set_node_t *node) {
+    if (node->data_allocated) {
+        ffma_mem_free(node->data);
+    }
+
+    memset(node, 0, sizeof(module_redis_command_helper_set_node_t));
+}
+
+static void module_redis_command_helper_set_node_index_insert(
+        module_redis_command_helper_set_node_t *node,
+        uint32_t member_hash,
+        uint32_t entry_offset) {
+    uint32_t groups_mask = node->groups_count - 1;
+    uint32_t group_index = member_hash & groups_mask;
+
+    // The groups are never filled more than GROUP_LOAD / GROUP_SLOTS so there is always a group with a free slot
+    while(node->groups[group_index].count == MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) {
+        group_index = (group_index + 1) & groups_mask;
+    }
+
+    module_redis_command_helper_set_group_t *group = &node->groups[group_index];
+    node->entries_offsets[(group_index * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) + group->count] =
+            entry_offset;
+    group->hashes[group->count] = member_hash;
+    group->count++;
+}
+
+static module_redis_command_helper_set_entry_t *module_redis_command_helper_set_node_entries_collect(
+        module_redis_command_helper_set_node_t *node,
+        uint32_t extra_count) {
+    char *entry_ptr = node->entries_start;
+    size_t entries_size = sizeof(module_redis_command_helper_set_entry_t) * (node->count + extra_count);
+    module_redis_command_helper_set_entry_t *entries = module_redis_command_helper_buffer_alloc(
+            MAX(entries_size, 1));
+
+    if (unlikely(!entries)) {
+        return NULL;
+    }
+
+    // The entries are collected in the order they are packed, which is the order they have been added in
+    for(uint32_t index = 0; index < node->count; index++) {
+        char *member;
+        size_t member_length;
+
+        if (unlikely((entry_ptr = module_redis_command_helper_set_entry_decode(
+                entry_ptr,
+                node->entries_end,
+                &member,
+                &member_length)) == NULL)) {
+            module_redis_command_helper_buffer_free(entries, MAX(entries_size, 1));
+            return NULL;
+        }
+
+        entries[index].member = member;
+        entries[index].member_length = member_length;
+        entries[index].hash = module_redis_command_helper_set_member_hash(member, member_length);
+    }
+
+    return entries;
+}
+
+static char *module_redis_command_helper_set_node_build(
+        module_redis_command_helper_set_entry_t *entries,
+        uint32_t count,
+        uint32_t *buffer_size,
+        uint32_t *length) {
+    size_t entries_length = 0;
+    module_redis_command_helper_set_node_t node = { 0 };
+    uint32_t groups_count = module_redis_command_helper_set_node_groups_count(count);
+    size_t index_length =
+            sizeof(module_redis_command_helper_set_node_header_t) +
+            module_redis_command_helper_set_node_index_size(groups_count);
+
+    for(uint32_t index = 0; index < count; index++) {
+        entries_length += module_redis_command_helper_set_entry_length(entries[index].member_length);
+    }
+
+    *length = index_length + entries_length;
+    *buffer_size = MAX(*length, MODULE_REDIS_COMMAND_HELPER_SET_NODE_BUFFER_SIZE);
+
+    char *buffer = module_redis_command_helper_buffer_alloc(*buffer_size);
+    if (unlikely(!buffer)) {
+        return NULL;
+    }
+
+    memset(buffer, 0, index_length);
+    ((module_redis_command_helper_set_node_header_t*)buffer)->count = count;
+    ((module_redis_command_helper_set_node_header_t*)buffer)->groups_count = groups_count;
+    module_redis_command_helper_set_node_view(buffer, *length, &node);
+
+    char *entry_ptr = node.entries_start;
+    for(uint32_t index = 0; index < count; index++) {
+        module_redis_command_helper_set_node_index_insert(&node, entries[index].hash, entry_ptr - node.entries_start);
+
+        entry_ptr = module_redis_command_helper_varint_write(entry_ptr, entries[index].member_length);
+        memcpy(entry_ptr, entries[index].member, entries[index].member_length);
+        entry_ptr += entries[index].member_length;
+    }
+
+    assert(entry_ptr == buffer + *length);
+
+    return buffer;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_set_nodes_locate(
+        module_redis_command_helper_set_nodes_t *nodes,
+        uint32_t member_hash) {
+    uint32_t low = 0, high = nodes->count;
+
+    // The first node always starts from 0 so the node containing the hash is the last one with a key lower or equal
+    while(low < high) {
+        uint32_t middle = low + ((high - low) / 2);
+
+        if (nodes->keys[middle] <= member_hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low > 0 ? low - 1 : 0;
+}
+
+static void module_redis_command_helper_set_nodes_arrays_free(
+        module_redis_command_helper_set_nodes_t *nodes) {
+    if (nodes->keys) {
+        module_redis_command_helper_buffer_free(nodes->keys, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->chunk_indexes) {
+        module_redis_command_helper_buffer_free(nodes->chunk_indexes, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->lengths) {
+        module_redis_command_helper_buffer_free(nodes->lengths, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->buffers_sizes) {
+        module_redis_command_helper_buffer_free(nodes->buffers_sizes, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->buffers) {
+        module_redis_command_helper_buffer_free(nodes->buffers, sizeof(char*) * nodes->size);
+    }
+}
+
+static bool module_redis_command_helper_set_nodes_arrays_alloc(
+        module_redis_command_helper_set_nodes_t *nodes,
+        uint32_t size) {
+    nodes->size = size;
+    nodes->keys = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->chunk_indexes = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->lengths = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->buffers_sizes = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->buffers = module_redis_command_helper_buffer_alloc_zero(sizeof(char*) * size);
+
+    if (unlikely(!nodes->keys || !nodes->chunk_indexes || !nodes->lengths || !nodes->buffers_sizes ||
+            !nodes->buffers)) {
+        module_redis_command_helper_set_nodes_arrays_free(nodes);
+        memset(nodes, 0, sizeof(module_redis_command_helper_set_nodes_t));
+        return false;
+    }
+
+    return true;
+}
+
+static void module_redis_command_helper_set_nodes_free(
+        module_redis_command_helper_set_nodes_t *nodes) {
+    if (nodes->buffers) {
+        for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+            if (nodes->buffers[node_index]) {
+                module_redis_command_helper_buffer_free(
+                        nodes->buffers[node_index],
+                        nodes->buffers_sizes[node_index]);
+            }
+        }
+    }
+
+    module_redis_command_helper_set_nodes_arrays_free(nodes);
+
+    memset(nodes, 0, sizeof(module_redis_command_helper_set_nodes_t));
+}
+
+static void module_redis_command_helper_set_nodes_loaded_free(
+        module_redis_command_helper_set_nodes_t *nodes) {
+    if (!nodes->loaded) {
+        return;
+    }
+
+    for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+        module_redis_command_helper_set_node_cleanup(&nodes->loaded[node_index]);
+    }
+
+    module_redis_command_helper_buffer_free(
+            nodes->loaded,
+            sizeof(module_redis_command_helper_set_node_t) * nodes->count);
+    nodes->loaded = NULL;
+}
+
+static bool module_redis_command_helper_set_nodes_reserve(
+        module_redis_command_helper_set_nodes_t *nodes,
+        uint32_t count) {
+    module_redis_command_helper_set_nodes_t nodes_new = { 0 };
+
+    if (likely(nodes->count + count <= nodes->size)) {
+        return true;
+    }
+
+    if (unlikely(nodes->count + count > MODULE_REDIS_COMMAND_HELPER_SET_NODES_MAX)) {
+        return false;
+    }
+
+    // The new arrays are all allocated before touching the current ones, if an allocation fails the nodes are left
+    // untouched and will be freed by the cleanup
+    if (unlikely(!module_redis_command_helper_set_nodes_arrays_alloc(
+            &nodes_new,
+            MIN(MAX(nodes->size * 2, nodes->count + count), MODULE_REDIS_COMMAND_HELPER_SET_NODES_MAX)))) {
+        return false;
+    }
+
+    if (nodes->count > 0) {
+        memcpy(nodes_new.keys, nodes->keys, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.chunk_indexes, nodes->chunk_indexes, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.lengths, nodes->lengths, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.buffers_sizes, nodes->buffers_sizes, sizeof(uint32_t) * nodes->count);
+        memcpy(nodes_new.buffers, nodes->buffers, sizeof(char*) * nodes->count);
+    }
+    nodes_new.count = nodes->count;
+
+    // The buffers of the nodes have been moved to the new arrays, only the current arrays have to be freed
+    module_redis_command_helper_set_nodes_arrays_free(nodes);
+    *nodes = nodes_new;
+
+    return true;
+}
+
+static bool module_redis_command_helper_set_nodes_insert(
+        module_redis_command_helper_set_nodes_t *nodes,
+        uint32_t node_index,
+        uint32_t key,
+        char *buffer,
+        uint32_t buffer_size,
+        uint32_t length) {
+    if (unlikely(!module_redis_command_helper_set_nodes_reserve(nodes, 1))) {
+        return false;
+    }
+
+    uint32_t move_count = nodes->count - node_index;
+    memmove(&nodes->keys[node_index + 1], &nodes->keys[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->chunk_indexes[node_index + 1], &nodes->chunk_indexes[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->lengths[node_index + 1], &nodes->lengths[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers_sizes[node_index + 1], &nodes->buffers_sizes[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers[node_index + 1], &nodes->buffers[node_index], sizeof(char*) * move_count);
+
+    nodes->keys[node_index] = key;
+    nodes->chunk_indexes[node_index] = 0;
+    nodes->lengths[node_index] = length;
+    nodes->buffers_sizes[node_index] = buffer_size;
+    nodes->buffers[node_index] = buffer;
+    nodes->count++;
+
+    return true;
+}
+
+static void module_redis_command_helper_set_nodes_remove(
+        module_redis_command_helper_set_nodes_t *nodes,
+        uint32_t node_index) {
+    if (nodes->buffers[node_index]) {
+        module_redis_command_helper_buffer_free(nodes->buffers[node_index], nodes->buffers_sizes[node_index]);
+    }
+
+    uint32_t move_count = nodes->count - node_index - 1;
+    memmove(&nodes->keys[node_index], &nodes->keys[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->chunk_indexes[node_index], &nodes->chunk_indexes[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->lengths[node_index], &nodes->lengths[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers_sizes[node_index], &nodes->buffers_sizes[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers[node_index], &nodes->buffers[node_index + 1], sizeof(char*) * move_count);
+
+    nodes->count--;
+    nodes->buffers[nodes->count] = NULL;
+
+    // The first node always starts from 0
+    if (node_index == 0 && nodes->count > 0) {
+        nodes->keys[0] = 0;
+    }
+}
+
+static void module_redis_command_helper_set_nodes_replace(
+        module_redis_command_helper_set_nodes_t *nodes,
+        uint32_t node_index,
+        char *buffer,
+        uint32_t buffer_size,
+        uint32_t length) {
+    if (nodes->buffers[node_index]) {
+        module_redis_command_helper_buffer_free(nodes->buffers[node_index], nodes->buffers_sizes[node_index]);
+    }
+
+    nodes->buffers[node_index] = buffer;
+    nodes->buffers_sizes[node_index] = buffer_size;
+    nodes->lengths[node_index] = length;
+}
+
+static bool module_redis_command_helper_set_nodes_prepare_buffer(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        uint32_t node_index,
+        size_t length_extra) {
+    module_redis_command_helper_set_nodes_t *nodes = &set->nodes;
+    size_t length_required = nodes->lengths[node_index] + length_extra;
+
+    if (nodes->buffers[node_index]) {
+        if (likely(length_required <= nodes->buffers_sizes[node_index])) {
+            return true;
+        }
+
+        size_t buffer_size = MAX(length_required, nodes->buffers_sizes[node_index] * 2);
+        char *buffer = module_redis_command_helper_buffer_realloc(
+                nodes->buffers[node_index],
+                nodes->buffers_sizes[node_index],
+                buffer_size,
+                false);
+
+        // The buffer passed is freed even if the allocation fails, the node can't be used anymore but the set is
+        // going to be thrown away by the caller
+        nodes->buffers[node_index] = buffer;
+        nodes->buffers_sizes[node_index] = buffer ? buffer_size : 0;
+
+        return buffer != NULL;
+    }
+
+    size_t buffer_size = MAX(length_required, MODULE_REDIS_COMMAND_HELPER_SET_NODE_BUFFER_SIZE);
+    char *buffer = module_redis_command_helper_buffer_alloc(buffer_size);
+    if (unlikely(!buffer)) {
+        return false;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+            set->chunk_sequence,
+            nodes->chunk_indexes[node_index]);
+    if (unlikely(!storage_db_chunk_read(db, chunk_info, buffer, 0, chunk_info->chunk_length))) {
+        module_redis_command_helper_buffer_free(buffer, buffer_size);
+        return false;
+    }
+
+    nodes->buffers[node_index] = buffer;
+    nodes->buffers_sizes[node_index] = buffer_size;
+    nodes->lengths[node_index] = chunk_info->chunk_length;
+
+    return true;
+}
+
+static int module_redis_command_helper_set_entries_compare(
+        const void *a,
+        const void *b) {
+    uint32_t a_hash = ((module_redis_command_helper_set_entry_t*)a)->hash;
+    uint32_t b_hash = ((module_redis_command_helper_set_entry_t*)b)->hash;
+
+    return a_hash < b_hash ? -1 : (a_hash > b_hash ? 1 : 0);
+}
+
+static bool module_redis_command_helper_set_nodes_split(
+        module_redis_command_helper_set_nodes_t *nodes,
+        uint32_t node_index) {
+    bool result = false;
+    module_redis_command_helper_set_node_t node = { 0 };
+    module_redis_command_helper_set_entry_t *entries = NULL;
+    char *left_buffer = NULL, *right_buffer = NULL;
+    uint32_t left_buffer_size, left_length, right_buffer_size, right_length;
+    uint32_t split_position;
+
+    if (nodes->lengths[node_index] <= MODULE_REDIS_COMMAND_HELPER_SET_NODE_MAX_SIZE) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_set_node_view(
+            nodes->buffers[node_index],
+            nodes->lengths[node_index],
+            &node))) {
+        return false;
+    }
+
+    if (node.count < 2) {
+        return true;
+    }
+
+    entries = module_redis_command_helper_set_node_entries_collect(&node, 0);
+    if (unlikely(!entries)) {
+        return false;
+    }
+
+    // The node is split in two halves by hash, the members with the same hash have to stay in the same node so if the
+    // median is the lowest hash the split moves to the first greater hash
+    qsort(entries, node.count, sizeof(module_redis_command_helper_set_entry_t), module_redis_command_helper_set_entries_compare);
+
+    split_position = node.count / 2;
+    while(split_position > 0 && entries[split_position - 1].hash == entries[split_position].hash) {
+        split_position--;
+    }
+
+    if (split_position == 0) {
+        split_position = node.count / 2;
+        while(split_position < node.count && entries[split_position - 1].hash == entries[split_position].hash) {
+            split_position++;
+        }
+    }
+
+    // All the members have the same hash, the node can't be split
+    if (split_position == node.count) {
+        result = true;
+        goto end;
+    }
+
+    left_buffer = module_redis_command_helper_set_node_build(
+            entries,
+            split_position,
+            &left_buffer_size,
+            &left_length);
+    right_buffer = module_redis_command_helper_set_node_build(
+            entries + split_position,
+            node.count - split_position,
+            &right_buffer_size,
+            &right_length);
+
+    if (unlikely(!left_buffer || !right_buffer)) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_set_nodes_insert(
+            nodes,
+            node_index + 1,
+            entries[split_position].hash,
+            right_buffer,
+            right_buffer_size,
+            right_length))) {
+        goto end;
+    }
+    right_buffer = NULL;
+
+    // The entries point to the buffer being replaced, they can't be used anymore
+    module_redis_command_helper_set_nodes_replace(nodes, node_index, left_buffer, left_buffer_size, left_length);
+    left_buffer = NULL;
+
+    // A node containing a member bigger than the max size might need to be split again, the node after is split first
+    // as splitting a node shifts the ones following it
+    result =
+            module_redis_command_helper_set_nodes_split(nodes, node_index + 1) &&
+            module_redis_command_helper_set_nodes_split(nodes, node_index);
+
+end:
+    if (left_buffer) {
+        module_redis_command_helper_buffer_free(left_buffer, left_buffer_size);
+    }
+
+    if (right_buffer) {
+        module_redis_command_helper_buffer_free(right_buffer, right_buffer_size);
+    }
+
+    module_redis_command_helper_buffer_free(
+            entries,
+            MAX(sizeof(module_redis_command_helper_set_entry_t) * node.count, 1));
+
+    return result;
+}
+
+static bool module_redis_command_helper_set_node_load(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        uint32_t node_index,
+        module_redis_command_helper_set_node_t *node) {
+    memset(node, 0, sizeof(module_redis_command_helper_set_node_t));
+
+    if (unlikely(node_index >= set->nodes.count)) {
+        return false;
+    }
+
+    if (set->editable && set->nodes.buffers[node_index]) {
+        return module_redis_command_helper_set_node_view(
+                set->nodes.buffers[node_index],
+                set->nodes.lengths[node_index],
+                node);
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+            set->chunk_sequence,
+            set->editable ? set->nodes.chunk_indexes[node_index] : 1 + node_index);
+
+    bool data_allocated = false;
+    char *data = storage_db_get_chunk_data(db, chunk_info, &data_allocated);
+    if (unlikely(!data)) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_command_helper_set_node_view(data, chunk_info->chunk_length, node))) {
+        if (data_allocated) {
+            ffma_mem_free(data);
+        }
+
+        return false;
+    }
+
+    node->data_allocated = data_allocated;
+
+    return true;
+}
+
+static module_redis_command_helper_set_node_t *module_redis_command_helper_set_node_get(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        uint32_t node_index) {
+    // While the set is being edited the nodes can be changed, split or removed so they are loaded every time
+    if (set->editable) {
+        module_redis_command_helper_set_node_cleanup(&set->lookup_node);
+
+        if (unlikely(!module_redis_command_helper_set_node_load(db, set, node_index, &set->lookup_node))) {
+            return NULL;
+        }
+
+        return &set->lookup_node;
+    }
+
+    if (!set->nodes.loaded) {
+        set->nodes.loaded = module_redis_command_helper_buffer_alloc_zero(
+                sizeof(module_redis_command_helper_set_node_t) * set->nodes.count);
+
+        if (unlikely(!set->nodes.loaded)) {
+            return NULL;
+        }
+    }
+
+    module_redis_command_helper_set_node_t *node = &set->nodes.loaded[node_index];
+    if (!node->data) {
+        if (unlikely(!module_redis_command_helper_set_node_load(db, set, node_index, node))) {
+            return NULL;
+        }
+    }
+
+    return node;
+}
+
+bool module_redis_command_helper_set_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_set_t *set) {
+    storage_db_chunk_sequence_t *chunk_sequence = entry_index->value;
+    module_redis_command_helper_set_header_t *header;
+
+    memset(set, 0, sizeof(module_redis_command_helper_set_t));
+
+    if (unlikely(chunk_sequence->count < 1)) {
+        return false;
+    }
+
+    // Only the header, or the intset, is loaded, the nodes are loaded when needed
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, 0);
+    if (unlikely(chunk_info->chunk_length < sizeof(module_redis_command_helper_set_header_t))) {
+        return false;
+    }
+
+    set->header_data = storage_db_get_chunk_data(db, chunk_info, &set->header_data_allocated);
+    if (unlikely(!set->header_data)) {
+        return false;
+    }
+
+    set->chunk_sequence = chunk_sequence;
+    set->header_data_length = chunk_info->chunk_length;
+
+    header = (module_redis_command_helper_set_header_t*)set->header_data;
+    set->encoding = header->encoding;
+    set->count = header->count;
+
+    if (likely(set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET)) {
+        set->integers = (int64_t*)(set->header_data + sizeof(module_redis_command_helper_set_header_t));
+
+        if (unlikely(chunk_sequence->count != 1 || set->header_data_length !=
+                sizeof(module_redis_command_helper_set_header_t) + (sizeof(int64_t) * set->count))) {
+            module_redis_command_helper_set_cleanup(set);
+            return false;
+        }
+    } else if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_HASHTABLE) {
+        if (unlikely(chunk_sequence->count != 1 + header->nodes_count || set->header_data_length !=
+                sizeof(module_redis_command_helper_set_header_t) + (sizeof(uint32_t) * header->nodes_count))) {
+            module_redis_command_helper_set_cleanup(set);
+            return false;
+        }
+
+        // The keys of the nodes are used in place until the set is edited
+        set->nodes.keys = (uint32_t*)(set->header_data + sizeof(module_redis_command_helper_set_header_t));
+        set->nodes.count = header->nodes_count;
+    } else {
+        module_redis_command_helper_set_cleanup(set);
+        return false;
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_set_count(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        uint32_t *count) {
+    module_redis_command_helper_set_header_t header;
+    storage_db_chunk_sequence_t *chunk_sequence = entry_index->value;
+
+    // The header is always contained in the first chunk, only the header is read to avoid to copy the large sets
+    if (unlikely(chunk_sequence->size < sizeof(module_redis_command_helper_set_header_t))) {
+        return false;
+    }
+
+    if (unlikely(!storage_db_chunk_read(
+            db,
+            storage_db_chunk_sequence_get(chunk_sequence, 0),
+            (char*)&header,
+            0,
+            sizeof(module_redis_command_helper_set_header_t)))) {
+        return false;
+    }
+
+    *count = header.count;
+
+    return true;
+}
+
+void module_redis_command_helper_set_init(
+        module_redis_command_helper_set_t *set,
+        module_redis_command_helper_set_encoding_t encoding) {
+    memset(set, 0, sizeof(module_redis_command_helper_set_t));
+    set->encoding = encoding;
+}
+
+void module_redis_command_helper_set_cleanup(
+        module_redis_command_helper_set_t *set) {
+    module_redis_command_helper_set_node_cleanup(&set->lookup_node);
+
+    if (set->edit_integers.list) {
+        module_redis_command_helper_buffer_free(
+                set->edit_integers.list,
+                sizeof(int64_t) * set->edit_integers.size);
+        set->edit_integers.list = NULL;
+    }
+
+    if (set->editable) {
+        module_redis_command_helper_set_nodes_free(&set->nodes);
+    } else {
+        module_redis_command_helper_set_nodes_loaded_free(&set->nodes);
+    }
+
+    if (set->header_data && set->header_data_allocated) {
+        ffma_mem_free(set->header_data);
+    }
+
+    set->header_data = NULL;
+    set->header_data_allocated = false;
+}
+
+static bool module_redis_command_helper_set_convert_to_hashtable(
+        module_redis_command_helper_set_t *set) {
+    bool result = false;
+    char *buffer = NULL;
+    uint32_t buffer_size, length;
+    uint32_t count = set->edit_integers.count;
+    char *strings = module_redis_command_helper_buffer_alloc(
+            MAX(MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH * count, 1));
+    module_redis_command_helper_set_entry_t *entries = module_redis_command_helper_buffer_alloc(
+            MAX(sizeof(module_redis_command_helper_set_entry_t) * count, 1));
+
+    if (unlikely(!strings || !entries)) {
+        goto end;
+    }
+
+    for(uint32_t index = 0; index < count; index++) {
+        char *member = strings + (MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH * index);
+        size_t member_length = module_redis_command_helper_set_int64_to_member(
+                set->edit_integers.list[index],
+                member);
+
+        entries[index].member = member;
+        entries[index].member_length = member_length;
+        entries[index].hash = module_redis_command_helper_set_member_hash(member, member_length);
+    }
+
+    // The integers are packed in a single node which is then split as needed
+    buffer = module_redis_command_helper_set_node_build(entries, count, &buffer_size, &length);
+    if (unlikely(!buffer)) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_set_nodes_insert(&set->nodes, 0, 0, buffer, buffer_size, length))) {
+        module_redis_command_helper_buffer_free(buffer, buffer_size);
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_set_nodes_split(&set->nodes, 0))) {
+        goto end;
+    }
+
+    module_redis_command_helper_buffer_free(
+            set->edit_integers.list,
+            sizeof(int64_t) * set->edit_integers.size);
+    set->edit_integers.list = NULL;
+    set->edit_integers.count = 0;
+    set->edit_integers.size = 0;
+
+    set->encoding = MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_HASHTABLE;
+    result = true;
+
+end:
+    if (strings) {
+        module_redis_command_helper_buffer_free(strings, MAX(MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH * count, 1));
+    }
+
+    if (entries) {
+        module_redis_command_helper_buffer_free(
+                entries,
+                MAX(sizeof(module_redis_command_helper_set_entry_t) * count, 1));
+    }
+
+    return result;
+}
+
+bool module_redis_command_helper_set_contains(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        char *member,
+        size_t member_length) {
+    int64_t value;
+
+    if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+        if (!module_redis_command_helper_set_member_to_int64(member, member_length, &value)) {
+            return false;
+        }
+
+        return module_redis_command_helper_set_contains_int64(db, set, value);
+    }
+
+    if (set->nodes.count == 0) {
+        return false;
+    }
+
+    uint32_t member_hash = module_redis_command_helper_set_member_hash(member, member_length);
+    module_redis_command_helper_set_node_t *node = module_redis_command_helper_set_node_get(
+            db,
+            set,
+            module_redis_command_helper_set_nodes_locate(&set->nodes, member_hash));
+
+    if (unlikely(!node)) {
+        return false;
+    }
+
+    return module_redis_command_helper_set_node_find(node, member, member_length, member_hash) != -1;
+}
+
+bool module_redis_command_helper_set_contains_int64(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        int64_t value) {
+    uint32_t position;
+
+    if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+        return set->editable
+                ? module_redis_command_helper_set_intset_search(
+                        set->edit_integers.list,
+                        set->edit_integers.count,
+                        value,
+                        &position)
+                : module_redis_command_helper_set_intset_search(
+                        set->integers,
+                        set->count,
+                        value,
+                        &position);
+    }
+
+    char member[MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH];
+    size_t member_length = module_redis_command_helper_set_int64_to_member(value, member);
+
+    return module_redis_command_helper_set_contains(db, set, member, member_length);
+}
+
+bool module_redis_command_helper_set_iter(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        module_redis_command_helper_set_iter_t *iter,
+        char **member,
+        size_t *member_length) {
+    if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+        int64_t *integers = set->editable ? set->edit_integers.list : set->integers;
+        uint32_t count = set->editable ? set->edit_integers.count : set->count;
+
+        if (iter->index >= count) {
+            return false;
+        }
+
+        *member = iter->integer_buffer;
+        *member_length = module_redis_command_helper_set_int64_to_member(
+                integers[iter->index],
+                iter->integer_buffer);
+        iter->index++;
+
+        return true;
+    }
+
+    while(iter->node.data == NULL || iter->index >= iter->node.count) {
+        if (iter->node.data) {
+            module_redis_command_helper_set_node_cleanup(&iter->node);
+            iter->node_index++;
+        }
+
+        if (iter->node_index >= set->nodes.count) {
+            return false;
+        }
+
+        // The nodes loaded when the set isn't being edited are kept by the set, the iterator uses them directly
+        if (set->editable) {
+            if (unlikely(!module_redis_command_helper_set_node_load(db, set, iter->node_index, &iter->node))) {
+                return false;
+            }
+        } else {
+            module_redis_command_helper_set_node_t *node = module_redis_command_helper_set_node_get(
+                    db,
+                    set,
+                    iter->node_index);
+
+            if (unlikely(!node)) {
+                return false;
+            }
+
+            iter->node = *node;
+            iter->node.data_allocated = false;
+        }
+
+        iter->ptr = iter->node.entries_start;
+        iter->index = 0;
+    }
+
+    char *entry_ptr = module_redis_command_helper_set_entry_decode(
+            iter->ptr,
+            iter->node.entries_end,
+            member,
+            member_length);
+
+    if (unlikely(entry_ptr == NULL)) {
+        return false;
+    }
+
+    iter->ptr = entry_ptr;
+    iter->index++;
+
+    return true;
+}
+
+void module_redis_command_helper_set_iter_cleanup(
+        module_redis_command_helper_set_iter_t *iter) {
+    module_redis_command_helper_set_node_cleanup(&iter->node);
+}
+
+bool module_redis_command_helper_set_edit_begin(
+        module_redis_command_helper_set_t *set) {
+    if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+        set->edit_integers.size = set->count + 8;
+        set->edit_integers.count = set->count;
+        set->edit_integers.list = module_redis_command_helper_buffer_alloc(sizeof(int64_t) * set->edit_integers.size);
+
+        if (unlikely(!set->edit_integers.list)) {
+            return false;
+        }
+
+        if (set->count > 0) {
+            memcpy(set->edit_integers.list, set->integers, sizeof(int64_t) * set->count);
+        }
+    } else {
+        module_redis_command_helper_set_nodes_t nodes_edit = { 0 };
+        module_redis_command_helper_set_nodes_t *nodes = &set->nodes;
+
+        if (unlikely(!module_redis_command_helper_set_nodes_arrays_alloc(
+                &nodes_edit,
+                MIN(nodes->count + 16, MODULE_REDIS_COMMAND_HELPER_SET_NODES_MAX)))) {
+            return false;
+        }
+
+        nodes_edit.count = nodes->count;
+
+        // Only the arrays are copied, the nodes are copied in their own buffer when they are changed
+        for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+            nodes_edit.keys[node_index] = nodes->keys[node_index];
+            nodes_edit.chunk_indexes[node_index] = 1 + node_index;
+            nodes_edit.lengths[node_index] = storage_db_chunk_sequence_get(
+                    set->chunk_sequence,
+                    nodes_edit.chunk_indexes[node_index])->chunk_length;
+            nodes_edit.buffers_sizes[node_index] = 0;
+        }
+
+        module_redis_command_helper_set_nodes_loaded_free(nodes);
+        set->nodes = nodes_edit;
+    }
+
+    set->editable = true;
+
+    return true;
+}
+
+bool module_redis_command_helper_set_add(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        char *member,
+        size_t member_length,
+        bool *added) {
+    module_redis_command_helper_set_node_t node = { 0 };
+    module_redis_command_helper_set_nodes_t *nodes = &set->nodes;
+
+    assert(set->editable);
+    *added = false;
+
+    if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+        int64_t value;
+        uint32_t position;
+
+        if (module_redis_command_helper_set_member_to_int64(member, member_length, &value)) {
+            if (module_redis_command_helper_set_intset_search(
+                    set->edit_integers.list,
+                    set->edit_integers.count,
+                    value,
+                    &position)) {
+                return true;
+            }
+
+            if (likely(set->edit_integers.count < MODULE_REDIS_COMMAND_HELPER_SET_INTSET_MAX_ENTRIES)) {
+                if (unlikely(set->edit_integers.count == set->edit_integers.size)) {
+                    uint32_t new_size = MIN(
+                            set->edit_integers.size * 2,
+                            MODULE_REDIS_COMMAND_HELPER_SET_INTSET_MAX_ENTRIES);
+                    int64_t *new_list = module_redis_command_helper_buffer_realloc(
+                            set->edit_integers.list,
+                            sizeof(int64_t) * set->edit_integers.size,
+                            sizeof(int64_t) * new_size,
+                            false);
+
+                    if (unlikely(!new_list)) {
+                        set->edit_integers.list = NULL;
+                        set->edit_integers.size = 0;
+                        set->edit_integers.count = 0;
+                        return false;
+                    }
+
+                    set->edit_integers.list = new_list;
+                    set->edit_integers.size = new_size;
+                }
+
+                memmove(
+                        set->edit_integers.list + position + 1,
+                        set->edit_integers.list + position,
+                        sizeof(int64_t) * (set->edit_integers.count - position));
+                set->edit_integers.list[position] = value;
+                set->edit_integers.count++;
+                set->count++;
+                *added = true;
+
+                return true;
+            }
+        }
+
+        // The member isn't an integer or the intset is full, the set has to be converted to the hashtable encoding
+        if (unlikely(!module_redis_command_helper_set_convert_to_hashtable(set))) {
+            return false;
+        }
+    }
+
+    if (unlikely(!module_redis_command_helper_set_member_fits(member_length))) {
+        return false;
+    }
+
+    // The lookup node might point to the buffer of the node being changed
+    module_redis_command_helper_set_node_cleanup(&set->lookup_node);
+
+    if (nodes->count == 0) {
+        uint32_t buffer_size, length;
+        char *buffer = module_redis_command_helper_set_node_build(NULL, 0, &buffer_size, &length);
+
+        if (unlikely(!buffer)) {
+            return false;
+        }
+
+        if (unlikely(!module_redis_command_helper_set_nodes_insert(nodes, 0, 0, buffer, buffer_size, length))) {
+            module_redis_command_helper_buffer_free(buffer, buffer_size);
+            return false;
+        }
+    }
+
+    uint32_t member_hash = module_redis_command_helper_set_member_hash(member, member_length);
+    uint32_t node_index = module_redis_command_helper_set_nodes_locate(nodes, member_hash);
+    size_t entry_length = module_redis_command_helper_set_entry_length(member_length);
+
+    // The lookup is done on the current version of the node first, the node is copied only if the member is added
+    if (unlikely(!module_redis_command_helper_set_node_load(db, set, node_index, &node))) {
+        return false;
+    }
+
+    bool found = module_redis_command_helper_set_node_find(&node, member, member_length, member_hash) != -1;
+    uint32_t node_count = node.count, node_groups_count = node.groups_count;
+    module_redis_command_helper_set_node_cleanup(&node);
+
+    if (found) {
+        return true;
+    }
+
+    if (node_count + 1 > node_groups_count * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_LOAD) {
+        // The index is full, the node is rebuilt with an index twice as big
+        uint32_t buffer_size, length;
+        module_redis_command_helper_set_entry_t *entries;
+
+        if (unlikely(!module_redis_command_helper_set_node_load(db, set, node_index, &node))) {
+            return false;
+        }
+
+        entries = module_redis_command_helper_set_node_entries_collect(&node, 1);
+        if (unlikely(!entries)) {
+            module_redis_command_helper_set_node_cleanup(&node);
+            return false;
+        }
+
+        entries[node.count].member = member;
+        entries[node.count].member_length = member_length;
+        entries[node.count].hash = member_hash;
+
+        char *buffer = module_redis_command_helper_set_node_build(entries, node.count + 1, &buffer_size, &length);
+
+        module_redis_command_helper_buffer_free(
+                entries,
+                MAX(sizeof(module_redis_command_helper_set_entry_t) * (node.count + 1), 1));
+        module_redis_command_helper_set_node_cleanup(&node);
+
+        if (unlikely(!buffer)) {
+            return false;
+        }
+
+        module_redis_command_helper_set_nodes_replace(nodes, node_index, buffer, buffer_size, length);
+    } else {
+        // Only the node containing the member is copied to be modified, the member is appended to the entries
+        if (unlikely(!module_redis_command_helper_set_nodes_prepare_buffer(db, set, node_index, entry_length))) {
+            return false;
+        }
+
+        char *buffer = nodes->buffers[node_index];
+        char *entry_ptr = buffer + nodes->lengths[node_index];
+        entry_ptr = module_redis_command_helper_varint_write(entry_ptr, member_length);
+        memcpy(entry_ptr, member, member_length);
+
+        module_redis_command_helper_set_node_view(buffer, nodes->lengths[node_index] + entry_length, &node);
+        module_redis_command_helper_set_node_index_insert(
+                &node,
+                member_hash,
+                nodes->lengths[node_index] - (node.entries_start - buffer));
+
+        ((module_redis_command_helper_set_node_header_t*)buffer)->count++;
+        nodes->lengths[node_index] += entry_length;
+    }
+
+    set->count++;
+    *added = true;
+
+    return module_redis_command_helper_set_nodes_split(nodes, node_index);
+}
+
+bool module_redis_command_helper_set_remove(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        char *member,
+        size_t member_length,
+        bool *removed) {
+    module_redis_command_helper_set_node_t node = { 0 };
+    module_redis_command_helper_set_nodes_t *nodes = &set->nodes;
+
+    assert(set->editable);
+    *removed = false;
+
+    if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+        int64_t value;
+        uint32_t position;
+
+        if (!module_redis_command_helper_set_member_to_int64(member, member_length, &value)) {
+            return true;
+        }
+
+        if (!module_redis_command_helper_set_intset_search(
+                set->edit_integers.list,
+                set->edit_integers.count,
+                value,
+                &position)) {
+            return true;
+        }
+
+        memmove(
+                set->edit_integers.list + position,
+                set->edit_integers.list + position + 1,
+                sizeof(int64_t) * (set->edit_integers.count - position - 1));
+        set->edit_integers.count--;
+        set->count--;
+        *removed = true;
+
+        return true;
+    }
+
+    if (nodes->count == 0) {
+        return true;
+    }
+
+    // The lookup node might point to the buffer of the node being changed
+    module_redis_command_helper_set_node_cleanup(&set->lookup_node);
+
+    uint32_t member_hash = module_redis_command_helper_set_member_hash(member, member_length);
+    uint32_t node_index = module_redis_command_helper_set_nodes_locate(nodes, member_hash);
+
+    // The lookup is done on the current version of the node first, the node is copied only if the member is removed
+    if (unlikely(!module_redis_command_helper_set_node_load(db, set, node_index, &node))) {
+        return false;
+    }
+
+    bool found = module_redis_command_helper_set_node_find(&node, member, member_length, member_hash) != -1;
+    module_redis_command_helper_set_node_cleanup(&node);
+
+    if (!found) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_set_nodes_prepare_buffer(db, set, node_index, 0))) {
+        return false;
+    }
+
+    char *buffer = nodes->buffers[node_index];
+    module_redis_command_helper_set_node_view(buffer, nodes->lengths[node_index], &node);
+
+    int64_t slot = module_redis_command_helper_set_node_find(&node, member, member_length, member_hash);
+    uint32_t group_index = slot / MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS;
+    uint32_t slot_index = slot % MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS;
+    module_redis_command_helper_set_group_t *group = &node.groups[group_index];
+    bool group_was_full = group->count == MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS;
+    uint32_t entry_offset = node.entries_offsets[slot];
+    size_t entry_length = module_redis_command_helper_set_entry_length(member_length);
+    char *entry_ptr = node.entries_start + entry_offset;
+
+    // The entries following the one removed are moved back, keeping the order in which they have been added
+    memmove(entry_ptr, entry_ptr + entry_length, node.entries_end - (entry_ptr + entry_length));
+    nodes->lengths[node_index] -= entry_length;
+
+    for(uint32_t index = 0; index < node.groups_count; index++) {
+        for(uint32_t group_slot_index = 0; group_slot_index < node.groups[index].count; group_slot_index++) {
+            uint32_t *offset = &node.entries_offsets[
+                    (index * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) + group_slot_index];
+            if (*offset > entry_offset) {
+                *offset -= entry_length;
+            }
+        }
+    }
+
+    // The last slot of the group is moved in place of the one removed
+    uint32_t slot_last = (group_index * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) + group->count - 1;
+    group->hashes[slot_index] = group->hashes[group->count - 1];
+    node.entries_offsets[slot] = node.entries_offsets[slot_last];
+    group->hashes[group->count - 1] = 0;
+    group->count--;
+
+    ((module_redis_command_helper_set_node_header_t*)buffer)->count--;
+    node.count--;
+
+    set->count--;
+    *removed = true;
+
+    if (node.count == 0) {
+        module_redis_command_helper_set_nodes_remove(nodes, node_index);
+        return true;
+    }
+
+    // The lookups stop at the first group that isn't full, if the group was full the members that overflowed from it
+    // would not be found anymore so the index is rebuilt, it's also shrunk if the node has lost most of its members
+    if (group_was_full || node.groups_count > module_redis_command_helper_set_node_groups_count(node.count) * 2) {
+        uint32_t buffer_size, length;
+        module_redis_command_helper_set_entry_t *entries;
+
+        module_redis_command_helper_set_node_view(buffer, nodes->lengths[node_index], &node);
+
+        entries = module_redis_command_helper_set_node_entries_collect(&node, 0);
+        if (unlikely(!entries)) {
+            return false;
+        }
+
+        char *new_buffer = module_redis_command_helper_set_node_build(entries, node.count, &buffer_size, &length);
+
+        module_redis_command_helper_buffer_free(
+                entries,
+                MAX(sizeof(module_redis_command_helper_set_entry_t) * node.count, 1));
+
+        if (unlikely(!new_buffer)) {
+            return false;
+        }
+
+        module_redis_command_helper_set_nodes_replace(nodes, node_index, new_buffer, buffer_size, length);
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_set_merge(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        module_redis_command_helper_set_t *other_set) {
+    bool result = true;
+    module_redis_command_helper_set_iter_t iter = { 0 };
+    char *member;
+    size_t member_length;
+    bool added;
+
+    assert(set->editable);
+
+    // The members are copied in the nodes of the set so they can be added straight away
+    while(result && module_redis_command_helper_set_iter(db, other_set, &iter, &member, &member_length)) {
+        result = module_redis_command_helper_set_add(db, set, member, member_length, &added);
+    }
+
+    module_redis_command_helper_set_iter_cleanup(&iter);
+
+    return result;
+}
+
+static storage_db_chunk_sequence_t *module_redis_command_helper_set_write_buffer(
+        storage_db_t *db,
+        char *buffer,
+        size_t buffer_length) {
+    storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_allocate(db, buffer_length);
+    if (unlikely(!chunk_sequence)) {
+        return NULL;
+    }
+
+    size_t buffer_offset = 0;
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (unlikely(!storage_db_chunk_write(
+                db,
+                chunk_info,
+                0,
+                buffer + buffer_offset,
+                chunk_info->chunk_length))) {
+            storage_db_chunk_sequence_free(db, chunk_sequence);
+            return NULL;
+        }
+
+        buffer_offset += chunk_info->chunk_length;
+    }
+
+    return chunk_sequence;
+}
+
+static storage_db_chunk_sequence_t *module_redis_command_helper_set_serialize_intset(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set) {
+    storage_db_chunk_sequence_t *chunk_sequence;
+    size_t buffer_length = sizeof(module_redis_command_helper_set_header_t) + (sizeof(int64_t) * set->count);
+
+    char *buffer = module_redis_command_helper_buffer_alloc_zero(buffer_length);
+    if (unlikely(!buffer)) {
+        return NULL;
+    }
+
+    module_redis_command_helper_set_header_t *header = (module_redis_command_helper_set_header_t*)buffer;
+    header->encoding = MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET;
+    header->count = set->count;
+
+    if (set->count > 0) {
+        memcpy(
+                buffer + sizeof(module_redis_command_helper_set_header_t),
+                set->edit_integers.list,
+                sizeof(int64_t) * set->count);
+    }
+
+    chunk_sequence = module_redis_command_helper_set_write_buffer(db, buffer, buffer_length);
+    module_redis_command_helper_buffer_free(buffer, buffer_length);
+
+    return chunk_sequence;
+}
+
+static storage_db_chunk_sequence_t *module_redis_command_helper_set_serialize_hashtable(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set) {
+    bool result = false;
+    char *header_data = NULL;
+    storage_db_chunk_index_t chunk_index = 0;
+    storage_db_chunk_sequence_t *chunk_sequence;
+    module_redis_command_helper_set_nodes_t *nodes = &set->nodes;
+    size_t header_length = sizeof(module_redis_command_helper_set_header_t) + (sizeof(uint32_t) * nodes->count);
+
+    chunk_sequence = storage_db_chunk_sequence_new(1 + nodes->count);
+    if (unlikely(!chunk_sequence)) {
+        return NULL;
+    }
+
+    header_data = module_redis_command_helper_buffer_alloc(header_length);
+    if (unlikely(!header_data)) {
+        goto end;
+    }
+
+    module_redis_command_helper_set_header_t *header = (module_redis_command_helper_set_header_t*)header_data;
+    header->encoding = MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_HASHTABLE;
+    header->count = set->count;
+    header->nodes_count = nodes->count;
+    header->reserved = 0;
+
+    if (nodes->count > 0) {
+        memcpy(
+                header_data + sizeof(module_redis_command_helper_set_header_t),
+                nodes->keys,
+                sizeof(uint32_t) * nodes->count);
+    }
+
+    storage_db_chunk_info_t *chunk_info_header = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+    if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info_header, header_length))) {
+        goto end;
+    }
+
+    chunk_index++;
+    chunk_sequence->size += header_length;
+
+    if (unlikely(!storage_db_chunk_write(db, chunk_info_header, 0, header_data, header_length))) {
+        goto end;
+    }
+
+    for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (nodes->buffers[node_index]) {
+            if (unlikely(nodes->lengths[node_index] > STORAGE_DB_CHUNK_MAX_SIZE)) {
+                goto end;
+            }
+
+            if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info, nodes->lengths[node_index]))) {
+                goto end;
+            }
+
+            chunk_index++;
+
+            if (unlikely(!storage_db_chunk_write(
+                    db,
+                    chunk_info,
+                    0,
+                    nodes->buffers[node_index],
+                    nodes->lengths[node_index]))) {
+                goto end;
+            }
+        } else {
+            // The nodes not touched by the update are shared with the current version of the set
+            if (unlikely(!storage_db_chunk_data_share(
+                    db,
+                    storage_db_chunk_sequence_get(set->chunk_sequence, nodes->chunk_indexes[node_index]),
+                    chunk_info))) {
+                goto end;
+            }
+
+            chunk_index++;
+        }
+
+        chunk_sequence->size += chunk_info->chunk_length;
+    }
+
+    assert(chunk_index == chunk_sequence->count);
+
+    result = true;
+
+end:
+    if (header_data) {
+        module_redis_command_helper_buffer_free(header_data, header_length);
+    }
+
+    if (unlikely(!result)) {
+        // Only the chunks already initialized have to be freed
+        chunk_sequence->count = chunk_index;
+        storage_db_chunk_sequence_free(db, chunk_sequence);
+        ffma_mem_free(chunk_sequence);
+        chunk_sequence = NULL;
+    }
+
+    return chunk_sequence;
+}
+
+storage_db_chunk_sequence_t *module_redis_command_helper_set_serialize(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set) {
+    assert(set->editable);
+
+    return set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET
+            ? module_redis_command_helper_set_serialize_intset(db, set)
+            : module_redis_command_helper_set_serialize_hashtable(db, set);
+}
+
+bool module_redis_command_helper_set_send_members(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_set_t *set) {
+    bool result = false;
+    module_redis_command_helper_set_iter_t iter = { 0 };
+    char *member;
+    size_t member_length;
+
+    if (unlikely(!module_redis_connection_send_set_header(connection_context, set->count))) {
+        return false;
+    }
+
+    for(uint32_t index = 0; index < set->count; index++) {
+        if (unlikely(!module_redis_command_helper_set_iter(
+                connection_context->db,
+                set,
+                &iter,
+                &member,
+                &member_length))) {
+            goto end;
+        }
+
+        if (unlikely(!module_redis_connection_send_blob_string(connection_context, member, member_length))) {
+            goto end;
+        }
+    }
+
+    result = true;
+
+end:
+    module_redis_command_helper_set_iter_cleanup(&iter);
+
+    return result;
+}
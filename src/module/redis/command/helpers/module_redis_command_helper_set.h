@@ -0,0 +1,319 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SET_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The sets are serialized in the value of the entry index (so they work transparently with every storage backend)
+// using two different encodings:
+// - intset, used for the sets containing only integers, the integers are stored sorted as int64 so the lookups are
+//   binary searches and the intersections can be computed merging the arrays, the intsets always fit in a chunk
+// - hashtable, used for all the other sets, the members are distributed in nodes by the hash of the member and every
+//   node is mapped on its own chunk
+//
+// The layout of the hashtable encoding is
+//   chunk 0 (header) | chunk 1 (node 0) | chunk 2 (node 1) | ... | chunk n (node n - 1)
+// where the header contains the lowest hash of the members of every node packed in an array (the first node always
+// starts from 0 and each node contains the members with a hash lower than the first hash of the next one)
+//   header | nodes_keys[n]
+// and every node is an open-addressing hashtable, the members are packed one after the other prefixed by their
+// length encoded as varint and are preceded by the index
+//   node_header | groups[groups_count] | entries_offsets[groups_count * 14] | entries
+//
+// The index is made of groups of 14 slots, as the chunks of the half hashes of the hashtable mcmp, so the same SIMD
+// kernels can be used to search the hash of a member in a group. The groups are filled in order and the members
+// overflow in the next group when one is full, a lookup can stop as soon as it finds a group that isn't full.
+//
+// As for the lists and the sorted sets the nodes are immutable, SADD and SREM copy only the nodes containing the
+// members being changed and the new version of the set shares all the other nodes with the previous one.
+#define MODULE_REDIS_COMMAND_HELPER_SET_INTSET_MAX_ENTRIES \
+    ((STORAGE_DB_CHUNK_MAX_SIZE - sizeof(module_redis_command_helper_set_header_t)) / sizeof(int64_t))
+#define MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS 14
+#define MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_LOAD 10
+#define MODULE_REDIS_COMMAND_HELPER_SET_NODE_MAX_SIZE (16 * 1024)
+#define MODULE_REDIS_COMMAND_HELPER_SET_NODES_MAX \
+    ((FFMA_OBJECT_SIZE_MAX / sizeof(storage_db_chunk_info_t)) - 1)
+// A member bigger than a node gets a dedicated node, which has still to fit in a chunk together with the index of a
+// single group and the length of the member, up to 3 bytes as varint
+#define MODULE_REDIS_COMMAND_HELPER_SET_MEMBER_MAX_LENGTH \
+    (STORAGE_DB_CHUNK_MAX_SIZE - sizeof(module_redis_command_helper_set_node_header_t) - \
+     sizeof(module_redis_command_helper_set_group_t) - \
+     (sizeof(uint32_t) * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) - 3)
+#define MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH 20
+
+#define MODULE_REDIS_COMMAND_HELPER_SET_NAME_IFUNC(NAME) module_redis_command_helper_set_##NAME
+#define MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IFUNC(NAME, ARGS) MODULE_REDIS_COMMAND_HELPER_SET_NAME_IFUNC(NAME) ARGS
+
+#define MODULE_REDIS_COMMAND_HELPER_SET_NAME_IMPL(NAME, METHOD) module_redis_command_helper_set_##NAME##_##METHOD
+#define MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(NAME, METHOD, ARGS) \
+    MODULE_REDIS_COMMAND_HELPER_SET_NAME_IMPL(NAME, METHOD) ARGS
+
+enum module_redis_command_helper_set_encoding {
+    MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET = 1,
+    MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_HASHTABLE = 2,
+};
+typedef enum module_redis_command_helper_set_encoding module_redis_command_helper_set_encoding_t;
+
+typedef struct module_redis_command_helper_set_header module_redis_command_helper_set_header_t;
+struct module_redis_command_helper_set_header {
+    uint32_t encoding;
+    uint32_t count;
+    uint32_t nodes_count;
+    uint32_t reserved;
+};
+
+typedef struct module_redis_command_helper_set_node_header module_redis_command_helper_set_node_header_t;
+struct module_redis_command_helper_set_node_header {
+    uint32_t count;
+    uint32_t groups_count;
+};
+
+typedef struct module_redis_command_helper_set_group module_redis_command_helper_set_group_t;
+struct module_redis_command_helper_set_group {
+    uint32_t hashes[MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS];
+    uint32_t count;
+    uint32_t reserved;
+};
+
+typedef struct module_redis_command_helper_set_node module_redis_command_helper_set_node_t;
+struct module_redis_command_helper_set_node {
+    char *data;
+    size_t length;
+    bool data_allocated;
+    uint32_t count;
+    uint32_t groups_count;
+    module_redis_command_helper_set_group_t *groups;
+    uint32_t *entries_offsets;
+    char *entries_start;
+    char *entries_end;
+};
+
+// When the set is being edited the nodes being changed get their own buffer, with the same layout of the serialized
+// nodes, and the chunk indexes point to the chunks of the current version of the nodes not changed. The nodes loaded
+// when the set is not being edited are kept until the cleanup so the members returned stay valid.
+typedef struct module_redis_command_helper_set_nodes module_redis_command_helper_set_nodes_t;
+struct module_redis_command_helper_set_nodes {
+    uint32_t *keys;
+    uint32_t *chunk_indexes;
+    uint32_t *lengths;
+    uint32_t *buffers_sizes;
+    char **buffers;
+    module_redis_command_helper_set_node_t *loaded;
+    uint32_t count;
+    uint32_t size;
+};
+
+typedef struct module_redis_command_helper_set module_redis_command_helper_set_t;
+struct module_redis_command_helper_set {
+    storage_db_chunk_sequence_t *chunk_sequence;
+    char *header_data;
+    size_t header_data_length;
+    bool header_data_allocated;
+    bool editable;
+    module_redis_command_helper_set_encoding_t encoding;
+    uint32_t count;
+    int64_t *integers;
+    struct {
+        int64_t *list;
+        uint32_t count;
+        uint32_t size;
+    } edit_integers;
+    module_redis_command_helper_set_nodes_t nodes;
+    // The node of the last lookup done while the set is being edited, if the node hasn't been changed yet
+    module_redis_command_helper_set_node_t lookup_node;
+};
+
+typedef struct module_redis_command_helper_set_iter module_redis_command_helper_set_iter_t;
+struct module_redis_command_helper_set_iter {
+    uint32_t index;
+    uint32_t node_index;
+    char *ptr;
+    module_redis_command_helper_set_node_t node;
+    char integer_buffer[MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH + 1];
+};
+
+// The intersection of two intsets, the integers of a and b must be sorted and unique. The intersection can be written
+// in place of a as it never writes ahead of the element of a being checked.
+uint32_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IFUNC(intset_intersect, (
+        int64_t *a, uint32_t a_count, int64_t *b, uint32_t b_count, int64_t *result));
+uint32_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(intset_intersect, sw, (
+        int64_t *a, uint32_t a_count, int64_t *b, uint32_t b_count, int64_t *result));
+uint32_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(intset_intersect, avx2, (
+        int64_t *a, uint32_t a_count, int64_t *b, uint32_t b_count, int64_t *result));
+
+// Searches a member in a node, returns the index of the slot containing it or -1 if it's not found
+int64_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IFUNC(node_find, (
+        module_redis_command_helper_set_node_t *node, char *member, size_t member_length, uint32_t member_hash));
+int64_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(node_find, sw, (
+        module_redis_command_helper_set_node_t *node, char *member, size_t member_length, uint32_t member_hash));
+int64_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(node_find, avx2, (
+        module_redis_command_helper_set_node_t *node, char *member, size_t member_length, uint32_t member_hash));
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_set_member_hash(
+        char *member,
+        size_t member_length) {
+    return fnv_32_hash(member, member_length);
+}
+
+static inline __attribute__((always_inline)) bool module_redis_command_helper_set_member_fits(
+        size_t member_length) {
+    return member_length <= MODULE_REDIS_COMMAND_HELPER_SET_MEMBER_MAX_LENGTH;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_set_entry_decode(
+        char *entry_ptr,
+        char *entries_end,
+        char **member,
+        size_t *member_length) {
+    uint32_t length;
+
+    if (unlikely((entry_ptr = module_redis_command_helper_varint_read(entry_ptr, entries_end, &length)) == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(entry_ptr + length > entries_end)) {
+        return NULL;
+    }
+
+    *member = entry_ptr;
+    *member_length = length;
+
+    return entry_ptr + length;
+}
+
+// Searches the hash of the member in the groups of the index of the node with the search function passed, the
+// implementations of node_find only differ by the SIMD kernel used
+static inline __attribute__((always_inline)) int64_t module_redis_command_helper_set_node_find_internal(
+        module_redis_command_helper_set_node_t *node,
+        char *member,
+        size_t member_length,
+        uint32_t member_hash,
+        uint32_t (*search_func)(uint32_t hash, uint32_t *hashes, uint32_t skip_indexes_mask)) {
+    uint32_t groups_mask = node->groups_count - 1;
+    uint32_t group_index = member_hash & groups_mask;
+
+    for(uint32_t probes = 0; probes < node->groups_count; probes++) {
+        module_redis_command_helper_set_group_t *group = &node->groups[group_index];
+        uint32_t group_count = MIN(group->count, MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS);
+
+        // The slots not used have to be skipped, the hashes are set to zero but zero is a valid hash
+        uint32_t skip_indexes_mask = ~((1u << group_count) - 1);
+
+        while(true) {
+            char *entry_member;
+            size_t entry_member_length;
+            uint32_t slot_index = search_func(member_hash, group->hashes, skip_indexes_mask);
+
+            if (slot_index >= MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) {
+                break;
+            }
+
+            skip_indexes_mask |= 1u << slot_index;
+
+            uint32_t slot = (group_index * MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) + slot_index;
+            if (unlikely(module_redis_command_helper_set_entry_decode(
+                    node->entries_start + node->entries_offsets[slot],
+                    node->entries_end,
+                    &entry_member,
+                    &entry_member_length) == NULL)) {
+                return -1;
+            }
+
+            if (entry_member_length == member_length && memcmp(entry_member, member, member_length) == 0) {
+                return slot;
+            }
+        }
+
+        if (group_count < MODULE_REDIS_COMMAND_HELPER_SET_HASHTABLE_GROUP_SLOTS) {
+            break;
+        }
+
+        group_index = (group_index + 1) & groups_mask;
+    }
+
+    return -1;
+}
+
+bool module_redis_command_helper_set_member_to_int64(
+        char *member,
+        size_t member_length,
+        int64_t *value);
+
+size_t module_redis_command_helper_set_int64_to_member(
+        int64_t value,
+        char *buffer);
+
+bool module_redis_command_helper_set_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_set_t *set);
+
+bool module_redis_command_helper_set_count(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        uint32_t *count);
+
+void module_redis_command_helper_set_init(
+        module_redis_command_helper_set_t *set,
+        module_redis_command_helper_set_encoding_t encoding);
+
+void module_redis_command_helper_set_cleanup(
+        module_redis_command_helper_set_t *set);
+
+bool module_redis_command_helper_set_contains(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        char *member,
+        size_t member_length);
+
+bool module_redis_command_helper_set_contains_int64(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        int64_t value);
+
+bool module_redis_command_helper_set_iter(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        module_redis_command_helper_set_iter_t *iter,
+        char **member,
+        size_t *member_length);
+
+void module_redis_command_helper_set_iter_cleanup(
+        module_redis_command_helper_set_iter_t *iter);
+
+bool module_redis_command_helper_set_edit_begin(
+        module_redis_command_helper_set_t *set);
+
+bool module_redis_command_helper_set_add(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        char *member,
+        size_t member_length,
+        bool *added);
+
+bool module_redis_command_helper_set_remove(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        char *member,
+        size_t member_length,
+        bool *removed);
+
+bool module_redis_command_helper_set_merge(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set,
+        module_redis_command_helper_set_t *other_set);
+
+storage_db_chunk_sequence_t *module_redis_command_helper_set_serialize(
+        storage_db_t *db,
+        module_redis_command_helper_set_t *set);
+
+bool module_redis_command_helper_set_send_members(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_set_t *set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SET_H
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <immintrin.h>
+#include <numa.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "hash/hash_fnv1.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/mcmp/hashtable_support_hash_search_avx2.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+
+#include "module_redis_command_helper_varint.h"
+#include "module_redis_command_helper_set.h"
+
+// Number of int64 compared at once
+#define MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE 4
+
+static uint32_t module_redis_command_helper_set_hash_search_avx2(
+        uint32_t hash,
+        uint32_t *hashes,
+        uint32_t skip_indexes_mask) {
+    return hashtable_mcmp_support_hash_search_avx2_14(hash, hashes, skip_indexes_mask);
+}
+
+uint32_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(intset_intersect, avx2, (
+        int64_t *a,
+        uint32_t a_count,
+        int64_t *b,
+        uint32_t b_count,
+        int64_t *result)) {
+    uint32_t result_count = 0, a_index = 0, b_index = 0;
+
+    // Same algorithm of the sw implementation but the galloping in b is done on blocks of 4 integers, comparing only
+    // the last integer of each block, and the block found is then compared at once with a single AVX2 comparison
+    while(a_index < a_count && b_index + MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE <= b_count) {
+        int64_t value = a[a_index];
+
+        if (b[b_index + MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE - 1] < value) {
+            uint32_t low = b_index, step = 1, blocks_low, blocks_high;
+
+            while(low + ((step + 1) * MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE) <= b_count &&
+                  b[low + ((step + 1) * MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE) - 1] < value) {
+                low += step * MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE;
+                step <<= 1;
+            }
+
+            // The block at low is always lower than value, the one at low + step blocks is either greater or equal or
+            // out of range
+            blocks_low = 1;
+            blocks_high = step;
+            while(blocks_low < blocks_high) {
+                uint32_t blocks_middle = blocks_low + ((blocks_high - blocks_low) / 2);
+                uint32_t block_last = low + ((blocks_middle + 1) * MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE) - 1;
+
+                if (block_last < b_count && b[block_last] < value) {
+                    blocks_low = blocks_middle + 1;
+                } else {
+                    blocks_high = blocks_middle;
+                }
+            }
+
+            b_index = low + (blocks_low * MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE);
+            if (b_index + MODULE_REDIS_COMMAND_HELPER_SET_AVX2_BLOCK_SIZE > b_count) {
+                break;
+            }
+        }
+
+        __m256i block_vector = _mm256_loadu_si256((__m256i*)(b + b_index));
+        __m256i cmp_vector = _mm256_set1_epi64x(value);
+        uint32_t mask = (uint32_t)_mm256_movemask_pd(
+                _mm256_castsi256_pd(_mm256_cmpeq_epi64(block_vector, cmp_vector)));
+
+        if (mask) {
+            result[result_count++] = value;
+            b_index += _tzcnt_u32(mask) + 1;
+        }
+
+        a_index++;
+    }
+
+    // The tail of b, shorter than a block, is handled by the sw implementation, a_index is always greater or equal
+    // than result_count so the intersection can still be computed in place
+    if (a_index < a_count && b_index < b_count) {
+        result_count += MODULE_REDIS_COMMAND_HELPER_SET_NAME_IMPL(intset_intersect, sw)(
+                a + a_index,
+                a_count - a_index,
+                b + b_index,
+                b_count - b_index,
+                result + result_count);
+    }
+
+    return result_count;
+}
+
+int64_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(node_find, avx2, (
+        module_redis_command_helper_set_node_t *node,
+        char *member,
+        size_t member_length,
+        uint32_t member_hash)) {
+    return module_redis_command_helper_set_node_find_internal(
+            node,
+            member,
+            member_length,
+            member_hash,
+            module_redis_command_helper_set_hash_search_avx2);
+}
@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <numa.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "hash/hash_fnv1.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/mcmp/hashtable_support_hash_search_loop.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+
+#include "module_redis_command_helper_varint.h"
+#include "module_redis_command_helper_set.h"
+
+static uint32_t module_redis_command_helper_set_hash_search_loop(
+        uint32_t hash,
+        uint32_t *hashes,
+        uint32_t skip_indexes_mask) {
+    return hashtable_mcmp_support_hash_search_loop_14(hash, hashes, skip_indexes_mask);
+}
+
+uint32_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(intset_intersect, sw, (
+        int64_t *a,
+        uint32_t a_count,
+        int64_t *b,
+        uint32_t b_count,
+        int64_t *result)) {
+    uint32_t result_count = 0, b_index = 0;
+
+    // a is expected to be the smallest intset, for each integer the position in b is searched galloping from the last
+    // position found, so the cost is logarithmic in the distance between the matches and not linear in the size of b
+    for(uint32_t a_index = 0; a_index < a_count && b_index < b_count; a_index++) {
+        int64_t value = a[a_index];
+
+        if (b[b_index] < value) {
+            uint32_t low = b_index, high, step = 1;
+
+            while(low + step < b_count && b[low + step] < value) {
+                low += step;
+                step <<= 1;
+            }
+            high = MIN(low + step, b_count);
+
+            low++;
+            while(low < high) {
+                uint32_t middle = low + ((high - low) / 2);
+
+                if (b[middle] < value) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+
+            b_index = low;
+            if (b_index == b_count) {
+                break;
+            }
+        }
+
+        if (b[b_index] == value) {
+            result[result_count++] = value;
+            b_index++;
+        }
+    }
+
+    return result_count;
+}
+
+int64_t MODULE_REDIS_COMMAND_HELPER_SET_SIGNATURE_IMPL(node_find, sw, (
+        module_redis_command_helper_set_node_t *node,
+        char *member,
+        size_t member_length,
+        uint32_t member_hash)) {
+    return module_redis_command_helper_set_node_find_internal(
+            node,
+            member,
+            member_length,
+            member_hash,
+            module_redis_command_helper_set_hash_search_loop);
+}
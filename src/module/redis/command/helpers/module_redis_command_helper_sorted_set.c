@@ -0,0 +1,1694 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "hash/hash_fnv1.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_command_helper_buffer.h"
+#include "module_redis_command_helper_varint.h"
+#include "module_redis_command_helper_sorted_set.h"
+
+#define TAG "module_redis_command_helper_sorted_set"
+
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE (sizeof(uint32_t) + sizeof(double))
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_SPLIT_MAX_PIECES 8
+
+static inline __attribute__((always_inline)) uint64_t module_redis_command_helper_sorted_set_score_to_key(
+        double score) {
+    uint64_t bits;
+
+    // -0.0 and 0.0 are equal, they have to be mapped to the same key
+    score = score == 0 ? 0.0 : score;
+    memcpy(&bits, &score, sizeof(bits));
+
+    // The sign bit is flipped for the positive numbers and all the bits are flipped for the negative ones so the
+    // integers have the same ordering of the doubles
+    return (bits & (1ULL << 63)) ? ~bits : bits | (1ULL << 63);
+}
+
+static inline __attribute__((always_inline)) double module_redis_command_helper_sorted_set_score_normalize(
+        double score) {
+    // -0.0 and 0.0 are equal but they would be mapped to different keys
+    return score == 0 ? 0.0 : score;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_sorted_set_member_hash(
+        char *member,
+        size_t member_length) {
+    return fnv_32_hash(member, member_length);
+}
+
+static inline __attribute__((always_inline)) int module_redis_command_helper_sorted_set_entry_compare(
+        double score_a,
+        char *member_a,
+        size_t member_a_length,
+        double score_b,
+        char *member_b,
+        size_t member_b_length) {
+    if (score_a != score_b) {
+        return score_a < score_b ? -1 : 1;
+    }
+
+    int result = memcmp(member_a, member_b, MIN(member_a_length, member_b_length));
+    if (result != 0) {
+        return result;
+    }
+
+    return member_a_length == member_b_length ? 0 : (member_a_length < member_b_length ? -1 : 1);
+}
+
+static inline __attribute__((always_inline)) size_t module_redis_command_helper_sorted_set_score_entry_length(
+        size_t member_length) {
+    return sizeof(double) + module_redis_command_helper_varint_length(member_length) + member_length;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_sorted_set_score_entry_read(
+        char *ptr,
+        char *end,
+        double *score,
+        char **member,
+        uint32_t *member_length) {
+    if (unlikely(ptr + sizeof(double) > end)) {
+        return NULL;
+    }
+
+    memcpy(score, ptr, sizeof(double));
+    ptr += sizeof(double);
+
+    if (unlikely((ptr = module_redis_command_helper_varint_read(ptr, end, member_length)) == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(ptr + *member_length > end)) {
+        return NULL;
+    }
+
+    *member = ptr;
+
+    return ptr + *member_length;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_sorted_set_score_entry_write(
+        char *ptr,
+        double score,
+        char *member,
+        size_t member_length) {
+    memcpy(ptr, &score, sizeof(double));
+    ptr = module_redis_command_helper_varint_write(ptr + sizeof(double), member_length);
+    memcpy(ptr, member, member_length);
+
+    return ptr + member_length;
+}
+
+static inline __attribute__((always_inline)) void module_redis_command_helper_sorted_set_hash_entry_read(
+        char *ptr,
+        uint32_t *hash,
+        double *score) {
+    memcpy(hash, ptr, sizeof(uint32_t));
+    memcpy(score, ptr + sizeof(uint32_t), sizeof(double));
+}
+
+static inline __attribute__((always_inline)) void module_redis_command_helper_sorted_set_hash_entry_write(
+        char *ptr,
+        uint32_t hash,
+        double score) {
+    memcpy(ptr, &hash, sizeof(uint32_t));
+    memcpy(ptr + sizeof(uint32_t), &score, sizeof(double));
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_sorted_set_keys_lower_bound(
+        uint64_t *keys,
+        uint32_t count,
+        uint64_t key) {
+    uint32_t low = 0, high = count;
+
+    while(low < high) {
+        uint32_t mid = low + ((high - low) >> 1);
+        if (keys[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_sorted_set_keys_upper_bound(
+        uint64_t *keys,
+        uint32_t count,
+        uint64_t key) {
+    uint32_t low = 0, high = count;
+
+    while(low < high) {
+        uint32_t mid = low + ((high - low) >> 1);
+        if (keys[mid] <= key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static uint32_t module_redis_command_helper_sorted_set_hash_node_bound(
+        char *data,
+        uint32_t count,
+        uint32_t hash,
+        bool upper) {
+    uint32_t low = 0, high = count;
+
+    while(low < high) {
+        uint32_t mid = low + ((high - low) >> 1), mid_hash;
+        memcpy(&mid_hash, data + (mid * MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE), sizeof(uint32_t));
+
+        if (mid_hash < hash || (upper && mid_hash == hash)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static inline __attribute__((always_inline)) uint32_t module_redis_command_helper_sorted_set_nodes_chunk_index(
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t node_index) {
+    return sorted_set->editable
+        ? nodes->chunk_indexes[node_index]
+        : nodes->chunk_index_first + node_index;
+}
+
+static void module_redis_command_helper_sorted_set_nodes_arrays_free(
+        module_redis_command_helper_sorted_set_nodes_t *nodes) {
+    if (nodes->keys) {
+        module_redis_command_helper_buffer_free(nodes->keys, sizeof(uint64_t) * nodes->size);
+    }
+
+    if (nodes->counts) {
+        module_redis_command_helper_buffer_free(nodes->counts, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->chunk_indexes) {
+        module_redis_command_helper_buffer_free(nodes->chunk_indexes, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->lengths) {
+        module_redis_command_helper_buffer_free(nodes->lengths, sizeof(uint32_t) * nodes->size);
+    }
+
+    if (nodes->buffers) {
+        module_redis_command_helper_buffer_free(nodes->buffers, sizeof(char*) * nodes->size);
+    }
+}
+
+static bool module_redis_command_helper_sorted_set_nodes_arrays_alloc(
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t size) {
+    nodes->size = size;
+    nodes->keys = module_redis_command_helper_buffer_alloc(sizeof(uint64_t) * size);
+    nodes->counts = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->chunk_indexes = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->lengths = module_redis_command_helper_buffer_alloc(sizeof(uint32_t) * size);
+    nodes->buffers = module_redis_command_helper_buffer_alloc_zero(sizeof(char*) * size);
+
+    if (unlikely(!nodes->keys || !nodes->counts || !nodes->chunk_indexes || !nodes->lengths || !nodes->buffers)) {
+        module_redis_command_helper_sorted_set_nodes_arrays_free(nodes);
+        memset(nodes, 0, sizeof(module_redis_command_helper_sorted_set_nodes_t));
+        return false;
+    }
+
+    return true;
+}
+
+static void module_redis_command_helper_sorted_set_nodes_free(
+        module_redis_command_helper_sorted_set_nodes_t *nodes) {
+    if (nodes->buffers) {
+        for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+            if (nodes->buffers[node_index]) {
+                ffma_mem_free(nodes->buffers[node_index]);
+            }
+        }
+    }
+
+    module_redis_command_helper_sorted_set_nodes_arrays_free(nodes);
+
+    memset(nodes, 0, sizeof(module_redis_command_helper_sorted_set_nodes_t));
+}
+
+static bool module_redis_command_helper_sorted_set_nodes_edit_begin(
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        module_redis_command_helper_sorted_set_nodes_t *nodes) {
+    module_redis_command_helper_sorted_set_nodes_t nodes_edit = { 0 };
+    uint32_t size = MIN(nodes->count + 16, MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODES_MAX);
+
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_arrays_alloc(&nodes_edit, size))) {
+        return false;
+    }
+
+    nodes_edit.count = nodes->count;
+
+    for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+        nodes_edit.keys[node_index] = nodes->keys[node_index];
+        nodes_edit.counts[node_index] = nodes->counts[node_index];
+        nodes_edit.chunk_indexes[node_index] = nodes->chunk_index_first + node_index;
+        nodes_edit.lengths[node_index] = storage_db_chunk_sequence_get(
+                sorted_set->chunk_sequence,
+                nodes_edit.chunk_indexes[node_index])->chunk_length;
+    }
+
+    *nodes = nodes_edit;
+
+    return true;
+}
+
+static bool module_redis_command_helper_sorted_set_nodes_reserve(
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t count) {
+    module_redis_command_helper_sorted_set_nodes_t nodes_new = { 0 };
+
+    if (likely(nodes->count + count <= nodes->size)) {
+        return true;
+    }
+
+    if (unlikely(nodes->count + count > MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODES_MAX)) {
+        return false;
+    }
+
+    // The new arrays are all allocated before touching the current ones, if an allocation fails the nodes are left
+    // untouched and will be freed by the cleanup
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_arrays_alloc(
+            &nodes_new,
+            MIN(MAX(nodes->size * 2, nodes->count + count), MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODES_MAX)))) {
+        return false;
+    }
+
+    memcpy(nodes_new.keys, nodes->keys, sizeof(uint64_t) * nodes->count);
+    memcpy(nodes_new.counts, nodes->counts, sizeof(uint32_t) * nodes->count);
+    memcpy(nodes_new.chunk_indexes, nodes->chunk_indexes, sizeof(uint32_t) * nodes->count);
+    memcpy(nodes_new.lengths, nodes->lengths, sizeof(uint32_t) * nodes->count);
+    memcpy(nodes_new.buffers, nodes->buffers, sizeof(char*) * nodes->count);
+    nodes_new.count = nodes->count;
+    nodes_new.chunk_index_first = nodes->chunk_index_first;
+
+    // The buffers of the nodes have been moved to the new arrays, only the current arrays have to be freed
+    module_redis_command_helper_sorted_set_nodes_arrays_free(nodes);
+    *nodes = nodes_new;
+
+    return true;
+}
+
+static bool module_redis_command_helper_sorted_set_nodes_insert(
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t node_index,
+        uint64_t key) {
+    // The new nodes are always backed by a buffer, they will be written out when the sorted set is serialized
+    char *buffer = ffma_mem_alloc(STORAGE_DB_CHUNK_MAX_SIZE);
+    if (unlikely(!buffer)) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_reserve(nodes, 1))) {
+        ffma_mem_free(buffer);
+        return false;
+    }
+
+    uint32_t move_count = nodes->count - node_index;
+    memmove(&nodes->keys[node_index + 1], &nodes->keys[node_index], sizeof(uint64_t) * move_count);
+    memmove(&nodes->counts[node_index + 1], &nodes->counts[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->chunk_indexes[node_index + 1], &nodes->chunk_indexes[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->lengths[node_index + 1], &nodes->lengths[node_index], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers[node_index + 1], &nodes->buffers[node_index], sizeof(char*) * move_count);
+
+    nodes->keys[node_index] = key;
+    nodes->counts[node_index] = 0;
+    nodes->chunk_indexes[node_index] = 0;
+    nodes->lengths[node_index] = 0;
+    nodes->buffers[node_index] = buffer;
+    nodes->count++;
+
+    return true;
+}
+
+static void module_redis_command_helper_sorted_set_nodes_remove(
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t node_index) {
+    if (nodes->buffers[node_index]) {
+        ffma_mem_free(nodes->buffers[node_index]);
+    }
+
+    uint32_t move_count = nodes->count - node_index - 1;
+    memmove(&nodes->keys[node_index], &nodes->keys[node_index + 1], sizeof(uint64_t) * move_count);
+    memmove(&nodes->counts[node_index], &nodes->counts[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->chunk_indexes[node_index], &nodes->chunk_indexes[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->lengths[node_index], &nodes->lengths[node_index + 1], sizeof(uint32_t) * move_count);
+    memmove(&nodes->buffers[node_index], &nodes->buffers[node_index + 1], sizeof(char*) * move_count);
+
+    nodes->count--;
+    nodes->buffers[nodes->count] = NULL;
+}
+
+static bool module_redis_command_helper_sorted_set_nodes_prepare_buffer(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t node_index) {
+    if (nodes->buffers[node_index]) {
+        return true;
+    }
+
+    // The buffer is always big enough to hold a node growing over the max size by one entry before being split
+    char *buffer = ffma_mem_alloc(STORAGE_DB_CHUNK_MAX_SIZE);
+    if (unlikely(!buffer)) {
+        return false;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+            sorted_set->chunk_sequence,
+            nodes->chunk_indexes[node_index]);
+    if (unlikely(!storage_db_chunk_read(db, chunk_info, buffer, 0, chunk_info->chunk_length))) {
+        ffma_mem_free(buffer);
+        return false;
+    }
+
+    nodes->buffers[node_index] = buffer;
+    nodes->lengths[node_index] = chunk_info->chunk_length;
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_sorted_set_t *sorted_set) {
+    module_redis_command_helper_sorted_set_header_t *header;
+    storage_db_chunk_sequence_t *chunk_sequence = entry_index->value;
+
+    memset(sorted_set, 0, sizeof(module_redis_command_helper_sorted_set_t));
+
+    if (unlikely(chunk_sequence->count < 1)) {
+        return false;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, 0);
+    if (unlikely(chunk_info->chunk_length < sizeof(module_redis_command_helper_sorted_set_header_t))) {
+        return false;
+    }
+
+    sorted_set->header_data = storage_db_get_chunk_data(db, chunk_info, &sorted_set->header_data_allocated);
+    if (unlikely(!sorted_set->header_data)) {
+        return false;
+    }
+
+    header = (module_redis_command_helper_sorted_set_header_t*)sorted_set->header_data;
+    uint32_t nodes_count = header->score_nodes_count + header->hash_nodes_count;
+
+    if (unlikely(chunk_sequence->count != 1 + nodes_count ||
+            chunk_info->chunk_length != sizeof(module_redis_command_helper_sorted_set_header_t) +
+                ((sizeof(uint64_t) + sizeof(uint32_t)) * nodes_count))) {
+        module_redis_command_helper_sorted_set_cleanup(sorted_set);
+        return false;
+    }
+
+    sorted_set->chunk_sequence = chunk_sequence;
+    sorted_set->encoding = header->encoding;
+    sorted_set->count = header->count;
+
+    // The arrays of the header are used in place until the sorted set is edited
+    uint64_t *keys = (uint64_t*)(sorted_set->header_data + sizeof(module_redis_command_helper_sorted_set_header_t));
+    uint32_t *counts = (uint32_t*)(keys + nodes_count);
+
+    sorted_set->score_nodes.keys = keys;
+    sorted_set->score_nodes.counts = counts;
+    sorted_set->score_nodes.count = header->score_nodes_count;
+    sorted_set->score_nodes.chunk_index_first = 1;
+
+    sorted_set->hash_nodes.keys = keys + header->score_nodes_count;
+    sorted_set->hash_nodes.counts = counts + header->score_nodes_count;
+    sorted_set->hash_nodes.count = header->hash_nodes_count;
+    sorted_set->hash_nodes.chunk_index_first = 1 + header->score_nodes_count;
+
+    return true;
+}
+
+void module_redis_command_helper_sorted_set_init(
+        module_redis_command_helper_sorted_set_t *sorted_set) {
+    memset(sorted_set, 0, sizeof(module_redis_command_helper_sorted_set_t));
+
+    sorted_set->encoding = MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ENCODING_LISTPACK;
+    sorted_set->editable = true;
+}
+
+bool module_redis_command_helper_sorted_set_edit_begin(
+        module_redis_command_helper_sorted_set_t *sorted_set) {
+    if (sorted_set->editable) {
+        return true;
+    }
+
+    module_redis_command_helper_sorted_set_nodes_t score_nodes = sorted_set->score_nodes;
+    module_redis_command_helper_sorted_set_nodes_t hash_nodes = sorted_set->hash_nodes;
+
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_edit_begin(sorted_set, &score_nodes))) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_edit_begin(sorted_set, &hash_nodes))) {
+        module_redis_command_helper_sorted_set_nodes_free(&score_nodes);
+        return false;
+    }
+
+    sorted_set->score_nodes = score_nodes;
+    sorted_set->hash_nodes = hash_nodes;
+    sorted_set->editable = true;
+
+    return true;
+}
+
+void module_redis_command_helper_sorted_set_cleanup(
+        module_redis_command_helper_sorted_set_t *sorted_set) {
+    if (sorted_set->editable) {
+        module_redis_command_helper_sorted_set_nodes_free(&sorted_set->score_nodes);
+        module_redis_command_helper_sorted_set_nodes_free(&sorted_set->hash_nodes);
+    }
+
+    if (sorted_set->header_data_allocated) {
+        ffma_mem_free(sorted_set->header_data);
+    }
+
+    memset(sorted_set, 0, sizeof(module_redis_command_helper_sorted_set_t));
+}
+
+bool module_redis_command_helper_sorted_set_node_load(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t node_index,
+        module_redis_command_helper_sorted_set_node_t *node) {
+    memset(node, 0, sizeof(module_redis_command_helper_sorted_set_node_t));
+
+    if (unlikely(node_index >= nodes->count)) {
+        return false;
+    }
+
+    node->count = nodes->counts[node_index];
+
+    if (sorted_set->editable && nodes->buffers[node_index]) {
+        node->data = nodes->buffers[node_index];
+        node->length = nodes->lengths[node_index];
+        return true;
+    }
+
+    storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(
+            sorted_set->chunk_sequence,
+            module_redis_command_helper_sorted_set_nodes_chunk_index(sorted_set, nodes, node_index));
+
+    node->data = storage_db_get_chunk_data(db, chunk_info, &node->data_allocated);
+    if (unlikely(!node->data)) {
+        return false;
+    }
+
+    node->length = chunk_info->chunk_length;
+
+    return true;
+}
+
+void module_redis_command_helper_sorted_set_node_cleanup(
+        module_redis_command_helper_sorted_set_node_t *node) {
+    if (node->data_allocated) {
+        ffma_mem_free(node->data);
+    }
+
+    node->data = NULL;
+    node->data_allocated = false;
+}
+
+static bool module_redis_command_helper_sorted_set_score_locate(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        double score,
+        char *member,
+        size_t member_length,
+        uint32_t *node_index,
+        size_t *offset,
+        uint32_t *position,
+        bool *found) {
+    double entry_score;
+    char *entry_member;
+    uint32_t entry_member_length, entry_position = 0;
+    bool result = false;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->score_nodes;
+    module_redis_command_helper_sorted_set_node_t node = { 0 };
+    uint64_t key = module_redis_command_helper_sorted_set_score_to_key(score);
+
+    *node_index = 0;
+    *offset = 0;
+    *position = 0;
+    *found = false;
+
+    if (nodes->count == 0) {
+        return true;
+    }
+
+    uint32_t index = module_redis_command_helper_sorted_set_keys_upper_bound(nodes->keys, nodes->count, key);
+    index = index > 0 ? index - 1 : 0;
+
+    // The keys don't contain the members, if more nodes start with the same score the first entry of each one has to be
+    // checked to find the node the entry belongs to
+    do {
+        if (unlikely(!module_redis_command_helper_sorted_set_node_load(db, sorted_set, nodes, index, &node))) {
+            goto end;
+        }
+
+        if (index == 0 || nodes->keys[index] != key) {
+            break;
+        }
+
+        if (unlikely(!module_redis_command_helper_sorted_set_score_entry_read(
+                node.data,
+                node.data + node.length,
+                &entry_score,
+                &entry_member,
+                &entry_member_length))) {
+            goto end;
+        }
+
+        if (module_redis_command_helper_sorted_set_entry_compare(
+                score, member, member_length, entry_score, entry_member, entry_member_length) >= 0) {
+            break;
+        }
+
+        module_redis_command_helper_sorted_set_node_cleanup(&node);
+        index--;
+    } while(true);
+
+    char *ptr = node.data, *end = node.data + node.length;
+    while(ptr < end) {
+        char *next = module_redis_command_helper_sorted_set_score_entry_read(
+                ptr,
+                end,
+                &entry_score,
+                &entry_member,
+                &entry_member_length);
+        if (unlikely(!next)) {
+            goto end;
+        }
+
+        int compare = module_redis_command_helper_sorted_set_entry_compare(
+                score, member, member_length, entry_score, entry_member, entry_member_length);
+        if (compare <= 0) {
+            *found = compare == 0;
+            break;
+        }
+
+        ptr = next;
+        entry_position++;
+    }
+
+    *node_index = index;
+    *offset = ptr - node.data;
+    *position = entry_position;
+    result = true;
+
+end:
+    module_redis_command_helper_sorted_set_node_cleanup(&node);
+
+    return result;
+}
+
+bool module_redis_command_helper_sorted_set_member_find(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double *score,
+        bool *found) {
+    double entry_score;
+    char *entry_member;
+    uint32_t entry_member_length;
+    module_redis_command_helper_sorted_set_node_t node = { 0 };
+
+    *found = false;
+
+    if (sorted_set->encoding == MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ENCODING_LISTPACK) {
+        module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->score_nodes;
+
+        for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+            if (unlikely(!module_redis_command_helper_sorted_set_node_load(db, sorted_set, nodes, node_index, &node))) {
+                return false;
+            }
+
+            char *ptr = node.data, *end = node.data + node.length;
+            while(ptr < end) {
+                if (unlikely((ptr = module_redis_command_helper_sorted_set_score_entry_read(
+                        ptr,
+                        end,
+                        &entry_score,
+                        &entry_member,
+                        &entry_member_length)) == NULL)) {
+                    module_redis_command_helper_sorted_set_node_cleanup(&node);
+                    return false;
+                }
+
+                if (entry_member_length == member_length && memcmp(entry_member, member, member_length) == 0) {
+                    *score = entry_score;
+                    *found = true;
+                    module_redis_command_helper_sorted_set_node_cleanup(&node);
+                    return true;
+                }
+            }
+
+            module_redis_command_helper_sorted_set_node_cleanup(&node);
+        }
+
+        return true;
+    }
+
+    // The entries with the same hash might be at the end of the node preceding the first one starting with the hash
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->hash_nodes;
+    uint32_t hash = module_redis_command_helper_sorted_set_member_hash(member, member_length);
+    uint32_t node_index = module_redis_command_helper_sorted_set_keys_lower_bound(nodes->keys, nodes->count, hash);
+    node_index = node_index > 0 ? node_index - 1 : 0;
+
+    for(; node_index < nodes->count && nodes->keys[node_index] <= hash; node_index++) {
+        if (unlikely(!module_redis_command_helper_sorted_set_node_load(db, sorted_set, nodes, node_index, &node))) {
+            return false;
+        }
+
+        for(
+                uint32_t position = module_redis_command_helper_sorted_set_hash_node_bound(
+                        node.data, node.count, hash, false);
+                position < node.count;
+                position++) {
+            uint32_t entry_hash, score_node_index, score_position;
+            size_t score_offset;
+            bool score_found;
+
+            module_redis_command_helper_sorted_set_hash_entry_read(
+                    node.data + (position * MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE),
+                    &entry_hash,
+                    &entry_score);
+
+            if (entry_hash != hash) {
+                break;
+            }
+
+            // Different members can have the same hash, the member has to be checked in the score nodes
+            if (unlikely(!module_redis_command_helper_sorted_set_score_locate(
+                    db,
+                    sorted_set,
+                    entry_score,
+                    member,
+                    member_length,
+                    &score_node_index,
+                    &score_offset,
+                    &score_position,
+                    &score_found))) {
+                module_redis_command_helper_sorted_set_node_cleanup(&node);
+                return false;
+            }
+
+            if (score_found) {
+                *score = entry_score;
+                *found = true;
+                module_redis_command_helper_sorted_set_node_cleanup(&node);
+                return true;
+            }
+        }
+
+        module_redis_command_helper_sorted_set_node_cleanup(&node);
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_rank(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        uint64_t *rank,
+        bool *found) {
+    double score;
+    size_t offset;
+    uint32_t node_index, position;
+
+    if (unlikely(!module_redis_command_helper_sorted_set_member_find(
+            db,
+            sorted_set,
+            member,
+            member_length,
+            &score,
+            found))) {
+        return false;
+    }
+
+    if (!*found) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_score_locate(
+            db,
+            sorted_set,
+            score,
+            member,
+            member_length,
+            &node_index,
+            &offset,
+            &position,
+            found))) {
+        return false;
+    }
+
+    *rank = position;
+    for(uint32_t index = 0; index < node_index; index++) {
+        *rank += sorted_set->score_nodes.counts[index];
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_count_below(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        double score,
+        bool inclusive,
+        uint64_t *count) {
+    double entry_score;
+    char *entry_member;
+    uint32_t entry_member_length;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->score_nodes;
+    module_redis_command_helper_sorted_set_node_t node = { 0 };
+    uint64_t key = module_redis_command_helper_sorted_set_score_to_key(score);
+
+    *count = 0;
+
+    // All the entries of the nodes starting at node_index are above the score, the entries below are either in the
+    // previous node or in the nodes preceding it
+    uint32_t node_index = inclusive
+            ? module_redis_command_helper_sorted_set_keys_upper_bound(nodes->keys, nodes->count, key)
+            : module_redis_command_helper_sorted_set_keys_lower_bound(nodes->keys, nodes->count, key);
+
+    if (node_index == 0) {
+        return true;
+    }
+
+    node_index--;
+    for(uint32_t index = 0; index < node_index; index++) {
+        *count += nodes->counts[index];
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_node_load(db, sorted_set, nodes, node_index, &node))) {
+        return false;
+    }
+
+    char *ptr = node.data, *end = node.data + node.length;
+    while(ptr < end) {
+        if (unlikely((ptr = module_redis_command_helper_sorted_set_score_entry_read(
+                ptr,
+                end,
+                &entry_score,
+                &entry_member,
+                &entry_member_length)) == NULL)) {
+            module_redis_command_helper_sorted_set_node_cleanup(&node);
+            return false;
+        }
+
+        uint64_t entry_key = module_redis_command_helper_sorted_set_score_to_key(entry_score);
+        if (entry_key > key || (!inclusive && entry_key == key)) {
+            break;
+        }
+
+        (*count)++;
+    }
+
+    module_redis_command_helper_sorted_set_node_cleanup(&node);
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_iter_init(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        uint64_t rank,
+        module_redis_command_helper_sorted_set_iter_t *iter) {
+    double entry_score;
+    char *entry_member;
+    uint32_t entry_member_length;
+    uint64_t node_first_rank = 0;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->score_nodes;
+
+    memset(iter, 0, sizeof(module_redis_command_helper_sorted_set_iter_t));
+    iter->sorted_set = sorted_set;
+
+    while(iter->node_index < nodes->count && node_first_rank + nodes->counts[iter->node_index] <= rank) {
+        node_first_rank += nodes->counts[iter->node_index];
+        iter->node_index++;
+    }
+
+    if (iter->node_index == nodes->count) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_node_load(
+            db,
+            sorted_set,
+            nodes,
+            iter->node_index,
+            &iter->node))) {
+        return false;
+    }
+
+    iter->ptr = iter->node.data;
+    for(; node_first_rank < rank; node_first_rank++) {
+        if (unlikely((iter->ptr = module_redis_command_helper_sorted_set_score_entry_read(
+                iter->ptr,
+                iter->node.data + iter->node.length,
+                &entry_score,
+                &entry_member,
+                &entry_member_length)) == NULL)) {
+            module_redis_command_helper_sorted_set_iter_cleanup(iter);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_iter_next(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_iter_t *iter,
+        double *score,
+        char **member,
+        size_t *member_length) {
+    uint32_t entry_member_length;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &iter->sorted_set->score_nodes;
+
+    while(iter->node_index < nodes->count) {
+        if (!iter->node.data) {
+            if (unlikely(!module_redis_command_helper_sorted_set_node_load(
+                    db,
+                    iter->sorted_set,
+                    nodes,
+                    iter->node_index,
+                    &iter->node))) {
+                return false;
+            }
+
+            iter->ptr = iter->node.data;
+        }
+
+        if (iter->ptr < iter->node.data + iter->node.length) {
+            if (unlikely((iter->ptr = module_redis_command_helper_sorted_set_score_entry_read(
+                    iter->ptr,
+                    iter->node.data + iter->node.length,
+                    score,
+                    member,
+                    &entry_member_length)) == NULL)) {
+                return false;
+            }
+
+            *member_length = entry_member_length;
+            return true;
+        }
+
+        module_redis_command_helper_sorted_set_node_cleanup(&iter->node);
+        iter->node_index++;
+    }
+
+    return false;
+}
+
+void module_redis_command_helper_sorted_set_iter_cleanup(
+        module_redis_command_helper_sorted_set_iter_t *iter) {
+    module_redis_command_helper_sorted_set_node_cleanup(&iter->node);
+    iter->ptr = NULL;
+}
+
+static bool module_redis_command_helper_sorted_set_nodes_split(
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t node_index,
+        bool hash_nodes) {
+    double entry_score;
+    char *entry_member;
+    uint32_t entry_member_length, pieces_count = 0, piece_count = 0;
+    size_t piece_start = 0;
+    size_t pieces_end[MODULE_REDIS_COMMAND_HELPER_SORTED_SET_SPLIT_MAX_PIECES];
+    uint32_t pieces_counts[MODULE_REDIS_COMMAND_HELPER_SORTED_SET_SPLIT_MAX_PIECES];
+    char *buffer = nodes->buffers[node_index];
+    char *ptr = buffer, *end = buffer + nodes->lengths[node_index];
+
+    // The node is split in pieces filled up to half of the max size, as in a B+tree, so the next inserts will not
+    // cause another split straight away
+    while(ptr < end) {
+        size_t entry_length;
+        if (hash_nodes) {
+            entry_length = MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE;
+        } else {
+            char *next = module_redis_command_helper_sorted_set_score_entry_read(
+                    ptr,
+                    end,
+                    &entry_score,
+                    &entry_member,
+                    &entry_member_length);
+            if (unlikely(!next)) {
+                return false;
+            }
+            entry_length = next - ptr;
+        }
+
+        if (piece_count > 0 &&
+            (ptr - buffer) - piece_start + entry_length > MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODE_MAX_SIZE / 2) {
+            if (unlikely(pieces_count == MODULE_REDIS_COMMAND_HELPER_SORTED_SET_SPLIT_MAX_PIECES - 1)) {
+                return false;
+            }
+
+            pieces_end[pieces_count] = ptr - buffer;
+            pieces_counts[pieces_count] = piece_count;
+            pieces_count++;
+
+            piece_start = ptr - buffer;
+            piece_count = 0;
+        }
+
+        ptr += entry_length;
+        piece_count++;
+    }
+
+    pieces_end[pieces_count] = end - buffer;
+    pieces_counts[pieces_count] = piece_count;
+    pieces_count++;
+
+    // The first piece stays in the current node, the others go into new nodes inserted after it
+    for(uint32_t piece_index = 1; piece_index < pieces_count; piece_index++) {
+        uint64_t key;
+        uint32_t new_node_index = node_index + piece_index;
+        char *piece = buffer + pieces_end[piece_index - 1];
+        size_t piece_length = pieces_end[piece_index] - pieces_end[piece_index - 1];
+
+        if (hash_nodes) {
+            uint32_t hash;
+            memcpy(&hash, piece, sizeof(uint32_t));
+            key = hash;
+        } else {
+            memcpy(&entry_score, piece, sizeof(double));
+            key = module_redis_command_helper_sorted_set_score_to_key(entry_score);
+        }
+
+        if (unlikely(!module_redis_command_helper_sorted_set_nodes_insert(nodes, new_node_index, key))) {
+            return false;
+        }
+
+        memcpy(nodes->buffers[new_node_index], piece, piece_length);
+        nodes->lengths[new_node_index] = piece_length;
+        nodes->counts[new_node_index] = pieces_counts[piece_index];
+    }
+
+    nodes->lengths[node_index] = pieces_end[0];
+    nodes->counts[node_index] = pieces_counts[0];
+
+    return true;
+}
+
+static bool module_redis_command_helper_sorted_set_score_insert(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        double score,
+        char *member,
+        size_t member_length) {
+    uint32_t node_index, position;
+    size_t offset;
+    bool found;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->score_nodes;
+    size_t entry_length = module_redis_command_helper_sorted_set_score_entry_length(member_length);
+
+    if (nodes->count == 0) {
+        if (unlikely(!module_redis_command_helper_sorted_set_nodes_insert(
+                nodes,
+                0,
+                module_redis_command_helper_sorted_set_score_to_key(score)))) {
+            return false;
+        }
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_score_locate(
+            db,
+            sorted_set,
+            score,
+            member,
+            member_length,
+            &node_index,
+            &offset,
+            &position,
+            &found))) {
+        return false;
+    }
+
+    assert(!found);
+
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_prepare_buffer(db, sorted_set, nodes, node_index))) {
+        return false;
+    }
+
+    char *buffer = nodes->buffers[node_index];
+    memmove(buffer + offset + entry_length, buffer + offset, nodes->lengths[node_index] - offset);
+    module_redis_command_helper_sorted_set_score_entry_write(buffer + offset, score, member, member_length);
+
+    nodes->lengths[node_index] += entry_length;
+    nodes->counts[node_index]++;
+
+    if (position == 0) {
+        nodes->keys[node_index] = module_redis_command_helper_sorted_set_score_to_key(score);
+    }
+
+    if (nodes->lengths[node_index] > MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODE_MAX_SIZE) {
+        return module_redis_command_helper_sorted_set_nodes_split(nodes, node_index, false);
+    }
+
+    return true;
+}
+
+static bool module_redis_command_helper_sorted_set_score_remove(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        double score,
+        char *member,
+        size_t member_length) {
+    uint32_t node_index, position;
+    size_t offset;
+    bool found;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->score_nodes;
+    size_t entry_length = module_redis_command_helper_sorted_set_score_entry_length(member_length);
+
+    if (unlikely(!module_redis_command_helper_sorted_set_score_locate(
+            db,
+            sorted_set,
+            score,
+            member,
+            member_length,
+            &node_index,
+            &offset,
+            &position,
+            &found))) {
+        return false;
+    }
+
+    if (unlikely(!found)) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_prepare_buffer(db, sorted_set, nodes, node_index))) {
+        return false;
+    }
+
+    char *buffer = nodes->buffers[node_index];
+    memmove(
+            buffer + offset,
+            buffer + offset + entry_length,
+            nodes->lengths[node_index] - offset - entry_length);
+
+    nodes->lengths[node_index] -= entry_length;
+    nodes->counts[node_index]--;
+
+    if (nodes->counts[node_index] == 0) {
+        module_redis_command_helper_sorted_set_nodes_remove(nodes, node_index);
+    } else if (position == 0) {
+        double first_score;
+        memcpy(&first_score, buffer, sizeof(double));
+        nodes->keys[node_index] = module_redis_command_helper_sorted_set_score_to_key(first_score);
+    }
+
+    return true;
+}
+
+static bool module_redis_command_helper_sorted_set_hash_insert(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        uint32_t hash,
+        double score) {
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->hash_nodes;
+
+    if (nodes->count == 0) {
+        if (unlikely(!module_redis_command_helper_sorted_set_nodes_insert(nodes, 0, hash))) {
+            return false;
+        }
+    }
+
+    uint32_t node_index = module_redis_command_helper_sorted_set_keys_upper_bound(nodes->keys, nodes->count, hash);
+    node_index = node_index > 0 ? node_index - 1 : 0;
+
+    if (unlikely(!module_redis_command_helper_sorted_set_nodes_prepare_buffer(db, sorted_set, nodes, node_index))) {
+        return false;
+    }
+
+    char *buffer = nodes->buffers[node_index];
+    uint32_t position = module_redis_command_helper_sorted_set_hash_node_bound(
+            buffer,
+            nodes->counts[node_index],
+            hash,
+            true);
+    size_t offset = position * MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE;
+
+    memmove(
+            buffer + offset + MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE,
+            buffer + offset,
+            nodes->lengths[node_index] - offset);
+    module_redis_command_helper_sorted_set_hash_entry_write(buffer + offset, hash, score);
+
+    nodes->lengths[node_index] += MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE;
+    nodes->counts[node_index]++;
+
+    if (position == 0) {
+        nodes->keys[node_index] = hash;
+    }
+
+    if (nodes->lengths[node_index] > MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODE_MAX_SIZE) {
+        return module_redis_command_helper_sorted_set_nodes_split(nodes, node_index, true);
+    }
+
+    return true;
+}
+
+static bool module_redis_command_helper_sorted_set_hash_remove(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        uint32_t hash,
+        double score) {
+    uint32_t entry_hash;
+    double entry_score;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->hash_nodes;
+    module_redis_command_helper_sorted_set_node_t node = { 0 };
+    uint32_t node_index = module_redis_command_helper_sorted_set_keys_lower_bound(nodes->keys, nodes->count, hash);
+    uint64_t score_key = module_redis_command_helper_sorted_set_score_to_key(score);
+
+    node_index = node_index > 0 ? node_index - 1 : 0;
+
+    for(; node_index < nodes->count && nodes->keys[node_index] <= hash; node_index++) {
+        bool found = false;
+        uint32_t position;
+
+        if (unlikely(!module_redis_command_helper_sorted_set_node_load(db, sorted_set, nodes, node_index, &node))) {
+            return false;
+        }
+
+        for(
+                position = module_redis_command_helper_sorted_set_hash_node_bound(node.data, node.count, hash, false);
+                position < node.count;
+                position++) {
+            module_redis_command_helper_sorted_set_hash_entry_read(
+                    node.data + (position * MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE),
+                    &entry_hash,
+                    &entry_score);
+
+            if (entry_hash != hash) {
+                break;
+            }
+
+            if (module_redis_command_helper_sorted_set_score_to_key(entry_score) == score_key) {
+                found = true;
+                break;
+            }
+        }
+
+        module_redis_command_helper_sorted_set_node_cleanup(&node);
+
+        if (!found) {
+            continue;
+        }
+
+        // Only the node containing the entry is copied to be modified
+        if (unlikely(!module_redis_command_helper_sorted_set_nodes_prepare_buffer(db, sorted_set, nodes, node_index))) {
+            return false;
+        }
+
+        char *buffer = nodes->buffers[node_index];
+        size_t offset = position * MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE;
+        memmove(
+                buffer + offset,
+                buffer + offset + MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE,
+                nodes->lengths[node_index] - offset - MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE);
+
+        nodes->lengths[node_index] -= MODULE_REDIS_COMMAND_HELPER_SORTED_SET_HASH_ENTRY_SIZE;
+        nodes->counts[node_index]--;
+
+        if (nodes->counts[node_index] == 0) {
+            module_redis_command_helper_sorted_set_nodes_remove(nodes, node_index);
+        } else if (position == 0) {
+            memcpy(&entry_hash, buffer, sizeof(uint32_t));
+            nodes->keys[node_index] = entry_hash;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+static bool module_redis_command_helper_sorted_set_hash_index_build(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set) {
+    double entry_score;
+    char *entry_member;
+    uint32_t entry_member_length;
+    module_redis_command_helper_sorted_set_nodes_t *nodes = &sorted_set->score_nodes;
+    module_redis_command_helper_sorted_set_node_t node = { 0 };
+
+    for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+        if (unlikely(!module_redis_command_helper_sorted_set_node_load(db, sorted_set, nodes, node_index, &node))) {
+            return false;
+        }
+
+        char *ptr = node.data, *end = node.data + node.length;
+        while(ptr < end) {
+            if (unlikely((ptr = module_redis_command_helper_sorted_set_score_entry_read(
+                    ptr,
+                    end,
+                    &entry_score,
+                    &entry_member,
+                    &entry_member_length)) == NULL)) {
+                module_redis_command_helper_sorted_set_node_cleanup(&node);
+                return false;
+            }
+
+            if (unlikely(!module_redis_command_helper_sorted_set_hash_insert(
+                    db,
+                    sorted_set,
+                    module_redis_command_helper_sorted_set_member_hash(entry_member, entry_member_length),
+                    entry_score))) {
+                module_redis_command_helper_sorted_set_node_cleanup(&node);
+                return false;
+            }
+        }
+
+        module_redis_command_helper_sorted_set_node_cleanup(&node);
+    }
+
+    sorted_set->encoding = MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ENCODING_TREE;
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_update(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double score,
+        bool *inserted) {
+    double current_score;
+    bool found;
+    bool is_tree = sorted_set->encoding == MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ENCODING_TREE;
+
+    assert(sorted_set->editable);
+    assert(member_length <= MODULE_REDIS_COMMAND_HELPER_SORTED_SET_MEMBER_MAX_LENGTH);
+
+    *inserted = false;
+    score = module_redis_command_helper_sorted_set_score_normalize(score);
+
+    if (unlikely(!module_redis_command_helper_sorted_set_member_find(
+            db,
+            sorted_set,
+            member,
+            member_length,
+            &current_score,
+            &found))) {
+        return false;
+    }
+
+    if (found) {
+        if (current_score == score) {
+            return true;
+        }
+
+        if (unlikely(!module_redis_command_helper_sorted_set_score_remove(
+                db,
+                sorted_set,
+                current_score,
+                member,
+                member_length))) {
+            return false;
+        }
+
+        if (is_tree && unlikely(!module_redis_command_helper_sorted_set_hash_remove(
+                db,
+                sorted_set,
+                module_redis_command_helper_sorted_set_member_hash(member, member_length),
+                current_score))) {
+            return false;
+        }
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_score_insert(
+            db,
+            sorted_set,
+            score,
+            member,
+            member_length))) {
+        return false;
+    }
+
+    if (is_tree && unlikely(!module_redis_command_helper_sorted_set_hash_insert(
+            db,
+            sorted_set,
+            module_redis_command_helper_sorted_set_member_hash(member, member_length),
+            score))) {
+        return false;
+    }
+
+    if (!found) {
+        sorted_set->count++;
+        *inserted = true;
+    }
+
+    if (!is_tree && (
+            sorted_set->count > MODULE_REDIS_COMMAND_HELPER_SORTED_SET_LISTPACK_MAX_ENTRIES ||
+            member_length > MODULE_REDIS_COMMAND_HELPER_SORTED_SET_LISTPACK_MAX_MEMBER_LENGTH)) {
+        return module_redis_command_helper_sorted_set_hash_index_build(db, sorted_set);
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_remove(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        bool *removed) {
+    double score;
+
+    assert(sorted_set->editable);
+
+    if (unlikely(!module_redis_command_helper_sorted_set_member_find(
+            db,
+            sorted_set,
+            member,
+            member_length,
+            &score,
+            removed))) {
+        return false;
+    }
+
+    if (!*removed) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_score_remove(
+            db,
+            sorted_set,
+            score,
+            member,
+            member_length))) {
+        return false;
+    }
+
+    if (sorted_set->encoding == MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ENCODING_TREE &&
+        unlikely(!module_redis_command_helper_sorted_set_hash_remove(
+                db,
+                sorted_set,
+                module_redis_command_helper_sorted_set_member_hash(member, member_length),
+                score))) {
+        return false;
+    }
+
+    sorted_set->count--;
+
+    return true;
+}
+
+static bool module_redis_command_helper_sorted_set_serialize_nodes(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        storage_db_chunk_sequence_t *chunk_sequence,
+        storage_db_chunk_index_t *chunk_index) {
+    for(uint32_t node_index = 0; node_index < nodes->count; node_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, *chunk_index);
+
+        if (nodes->buffers[node_index]) {
+            if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info, nodes->lengths[node_index]))) {
+                return false;
+            }
+
+            (*chunk_index)++;
+
+            if (unlikely(!storage_db_chunk_write(
+                    db,
+                    chunk_info,
+                    0,
+                    nodes->buffers[node_index],
+                    nodes->lengths[node_index]))) {
+                return false;
+            }
+        } else {
+            // The nodes not touched by the update are shared with the current version of the sorted set
+            if (unlikely(!storage_db_chunk_data_share(
+                    db,
+                    storage_db_chunk_sequence_get(sorted_set->chunk_sequence, nodes->chunk_indexes[node_index]),
+                    chunk_info))) {
+                return false;
+            }
+
+            (*chunk_index)++;
+        }
+
+        chunk_sequence->size += chunk_info->chunk_length;
+    }
+
+    return true;
+}
+
+storage_db_chunk_sequence_t *module_redis_command_helper_sorted_set_serialize(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set) {
+    bool result = false;
+    char *header_data = NULL;
+    storage_db_chunk_index_t chunk_index = 0;
+    storage_db_chunk_sequence_t *chunk_sequence;
+    module_redis_command_helper_sorted_set_nodes_t *score_nodes = &sorted_set->score_nodes;
+    module_redis_command_helper_sorted_set_nodes_t *hash_nodes = &sorted_set->hash_nodes;
+    uint32_t nodes_count = score_nodes->count + hash_nodes->count;
+    size_t header_length = sizeof(module_redis_command_helper_sorted_set_header_t) +
+            ((sizeof(uint64_t) + sizeof(uint32_t)) * nodes_count);
+
+    assert(sorted_set->editable);
+
+    if (unlikely(nodes_count > MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODES_MAX)) {
+        return NULL;
+    }
+
+    chunk_sequence = storage_db_chunk_sequence_new(1 + nodes_count);
+    if (unlikely(!chunk_sequence)) {
+        return NULL;
+    }
+
+    header_data = module_redis_command_helper_buffer_alloc(header_length);
+    if (unlikely(!header_data)) {
+        goto end;
+    }
+
+    module_redis_command_helper_sorted_set_header_t *header =
+            (module_redis_command_helper_sorted_set_header_t*)header_data;
+    header->encoding = sorted_set->encoding;
+    header->score_nodes_count = score_nodes->count;
+    header->hash_nodes_count = hash_nodes->count;
+    header->reserved = 0;
+    header->count = sorted_set->count;
+
+    uint64_t *keys = (uint64_t*)(header_data + sizeof(module_redis_command_helper_sorted_set_header_t));
+    uint32_t *counts = (uint32_t*)(keys + nodes_count);
+    memcpy(keys, score_nodes->keys, sizeof(uint64_t) * score_nodes->count);
+    memcpy(counts, score_nodes->counts, sizeof(uint32_t) * score_nodes->count);
+    if (hash_nodes->count > 0) {
+        memcpy(keys + score_nodes->count, hash_nodes->keys, sizeof(uint64_t) * hash_nodes->count);
+        memcpy(counts + score_nodes->count, hash_nodes->counts, sizeof(uint32_t) * hash_nodes->count);
+    }
+
+    storage_db_chunk_info_t *chunk_info_header = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+    if (unlikely(!storage_db_chunk_data_pre_allocate(db, chunk_info_header, header_length))) {
+        goto end;
+    }
+
+    chunk_index++;
+    chunk_sequence->size += header_length;
+
+    if (unlikely(!storage_db_chunk_write(db, chunk_info_header, 0, header_data, header_length))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_serialize_nodes(
+            db,
+            sorted_set,
+            score_nodes,
+            chunk_sequence,
+            &chunk_index))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_serialize_nodes(
+            db,
+            sorted_set,
+            hash_nodes,
+            chunk_sequence,
+            &chunk_index))) {
+        goto end;
+    }
+
+    assert(chunk_index == chunk_sequence->count);
+
+    result = true;
+
+end:
+    if (header_data) {
+        module_redis_command_helper_buffer_free(header_data, header_length);
+    }
+
+    if (unlikely(!result)) {
+        // Only the chunks already initialized have to be freed
+        chunk_sequence->count = chunk_index;
+        storage_db_chunk_sequence_free(db, chunk_sequence);
+        ffma_mem_free(chunk_sequence);
+        chunk_sequence = NULL;
+    }
+
+    return chunk_sequence;
+}
+
+bool module_redis_command_helper_sorted_set_parse_score_bound(
+        char *string,
+        size_t string_length,
+        double *score,
+        bool *exclusive) {
+    char buffer[64], *buffer_end_ptr;
+
+    *exclusive = false;
+    if (string_length > 0 && string[0] == '(') {
+        *exclusive = true;
+        string++;
+        string_length--;
+    }
+
+    if (unlikely(string_length == 0 || string_length >= sizeof(buffer))) {
+        return false;
+    }
+
+    memcpy(buffer, string, string_length);
+    buffer[string_length] = 0;
+
+    if (strcasecmp(buffer, "-inf") == 0) {
+        *score = -INFINITY;
+        return true;
+    } else if (strcasecmp(buffer, "+inf") == 0 || strcasecmp(buffer, "inf") == 0) {
+        *score = INFINITY;
+        return true;
+    }
+
+    errno = 0;
+    *score = strtod(buffer, &buffer_end_ptr);
+
+    if (unlikely(errno == ERANGE || buffer_end_ptr != buffer + string_length || isnan(*score))) {
+        return false;
+    }
+
+    return true;
+}
+
+bool module_redis_command_helper_sorted_set_send_range(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        uint64_t range_start,
+        uint64_t range_end,
+        bool with_scores) {
+    bool result = false;
+    double score;
+    char *member;
+    size_t member_length;
+    storage_db_t *db = connection_context->db;
+    module_redis_command_helper_sorted_set_iter_t iter = { 0 };
+    uint64_t count = range_end > range_start ? range_end - range_start : 0;
+
+    // With RESP3 each member and its score are sent as a pair, with RESP2 they are flattened in the reply
+    bool send_pairs = with_scores && connection_context->resp_version != PROTOCOL_REDIS_RESP_VERSION_2;
+
+    if (unlikely(!module_redis_connection_send_array_header(
+            connection_context,
+            with_scores && !send_pairs ? count * 2 : count))) {
+        return false;
+    }
+
+    if (count == 0) {
+        return true;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_iter_init(db, sorted_set, range_start, &iter))) {
+        return false;
+    }
+
+    for(uint64_t index = 0; index < count; index++) {
+        if (unlikely(!module_redis_command_helper_sorted_set_iter_next(db, &iter, &score, &member, &member_length))) {
+            goto end;
+        }
+
+        if (send_pairs && unlikely(!module_redis_connection_send_array_header(connection_context, 2))) {
+            goto end;
+        }
+
+        if (unlikely(!module_redis_connection_send_blob_string(connection_context, member, member_length))) {
+            goto end;
+        }
+
+        if (with_scores && unlikely(!module_redis_connection_send_double(connection_context, score))) {
+            goto end;
+        }
+    }
+
+    result = true;
+
+end:
+    module_redis_command_helper_sorted_set_iter_cleanup(&iter);
+
+    return result;
+}
@@ -0,0 +1,190 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SORTED_SET_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SORTED_SET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The sorted sets are stored as a two levels B+tree mapped on the chunks of the value of the entry index (so they work
+// transparently with every storage backend)
+//   chunk 0 (header) | chunk 1 ... chunk S (score nodes) | chunk S + 1 ... chunk S + H (hash nodes)
+// the header is the root of the tree, after the counters it contains the first key and the amount of entries of every
+// node packed in arrays, so a lookup is a binary search over contiguous memory followed by the scan of a single node
+//   header | score_nodes_keys[S] | hash_nodes_keys[H] | score_nodes_counts[S] | hash_nodes_counts[H]
+//
+// The score nodes contain the entries ordered by score and member, each entry is the score followed by the member
+// prefixed by its length encoded as varint. The hash nodes are the member index, they contain fixed size entries made
+// of the hash of the member and of its score ordered by hash, the score is then used to locate the member in the score
+// nodes so ZSCORE, ZRANK, ZREM or ZADD updating a member don't have to scan the whole sorted set.
+//
+// The small sorted sets use the listpack encoding, the member index isn't maintained as they fit in a single score
+// node which is scanned to find the members, the index is built when the sorted set grows over the thresholds below.
+//
+// As for the lists, the nodes are immutable, an update builds a new chunk sequence with the new version of the nodes
+// changed and shares the data of all the other nodes with the previous version of the sorted set.
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODE_MAX_SIZE (32 * 1024)
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_NODES_MAX \
+    ((FFMA_OBJECT_SIZE_MAX / sizeof(storage_db_chunk_info_t)) - 1)
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_MEMBER_MAX_LENGTH (8 * 1024)
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_LISTPACK_MAX_ENTRIES 128
+#define MODULE_REDIS_COMMAND_HELPER_SORTED_SET_LISTPACK_MAX_MEMBER_LENGTH 64
+
+enum module_redis_command_helper_sorted_set_encoding {
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ENCODING_LISTPACK = 1,
+    MODULE_REDIS_COMMAND_HELPER_SORTED_SET_ENCODING_TREE = 2,
+};
+typedef enum module_redis_command_helper_sorted_set_encoding module_redis_command_helper_sorted_set_encoding_t;
+
+typedef struct module_redis_command_helper_sorted_set_header module_redis_command_helper_sorted_set_header_t;
+struct module_redis_command_helper_sorted_set_header {
+    uint32_t encoding;
+    uint32_t score_nodes_count;
+    uint32_t hash_nodes_count;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+// The keys of the score nodes are the scores mapped to integers preserving their ordering, the keys of the hash nodes
+// are the hashes of the members. When the sorted set is being edited the arrays are copied out of the header and the
+// nodes being changed get their own buffer, the chunk indexes point to the chunks of the current version of the nodes
+// not changed (0, the header, for the new nodes).
+typedef struct module_redis_command_helper_sorted_set_nodes module_redis_command_helper_sorted_set_nodes_t;
+struct module_redis_command_helper_sorted_set_nodes {
+    uint64_t *keys;
+    uint32_t *counts;
+    uint32_t *chunk_indexes;
+    uint32_t *lengths;
+    char **buffers;
+    uint32_t count;
+    uint32_t size;
+    uint32_t chunk_index_first;
+};
+
+typedef struct module_redis_command_helper_sorted_set module_redis_command_helper_sorted_set_t;
+struct module_redis_command_helper_sorted_set {
+    storage_db_chunk_sequence_t *chunk_sequence;
+    char *header_data;
+    bool header_data_allocated;
+    bool editable;
+    module_redis_command_helper_sorted_set_encoding_t encoding;
+    uint64_t count;
+    module_redis_command_helper_sorted_set_nodes_t score_nodes;
+    module_redis_command_helper_sorted_set_nodes_t hash_nodes;
+};
+
+typedef struct module_redis_command_helper_sorted_set_node module_redis_command_helper_sorted_set_node_t;
+struct module_redis_command_helper_sorted_set_node {
+    char *data;
+    size_t length;
+    bool data_allocated;
+    uint32_t count;
+};
+
+typedef struct module_redis_command_helper_sorted_set_iter module_redis_command_helper_sorted_set_iter_t;
+struct module_redis_command_helper_sorted_set_iter {
+    module_redis_command_helper_sorted_set_t *sorted_set;
+    module_redis_command_helper_sorted_set_node_t node;
+    uint32_t node_index;
+    char *ptr;
+};
+
+bool module_redis_command_helper_sorted_set_load(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index,
+        module_redis_command_helper_sorted_set_t *sorted_set);
+
+void module_redis_command_helper_sorted_set_init(
+        module_redis_command_helper_sorted_set_t *sorted_set);
+
+bool module_redis_command_helper_sorted_set_edit_begin(
+        module_redis_command_helper_sorted_set_t *sorted_set);
+
+void module_redis_command_helper_sorted_set_cleanup(
+        module_redis_command_helper_sorted_set_t *sorted_set);
+
+bool module_redis_command_helper_sorted_set_node_load(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        module_redis_command_helper_sorted_set_nodes_t *nodes,
+        uint32_t node_index,
+        module_redis_command_helper_sorted_set_node_t *node);
+
+void module_redis_command_helper_sorted_set_node_cleanup(
+        module_redis_command_helper_sorted_set_node_t *node);
+
+bool module_redis_command_helper_sorted_set_member_find(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double *score,
+        bool *found);
+
+bool module_redis_command_helper_sorted_set_rank(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        uint64_t *rank,
+        bool *found);
+
+bool module_redis_command_helper_sorted_set_count_below(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        double score,
+        bool inclusive,
+        uint64_t *count);
+
+bool module_redis_command_helper_sorted_set_iter_init(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        uint64_t rank,
+        module_redis_command_helper_sorted_set_iter_t *iter);
+
+bool module_redis_command_helper_sorted_set_iter_next(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_iter_t *iter,
+        double *score,
+        char **member,
+        size_t *member_length);
+
+void module_redis_command_helper_sorted_set_iter_cleanup(
+        module_redis_command_helper_sorted_set_iter_t *iter);
+
+bool module_redis_command_helper_sorted_set_update(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        double score,
+        bool *inserted);
+
+bool module_redis_command_helper_sorted_set_remove(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        char *member,
+        size_t member_length,
+        bool *removed);
+
+storage_db_chunk_sequence_t *module_redis_command_helper_sorted_set_serialize(
+        storage_db_t *db,
+        module_redis_command_helper_sorted_set_t *sorted_set);
+
+bool module_redis_command_helper_sorted_set_parse_score_bound(
+        char *string,
+        size_t string_length,
+        double *score,
+        bool *exclusive);
+
+bool module_redis_command_helper_sorted_set_send_range(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_helper_sorted_set_t *sorted_set,
+        uint64_t range_start,
+        uint64_t range_end,
+        bool with_scores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_SORTED_SET_H
@@ -0,0 +1,57 @@
+#ifndef CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_VARINT_H
+#define CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_VARINT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The lengths of the elements packed in the serialized data types (hashes, lists, etc.) are encoded as varint, 7 bits
+// per byte with the MSB set if another byte follows
+
+static inline __attribute__((always_inline)) size_t module_redis_command_helper_varint_length(
+        uint32_t value) {
+    size_t length = 1;
+    while(value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+
+    return length;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_varint_write(
+        char *buffer,
+        uint32_t value) {
+    while(value >= 0x80) {
+        *buffer++ = (char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    *buffer++ = (char)value;
+
+    return buffer;
+}
+
+static inline __attribute__((always_inline)) char *module_redis_command_helper_varint_read(
+        char *buffer,
+        char *buffer_end,
+        uint32_t *value) {
+    uint32_t result = 0;
+
+    for(int shift = 0; shift < 35 && buffer < buffer_end; shift += 7) {
+        uint8_t byte = *(uint8_t*)buffer++;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return buffer;
+        }
+    }
+
+    return NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_COMMAND_HELPER_VARINT_H
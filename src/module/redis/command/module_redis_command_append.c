@@ -187,7 +187,7 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(append) {
 
     return_res = module_redis_connection_send_number(
             connection_context,
-            (int64_t)destination_chunk_sequence->size);
+            (int64_t)destination_chunk_sequence_length);
 
     destination_chunk_sequence = NULL;
 
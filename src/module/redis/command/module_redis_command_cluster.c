@@ -0,0 +1,699 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_cluster.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+#include "utils_string.h"
+
+#define TAG "module_redis_command_cluster"
+
+typedef struct module_redis_command_cluster_buffer module_redis_command_cluster_buffer_t;
+struct module_redis_command_cluster_buffer {
+    char *data;
+    size_t length;
+    size_t size;
+};
+
+__attribute__((format(printf, 2, 3)))
+static bool module_redis_command_cluster_buffer_printf(
+        module_redis_command_cluster_buffer_t *buffer,
+        char *format,
+        ...) {
+    va_list args;
+    int printed_length;
+
+    do {
+        size_t available_length = buffer->size - buffer->length;
+
+        va_start(args, format);
+        printed_length = vsnprintf(buffer->data + buffer->length, available_length, format, args);
+        va_end(args);
+
+        if (likely(printed_length >= 0 && (size_t)printed_length < available_length)) {
+            break;
+        }
+
+        size_t new_size = buffer->size == 0 ? 1024 : buffer->size * 2;
+        buffer->data = module_redis_command_helper_buffer_realloc(buffer->data, buffer->size, new_size, false);
+        buffer->size = buffer->data ? new_size : 0;
+        buffer->length = buffer->data ? buffer->length : 0;
+
+        if (unlikely(buffer->data == NULL)) {
+            return false;
+        }
+    } while(true);
+
+    buffer->length += printed_length;
+
+    return true;
+}
+
+static bool module_redis_command_cluster_parse_number(
+        module_redis_short_string_t *string,
+        int64_t min,
+        int64_t max,
+        int64_t *number) {
+    char number_str[32];
+    char *number_end = NULL;
+
+    if (string->length == 0 || string->length >= sizeof(number_str)) {
+        return false;
+    }
+
+    memcpy(number_str, string->short_string, string->length);
+    number_str[string->length] = 0;
+
+    *number = strtoll(number_str, &number_end, 10);
+
+    return *number_end == 0 && *number >= min && *number <= max;
+}
+
+static bool module_redis_command_cluster_parse_slot(
+        module_redis_connection_context_t *connection_context,
+        module_redis_short_string_t *string,
+        uint16_t *slot) {
+    int64_t number;
+
+    if (!module_redis_command_cluster_parse_number(string, 0, MODULE_REDIS_CLUSTER_SLOTS_COUNT - 1, &number)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Invalid or out of range slot");
+        return false;
+    }
+
+    *slot = number;
+
+    return true;
+}
+
+static bool module_redis_command_cluster_wrong_arguments_count(
+        module_redis_connection_context_t *connection_context,
+        char *subcommand) {
+    return module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR wrong number of arguments for 'cluster|%s' command",
+            subcommand);
+}
+
+static bool module_redis_command_cluster_myid(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    module_redis_cluster_node_t *myself = &module_redis_cluster_registry.nodes[MODULE_REDIS_CLUSTER_NODE_MYSELF];
+
+    return module_redis_connection_send_blob_string(
+            connection_context,
+            myself->id,
+            MODULE_REDIS_CLUSTER_NODE_ID_LENGTH);
+}
+
+static bool module_redis_command_cluster_keyslot(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    if (context->subcommand_argument.count != 1) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, "keyslot");
+    }
+
+    return module_redis_connection_send_number(
+            connection_context,
+            storage_db_key_slot(
+                    context->subcommand_argument.list[0].short_string,
+                    context->subcommand_argument.list[0].length));
+}
+
+static bool module_redis_command_cluster_countkeysinslot(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    uint16_t slot;
+
+    if (context->subcommand_argument.count != 1) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, "countkeysinslot");
+    }
+
+    if (!module_redis_command_cluster_parse_slot(connection_context, &context->subcommand_argument.list[0], &slot)) {
+        return true;
+    }
+
+    return module_redis_connection_send_number(
+            connection_context,
+            storage_db_op_count_keys_in_slot(connection_context->db, slot));
+}
+
+static bool module_redis_command_cluster_getkeysinslot(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    bool result_res = false;
+    uint16_t slot;
+    int64_t count;
+    uint64_t keys_count = 0;
+    storage_db_key_and_key_length_t *keys;
+
+    if (context->subcommand_argument.count != 2) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, "getkeysinslot");
+    }
+
+    if (!module_redis_command_cluster_parse_slot(connection_context, &context->subcommand_argument.list[0], &slot)) {
+        return true;
+    }
+
+    if (!module_redis_command_cluster_parse_number(&context->subcommand_argument.list[1], 0, INT64_MAX, &count)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Invalid number of keys");
+    }
+
+    keys = storage_db_op_get_keys_in_slot(connection_context->db, slot, count, &keys_count);
+
+    if (!module_redis_connection_send_array_header(connection_context, keys_count)) {
+        goto end;
+    }
+
+    for(uint64_t index = 0; index < keys_count; index++) {
+        if (!module_redis_connection_send_blob_string(connection_context, keys[index].key, keys[index].key_size)) {
+            goto end;
+        }
+    }
+
+    result_res = true;
+
+end:
+    if (keys) {
+        storage_db_free_key_and_key_length_list(keys, keys_count);
+    }
+
+    return result_res;
+}
+
+static bool module_redis_command_cluster_addslots_or_delslots(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context,
+        bool add) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    uint16_t slot;
+
+    if (context->subcommand_argument.count == 0) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, add ? "addslots" : "delslots");
+    }
+
+    // All the slots are validated before changing any of them
+    for(int index = 0; index < context->subcommand_argument.count; index++) {
+        if (!module_redis_command_cluster_parse_slot(
+                connection_context,
+                &context->subcommand_argument.list[index],
+                &slot)) {
+            return true;
+        }
+
+        bool unassigned = registry->slots[slot].owner == MODULE_REDIS_CLUSTER_NODE_NONE;
+        if (add && !unassigned) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR Slot %u is already busy",
+                    slot);
+        } else if (!add && unassigned) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR Slot %u is already unassigned",
+                    slot);
+        }
+    }
+
+    for(int index = 0; index < context->subcommand_argument.count; index++) {
+        module_redis_command_cluster_parse_slot(
+                connection_context,
+                &context->subcommand_argument.list[index],
+                &slot);
+
+        if (add) {
+            module_redis_cluster_slot_add(slot);
+        } else {
+            module_redis_cluster_slot_delete(slot);
+        }
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+}
+
+static bool module_redis_command_cluster_meet(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    int64_t port;
+    char address_str[INET6_ADDRSTRLEN];
+    union {
+        struct sockaddr base;
+        struct sockaddr_in ipv4;
+        struct sockaddr_in6 ipv6;
+    } address = { 0 };
+    socklen_t address_size;
+    module_redis_short_string_t *host;
+
+    if (context->subcommand_argument.count < 2 || context->subcommand_argument.count > 3) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, "meet");
+    }
+
+    host = &context->subcommand_argument.list[0];
+
+    if (!module_redis_command_cluster_parse_number(&context->subcommand_argument.list[1], 1, UINT16_MAX, &port)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Invalid TCP base port specified: %.*s",
+                (int)context->subcommand_argument.list[1].length,
+                context->subcommand_argument.list[1].short_string);
+    }
+
+    // The address is validated and normalized, only the IP addresses are supported
+    if (!module_redis_cluster_parse_address(host->short_string, host->length, port, &address.base, &address_size)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Invalid node address specified: %.*s:%ld",
+                (int)host->length,
+                host->short_string,
+                port);
+    }
+
+    if (address.base.sa_family == AF_INET) {
+        inet_ntop(AF_INET, &address.ipv4.sin_addr, address_str, sizeof(address_str));
+    } else {
+        inet_ntop(AF_INET6, &address.ipv6.sin6_addr, address_str, sizeof(address_str));
+    }
+
+    if (module_redis_cluster_node_meet(address_str, port) == MODULE_REDIS_CLUSTER_NODE_NONE) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Too many nodes in the cluster");
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+}
+
+static bool module_redis_command_cluster_find_node(
+        module_redis_connection_context_t *connection_context,
+        module_redis_short_string_t *node_id,
+        uint16_t *node_index) {
+    int32_t found_node_index = module_redis_cluster_node_find(node_id->short_string, node_id->length);
+
+    if (found_node_index < 0) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Unknown node %.*s",
+                (int)node_id->length,
+                node_id->short_string);
+        return false;
+    }
+
+    *node_index = found_node_index;
+
+    return true;
+}
+
+static bool module_redis_command_cluster_forget(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    uint16_t node_index;
+
+    if (context->subcommand_argument.count != 1) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, "forget");
+    }
+
+    if (!module_redis_command_cluster_find_node(
+            connection_context,
+            &context->subcommand_argument.list[0],
+            &node_index)) {
+        return true;
+    }
+
+    if (!module_redis_cluster_node_forget(node_index)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR I tried hard but I can't forget myself...");
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+}
+
+static bool module_redis_command_cluster_setslot(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    uint16_t slot;
+    uint16_t node_index = MODULE_REDIS_CLUSTER_NODE_NONE;
+    module_redis_short_string_t *action;
+    module_redis_cluster_slot_t *cluster_slot;
+
+    if (context->subcommand_argument.count < 2 || context->subcommand_argument.count > 3) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, "setslot");
+    }
+
+    if (!module_redis_command_cluster_parse_slot(connection_context, &context->subcommand_argument.list[0], &slot)) {
+        return true;
+    }
+
+    action = &context->subcommand_argument.list[1];
+    cluster_slot = &module_redis_cluster_registry.slots[slot];
+
+    if (utils_string_casecmp_eq_32(action->short_string, action->length, "STABLE", 6)) {
+        module_redis_cluster_slot_set_stable(slot);
+        return module_redis_connection_send_ok(connection_context);
+    }
+
+    if (context->subcommand_argument.count != 3) {
+        return module_redis_command_cluster_wrong_arguments_count(connection_context, "setslot");
+    }
+
+    if (!module_redis_command_cluster_find_node(
+            connection_context,
+            &context->subcommand_argument.list[2],
+            &node_index)) {
+        return true;
+    }
+
+    if (utils_string_casecmp_eq_32(action->short_string, action->length, "MIGRATING", 9)) {
+        if (cluster_slot->owner != MODULE_REDIS_CLUSTER_NODE_MYSELF) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR I'm not the owner of hash slot %u",
+                    slot);
+        }
+
+        module_redis_cluster_slot_set_migrating(slot, node_index);
+    } else if (utils_string_casecmp_eq_32(action->short_string, action->length, "IMPORTING", 9)) {
+        if (cluster_slot->owner == MODULE_REDIS_CLUSTER_NODE_MYSELF) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR I'm already the owner of hash slot %u",
+                    slot);
+        }
+
+        module_redis_cluster_slot_set_importing(slot, node_index);
+    } else if (utils_string_casecmp_eq_32(action->short_string, action->length, "NODE", 4)) {
+        // The slot can't be given away while this node still has keys in it
+        if (cluster_slot->owner == MODULE_REDIS_CLUSTER_NODE_MYSELF &&
+            node_index != MODULE_REDIS_CLUSTER_NODE_MYSELF &&
+            storage_db_op_count_keys_in_slot(connection_context->db, slot) > 0) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR Can't assign hashslot %u to a different node while I still hold keys for this hash slot.",
+                    slot);
+        }
+
+        module_redis_cluster_slot_set_node(slot, node_index);
+    } else {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Invalid CLUSTER SETSLOT action or number of arguments. Try CLUSTER HELP");
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+}
+
+static bool module_redis_command_cluster_send_node(
+        module_redis_connection_context_t *connection_context,
+        uint16_t node_index) {
+    module_redis_cluster_node_t *node = &module_redis_cluster_registry.nodes[node_index];
+
+    return
+            module_redis_connection_send_array_header(connection_context, 3) &&
+            module_redis_connection_send_blob_string(connection_context, node->address, strlen(node->address)) &&
+            module_redis_connection_send_number(connection_context, node->port) &&
+            module_redis_connection_send_blob_string(connection_context, node->id, MODULE_REDIS_CLUSTER_NODE_ID_LENGTH);
+}
+
+static bool module_redis_command_cluster_slots(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    uint32_t range_start = 0;
+
+    // The topology can be changed concurrently by the other workers, the ranges are calculated from a copy of the
+    // owners to keep the reply consistent with the header
+    uint16_t *owners = xalloc_alloc(sizeof(uint16_t) * MODULE_REDIS_CLUSTER_SLOTS_COUNT);
+    for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+        owners[slot] = registry->slots[slot].owner;
+    }
+
+    uint32_t ranges_count = 0;
+    for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+        if (owners[slot] != MODULE_REDIS_CLUSTER_NODE_NONE && (slot == 0 || owners[slot - 1] != owners[slot])) {
+            ranges_count++;
+        }
+    }
+
+    if (!module_redis_connection_send_array_header(connection_context, ranges_count)) {
+        goto fail;
+    }
+
+    for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+        if (slot == 0 || owners[slot - 1] != owners[slot]) {
+            range_start = slot;
+        }
+
+        if (owners[slot] == MODULE_REDIS_CLUSTER_NODE_NONE ||
+            (slot + 1 < MODULE_REDIS_CLUSTER_SLOTS_COUNT && owners[slot + 1] == owners[slot])) {
+            continue;
+        }
+
+        if (!module_redis_connection_send_array_header(connection_context, 3) ||
+            !module_redis_connection_send_number(connection_context, range_start) ||
+            !module_redis_connection_send_number(connection_context, slot) ||
+            !module_redis_command_cluster_send_node(connection_context, owners[slot])) {
+            goto fail;
+        }
+    }
+
+    xalloc_free(owners);
+    return true;
+
+fail:
+    xalloc_free(owners);
+    return false;
+}
+
+static bool module_redis_command_cluster_nodes(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    bool result_res = false;
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    module_redis_command_cluster_buffer_t buffer = { 0 };
+    uint16_t nodes_count = __atomic_load_n(&registry->nodes_count, __ATOMIC_ACQUIRE);
+    uint64_t epoch = registry->epoch;
+
+    for(uint16_t node_index = 0; node_index < nodes_count; node_index++) {
+        module_redis_cluster_node_t *node = &registry->nodes[node_index];
+        int32_t range_start = -1;
+
+        if (node->forgotten) {
+            continue;
+        }
+
+        // There is no cluster bus, the port reported for it is the usual one
+        if (!module_redis_command_cluster_buffer_printf(
+                &buffer,
+                "%s %s:%u@%u %s - 0 0 %lu connected",
+                node->id,
+                node->address,
+                node->port,
+                node->port + 10000,
+                node_index == MODULE_REDIS_CLUSTER_NODE_MYSELF ? "myself,master" : "master",
+                epoch)) {
+            goto end;
+        }
+
+        for(uint32_t slot = 0; slot <= MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+            bool owned = slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT && registry->slots[slot].owner == node_index;
+
+            if (owned && range_start == -1) {
+                range_start = (int32_t)slot;
+            } else if (!owned && range_start != -1) {
+                bool printed = range_start == (int32_t)slot - 1
+                        ? module_redis_command_cluster_buffer_printf(&buffer, " %d", range_start)
+                        : module_redis_command_cluster_buffer_printf(&buffer, " %d-%u", range_start, slot - 1);
+
+                if (!printed) {
+                    goto end;
+                }
+
+                range_start = -1;
+            }
+        }
+
+        // The migrations in progress are reported only for this node, as Redis Cluster does
+        if (node_index == MODULE_REDIS_CLUSTER_NODE_MYSELF) {
+            for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+                uint16_t migrating_to = registry->slots[slot].migrating_to;
+                uint16_t importing_from = registry->slots[slot].importing_from;
+
+                if (migrating_to != MODULE_REDIS_CLUSTER_NODE_NONE && !module_redis_command_cluster_buffer_printf(
+                        &buffer,
+                        " [%u->-%s]",
+                        slot,
+                        registry->nodes[migrating_to].id)) {
+                    goto end;
+                }
+
+                if (importing_from != MODULE_REDIS_CLUSTER_NODE_NONE && !module_redis_command_cluster_buffer_printf(
+                        &buffer,
+                        " [%u-<-%s]",
+                        slot,
+                        registry->nodes[importing_from].id)) {
+                    goto end;
+                }
+            }
+        }
+
+        if (!module_redis_command_cluster_buffer_printf(&buffer, "\n")) {
+            goto end;
+        }
+    }
+
+    result_res = module_redis_connection_send_blob_string(connection_context, buffer.data, buffer.length);
+
+end:
+    if (buffer.data) {
+        module_redis_command_helper_buffer_free(buffer.data, buffer.size);
+    }
+
+    return result_res;
+}
+
+static bool module_redis_command_cluster_info(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_cluster_context_t *context) {
+    bool result_res = false;
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    module_redis_command_cluster_buffer_t buffer = { 0 };
+    uint16_t nodes_count = __atomic_load_n(&registry->nodes_count, __ATOMIC_ACQUIRE);
+    uint32_t slots_assigned = 0;
+    uint16_t known_nodes = 0;
+    uint16_t cluster_size = 0;
+
+    for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+        if (registry->slots[slot].owner != MODULE_REDIS_CLUSTER_NODE_NONE) {
+            slots_assigned++;
+        }
+    }
+
+    for(uint16_t node_index = 0; node_index < nodes_count; node_index++) {
+        if (registry->nodes[node_index].forgotten) {
+            continue;
+        }
+
+        known_nodes++;
+
+        for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+            if (registry->slots[slot].owner == node_index) {
+                cluster_size++;
+                break;
+            }
+        }
+    }
+
+    if (module_redis_command_cluster_buffer_printf(
+            &buffer,
+            "cluster_state:%s\r\n"
+            "cluster_slots_assigned:%u\r\n"
+            "cluster_slots_ok:%u\r\n"
+            "cluster_slots_pfail:0\r\n"
+            "cluster_slots_fail:0\r\n"
+            "cluster_known_nodes:%u\r\n"
+            "cluster_size:%u\r\n"
+            "cluster_current_epoch:%lu\r\n"
+            "cluster_my_epoch:%lu\r\n",
+            slots_assigned == MODULE_REDIS_CLUSTER_SLOTS_COUNT ? "ok" : "fail",
+            slots_assigned,
+            slots_assigned,
+            known_nodes,
+            cluster_size,
+            registry->epoch,
+            registry->epoch)) {
+        result_res = module_redis_connection_send_blob_string(connection_context, buffer.data, buffer.length);
+    }
+
+    if (buffer.data) {
+        module_redis_command_helper_buffer_free(buffer.data, buffer.size);
+    }
+
+    return result_res;
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(cluster) {
+    module_redis_command_cluster_context_t *context = connection_context->command.context;
+    char *subcommand = context->subcommand.value.short_string;
+    size_t subcommand_length = context->subcommand.value.length;
+
+    if (!module_redis_cluster_is_enabled(connection_context)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR This instance has cluster support disabled");
+    }
+
+    module_redis_cluster_registry_initialize(connection_context->network_channel->module_config);
+
+    if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "MYID", 4)) {
+        return module_redis_command_cluster_myid(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "INFO", 4)) {
+        return module_redis_command_cluster_info(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "SLOTS", 5)) {
+        return module_redis_command_cluster_slots(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "NODES", 5)) {
+        return module_redis_command_cluster_nodes(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "KEYSLOT", 7)) {
+        return module_redis_command_cluster_keyslot(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "COUNTKEYSINSLOT", 15)) {
+        return module_redis_command_cluster_countkeysinslot(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "GETKEYSINSLOT", 13)) {
+        return module_redis_command_cluster_getkeysinslot(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "ADDSLOTS", 8)) {
+        return module_redis_command_cluster_addslots_or_delslots(connection_context, context, true);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "DELSLOTS", 8)) {
+        return module_redis_command_cluster_addslots_or_delslots(connection_context, context, false);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "MEET", 4)) {
+        return module_redis_command_cluster_meet(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "FORGET", 6)) {
+        return module_redis_command_cluster_forget(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "SETSLOT", 7)) {
+        return module_redis_command_cluster_setslot(connection_context, context);
+    }
+
+    return module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR unknown subcommand '%.*s'. Try CLUSTER HELP.",
+            (int)subcommand_length,
+            subcommand);
+}
@@ -104,9 +104,18 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(copy) {
     }
 
     chunk_sequence_source = entry_index_source->value;
-    chunk_sequence_destination = storage_db_chunk_sequence_allocate(
+    // The destination mirrors the chunks of the source, the data types packing their structures in the chunks (e.g.
+    // the lists) rely on the chunks boundaries
+    chunk_sequence_destination = storage_db_chunk_sequence_allocate_like(
             connection_context->db,
-            entry_index_source->value->size);
+            chunk_sequence_source);
+    if (unlikely(!chunk_sequence_destination)) {
+        error_found = true;
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR copy failed");
+        goto end;
+    }
 
     off_t destination_chunk_offset = 0;
     storage_db_chunk_index_t destination_chunk_index = 0;
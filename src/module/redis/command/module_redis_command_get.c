@@ -41,13 +41,35 @@
 
 MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(get) {
     bool return_res = false;
+    bool entry_index_pinned = false;
     storage_db_entry_index_t *entry_index = NULL;
     module_redis_command_get_context_t *context = connection_context->command.context;
 
-    entry_index = storage_db_get_entry_index_for_read(
-            connection_context->db,
-            context->key.value.key,
-            context->key.value.length);
+    if (likely(storage_db_can_read_unpinned(connection_context->db))) {
+        // The readers counter is not touched for the hot path, the entry index is protected by the epoch of the
+        // worker as long as the fiber doesn't yield, if streaming the value might yield the entry index gets pinned
+        entry_index = storage_db_get_entry_index_for_read_unpinned(
+                connection_context->db,
+                context->key.value.key,
+                context->key.value.length);
+
+        if (likely(entry_index) && unlikely(!module_redis_command_stream_entry_can_complete_without_yielding(
+                connection_context->network_channel,
+                connection_context->db,
+                entry_index))) {
+            if (unlikely(!storage_db_entry_index_status_try_increase_readers_counter(entry_index))) {
+                entry_index = NULL;
+            } else {
+                entry_index_pinned = true;
+            }
+        }
+    } else {
+        entry_index = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                context->key.value.key,
+                context->key.value.length);
+        entry_index_pinned = true;
+    }
 
     if (unlikely(!entry_index)) {
         return_res = module_redis_connection_send_string_null(connection_context);
@@ -59,7 +81,9 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(get) {
             connection_context->db,
             entry_index);
 
-    storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    if (entry_index_pinned) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
     entry_index = NULL;
 
 end:
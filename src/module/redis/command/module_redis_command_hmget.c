@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hash.h"
+
+#define TAG "module_redis_command_hmget"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(hmget) {
+    bool return_res = false;
+    char *value = NULL;
+    size_t value_length = 0;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_helper_hash_t hash = { 0 };
+    module_redis_command_hmget_context_t *context = connection_context->command.context;
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            context->key.value.key,
+            context->key.value.length);
+
+    if (likely(entry_index)) {
+        if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    MODULE_REDIS_ERROR_WRONGTYPE);
+            goto end;
+        }
+
+        if (unlikely(!module_redis_command_helper_hash_load(connection_context->db, entry_index, &hash))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR hmget failed");
+            goto end;
+        }
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, context->field.count))) {
+        goto end;
+    }
+
+    for(int index = 0; index < context->field.count; index++) {
+        bool res, found = false;
+
+        // The array header has already been sent, if the lookup fails the connection is closed
+        if (entry_index && unlikely(!module_redis_command_helper_hash_get(
+                connection_context->db,
+                &hash,
+                context->field.list[index].short_string,
+                context->field.list[index].length,
+                &value,
+                &value_length,
+                &found))) {
+            goto end;
+        }
+
+        if (found) {
+            res = module_redis_connection_send_blob_string(connection_context, value, value_length);
+        } else {
+            res = module_redis_connection_send_string_null(connection_context);
+        }
+
+        if (unlikely(!res)) {
+            goto end;
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    module_redis_command_helper_hash_cleanup(&hash);
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
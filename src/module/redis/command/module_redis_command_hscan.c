@@ -0,0 +1,209 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "utils_string.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hash.h"
+
+#define TAG "module_redis_command_hscan"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(hscan) {
+    bool return_res = false;
+    char *field, *value;
+    size_t field_length, value_length;
+    uint32_t field_hash, field_hash_last = 0;
+    uint64_t count = 10;
+    uint64_t cursor_next = 0;
+    uint64_t entries_count = 0;
+    uint32_t matches_count = 0;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_helper_hash_t hash = { 0 };
+    module_redis_command_helper_hash_iter_t iter = { 0 };
+    module_redis_command_hscan_context_t *context = connection_context->command.context;
+
+    if (unlikely(context->cursor.value < 0 || (context->count_count.has_token && context->count_count.value <= 0))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR invalid cursor or count");
+        goto end;
+    }
+
+    if (context->count_count.has_token) {
+        count = context->count_count.value;
+    }
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            context->key.value.key,
+            context->key.value.length);
+
+    if (likely(entry_index)) {
+        if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    MODULE_REDIS_ERROR_WRONGTYPE);
+            goto end;
+        }
+
+        if (unlikely(!module_redis_command_helper_hash_load(connection_context->db, entry_index, &hash))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR hscan failed");
+            goto end;
+        }
+    }
+
+    // The entries are ordered by the hash of their field so the cursor is the hash of the next field to return plus
+    // one, 0 meaning that the iteration is starting or is over. The position is not affected by the fields added or
+    // deleted so it provides the same guarantees of Redis: the fields with the same hash are always returned together
+    // by the same call, even if they exceed the count, to avoid skipping or repeating them.
+    bool scan = entry_index && context->cursor.value <= (int64_t)UINT32_MAX + 1;
+    uint32_t field_hash_start = context->cursor.value > 0
+            ? (uint32_t)(context->cursor.value - 1)
+            : 0;
+
+    if (scan) {
+        if (unlikely(!module_redis_command_helper_hash_iter_init(
+                connection_context->db,
+                &hash,
+                field_hash_start,
+                &iter))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR hscan failed");
+            goto end;
+        }
+
+        // The fields point to the data of the node being iterated so a first pass counts the matches and finds
+        // where the next call has to start from, the second one sends them
+        while(module_redis_command_helper_hash_iter_next(
+                connection_context->db,
+                &iter,
+                &field_hash,
+                &field,
+                &field_length,
+                &value,
+                &value_length)) {
+            if (entries_count >= count && field_hash != field_hash_last) {
+                cursor_next = (uint64_t)field_hash + 1;
+                break;
+            }
+
+            if (!context->match_pattern.has_token || utils_string_glob_match(
+                    field,
+                    field_length,
+                    context->match_pattern.value.pattern,
+                    context->match_pattern.value.length)) {
+                matches_count++;
+            }
+
+            field_hash_last = field_hash;
+            entries_count++;
+        }
+
+        module_redis_command_helper_hash_iter_cleanup(&iter);
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, 2))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_number(connection_context, (int64_t)cursor_next))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, matches_count * 2))) {
+        goto end;
+    }
+
+    if (scan && matches_count > 0) {
+        if (unlikely(!module_redis_command_helper_hash_iter_init(
+                connection_context->db,
+                &hash,
+                field_hash_start,
+                &iter))) {
+            goto end;
+        }
+
+        for(uint64_t index = 0; index < entries_count; index++) {
+            if (unlikely(!module_redis_command_helper_hash_iter_next(
+                    connection_context->db,
+                    &iter,
+                    &field_hash,
+                    &field,
+                    &field_length,
+                    &value,
+                    &value_length))) {
+                goto end;
+            }
+
+            if (context->match_pattern.has_token && !utils_string_glob_match(
+                    field,
+                    field_length,
+                    context->match_pattern.value.pattern,
+                    context->match_pattern.value.length)) {
+                continue;
+            }
+
+            if (unlikely(!module_redis_connection_send_blob_string(connection_context, field, field_length))) {
+                goto end;
+            }
+
+            if (unlikely(!module_redis_connection_send_blob_string(connection_context, value, value_length))) {
+                goto end;
+            }
+        }
+    }
+
+    return_res = true;
+
+end:
+
+    module_redis_command_helper_hash_iter_cleanup(&iter);
+    module_redis_command_helper_hash_cleanup(&hash);
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
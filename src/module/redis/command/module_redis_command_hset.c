@@ -0,0 +1,208 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hash.h"
+
+#define TAG "module_redis_command_hset"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(hset) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    int64_t inserted_count = 0;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_chunk_sequence_t *chunk_sequence_new = NULL;
+    module_redis_command_helper_hash_t hash = { 0 };
+    storage_db_expiry_time_ms_t expiry_time_ms = STORAGE_DB_ENTRY_NO_EXPIRY;
+    module_redis_command_hset_context_t *context = connection_context->command.context;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            connection_context->db,
+            &transaction,
+            context->key.value.key,
+            context->key.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR hset failed");
+
+        goto end;
+    }
+
+    if (likely(current_entry_index)) {
+        current_entry_index = storage_db_op_rmw_current_entry_index_prep_for_read(
+                connection_context->db,
+                &rmw_status,
+                current_entry_index);
+
+        if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    MODULE_REDIS_ERROR_WRONGTYPE);
+
+            goto end;
+        }
+
+        expiry_time_ms = current_entry_index->expiry_time_ms;
+
+        if (unlikely(!module_redis_command_helper_hash_load(
+                connection_context->db,
+                current_entry_index,
+                &hash) || !module_redis_command_helper_hash_edit_begin(&hash))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR hset failed");
+
+            goto end;
+        }
+    } else {
+        module_redis_command_helper_hash_init(&hash);
+    }
+
+    for(int index = 0; index < context->field_value.count; index++) {
+        bool inserted = false;
+        module_redis_command_hset_context_subargument_field_value_t *field_value =
+                &context->field_value.list[index];
+
+        if (unlikely(!module_redis_command_helper_hash_entry_fits(
+                field_value->field.value.length,
+                field_value->value.value.chunk_sequence->size))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR field and value too large");
+
+            goto end;
+        }
+
+        char *value = module_redis_command_helper_hash_long_string_read(
+                connection_context->db,
+                &field_value->value.value);
+
+        if (unlikely(!value)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR hset failed");
+
+            goto end;
+        }
+
+        // The entry is copied in the node so the value can be freed straight away
+        bool result = module_redis_command_helper_hash_set(
+                connection_context->db,
+                &hash,
+                field_value->field.value.short_string,
+                field_value->field.value.length,
+                value,
+                field_value->value.value.chunk_sequence->size,
+                &inserted);
+        module_redis_command_helper_buffer_free(value, MAX(field_value->value.value.chunk_sequence->size, 1));
+
+        if (unlikely(!result)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR hset failed");
+
+            goto end;
+        }
+
+        inserted_count += inserted ? 1 : 0;
+    }
+
+    chunk_sequence_new = module_redis_command_helper_hash_serialize(connection_context->db, &hash);
+    if (unlikely(!chunk_sequence_new)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR hset failed");
+
+        goto end;
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update(
+            connection_context->db,
+            &rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET,
+            chunk_sequence_new,
+            expiry_time_ms))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR hset failed");
+
+        goto end;
+    }
+
+    transaction_release(&transaction);
+    release_transaction = false;
+
+    context->key.value.key = NULL;
+    chunk_sequence_new = NULL;
+    abort_rmw = false;
+
+    return_res = module_redis_connection_send_number(connection_context, inserted_count);
+
+end:
+
+    module_redis_command_helper_hash_cleanup(&hash);
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(connection_context->db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    if (current_entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+    }
+
+    if (unlikely(chunk_sequence_new)) {
+        storage_db_chunk_sequence_free(connection_context->db, chunk_sequence_new);
+    }
+
+    return return_res;
+}
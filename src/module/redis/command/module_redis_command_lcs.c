@@ -35,6 +35,7 @@
 #include "network/io/network_io_common.h"
 #include "config.h"
 #include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
 #include "network/channel/network_channel.h"
 #include "storage/io/storage_io_common.h"
 #include "storage/channel/storage_channel.h"
@@ -82,10 +83,17 @@ uint32_t *lcsmap_build(
     // Initialize the generalized trees suffixes array
     uint32_t *lcsmap = xalloc_alloc_zero(sizeof(uint32_t) * (value_1->size + 1) * (value_2->size + 1));
 
+    // Building the map for large values takes time, the fiber yields periodically to let the other fibers of the worker
+    // run, the budget is checked every few rows as each one of them requires to iterate over the whole second value
+    fiber_scheduler_yield_budget_t yield_budget;
+    fiber_scheduler_yield_budget_init(&yield_budget, 16);
+
     // Loop over the characters to build the tree
     value_1_chunk_index = -1;
     value_1_chunk_offset = -1;
     for(uint32_t value_1_char_index = 0; value_1_char_index <= value_1->size; value_1_char_index++) {
+        fiber_scheduler_yield_budget_check(&yield_budget);
+
         value_1_chunk_offset++;
         if (unlikely(value_1_chunk_index == -1 || value_1_chunk_offset >= value_1_chunk_info->chunk_length)) {
             if (unlikely(value_1_chunk_data_allocated_new)) {
@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_list.h"
+
+#define TAG "module_redis_command_lindex"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(lindex) {
+    bool return_res = false;
+    char *iter_ptr = NULL, *element = NULL;
+    size_t element_length = 0;
+    uint32_t node_index;
+    uint64_t node_first_element_index;
+    int64_t index;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_helper_list_t list = { 0 };
+    module_redis_command_helper_list_node_t node = { 0 };
+    module_redis_command_lindex_context_t *context = connection_context->command.context;
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            context->key.value.key,
+            context->key.value.length);
+
+    if (unlikely(!entry_index)) {
+        return_res = module_redis_connection_send_string_null(connection_context);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                MODULE_REDIS_ERROR_WRONGTYPE);
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_list_load(connection_context->db, entry_index, &list))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR lindex failed");
+        goto end;
+    }
+
+    index = context->index.value;
+    if (index < 0) {
+        index += (int64_t)list.count;
+    }
+
+    if (index < 0 || index >= (int64_t)list.count) {
+        return_res = module_redis_connection_send_string_null(connection_context);
+        goto end;
+    }
+
+    // Only the node containing the element is loaded, the others are skipped reading their element counters
+    if (unlikely(!module_redis_command_helper_list_find(
+            connection_context->db,
+            &list,
+            index,
+            &node_index,
+            &node_first_element_index) || !module_redis_command_helper_list_node_load(
+                    connection_context->db,
+                    &list,
+                    node_index,
+                    &node))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR lindex failed");
+        goto end;
+    }
+
+    for(uint64_t element_index = node_first_element_index; element_index <= (uint64_t)index; element_index++) {
+        if (unlikely(!module_redis_command_helper_list_node_iter(&node, &iter_ptr, &element, &element_length))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR lindex failed");
+            goto end;
+        }
+    }
+
+    return_res = module_redis_connection_send_blob_string(connection_context, element, element_length);
+
+end:
+
+    module_redis_command_helper_list_node_cleanup(&node);
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
@@ -0,0 +1,238 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_list.h"
+
+#define TAG "module_redis_command_ltrim"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(ltrim) {
+    bool return_res = false;
+    bool abort_rmw = true;
+    bool release_transaction = true;
+    uint64_t range_start, range_end;
+    uint32_t node_index_start, node_index_end;
+    uint64_t node_start_first_element_index, node_end_first_element_index;
+    transaction_t transaction = { 0 };
+    storage_db_op_rmw_status_t rmw_status = { 0 };
+    storage_db_entry_index_t *current_entry_index = NULL;
+    storage_db_chunk_sequence_t *chunk_sequence_new = NULL;
+    module_redis_command_helper_list_t list = { 0 };
+    module_redis_command_helper_list_node_t node = { 0 };
+    module_redis_command_helper_list_builder_t builder_head = { 0 };
+    module_redis_command_helper_list_builder_t builder_tail = { 0 };
+    module_redis_command_ltrim_context_t *context = connection_context->command.context;
+    storage_db_t *db = connection_context->db;
+
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_rmw_begin(
+            db,
+            &transaction,
+            context->key.value.key,
+            context->key.value.length,
+            &rmw_status,
+            &current_entry_index))) {
+        goto end_error;
+    }
+
+    if (unlikely(!current_entry_index)) {
+        return_res = module_redis_connection_send_ok(connection_context);
+        goto end;
+    }
+
+    current_entry_index = storage_db_op_rmw_current_entry_index_prep_for_read(
+            db,
+            &rmw_status,
+            current_entry_index);
+
+    if (unlikely(current_entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                MODULE_REDIS_ERROR_WRONGTYPE);
+
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_list_load(db, current_entry_index, &list))) {
+        goto end_error;
+    }
+
+    // If the range is empty the list is emptied and therefore the key is deleted
+    if (!module_redis_command_helper_list_normalize_range(
+            &list,
+            context->start.value,
+            context->stop.value,
+            &range_start,
+            &range_end)) {
+        storage_db_op_rmw_commit_delete(db, &rmw_status);
+        goto end_commit;
+    }
+
+    if (range_start == 0 && range_end == list.count) {
+        return_res = module_redis_connection_send_ok(connection_context);
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_list_find(
+            db,
+            &list,
+            range_start,
+            &node_index_start,
+            &node_start_first_element_index))) {
+        goto end_error;
+    }
+
+    if (unlikely(!module_redis_command_helper_list_find(
+            db,
+            &list,
+            range_end - 1,
+            &node_index_end,
+            &node_end_first_element_index))) {
+        goto end_error;
+    }
+
+    // The nodes at the edges of the range are re-packed only if they are trimmed, the ones in the middle are shared
+    if (unlikely(!module_redis_command_helper_list_node_load(db, &list, node_index_start, &node))) {
+        goto end_error;
+    }
+
+    if (node_index_start == node_index_end) {
+        if (unlikely(!module_redis_command_helper_list_builder_append_node(
+                &builder_head,
+                &node,
+                range_start - node_start_first_element_index,
+                range_end - node_start_first_element_index))) {
+            goto end_error;
+        }
+        node_index_start++;
+        node_index_end++;
+    } else {
+        if (range_start > node_start_first_element_index) {
+            if (unlikely(!module_redis_command_helper_list_builder_append_node(
+                    &builder_head,
+                    &node,
+                    range_start - node_start_first_element_index,
+                    node.count))) {
+                goto end_error;
+            }
+            node_index_start++;
+        }
+
+        module_redis_command_helper_list_node_cleanup(&node);
+        if (unlikely(!module_redis_command_helper_list_node_load(db, &list, node_index_end, &node))) {
+            goto end_error;
+        }
+
+        if (range_end < node_end_first_element_index + node.count) {
+            if (unlikely(!module_redis_command_helper_list_builder_append_node(
+                    &builder_tail,
+                    &node,
+                    0,
+                    range_end - node_end_first_element_index))) {
+                goto end_error;
+            }
+        } else {
+            node_index_end++;
+        }
+    }
+
+    chunk_sequence_new = module_redis_command_helper_list_compose(
+            db,
+            &list,
+            &builder_head,
+            node_index_start,
+            node_index_end,
+            &builder_tail,
+            range_end - range_start);
+    if (unlikely(!chunk_sequence_new)) {
+        goto end_error;
+    }
+
+    if (unlikely(!storage_db_op_rmw_commit_update(
+            db,
+            &rmw_status,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST,
+            chunk_sequence_new,
+            current_entry_index->expiry_time_ms))) {
+        goto end_error;
+    }
+
+    context->key.value.key = NULL;
+    chunk_sequence_new = NULL;
+
+end_commit:
+    transaction_release(&transaction);
+    release_transaction = false;
+    abort_rmw = false;
+
+    return_res = module_redis_connection_send_ok(connection_context);
+    goto end;
+
+end_error:
+    return_res = module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR ltrim failed");
+
+end:
+
+    module_redis_command_helper_list_node_cleanup(&node);
+    module_redis_command_helper_list_builder_cleanup(&builder_head);
+    module_redis_command_helper_list_builder_cleanup(&builder_tail);
+
+    if (unlikely(abort_rmw)) {
+        storage_db_op_rmw_abort(db, &rmw_status);
+    }
+
+    if (unlikely(release_transaction)) {
+        transaction_release(&transaction);
+    }
+
+    if (current_entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(current_entry_index, NULL);
+    }
+
+    if (unlikely(chunk_sequence_new)) {
+        storage_db_chunk_sequence_free(db, chunk_sequence_new);
+        ffma_mem_free(chunk_sequence_new);
+    }
+
+    return return_res;
+}
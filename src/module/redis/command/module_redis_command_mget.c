@@ -46,28 +46,47 @@ MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(mget) {
         return false;
     }
 
-    for(int index = 0; index < context->key.count; index++) {
-        storage_db_entry_index_t *entry_index = storage_db_get_entry_index_for_read(
+    for(int batch_start = 0; batch_start < context->key.count; batch_start += STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE) {
+        storage_db_key_and_key_length_t keys[STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE];
+        storage_db_entry_index_t *entry_indexes[STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE];
+        uint32_t batch_count = MIN(STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE, context->key.count - batch_start);
+
+        for(int index = 0; index < batch_count; index++) {
+            keys[index].key = context->key.list[batch_start + index].key;
+            keys[index].key_size = context->key.list[batch_start + index].length;
+        }
+
+        storage_db_op_get_multi(
                 connection_context->db,
-                context->key.list[index].key,
-                context->key.list[index].length);
+                keys,
+                batch_count,
+                entry_indexes);
 
-        if (unlikely(!entry_index)) {
-            if (!module_redis_connection_send_string_null(connection_context)) {
-                return false;
-            }
-        } else {
-            bool res = module_redis_command_stream_entry(
-                    connection_context->network_channel,
-                    connection_context->db,
-                    entry_index);
+        bool res = true;
+        int index = 0;
+        for(; index < batch_count && res; index++) {
+            if (unlikely(!entry_indexes[index])) {
+                res = module_redis_connection_send_string_null(connection_context);
+            } else {
+                res = module_redis_command_stream_entry(
+                        connection_context->network_channel,
+                        connection_context->db,
+                        entry_indexes[index]);
 
-            storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+                storage_db_entry_index_status_decrease_readers_counter(entry_indexes[index], NULL);
+            }
+        }
 
-            if (!res) {
-                return false;
+        // If the response can't be sent, the readers counter of the entry indexes not streamed has to be released
+        for(; index < batch_count; index++) {
+            if (entry_indexes[index]) {
+                storage_db_entry_index_status_decrease_readers_counter(entry_indexes[index], NULL);
             }
         }
+
+        if (unlikely(!res)) {
+            return false;
+        }
     }
 
     return true;
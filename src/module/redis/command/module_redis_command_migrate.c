@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_replication.h"
+#include "module/redis/module_redis_cluster.h"
+
+#define TAG "module_redis_command_migrate"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(migrate) {
+    module_redis_key_t single_key;
+    module_redis_key_t *keys;
+    uint32_t keys_count;
+    union {
+        struct sockaddr base;
+        struct sockaddr_in ipv4;
+        struct sockaddr_in6 ipv6;
+    } address = { 0 };
+    socklen_t address_size;
+    module_redis_command_migrate_context_t *context = connection_context->command.context;
+
+    // Only the database 0 is supported
+    if (context->destination_db.value != 0) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR DB index is out of range");
+    }
+
+    if (context->port.value <= 0 || context->port.value > UINT16_MAX) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Invalid target port");
+    }
+
+    // Either a single key is passed or the key is an empty string and the keys are passed after KEYS
+    if (context->keys.has_token) {
+        if (context->key.value.length > 0) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR When using MIGRATE KEYS option, the key argument must be set to the empty string");
+        }
+
+        keys = context->keys.list;
+        keys_count = context->keys.count;
+    } else {
+        single_key.key = context->key.value.short_string;
+        single_key.length = context->key.value.length;
+        keys = &single_key;
+        keys_count = 1;
+    }
+
+    if (!module_redis_cluster_parse_address(
+            context->host.value.short_string,
+            context->host.value.length,
+            context->port.value,
+            &address.base,
+            &address_size)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Invalid target address, only IP addresses are supported");
+    }
+
+    return module_redis_cluster_migrate(
+            connection_context,
+            &address.base,
+            address_size,
+            keys,
+            keys_count,
+            context->timeout.value,
+            context->copy.has_token,
+            context->replace.has_token);
+}
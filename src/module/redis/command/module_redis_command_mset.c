@@ -21,6 +21,7 @@
 #include "transaction_spinlock.h"
 #include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
+#include "memory_allocator/ffma.h"
 #include "data_structures/hashtable/mcmp/hashtable.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
 #include "protocol/redis/protocol_redis.h"
@@ -41,25 +42,46 @@
 MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(mset) {
     module_redis_command_mset_context_t *context = connection_context->command.context;
 
+    bool res;
+    uint32_t keys_set_count = 0;
+    storage_db_key_and_key_length_t *keys =
+            ffma_mem_alloc(sizeof(storage_db_key_and_key_length_t) * context->key_value.count);
+    storage_db_chunk_sequence_t **values_chunk_sequences =
+            ffma_mem_alloc(sizeof(storage_db_chunk_sequence_t*) * context->key_value.count);
+
     for(int index = 0; index < context->key_value.count; index++) {
         module_redis_command_mset_context_subargument_key_value_t *key_value = &context->key_value.list[index];
 
-        if (!storage_db_op_set(
-                connection_context->db,
-                key_value->key.value.key,
-                key_value->key.value.length,
-                STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
-                key_value->value.value.chunk_sequence,
-                STORAGE_DB_ENTRY_NO_EXPIRY)) {
-            return module_redis_connection_error_message_printf_noncritical(connection_context, "ERR mset failed");
-        }
+        keys[index].key = key_value->key.value.key;
+        keys[index].key_size = key_value->key.value.length;
+        values_chunk_sequences[index] = key_value->value.value.chunk_sequence;
+    }
+
+    res = storage_db_op_set_multi(
+            connection_context->db,
+            keys,
+            values_chunk_sequences,
+            context->key_value.count,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+            STORAGE_DB_ENTRY_NO_EXPIRY,
+            &keys_set_count);
+
+    // Mark both the keys and the chunk_sequences stored as NULL as the storage db now owns them, we don't want them to
+    // be automatically freed at the end of the execution, especially the keys as the hashtable might not need to hold
+    // a reference to them, they might have already been freed
+    for(uint32_t index = 0; index < keys_set_count; index++) {
+        module_redis_command_mset_context_subargument_key_value_t *key_value = &context->key_value.list[index];
 
-        // Mark both the key and the chunk_sequence as NULL as the storage db now owns them, we don't want them to be
-        // automatically freed at the end of the execution, especially the key as the hashtable might not need to hold
-        // a reference to it, it might have already been freed
         key_value->key.value.key = NULL;
         key_value->value.value.chunk_sequence = NULL;
     }
 
+    ffma_mem_free(keys);
+    ffma_mem_free(values_chunk_sequences);
+
+    if (unlikely(!res)) {
+        return module_redis_connection_error_message_printf_noncritical(connection_context, "ERR mset failed");
+    }
+
     return module_redis_connection_send_ok(connection_context);
 }
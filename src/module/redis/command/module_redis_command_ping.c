@@ -23,6 +23,7 @@
 #include "data_structures/double_linked_list/double_linked_list.h"
 #include "data_structures/hashtable/mcmp/hashtable.h"
 #include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "protocol/redis/protocol_redis.h"
 #include "protocol/redis/protocol_redis_reader.h"
 #include "protocol/redis/protocol_redis_writer.h"
@@ -35,14 +36,34 @@
 #include "storage/db/storage_db.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
 
 #define TAG "module_redis_command_ping"
 
 MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(ping) {
     module_redis_command_ping_context_t *context = connection_context->command.context;
+
+    // In RESP2, when the connection is subscribed to channels or patterns, the reply has the same format of the messages
+    if (unlikely(connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2 &&
+            module_redis_pubsub_client_subscriptions_count(connection_context) > 0)) {
+        if (unlikely(!module_redis_connection_send_array_header(connection_context, 2))) {
+            return false;
+        }
+
+        if (unlikely(!module_redis_connection_send_blob_string(connection_context, "pong", strlen("pong")))) {
+            return false;
+        }
+
+        return module_redis_connection_send_blob_string(
+                connection_context,
+                context->message.value.short_string ? context->message.value.short_string : "",
+                context->message.value.short_string ? context->message.value.length : 0);
+    }
+
     if (context->message.value.short_string) {
-        size_t string_length = context->message.value.length + 32 > NETWORK_CHANNEL_MAX_PACKET_SIZE
-                ? NETWORK_CHANNEL_MAX_PACKET_SIZE - 32
+        size_t string_length =
+                context->message.value.length + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH > NETWORK_CHANNEL_MAX_PACKET_SIZE
+                ? NETWORK_CHANNEL_MAX_PACKET_SIZE - PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH
                 : context->message.value.length;
 
         return module_redis_connection_send_blob_string(
@@ -0,0 +1,88 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
+
+#define TAG "module_redis_command_publish"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(publish) {
+    bool allocated_new_buffer = false;
+    module_redis_pubsub_message_t *message;
+    module_redis_command_publish_context_t *context = connection_context->command.context;
+    storage_db_chunk_sequence_t *chunk_sequence = context->message.value.chunk_sequence;
+
+    // The message is copied only once, all the workers having subscribers will share it
+    message = module_redis_pubsub_message_new(
+            context->channel.value.short_string,
+            context->channel.value.length,
+            chunk_sequence->size);
+    if (unlikely(!message)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR publish failed");
+    }
+
+    size_t message_offset = 0;
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        char *chunk_data = storage_db_get_chunk_data(
+                connection_context->db,
+                chunk_info,
+                &allocated_new_buffer);
+        if (unlikely(chunk_data == NULL)) {
+            module_redis_pubsub_message_free(message);
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR publish failed");
+        }
+
+        memcpy(message->message + message_offset, chunk_data, chunk_info->chunk_length);
+        message_offset += chunk_info->chunk_length;
+
+        if (allocated_new_buffer) {
+            ffma_mem_free(chunk_data);
+            allocated_new_buffer = false;
+        }
+    }
+
+    return module_redis_connection_send_number(
+            connection_context,
+            (int64_t)module_redis_pubsub_publish(message));
+}
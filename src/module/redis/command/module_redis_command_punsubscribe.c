@@ -0,0 +1,115 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
+
+#define TAG "module_redis_command_punsubscribe"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(punsubscribe) {
+    char *name;
+    size_t name_length;
+    module_redis_command_punsubscribe_context_t *context = connection_context->command.context;
+
+    if (context->pattern.count > 0) {
+        for(int index = 0; index < context->pattern.count; index++) {
+            module_redis_pattern_t *pattern = &context->pattern.list[index];
+
+            module_redis_pubsub_client_unsubscribe(
+                    connection_context,
+                    pattern->pattern,
+                    pattern->length,
+                    true);
+
+            if (unlikely(!module_redis_pubsub_client_send_subscription_reply(
+                    connection_context,
+                    "punsubscribe",
+                    strlen("punsubscribe"),
+                    pattern->pattern,
+                    pattern->length))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Without arguments the client is unsubscribed from all the patterns, if there are none a single reply is sent
+    // with the pattern set to null
+    if ((name = module_redis_pubsub_client_get_first_subscription(
+            connection_context,
+            true,
+            &name_length)) == NULL) {
+        return module_redis_pubsub_client_send_subscription_reply(
+                connection_context,
+                "punsubscribe",
+                strlen("punsubscribe"),
+                NULL,
+                0);
+    }
+
+    do {
+        // The reply has to be sent before unsubscribing as the name is owned by the subscription
+        if (unlikely(!module_redis_connection_send_push_header(connection_context, 3))) {
+            return false;
+        }
+
+        if (unlikely(!module_redis_connection_send_blob_string(
+                connection_context,
+                "punsubscribe",
+                strlen("punsubscribe")))) {
+            return false;
+        }
+
+        if (unlikely(!module_redis_connection_send_blob_string(connection_context, name, name_length))) {
+            return false;
+        }
+
+        module_redis_pubsub_client_unsubscribe(connection_context, name, name_length, true);
+
+        if (unlikely(!module_redis_connection_send_number(
+                connection_context,
+                module_redis_pubsub_client_subscriptions_count(connection_context)))) {
+            return false;
+        }
+    } while((name = module_redis_pubsub_client_get_first_subscription(
+            connection_context,
+            true,
+            &name_length)) != NULL);
+
+    return true;
+}
@@ -0,0 +1,122 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_replication.h"
+#include "utils_string.h"
+
+#define TAG "module_redis_command_replicaof"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(replicaof) {
+    char host[INET6_ADDRSTRLEN];
+    char port_str[8];
+    char *port_end = NULL;
+    long port;
+    union {
+        struct sockaddr base;
+        struct sockaddr_in ipv4;
+        struct sockaddr_in6 ipv6;
+    } address = { 0 };
+    socklen_t address_size;
+    module_redis_command_replicaof_context_t *context = connection_context->command.context;
+
+    if (utils_string_casecmp_eq_32(
+            context->host.value.short_string,
+            context->host.value.length,
+            "NO",
+            2) &&
+        utils_string_casecmp_eq_32(
+            context->port.value.short_string,
+            context->port.value.length,
+            "ONE",
+            3)) {
+        module_redis_replication_replicaof_no_one();
+        return module_redis_connection_send_ok(connection_context);
+    }
+
+    if (context->port.value.length == 0 || context->port.value.length >= sizeof(port_str)) {
+        goto invalid_port;
+    }
+
+    memcpy(port_str, context->port.value.short_string, context->port.value.length);
+    port_str[context->port.value.length] = 0;
+
+    port = strtol(port_str, &port_end, 10);
+    if (*port_end != 0 || port <= 0 || port > UINT16_MAX) {
+        goto invalid_port;
+    }
+
+    if (context->host.value.length >= sizeof(host)) {
+        goto invalid_address;
+    }
+
+    memcpy(host, context->host.value.short_string, context->host.value.length);
+    host[context->host.value.length] = 0;
+
+    // Only the IP addresses are supported, resolving an hostname would block the worker
+    if (inet_pton(AF_INET, host, &address.ipv4.sin_addr) == 1) {
+        address.ipv4.sin_family = AF_INET;
+        address.ipv4.sin_port = htons(port);
+        address_size = sizeof(address.ipv4);
+    } else if (inet_pton(AF_INET6, host, &address.ipv6.sin6_addr) == 1) {
+        address.ipv6.sin6_family = AF_INET6;
+        address.ipv6.sin6_port = htons(port);
+        address_size = sizeof(address.ipv6);
+    } else {
+        goto invalid_address;
+    }
+
+    if (unlikely(!module_redis_replication_replicaof(connection_context, &address.base, address_size))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Unable to start the replication");
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+
+invalid_port:
+    return module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR Invalid master port");
+
+invalid_address:
+    return module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR Invalid master address, only IP addresses are supported");
+}
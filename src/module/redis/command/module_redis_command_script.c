@@ -0,0 +1,172 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "utils_string.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_script.h"
+
+#define TAG "module_redis_command_script"
+
+static bool module_redis_command_script_read_sha1(
+        storage_db_t *db,
+        module_redis_long_string_t *string,
+        char *sha1) {
+    bool allocated_new_buffer = false;
+    storage_db_chunk_sequence_t *chunk_sequence = string->chunk_sequence;
+    size_t sha1_offset = 0;
+
+    if (chunk_sequence->size != MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH) {
+        return false;
+    }
+
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        char *chunk_data = storage_db_get_chunk_data(
+                db,
+                chunk_info,
+                &allocated_new_buffer);
+        if (unlikely(chunk_data == NULL)) {
+            return false;
+        }
+
+        memcpy(sha1 + sha1_offset, chunk_data, chunk_info->chunk_length);
+        sha1_offset += chunk_info->chunk_length;
+
+        if (allocated_new_buffer) {
+            ffma_mem_free(chunk_data);
+            allocated_new_buffer = false;
+        }
+    }
+
+    return true;
+}
+
+static bool module_redis_command_script_load(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_script_context_t *context) {
+    char sha1[MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH];
+
+    if (context->subcommand_argument.count != 1) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR wrong number of arguments for 'script|load' command");
+    }
+
+    if (!module_redis_script_load(connection_context, &context->subcommand_argument.list[0], sha1)) {
+        // The compilation errors are reported to the client
+        if (module_redis_connection_has_error(connection_context)) {
+            return true;
+        }
+
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR script load failed");
+    }
+
+    return module_redis_connection_send_blob_string(
+            connection_context,
+            sha1,
+            sizeof(sha1));
+}
+
+static bool module_redis_command_script_exists(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_script_context_t *context) {
+    char sha1[MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH];
+
+    if (context->subcommand_argument.count == 0) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR wrong number of arguments for 'script|exists' command");
+    }
+
+    if (!module_redis_connection_send_array_header(connection_context, context->subcommand_argument.count)) {
+        return false;
+    }
+
+    for(int index = 0; index < context->subcommand_argument.count; index++) {
+        bool exists =
+                module_redis_command_script_read_sha1(
+                        connection_context->db,
+                        &context->subcommand_argument.list[index],
+                        sha1) &&
+                module_redis_script_exists(sha1, sizeof(sha1));
+
+        if (!module_redis_connection_send_number(connection_context, exists ? 1 : 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool module_redis_command_script_flush(
+        module_redis_connection_context_t *connection_context,
+        module_redis_command_script_context_t *context) {
+    // ASYNC and SYNC are accepted for compatibility, the registry is always flushed synchronously
+    if (context->subcommand_argument.count > 1) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR wrong number of arguments for 'script|flush' command");
+    }
+
+    module_redis_script_flush();
+
+    return module_redis_connection_send_ok(connection_context);
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(script) {
+    module_redis_command_script_context_t *context = connection_context->command.context;
+    char *subcommand = context->subcommand.value.short_string;
+    size_t subcommand_length = context->subcommand.value.length;
+
+    if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "LOAD", 4)) {
+        return module_redis_command_script_load(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "EXISTS", 6)) {
+        return module_redis_command_script_exists(connection_context, context);
+    } else if (utils_string_casecmp_eq_32(subcommand, subcommand_length, "FLUSH", 5)) {
+        return module_redis_command_script_flush(connection_context, context);
+    }
+
+    return module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "ERR unknown subcommand '%.*s'. Try SCRIPT HELP.",
+            (int)subcommand_length,
+            subcommand);
+}
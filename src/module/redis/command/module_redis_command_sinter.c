@@ -0,0 +1,279 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "hash/hash_fnv1.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+#include "module/redis/command/helpers/module_redis_command_helper_varint.h"
+#include "module/redis/command/helpers/module_redis_command_helper_set.h"
+
+#define TAG "module_redis_command_sinter"
+
+static int module_redis_command_sinter_sets_compare(
+        const void *a,
+        const void *b) {
+    uint32_t a_count = (*(module_redis_command_helper_set_t**)a)->count;
+    uint32_t b_count = (*(module_redis_command_helper_set_t**)b)->count;
+
+    return a_count < b_count ? -1 : (a_count > b_count ? 1 : 0);
+}
+
+static bool module_redis_command_sinter_send_integers(
+        module_redis_connection_context_t *connection_context,
+        int64_t *integers,
+        uint32_t count) {
+    char member[MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH];
+
+    if (unlikely(!module_redis_connection_send_set_header(connection_context, count))) {
+        return false;
+    }
+
+    for(uint32_t index = 0; index < count; index++) {
+        size_t member_length = module_redis_command_helper_set_int64_to_member(integers[index], member);
+
+        if (unlikely(!module_redis_connection_send_blob_string(connection_context, member, member_length))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(sinter) {
+    bool return_res = false;
+    int loaded_count = 0;
+    uint32_t result_count = 0;
+    int64_t *result_integers = NULL;
+    size_t result_integers_size = 0;
+    struct {
+        char *member;
+        size_t member_length;
+    } *result_members = NULL;
+    size_t result_members_size = 0;
+    module_redis_command_helper_set_t *sets = NULL, **sets_sorted = NULL;
+    storage_db_entry_index_t **entry_indexes = NULL;
+    module_redis_command_sinter_context_t *context = connection_context->command.context;
+    uint32_t keys_count = context->key.count;
+
+    entry_indexes = module_redis_command_helper_buffer_alloc_zero(sizeof(storage_db_entry_index_t*) * keys_count);
+    sets = module_redis_command_helper_buffer_alloc_zero(sizeof(module_redis_command_helper_set_t) * keys_count);
+    sets_sorted = module_redis_command_helper_buffer_alloc(sizeof(module_redis_command_helper_set_t*) * keys_count);
+
+    if (unlikely(!entry_indexes || !sets || !sets_sorted)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR sinter failed");
+        goto end;
+    }
+
+    for(uint32_t index = 0; index < keys_count; index++) {
+        entry_indexes[index] = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                context->key.list[index].key,
+                context->key.list[index].length);
+
+        // If a key doesn't exist the intersection is empty
+        if (!entry_indexes[index]) {
+            return_res = module_redis_connection_send_set_header(connection_context, 0);
+            goto end;
+        }
+
+        if (unlikely(entry_indexes[index]->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    MODULE_REDIS_ERROR_WRONGTYPE);
+            goto end;
+        }
+
+        loaded_count++;
+        if (unlikely(!module_redis_command_helper_set_load(
+                connection_context->db,
+                entry_indexes[index],
+                &sets[index]))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR sinter failed");
+            goto end;
+        }
+
+        sets_sorted[index] = &sets[index];
+    }
+
+    // The sets are intersected starting from the smallest one, so the amount of members to check in the bigger sets
+    // is always the minimum
+    qsort(sets_sorted, keys_count, sizeof(module_redis_command_helper_set_t*), module_redis_command_sinter_sets_compare);
+
+    // If the smallest set is an intset the intersection is an intset as well, the intsets are intersected with the
+    // SIMD accelerated galloping search and the other sets are probed
+    if (sets_sorted[0]->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+        result_integers_size = MAX(sizeof(int64_t) * sets_sorted[0]->count, 1);
+        result_integers = module_redis_command_helper_buffer_alloc(result_integers_size);
+
+        if (unlikely(!result_integers)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR sinter failed");
+            goto end;
+        }
+
+        result_count = sets_sorted[0]->count;
+        if (result_count > 0) {
+            memcpy(result_integers, sets_sorted[0]->integers, sizeof(int64_t) * result_count);
+        }
+
+        for(uint32_t index = 1; index < keys_count && result_count > 0; index++) {
+            module_redis_command_helper_set_t *set = sets_sorted[index];
+
+            if (set->encoding == MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+                result_count = module_redis_command_helper_set_intset_intersect(
+                        result_integers,
+                        result_count,
+                        set->integers,
+                        set->count,
+                        result_integers);
+            } else {
+                uint32_t new_result_count = 0;
+                for(uint32_t result_index = 0; result_index < result_count; result_index++) {
+                    if (module_redis_command_helper_set_contains_int64(
+                            connection_context->db,
+                            set,
+                            result_integers[result_index])) {
+                        result_integers[new_result_count++] = result_integers[result_index];
+                    }
+                }
+                result_count = new_result_count;
+            }
+        }
+
+        return_res = module_redis_command_sinter_send_integers(connection_context, result_integers, result_count);
+    } else {
+        module_redis_command_helper_set_iter_t iter = { 0 };
+        char *member;
+        size_t member_length;
+
+        // The smallest set isn't an intset, the nodes loaded are kept by the set until the cleanup so its members can
+        // be collected without being copied
+        result_members_size = MAX(sizeof(*result_members) * sets_sorted[0]->count, 1);
+        result_members = module_redis_command_helper_buffer_alloc(result_members_size);
+
+        if (unlikely(!result_members)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR sinter failed");
+            goto end;
+        }
+
+        while(module_redis_command_helper_set_iter(
+                connection_context->db,
+                sets_sorted[0],
+                &iter,
+                &member,
+                &member_length)) {
+            bool found = true;
+
+            for(uint32_t index = 1; index < keys_count && found; index++) {
+                found = module_redis_command_helper_set_contains(
+                        connection_context->db,
+                        sets_sorted[index],
+                        member,
+                        member_length);
+            }
+
+            if (found) {
+                result_members[result_count].member = member;
+                result_members[result_count].member_length = member_length;
+                result_count++;
+            }
+        }
+
+        module_redis_command_helper_set_iter_cleanup(&iter);
+
+        if (unlikely(!module_redis_connection_send_set_header(connection_context, result_count))) {
+            goto end;
+        }
+
+        for(uint32_t index = 0; index < result_count; index++) {
+            if (unlikely(!module_redis_connection_send_blob_string(
+                    connection_context,
+                    result_members[index].member,
+                    result_members[index].member_length))) {
+                goto end;
+            }
+        }
+
+        return_res = true;
+    }
+
+end:
+
+    if (result_integers) {
+        module_redis_command_helper_buffer_free(result_integers, result_integers_size);
+    }
+
+    if (result_members) {
+        module_redis_command_helper_buffer_free(result_members, result_members_size);
+    }
+
+    if (sets) {
+        for(int index = 0; index < loaded_count; index++) {
+            module_redis_command_helper_set_cleanup(&sets[index]);
+        }
+
+        module_redis_command_helper_buffer_free(sets, sizeof(module_redis_command_helper_set_t) * keys_count);
+    }
+
+    if (sets_sorted) {
+        module_redis_command_helper_buffer_free(sets_sorted, sizeof(module_redis_command_helper_set_t*) * keys_count);
+    }
+
+    if (entry_indexes) {
+        for(uint32_t index = 0; index < keys_count; index++) {
+            if (entry_indexes[index]) {
+                storage_db_entry_index_status_decrease_readers_counter(entry_indexes[index], NULL);
+            }
+        }
+
+        module_redis_command_helper_buffer_free(entry_indexes, sizeof(storage_db_entry_index_t*) * keys_count);
+    }
+
+    return return_res;
+}
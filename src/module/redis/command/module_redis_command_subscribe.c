@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_pubsub.h"
+
+#define TAG "module_redis_command_subscribe"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(subscribe) {
+    module_redis_command_subscribe_context_t *context = connection_context->command.context;
+
+    for(int index = 0; index < context->channel.count; index++) {
+        module_redis_short_string_t *channel = &context->channel.list[index];
+
+        if (unlikely(!module_redis_pubsub_client_subscribe(
+                connection_context,
+                channel->short_string,
+                channel->length,
+                false))) {
+            return module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR subscribe failed");
+        }
+
+        if (unlikely(!module_redis_pubsub_client_send_subscription_reply(
+                connection_context,
+                "subscribe",
+                strlen("subscribe"),
+                channel->short_string,
+                channel->length))) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,217 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "hash/hash_fnv1.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "xalloc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+#include "module/redis/command/helpers/module_redis_command_helper_varint.h"
+#include "module/redis/command/helpers/module_redis_command_helper_set.h"
+
+#define TAG "module_redis_command_sunion"
+
+static int module_redis_command_sunion_integers_compare(
+        const void *a,
+        const void *b) {
+    int64_t a_value = *(int64_t*)a;
+    int64_t b_value = *(int64_t*)b;
+
+    return a_value < b_value ? -1 : (a_value > b_value ? 1 : 0);
+}
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(sunion) {
+    bool return_res = false;
+    bool all_intsets = true;
+    int loaded_count = 0;
+    uint64_t integers_count = 0;
+    int64_t *integers = NULL;
+    size_t integers_size = 0;
+    module_redis_command_helper_set_t result_set = { 0 };
+    module_redis_command_helper_set_t *sets = NULL;
+    storage_db_entry_index_t **entry_indexes = NULL;
+    module_redis_command_sunion_context_t *context = connection_context->command.context;
+    uint32_t keys_count = context->key.count;
+
+    entry_indexes = module_redis_command_helper_buffer_alloc_zero(sizeof(storage_db_entry_index_t*) * keys_count);
+    sets = module_redis_command_helper_buffer_alloc_zero(sizeof(module_redis_command_helper_set_t) * keys_count);
+
+    if (unlikely(!entry_indexes || !sets)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR sunion failed");
+        goto end;
+    }
+
+    for(uint32_t index = 0; index < keys_count; index++) {
+        entry_indexes[index] = storage_db_get_entry_index_for_read(
+                connection_context->db,
+                context->key.list[index].key,
+                context->key.list[index].length);
+
+        // The keys that don't exist are empty sets
+        if (!entry_indexes[index]) {
+            module_redis_command_helper_set_init(&sets[index], MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET);
+            loaded_count++;
+            continue;
+        }
+
+        if (unlikely(entry_indexes[index]->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    MODULE_REDIS_ERROR_WRONGTYPE);
+            goto end;
+        }
+
+        loaded_count++;
+        if (unlikely(!module_redis_command_helper_set_load(
+                connection_context->db,
+                entry_indexes[index],
+                &sets[index]))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR sunion failed");
+            goto end;
+        }
+
+        if (sets[index].encoding != MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_INTSET) {
+            all_intsets = false;
+        }
+
+        integers_count += sets[index].count;
+    }
+
+    if (all_intsets) {
+        // The union of intsets is computed concatenating the integers, sorting them and dropping the duplicates
+        uint64_t unique_count = 0;
+        char member[MODULE_REDIS_COMMAND_HELPER_SET_INT64_STR_MAX_LENGTH];
+
+        integers_size = MAX(sizeof(int64_t) * integers_count, 1);
+        integers = module_redis_command_helper_buffer_alloc(integers_size);
+
+        if (unlikely(!integers)) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR sunion failed");
+            goto end;
+        }
+
+        integers_count = 0;
+        for(uint32_t index = 0; index < keys_count; index++) {
+            if (sets[index].count > 0) {
+                memcpy(integers + integers_count, sets[index].integers, sizeof(int64_t) * sets[index].count);
+                integers_count += sets[index].count;
+            }
+        }
+
+        qsort(integers, integers_count, sizeof(int64_t), module_redis_command_sunion_integers_compare);
+
+        for(uint64_t index = 0; index < integers_count; index++) {
+            if (unique_count == 0 || integers[unique_count - 1] != integers[index]) {
+                integers[unique_count++] = integers[index];
+            }
+        }
+
+        if (unlikely(!module_redis_connection_send_set_header(connection_context, unique_count))) {
+            goto end;
+        }
+
+        for(uint64_t index = 0; index < unique_count; index++) {
+            size_t member_length = module_redis_command_helper_set_int64_to_member(integers[index], member);
+
+            if (unlikely(!module_redis_connection_send_blob_string(connection_context, member, member_length))) {
+                goto end;
+            }
+        }
+
+        return_res = true;
+    } else {
+        module_redis_command_helper_set_init(&result_set, MODULE_REDIS_COMMAND_HELPER_SET_ENCODING_HASHTABLE);
+
+        if (unlikely(!module_redis_command_helper_set_edit_begin(&result_set))) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR sunion failed");
+            goto end;
+        }
+
+        for(uint32_t index = 0; index < keys_count; index++) {
+            if (unlikely(!module_redis_command_helper_set_merge(
+                    connection_context->db,
+                    &result_set,
+                    &sets[index]))) {
+                return_res = module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR sunion failed");
+                goto end;
+            }
+        }
+
+        return_res = module_redis_command_helper_set_send_members(connection_context, &result_set);
+    }
+
+end:
+
+    module_redis_command_helper_set_cleanup(&result_set);
+
+    if (integers) {
+        module_redis_command_helper_buffer_free(integers, integers_size);
+    }
+
+    if (sets) {
+        for(int index = 0; index < loaded_count; index++) {
+            module_redis_command_helper_set_cleanup(&sets[index]);
+        }
+
+        module_redis_command_helper_buffer_free(sets, sizeof(module_redis_command_helper_set_t) * keys_count);
+    }
+
+    if (entry_indexes) {
+        for(uint32_t index = 0; index < keys_count; index++) {
+            if (entry_indexes[index]) {
+                storage_db_entry_index_status_decrease_readers_counter(entry_indexes[index], NULL);
+            }
+        }
+
+        module_redis_command_helper_buffer_free(entry_indexes, sizeof(storage_db_entry_index_t*) * keys_count);
+    }
+
+    return return_res;
+}
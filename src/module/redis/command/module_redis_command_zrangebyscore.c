@@ -0,0 +1,138 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "network/channel/network_channel.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/command/helpers/module_redis_command_helper_sorted_set.h"
+
+#define TAG "module_redis_command_zrangebyscore"
+
+MODULE_REDIS_COMMAND_FUNCPTR_COMMAND_END(zrangebyscore) {
+    bool return_res = false;
+    double min, max;
+    bool min_exclusive, max_exclusive;
+    uint64_t range_start, range_end;
+    storage_db_entry_index_t *entry_index = NULL;
+    module_redis_command_helper_sorted_set_t sorted_set = { 0 };
+    module_redis_command_zrangebyscore_context_t *context = connection_context->command.context;
+
+    if (unlikely(!module_redis_command_helper_sorted_set_parse_score_bound(
+            context->min.value.short_string,
+            context->min.value.length,
+            &min,
+            &min_exclusive) || !module_redis_command_helper_sorted_set_parse_score_bound(
+            context->max.value.short_string,
+            context->max.value.length,
+            &max,
+            &max_exclusive))) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR min or max is not a float");
+    }
+
+    entry_index = storage_db_get_entry_index_for_read(
+            connection_context->db,
+            context->key.value.key,
+            context->key.value.length);
+
+    if (unlikely(!entry_index)) {
+        return_res = module_redis_connection_send_array_header(connection_context, 0);
+        goto end;
+    }
+
+    if (unlikely(entry_index->value_type != STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                MODULE_REDIS_ERROR_WRONGTYPE);
+        goto end;
+    }
+
+    // The score range is converted into a rank range, the amount of members to send is needed upfront for the header
+    // of the reply
+    if (unlikely(!module_redis_command_helper_sorted_set_load(connection_context->db, entry_index, &sorted_set) ||
+            !module_redis_command_helper_sorted_set_count_below(
+                    connection_context->db,
+                    &sorted_set,
+                    min,
+                    min_exclusive,
+                    &range_start) ||
+            !module_redis_command_helper_sorted_set_count_below(
+                    connection_context->db,
+                    &sorted_set,
+                    max,
+                    !max_exclusive,
+                    &range_end))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR zrangebyscore failed");
+        goto end;
+    }
+
+    if (context->limit_offset_count.has_token) {
+        int64_t offset = context->limit_offset_count.value.offset.value;
+        int64_t count = context->limit_offset_count.value.count.value;
+
+        if (offset < 0) {
+            range_start = range_end;
+        } else {
+            range_start += offset;
+        }
+
+        if (count >= 0 && range_start < range_end && range_end - range_start > (uint64_t)count) {
+            range_end = range_start + count;
+        }
+    }
+
+    return_res = module_redis_command_helper_sorted_set_send_range(
+            connection_context,
+            &sorted_set,
+            range_start,
+            range_end,
+            context->withscores.has_token);
+
+end:
+
+    module_redis_command_helper_sorted_set_cleanup(&sorted_set);
+
+    if (entry_index) {
+        storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+    }
+
+    return return_res;
+}
@@ -47,6 +47,11 @@
 #include "module_redis.h"
 #include "module_redis_connection.h"
 #include "module_redis_command.h"
+#include "module_redis_pubsub.h"
+#include "module_redis_multi.h"
+#include "module_redis_replication.h"
+#include "module_redis_aof.h"
+#include "module_redis_cluster.h"
 #include "module_redis_commands.h"
 #include "module_redis_autogenerated_commands_callbacks.h"
 #include "module_redis_autogenerated_commands_arguments.h"
@@ -54,6 +59,13 @@
 
 #define TAG "module_redis"
 
+// Amount of ops processed per invocation of the batch reader
+#define MODULE_REDIS_PROCESS_DATA_OPS_SIZE 64
+
+// A complete GET command is always parsed into 8 ops: the command begin, 3 ops for the command name, 3 ops for the key
+// and the command end
+#define MODULE_REDIS_PROCESS_DATA_GET_COMMAND_OPS_COUNT 8
+
 hashtable_spsc_t *module_redis_commands_hashtable = NULL;
 
 FUNCTION_CTOR(module_redis_commands_ctor, {
@@ -119,10 +131,22 @@ void module_redis_accept(
                 network_buffer_rewind(&connection_context.read_buffer);
             }
 
-            exit_loop = network_receive(
+            // The messages received for the subscribed channels and patterns are sent before waiting for new data
+            exit_loop = !module_redis_pubsub_client_flush_pending(&connection_context);
+        }
+
+        if (likely(!exit_loop)) {
+            network_op_result_t res = network_receive(
                     network_channel,
                     &connection_context.read_buffer,
-                    NETWORK_CHANNEL_MAX_PACKET_SIZE) != NETWORK_OP_RESULT_OK;
+                    NETWORK_CHANNEL_MAX_PACKET_SIZE);
+
+            // The receive is interrupted when there are new pending messages to send
+            if (res == NETWORK_OP_RESULT_INTERRUPTED) {
+                continue;
+            }
+
+            exit_loop = res != NETWORK_OP_RESULT_OK;
         }
 
         if (likely(!exit_loop)) {
@@ -136,258 +160,430 @@ void module_redis_accept(
     // module_redis_process_data returns false and the receiving loop above terminates immediately
     module_redis_command_process_try_free(
             &connection_context);
+    module_redis_pubsub_client_free(
+            &connection_context);
+    module_redis_multi_free(
+            &connection_context);
+    module_redis_replication_client_free(
+            &connection_context);
     module_redis_connection_context_reset(
             &connection_context);
     module_redis_connection_context_cleanup(
             &connection_context);
 }
 
+static inline bool module_redis_process_data_is_get_command(
+        char *read_buffer_data_start,
+        protocol_redis_reader_op_t *command_ops) {
+    protocol_redis_reader_op_t *command_name_op = &command_ops[2];
+    protocol_redis_reader_op_t *key_op = &command_ops[5];
+
+    return
+            command_ops[0].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN &&
+            command_ops[0].data.command.arguments_count == 2 &&
+            command_name_op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA &&
+            command_name_op->data.argument.length == 3 &&
+            command_name_op->data.argument.data_length == 3 &&
+            key_op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA &&
+            key_op->data.argument.data_length == key_op->data.argument.length &&
+            command_ops[7].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END &&
+            strncasecmp(read_buffer_data_start + command_name_op->data.argument.offset, "GET", 3) == 0;
+}
+
+static void module_redis_process_data_prefetch_get_commands_keys(
+        module_redis_connection_context_t *connection_context,
+        char *read_buffer_data_start,
+        protocol_redis_reader_op_t *ops,
+        uint8_t ops_count) {
+    uint8_t key_ops_indexes[MODULE_REDIS_PROCESS_DATA_OPS_SIZE / MODULE_REDIS_PROCESS_DATA_GET_COMMAND_OPS_COUNT];
+    uint8_t key_ops_indexes_count = 0;
+
+    // Collect the keys of the pipelined GET commands fully contained in the ops, the commands are not validated here,
+    // the usual processing will take care of it
+    for(
+            uint8_t op_index = 0;
+            op_index + MODULE_REDIS_PROCESS_DATA_GET_COMMAND_OPS_COUNT <= ops_count &&
+            key_ops_indexes_count < ARRAY_SIZE(key_ops_indexes);
+            op_index++) {
+        if (!module_redis_process_data_is_get_command(read_buffer_data_start, &ops[op_index])) {
+            continue;
+        }
+
+        key_ops_indexes[key_ops_indexes_count++] = op_index + 5;
+        op_index += MODULE_REDIS_PROCESS_DATA_GET_COMMAND_OPS_COUNT - 1;
+    }
+
+    // If there is only one GET command the prefetch would be immediately followed by the lookup, nothing to gain
+    if (key_ops_indexes_count < 2) {
+        return;
+    }
+
+    // Hash all the keys and prefetch the hashtable chunks before any lookup takes place, when the commands will be
+    // processed in order the half hashes will already be in cache
+    for(uint8_t index = 0; index < key_ops_indexes_count; index++) {
+        protocol_redis_reader_op_t *key_op = &ops[key_ops_indexes[index]];
+
+        storage_db_entry_index_prefetch(
+                connection_context->db,
+                read_buffer_data_start + key_op->data.argument.offset,
+                key_op->data.argument.length);
+    }
+}
+
+static inline bool module_redis_process_data_is_command_allowed_in_pubsub(
+        module_redis_connection_context_t *connection_context) {
+    if (likely(connection_context->pubsub_client == NULL) ||
+        connection_context->resp_version != PROTOCOL_REDIS_RESP_VERSION_2 ||
+        module_redis_pubsub_client_subscriptions_count(connection_context) == 0) {
+        return true;
+    }
+
+    switch(connection_context->command.info->command) {
+        case MODULE_REDIS_COMMAND_SUBSCRIBE:
+        case MODULE_REDIS_COMMAND_UNSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PUNSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PING:
+        case MODULE_REDIS_COMMAND_QUIT:
+            return true;
+        default:
+            return false;
+    }
+}
+
 bool module_redis_process_data(
         module_redis_connection_context_t *connection_context,
         network_channel_buffer_t *read_buffer) {
     int32_t ops_found;
     bool return_result = false;
-    protocol_redis_reader_op_t ops[8] = { 0 };
+    protocol_redis_reader_op_t ops[MODULE_REDIS_PROCESS_DATA_OPS_SIZE] = { 0 };
     uint8_t ops_size = (sizeof(ops) / sizeof(protocol_redis_reader_op_t));
 
-    worker_context_t *worker_context = worker_context_get();
-
-    // The loops below terminate if data_size is equals to zero, it should never happen that this function is invoked
+    // The loop below terminates if data_size is equals to zero, it should never happen that this function is invoked
     // with the read buffer empty.
     assert(read_buffer->data_size > 0);
 
     do {
-        // Keep reading till there are data in the buffer
-        do {
-            network_channel_buffer_data_t *read_buffer_data_start = read_buffer->data + read_buffer->data_offset;
-            ops_found = protocol_redis_reader_read(
+        // protocol_redis_reader_read_batch parses as many commands as possible till ops is filled, the ops of
+        // different commands are processed in sequence and the COMMAND_END op is used to reset the connection context
+        network_channel_buffer_data_t *read_buffer_data_start = read_buffer->data + read_buffer->data_offset;
+        ops_found = protocol_redis_reader_read_batch(
+                read_buffer_data_start,
+                read_buffer->data_size,
+                &connection_context->reader_context,
+                ops,
+                ops_size);
+
+        assert(ops_found < UINT8_MAX);
+
+        if (unlikely(ops_found == -1)) {
+            assert(module_redis_connection_reader_has_error(connection_context));
+            module_redis_connection_set_error_message_from_reader(connection_context);
+        } else if (ops_found >= MODULE_REDIS_PROCESS_DATA_GET_COMMAND_OPS_COUNT * 2) {
+            module_redis_process_data_prefetch_get_commands_keys(
+                    connection_context,
                     read_buffer_data_start,
-                    read_buffer->data_size,
-                    &connection_context->reader_context,
                     ops,
-                    ops_size);
+                    ops_found);
+        }
 
-            assert(ops_found < UINT8_MAX);
+        // ops_found has to be bigger than uint8_t because protocol_redis_reader_read_batch must return -1 in case of
+        // errors, but otherwise it will always return values that are contained in an uint8_t
+        for (uint8_t op_index = 0; ops_found > 0 && op_index < (uint8_t)ops_found; op_index++) {
+            protocol_redis_reader_op_t *op = &ops[op_index];
 
-            if (unlikely(module_redis_connection_reader_has_error(connection_context))) {
-                assert(ops_found == -1);
-                module_redis_connection_set_error_message_from_reader(connection_context);
-                break;
-            }
+            read_buffer->data_offset += op->data_read_len;
+            read_buffer->data_size -= op->data_read_len;
+            connection_context->command.data_length += op->data_read_len;
 
-            if (unlikely(ops_found == 0)) {
+            if (unlikely(module_redis_connection_command_too_long(connection_context))) {
+                module_redis_connection_error_message_printf_critical(
+                        connection_context,
+                        "ERR the command length has exceeded '%u' bytes",
+                        connection_context->network_channel->module_config->redis->max_command_length);
                 break;
             }
 
-            // ops_found has to be bigger than uint8_t because protocol_redis_reader_read must return -1 in case of
-            // errors, but otherwise it will always return values that are contained in an uint8_t
-            for (uint8_t op_index = 0; op_index < (uint8_t)ops_found; op_index++) {
-                protocol_redis_reader_op_t *op = &ops[op_index];
+            if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN) {
+                // The reader context may already be processing the next command in the buffer so the amount of
+                // arguments has to be tracked in the connection context
+                connection_context->command.arguments_count = op->data.command.arguments_count;
+                continue;
+            } else if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END) {
+                // In cluster mode the commands operating on keys of slots not served by this node are refused
+                if (likely(!connection_context->command.skip) &&
+                    likely(module_redis_cluster_command_check(connection_context))) {
+                    module_redis_replication_command_execute_begin(connection_context);
+
+                    // After MULTI the commands are queued instead of being executed
+                    if (unlikely(module_redis_multi_is_queuing(connection_context))) {
+                        if (unlikely(!module_redis_multi_process_end(connection_context))) {
+                            goto end;
+                        }
+                    } else if (unlikely(!module_redis_command_process_end(connection_context))) {
+                        goto end;
+                    }
+                }
 
-                read_buffer->data_offset += op->data_read_len;
-                read_buffer->data_size -= op->data_read_len;
-                connection_context->command.data_length += op->data_read_len;
+                if (unlikely(module_redis_connection_has_error(connection_context))) {
+                    // An error while queueing a command aborts the transaction, EXEC will report it
+                    if (unlikely(module_redis_multi_is_queuing(connection_context))) {
+                        module_redis_multi_command_failed(connection_context);
+                    }
 
-                if (unlikely(module_redis_connection_command_too_long(connection_context))) {
-                    module_redis_connection_error_message_printf_critical(
-                            connection_context,
-                            "ERR the command length has exceeded '%u' bytes",
-                            connection_context->network_channel->module_config->redis->max_command_length);
-                    break;
+                    if (!module_redis_connection_send_error(connection_context)) {
+                        module_redis_replication_command_end(connection_context);
+                        goto end;
+                    }
                 }
 
-                // protocol_redis_reader_read will at best parse one command till the end therefore ops will never
-                // contain data from other commands, therefore it's not necessary to check for COMMAND_END in the
-                // ops to reset the status of the connection_context.
-                // If the function changes the behaviour and will support parsing multiple commands then will be
-                // essential to properly handle the COMMAND_END op to reset the protocol context
-                if (connection_context->command.skip) {
-                    // The for loop can't be interrupted, has to continue till the end, read_buffer->data_* have to be
-                    // updated and the max command length has to be checked
-                    continue;
+                // The write commands are appended to the replication backlog only once they have been executed
+                module_redis_replication_command_end(connection_context);
+
+                if (unlikely(module_redis_connection_should_terminate_connection(connection_context))) {
+                    module_redis_connection_flush_and_close(connection_context);
+                    goto end;
                 }
 
-                if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA && op->data.argument.index == 0) {
-                    bool last_op = op_index == (uint8_t) ops_found - 1;
-                    bool op_followed_by_argument_end =
-                            !last_op && (ops[op_index + 1].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END);
+                // The reader context is not reset, protocol_redis_reader_read_batch takes care of it when it starts
+                // to parse the next command
+                module_redis_command_process_try_free(connection_context);
+                module_redis_connection_context_reset_command(connection_context);
+                continue;
+            }
 
-                    if (unlikely(last_op || !op_followed_by_argument_end)) {
-                        // Set the reader_context state back to PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA and reset
-                        // the current argument received_length
-                        connection_context->reader_context.state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA;
-                        connection_context->reader_context.arguments.current.received_length = 0;
+            if (connection_context->command.skip) {
+                // The for loop can't be interrupted, has to continue till the end, read_buffer->data_* have to be
+                // updated and the max command length has to be checked
+                continue;
+            }
 
-                        // Roll back the buffer
-                        read_buffer->data_offset -= op->data_read_len;
-                        read_buffer->data_size += op->data_read_len;
+            if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA && op->data.argument.index == 0) {
+                bool last_op = op_index == (uint8_t) ops_found - 1;
+                bool op_followed_by_argument_end =
+                        !last_op && (ops[op_index + 1].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END);
+
+                if (unlikely(last_op || !op_followed_by_argument_end)) {
+                    // Set the reader_context state back to PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA and reset
+                    // the current argument received_length, the op is always the last one so the reader_context is
+                    // still processing this argument
+                    connection_context->reader_context.state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA;
+                    connection_context->reader_context.arguments.current.received_length = 0;
+
+                    // Roll back the buffer
+                    read_buffer->data_offset -= op->data_read_len;
+                    read_buffer->data_size += op->data_read_len;
+
+                    // No need to continue the parsing, more data are needed
+                    return_result = true;
+                    goto end;
+                }
 
-                        // No need to continue the parsing, more data are needed
-                        return_result = true;
-                        goto end;
-                    }
+                connection_context->current_argument_token_data_offset = op->data.argument.offset;
+            } else if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END && op->data.argument.index == 0) {
+                // If the end of the first argument has been found then check if it's a known command
+                size_t command_length = op->data.argument.length;
+                char *command_data = read_buffer_data_start + connection_context->current_argument_token_data_offset;
 
-                    connection_context->current_argument_token_data_offset = op->data.argument.offset;
-                } else if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END && op->data.argument.index == 0) {
-                    // If the end of the first argument has been found then check if it's a known command
-                    size_t command_length = op->data.argument.length;
-                    char *command_data = read_buffer_data_start + connection_context->current_argument_token_data_offset;
+                // Set the current command to UNKNOWN
+                connection_context->command.info = hashtable_spsc_op_get_ci(
+                        module_redis_commands_hashtable,
+                        command_data,
+                        command_length);
 
-                    // Set the current command to UNKNOWN
-                    connection_context->command.info = hashtable_spsc_op_get_ci(
-                            module_redis_commands_hashtable,
+                if (!connection_context->command.info) {
+                    module_redis_connection_error_message_printf_noncritical(
+                            connection_context,
+                            "ERR unknown command `%.*s` with `%d` args",
+                            (int)command_length,
                             command_data,
-                            command_length);
+                            connection_context->command.arguments_count - 1);
+                    continue;
+                }
 
-                    if (!connection_context->command.info) {
-                        module_redis_connection_error_message_printf_noncritical(
-                                connection_context,
-                                "ERR unknown command `%.*s` with `%d` args",
-                                (int)command_length,
-                                command_data,
-                                connection_context->reader_context.arguments.count - 1);
-                        continue;
-                    }
+                LOG_D(
+                        TAG,
+                        "[RECV][REDIS] <%s> command received",
+                        connection_context->command.info->string);
 
-                    LOG_D(
-                            TAG,
-                            "[RECV][REDIS] <%s> command received",
+                // Check if the command has been found and if the required arguments are going to be provided else
+                if (unlikely(connection_context->command.info->required_arguments_count >
+                    connection_context->command.arguments_count - 1)) {
+                    module_redis_connection_error_message_printf_noncritical(
+                            connection_context,
+                            "ERR wrong number of arguments for '%s' command",
                             connection_context->command.info->string);
+                    continue;
+                } else if (unlikely(connection_context->command.arguments_count - 1 >
+                        connection_context->network_channel->module_config->redis->max_command_arguments)) {
+                    module_redis_connection_error_message_printf_noncritical(
+                            connection_context,
+                            "ERR command '%s' has '%u' arguments but only '%u' allowed",
+                            connection_context->command.info->string,
+                            connection_context->command.arguments_count - 1,
+                            connection_context->network_channel->module_config->redis->max_command_arguments);
+                    continue;
+                }
 
-                    // Check if the command has been found and if the required arguments are going to be provided else
-                    if (unlikely(connection_context->command.info->required_arguments_count >
-                        connection_context->reader_context.arguments.count - 1)) {
-                        module_redis_connection_error_message_printf_noncritical(
-                                connection_context,
-                                "ERR wrong number of arguments for '%s' command",
-                                connection_context->command.info->string);
-                        continue;
-                    } else if (unlikely(connection_context->reader_context.arguments.count - 1 >
-                            connection_context->network_channel->module_config->redis->max_command_arguments)) {
-                        module_redis_connection_error_message_printf_noncritical(
-                                connection_context,
-                                "ERR command '%s' has '%u' arguments but only '%u' allowed",
-                                connection_context->command.info->string,
-                                connection_context->reader_context.arguments.count - 1,
-                                connection_context->network_channel->module_config->redis->max_command_arguments);
-                        continue;
-                    }
+                // In RESP2 a connection subscribed to channels or patterns can only issue the pub/sub commands
+                if (unlikely(!module_redis_process_data_is_command_allowed_in_pubsub(connection_context))) {
+                    module_redis_connection_error_message_printf_noncritical(
+                            connection_context,
+                            "ERR Can't execute '%s': only (P|S)SUBSCRIBE / (P|S)UNSUBSCRIBE / PING / QUIT / RESET are "
+                            "allowed in this context",
+                            connection_context->command.info->string);
+                    continue;
+                }
 
-                    // Invoke the being function callback if it has been set
-                    if (unlikely(!module_redis_command_process_begin(connection_context))) {
-                        LOG_D(TAG, "[RECV][REDIS] Unable to allocate the command context, terminating connection");
+                // While the append only file is being loaded only the connection applying it can execute commands
+                if (unlikely(module_redis_aof_is_loading(connection_context))) {
+                    module_redis_connection_error_message_printf_noncritical(
+                            connection_context,
+                            "LOADING cachegrand is loading the dataset in memory");
+                    continue;
+                }
+
+                // The replicas refuse the write commands and, once a replica is synchronizing, the write commands are
+                // staged to be appended to the replication backlog
+                if (unlikely(!module_redis_replication_command_begin(connection_context))) {
+                    if (unlikely(module_redis_connection_should_terminate_connection(connection_context))) {
                         goto end;
                     }
 
-                    // If a command has been identified it's possible to move to the next op
                     continue;
                 }
 
-                bool is_argument_op =
-                        op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN ||
-                        op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA ||
-                        op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END;
+                // Invoke the being function callback if it has been set
+                if (unlikely(!module_redis_command_process_begin(connection_context))) {
+                    LOG_D(TAG, "[RECV][REDIS] Unable to allocate the command context, terminating connection");
+                    goto end;
+                }
+
+                // If a command has been identified it's possible to move to the next op
+                continue;
+            }
 
-                if (is_argument_op && op->data.argument.index > 0) {
-                    if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN) {
-                        if (unlikely(!module_redis_command_process_argument_begin(
+            bool is_argument_op =
+                    op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN ||
+                    op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA ||
+                    op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END;
+
+            if (is_argument_op && op->data.argument.index > 0) {
+                if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN) {
+                    if (unlikely(module_redis_replication_is_staging(connection_context) &&
+                        !module_redis_replication_stage_argument_begin(
                                 connection_context,
                                 op->data.argument.length))) {
-                            goto end;
-                        }
-                    } else {
-                        bool require_stream = module_redis_command_process_argument_require_stream(
-                                connection_context);
+                        goto end;
+                    }
+
+                    if (unlikely(!module_redis_command_process_argument_begin(
+                            connection_context,
+                            op->data.argument.length))) {
+                        goto end;
+                    }
+                } else {
+                    bool require_stream = module_redis_command_process_argument_require_stream(
+                            connection_context);
 
-                        if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA) {
-                            if (require_stream) {
-                                size_t chunk_length = op->data.argument.data_length;
-                                char *chunk_data = read_buffer_data_start + op->data.argument.offset;
+                    if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA) {
+                        if (require_stream) {
+                            size_t chunk_length = op->data.argument.data_length;
+                            char *chunk_data = read_buffer_data_start + op->data.argument.offset;
 
-                                if (unlikely(!module_redis_command_process_argument_stream_data(
+                            if (unlikely(module_redis_replication_is_staging(connection_context) &&
+                                !module_redis_replication_stage_argument_data(
                                         connection_context,
                                         chunk_data,
                                         chunk_length))) {
-                                    goto end;
-                                }
-                            } else {
-                                // If the require_stream flag is false, the argument_full callback will be called once all the data
-                                // have been processed but to ensure that if the buffer gets rewind these data will not be lost
-                                // the buffer pointer is moved back as well if there isn't another op or if op_index + 1 isn't an
-                                // argument-end op.
-                                bool last_op = op_index == (uint8_t) ops_found - 1;
-                                bool op_followed_by_argument_end =
-                                        !last_op &&
-                                        (ops[op_index + 1].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END);
-
-                                if (unlikely(last_op || !op_followed_by_argument_end)) {
-                                    // Set the reader_context state back to PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA and reset
-                                    // the current argument received_length
-                                    connection_context->reader_context.state =
-                                            PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA;
-                                    connection_context->reader_context.arguments.current.received_length = 0;
-
-                                    // Roll back the buffer
-                                    read_buffer->data_offset -= op->data_read_len;
-                                    read_buffer->data_size += op->data_read_len;
-
-                                    // No need to continue the parsing, more data are needed
-                                    return_result = true;
-                                    goto end;
-                                }
-
-                                connection_context->current_argument_token_data_offset = op->data.argument.offset;
+                                goto end;
+                            }
+
+                            if (unlikely(!module_redis_command_process_argument_stream_data(
+                                    connection_context,
+                                    chunk_data,
+                                    chunk_length))) {
+                                goto end;
+                            }
+                        } else {
+                            // If the require_stream flag is false, the argument_full callback will be called once all the data
+                            // have been processed but to ensure that if the buffer gets rewind these data will not be lost
+                            // the buffer pointer is moved back as well if there isn't another op or if op_index + 1 isn't an
+                            // argument-end op.
+                            bool last_op = op_index == (uint8_t) ops_found - 1;
+                            bool op_followed_by_argument_end =
+                                    !last_op &&
+                                    (ops[op_index + 1].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END);
+
+                            if (unlikely(last_op || !op_followed_by_argument_end)) {
+                                // Set the reader_context state back to PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA and reset
+                                // the current argument received_length
+                                connection_context->reader_context.state =
+                                        PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA;
+                                connection_context->reader_context.arguments.current.received_length = 0;
+
+                                // Roll back the buffer
+                                read_buffer->data_offset -= op->data_read_len;
+                                read_buffer->data_size += op->data_read_len;
+
+                                // No need to continue the parsing, more data are needed
+                                return_result = true;
+                                goto end;
+                            }
+
+                            connection_context->current_argument_token_data_offset = op->data.argument.offset;
+                        }
+                    } else if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END) {
+                        if (require_stream) {
+                            if (unlikely(!module_redis_command_process_argument_stream_end(connection_context))) {
+                                goto end;
                             }
-                        } else if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END) {
-                            if (require_stream) {
-                                if (unlikely(!module_redis_command_process_argument_stream_end(connection_context))) {
-                                    goto end;
-                                }
-                            } else {
-                                size_t chunk_length = op->data.argument.length;
-                                char *chunk_data =
-                                        read_buffer_data_start + connection_context->current_argument_token_data_offset;
-
-                                if (unlikely(!module_redis_command_process_argument_full(
+                        } else {
+                            size_t chunk_length = op->data.argument.length;
+                            char *chunk_data =
+                                    read_buffer_data_start + connection_context->current_argument_token_data_offset;
+
+                            if (unlikely(module_redis_replication_is_staging(connection_context) &&
+                                !module_redis_replication_stage_argument_data(
                                         connection_context,
                                         chunk_data,
                                         chunk_length))) {
-                                    goto end;
-                                }
+                                goto end;
                             }
 
-                            if (unlikely(!module_redis_command_process_argument_end(connection_context))) {
+                            if (unlikely(!module_redis_command_process_argument_full(
+                                    connection_context,
+                                    chunk_data,
+                                    chunk_length))) {
                                 goto end;
                             }
                         }
-                    }
-                } else if (op->type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END) {
-                    if (unlikely(!module_redis_command_process_end(connection_context))) {
-                        goto end;
+
+                        if (unlikely(module_redis_replication_is_staging(connection_context) &&
+                            !module_redis_replication_stage_argument_end(connection_context))) {
+                            goto end;
+                        }
+
+                        if (unlikely(!module_redis_command_process_argument_end(connection_context))) {
+                            goto end;
+                        }
                     }
                 }
             }
         }
-        while (
-                read_buffer->data_size > 0 &&
-                connection_context->reader_context.state != PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED &&
-                connection_context->reader_context.error != PROTOCOL_REDIS_READER_ERROR_OK);
-
-        if (unlikely(module_redis_connection_has_error(connection_context))) {
-            if (!module_redis_connection_send_error(connection_context)) {
-                goto end;
-            }
-        }
 
+        // The errors reported by the reader or the max command length check are critical and the connection has to be
+        // closed without waiting for the end of the command
         if (unlikely(module_redis_connection_should_terminate_connection(connection_context))) {
+            if (module_redis_connection_has_error(connection_context)) {
+                if (!module_redis_connection_send_error(connection_context)) {
+                    goto end;
+                }
+            }
+
             module_redis_connection_flush_and_close(connection_context);
             goto end;
         }
-
-        if (connection_context->reader_context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED) {
-            module_redis_command_process_try_free(connection_context);
-            module_redis_connection_context_reset(connection_context);
-        }
     } while(read_buffer->data_size > 0 && ops_found > 0);
 
     return_result = true;
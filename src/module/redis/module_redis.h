@@ -40,7 +40,7 @@ extern "C" {
         command_free, \
         MODULE_REDIS_COMMAND_FUNCPTR_ARGUMENTS_COMMAND_FREE)
 
-#define MODULE_REDIS_COMMAND_AUTOGEN(ID, COMMAND, COMMAND_FUNC_PTR, REQUIRED_ARGS_COUNT, HAS_VARIABLE_ARGUMENTS, ARGS_COUNT) \
+#define MODULE_REDIS_COMMAND_AUTOGEN(ID, COMMAND, COMMAND_FUNC_PTR, REQUIRED_ARGS_COUNT, HAS_VARIABLE_ARGUMENTS, ARGS_COUNT, IS_WRITE) \
     { \
         .command = MODULE_REDIS_COMMAND_##ID, \
         .string = (COMMAND), \
@@ -52,10 +52,11 @@ extern "C" {
         .command_free_funcptr = MODULE_REDIS_COMMAND_FUNCPTR_NAME_AUTOGEN(COMMAND_FUNC_PTR, command_free), \
         .required_arguments_count = (REQUIRED_ARGS_COUNT), \
         .has_variable_arguments = (HAS_VARIABLE_ARGUMENTS), \
+        .is_write = (IS_WRITE), \
         .tokens_hashtable = NULL, \
     }
 
-#define MODULE_REDIS_COMMAND(ID, COMMAND, COMMAND_FUNC_PTR, REQUIRED_ARGS_COUNT, HAS_VARIABLE_ARGUMENTS, ARGS_COUNT) \
+#define MODULE_REDIS_COMMAND(ID, COMMAND, COMMAND_FUNC_PTR, REQUIRED_ARGS_COUNT, HAS_VARIABLE_ARGUMENTS, ARGS_COUNT, IS_WRITE) \
     { \
         .command = MODULE_REDIS_COMMAND_##ID, \
         .string = (COMMAND), \
@@ -67,15 +68,22 @@ extern "C" {
         .command_free_funcptr = MODULE_REDIS_COMMAND_FUNCPTR_NAME(COMMAND_FUNC_PTR, command_free), \
         .required_arguments_count = (REQUIRED_ARGS_COUNT), \
         .has_variable_arguments = (HAS_VARIABLE_ARGUMENTS), \
+        .is_write = (IS_WRITE), \
         .tokens_hashtable = NULL, \
     }
 
+#define MODULE_REDIS_ERROR_WRONGTYPE \
+    "WRONGTYPE Operation against a key holding the wrong kind of value"
+
 typedef void module_redis_command_context_t;
 typedef bool module_redis_command_funcptr_retval_t;
 
 // This typedef is needed before the declaration of the function pointers as it's used in there
 // the entire struct can't be moved because of the dependencies
 typedef struct module_redis_connection_context module_redis_connection_context_t;
+typedef struct module_redis_pubsub_client module_redis_pubsub_client_t;
+typedef struct module_redis_multi module_redis_multi_t;
+typedef struct module_redis_replication_client module_redis_replication_client_t;
 
 typedef module_redis_command_funcptr_retval_t (module_redis_command_end_funcptr_t)(
         MODULE_REDIS_COMMAND_FUNCPTR_ARGUMENTS_COMMAND_END);
@@ -153,6 +161,7 @@ struct module_redis_command_info {
     uint16_t arguments_count;
     uint8_t required_arguments_count;
     bool has_variable_arguments;
+    bool is_write;
     module_redis_command_argument_t *arguments;
     module_redis_command_end_funcptr_t *command_end_funcptr;
     module_redis_command_free_funcptr_t *command_free_funcptr;
@@ -189,11 +198,16 @@ struct module_redis_connection_context {
     storage_db_t *db;
     size_t current_argument_token_data_offset;
     bool terminate_connection;
+    module_redis_pubsub_client_t *pubsub_client;
+    module_redis_multi_t *multi;
+    module_redis_replication_client_t *replication;
+    bool cluster_asking;
     struct {
         char *message;
     } error;
     struct {
         size_t data_length;
+        uint32_t arguments_count;
         module_redis_command_info_t *info;
         module_redis_command_context_t *context;
         module_redis_command_parser_context_t parser_context;
@@ -203,6 +217,8 @@ struct module_redis_connection_context {
 
 #include "module_redis_autogenerated_commands_contexts.h"
 
+extern hashtable_spsc_t *module_redis_commands_hashtable;
+
 void module_redis_accept(
         network_channel_t *channel);
 
@@ -0,0 +1,1111 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "fatal.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "clock.h"
+#include "config.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/storage.h"
+#include "storage/db/storage_db.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/module_redis_multi.h"
+#include "module/redis/module_redis_replication.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+
+#include "module_redis_aof.h"
+
+#define TAG "module_redis_aof"
+
+module_redis_aof_registry_t module_redis_aof_registry = { 0 };
+static thread_local module_redis_aof_worker_t *module_redis_aof_worker = NULL;
+
+static char *module_redis_aof_build_path(
+        char *path_template,
+        ...) {
+    va_list args;
+    char *path;
+    int required_length;
+
+    va_start(args, path_template);
+    required_length = vsnprintf(NULL, 0, path_template, args);
+    va_end(args);
+
+    path = ffma_mem_alloc(required_length + 1);
+
+    va_start(args, path_template);
+    vsnprintf(path, required_length + 1, path_template, args);
+    va_end(args);
+
+    return path;
+}
+
+static char *module_redis_aof_build_segment_path(
+        uint32_t generation,
+        uint32_t worker_index) {
+    return module_redis_aof_build_path(
+            "%s/" MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "%u.%u",
+            module_redis_aof_registry.config->path,
+            generation,
+            worker_index);
+}
+
+static bool module_redis_aof_sync_directory() {
+    bool result_res;
+    storage_channel_t *channel = storage_open(
+            module_redis_aof_registry.config->path,
+            O_RDONLY | O_DIRECTORY,
+            0);
+
+    if (unlikely(channel == NULL)) {
+        return false;
+    }
+
+    // The renames and the creation of the files are durable only once the directory has been synced
+    result_res = storage_flush(channel);
+    storage_close(channel);
+
+    return result_res;
+}
+
+static bool module_redis_aof_buffer_reserve(
+        module_redis_aof_worker_t *worker,
+        size_t length) {
+    if (likely(worker->buffer_length + length <= worker->buffer_size)) {
+        return true;
+    }
+
+    size_t buffer_size_new = MAX(worker->buffer_size, MODULE_REDIS_AOF_BUFFER_MIN_SIZE);
+    while(buffer_size_new < worker->buffer_length + length) {
+        buffer_size_new *= 2;
+    }
+
+    worker->buffer = module_redis_command_helper_buffer_realloc(
+            worker->buffer,
+            worker->buffer_size,
+            buffer_size_new,
+            false);
+    if (unlikely(worker->buffer == NULL)) {
+        worker->buffer_length = worker->buffer_size = 0;
+        return false;
+    }
+
+    worker->buffer_size = buffer_size_new;
+
+    return true;
+}
+
+static void module_redis_aof_segment_close(
+        module_redis_aof_worker_t *worker) {
+    module_redis_aof_closed_segment_t *closed_segment;
+    double_linked_list_item_t *item;
+
+    if (unlikely(!storage_flush(worker->segment))) {
+        LOG_W(TAG, "Unable to sync the append only file segment <%s>", worker->segment_path);
+    }
+
+    storage_close(worker->segment);
+    worker->segment = NULL;
+
+    // The segment is kept till a base containing all its records has been written
+    closed_segment = ffma_mem_alloc(sizeof(module_redis_aof_closed_segment_t));
+    closed_segment->path = worker->segment_path;
+    closed_segment->max_sequence = worker->segment_max_sequence;
+
+    item = double_linked_list_item_init();
+    item->data = closed_segment;
+    double_linked_list_push_item(worker->closed_segments, item);
+
+    worker->segment_path = NULL;
+}
+
+static bool module_redis_aof_segment_open(
+        module_redis_aof_worker_t *worker,
+        uint32_t generation) {
+    char *path = module_redis_aof_build_segment_path(generation, worker->worker_index);
+
+    worker->segment = storage_open(
+            path,
+            O_CREAT | O_WRONLY | O_TRUNC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+    if (unlikely(worker->segment == NULL)) {
+        ffma_mem_free(path);
+        return false;
+    }
+
+    worker->segment_path = path;
+    worker->segment_offset = 0;
+    worker->segment_max_sequence = 0;
+    worker->generation = generation;
+
+    return true;
+}
+
+static void module_redis_aof_segments_delete_obsolete(
+        module_redis_aof_worker_t *worker) {
+    uint64_t base_sequence = __atomic_load_n(&module_redis_aof_registry.base_sequence, __ATOMIC_ACQUIRE);
+    double_linked_list_item_t *item = worker->closed_segments->head;
+
+    while(item != NULL) {
+        double_linked_list_item_t *next_item = item->next;
+        module_redis_aof_closed_segment_t *closed_segment = item->data;
+
+        if (closed_segment->max_sequence <= base_sequence) {
+            if (unlink(closed_segment->path) != 0 && errno != ENOENT) {
+                LOG_W(TAG, "Unable to delete the append only file segment <%s>", closed_segment->path);
+                LOG_E_OS_ERROR(TAG);
+            }
+
+            double_linked_list_remove_item(worker->closed_segments, item);
+            double_linked_list_item_free(item);
+            ffma_mem_free(closed_segment->path);
+            ffma_mem_free(closed_segment);
+        }
+
+        item = next_item;
+    }
+}
+
+static bool module_redis_aof_flush(
+        module_redis_aof_worker_t *worker,
+        bool fsync) {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    bool result_res = false;
+    char *buffer = worker->buffer;
+    size_t buffer_length = worker->buffer_length;
+    size_t buffer_size = worker->buffer_size;
+    uint64_t buffer_max_sequence = worker->buffer_max_sequence;
+    uint64_t appended_length = worker->appended_length;
+    uint32_t generation = __atomic_load_n(&registry->generation, __ATOMIC_ACQUIRE);
+
+    worker->flushing = true;
+
+    // The buffers are swapped so the fibers can keep appending while the data are being written
+    worker->buffer = worker->flush_buffer;
+    worker->buffer_size = worker->flush_buffer_size;
+    worker->buffer_length = 0;
+    worker->flush_buffer = buffer;
+    worker->flush_buffer_size = buffer_size;
+
+    // A rewrite has been started, the segment is switched to the new generation
+    if (worker->segment != NULL && worker->generation != generation) {
+        module_redis_aof_segment_close(worker);
+    }
+
+    if (buffer_length > 0) {
+        if (worker->segment == NULL && unlikely(!module_redis_aof_segment_open(worker, generation))) {
+            goto end;
+        }
+
+        if (unlikely(!storage_write(worker->segment, buffer, buffer_length, worker->segment_offset))) {
+            goto end;
+        }
+
+        if (fsync && unlikely(!storage_flush(worker->segment))) {
+            goto end;
+        }
+
+        worker->segment_offset += (off_t)buffer_length;
+        worker->segment_max_sequence = buffer_max_sequence;
+        __atomic_add_fetch(&registry->segments_size, buffer_length, __ATOMIC_RELAXED);
+    }
+
+    result_res = true;
+
+end:
+    if (unlikely(!result_res)) {
+        LOG_E(TAG, "Unable to write <%lu> bytes to the append only file, the data are lost", buffer_length);
+    }
+
+    // The length is updated also on failure, the fibers waiting for the data to be synced would wait forever otherwise
+    worker->written_length = appended_length;
+    worker->flushing = false;
+
+    module_redis_aof_segments_delete_obsolete(worker);
+
+    return result_res;
+}
+
+static void module_redis_aof_wait_synced(
+        module_redis_aof_worker_t *worker,
+        uint64_t length) {
+    // The first fiber waiting writes and syncs the records of all the fibers that have appended data meanwhile, the
+    // others wait for the flush in progress to complete and flush again only if their records weren't included
+    while(worker->written_length < length) {
+        if (!worker->flushing) {
+            module_redis_aof_flush(worker, true);
+        } else if (!worker_op_timer(0, MODULE_REDIS_AOF_BUSY_WAIT_NS)) {
+            break;
+        }
+    }
+}
+
+void module_redis_aof_append(
+        char *data,
+        size_t data_length) {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    module_redis_aof_worker_t *worker = module_redis_aof_worker;
+    module_redis_aof_record_header_t record_header;
+
+    if (likely(worker == NULL)) {
+        return;
+    }
+
+    if (unlikely(!module_redis_aof_buffer_reserve(worker, sizeof(record_header) + data_length))) {
+        LOG_E(TAG, "Unable to allocate the memory to append the command to the append only file");
+        return;
+    }
+
+    // The sequence is taken when the command has already been executed, a command depending on the changes made by
+    // another one, regardless of the worker, always gets a greater sequence
+    record_header.sequence = __atomic_add_fetch(&registry->sequence, 1, __ATOMIC_ACQ_REL);
+    record_header.length = (uint32_t)data_length;
+
+    memcpy(worker->buffer + worker->buffer_length, &record_header, sizeof(record_header));
+    memcpy(worker->buffer + worker->buffer_length + sizeof(record_header), data, data_length);
+    worker->buffer_length += sizeof(record_header) + data_length;
+    worker->buffer_max_sequence = record_header.sequence;
+    worker->appended_length += sizeof(record_header) + data_length;
+
+    if (registry->config->fsync == CONFIG_DATABASE_AOF_FSYNC_ALWAYS) {
+        module_redis_aof_wait_synced(worker, worker->appended_length);
+    }
+}
+
+static void module_redis_aof_rewrite_quiesced(
+        void *user_data) {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    module_redis_aof_base_header_t *base_header = user_data;
+
+    // All the commands with a sequence lower or equal than the one recorded are part of the snapshot, the ones appended
+    // from now on are written to the segments of the new generation
+    base_header->sequence = __atomic_load_n(&registry->sequence, __ATOMIC_ACQUIRE);
+    base_header->generation = __atomic_add_fetch(&registry->generation, 1, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&registry->segments_size, 0, __ATOMIC_RELEASE);
+}
+
+static bool module_redis_aof_base_write(
+        void *user_data,
+        char *data,
+        size_t data_length) {
+    module_redis_aof_base_writer_t *base_writer = user_data;
+
+    if (unlikely(!storage_write(base_writer->channel, data, data_length, base_writer->offset))) {
+        return false;
+    }
+
+    base_writer->offset += (off_t)data_length;
+
+    return true;
+}
+
+static bool module_redis_aof_rewrite(
+        storage_db_t *db) {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    bool result_res = false;
+    bool snapshot_taken = false;
+    uint64_t entries_count = 0;
+    module_redis_aof_base_header_t base_header = { 0 };
+    module_redis_aof_base_writer_t base_writer = { 0 };
+    char *base_path = module_redis_aof_build_path(
+            "%s/" MODULE_REDIS_AOF_BASE_FILENAME,
+            registry->config->path);
+    char *base_temp_path = module_redis_aof_build_path(
+            "%s/" MODULE_REDIS_AOF_BASE_TEMP_FILENAME,
+            registry->config->path);
+
+    LOG_I(TAG, "Rewriting the append only file");
+
+    if (unlikely(!module_redis_replication_snapshot_take(
+            db,
+            module_redis_aof_rewrite_quiesced,
+            &base_header))) {
+        goto end;
+    }
+    snapshot_taken = true;
+
+    base_writer.channel = storage_open(
+            base_temp_path,
+            O_CREAT | O_WRONLY | O_TRUNC,
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+    if (unlikely(base_writer.channel == NULL)) {
+        goto end;
+    }
+
+    memcpy(base_header.magic, MODULE_REDIS_AOF_BASE_MAGIC, sizeof(base_header.magic));
+    if (unlikely(!module_redis_aof_base_write(&base_writer, (char*)&base_header, sizeof(base_header)))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_replication_snapshot_serialize(
+            db,
+            module_redis_aof_base_write,
+            &base_writer,
+            &entries_count))) {
+        goto end;
+    }
+
+    module_redis_replication_snapshot_end(db);
+    snapshot_taken = false;
+
+    if (unlikely(!storage_flush(base_writer.channel))) {
+        goto end;
+    }
+
+    storage_close(base_writer.channel);
+    base_writer.channel = NULL;
+
+    if (unlikely(rename(base_temp_path, base_path) != 0)) {
+        LOG_E(TAG, "Unable to rename <%s> to <%s>", base_temp_path, base_path);
+        LOG_E_OS_ERROR(TAG);
+        goto end;
+    }
+
+    if (unlikely(!module_redis_aof_sync_directory())) {
+        goto end;
+    }
+
+    // Once the base is durable the segments containing only older records can be deleted, each worker deletes its own
+    // segments at the next flush
+    __atomic_store_n(&registry->base_size, base_writer.offset, __ATOMIC_RELEASE);
+    __atomic_store_n(&registry->base_sequence, base_header.sequence, __ATOMIC_RELEASE);
+
+    LOG_I(TAG, "Append only file rewritten, <%lu> keys saved", entries_count);
+
+    result_res = true;
+
+end:
+    if (unlikely(!result_res)) {
+        LOG_E(TAG, "Failed to rewrite the append only file");
+    }
+
+    if (base_writer.channel) {
+        storage_close(base_writer.channel);
+        unlink(base_temp_path);
+    }
+
+    if (snapshot_taken) {
+        module_redis_replication_snapshot_end(db);
+    }
+
+    ffma_mem_free(base_path);
+    ffma_mem_free(base_temp_path);
+
+    return result_res;
+}
+
+static void module_redis_aof_rewrite_fiber_entrypoint(
+        void *user_data) {
+    module_redis_aof_rewrite(user_data);
+
+    __atomic_store_n(&module_redis_aof_registry.rewrite_running, false, __ATOMIC_RELEASE);
+
+    fiber_scheduler_terminate_current_fiber();
+}
+
+bool module_redis_aof_is_enabled() {
+    return module_redis_aof_worker != NULL;
+}
+
+bool module_redis_aof_rewrite_start(
+        storage_db_t *db) {
+    if (!__sync_bool_compare_and_swap(&module_redis_aof_registry.rewrite_running, false, true)) {
+        return false;
+    }
+
+    fiber_scheduler_new_fiber(
+            "worker-redis-aof-rewrite",
+            strlen("worker-redis-aof-rewrite"),
+            module_redis_aof_rewrite_fiber_entrypoint,
+            db);
+
+    return true;
+}
+
+static void module_redis_aof_rewrite_start_if_needed(
+        storage_db_t *db) {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    uint64_t segments_size = __atomic_load_n(&registry->segments_size, __ATOMIC_ACQUIRE);
+    uint64_t base_size = __atomic_load_n(&registry->base_size, __ATOMIC_ACQUIRE);
+
+    if (registry->config->rewrite_percentage == 0 ||
+        registry->loading ||
+        registry->rewrite_running) {
+        return;
+    }
+
+    // The segments contain only the records appended after the last rewrite, therefore their size is the growth of
+    // the append only file
+    if (segments_size < (uint64_t)registry->config->rewrite_min_size_mb * 1024 * 1024 ||
+        segments_size * 100 < base_size * registry->config->rewrite_percentage) {
+        return;
+    }
+
+    module_redis_aof_rewrite_start(db);
+}
+
+static void module_redis_aof_flush_fiber_entrypoint(
+        void *user_data) {
+    module_redis_aof_worker_t *worker = user_data;
+    worker_context_t *worker_context = worker_context_get();
+    bool fsync = module_redis_aof_registry.config->fsync != CONFIG_DATABASE_AOF_FSYNC_NO;
+
+    while(worker_op_timer(0, MODULE_REDIS_AOF_FLUSH_INTERVAL_NS)) {
+        if (!worker->flushing) {
+            module_redis_aof_flush(worker, fsync);
+        }
+
+        module_redis_aof_rewrite_start_if_needed(worker_context->db);
+    }
+
+    fiber_scheduler_terminate_current_fiber();
+}
+
+static bool module_redis_aof_load_feed(
+        module_redis_aof_loader_t *loader,
+        char *data,
+        size_t data_length) {
+    network_channel_buffer_t *read_buffer = &loader->connection_context.read_buffer;
+
+    // The data are fed to the parser as if they were received from the network
+    while(data_length > 0) {
+        if (unlikely(!network_buffer_has_enough_space(read_buffer, NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
+            LOG_E(TAG, "The append only file contains a command too long to be loaded");
+            return false;
+        }
+
+        if (unlikely(network_buffer_needs_rewind(read_buffer, NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
+            network_buffer_rewind(read_buffer);
+        }
+
+        size_t length = MIN(data_length, NETWORK_CHANNEL_MAX_PACKET_SIZE);
+        memcpy(read_buffer->data + read_buffer->data_offset + read_buffer->data_size, data, length);
+        read_buffer->data_size += length;
+        data += length;
+        data_length -= length;
+
+        if (unlikely(!module_redis_process_data(&loader->connection_context, read_buffer))) {
+            LOG_E(TAG, "Failed to apply the commands stored in the append only file");
+            return false;
+        }
+
+        network_channel_capture_reset(&loader->network_channel);
+    }
+
+    return true;
+}
+
+static bool module_redis_aof_load_base(
+        module_redis_aof_loader_t *loader,
+        char *path,
+        off_t file_size,
+        uint32_t *generation) {
+    bool result_res = false;
+    off_t file_offset;
+    module_redis_aof_base_header_t base_header;
+    char *buffer = NULL;
+    storage_channel_t *channel = NULL;
+
+    if (unlikely(file_size < (off_t)sizeof(base_header))) {
+        LOG_E(TAG, "The append only file base <%s> is truncated", path);
+        goto end;
+    }
+
+    if (unlikely((channel = storage_open(path, O_RDONLY, 0)) == NULL)) {
+        goto end;
+    }
+
+    if (unlikely(!storage_read(channel, (char*)&base_header, sizeof(base_header), 0))) {
+        goto end;
+    }
+
+    if (unlikely(memcmp(base_header.magic, MODULE_REDIS_AOF_BASE_MAGIC, sizeof(base_header.magic)) != 0)) {
+        LOG_E(TAG, "The append only file base <%s> is not valid", path);
+        goto end;
+    }
+
+    buffer = ffma_mem_alloc(MODULE_REDIS_AOF_READ_BUFFER_SIZE);
+    file_offset = sizeof(base_header);
+
+    while(file_offset < file_size) {
+        size_t length = MIN(file_size - file_offset, MODULE_REDIS_AOF_READ_BUFFER_SIZE);
+
+        if (unlikely(!storage_read(channel, buffer, length, file_offset))) {
+            goto end;
+        }
+
+        if (unlikely(!module_redis_aof_load_feed(loader, buffer, length))) {
+            goto end;
+        }
+
+        file_offset += (off_t)length;
+    }
+
+    loader->base_sequence = base_header.sequence;
+    *generation = base_header.generation;
+    result_res = true;
+
+end:
+    if (buffer) {
+        ffma_mem_free(buffer);
+    }
+
+    if (channel) {
+        storage_close(channel);
+    }
+
+    return result_res;
+}
+
+static bool module_redis_aof_segment_reader_fill(
+        module_redis_aof_segment_reader_t *reader) {
+    if (reader->buffer_offset < reader->buffer_length) {
+        return true;
+    }
+
+    if (reader->file_offset == reader->file_size) {
+        return false;
+    }
+
+    size_t length = MIN(reader->file_size - reader->file_offset, MODULE_REDIS_AOF_READ_BUFFER_SIZE);
+    if (unlikely(!storage_read(reader->channel, reader->buffer, length, reader->file_offset))) {
+        return false;
+    }
+
+    reader->file_offset += (off_t)length;
+    reader->buffer_offset = 0;
+    reader->buffer_length = length;
+
+    return true;
+}
+
+static bool module_redis_aof_segment_reader_next(
+        module_redis_aof_segment_reader_t *reader) {
+    size_t copied_length = 0;
+    char *record_header = (char*)&reader->record_header;
+
+    reader->has_record = false;
+
+    while(copied_length < sizeof(reader->record_header)) {
+        if (!module_redis_aof_segment_reader_fill(reader)) {
+            if (copied_length > 0) {
+                LOG_W(TAG, "The append only file segment <%s> is truncated", reader->path);
+            }
+
+            return false;
+        }
+
+        size_t length = MIN(
+                reader->buffer_length - reader->buffer_offset,
+                sizeof(reader->record_header) - copied_length);
+        memcpy(record_header + copied_length, reader->buffer + reader->buffer_offset, length);
+        reader->buffer_offset += length;
+        copied_length += length;
+    }
+
+    // A record is applied only if it has been written entirely, the last one might have been written only partially if
+    // cachegrand has been terminated while writing it
+    if (unlikely(reader->record_header.length >
+        (reader->buffer_length - reader->buffer_offset) + (reader->file_size - reader->file_offset))) {
+        LOG_W(TAG, "The append only file segment <%s> is truncated", reader->path);
+        return false;
+    }
+
+    reader->has_record = true;
+
+    return true;
+}
+
+static bool module_redis_aof_segment_reader_apply(
+        module_redis_aof_loader_t *loader,
+        module_redis_aof_segment_reader_t *reader) {
+    size_t remaining_length = reader->record_header.length;
+
+    // The records already included in the base are skipped
+    bool skip = reader->record_header.sequence <= loader->base_sequence;
+
+    while(remaining_length > 0) {
+        if (unlikely(!module_redis_aof_segment_reader_fill(reader))) {
+            return false;
+        }
+
+        size_t length = MIN(reader->buffer_length - reader->buffer_offset, remaining_length);
+        if (!skip && unlikely(!module_redis_aof_load_feed(loader, reader->buffer + reader->buffer_offset, length))) {
+            return false;
+        }
+
+        reader->buffer_offset += length;
+        remaining_length -= length;
+    }
+
+    if (!skip) {
+        loader->records_count++;
+    }
+
+    return true;
+}
+
+static bool module_redis_aof_load_segments(
+        module_redis_aof_loader_t *loader,
+        module_redis_aof_segment_reader_t *readers,
+        uint32_t readers_count,
+        uint64_t *max_sequence) {
+    for(uint32_t reader_index = 0; reader_index < readers_count; reader_index++) {
+        module_redis_aof_segment_reader_t *reader = &readers[reader_index];
+
+        reader->channel = storage_open(reader->path, O_RDONLY, 0);
+        if (unlikely(reader->channel == NULL)) {
+            return false;
+        }
+
+        reader->buffer = ffma_mem_alloc(MODULE_REDIS_AOF_READ_BUFFER_SIZE);
+        module_redis_aof_segment_reader_next(reader);
+    }
+
+    // The records of the segments are merged using their sequence, the segments are only a few so a linear search is
+    // enough to pick the next record
+    do {
+        module_redis_aof_segment_reader_t *next_reader = NULL;
+
+        for(uint32_t reader_index = 0; reader_index < readers_count; reader_index++) {
+            module_redis_aof_segment_reader_t *reader = &readers[reader_index];
+
+            if (reader->has_record &&
+                (next_reader == NULL || reader->record_header.sequence < next_reader->record_header.sequence)) {
+                next_reader = reader;
+            }
+        }
+
+        if (next_reader == NULL) {
+            break;
+        }
+
+        if (unlikely(!module_redis_aof_segment_reader_apply(loader, next_reader))) {
+            return false;
+        }
+
+        *max_sequence = MAX(*max_sequence, next_reader->record_header.sequence);
+        module_redis_aof_segment_reader_next(next_reader);
+    } while(true);
+
+    return true;
+}
+
+static bool module_redis_aof_load_scan_directory(
+        bool *base_found,
+        off_t *base_size,
+        module_redis_aof_segment_reader_t **readers,
+        uint32_t *readers_count,
+        uint32_t *max_generation) {
+    char *path = module_redis_aof_registry.config->path;
+    uint32_t readers_size = 0;
+    struct dirent *dir_entry;
+    struct stat file_stat;
+    DIR *dir;
+
+    if ((dir = opendir(path)) == NULL) {
+        LOG_E(TAG, "Unable to open the append only file directory <%s>", path);
+        LOG_E_OS_ERROR(TAG);
+        return false;
+    }
+
+    while((dir_entry = readdir(dir)) != NULL) {
+        int name_length = -1;
+        uint32_t generation, worker_index;
+        char *file_path = module_redis_aof_build_path("%s/%s", path, dir_entry->d_name);
+
+        if (strcmp(dir_entry->d_name, MODULE_REDIS_AOF_BASE_TEMP_FILENAME) == 0) {
+            // Leftover of a rewrite that hasn't been completed
+            unlink(file_path);
+            ffma_mem_free(file_path);
+            continue;
+        }
+
+        if (stat(file_path, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+            ffma_mem_free(file_path);
+            continue;
+        }
+
+        if (strcmp(dir_entry->d_name, MODULE_REDIS_AOF_BASE_FILENAME) == 0) {
+            *base_found = true;
+            *base_size = file_stat.st_size;
+            ffma_mem_free(file_path);
+            continue;
+        }
+
+        if (sscanf(
+                dir_entry->d_name,
+                MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "%u.%u%n",
+                &generation,
+                &worker_index,
+                &name_length) != 2 || name_length != (int)strlen(dir_entry->d_name)) {
+            ffma_mem_free(file_path);
+            continue;
+        }
+
+        if (*readers_count == readers_size) {
+            uint32_t readers_size_new = MAX(readers_size * 2, 16);
+            *readers = ffma_mem_realloc(
+                    *readers,
+                    sizeof(module_redis_aof_segment_reader_t) * readers_size,
+                    sizeof(module_redis_aof_segment_reader_t) * readers_size_new,
+                    true);
+            readers_size = readers_size_new;
+        }
+
+        module_redis_aof_segment_reader_t *reader = &(*readers)[*readers_count];
+        reader->path = file_path;
+        reader->generation = generation;
+        reader->file_size = file_stat.st_size;
+        (*readers_count)++;
+
+        *max_generation = MAX(*max_generation, generation);
+    }
+
+    closedir(dir);
+
+    return true;
+}
+
+static void module_redis_aof_load(
+        storage_db_t *db) {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    bool result_res = false;
+    bool base_found = false;
+    off_t base_size = 0;
+    uint32_t generation = 0;
+    uint64_t max_sequence = 0;
+    uint32_t readers_count = 0;
+    module_redis_aof_segment_reader_t *readers = NULL;
+    module_redis_aof_loader_t *loader = ffma_mem_alloc_zero(sizeof(module_redis_aof_loader_t));
+    char *base_path = module_redis_aof_build_path(
+            "%s/" MODULE_REDIS_AOF_BASE_FILENAME,
+            registry->config->path);
+
+    if (mkdir(registry->config->path, S_IRWXU | S_IRGRP | S_IXGRP) != 0 && errno != EEXIST) {
+        LOG_E(TAG, "Unable to create the append only file directory <%s>", registry->config->path);
+        LOG_E_OS_ERROR(TAG);
+        goto end;
+    }
+
+    if (!module_redis_aof_load_scan_directory(&base_found, &base_size, &readers, &readers_count, &generation)) {
+        goto end;
+    }
+
+    // The commands are applied as if they were sent by a client, the replies are captured and dropped, the connection
+    // is marked as a replication link to bypass the loading check
+    network_channel_init(NETWORK_CHANNEL_TYPE_CAPTURE, &loader->network_channel);
+    loader->network_channel.module_config = registry->module_config;
+
+    module_redis_connection_context_init(
+            &loader->connection_context,
+            db,
+            &loader->network_channel,
+            registry->module_config);
+    loader->connection_context.replication = ffma_mem_alloc_zero(sizeof(module_redis_replication_client_t));
+    loader->connection_context.replication->is_link = true;
+
+    if (base_found) {
+        uint32_t base_generation = 0;
+
+        LOG_I(TAG, "Loading the append only file base");
+        if (!module_redis_aof_load_base(loader, base_path, base_size, &base_generation)) {
+            goto end;
+        }
+
+        generation = MAX(generation, base_generation);
+        max_sequence = loader->base_sequence;
+        registry->base_sequence = loader->base_sequence;
+        registry->base_size = base_size;
+    }
+
+    if (readers_count > 0) {
+        LOG_I(TAG, "Loading <%u> append only file segments", readers_count);
+        if (!module_redis_aof_load_segments(loader, readers, readers_count, &max_sequence)) {
+            goto end;
+        }
+    }
+
+    LOG_I(TAG, "Append only file loaded, <%lu> commands applied from the segments", loader->records_count);
+
+    // The new segments get a generation never used before
+    registry->sequence = max_sequence;
+    registry->generation = generation + 1;
+
+    result_res = true;
+
+end:
+    module_redis_command_process_try_free(&loader->connection_context);
+    module_redis_multi_free(&loader->connection_context);
+    module_redis_replication_client_free(&loader->connection_context);
+    module_redis_connection_context_reset(&loader->connection_context);
+    module_redis_connection_context_cleanup(&loader->connection_context);
+    network_channel_cleanup(&loader->network_channel);
+    ffma_mem_free(loader);
+
+    for(uint32_t reader_index = 0; reader_index < readers_count; reader_index++) {
+        module_redis_aof_segment_reader_t *reader = &readers[reader_index];
+
+        if (reader->channel) {
+            storage_close(reader->channel);
+            reader->channel = NULL;
+        }
+
+        if (reader->buffer) {
+            ffma_mem_free(reader->buffer);
+        }
+    }
+
+    if (unlikely(!result_res)) {
+        FATAL(TAG, "Unable to load the append only file, can't continue!");
+    }
+
+    // The loaded segments are compacted in a new base and then deleted, the writes are staged from now on
+    if ((base_found || readers_count > 0) && module_redis_aof_rewrite(db)) {
+        for(uint32_t reader_index = 0; reader_index < readers_count; reader_index++) {
+            unlink(readers[reader_index].path);
+        }
+    } else {
+        module_redis_replication_enable_staging();
+    }
+
+    for(uint32_t reader_index = 0; reader_index < readers_count; reader_index++) {
+        ffma_mem_free(readers[reader_index].path);
+    }
+
+    if (readers) {
+        ffma_mem_free(readers);
+    }
+
+    ffma_mem_free(base_path);
+}
+
+static void module_redis_aof_load_fiber_entrypoint(
+        void *user_data) {
+    module_redis_aof_load(user_data);
+
+    __atomic_store_n(&module_redis_aof_registry.loading, false, __ATOMIC_SEQ_CST);
+
+    fiber_scheduler_terminate_current_fiber();
+}
+
+void module_redis_aof_worker_initialize(
+        config_t *config) {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    worker_context_t *worker_context = worker_context_get();
+    module_redis_aof_worker_t *worker;
+    bool load = false;
+
+    if (config->database->aof == NULL) {
+        return;
+    }
+
+    worker = ffma_mem_alloc_zero(sizeof(module_redis_aof_worker_t));
+    worker->worker_index = worker_context->worker_index;
+    worker->closed_segments = double_linked_list_init();
+    module_redis_aof_worker = worker;
+
+    // The first worker loads the append only file, the registry is marked as loading before any worker starts to
+    // accept connections
+    spinlock_lock(&registry->lock);
+
+    if (registry->workers_registered_count == 0) {
+        registry->config = config->database->aof;
+        registry->loading = true;
+        load = true;
+
+        for(int module_index = 0; module_index < config->modules_count; module_index++) {
+            if (config->modules[module_index].type == CONFIG_MODULE_TYPE_REDIS) {
+                registry->module_config = &config->modules[module_index];
+                break;
+            }
+        }
+    }
+
+    registry->workers_registered_count++;
+
+    spinlock_unlock(&registry->lock);
+
+    fiber_scheduler_new_fiber(
+            "worker-redis-aof-flush",
+            strlen("worker-redis-aof-flush"),
+            module_redis_aof_flush_fiber_entrypoint,
+            worker);
+
+    if (load) {
+        fiber_scheduler_new_fiber(
+                "worker-redis-aof-load",
+                strlen("worker-redis-aof-load"),
+                module_redis_aof_load_fiber_entrypoint,
+                worker_context->db);
+    }
+}
+
+static void module_redis_aof_worker_cleanup_flush(
+        module_redis_aof_worker_t *worker) {
+    int fd;
+    size_t written_length = 0;
+
+    if (worker->buffer_length == 0 || worker->flushing) {
+        return;
+    }
+
+    // The event loop has already been terminated and the storage operations can't be used anymore, the data still in
+    // the buffer are written using the syscalls directly
+    if (worker->segment == NULL) {
+        worker->segment_path = module_redis_aof_build_segment_path(
+                module_redis_aof_registry.generation,
+                worker->worker_index);
+        worker->segment_offset = 0;
+
+        if ((fd = open(
+                worker->segment_path,
+                O_CREAT | O_WRONLY | O_TRUNC,
+                S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP)) < 0) {
+            LOG_E(TAG, "Unable to open the append only file segment <%s>", worker->segment_path);
+            LOG_E_OS_ERROR(TAG);
+            return;
+        }
+    } else {
+        fd = worker->segment->fd;
+    }
+
+    while(written_length < worker->buffer_length) {
+        ssize_t res = pwrite(
+                fd,
+                worker->buffer + written_length,
+                worker->buffer_length - written_length,
+                worker->segment_offset + (off_t)written_length);
+
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            LOG_E(TAG, "Unable to write to the append only file segment <%s>", worker->segment_path);
+            LOG_E_OS_ERROR(TAG);
+            break;
+        }
+
+        written_length += res;
+    }
+
+    if (module_redis_aof_registry.config->fsync != CONFIG_DATABASE_AOF_FSYNC_NO) {
+        fdatasync(fd);
+    }
+
+    if (worker->segment == NULL) {
+        storage_io_common_close(fd);
+    }
+}
+
+static void module_redis_aof_registry_free() {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+
+    registry->config = NULL;
+    registry->module_config = NULL;
+    registry->loading = false;
+    registry->rewrite_running = false;
+    registry->sequence = 0;
+    registry->generation = 0;
+    registry->base_sequence = 0;
+    registry->base_size = 0;
+    registry->segments_size = 0;
+}
+
+void module_redis_aof_worker_cleanup() {
+    module_redis_aof_registry_t *registry = &module_redis_aof_registry;
+    module_redis_aof_worker_t *worker = module_redis_aof_worker;
+    double_linked_list_item_t *item;
+
+    if (!worker) {
+        return;
+    }
+
+    module_redis_aof_worker_cleanup_flush(worker);
+
+    if (worker->segment) {
+        storage_io_common_close(worker->segment->fd);
+        storage_channel_free(worker->segment);
+    }
+
+    if (worker->segment_path) {
+        ffma_mem_free(worker->segment_path);
+    }
+
+    while((item = double_linked_list_pop_item(worker->closed_segments)) != NULL) {
+        module_redis_aof_closed_segment_t *closed_segment = item->data;
+
+        ffma_mem_free(closed_segment->path);
+        ffma_mem_free(closed_segment);
+        double_linked_list_item_free(item);
+    }
+    double_linked_list_free(worker->closed_segments);
+
+    if (worker->buffer) {
+        module_redis_command_helper_buffer_free(worker->buffer, worker->buffer_size);
+    }
+
+    if (worker->flush_buffer) {
+        module_redis_command_helper_buffer_free(worker->flush_buffer, worker->flush_buffer_size);
+    }
+
+    ffma_mem_free(worker);
+    module_redis_aof_worker = NULL;
+
+    spinlock_lock(&registry->lock);
+
+    registry->workers_registered_count--;
+
+    if (registry->workers_registered_count == 0) {
+        module_redis_aof_registry_free();
+    }
+
+    spinlock_unlock(&registry->lock);
+}
@@ -0,0 +1,144 @@
+#ifndef CACHEGRAND_MODULE_REDIS_AOF_H
+#define CACHEGRAND_MODULE_REDIS_AOF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The append only file reuses the staging of the replication (see module_redis_replication.h), each write command is
+// appended by the worker that executed it to a buffer and then written to a segment file owned by the worker, so the
+// workers never contend for a single writer. The records are prefixed by a sequence number taken from a global counter
+// once the command has been executed, the segments are merged using it when they are loaded.
+//
+// With the fsync policy set to always the fibers wait for their records to be synced before the reply is sent, the
+// first fiber that has to wait writes and syncs everything buffered by the worker and the fibers that find a flush in
+// progress wait for it to complete, grouping the fsyncs. With everysec a fiber of each worker writes and syncs the
+// buffer once per second, with no the buffer is written once per second and never explicitly synced.
+//
+// The rewrite takes a snapshot as SYNC does, records the sequence and bumps the generation while the writes are
+// paused, the workers switch to new segments at their next flush. Once the base file containing the snapshot has been
+// synced and renamed, the segments containing only records older than the snapshot are deleted.
+//
+// At startup the first worker loads the base and the segments, the commands are applied using
+// module_redis_process_data and the other connections get a LOADING error meanwhile, the loaded data are then
+// rewritten to compact the files.
+#define MODULE_REDIS_AOF_BASE_FILENAME "cachegrand.aof.base"
+#define MODULE_REDIS_AOF_BASE_TEMP_FILENAME "cachegrand.aof.base.tmp"
+#define MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "cachegrand.aof."
+#define MODULE_REDIS_AOF_BASE_MAGIC "CGAOFB01"
+#define MODULE_REDIS_AOF_BUFFER_MIN_SIZE (64 * 1024)
+#define MODULE_REDIS_AOF_READ_BUFFER_SIZE (64 * 1024)
+#define MODULE_REDIS_AOF_FLUSH_INTERVAL_NS (1000 * 1000 * 1000)
+#define MODULE_REDIS_AOF_BUSY_WAIT_NS (50 * 1000)
+
+typedef struct module_redis_aof_base_header module_redis_aof_base_header_t;
+struct module_redis_aof_base_header {
+    char magic[8];
+    uint64_t sequence;
+    uint32_t generation;
+} __attribute__((packed));
+
+typedef struct module_redis_aof_record_header module_redis_aof_record_header_t;
+struct module_redis_aof_record_header {
+    uint64_t sequence;
+    uint32_t length;
+} __attribute__((packed));
+
+typedef struct module_redis_aof_closed_segment module_redis_aof_closed_segment_t;
+struct module_redis_aof_closed_segment {
+    char *path;
+    uint64_t max_sequence;
+};
+
+typedef struct module_redis_aof_registry module_redis_aof_registry_t;
+struct module_redis_aof_registry {
+    spinlock_lock_volatile_t lock;
+    uint32_t workers_registered_count;
+    config_database_aof_t *config;
+    config_module_t *module_config;
+    bool_volatile_t loading;
+    bool_volatile_t rewrite_running;
+    uint64_volatile_t sequence;
+    uint32_volatile_t generation;
+    uint64_volatile_t base_sequence;
+    uint64_volatile_t base_size;
+    uint64_volatile_t segments_size;
+};
+
+typedef struct module_redis_aof_worker module_redis_aof_worker_t;
+struct module_redis_aof_worker {
+    uint32_t worker_index;
+    uint32_t generation;
+    storage_channel_t *segment;
+    char *segment_path;
+    off_t segment_offset;
+    uint64_t segment_max_sequence;
+    double_linked_list_t *closed_segments;
+    char *buffer;
+    size_t buffer_length;
+    size_t buffer_size;
+    uint64_t buffer_max_sequence;
+    char *flush_buffer;
+    size_t flush_buffer_size;
+    uint64_t appended_length;
+    uint64_t written_length;
+    bool flushing;
+};
+
+typedef struct module_redis_aof_base_writer module_redis_aof_base_writer_t;
+struct module_redis_aof_base_writer {
+    storage_channel_t *channel;
+    off_t offset;
+};
+
+typedef struct module_redis_aof_segment_reader module_redis_aof_segment_reader_t;
+struct module_redis_aof_segment_reader {
+    char *path;
+    uint32_t generation;
+    storage_channel_t *channel;
+    off_t file_size;
+    off_t file_offset;
+    char *buffer;
+    size_t buffer_offset;
+    size_t buffer_length;
+    module_redis_aof_record_header_t record_header;
+    bool has_record;
+};
+
+typedef struct module_redis_aof_loader module_redis_aof_loader_t;
+struct module_redis_aof_loader {
+    network_channel_t network_channel;
+    module_redis_connection_context_t connection_context;
+    uint64_t base_sequence;
+    uint64_t records_count;
+};
+
+extern module_redis_aof_registry_t module_redis_aof_registry;
+
+static inline __attribute__((always_inline)) bool module_redis_aof_is_loading(
+        module_redis_connection_context_t *connection_context) {
+    // The connections applying a stream of commands, as the one loading the append only file, are always allowed
+    return
+            unlikely(module_redis_aof_registry.loading) &&
+            (connection_context->replication == NULL || !connection_context->replication->is_link);
+}
+
+void module_redis_aof_worker_initialize(
+        config_t *config);
+
+void module_redis_aof_append(
+        char *data,
+        size_t data_length);
+
+bool module_redis_aof_is_enabled();
+
+bool module_redis_aof_rewrite_start(
+        storage_db_t *db);
+
+void module_redis_aof_worker_cleanup();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_AOF_H
@@ -0,0 +1,734 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "clock.h"
+#include "random.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "worker/network/worker_network_op.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/module_redis_replication.h"
+
+#include "module_redis_cluster.h"
+
+#define TAG "module_redis_cluster"
+
+module_redis_cluster_registry_t module_redis_cluster_registry = { 0 };
+
+static void module_redis_cluster_node_generate_id(
+        char *id) {
+    static const char hex_chars[] = "0123456789abcdef";
+
+    uint64_t random_value = 0;
+
+    for(int index = 0; index < MODULE_REDIS_CLUSTER_NODE_ID_LENGTH; index++) {
+        // Each random value provides 16 hex chars
+        if (index % 16 == 0) {
+            random_value = random_generate();
+        }
+
+        id[index] = hex_chars[random_value & 0x0F];
+        random_value >>= 4;
+    }
+
+    id[MODULE_REDIS_CLUSTER_NODE_ID_LENGTH] = 0;
+}
+
+static uint16_t module_redis_cluster_node_append(
+        char *address,
+        uint16_t port) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    module_redis_cluster_node_t *node;
+
+    // The nodes are only appended, the forgotten ones are flagged, so the indexes stored in the slots never change
+    if (registry->nodes_count == MODULE_REDIS_CLUSTER_NODES_MAX) {
+        return MODULE_REDIS_CLUSTER_NODE_NONE;
+    }
+
+    node = &registry->nodes[registry->nodes_count];
+    module_redis_cluster_node_generate_id(node->id);
+    strncpy(node->address, address, sizeof(node->address) - 1);
+    node->port = port;
+    node->forgotten = false;
+
+    __atomic_store_n(&registry->nodes_count, registry->nodes_count + 1, __ATOMIC_RELEASE);
+
+    return registry->nodes_count - 1;
+}
+
+void module_redis_cluster_registry_initialize(
+        config_module_t *module_config) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    config_module_redis_cluster_t *cluster_config = module_config->redis->cluster;
+    uint16_t port = cluster_config->announce_port;
+
+    if (likely(__atomic_load_n(&registry->initialized, __ATOMIC_ACQUIRE))) {
+        return;
+    }
+
+    // The announce port defaults to the port of the first binding
+    if (port == 0 && module_config->network->bindings_count > 0) {
+        port = module_config->network->bindings[0].port;
+    }
+
+    spinlock_lock(&registry->lock);
+
+    if (!registry->initialized) {
+        for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+            registry->slots[slot].owner = MODULE_REDIS_CLUSTER_NODE_NONE;
+            registry->slots[slot].migrating_to = MODULE_REDIS_CLUSTER_NODE_NONE;
+            registry->slots[slot].importing_from = MODULE_REDIS_CLUSTER_NODE_NONE;
+        }
+
+        module_redis_cluster_node_append(cluster_config->announce_address, port);
+        LOG_I(TAG, "Cluster mode enabled, node id <%s>", registry->nodes[MODULE_REDIS_CLUSTER_NODE_MYSELF].id);
+
+        __atomic_store_n(&registry->initialized, true, __ATOMIC_RELEASE);
+    }
+
+    spinlock_unlock(&registry->lock);
+}
+
+int32_t module_redis_cluster_node_find(
+        char *id,
+        size_t id_length) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    uint16_t nodes_count = __atomic_load_n(&registry->nodes_count, __ATOMIC_ACQUIRE);
+
+    if (id_length != MODULE_REDIS_CLUSTER_NODE_ID_LENGTH) {
+        return -1;
+    }
+
+    for(uint16_t node_index = 0; node_index < nodes_count; node_index++) {
+        module_redis_cluster_node_t *node = &registry->nodes[node_index];
+
+        if (!node->forgotten && strncmp(node->id, id, MODULE_REDIS_CLUSTER_NODE_ID_LENGTH) == 0) {
+            return node_index;
+        }
+    }
+
+    return -1;
+}
+
+uint16_t module_redis_cluster_node_meet(
+        char *address,
+        uint16_t port) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    uint16_t node_index = MODULE_REDIS_CLUSTER_NODE_NONE;
+
+    spinlock_lock(&registry->lock);
+
+    for(uint16_t index = 0; index < registry->nodes_count; index++) {
+        module_redis_cluster_node_t *node = &registry->nodes[index];
+
+        if (node->port == port && strcmp(node->address, address) == 0) {
+            node->forgotten = false;
+            node_index = index;
+            break;
+        }
+    }
+
+    if (node_index == MODULE_REDIS_CLUSTER_NODE_NONE) {
+        node_index = module_redis_cluster_node_append(address, port);
+    }
+
+    registry->epoch++;
+    spinlock_unlock(&registry->lock);
+
+    return node_index;
+}
+
+bool module_redis_cluster_node_forget(
+        uint16_t node_index) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+
+    if (node_index == MODULE_REDIS_CLUSTER_NODE_MYSELF) {
+        return false;
+    }
+
+    spinlock_lock(&registry->lock);
+
+    // The slots served by the forgotten node become unassigned
+    for(uint32_t slot = 0; slot < MODULE_REDIS_CLUSTER_SLOTS_COUNT; slot++) {
+        module_redis_cluster_slot_t *cluster_slot = &registry->slots[slot];
+
+        if (cluster_slot->owner == node_index) {
+            cluster_slot->owner = MODULE_REDIS_CLUSTER_NODE_NONE;
+        }
+
+        if (cluster_slot->migrating_to == node_index) {
+            cluster_slot->migrating_to = MODULE_REDIS_CLUSTER_NODE_NONE;
+        }
+
+        if (cluster_slot->importing_from == node_index) {
+            cluster_slot->importing_from = MODULE_REDIS_CLUSTER_NODE_NONE;
+        }
+    }
+
+    registry->nodes[node_index].forgotten = true;
+    registry->epoch++;
+
+    spinlock_unlock(&registry->lock);
+
+    return true;
+}
+
+bool module_redis_cluster_slot_add(
+        uint16_t slot) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    bool result_res = false;
+
+    spinlock_lock(&registry->lock);
+
+    if (registry->slots[slot].owner == MODULE_REDIS_CLUSTER_NODE_NONE) {
+        registry->slots[slot].owner = MODULE_REDIS_CLUSTER_NODE_MYSELF;
+        registry->epoch++;
+        result_res = true;
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    return result_res;
+}
+
+bool module_redis_cluster_slot_delete(
+        uint16_t slot) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    bool result_res = false;
+
+    spinlock_lock(&registry->lock);
+
+    if (registry->slots[slot].owner != MODULE_REDIS_CLUSTER_NODE_NONE) {
+        registry->slots[slot].owner = MODULE_REDIS_CLUSTER_NODE_NONE;
+        registry->slots[slot].migrating_to = MODULE_REDIS_CLUSTER_NODE_NONE;
+        registry->slots[slot].importing_from = MODULE_REDIS_CLUSTER_NODE_NONE;
+        registry->epoch++;
+        result_res = true;
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    return result_res;
+}
+
+void module_redis_cluster_slot_set_node(
+        uint16_t slot,
+        uint16_t node_index) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+
+    spinlock_lock(&registry->lock);
+
+    // Assigning the slot closes any migration in progress, as in Redis Cluster it's invoked on the target node once
+    // all the keys have been migrated and then on the source node
+    registry->slots[slot].owner = node_index;
+    registry->slots[slot].migrating_to = MODULE_REDIS_CLUSTER_NODE_NONE;
+    registry->slots[slot].importing_from = MODULE_REDIS_CLUSTER_NODE_NONE;
+    registry->epoch++;
+
+    spinlock_unlock(&registry->lock);
+}
+
+void module_redis_cluster_slot_set_migrating(
+        uint16_t slot,
+        uint16_t node_index) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+
+    spinlock_lock(&registry->lock);
+    registry->slots[slot].migrating_to = node_index;
+    registry->epoch++;
+    spinlock_unlock(&registry->lock);
+}
+
+void module_redis_cluster_slot_set_importing(
+        uint16_t slot,
+        uint16_t node_index) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+
+    spinlock_lock(&registry->lock);
+    registry->slots[slot].importing_from = node_index;
+    registry->epoch++;
+    spinlock_unlock(&registry->lock);
+}
+
+void module_redis_cluster_slot_set_stable(
+        uint16_t slot) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+
+    spinlock_lock(&registry->lock);
+    registry->slots[slot].migrating_to = MODULE_REDIS_CLUSTER_NODE_NONE;
+    registry->slots[slot].importing_from = MODULE_REDIS_CLUSTER_NODE_NONE;
+    registry->epoch++;
+    spinlock_unlock(&registry->lock);
+}
+
+static bool module_redis_cluster_command_keys_slot(
+        void *user_data,
+        char *key,
+        size_t key_length) {
+    module_redis_cluster_command_keys_t *command_keys = user_data;
+    int32_t slot = storage_db_key_slot(key, key_length);
+
+    command_keys->keys_count++;
+
+    if (command_keys->slot == -1) {
+        command_keys->slot = slot;
+    } else if (command_keys->slot != slot) {
+        command_keys->cross_slot = true;
+        return false;
+    }
+
+    return true;
+}
+
+static bool module_redis_cluster_command_keys_missing(
+        void *user_data,
+        char *key,
+        size_t key_length) {
+    module_redis_cluster_command_keys_t *command_keys = user_data;
+    storage_db_entry_index_t *entry_index = storage_db_get_entry_index(command_keys->db, key, key_length);
+
+    if (entry_index == NULL || storage_db_entry_index_is_expired(entry_index)) {
+        command_keys->keys_missing_count++;
+    }
+
+    return true;
+}
+
+static bool module_redis_cluster_command_redirect(
+        module_redis_connection_context_t *connection_context,
+        char *error_type,
+        uint16_t slot,
+        uint16_t node_index) {
+    module_redis_cluster_node_t *node = &module_redis_cluster_registry.nodes[node_index];
+
+    module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "%s %u %s:%u",
+            error_type,
+            slot,
+            node->address,
+            node->port);
+
+    return false;
+}
+
+bool module_redis_cluster_command_check(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_cluster_registry_t *registry = &module_redis_cluster_registry;
+    module_redis_command_info_t *command_info = connection_context->command.info;
+    module_redis_cluster_slot_t *cluster_slot;
+    uint16_t owner, migrating_to, importing_from;
+    module_redis_cluster_command_keys_t command_keys = {
+            .db = connection_context->db,
+            .slot = -1,
+    };
+
+    // ASKING is valid only for the command that follows it
+    bool asking = connection_context->cluster_asking;
+    connection_context->cluster_asking = false;
+
+    if (likely(!module_redis_cluster_is_enabled(connection_context))) {
+        return true;
+    }
+
+    // The streams applied by the replicas and by the append only file loader are never redirected
+    if (connection_context->replication != NULL && connection_context->replication->is_link) {
+        return true;
+    }
+
+    module_redis_cluster_registry_initialize(connection_context->network_channel->module_config);
+
+    module_redis_command_iterate_arguments_keys(
+            command_info->arguments,
+            command_info->arguments_count,
+            (uintptr_t)connection_context->command.context,
+            module_redis_cluster_command_keys_slot,
+            &command_keys);
+
+    if (unlikely(command_keys.cross_slot)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "CROSSSLOT Keys in request don't hash to the same slot");
+        return false;
+    }
+
+    // MIGRATE operates only on the local keys, as in Redis Cluster it's never redirected
+    if (command_keys.slot == -1 || command_info->command == MODULE_REDIS_COMMAND_MIGRATE) {
+        return true;
+    }
+
+    cluster_slot = &registry->slots[command_keys.slot];
+    owner = cluster_slot->owner;
+    migrating_to = cluster_slot->migrating_to;
+    importing_from = cluster_slot->importing_from;
+
+    if (owner == MODULE_REDIS_CLUSTER_NODE_MYSELF) {
+        if (likely(migrating_to == MODULE_REDIS_CLUSTER_NODE_NONE)) {
+            return true;
+        }
+
+        // While the slot is being migrated the keys already moved have to be requested to the target node
+        module_redis_command_iterate_arguments_keys(
+                command_info->arguments,
+                command_info->arguments_count,
+                (uintptr_t)connection_context->command.context,
+                module_redis_cluster_command_keys_missing,
+                &command_keys);
+
+        if (command_keys.keys_missing_count == 0) {
+            return true;
+        } else if (command_keys.keys_missing_count == command_keys.keys_count) {
+            return module_redis_cluster_command_redirect(
+                    connection_context,
+                    "ASK",
+                    command_keys.slot,
+                    migrating_to);
+        }
+
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "TRYAGAIN Multiple keys request during rehashing of slot");
+        return false;
+    }
+
+    if (asking && importing_from != MODULE_REDIS_CLUSTER_NODE_NONE) {
+        return true;
+    }
+
+    if (owner == MODULE_REDIS_CLUSTER_NODE_NONE) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "CLUSTERDOWN Hash slot not served");
+        return false;
+    }
+
+    return module_redis_cluster_command_redirect(
+            connection_context,
+            "MOVED",
+            command_keys.slot,
+            owner);
+}
+
+bool module_redis_cluster_parse_address(
+        char *host,
+        size_t host_length,
+        uint16_t port,
+        struct sockaddr *address,
+        socklen_t *address_size) {
+    char host_str[INET6_ADDRSTRLEN];
+    struct sockaddr_in *address_ipv4 = (struct sockaddr_in *)address;
+    struct sockaddr_in6 *address_ipv6 = (struct sockaddr_in6 *)address;
+
+    if (host_length >= sizeof(host_str)) {
+        return false;
+    }
+
+    memcpy(host_str, host, host_length);
+    host_str[host_length] = 0;
+
+    // Only the IP addresses are supported, resolving an hostname would block the worker
+    if (inet_pton(AF_INET, host_str, &address_ipv4->sin_addr) == 1) {
+        address_ipv4->sin_family = AF_INET;
+        address_ipv4->sin_port = htons(port);
+        *address_size = sizeof(struct sockaddr_in);
+    } else if (inet_pton(AF_INET6, host_str, &address_ipv6->sin6_addr) == 1) {
+        address_ipv6->sin6_family = AF_INET6;
+        address_ipv6->sin6_port = htons(port);
+        *address_size = sizeof(struct sockaddr_in6);
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+static bool module_redis_cluster_migrate_network_write(
+        void *user_data,
+        char *data,
+        size_t data_length) {
+    return network_send_buffered(user_data, data, data_length) == NETWORK_OP_RESULT_OK;
+}
+
+static bool module_redis_cluster_migrate_send_blob(
+        network_channel_t *network_channel,
+        char *data,
+        size_t data_length) {
+    char header[32];
+    int header_length = snprintf(header, sizeof(header), "$%lu\r\n", data_length);
+
+    return
+            network_send_buffered(network_channel, header, header_length) == NETWORK_OP_RESULT_OK &&
+            network_send_buffered(network_channel, data, data_length) == NETWORK_OP_RESULT_OK &&
+            network_send_buffered(network_channel, "\r\n", 2) == NETWORK_OP_RESULT_OK;
+}
+
+static bool module_redis_cluster_migrate_read_reply(
+        network_channel_t *network_channel,
+        network_channel_buffer_t *read_buffer,
+        char *reply,
+        size_t reply_size) {
+    char *line_end;
+
+    // All the commands sent to the target node have single line replies
+    while((line_end = memchr(
+            read_buffer->data + read_buffer->data_offset,
+            '\n',
+            read_buffer->data_size)) == NULL) {
+        if (unlikely(network_buffer_needs_rewind(read_buffer, NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
+            network_buffer_rewind(read_buffer);
+        }
+
+        if (unlikely(!network_buffer_has_enough_space(read_buffer, NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
+            return false;
+        }
+
+        if (network_receive(network_channel, read_buffer, NETWORK_CHANNEL_MAX_PACKET_SIZE) != NETWORK_OP_RESULT_OK) {
+            return false;
+        }
+    }
+
+    size_t line_length = line_end - (read_buffer->data + read_buffer->data_offset) + 1;
+    size_t reply_length = MIN(line_length > 2 ? line_length - 2 : 0, reply_size - 1);
+
+    memcpy(reply, read_buffer->data + read_buffer->data_offset, reply_length);
+    reply[reply_length] = 0;
+
+    read_buffer->data_offset += line_length;
+    read_buffer->data_size -= line_length;
+
+    return true;
+}
+
+static bool module_redis_cluster_migrate_check_busy_keys(
+        network_channel_t *network_channel,
+        network_channel_buffer_t *read_buffer,
+        module_redis_replication_snapshot_entry_t *entries,
+        uint64_t entries_count,
+        bool *busy_keys) {
+    char header[64];
+    char reply[128];
+    int header_length = snprintf(
+            header,
+            sizeof(header),
+            "*1\r\n$6\r\nASKING\r\n*%lu\r\n$6\r\nEXISTS\r\n",
+            entries_count + 1);
+
+    if (unlikely(network_send_buffered(network_channel, header, header_length) != NETWORK_OP_RESULT_OK)) {
+        return false;
+    }
+
+    for(uint64_t index = 0; index < entries_count; index++) {
+        if (unlikely(!module_redis_cluster_migrate_send_blob(
+                network_channel,
+                entries[index].key,
+                entries[index].key_length))) {
+            return false;
+        }
+    }
+
+    if (unlikely(network_flush_send_buffer(network_channel) != NETWORK_OP_RESULT_OK)) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_cluster_migrate_read_reply(network_channel, read_buffer, reply, sizeof(reply)))) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_cluster_migrate_read_reply(network_channel, read_buffer, reply, sizeof(reply)))) {
+        return false;
+    }
+
+    *busy_keys = reply[0] != ':' || strtoll(reply + 1, NULL, 10) > 0;
+
+    return true;
+}
+
+bool module_redis_cluster_migrate(
+        module_redis_connection_context_t *connection_context,
+        struct sockaddr *address,
+        socklen_t address_size,
+        module_redis_key_t *keys,
+        uint32_t keys_count,
+        int64_t timeout_ms,
+        bool copy,
+        bool replace) {
+    bool busy_keys = false;
+    char reply[256];
+    char error_reply[256] = { 0 };
+    char *error_message = NULL;
+    uint64_t commands_count = 0;
+    uint64_t entries_count = 0;
+    network_channel_t *network_channel = NULL;
+    network_channel_buffer_t read_buffer = { 0 };
+    storage_db_t *db = connection_context->db;
+    bool is_link = connection_context->replication != NULL && connection_context->replication->is_link;
+    module_redis_replication_snapshot_entry_t *entries =
+            xalloc_alloc(sizeof(module_redis_replication_snapshot_entry_t) * keys_count);
+
+    // The current version of the entries is pinned as SYNC does, the keys are copied because they are freed together
+    // with the entries
+    for(uint32_t index = 0; index < keys_count; index++) {
+        storage_db_entry_index_t *entry_index = storage_db_get_entry_index_for_read(
+                db,
+                keys[index].key,
+                keys[index].length);
+
+        if (entry_index == NULL) {
+            continue;
+        }
+
+        entries[entries_count].key = xalloc_alloc(keys[index].length);
+        memcpy(entries[entries_count].key, keys[index].key, keys[index].length);
+        entries[entries_count].key_length = keys[index].length;
+        entries[entries_count].entry_index = entry_index;
+        entries_count++;
+    }
+
+    if (entries_count == 0) {
+        module_redis_replication_snapshot_release(entries, entries_count);
+        return module_redis_connection_send_simple_string(connection_context, "NOKEY", strlen("NOKEY"));
+    }
+
+    // The replicas, and the append only file loader, only have to delete the keys, the primary has already moved them
+    if (is_link) {
+        goto delete_keys;
+    }
+
+    network_channel = worker_op_network_connect(
+            address,
+            address_size,
+            connection_context->network_channel->module_config);
+    if (network_channel == NULL) {
+        error_message = "IOERR error or timeout connecting to the target instance";
+        goto end;
+    }
+
+    if (timeout_ms > 0) {
+        network_channel->timeout.read.sec = timeout_ms / 1000;
+        network_channel->timeout.read.nsec = (timeout_ms % 1000) * 1000 * 1000;
+    }
+
+    read_buffer.data = ffma_mem_alloc(NETWORK_CHANNEL_RECV_BUFFER_SIZE);
+    read_buffer.length = NETWORK_CHANNEL_RECV_BUFFER_SIZE;
+
+    if (!replace) {
+        if (!module_redis_cluster_migrate_check_busy_keys(
+                network_channel,
+                &read_buffer,
+                entries,
+                entries_count,
+                &busy_keys)) {
+            error_message = "IOERR error or timeout reading to target instance";
+            goto end;
+        }
+
+        if (busy_keys) {
+            error_message = "BUSYKEY Target key name already exists.";
+            goto end;
+        }
+    }
+
+    if (unlikely(!module_redis_replication_snapshot_serialize_migrate(
+            db,
+            entries,
+            entries_count,
+            module_redis_cluster_migrate_network_write,
+            network_channel,
+            &commands_count) ||
+            network_flush_send_buffer(network_channel) != NETWORK_OP_RESULT_OK)) {
+        error_message = "IOERR error or timeout writing to target instance";
+        goto end;
+    }
+
+    // All the replies have to be read, the keys are deleted only if none of the commands failed
+    for(uint64_t index = 0; index < commands_count; index++) {
+        if (unlikely(!module_redis_cluster_migrate_read_reply(network_channel, &read_buffer, reply, sizeof(reply)))) {
+            error_message = "IOERR error or timeout reading to target instance";
+            goto end;
+        }
+
+        if (reply[0] == '-' && error_reply[0] == 0) {
+            strncpy(error_reply, reply + 1, sizeof(error_reply) - 1);
+        }
+    }
+
+    if (error_reply[0] != 0) {
+        error_message = "ERR Target instance replied with error";
+        goto end;
+    }
+
+delete_keys:
+    if (!copy) {
+        for(uint64_t index = 0; index < entries_count; index++) {
+            storage_db_op_delete(db, entries[index].key, entries[index].key_length);
+        }
+    }
+
+end:
+    if (network_channel != NULL) {
+        worker_op_network_close(network_channel, true);
+    }
+
+    if (read_buffer.data) {
+        ffma_mem_free(read_buffer.data);
+    }
+
+    module_redis_replication_snapshot_release(entries, entries_count);
+
+    if (error_reply[0] != 0) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "%s: %s",
+                error_message,
+                error_reply);
+    } else if (error_message) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "%s",
+                error_message);
+    }
+
+    return module_redis_connection_send_ok(connection_context);
+}
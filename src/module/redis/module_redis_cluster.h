@@ -0,0 +1,125 @@
+#ifndef CACHEGRAND_MODULE_REDIS_CLUSTER_H
+#define CACHEGRAND_MODULE_REDIS_CLUSTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The cluster mode shards the keys over 16384 hash slots as Redis Cluster does, the slot of a key is the CRC16 of the
+// key, or of its hash tag, modulo 16384 (see storage_db_key_slot).
+// The topology, the known nodes and the node serving each slot, is kept in a registry shared by all the workers and is
+// configured via the CLUSTER commands; there is no gossip protocol between the nodes so the same commands have to be
+// sent to each one of them.
+//
+// Before being executed the keys of a command are checked, all of them have to belong to the same slot and, if the
+// slot is served by another node, the client is redirected to it with a MOVED error. While a slot is being migrated
+// the source node redirects with an ASK error the commands operating on keys it doesn't have anymore and the target
+// node accepts them only if the client has sent ASKING right before the command.
+// The amount of keys per slot is tracked by the storage db, the keys of a slot are found scanning the hashtable.
+#define MODULE_REDIS_CLUSTER_SLOTS_COUNT STORAGE_DB_KEYS_SLOTS_COUNT
+#define MODULE_REDIS_CLUSTER_NODES_MAX (1024)
+#define MODULE_REDIS_CLUSTER_NODE_ID_LENGTH (40)
+#define MODULE_REDIS_CLUSTER_NODE_NONE UINT16_MAX
+#define MODULE_REDIS_CLUSTER_NODE_MYSELF (0)
+
+typedef struct module_redis_cluster_node module_redis_cluster_node_t;
+struct module_redis_cluster_node {
+    char id[MODULE_REDIS_CLUSTER_NODE_ID_LENGTH + 1];
+    char address[INET6_ADDRSTRLEN];
+    uint16_t port;
+    bool_volatile_t forgotten;
+};
+
+typedef struct module_redis_cluster_slot module_redis_cluster_slot_t;
+struct module_redis_cluster_slot {
+    uint16_volatile_t owner;
+    uint16_volatile_t migrating_to;
+    uint16_volatile_t importing_from;
+};
+
+typedef struct module_redis_cluster_registry module_redis_cluster_registry_t;
+struct module_redis_cluster_registry {
+    spinlock_lock_volatile_t lock;
+    bool_volatile_t initialized;
+    uint16_volatile_t nodes_count;
+    uint64_volatile_t epoch;
+    module_redis_cluster_node_t nodes[MODULE_REDIS_CLUSTER_NODES_MAX];
+    module_redis_cluster_slot_t slots[MODULE_REDIS_CLUSTER_SLOTS_COUNT];
+};
+
+typedef struct module_redis_cluster_command_keys module_redis_cluster_command_keys_t;
+struct module_redis_cluster_command_keys {
+    storage_db_t *db;
+    int32_t slot;
+    bool cross_slot;
+    uint32_t keys_count;
+    uint32_t keys_missing_count;
+};
+
+extern module_redis_cluster_registry_t module_redis_cluster_registry;
+
+static inline __attribute__((always_inline)) bool module_redis_cluster_is_enabled(
+        module_redis_connection_context_t *connection_context) {
+    return unlikely(connection_context->network_channel->module_config->redis->cluster != NULL);
+}
+
+void module_redis_cluster_registry_initialize(
+        config_module_t *module_config);
+
+bool module_redis_cluster_command_check(
+        module_redis_connection_context_t *connection_context);
+
+int32_t module_redis_cluster_node_find(
+        char *id,
+        size_t id_length);
+
+uint16_t module_redis_cluster_node_meet(
+        char *address,
+        uint16_t port);
+
+bool module_redis_cluster_node_forget(
+        uint16_t node_index);
+
+bool module_redis_cluster_slot_add(
+        uint16_t slot);
+
+bool module_redis_cluster_slot_delete(
+        uint16_t slot);
+
+void module_redis_cluster_slot_set_node(
+        uint16_t slot,
+        uint16_t node_index);
+
+void module_redis_cluster_slot_set_migrating(
+        uint16_t slot,
+        uint16_t node_index);
+
+void module_redis_cluster_slot_set_importing(
+        uint16_t slot,
+        uint16_t node_index);
+
+void module_redis_cluster_slot_set_stable(
+        uint16_t slot);
+
+bool module_redis_cluster_parse_address(
+        char *host,
+        size_t host_length,
+        uint16_t port,
+        struct sockaddr *address,
+        socklen_t *address_size);
+
+bool module_redis_cluster_migrate(
+        module_redis_connection_context_t *connection_context,
+        struct sockaddr *address,
+        socklen_t address_size,
+        module_redis_key_t *keys,
+        uint32_t keys_count,
+        int64_t timeout_ms,
+        bool copy,
+        bool replace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_CLUSTER_H
@@ -307,7 +307,9 @@ bool module_redis_command_process_argument_begin(
                         connection_context->command.context);
 
         module_redis_long_string_t *string = command_parser_context->current_argument.member_context_addr;
-        string->chunk_sequence = storage_db_chunk_sequence_allocate(
+        // The long strings might be stored as they are (e.g. the value of SET), the small ones are allocated together
+        // with an entry index so they don't have to be copied
+        string->chunk_sequence = storage_db_chunk_sequence_allocate_entry_index_value(
                 connection_context->db,
                 argument_length);
 
@@ -777,6 +779,25 @@ bool module_redis_command_acquire_slice_and_write_blob_start(
     return true;
 }
 
+bool module_redis_command_stream_entry_can_complete_without_yielding(
+        network_channel_t *network_channel,
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    // The value is streamed without yielding only if it's written in one go in the send buffer, without flushing it,
+    // and if the data can be read directly from memory
+    if (entry_index->value->count != 1 || entry_index->value->size + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH > NETWORK_CHANNEL_MAX_PACKET_SIZE) {
+        return false;
+    }
+
+    if (!network_buffer_has_enough_space(&network_channel->buffers.send, entry_index->value->size + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH)) {
+        return false;
+    }
+
+    return storage_db_entry_chunk_can_read_from_memory(
+            db,
+            storage_db_chunk_sequence_get(entry_index->value, 0));
+}
+
 bool module_redis_command_stream_entry_range_with_one_chunk(
         network_channel_t *network_channel,
         storage_db_t *db,
@@ -787,12 +808,12 @@ bool module_redis_command_stream_entry_range_with_one_chunk(
     network_channel_buffer_data_t *send_buffer = NULL, *send_buffer_start = NULL, *send_buffer_end = NULL;
     storage_db_chunk_info_t *chunk_info;
 
-    assert(entry_index->value->count == 1 && length + 32 <= NETWORK_CHANNEL_MAX_PACKET_SIZE);
+    assert(entry_index->value->count == 1 && length + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH <= NETWORK_CHANNEL_MAX_PACKET_SIZE);
 
     // Acquires a slice long enough to stream the data and the protocol bits
     if (unlikely(!module_redis_command_acquire_slice_and_write_blob_start(
             network_channel,
-            length + 32,
+            length + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH,
             length,
             &send_buffer,
             &send_buffer_start,
@@ -850,13 +871,13 @@ bool module_redis_command_stream_entry_range_with_multiple_chunks(
         size_t length) {
     network_channel_buffer_data_t *send_buffer = NULL, *send_buffer_start = NULL, *send_buffer_end = NULL;
     storage_db_chunk_info_t *chunk_info = NULL;
-    size_t slice_length = 32;
+    size_t slice_length = PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH;
 
-    assert(entry_index->value->count > 1 || length + 32 > NETWORK_CHANNEL_MAX_PACKET_SIZE);
+    assert(entry_index->value->count > 1 || length + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH > NETWORK_CHANNEL_MAX_PACKET_SIZE);
 
     if (unlikely(!module_redis_command_acquire_slice_and_write_blob_start(
             network_channel,
-            32,
+            PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH,
             length,
             &send_buffer,
             &send_buffer_start,
@@ -898,34 +919,27 @@ bool module_redis_command_stream_entry_range_with_multiple_chunks(
             return false;
         }
 
-        size_t chunk_length_to_send = length > chunk_info->chunk_length
+        size_t chunk_length_to_send = length > chunk_info->chunk_length - sent_data
                 ? chunk_info->chunk_length
                 : length + sent_data;
-        do {
-            size_t data_available_to_send_length = chunk_length_to_send - sent_data;
-            size_t data_to_send_length =
-                    data_available_to_send_length > NETWORK_CHANNEL_MAX_PACKET_SIZE
-                    ? NETWORK_CHANNEL_MAX_PACKET_SIZE
-                    : data_available_to_send_length;
-
-            // TODO: check if it's the last chunk and, if yes, if it would fit in the send buffer with the protocol
-            //       bits that have to be sent later without doing an implicit flush
-            if (network_send_direct(
-                    network_channel,
-                    buffer_to_send + sent_data,
-                    data_to_send_length) != NETWORK_OP_RESULT_OK) {
-                if (allocated_new_buffer) {
-                    ffma_mem_free(buffer_to_send);
-                }
+        size_t data_to_send_length = chunk_length_to_send - sent_data;
 
-                return false;
+        // The data of the chunk are sent with a single send, the chunk is contiguous in memory and network_send_direct
+        // takes care of the partial sends, with the memory backend a value is always stored in a single chunk.
+        // TODO: check if it's the last chunk and, if yes, if it would fit in the send buffer with the protocol
+        //       bits that have to be sent later without doing an implicit flush
+        if (network_send_direct(
+                network_channel,
+                buffer_to_send + sent_data,
+                data_to_send_length) != NETWORK_OP_RESULT_OK) {
+            if (allocated_new_buffer) {
+                ffma_mem_free(buffer_to_send);
             }
 
-            sent_data += data_to_send_length;
-            length -= data_to_send_length;
-        } while (sent_data < chunk_length_to_send);
+            return false;
+        }
 
-        assert(sent_data == chunk_length_to_send);
+        length -= data_to_send_length;
 
         if (allocated_new_buffer) {
             ffma_mem_free(buffer_to_send);
@@ -958,6 +972,65 @@ bool module_redis_command_stream_entry_range_with_multiple_chunks(
     return true;
 }
 
+bool module_redis_command_iterate_arguments_keys(
+        module_redis_command_argument_t *arguments,
+        uint16_t arguments_count,
+        uintptr_t argument_context_base_addr,
+        module_redis_command_iterate_arguments_keys_fp_t *key_fp,
+        void *user_data) {
+    // Walks the arguments, and the sub arguments of the blocks, as module_redis_command_dump_arguments does to find
+    // the keys stored in the context of the command, the iteration stops if the callback returns false
+    for(uint16_t argument_index = 0; argument_index < arguments_count; argument_index++) {
+        int count = 1;
+        module_redis_command_argument_t *argument = &arguments[argument_index];
+        uintptr_t list = argument_context_base_addr + argument->argument_context_member_offset;
+
+        if (argument->type != MODULE_REDIS_COMMAND_ARGUMENT_TYPE_KEY &&
+            argument->type != MODULE_REDIS_COMMAND_ARGUMENT_TYPE_BLOCK &&
+            argument->type != MODULE_REDIS_COMMAND_ARGUMENT_TYPE_ONEOF) {
+            continue;
+        }
+
+        if (argument->token != NULL) {
+            if (!module_redis_command_context_has_token_get(argument, (void*)list)) {
+                continue;
+            }
+
+            list += module_redis_command_get_context_has_token_padding_size();
+        }
+
+        if (argument->has_multiple_occurrences) {
+            count = *(int *)(list + sizeof(void *));
+            list = (uintptr_t)*(void**)list;
+        }
+
+        for(int index = 0; index < count; index++) {
+            uintptr_t base_addr = list + (argument->argument_context_member_size * index);
+
+            if (argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_KEY) {
+                module_redis_key_t *key = (module_redis_key_t*)base_addr;
+
+                if (key->key == NULL) {
+                    continue;
+                }
+
+                if (!key_fp(user_data, key->key, key->length)) {
+                    return false;
+                }
+            } else if (!module_redis_command_iterate_arguments_keys(
+                    argument->sub_arguments,
+                    argument->sub_arguments_count,
+                    base_addr,
+                    key_fp,
+                    user_data)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 #if CACHEGRAND_MODULE_REDIS_COMMAND_DUMP_CONTEXT == 1
 void module_redis_command_dump_argument(
         storage_db_t *db,
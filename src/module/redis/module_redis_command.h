@@ -18,6 +18,11 @@ struct module_redis_command_context_has_token_padding_detection {
     void *pointer;
 };
 
+typedef bool (module_redis_command_iterate_arguments_keys_fp_t)(
+        void *user_data,
+        char *key,
+        size_t key_length);
+
 bool module_redis_command_process_begin(
         module_redis_connection_context_t *connection_context);
 
@@ -46,6 +51,11 @@ bool module_redis_command_acquire_slice_and_write_blob_start(
         network_channel_buffer_data_t **send_buffer_start,
         network_channel_buffer_data_t **send_buffer_end);
 
+bool module_redis_command_stream_entry_can_complete_without_yielding(
+        network_channel_t *network_channel,
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index);
+
 bool module_redis_command_stream_entry_range_with_one_chunk(
         network_channel_t *network_channel,
         storage_db_t *db,
@@ -60,7 +70,14 @@ bool module_redis_command_stream_entry_range_with_multiple_chunks(
         off_t offset,
         size_t length);
 
-static inline __attribute__((always_inline)) bool module_redis_command_process_end(
+bool module_redis_command_iterate_arguments_keys(
+        module_redis_command_argument_t *arguments,
+        uint16_t arguments_count,
+        uintptr_t argument_context_base_addr,
+        module_redis_command_iterate_arguments_keys_fp_t *key_fp,
+        void *user_data);
+
+static inline __attribute__((always_inline)) bool module_redis_command_process_end_has_all_arguments(
         module_redis_connection_context_t *connection_context) {
     module_redis_command_parser_context_t *command_parser_context = &connection_context->command.parser_context;
     module_redis_command_argument_t *expected_argument = command_parser_context->current_argument.expected_argument;
@@ -70,17 +87,29 @@ static inline __attribute__((always_inline)) bool module_redis_command_process_e
             expected_argument->type == MODULE_REDIS_COMMAND_ARGUMENT_TYPE_BLOCK &&
             command_parser_context->current_argument.block_argument_index > 0) {
         if (expected_argument->is_positional) {
-            return module_redis_connection_error_message_printf_noncritical(
+            module_redis_connection_error_message_printf_noncritical(
                     connection_context,
                     "ERR wrong number of arguments for '%s' command",
                     connection_context->command.info->string);
         } else {
-            return module_redis_connection_error_message_printf_noncritical(
+            module_redis_connection_error_message_printf_noncritical(
                     connection_context,
                     "ERR syntax error in '%s' option '%s'",
                     connection_context->command.info->string,
                     expected_argument->token);
         }
+
+        return false;
+    }
+
+    return true;
+}
+
+static inline __attribute__((always_inline)) bool module_redis_command_process_end(
+        module_redis_connection_context_t *connection_context) {
+    if (unlikely(!module_redis_command_process_end_has_all_arguments(connection_context))) {
+        // The error message has been set, the connection has to be closed only if it wasn't possible to set it
+        return !module_redis_connection_should_terminate_connection(connection_context);
     }
 
     return connection_context->command.info->command_end_funcptr(
@@ -234,8 +263,8 @@ static inline __attribute__((always_inline)) bool module_redis_command_stream_en
 
     // Check if the value is small enough to be contained in 1 single chunk and if it would fit in a memory single
     // memory allocation leaving enough space for the protocol begin and end signatures themselves.
-    // The 32 bytes extra are required for the protocol data
-    if (likely(entry_index->value->count == 1 && entry_index->value->size + 32 <= NETWORK_CHANNEL_MAX_PACKET_SIZE)) {
+    if (likely(entry_index->value->count == 1 &&
+            entry_index->value->size + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH <= NETWORK_CHANNEL_MAX_PACKET_SIZE)) {
         return module_redis_command_stream_entry_range_with_one_chunk(
                 network_channel,
                 db,
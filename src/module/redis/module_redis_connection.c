@@ -66,14 +66,15 @@ void module_redis_connection_context_cleanup(
     ffma_mem_free(connection_context->read_buffer.data);
 }
 
-void module_redis_connection_context_reset(
+void module_redis_connection_context_reset_command(
         module_redis_connection_context_t *connection_context) {
-    // Reset the reader_context to handle the next command in the buffer, the resp_version isn't touched as it's
-    // to be known all along the connection lifecycle
+    // Reset the command related information, the reader_context isn't touched as it may already be processing the next
+    // command in the buffer
     connection_context->command.info = NULL;
     connection_context->command.context  = NULL;
     connection_context->command.skip = false;
     connection_context->command.data_length = 0;
+    connection_context->command.arguments_count = 0;
     connection_context->terminate_connection = false;
 
     memset(&connection_context->command.parser_context, 0, sizeof(module_redis_command_parser_context_t));
@@ -82,7 +83,13 @@ void module_redis_connection_context_reset(
         ffma_mem_free(connection_context->error.message);
         connection_context->error.message = NULL;
     }
+}
 
+void module_redis_connection_context_reset(
+        module_redis_connection_context_t *connection_context) {
+    // Reset the reader_context to handle the next command in the buffer, the resp_version isn't touched as it's
+    // to be known all along the connection lifecycle
+    module_redis_connection_context_reset_command(connection_context);
     protocol_redis_reader_context_reset(&connection_context->reader_context);
 }
 
@@ -275,8 +282,10 @@ end:
     return return_result;
 }
 
-bool module_redis_connection_send_ok(
-        module_redis_connection_context_t *connection_context) {
+static bool module_redis_connection_send_header(
+        module_redis_connection_context_t *connection_context,
+        protocol_redis_types_t type,
+        uint64_t count) {
     bool return_result = false;
     network_channel_buffer_data_t *send_buffer, *send_buffer_start;
     size_t slice_length = 32;
@@ -288,11 +297,227 @@ bool module_redis_connection_send_ok(
         goto end;
     }
 
-    send_buffer_start = protocol_redis_writer_write_simple_string(
+    send_buffer_start = protocol_redis_writer_write_argument_header(
             send_buffer_start,
             slice_length,
-            "OK",
-            2);
+            type,
+            (int64_t)count);
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "buffer length incorrectly calculated, not enough space!");
+        goto end;
+    }
+
+    return_result = true;
+
+end:
+
+    return return_result;
+}
+
+bool module_redis_connection_send_map_header(
+        module_redis_connection_context_t *connection_context,
+        uint64_t items_count) {
+    // With RESP2 the maps are sent as flat arrays of keys and values
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        return module_redis_connection_send_header(connection_context, PROTOCOL_REDIS_TYPE_ARRAY, items_count * 2);
+    }
+
+    return module_redis_connection_send_header(connection_context, PROTOCOL_REDIS_TYPE_MAP, items_count);
+}
+
+bool module_redis_connection_send_set_header(
+        module_redis_connection_context_t *connection_context,
+        uint64_t set_length) {
+    return module_redis_connection_send_header(
+            connection_context,
+            connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2
+                ? PROTOCOL_REDIS_TYPE_ARRAY
+                : PROTOCOL_REDIS_TYPE_SET,
+            set_length);
+}
+
+bool module_redis_connection_send_push_header(
+        module_redis_connection_context_t *connection_context,
+        uint64_t messages_count) {
+    return module_redis_connection_send_header(
+            connection_context,
+            connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2
+                ? PROTOCOL_REDIS_TYPE_ARRAY
+                : PROTOCOL_REDIS_TYPE_PUSH,
+            messages_count);
+}
+
+bool module_redis_connection_send_double(
+        module_redis_connection_context_t *connection_context,
+        double number) {
+    bool return_result = false;
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 64;
+
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        goto end;
+    }
+
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        // With RESP2 the doubles are sent as blob strings, the number is written first to know its length
+        char number_str[48];
+        char *number_str_end = protocol_redis_writer_write_argument_double(
+                number_str,
+                sizeof(number_str),
+                number);
+
+        send_buffer_start = number_str_end == NULL
+                ? NULL
+                : protocol_redis_writer_write_blob_string(
+                        send_buffer_start,
+                        slice_length,
+                        number_str,
+                        (int)(number_str_end - number_str));
+    } else {
+        send_buffer_start = protocol_redis_writer_write_double(
+                send_buffer_start,
+                slice_length,
+                number);
+    }
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "buffer length incorrectly calculated, not enough space!");
+        goto end;
+    }
+
+    return_result = true;
+
+end:
+
+    return return_result;
+}
+
+bool module_redis_connection_send_big_number(
+        module_redis_connection_context_t *connection_context,
+        char *big_number,
+        size_t big_number_length) {
+    bool return_result = false;
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 32;
+
+    if (unlikely(big_number_length > NETWORK_CHANNEL_MAX_PACKET_SIZE - slice_length)) {
+        LOG_E(TAG, "Big number too long, the max length is %lu", NETWORK_CHANNEL_MAX_PACKET_SIZE - slice_length);
+        goto end;
+    }
+
+    slice_length += big_number_length;
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        goto end;
+    }
+
+    // With RESP2 the big numbers are sent as blob strings
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        send_buffer_start = protocol_redis_writer_write_blob_string(
+                send_buffer_start,
+                slice_length,
+                big_number,
+                (int)big_number_length);
+    } else {
+        send_buffer_start = protocol_redis_writer_write_big_number(
+                send_buffer_start,
+                slice_length,
+                big_number,
+                (int)big_number_length);
+    }
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "buffer length incorrectly calculated, not enough space!");
+        goto end;
+    }
+
+    return_result = true;
+
+end:
+
+    return return_result;
+}
+
+bool module_redis_connection_send_boolean(
+        module_redis_connection_context_t *connection_context,
+        bool is_true) {
+    bool return_result = false;
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 16;
+
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        goto end;
+    }
+
+    // With RESP2 the booleans are sent as numbers
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        send_buffer_start = protocol_redis_writer_write_number(
+                send_buffer_start,
+                slice_length,
+                is_true ? 1 : 0);
+    } else {
+        send_buffer_start = protocol_redis_writer_write_boolean(
+                send_buffer_start,
+                slice_length,
+                is_true);
+    }
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "buffer length incorrectly calculated, not enough space!");
+        goto end;
+    }
+
+    return_result = true;
+
+end:
+
+    return return_result;
+}
+
+bool module_redis_connection_send_ok(
+        module_redis_connection_context_t *connection_context) {
+    bool return_result = false;
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 16;
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        goto end;
+    }
+
+    send_buffer_start = protocol_redis_writer_write_ok(
+            send_buffer_start,
+            slice_length);
 
     network_send_buffer_release_slice(
             connection_context->network_channel,
@@ -382,6 +607,35 @@ bool module_redis_connection_send_string_null(
     return true;
 }
 
+bool module_redis_connection_send_array_null(
+        module_redis_connection_context_t *connection_context) {
+    network_channel_buffer_data_t *send_buffer, *send_buffer_start;
+    size_t slice_length = 16;
+    send_buffer = send_buffer_start = network_send_buffer_acquire_slice(
+            connection_context->network_channel,
+            slice_length);
+    if (send_buffer_start == NULL) {
+        LOG_E(TAG, "Unable to acquire send buffer slice!");
+        return false;
+    }
+
+    if (connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        send_buffer_start = protocol_redis_writer_write_array_null(
+                send_buffer_start,
+                slice_length);
+    } else {
+        send_buffer_start = protocol_redis_writer_write_null(
+                send_buffer_start,
+                slice_length);
+    }
+
+    network_send_buffer_release_slice(
+            connection_context->network_channel,
+            send_buffer_start ? send_buffer_start - send_buffer : 0);
+
+    return true;
+}
+
 bool module_redis_connection_send_blob_string(
         module_redis_connection_context_t *connection_context,
         char *string,
@@ -14,6 +14,9 @@ void module_redis_connection_context_init(
 void module_redis_connection_context_cleanup(
         module_redis_connection_context_t *connection_context);
 
+void module_redis_connection_context_reset_command(
+        module_redis_connection_context_t *connection_context);
+
 void module_redis_connection_context_reset(
         module_redis_connection_context_t *connection_context);
 
@@ -58,12 +61,40 @@ bool module_redis_connection_send_array_header(
         module_redis_connection_context_t *connection_context,
         uint64_t array_length);
 
+bool module_redis_connection_send_map_header(
+        module_redis_connection_context_t *connection_context,
+        uint64_t items_count);
+
+bool module_redis_connection_send_set_header(
+        module_redis_connection_context_t *connection_context,
+        uint64_t set_length);
+
+bool module_redis_connection_send_push_header(
+        module_redis_connection_context_t *connection_context,
+        uint64_t messages_count);
+
+bool module_redis_connection_send_double(
+        module_redis_connection_context_t *connection_context,
+        double number);
+
+bool module_redis_connection_send_big_number(
+        module_redis_connection_context_t *connection_context,
+        char *big_number,
+        size_t big_number_length);
+
+bool module_redis_connection_send_boolean(
+        module_redis_connection_context_t *connection_context,
+        bool is_true);
+
 bool module_redis_connection_send_ok(
         module_redis_connection_context_t *connection_context);
 
 bool module_redis_connection_send_string_null(
         module_redis_connection_context_t *connection_context);
 
+bool module_redis_connection_send_array_null(
+        module_redis_connection_context_t *connection_context);
+
 bool module_redis_connection_send_blob_string(
         module_redis_connection_context_t *connection_context,
         char *string,
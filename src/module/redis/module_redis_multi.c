@@ -0,0 +1,562 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "config.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+
+#include "module_redis_multi.h"
+
+#define TAG "module_redis_multi"
+
+static module_redis_multi_t *module_redis_multi_get_or_new(
+        module_redis_connection_context_t *connection_context) {
+    if (likely(connection_context->multi != NULL)) {
+        return connection_context->multi;
+    }
+
+    connection_context->multi = ffma_mem_alloc_zero(sizeof(module_redis_multi_t));
+
+    return connection_context->multi;
+}
+
+static bool module_redis_multi_list_ensure_space(
+        void **list,
+        uint32_t count,
+        uint32_t *size,
+        size_t item_size) {
+    uint32_t size_new;
+
+    if (likely(count < *size)) {
+        return true;
+    }
+
+    size_new = *size == 0 ? MODULE_REDIS_MULTI_LIST_INITIAL_SIZE : *size * 2;
+
+    if (*list == NULL) {
+        *list = ffma_mem_alloc(item_size * size_new);
+    } else {
+        *list = ffma_mem_realloc(*list, item_size * *size, item_size * size_new, false);
+    }
+
+    if (*list == NULL) {
+        *size = 0;
+        return false;
+    }
+
+    *size = size_new;
+
+    return true;
+}
+
+static bool module_redis_multi_keys_append(
+        storage_db_key_and_key_length_t **keys,
+        uint32_t *keys_count,
+        uint32_t *keys_size,
+        char *key,
+        size_t key_length) {
+    if (unlikely(!module_redis_multi_list_ensure_space(
+            (void**)keys,
+            *keys_count,
+            keys_size,
+            sizeof(storage_db_key_and_key_length_t)))) {
+        return false;
+    }
+
+    (*keys)[*keys_count].key = key;
+    (*keys)[*keys_count].key_size = key_length;
+    (*keys_count)++;
+
+    return true;
+}
+
+typedef struct module_redis_multi_collect_keys module_redis_multi_collect_keys_t;
+struct module_redis_multi_collect_keys {
+    storage_db_key_and_key_length_t **keys;
+    uint32_t *keys_count;
+    uint32_t *keys_size;
+};
+
+static bool module_redis_multi_collect_arguments_keys_append(
+        void *user_data,
+        char *key,
+        size_t key_length) {
+    module_redis_multi_collect_keys_t *collect_keys = user_data;
+
+    return module_redis_multi_keys_append(
+            collect_keys->keys,
+            collect_keys->keys_count,
+            collect_keys->keys_size,
+            key,
+            key_length);
+}
+
+static bool module_redis_multi_collect_arguments_keys(
+        module_redis_command_argument_t *arguments,
+        uint16_t arguments_count,
+        uintptr_t argument_context_base_addr,
+        storage_db_key_and_key_length_t **keys,
+        uint32_t *keys_count,
+        uint32_t *keys_size) {
+    // The keys stored in the context of the command are collected without being copied
+    module_redis_multi_collect_keys_t collect_keys = {
+            .keys = keys,
+            .keys_count = keys_count,
+            .keys_size = keys_size,
+    };
+
+    return module_redis_command_iterate_arguments_keys(
+            arguments,
+            arguments_count,
+            argument_context_base_addr,
+            module_redis_multi_collect_arguments_keys_append,
+            &collect_keys);
+}
+
+static void module_redis_multi_command_free(
+        module_redis_connection_context_t *connection_context,
+        module_redis_multi_command_t *command) {
+    module_redis_command_info_t *current_command_info = connection_context->command.info;
+    module_redis_command_context_t *current_command_context = connection_context->command.context;
+
+    // The command free callbacks operate on the command set in the connection context
+    connection_context->command.info = command->info;
+    connection_context->command.context = command->context;
+    module_redis_command_process_try_free(connection_context);
+
+    connection_context->command.info = current_command_info;
+    connection_context->command.context = current_command_context;
+
+    command->context = NULL;
+}
+
+static void module_redis_multi_discard_commands(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_multi_t *multi = connection_context->multi;
+
+    for(uint32_t index = 0; index < multi->commands.count; index++) {
+        module_redis_multi_command_free(connection_context, &multi->commands.list[index]);
+    }
+
+    multi->commands.count = 0;
+    multi->queuing = false;
+    multi->aborted = false;
+}
+
+static bool module_redis_multi_command_is_queueable(
+        module_redis_command_info_t *command_info) {
+    switch(command_info->command) {
+        case MODULE_REDIS_COMMAND_EXEC:
+        case MODULE_REDIS_COMMAND_DISCARD:
+        case MODULE_REDIS_COMMAND_MULTI:
+        case MODULE_REDIS_COMMAND_WATCH:
+        case MODULE_REDIS_COMMAND_QUIT:
+            return false;
+        default:
+            return true;
+    }
+}
+
+bool module_redis_multi_begin(
+        module_redis_connection_context_t *connection_context) {
+    if (module_redis_multi_is_queuing(connection_context)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR MULTI calls can not be nested");
+    }
+
+    if (unlikely(module_redis_multi_get_or_new(connection_context) == NULL)) {
+        LOG_E(TAG, "Unable to allocate the transaction context");
+        return false;
+    }
+
+    connection_context->multi->queuing = true;
+    connection_context->multi->aborted = false;
+    connection_context->multi->executed = false;
+
+    return module_redis_connection_send_ok(connection_context);
+}
+
+bool module_redis_multi_process_end(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_multi_t *multi = connection_context->multi;
+
+    if (!module_redis_multi_command_is_queueable(connection_context->command.info)) {
+        return module_redis_command_process_end(connection_context);
+    }
+
+    if (unlikely(!module_redis_command_process_end_has_all_arguments(connection_context))) {
+        return !module_redis_connection_should_terminate_connection(connection_context);
+    }
+
+    if (unlikely(!module_redis_multi_list_ensure_space(
+            (void**)&multi->commands.list,
+            multi->commands.count,
+            &multi->commands.size,
+            sizeof(module_redis_multi_command_t)))) {
+        LOG_E(TAG, "Unable to allocate the list of the queued commands");
+        return false;
+    }
+
+    // The context is now owned by the queued command, it's not freed at the end of the command
+    multi->commands.list[multi->commands.count].info = connection_context->command.info;
+    multi->commands.list[multi->commands.count].context = connection_context->command.context;
+    multi->commands.list[multi->commands.count].arguments_count = connection_context->command.arguments_count;
+    multi->commands.count++;
+
+    connection_context->command.context = NULL;
+
+    return module_redis_connection_send_simple_string(connection_context, "QUEUED", strlen("QUEUED"));
+}
+
+void module_redis_multi_command_failed(
+        module_redis_connection_context_t *connection_context) {
+    // The errors reported by the commands that aren't queued (e.g. nested MULTI) don't abort the transaction
+    if (connection_context->command.info != NULL &&
+        !module_redis_multi_command_is_queueable(connection_context->command.info)) {
+        return;
+    }
+
+    connection_context->multi->aborted = true;
+}
+
+bool module_redis_multi_exec(
+        module_redis_connection_context_t *connection_context) {
+    bool return_res = false;
+    bool transaction_acquired = false;
+    uint32_t keys_count = 0, keys_size = 0;
+    storage_db_key_and_key_length_t *keys = NULL;
+    transaction_t transaction = { 0 };
+    network_channel_t *network_channel = connection_context->network_channel;
+    network_channel_t replies_network_channel = { 0 };
+    module_redis_multi_t *multi = connection_context->multi;
+    module_redis_command_info_t *exec_command_info = connection_context->command.info;
+    module_redis_command_context_t *exec_command_context = connection_context->command.context;
+    uint32_t exec_arguments_count = connection_context->command.arguments_count;
+
+    if (!module_redis_multi_is_queuing(connection_context)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR EXEC without MULTI");
+    }
+
+    multi->queuing = false;
+
+    if (unlikely(multi->aborted)) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "EXECABORT Transaction discarded because of previous errors.");
+        goto end;
+    }
+
+    // Collect the keys of the watched keys and of the queued commands, the chunks of all of them are locked upfront
+    for(uint32_t index = 0; index < multi->watched_keys.count; index++) {
+        if (unlikely(!module_redis_multi_keys_append(
+                &keys,
+                &keys_count,
+                &keys_size,
+                multi->watched_keys.list[index].key,
+                multi->watched_keys.list[index].key_length))) {
+            goto end;
+        }
+    }
+
+    for(uint32_t index = 0; index < multi->commands.count; index++) {
+        module_redis_multi_command_t *command = &multi->commands.list[index];
+
+        if (command->context == NULL) {
+            continue;
+        }
+
+        if (unlikely(!module_redis_multi_collect_arguments_keys(
+                command->info->arguments,
+                command->info->arguments_count,
+                (uintptr_t)command->context,
+                &keys,
+                &keys_count,
+                &keys_size))) {
+            goto end;
+        }
+    }
+
+    transaction_acquire(&transaction);
+    transaction_acquired = true;
+
+    if (keys_count > 0 && unlikely(!storage_db_op_lock_keys(
+            connection_context->db,
+            &transaction,
+            keys,
+            keys_count))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR unable to lock the keys of the transaction");
+        goto end;
+    }
+
+    // The replies are collected by a capture channel and sent once the locks are released, sending them while the keys
+    // are locked could yield waiting for the client to read them and keep the other workers waiting on the locks
+    network_channel_init(NETWORK_CHANNEL_TYPE_CAPTURE, &replies_network_channel);
+    replies_network_channel.module_config = network_channel->module_config;
+    connection_context->network_channel = &replies_network_channel;
+
+    // If any of the watched keys has been changed the transaction is not executed
+    for(uint32_t index = 0; index < multi->watched_keys.count; index++) {
+        storage_db_key_version_t key_version = { 0 };
+        module_redis_multi_watched_key_t *watched_key = &multi->watched_keys.list[index];
+
+        storage_db_op_get_key_version(
+                connection_context->db,
+                watched_key->key,
+                watched_key->key_length,
+                &key_version);
+
+        if (!storage_db_key_version_equals(&watched_key->key_version, &key_version)) {
+            return_res = module_redis_connection_send_array_null(connection_context);
+            goto end;
+        }
+    }
+
+    if (unlikely(!module_redis_connection_send_array_header(connection_context, multi->commands.count))) {
+        goto end;
+    }
+
+    // The commands are executed in child transactions sharing the id of the one holding the locks
+    transaction_set_parent_transaction(&transaction);
+    multi->executed = true;
+
+    return_res = true;
+    for(uint32_t index = 0; index < multi->commands.count && return_res; index++) {
+        module_redis_multi_command_t *command = &multi->commands.list[index];
+
+        connection_context->command.info = command->info;
+        connection_context->command.context = command->context;
+        connection_context->command.arguments_count = command->arguments_count;
+
+        return_res = command->info->command_end_funcptr(connection_context);
+
+        // The errors are sent as the reply of the command, the execution continues with the next one
+        if (return_res && module_redis_connection_has_error(connection_context)) {
+            return_res = module_redis_connection_send_error(connection_context);
+        }
+
+        connection_context->command.skip = false;
+        module_redis_command_process_try_free(connection_context);
+        command->context = NULL;
+    }
+
+    transaction_set_parent_transaction(NULL);
+
+end:
+
+    if (transaction_acquired) {
+        transaction_release(&transaction);
+    }
+
+    if (connection_context->network_channel != network_channel) {
+        connection_context->network_channel = network_channel;
+
+        // Moves what is left in the send buffer in the capture buffer and sends the whole reply to the client
+        if (unlikely(network_flush_send_buffer(&replies_network_channel) != NETWORK_OP_RESULT_OK)) {
+            return_res = false;
+        } else if (replies_network_channel.buffers.capture.data_size > 0 && unlikely(network_send_direct(
+                network_channel,
+                replies_network_channel.buffers.capture.data,
+                replies_network_channel.buffers.capture.data_size) != NETWORK_OP_RESULT_OK)) {
+            return_res = false;
+        }
+
+        network_channel_cleanup(&replies_network_channel);
+    }
+
+    connection_context->command.info = exec_command_info;
+    connection_context->command.context = exec_command_context;
+    connection_context->command.arguments_count = exec_arguments_count;
+
+    module_redis_multi_discard_commands(connection_context);
+    module_redis_multi_unwatch(connection_context);
+
+    if (keys) {
+        ffma_mem_free(keys);
+    }
+
+    return return_res;
+}
+
+bool module_redis_multi_discard(
+        module_redis_connection_context_t *connection_context) {
+    if (!module_redis_multi_is_queuing(connection_context)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR DISCARD without MULTI");
+    }
+
+    module_redis_multi_discard_commands(connection_context);
+    module_redis_multi_unwatch(connection_context);
+
+    return module_redis_connection_send_ok(connection_context);
+}
+
+bool module_redis_multi_watch(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *keys,
+        uint32_t keys_count) {
+    bool return_res = false;
+    transaction_t transaction = { 0 };
+    module_redis_multi_t *multi;
+    storage_db_key_and_key_length_t *db_keys = NULL;
+
+    if (module_redis_multi_is_queuing(connection_context)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR WATCH inside MULTI is not allowed");
+    }
+
+    if (unlikely((multi = module_redis_multi_get_or_new(connection_context)) == NULL)) {
+        LOG_E(TAG, "Unable to allocate the transaction context");
+        return false;
+    }
+
+    if (unlikely((db_keys = ffma_mem_alloc(sizeof(storage_db_key_and_key_length_t) * keys_count)) == NULL)) {
+        return false;
+    }
+
+    for(uint32_t index = 0; index < keys_count; index++) {
+        db_keys[index].key = keys[index].key;
+        db_keys[index].key_size = keys[index].length;
+    }
+
+    // The versions are read holding the locks of the chunks to avoid reading them while a key is being updated
+    transaction_acquire(&transaction);
+
+    if (unlikely(!storage_db_op_lock_keys(connection_context->db, &transaction, db_keys, keys_count))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR unable to lock the keys to watch");
+        goto end;
+    }
+
+    for(uint32_t index = 0; index < keys_count; index++) {
+        bool already_watched = false;
+        module_redis_multi_watched_key_t *watched_key;
+
+        for(uint32_t watched_key_index = 0; watched_key_index < multi->watched_keys.count; watched_key_index++) {
+            watched_key = &multi->watched_keys.list[watched_key_index];
+            if (watched_key->key_length == keys[index].length &&
+                memcmp(watched_key->key, keys[index].key, keys[index].length) == 0) {
+                already_watched = true;
+                break;
+            }
+        }
+
+        if (already_watched) {
+            continue;
+        }
+
+        if (unlikely(!module_redis_multi_list_ensure_space(
+                (void**)&multi->watched_keys.list,
+                multi->watched_keys.count,
+                &multi->watched_keys.size,
+                sizeof(module_redis_multi_watched_key_t)))) {
+            LOG_E(TAG, "Unable to allocate the list of the watched keys");
+            goto end;
+        }
+
+        watched_key = &multi->watched_keys.list[multi->watched_keys.count];
+        if (unlikely((watched_key->key = ffma_mem_alloc(keys[index].length)) == NULL)) {
+            goto end;
+        }
+
+        memcpy(watched_key->key, keys[index].key, keys[index].length);
+        watched_key->key_length = keys[index].length;
+
+        storage_db_op_get_key_version(
+                connection_context->db,
+                watched_key->key,
+                watched_key->key_length,
+                &watched_key->key_version);
+
+        multi->watched_keys.count++;
+    }
+
+    return_res = module_redis_connection_send_ok(connection_context);
+
+end:
+    transaction_release(&transaction);
+    ffma_mem_free(db_keys);
+
+    return return_res;
+}
+
+void module_redis_multi_unwatch(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_multi_t *multi = connection_context->multi;
+
+    if (multi == NULL) {
+        return;
+    }
+
+    for(uint32_t index = 0; index < multi->watched_keys.count; index++) {
+        ffma_mem_free(multi->watched_keys.list[index].key);
+    }
+
+    multi->watched_keys.count = 0;
+}
+
+void module_redis_multi_free(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_multi_t *multi = connection_context->multi;
+
+    if (likely(multi == NULL)) {
+        return;
+    }
+
+    module_redis_multi_discard_commands(connection_context);
+    module_redis_multi_unwatch(connection_context);
+
+    if (multi->commands.list) {
+        ffma_mem_free(multi->commands.list);
+    }
+
+    if (multi->watched_keys.list) {
+        ffma_mem_free(multi->watched_keys.list);
+    }
+
+    ffma_mem_free(multi);
+    connection_context->multi = NULL;
+}
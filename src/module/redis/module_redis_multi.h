@@ -0,0 +1,85 @@
+#ifndef CACHEGRAND_MODULE_REDIS_MULTI_H
+#define CACHEGRAND_MODULE_REDIS_MULTI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The commands received after MULTI are parsed as usual but, instead of being executed, their contexts are queued and
+// executed by EXEC one after the other.
+// Before executing them, EXEC locks in ascending order the hashtable chunks of all the watched keys and of all the
+// keys passed to the queued commands, the storage db operations carried out by the commands acquire child transactions
+// sharing the id of the EXEC one so they can operate on the chunks already locked while the other workers have to wait
+// for EXEC to complete. The parent transaction is set on the fiber running EXEC, and the replies are collected in a
+// capture channel and sent only once the locks are released, so nothing leaks to the other fibers if EXEC yields.
+// The watched keys are validated under the same locks comparing the changes counter of their chunk and their entry
+// index with the ones read when WATCH has been invoked, any change to the chunk is considered a change of the key.
+// Nothing is allocated until the connection invokes MULTI or WATCH.
+#define MODULE_REDIS_MULTI_LIST_INITIAL_SIZE 8
+
+typedef struct module_redis_multi_command module_redis_multi_command_t;
+struct module_redis_multi_command {
+    module_redis_command_info_t *info;
+    module_redis_command_context_t *context;
+    uint32_t arguments_count;
+};
+
+typedef struct module_redis_multi_watched_key module_redis_multi_watched_key_t;
+struct module_redis_multi_watched_key {
+    char *key;
+    size_t key_length;
+    storage_db_key_version_t key_version;
+};
+
+struct module_redis_multi {
+    bool queuing;
+    bool aborted;
+    bool executed;
+    struct {
+        module_redis_multi_command_t *list;
+        uint32_t count;
+        uint32_t size;
+    } commands;
+    struct {
+        module_redis_multi_watched_key_t *list;
+        uint32_t count;
+        uint32_t size;
+    } watched_keys;
+};
+
+static inline __attribute__((always_inline)) bool module_redis_multi_is_queuing(
+        module_redis_connection_context_t *connection_context) {
+    return unlikely(connection_context->multi != NULL) && connection_context->multi->queuing;
+}
+
+bool module_redis_multi_begin(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_multi_process_end(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_multi_command_failed(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_multi_exec(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_multi_discard(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_multi_watch(
+        module_redis_connection_context_t *connection_context,
+        module_redis_key_t *keys,
+        uint32_t keys_count);
+
+void module_redis_multi_unwatch(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_multi_free(
+        module_redis_connection_context_t *connection_context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_MULTI_H
@@ -0,0 +1,938 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "clock.h"
+#include "config.h"
+#include "utils_string.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+
+#include "module_redis_pubsub.h"
+
+#define TAG "module_redis_pubsub"
+
+static module_redis_pubsub_registry_t module_redis_pubsub_registry = { 0 };
+static thread_local module_redis_pubsub_worker_t *module_redis_pubsub_worker = NULL;
+
+static bool module_redis_pubsub_hashtable_set(
+        hashtable_spsc_t **hashtable,
+        char *key,
+        uint16_t key_length,
+        void *value) {
+    while(!hashtable_spsc_op_try_set_cs(*hashtable, key, key_length, value)) {
+        // The spsc hashtable can't grow, when the key can't be inserted the entries are moved in a bigger one
+        hashtable_spsc_t *hashtable_new = hashtable_spsc_upsize_cs(*hashtable);
+
+        if (unlikely(hashtable_new == NULL)) {
+            return false;
+        }
+
+        hashtable_spsc_free(*hashtable);
+        *hashtable = hashtable_new;
+    }
+
+    return true;
+}
+
+static module_redis_pubsub_registry_entry_t *module_redis_pubsub_registry_get_entry(
+        char *name,
+        size_t name_length,
+        bool is_pattern) {
+    module_redis_pubsub_registry_t *registry = &module_redis_pubsub_registry;
+
+    if (!is_pattern) {
+        return hashtable_spsc_op_get_cs(registry->channels, name, name_length);
+    }
+
+    DOUBLE_LINKED_LIST_ITER_FORWARD(registry->patterns, item, {
+        module_redis_pubsub_registry_entry_t *entry = item->data;
+        if (entry->name_length == name_length && memcmp(entry->name, name, name_length) == 0) {
+            return entry;
+        }
+    })
+
+    return NULL;
+}
+
+static bool module_redis_pubsub_registry_add(
+        char *name,
+        size_t name_length,
+        bool is_pattern,
+        uint32_t worker_index) {
+    module_redis_pubsub_registry_t *registry = &module_redis_pubsub_registry;
+    module_redis_pubsub_registry_entry_t *entry = module_redis_pubsub_registry_get_entry(
+            name,
+            name_length,
+            is_pattern);
+
+    if (!entry) {
+        // The registry is shared by all the workers and the entry can be freed by any of them, therefore the memory is
+        // allocated with xalloc
+        entry = xalloc_alloc_zero(
+                sizeof(module_redis_pubsub_registry_entry_t) + (sizeof(uint32_t) * registry->workers_count));
+        entry->name = xalloc_alloc(name_length);
+        entry->name_length = name_length;
+        memcpy(entry->name, name, name_length);
+
+        if (is_pattern) {
+            double_linked_list_item_t *item = double_linked_list_item_init();
+            item->data = entry;
+            double_linked_list_push_item(registry->patterns, item);
+        } else if (unlikely(!module_redis_pubsub_hashtable_set(
+                &registry->channels,
+                entry->name,
+                entry->name_length,
+                entry))) {
+            xalloc_free(entry->name);
+            xalloc_free(entry);
+            return false;
+        }
+    }
+
+    entry->subscribers_count++;
+    entry->workers_subscribers_count[worker_index]++;
+
+    return true;
+}
+
+static void module_redis_pubsub_registry_remove(
+        char *name,
+        size_t name_length,
+        bool is_pattern,
+        uint32_t worker_index,
+        uint32_t subscribers_count) {
+    module_redis_pubsub_registry_t *registry = &module_redis_pubsub_registry;
+    module_redis_pubsub_registry_entry_t *entry = module_redis_pubsub_registry_get_entry(
+            name,
+            name_length,
+            is_pattern);
+
+    assert(entry != NULL);
+    assert(entry->workers_subscribers_count[worker_index] >= subscribers_count);
+
+    entry->subscribers_count -= subscribers_count;
+    entry->workers_subscribers_count[worker_index] -= subscribers_count;
+
+    if (entry->subscribers_count > 0) {
+        return;
+    }
+
+    if (is_pattern) {
+        DOUBLE_LINKED_LIST_ITER_FORWARD(registry->patterns, item, {
+            if (item->data == entry) {
+                double_linked_list_remove_item(registry->patterns, item);
+                double_linked_list_item_free(item);
+                break;
+            }
+        })
+    } else {
+        hashtable_spsc_op_delete_cs(registry->channels, entry->name, entry->name_length);
+    }
+
+    xalloc_free(entry->name);
+    xalloc_free(entry);
+}
+
+static void module_redis_pubsub_registry_free() {
+    void *value;
+    hashtable_spsc_bucket_index_t bucket_index = 0;
+    module_redis_pubsub_registry_t *registry = &module_redis_pubsub_registry;
+
+    // When the last worker goes away all the subscriptions have already been removed, the loops below only take care
+    // of the entries that might have been left behind
+    while((value = hashtable_spsc_op_iter(registry->channels, &bucket_index)) != NULL) {
+        module_redis_pubsub_registry_entry_t *entry = value;
+        xalloc_free(entry->name);
+        xalloc_free(entry);
+        bucket_index++;
+    }
+    hashtable_spsc_free(registry->channels);
+
+    double_linked_list_item_t *item;
+    while((item = double_linked_list_pop_item(registry->patterns)) != NULL) {
+        module_redis_pubsub_registry_entry_t *entry = item->data;
+        xalloc_free(entry->name);
+        xalloc_free(entry);
+        double_linked_list_item_free(item);
+    }
+    double_linked_list_free(registry->patterns);
+
+    xalloc_free(registry->workers);
+    xalloc_free(registry->workers_targeted);
+
+    registry->channels = NULL;
+    registry->patterns = NULL;
+    registry->workers = NULL;
+    registry->workers_targeted = NULL;
+    registry->workers_count = 0;
+}
+
+module_redis_pubsub_message_t *module_redis_pubsub_message_new(
+        char *channel,
+        size_t channel_length,
+        size_t message_length) {
+    // The message is read by all the workers having subscribers and freed by the last one, therefore the memory is
+    // allocated with xalloc, the channel and the message are stored in the same allocation
+    module_redis_pubsub_message_t *message = xalloc_alloc(
+            sizeof(module_redis_pubsub_message_t) + channel_length + message_length);
+    if (!message) {
+        return NULL;
+    }
+
+    message->workers_count = 0;
+    message->channel = message->data;
+    message->channel_length = channel_length;
+    message->message = message->data + channel_length;
+    message->message_length = message_length;
+    memcpy(message->channel, channel, channel_length);
+
+    return message;
+}
+
+void module_redis_pubsub_message_free(
+        module_redis_pubsub_message_t *message) {
+    xalloc_free(message);
+}
+
+static void module_redis_pubsub_message_release(
+        module_redis_pubsub_message_t *message) {
+    if (__atomic_sub_fetch(&message->workers_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        module_redis_pubsub_message_free(message);
+    }
+}
+
+static void module_redis_pubsub_client_append_message(
+        module_redis_pubsub_client_t *client,
+        module_redis_pubsub_worker_entry_t *pattern_entry,
+        module_redis_pubsub_message_t *message) {
+    char *buffer, *buffer_start;
+    size_t buffer_length;
+
+    if (unlikely(client->pending_overflow)) {
+        return;
+    }
+
+    // The push header, the kind of message and the lengths of the strings take less than 64 bytes
+    size_t required_length =
+            64 +
+            message->channel_length + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH +
+            message->message_length + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH +
+            (pattern_entry ? pattern_entry->name_length + PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH : 0);
+
+    if (unlikely(client->pending.length + required_length > MODULE_REDIS_PUBSUB_CLIENT_PENDING_MAX_SIZE)) {
+        // The client is not reading the messages fast enough, the connection will be closed by its fiber
+        client->pending_overflow = true;
+        network_receive_interrupt(client->connection_context->network_channel);
+        return;
+    }
+
+    if (client->pending.length + required_length > client->pending.size) {
+        size_t new_size = MAX(client->pending.size * 2, MODULE_REDIS_PUBSUB_CLIENT_PENDING_MIN_SIZE);
+        while(new_size < client->pending.length + required_length) {
+            new_size *= 2;
+        }
+
+        client->pending.data = xalloc_realloc(client->pending.data, new_size);
+        client->pending.size = new_size;
+    }
+
+    buffer = buffer_start = client->pending.data + client->pending.length;
+    buffer_length = client->pending.size - client->pending.length;
+
+    if (client->connection_context->resp_version == PROTOCOL_REDIS_RESP_VERSION_2) {
+        buffer = protocol_redis_writer_write_array(buffer, buffer_length, pattern_entry ? 4 : 3);
+    } else {
+        buffer = protocol_redis_writer_write_push(buffer, buffer_length, pattern_entry ? 4 : 3);
+    }
+
+    if (pattern_entry) {
+        buffer = protocol_redis_writer_write_blob_string(
+                buffer,
+                buffer_length - (buffer - buffer_start),
+                "pmessage",
+                strlen("pmessage"));
+        buffer = protocol_redis_writer_write_blob_string(
+                buffer,
+                buffer_length - (buffer - buffer_start),
+                pattern_entry->name,
+                (int)pattern_entry->name_length);
+    } else {
+        buffer = protocol_redis_writer_write_blob_string(
+                buffer,
+                buffer_length - (buffer - buffer_start),
+                "message",
+                strlen("message"));
+    }
+
+    buffer = protocol_redis_writer_write_blob_string(
+            buffer,
+            buffer_length - (buffer - buffer_start),
+            message->channel,
+            (int)message->channel_length);
+    buffer = protocol_redis_writer_write_blob_string(
+            buffer,
+            buffer_length - (buffer - buffer_start),
+            message->message,
+            (int)message->message_length);
+
+    assert(buffer != NULL);
+    client->pending.length += buffer - buffer_start;
+
+    // If the fiber of the client is waiting for data, the receive is interrupted to let it send the pending messages
+    network_receive_interrupt(client->connection_context->network_channel);
+}
+
+static void module_redis_pubsub_worker_deliver(
+        module_redis_pubsub_worker_t *worker,
+        module_redis_pubsub_message_t *message) {
+    module_redis_pubsub_worker_entry_t *channel_entry = hashtable_spsc_op_get_cs(
+            worker->channels,
+            message->channel,
+            message->channel_length);
+
+    if (channel_entry) {
+        DOUBLE_LINKED_LIST_ITER_FORWARD(channel_entry->clients, item, {
+            module_redis_pubsub_client_append_message(item->data, NULL, message);
+        })
+    }
+
+    DOUBLE_LINKED_LIST_ITER_FORWARD(worker->patterns, pattern_item, {
+        module_redis_pubsub_worker_entry_t *pattern_entry = pattern_item->data;
+
+        if (utils_string_glob_match(
+                message->channel,
+                message->channel_length,
+                pattern_entry->name,
+                pattern_entry->name_length)) {
+            DOUBLE_LINKED_LIST_ITER_FORWARD(pattern_entry->clients, item, {
+                module_redis_pubsub_client_append_message(item->data, pattern_entry, message);
+            })
+        }
+    })
+}
+
+static void module_redis_pubsub_worker_process_queue(
+        module_redis_pubsub_worker_t *worker,
+        bool deliver) {
+    // The messages are fetched all together, with a single atomic operation, and in the same order they were pushed
+    queue_mpmc_node_t *node = queue_mpmc_pop_all(worker->queue);
+
+    while(node != NULL) {
+        queue_mpmc_node_t *node_next = node->next;
+        module_redis_pubsub_message_t *message = node->data;
+
+        if (likely(deliver)) {
+            module_redis_pubsub_worker_deliver(worker, message);
+        }
+
+        module_redis_pubsub_message_release(message);
+        queue_mpmc_node_free(node);
+        node = node_next;
+    }
+}
+
+static void module_redis_pubsub_worker_delivery_fiber_entrypoint(
+        void *user_data) {
+    module_redis_pubsub_worker_t *worker = user_data;
+
+    // The fiber terminates when there are no more clients subscribed on the worker, the publishers stop to push
+    // messages on the queue as soon as the subscriptions are removed from the registry so the last messages are
+    // processed before terminating
+    do {
+        bool timer_res = worker_op_timer(0, MODULE_REDIS_PUBSUB_DELIVERY_FIBER_WAIT_NS);
+        module_redis_pubsub_worker_process_queue(worker, true);
+
+        if (unlikely(!timer_res)) {
+            break;
+        }
+    } while(worker->clients_count > 0);
+
+    worker->delivery_fiber_running = false;
+    fiber_scheduler_terminate_current_fiber();
+}
+
+static module_redis_pubsub_worker_t *module_redis_pubsub_worker_get_or_create() {
+    module_redis_pubsub_registry_t *registry = &module_redis_pubsub_registry;
+    worker_context_t *worker_context;
+    module_redis_pubsub_worker_t *worker;
+
+    if (likely(module_redis_pubsub_worker)) {
+        return module_redis_pubsub_worker;
+    }
+
+    worker_context = worker_context_get();
+
+    worker = xalloc_alloc_zero(sizeof(module_redis_pubsub_worker_t));
+    worker->worker_index = worker_context->worker_index;
+    worker->queue = queue_mpmc_init();
+    worker->channels = hashtable_spsc_new(
+            MODULE_REDIS_PUBSUB_HASHTABLE_INITIAL_BUCKETS_COUNT,
+            HASHTABLE_SPSC_DEFAULT_MAX_RANGE,
+            false,
+            false);
+    worker->patterns = double_linked_list_init();
+
+    spinlock_lock(&registry->lock);
+
+    // The registry is allocated by the first worker that has a subscriber and freed by the last one terminating
+    if (registry->workers == NULL) {
+        registry->workers_count = worker_context->workers_count;
+        registry->workers = xalloc_alloc_zero(sizeof(module_redis_pubsub_worker_t*) * registry->workers_count);
+        registry->workers_targeted = xalloc_alloc_zero(sizeof(bool) * registry->workers_count);
+        registry->channels = hashtable_spsc_new(
+                MODULE_REDIS_PUBSUB_HASHTABLE_INITIAL_BUCKETS_COUNT,
+                HASHTABLE_SPSC_DEFAULT_MAX_RANGE,
+                false,
+                false);
+        registry->patterns = double_linked_list_init();
+    }
+
+    assert(worker->worker_index < registry->workers_count);
+    registry->workers[worker->worker_index] = worker;
+    registry->workers_registered_count++;
+
+    spinlock_unlock(&registry->lock);
+
+    module_redis_pubsub_worker = worker;
+
+    return worker;
+}
+
+static void module_redis_pubsub_worker_entry_free(
+        module_redis_pubsub_worker_entry_t *entry) {
+    double_linked_list_item_t *item;
+    while((item = double_linked_list_pop_item(entry->clients)) != NULL) {
+        double_linked_list_item_free(item);
+    }
+
+    double_linked_list_free(entry->clients);
+    ffma_mem_free(entry->name);
+    ffma_mem_free(entry);
+}
+
+static module_redis_pubsub_worker_entry_t *module_redis_pubsub_worker_get_entry(
+        module_redis_pubsub_worker_t *worker,
+        char *name,
+        size_t name_length,
+        bool is_pattern) {
+    if (!is_pattern) {
+        return hashtable_spsc_op_get_cs(worker->channels, name, name_length);
+    }
+
+    DOUBLE_LINKED_LIST_ITER_FORWARD(worker->patterns, item, {
+        module_redis_pubsub_worker_entry_t *entry = item->data;
+        if (entry->name_length == name_length && memcmp(entry->name, name, name_length) == 0) {
+            return entry;
+        }
+    })
+
+    return NULL;
+}
+
+void module_redis_pubsub_worker_cleanup() {
+    void *value;
+    double_linked_list_item_t *item;
+    hashtable_spsc_bucket_index_t bucket_index = 0;
+    module_redis_pubsub_registry_t *registry = &module_redis_pubsub_registry;
+    module_redis_pubsub_worker_t *worker = module_redis_pubsub_worker;
+
+    if (!worker) {
+        return;
+    }
+
+    // Remove the subscribers of the worker from the registry, the clients are not going to be resumed anymore
+    spinlock_lock(&registry->lock);
+
+    while((value = hashtable_spsc_op_iter(worker->channels, &bucket_index)) != NULL) {
+        module_redis_pubsub_worker_entry_t *entry = value;
+        module_redis_pubsub_registry_remove(
+                entry->name,
+                entry->name_length,
+                false,
+                worker->worker_index,
+                entry->clients->count);
+        bucket_index++;
+    }
+
+    DOUBLE_LINKED_LIST_ITER_FORWARD(worker->patterns, pattern_item, {
+        module_redis_pubsub_worker_entry_t *entry = pattern_item->data;
+        module_redis_pubsub_registry_remove(
+                entry->name,
+                entry->name_length,
+                true,
+                worker->worker_index,
+                entry->clients->count);
+    })
+
+    registry->workers[worker->worker_index] = NULL;
+    registry->workers_registered_count--;
+
+    if (registry->workers_registered_count == 0) {
+        module_redis_pubsub_registry_free();
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    // No publisher can push new messages in the queue, the ones left are dropped
+    module_redis_pubsub_worker_process_queue(worker, false);
+    queue_mpmc_free(worker->queue);
+
+    bucket_index = 0;
+    while((value = hashtable_spsc_op_iter(worker->channels, &bucket_index)) != NULL) {
+        module_redis_pubsub_worker_entry_free(value);
+        bucket_index++;
+    }
+    hashtable_spsc_free(worker->channels);
+
+    while((item = double_linked_list_pop_item(worker->patterns)) != NULL) {
+        module_redis_pubsub_worker_entry_free(item->data);
+        double_linked_list_item_free(item);
+    }
+    double_linked_list_free(worker->patterns);
+
+    xalloc_free(worker);
+    module_redis_pubsub_worker = NULL;
+}
+
+uint64_t module_redis_pubsub_publish(
+        module_redis_pubsub_message_t *message) {
+    uint64_t receivers_count = 0;
+    uint32_t workers_targeted_count = 0;
+    bool deliver_locally = false;
+    module_redis_pubsub_registry_t *registry = &module_redis_pubsub_registry;
+    uint32_t worker_index = worker_context_get()->worker_index;
+
+    spinlock_lock(&registry->lock);
+
+    // If no worker has ever had a subscriber there is nothing to do
+    if (registry->workers != NULL) {
+        memset(registry->workers_targeted, 0, sizeof(bool) * registry->workers_count);
+
+        module_redis_pubsub_registry_entry_t *channel_entry = hashtable_spsc_op_get_cs(
+                registry->channels,
+                message->channel,
+                message->channel_length);
+        if (channel_entry) {
+            receivers_count += channel_entry->subscribers_count;
+            for(uint32_t index = 0; index < registry->workers_count; index++) {
+                registry->workers_targeted[index] |= channel_entry->workers_subscribers_count[index] > 0;
+            }
+        }
+
+        DOUBLE_LINKED_LIST_ITER_FORWARD(registry->patterns, item, {
+            module_redis_pubsub_registry_entry_t *pattern_entry = item->data;
+
+            if (utils_string_glob_match(
+                    message->channel,
+                    message->channel_length,
+                    pattern_entry->name,
+                    pattern_entry->name_length)) {
+                receivers_count += pattern_entry->subscribers_count;
+                for(uint32_t index = 0; index < registry->workers_count; index++) {
+                    registry->workers_targeted[index] |= pattern_entry->workers_subscribers_count[index] > 0;
+                }
+            }
+        })
+
+        for(uint32_t index = 0; index < registry->workers_count; index++) {
+            workers_targeted_count += registry->workers_targeted[index] ? 1 : 0;
+        }
+
+        // The reference counter has to be set before the message is pushed on the queues, a worker might process it
+        // right away
+        message->workers_count = workers_targeted_count;
+
+        for(uint32_t index = 0; index < registry->workers_count; index++) {
+            if (!registry->workers_targeted[index]) {
+                continue;
+            }
+
+            if (index == worker_index) {
+                deliver_locally = true;
+                continue;
+            }
+
+            if (unlikely(!queue_mpmc_push(registry->workers[index]->queue, message))) {
+                LOG_E(TAG, "Unable to push the message on the queue of the worker <%u>", index);
+                module_redis_pubsub_message_release(message);
+            }
+        }
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    if (deliver_locally) {
+        // The subscribers on the same worker get the message right away
+        module_redis_pubsub_worker_deliver(module_redis_pubsub_worker, message);
+        module_redis_pubsub_message_release(message);
+    } else if (workers_targeted_count == 0) {
+        module_redis_pubsub_message_free(message);
+    }
+
+    return receivers_count;
+}
+
+static module_redis_pubsub_client_t *module_redis_pubsub_client_get_or_create(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_pubsub_client_t *client = connection_context->pubsub_client;
+
+    if (likely(client)) {
+        return client;
+    }
+
+    client = ffma_mem_alloc_zero(sizeof(module_redis_pubsub_client_t));
+    client->connection_context = connection_context;
+    client->channels = double_linked_list_init();
+    client->patterns = double_linked_list_init();
+
+    connection_context->pubsub_client = client;
+
+    return client;
+}
+
+static double_linked_list_item_t *module_redis_pubsub_client_get_subscription_item(
+        module_redis_pubsub_client_t *client,
+        char *name,
+        size_t name_length,
+        bool is_pattern) {
+    double_linked_list_t *subscriptions = is_pattern ? client->patterns : client->channels;
+
+    DOUBLE_LINKED_LIST_ITER_FORWARD(subscriptions, item, {
+        module_redis_pubsub_client_subscription_t *subscription = item->data;
+        if (subscription->entry->name_length == name_length &&
+            memcmp(subscription->entry->name, name, name_length) == 0) {
+            return item;
+        }
+    })
+
+    return NULL;
+}
+
+uint32_t module_redis_pubsub_client_subscriptions_count(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_pubsub_client_t *client = connection_context->pubsub_client;
+
+    if (!client) {
+        return 0;
+    }
+
+    return client->channels->count + client->patterns->count;
+}
+
+bool module_redis_pubsub_client_subscribe(
+        module_redis_connection_context_t *connection_context,
+        char *name,
+        size_t name_length,
+        bool is_pattern) {
+    bool res;
+    module_redis_pubsub_client_t *client;
+    module_redis_pubsub_worker_t *worker;
+    module_redis_pubsub_worker_entry_t *entry;
+    module_redis_pubsub_client_subscription_t *subscription;
+    double_linked_list_item_t *subscription_item;
+
+    if (unlikely(name_length > UINT16_MAX)) {
+        return false;
+    }
+
+    client = module_redis_pubsub_client_get_or_create(connection_context);
+
+    // Subscribing again to the same channel or pattern is a no-op
+    if (module_redis_pubsub_client_get_subscription_item(client, name, name_length, is_pattern)) {
+        return true;
+    }
+
+    worker = module_redis_pubsub_worker_get_or_create();
+
+    spinlock_lock(&module_redis_pubsub_registry.lock);
+    res = module_redis_pubsub_registry_add(name, name_length, is_pattern, worker->worker_index);
+    spinlock_unlock(&module_redis_pubsub_registry.lock);
+
+    if (unlikely(!res)) {
+        return false;
+    }
+
+    entry = module_redis_pubsub_worker_get_entry(worker, name, name_length, is_pattern);
+    if (!entry) {
+        entry = ffma_mem_alloc_zero(sizeof(module_redis_pubsub_worker_entry_t));
+        entry->name = ffma_mem_alloc(name_length);
+        entry->name_length = name_length;
+        entry->clients = double_linked_list_init();
+        memcpy(entry->name, name, name_length);
+
+        if (is_pattern) {
+            double_linked_list_item_t *item = double_linked_list_item_init();
+            item->data = entry;
+            double_linked_list_push_item(worker->patterns, item);
+        } else if (unlikely(!module_redis_pubsub_hashtable_set(
+                &worker->channels,
+                entry->name,
+                entry->name_length,
+                entry))) {
+            module_redis_pubsub_worker_entry_free(entry);
+
+            spinlock_lock(&module_redis_pubsub_registry.lock);
+            module_redis_pubsub_registry_remove(name, name_length, is_pattern, worker->worker_index, 1);
+            spinlock_unlock(&module_redis_pubsub_registry.lock);
+
+            return false;
+        }
+    }
+
+    if (module_redis_pubsub_client_subscriptions_count(connection_context) == 0) {
+        worker->clients_count++;
+    }
+
+    subscription = ffma_mem_alloc(sizeof(module_redis_pubsub_client_subscription_t));
+    subscription->entry = entry;
+    subscription->entry_clients_item = double_linked_list_item_init();
+    subscription->entry_clients_item->data = client;
+    double_linked_list_push_item(entry->clients, subscription->entry_clients_item);
+
+    subscription_item = double_linked_list_item_init();
+    subscription_item->data = subscription;
+    double_linked_list_push_item(is_pattern ? client->patterns : client->channels, subscription_item);
+
+    if (!worker->delivery_fiber_running) {
+        worker->delivery_fiber_running = true;
+        fiber_scheduler_new_fiber(
+                "worker-redis-pubsub-delivery",
+                strlen("worker-redis-pubsub-delivery"),
+                module_redis_pubsub_worker_delivery_fiber_entrypoint,
+                worker);
+    }
+
+    return true;
+}
+
+bool module_redis_pubsub_client_unsubscribe(
+        module_redis_connection_context_t *connection_context,
+        char *name,
+        size_t name_length,
+        bool is_pattern) {
+    module_redis_pubsub_client_t *client = connection_context->pubsub_client;
+    module_redis_pubsub_worker_t *worker = module_redis_pubsub_worker;
+    module_redis_pubsub_client_subscription_t *subscription;
+    module_redis_pubsub_worker_entry_t *entry;
+    double_linked_list_item_t *subscription_item;
+
+    if (!client) {
+        return false;
+    }
+
+    subscription_item = module_redis_pubsub_client_get_subscription_item(client, name, name_length, is_pattern);
+    if (!subscription_item) {
+        return false;
+    }
+
+    subscription = subscription_item->data;
+    entry = subscription->entry;
+
+    // The registry is updated first as the name of the entry is needed to find the one in the registry
+    spinlock_lock(&module_redis_pubsub_registry.lock);
+    module_redis_pubsub_registry_remove(entry->name, entry->name_length, is_pattern, worker->worker_index, 1);
+    spinlock_unlock(&module_redis_pubsub_registry.lock);
+
+    double_linked_list_remove_item(entry->clients, subscription->entry_clients_item);
+    double_linked_list_item_free(subscription->entry_clients_item);
+
+    if (entry->clients->count == 0) {
+        if (is_pattern) {
+            DOUBLE_LINKED_LIST_ITER_FORWARD(worker->patterns, item, {
+                if (item->data == entry) {
+                    double_linked_list_remove_item(worker->patterns, item);
+                    double_linked_list_item_free(item);
+                    break;
+                }
+            })
+        } else {
+            hashtable_spsc_op_delete_cs(worker->channels, entry->name, entry->name_length);
+        }
+
+        module_redis_pubsub_worker_entry_free(entry);
+    }
+
+    double_linked_list_remove_item(is_pattern ? client->patterns : client->channels, subscription_item);
+    double_linked_list_item_free(subscription_item);
+    ffma_mem_free(subscription);
+
+    if (module_redis_pubsub_client_subscriptions_count(connection_context) == 0) {
+        worker->clients_count--;
+    }
+
+    return true;
+}
+
+char *module_redis_pubsub_client_get_first_subscription(
+        module_redis_connection_context_t *connection_context,
+        bool is_pattern,
+        size_t *name_length) {
+    module_redis_pubsub_client_t *client = connection_context->pubsub_client;
+    double_linked_list_t *subscriptions;
+
+    if (!client) {
+        return NULL;
+    }
+
+    subscriptions = is_pattern ? client->patterns : client->channels;
+    if (!subscriptions->head) {
+        return NULL;
+    }
+
+    module_redis_pubsub_client_subscription_t *subscription = subscriptions->head->data;
+    *name_length = subscription->entry->name_length;
+
+    return subscription->entry->name;
+}
+
+bool module_redis_pubsub_client_send_subscription_reply(
+        module_redis_connection_context_t *connection_context,
+        char *kind,
+        size_t kind_length,
+        char *name,
+        size_t name_length) {
+    if (unlikely(!module_redis_connection_send_push_header(connection_context, 3))) {
+        return false;
+    }
+
+    if (unlikely(!module_redis_connection_send_blob_string(connection_context, kind, kind_length))) {
+        return false;
+    }
+
+    if (name) {
+        if (unlikely(!module_redis_connection_send_blob_string(connection_context, name, name_length))) {
+            return false;
+        }
+    } else {
+        if (unlikely(!module_redis_connection_send_string_null(connection_context))) {
+            return false;
+        }
+    }
+
+    return module_redis_connection_send_number(
+            connection_context,
+            module_redis_pubsub_client_subscriptions_count(connection_context));
+}
+
+bool module_redis_pubsub_client_flush_pending(
+        module_redis_connection_context_t *connection_context) {
+    bool res;
+    char *pending_data;
+    size_t pending_length, pending_size;
+    module_redis_pubsub_client_t *client = connection_context->pubsub_client;
+
+    if (likely(!client)) {
+        return true;
+    }
+
+    if (unlikely(client->pending_overflow)) {
+        LOG_I(
+                TAG,
+                "[FD:%5d] Pending messages for client <%s> exceeded <%d> bytes, closing connection",
+                connection_context->network_channel->fd,
+                connection_context->network_channel->address.str,
+                MODULE_REDIS_PUBSUB_CLIENT_PENDING_MAX_SIZE);
+        return false;
+    }
+
+    if (client->pending.length == 0) {
+        return true;
+    }
+
+    // The pending buffer is detached from the client as sending the data may switch to other fibers that might append
+    // new messages
+    pending_data = client->pending.data;
+    pending_length = client->pending.length;
+    pending_size = client->pending.size;
+    client->pending.data = NULL;
+    client->pending.length = 0;
+    client->pending.size = 0;
+
+    res = network_send_buffered(
+            connection_context->network_channel,
+            pending_data,
+            pending_length) == NETWORK_OP_RESULT_OK;
+
+    if (likely(res)) {
+        res = network_flush_send_buffer(connection_context->network_channel) == NETWORK_OP_RESULT_OK;
+    }
+
+    // Re-use the buffer if no message has been appended in the meantime and if it hasn't grown too much
+    if (client->pending.data == NULL && pending_size <= MODULE_REDIS_PUBSUB_CLIENT_PENDING_MIN_SIZE * 16) {
+        client->pending.data = pending_data;
+        client->pending.size = pending_size;
+    } else {
+        xalloc_free(pending_data);
+    }
+
+    return res;
+}
+
+void module_redis_pubsub_client_free(
+        module_redis_connection_context_t *connection_context) {
+    char *name;
+    size_t name_length;
+    module_redis_pubsub_client_t *client = connection_context->pubsub_client;
+
+    if (likely(!client)) {
+        return;
+    }
+
+    while((name = module_redis_pubsub_client_get_first_subscription(connection_context, false, &name_length))) {
+        module_redis_pubsub_client_unsubscribe(connection_context, name, name_length, false);
+    }
+
+    while((name = module_redis_pubsub_client_get_first_subscription(connection_context, true, &name_length))) {
+        module_redis_pubsub_client_unsubscribe(connection_context, name, name_length, true);
+    }
+
+    if (client->pending.data) {
+        xalloc_free(client->pending.data);
+    }
+
+    double_linked_list_free(client->channels);
+    double_linked_list_free(client->patterns);
+    ffma_mem_free(client);
+
+    connection_context->pubsub_client = NULL;
+}
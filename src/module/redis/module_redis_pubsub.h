@@ -0,0 +1,139 @@
+#ifndef CACHEGRAND_MODULE_REDIS_PUBSUB_H
+#define CACHEGRAND_MODULE_REDIS_PUBSUB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The subscriptions are tracked at two levels:
+// - in a registry shared by all the workers, protected by a spinlock, that for each channel and pattern tracks how many
+//   clients are subscribed on each worker, PUBLISH uses it to know which workers have to receive the message and how
+//   many clients are going to receive it
+// - in each worker, that for each channel and pattern tracks the list of the local clients subscribed
+//
+// PUBLISH copies the message once and pushes it on the queue of each worker having at least one subscriber, the
+// delivery fiber of the worker then fans it out to the local clients, therefore a message costs O(workers) cross-thread
+// operations and not O(subscribers). The messages are serialized in a pending buffer of the client and the fiber of the
+// client, interrupted if it's waiting for data, moves the whole pending buffer in its send buffer in one go.
+#define MODULE_REDIS_PUBSUB_HASHTABLE_INITIAL_BUCKETS_COUNT 64
+#define MODULE_REDIS_PUBSUB_DELIVERY_FIBER_WAIT_NS (1 * 1000 * 1000)
+#define MODULE_REDIS_PUBSUB_CLIENT_PENDING_MIN_SIZE (4 * 1024)
+#define MODULE_REDIS_PUBSUB_CLIENT_PENDING_MAX_SIZE (32 * 1024 * 1024)
+
+typedef struct module_redis_pubsub_worker module_redis_pubsub_worker_t;
+
+typedef struct module_redis_pubsub_message module_redis_pubsub_message_t;
+struct module_redis_pubsub_message {
+    // Amount of workers still holding a reference to the message, the last one frees it
+    uint32_volatile_t workers_count;
+    char *channel;
+    size_t channel_length;
+    char *message;
+    size_t message_length;
+    char data[];
+};
+
+typedef struct module_redis_pubsub_registry_entry module_redis_pubsub_registry_entry_t;
+struct module_redis_pubsub_registry_entry {
+    char *name;
+    uint16_t name_length;
+    uint32_t subscribers_count;
+    uint32_t workers_subscribers_count[];
+};
+
+typedef struct module_redis_pubsub_registry module_redis_pubsub_registry_t;
+struct module_redis_pubsub_registry {
+    spinlock_lock_volatile_t lock;
+    uint32_t workers_count;
+    uint32_t workers_registered_count;
+    module_redis_pubsub_worker_t **workers;
+    bool *workers_targeted;
+    hashtable_spsc_t *channels;
+    double_linked_list_t *patterns;
+};
+
+typedef struct module_redis_pubsub_worker_entry module_redis_pubsub_worker_entry_t;
+struct module_redis_pubsub_worker_entry {
+    char *name;
+    uint16_t name_length;
+    double_linked_list_t *clients;
+};
+
+struct module_redis_pubsub_worker {
+    uint32_t worker_index;
+    queue_mpmc_t *queue;
+    hashtable_spsc_t *channels;
+    double_linked_list_t *patterns;
+    uint32_t clients_count;
+    bool delivery_fiber_running;
+};
+
+typedef struct module_redis_pubsub_client_subscription module_redis_pubsub_client_subscription_t;
+struct module_redis_pubsub_client_subscription {
+    module_redis_pubsub_worker_entry_t *entry;
+    double_linked_list_item_t *entry_clients_item;
+};
+
+struct module_redis_pubsub_client {
+    module_redis_connection_context_t *connection_context;
+    double_linked_list_t *channels;
+    double_linked_list_t *patterns;
+    struct {
+        char *data;
+        size_t length;
+        size_t size;
+    } pending;
+    bool pending_overflow;
+};
+
+module_redis_pubsub_message_t *module_redis_pubsub_message_new(
+        char *channel,
+        size_t channel_length,
+        size_t message_length);
+
+void module_redis_pubsub_message_free(
+        module_redis_pubsub_message_t *message);
+
+uint64_t module_redis_pubsub_publish(
+        module_redis_pubsub_message_t *message);
+
+bool module_redis_pubsub_client_subscribe(
+        module_redis_connection_context_t *connection_context,
+        char *name,
+        size_t name_length,
+        bool is_pattern);
+
+bool module_redis_pubsub_client_unsubscribe(
+        module_redis_connection_context_t *connection_context,
+        char *name,
+        size_t name_length,
+        bool is_pattern);
+
+char *module_redis_pubsub_client_get_first_subscription(
+        module_redis_connection_context_t *connection_context,
+        bool is_pattern,
+        size_t *name_length);
+
+uint32_t module_redis_pubsub_client_subscriptions_count(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_pubsub_client_send_subscription_reply(
+        module_redis_connection_context_t *connection_context,
+        char *kind,
+        size_t kind_length,
+        char *name,
+        size_t name_length);
+
+bool module_redis_pubsub_client_flush_pending(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_pubsub_client_free(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_pubsub_worker_cleanup();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_PUBSUB_H
@@ -0,0 +1,1474 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "clock.h"
+#include "config.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/mcmp/hashtable_op_get_key.h"
+#include "data_structures/hashtable/mcmp/hashtable_op_iter.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "worker/network/worker_network_op.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/module_redis_multi.h"
+#include "module/redis/module_redis_script.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+#include "module/redis/command/helpers/module_redis_command_helper_hash.h"
+#include "module/redis/command/helpers/module_redis_command_helper_list.h"
+#include "module/redis/command/helpers/module_redis_command_helper_varint.h"
+#include "module/redis/command/helpers/module_redis_command_helper_set.h"
+#include "module/redis/command/helpers/module_redis_command_helper_sorted_set.h"
+
+#include "module_redis_replication.h"
+#include "module_redis_aof.h"
+
+#define TAG "module_redis_replication"
+
+static module_redis_replication_registry_t module_redis_replication_registry = { 0 };
+static thread_local module_redis_replication_worker_t *module_redis_replication_worker = NULL;
+
+static module_redis_replication_worker_t *module_redis_replication_worker_get_or_create() {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    worker_context_t *worker_context;
+    module_redis_replication_worker_t *worker;
+
+    if (likely(module_redis_replication_worker)) {
+        return module_redis_replication_worker;
+    }
+
+    worker_context = worker_context_get();
+
+    // The state of the worker is read by the fibers streaming the backlogs running on the other workers, it's freed
+    // only together with the registry and therefore it's allocated with xalloc
+    worker = xalloc_alloc_zero(sizeof(module_redis_replication_worker_t));
+    worker->worker_index = worker_context->worker_index;
+
+    spinlock_lock(&registry->lock);
+
+    // The registry is allocated by the first worker that executes a write command and freed by the last one terminating
+    if (registry->workers == NULL) {
+        registry->workers_count = worker_context->workers_count;
+        registry->workers = xalloc_alloc_zero(sizeof(module_redis_replication_worker_t*) * registry->workers_count);
+    }
+
+    assert(worker->worker_index < registry->workers_count);
+    __atomic_store_n(&registry->workers[worker->worker_index], worker, __ATOMIC_RELEASE);
+    registry->workers_registered_count++;
+
+    spinlock_unlock(&registry->lock);
+
+    module_redis_replication_worker = worker;
+
+    return worker;
+}
+
+static module_redis_replication_client_t *module_redis_replication_client_get_or_new(
+        module_redis_connection_context_t *connection_context) {
+    if (likely(connection_context->replication)) {
+        return connection_context->replication;
+    }
+
+    connection_context->replication = ffma_mem_alloc_zero(sizeof(module_redis_replication_client_t));
+
+    return connection_context->replication;
+}
+
+static bool module_redis_replication_buffer_reserve(
+        char **buffer,
+        size_t *buffer_length,
+        size_t *buffer_size,
+        size_t length) {
+    if (likely(*buffer_length + length <= *buffer_size)) {
+        return true;
+    }
+
+    size_t buffer_size_new = MAX(*buffer_size, MODULE_REDIS_REPLICATION_STAGING_MIN_SIZE);
+    while(buffer_size_new < *buffer_length + length) {
+        buffer_size_new *= 2;
+    }
+
+    *buffer = module_redis_command_helper_buffer_realloc(*buffer, *buffer_size, buffer_size_new, false);
+    if (unlikely(*buffer == NULL)) {
+        *buffer_length = *buffer_size = 0;
+        return false;
+    }
+
+    *buffer_size = buffer_size_new;
+
+    return true;
+}
+
+static bool module_redis_replication_buffer_append(
+        char **buffer,
+        size_t *buffer_length,
+        size_t *buffer_size,
+        char *data,
+        size_t data_length) {
+    if (unlikely(!module_redis_replication_buffer_reserve(buffer, buffer_length, buffer_size, data_length))) {
+        return false;
+    }
+
+    memcpy(*buffer + *buffer_length, data, data_length);
+    *buffer_length += data_length;
+
+    return true;
+}
+
+static bool module_redis_replication_buffer_append_header(
+        char **buffer,
+        size_t *buffer_length,
+        size_t *buffer_size,
+        char type,
+        size_t value) {
+    char header[32];
+    int header_length = snprintf(header, sizeof(header), "%c%lu\r\n", type, value);
+
+    return module_redis_replication_buffer_append(buffer, buffer_length, buffer_size, header, header_length);
+}
+
+static bool module_redis_replication_buffer_append_blob(
+        char **buffer,
+        size_t *buffer_length,
+        size_t *buffer_size,
+        char *data,
+        size_t data_length) {
+    return
+            module_redis_replication_buffer_append_header(buffer, buffer_length, buffer_size, '$', data_length) &&
+            module_redis_replication_buffer_append(buffer, buffer_length, buffer_size, data, data_length) &&
+            module_redis_replication_buffer_append(buffer, buffer_length, buffer_size, "\r\n", 2);
+}
+
+static bool module_redis_replication_client_stage(
+        module_redis_connection_context_t *connection_context,
+        char *data,
+        size_t data_length) {
+    module_redis_replication_client_t *client = connection_context->replication;
+
+    if (unlikely(!module_redis_replication_buffer_append(
+            &client->staging,
+            &client->staging_length,
+            &client->staging_size,
+            data,
+            data_length))) {
+        client->staging_command = client->staging_multi = false;
+        module_redis_connection_error_message_printf_critical(
+                connection_context,
+                "ERR unable to stage the command for the replication");
+        return false;
+    }
+
+    return true;
+}
+
+static void module_redis_replication_backlog_append(
+        module_redis_replication_backlog_t *backlog,
+        char *data,
+        size_t data_length) {
+    uint64_t offset_end_new = backlog->offset_end + data_length;
+
+    if (unlikely(backlog->data == NULL)) {
+        backlog->size = MODULE_REDIS_REPLICATION_BACKLOG_SIZE;
+        backlog->data = xalloc_alloc(backlog->size);
+    }
+
+    // A command bigger than the backlog can't be streamed, the replicas behind it have to synchronize again
+    if (unlikely(data_length > backlog->size)) {
+        LOG_W(TAG, "Command of <%lu> bytes bigger than the replication backlog, the replicas will resync", data_length);
+        __atomic_store_n(&backlog->offset_start, offset_end_new, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&backlog->offset_end, offset_end_new, __ATOMIC_RELEASE);
+        return;
+    }
+
+    if (offset_end_new - backlog->offset_start > backlog->size) {
+        __atomic_store_n(&backlog->offset_start, offset_end_new - backlog->size, __ATOMIC_SEQ_CST);
+    }
+
+    size_t position = backlog->offset_end % backlog->size;
+    size_t first_part_length = MIN(data_length, backlog->size - position);
+
+    memcpy(backlog->data + position, data, first_part_length);
+    memcpy(backlog->data, data + first_part_length, data_length - first_part_length);
+
+    __atomic_store_n(&backlog->offset_end, offset_end_new, __ATOMIC_RELEASE);
+}
+
+static bool module_redis_replication_backlog_read(
+        module_redis_replication_backlog_t *backlog,
+        uint64_t offset,
+        char *buffer,
+        size_t length) {
+    if (unlikely(offset < __atomic_load_n(&backlog->offset_start, __ATOMIC_ACQUIRE))) {
+        return false;
+    }
+
+    size_t position = offset % backlog->size;
+    size_t first_part_length = MIN(length, backlog->size - position);
+
+    memcpy(buffer, backlog->data + position, first_part_length);
+    memcpy(buffer + first_part_length, backlog->data, length - first_part_length);
+
+    // If the writer has moved the start past the offset while copying the data might have been overwritten
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return offset >= __atomic_load_n(&backlog->offset_start, __ATOMIC_ACQUIRE);
+}
+
+bool module_redis_replication_command_begin(
+        module_redis_connection_context_t *connection_context) {
+    bool stage;
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    module_redis_command_info_t *command_info = connection_context->command.info;
+    module_redis_replication_client_t *client = connection_context->replication;
+    bool is_queuing = module_redis_multi_is_queuing(connection_context);
+
+    if (likely(!command_info->is_write) &&
+        likely(!is_queuing) &&
+        likely(command_info->command != MODULE_REDIS_COMMAND_MULTI)) {
+        return true;
+    }
+
+    if (unlikely(command_info->is_write &&
+        registry->role == MODULE_REDIS_REPLICATION_ROLE_REPLICA &&
+        (client == NULL || !client->is_link))) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "READONLY You can't write against a read only replica.");
+        return false;
+    }
+
+    if (is_queuing) {
+        // The transactions are always staged from MULTI, the non write commands queued are skipped but EXEC and
+        // DISCARD have to be tracked to close the transaction
+        stage =
+                client != NULL && client->staging_multi &&
+                (command_info->is_write ||
+                 command_info->command == MODULE_REDIS_COMMAND_EXEC ||
+                 command_info->command == MODULE_REDIS_COMMAND_DISCARD);
+    } else if (command_info->command == MODULE_REDIS_COMMAND_MULTI) {
+        stage = true;
+    } else if (command_info->is_write) {
+        stage = __atomic_load_n(&registry->active, __ATOMIC_ACQUIRE);
+
+        // If the replication isn't active the command is tracked as unstaged, SYNC waits for all the unstaged commands
+        // to be completed after enabling the replication, the active flag has to be checked again after incrementing
+        // the counter to ensure that either this command or SYNC notice the change
+        if (!stage) {
+            module_redis_replication_worker_t *worker = module_redis_replication_worker_get_or_create();
+
+            __sync_fetch_and_add(&worker->writes_unstaged, 1);
+            if (unlikely(__atomic_load_n(&registry->active, __ATOMIC_SEQ_CST))) {
+                __sync_fetch_and_sub(&worker->writes_unstaged, 1);
+                stage = true;
+            } else {
+                module_redis_replication_client_get_or_new(connection_context)->write_unstaged = true;
+            }
+        }
+    } else {
+        // EXEC or DISCARD invoked without MULTI, they will just report an error
+        return true;
+    }
+
+    if (!stage) {
+        return true;
+    }
+
+    client = module_redis_replication_client_get_or_new(connection_context);
+    client->command_start = client->staging_length;
+    client->staging_command = true;
+
+    // The arguments count includes the command name
+    char header[64];
+    int header_length = snprintf(
+            header,
+            sizeof(header),
+            "*%u\r\n$%u\r\n%.*s\r\n",
+            connection_context->command.arguments_count,
+            command_info->string_len,
+            command_info->string_len,
+            command_info->string);
+
+    return module_redis_replication_client_stage(connection_context, header, header_length);
+}
+
+bool module_redis_replication_stage_argument_begin(
+        module_redis_connection_context_t *connection_context,
+        size_t length) {
+    char header[32];
+    int header_length = snprintf(header, sizeof(header), "$%lu\r\n", length);
+
+    return module_redis_replication_client_stage(connection_context, header, header_length);
+}
+
+bool module_redis_replication_stage_argument_data(
+        module_redis_connection_context_t *connection_context,
+        char *data,
+        size_t data_length) {
+    return module_redis_replication_client_stage(connection_context, data, data_length);
+}
+
+bool module_redis_replication_stage_argument_end(
+        module_redis_connection_context_t *connection_context) {
+    return module_redis_replication_client_stage(connection_context, "\r\n", 2);
+}
+
+void module_redis_replication_command_execute_begin(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    module_redis_replication_client_t *client = connection_context->replication;
+    module_redis_replication_worker_t *worker;
+
+    if (likely(client == NULL) || (!client->staging_command && !client->write_unstaged)) {
+        return;
+    }
+
+    // MULTI and DISCARD don't change the data and the queued commands are executed by EXEC
+    switch(connection_context->command.info->command) {
+        case MODULE_REDIS_COMMAND_MULTI:
+        case MODULE_REDIS_COMMAND_DISCARD:
+            return;
+        case MODULE_REDIS_COMMAND_EXEC:
+            break;
+        default:
+            if (module_redis_multi_is_queuing(connection_context)) {
+                return;
+            }
+    }
+
+    worker = module_redis_replication_worker_get_or_create();
+
+    // The writes are paused while SYNC records the end of the backlogs and pins the entries
+    do {
+        while(unlikely(__atomic_load_n(&registry->snapshot_barrier, __ATOMIC_ACQUIRE))) {
+            if (!worker_op_timer(0, MODULE_REDIS_REPLICATION_BUSY_WAIT_NS)) {
+                break;
+            }
+        }
+
+        __sync_fetch_and_add(&worker->writes_in_flight, 1);
+        if (likely(!__atomic_load_n(&registry->snapshot_barrier, __ATOMIC_SEQ_CST))) {
+            break;
+        }
+
+        __sync_fetch_and_sub(&worker->writes_in_flight, 1);
+    } while(true);
+
+    client->write_in_flight = true;
+}
+
+static void module_redis_replication_command_append(
+        char *data,
+        size_t data_length) {
+    // The backlogs are filled only once a replica has synchronized, the append only file, if enabled, receives all the
+    // write commands
+    if (__atomic_load_n(&module_redis_replication_registry.streaming, __ATOMIC_ACQUIRE)) {
+        module_redis_replication_backlog_append(
+                &module_redis_replication_worker_get_or_create()->backlog,
+                data,
+                data_length);
+    }
+
+    module_redis_aof_append(data, data_length);
+}
+
+static void module_redis_replication_command_staged_end(
+        module_redis_connection_context_t *connection_context,
+        module_redis_replication_client_t *client) {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    bool has_error = module_redis_connection_has_error(connection_context);
+
+    switch(connection_context->command.info->command) {
+        case MODULE_REDIS_COMMAND_MULTI:
+            if (unlikely(has_error)) {
+                client->staging_length = client->command_start;
+            } else {
+                client->staging_multi = true;
+                client->multi_start = client->command_start;
+                client->multi_commands_count = 0;
+            }
+            break;
+
+        case MODULE_REDIS_COMMAND_EXEC:
+            // The transaction is appended as a whole, MULTI included, only if it has been executed and it contains
+            // at least a write command
+            if (likely(!has_error) &&
+                connection_context->multi->executed &&
+                client->multi_commands_count > 0 &&
+                __atomic_load_n(&registry->active, __ATOMIC_ACQUIRE)) {
+                module_redis_replication_command_append(
+                        client->staging + client->multi_start,
+                        client->staging_length - client->multi_start);
+            }
+
+            client->staging_length = client->multi_start;
+            client->staging_multi = false;
+            break;
+
+        case MODULE_REDIS_COMMAND_DISCARD:
+            client->staging_length = client->multi_start;
+            client->staging_multi = false;
+            break;
+
+        default:
+            if (unlikely(has_error)) {
+                client->staging_length = client->command_start;
+            } else if (module_redis_multi_is_queuing(connection_context)) {
+                client->multi_commands_count++;
+            } else {
+                module_redis_replication_command_append(
+                        client->staging + client->command_start,
+                        client->staging_length - client->command_start);
+                client->staging_length = client->command_start;
+            }
+    }
+}
+
+void module_redis_replication_command_end(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_replication_client_t *client = connection_context->replication;
+
+    if (likely(client == NULL)) {
+        return;
+    }
+
+    if (client->staging_command) {
+        client->staging_command = false;
+
+        if (likely(connection_context->command.info != NULL)) {
+            module_redis_replication_command_staged_end(connection_context, client);
+        }
+    }
+
+    // The counters are decremented only once the command has been appended to the backlog
+    if (client->write_unstaged) {
+        __sync_fetch_and_sub(&module_redis_replication_worker->writes_unstaged, 1);
+        client->write_unstaged = false;
+    }
+
+    if (client->write_in_flight) {
+        __sync_fetch_and_sub(&module_redis_replication_worker->writes_in_flight, 1);
+        client->write_in_flight = false;
+    }
+}
+
+void module_redis_replication_client_free(
+        module_redis_connection_context_t *connection_context) {
+    module_redis_replication_client_t *client = connection_context->replication;
+
+    if (likely(client == NULL)) {
+        return;
+    }
+
+    // The connection might be closed while a write command is being processed
+    if (client->write_unstaged) {
+        __sync_fetch_and_sub(&module_redis_replication_worker->writes_unstaged, 1);
+    }
+
+    if (client->write_in_flight) {
+        __sync_fetch_and_sub(&module_redis_replication_worker->writes_in_flight, 1);
+    }
+
+    if (client->staging) {
+        module_redis_command_helper_buffer_free(client->staging, client->staging_size);
+    }
+
+    ffma_mem_free(client);
+    connection_context->replication = NULL;
+}
+
+static uint32_t module_redis_replication_workers_count_pending_writes(
+        bool in_flight) {
+    uint32_t count = 0;
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+
+    for(uint32_t worker_index = 0; worker_index < registry->workers_count; worker_index++) {
+        module_redis_replication_worker_t *worker =
+                __atomic_load_n(&registry->workers[worker_index], __ATOMIC_ACQUIRE);
+
+        if (worker == NULL) {
+            continue;
+        }
+
+        count += __atomic_load_n(in_flight ? &worker->writes_in_flight : &worker->writes_unstaged, __ATOMIC_SEQ_CST);
+    }
+
+    return count;
+}
+
+static bool module_redis_replication_wait_pending_writes(
+        bool in_flight) {
+    while(module_redis_replication_workers_count_pending_writes(in_flight) > 0) {
+        if (!worker_op_timer(0, MODULE_REDIS_REPLICATION_BUSY_WAIT_NS)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void module_redis_replication_snapshot_release(
+        module_redis_replication_snapshot_entry_t *entries,
+        uint64_t entries_count) {
+    for(uint64_t index = 0; index < entries_count; index++) {
+        storage_db_snapshot_entry_release(&entries[index]);
+    }
+
+    xalloc_free(entries);
+}
+
+static bool module_redis_replication_snapshot_flush_buffer(
+        module_redis_replication_snapshot_t *snapshot,
+        bool force) {
+    if (snapshot->buffer_length == 0 || (!force && snapshot->buffer_length < NETWORK_CHANNEL_SEND_BUFFER_SIZE)) {
+        return true;
+    }
+
+    if (unlikely(!snapshot->write_fp(snapshot->write_user_data, snapshot->buffer, snapshot->buffer_length))) {
+        return false;
+    }
+
+    snapshot->buffer_length = 0;
+
+    return true;
+}
+
+static bool module_redis_replication_snapshot_append_command(
+        module_redis_replication_snapshot_t *snapshot,
+        char *command,
+        module_redis_replication_snapshot_entry_t *entry,
+        uint32_t arguments_count,
+        char *arguments,
+        size_t arguments_length) {
+    // When migrating the keys to a node that is importing their slot each command has to be preceded by ASKING
+    if (snapshot->migrate) {
+        if (unlikely(!module_redis_replication_buffer_append(
+                &snapshot->buffer,
+                &snapshot->buffer_length,
+                &snapshot->buffer_size,
+                "*1\r\n$6\r\nASKING\r\n",
+                strlen("*1\r\n$6\r\nASKING\r\n")))) {
+            return false;
+        }
+
+        snapshot->commands_count++;
+    }
+
+    snapshot->commands_count++;
+
+    return
+            module_redis_replication_buffer_append_header(
+                    &snapshot->buffer,
+                    &snapshot->buffer_length,
+                    &snapshot->buffer_size,
+                    '*',
+                    arguments_count + 2) &&
+            module_redis_replication_buffer_append_blob(
+                    &snapshot->buffer,
+                    &snapshot->buffer_length,
+                    &snapshot->buffer_size,
+                    command,
+                    strlen(command)) &&
+            module_redis_replication_buffer_append_blob(
+                    &snapshot->buffer,
+                    &snapshot->buffer_length,
+                    &snapshot->buffer_size,
+                    entry->key,
+                    entry->key_length) &&
+            module_redis_replication_buffer_append(
+                    &snapshot->buffer,
+                    &snapshot->buffer_length,
+                    &snapshot->buffer_size,
+                    arguments,
+                    arguments_length) &&
+            module_redis_replication_snapshot_flush_buffer(snapshot, false);
+}
+
+static bool module_redis_replication_snapshot_batch_flush(
+        module_redis_replication_snapshot_t *snapshot,
+        char *command,
+        module_redis_replication_snapshot_entry_t *entry) {
+    bool result_res;
+
+    if (snapshot->batch_elements_count == 0) {
+        return true;
+    }
+
+    result_res = module_redis_replication_snapshot_append_command(
+            snapshot,
+            command,
+            entry,
+            snapshot->batch_elements_count,
+            snapshot->batch,
+            snapshot->batch_length);
+
+    snapshot->batch_length = 0;
+    snapshot->batch_elements_count = 0;
+
+    return result_res;
+}
+
+static bool module_redis_replication_snapshot_batch_append(
+        module_redis_replication_snapshot_t *snapshot,
+        char *command,
+        module_redis_replication_snapshot_entry_t *entry,
+        char *element,
+        size_t element_length,
+        bool last_element_of_group) {
+    if (unlikely(!module_redis_replication_buffer_append_blob(
+            &snapshot->batch,
+            &snapshot->batch_length,
+            &snapshot->batch_size,
+            element,
+            element_length))) {
+        return false;
+    }
+
+    snapshot->batch_elements_count++;
+
+    // The elements are sent in batches to keep the commands received by the replica within the usual limits, the
+    // members of the hashes and of the sorted sets are made by two elements that can't be split
+    if (last_element_of_group &&
+        (snapshot->batch_elements_count >= MODULE_REDIS_REPLICATION_SNAPSHOT_BATCH_MAX_ELEMENTS ||
+         snapshot->batch_length >= MODULE_REDIS_REPLICATION_SNAPSHOT_BATCH_MAX_LENGTH)) {
+        return module_redis_replication_snapshot_batch_flush(snapshot, command, entry);
+    }
+
+    return true;
+}
+
+static bool module_redis_replication_snapshot_serialize_string(
+        module_redis_replication_snapshot_t *snapshot,
+        module_redis_replication_snapshot_entry_t *entry) {
+    storage_db_chunk_sequence_t *chunk_sequence = entry->entry_index->value;
+
+    if (unlikely(!module_redis_replication_buffer_append_header(
+            &snapshot->batch,
+            &snapshot->batch_length,
+            &snapshot->batch_size,
+            '$',
+            chunk_sequence->size))) {
+        return false;
+    }
+
+    // The chunks are read straight into the batch buffer
+    if (unlikely(!module_redis_replication_buffer_reserve(
+            &snapshot->batch,
+            &snapshot->batch_length,
+            &snapshot->batch_size,
+            chunk_sequence->size + 2))) {
+        return false;
+    }
+
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        if (unlikely(!storage_db_chunk_read(
+                snapshot->db,
+                chunk_info,
+                snapshot->batch + snapshot->batch_length,
+                0,
+                chunk_info->chunk_length))) {
+            return false;
+        }
+
+        snapshot->batch_length += chunk_info->chunk_length;
+    }
+
+    snapshot->batch_elements_count = 1;
+
+    return
+            module_redis_replication_buffer_append(
+                    &snapshot->batch,
+                    &snapshot->batch_length,
+                    &snapshot->batch_size,
+                    "\r\n",
+                    2) &&
+            module_redis_replication_snapshot_batch_flush(snapshot, "SET", entry);
+}
+
+static bool module_redis_replication_snapshot_serialize_list(
+        module_redis_replication_snapshot_t *snapshot,
+        module_redis_replication_snapshot_entry_t *entry) {
+    bool result_res = true;
+    module_redis_command_helper_list_t list = { 0 };
+    module_redis_command_helper_list_node_t node = { 0 };
+
+    if (unlikely(!module_redis_command_helper_list_load(snapshot->db, entry->entry_index, &list))) {
+        return false;
+    }
+
+    for(uint32_t node_index = 0; node_index < list.nodes_count && result_res; node_index++) {
+        char *iter_ptr = NULL, *element;
+        size_t element_length;
+
+        if (unlikely(!module_redis_command_helper_list_node_load(snapshot->db, &list, node_index, &node))) {
+            result_res = false;
+            break;
+        }
+
+        while(result_res && module_redis_command_helper_list_node_iter(
+                &node,
+                &iter_ptr,
+                &element,
+                &element_length)) {
+            result_res = module_redis_replication_snapshot_batch_append(
+                    snapshot,
+                    "RPUSH",
+                    entry,
+                    element,
+                    element_length,
+                    true);
+        }
+
+        module_redis_command_helper_list_node_cleanup(&node);
+    }
+
+    return result_res && module_redis_replication_snapshot_batch_flush(snapshot, "RPUSH", entry);
+}
+
+static bool module_redis_replication_snapshot_serialize_hash(
+        module_redis_replication_snapshot_t *snapshot,
+        module_redis_replication_snapshot_entry_t *entry) {
+    bool result_res = true;
+    char *field, *value;
+    size_t field_length, value_length;
+    module_redis_command_helper_hash_t hash = { 0 };
+    module_redis_command_helper_hash_iter_t iter = { 0 };
+
+    if (unlikely(!module_redis_command_helper_hash_load(snapshot->db, entry->entry_index, &hash) ||
+            !module_redis_command_helper_hash_iter_init(snapshot->db, &hash, 0, &iter))) {
+        module_redis_command_helper_hash_iter_cleanup(&iter);
+        module_redis_command_helper_hash_cleanup(&hash);
+        return false;
+    }
+
+    while(result_res && module_redis_command_helper_hash_iter_next(
+            snapshot->db,
+            &iter,
+            NULL,
+            &field,
+            &field_length,
+            &value,
+            &value_length)) {
+        result_res =
+                module_redis_replication_snapshot_batch_append(
+                        snapshot,
+                        "HSET",
+                        entry,
+                        field,
+                        field_length,
+                        false) &&
+                module_redis_replication_snapshot_batch_append(
+                        snapshot,
+                        "HSET",
+                        entry,
+                        value,
+                        value_length,
+                        true);
+    }
+
+    module_redis_command_helper_hash_iter_cleanup(&iter);
+    module_redis_command_helper_hash_cleanup(&hash);
+
+    return result_res && module_redis_replication_snapshot_batch_flush(snapshot, "HSET", entry);
+}
+
+static bool module_redis_replication_snapshot_serialize_set(
+        module_redis_replication_snapshot_t *snapshot,
+        module_redis_replication_snapshot_entry_t *entry) {
+    bool result_res = true;
+    char *member;
+    size_t member_length;
+    module_redis_command_helper_set_t set = { 0 };
+    module_redis_command_helper_set_iter_t iter = { 0 };
+
+    if (unlikely(!module_redis_command_helper_set_load(snapshot->db, entry->entry_index, &set))) {
+        module_redis_command_helper_set_cleanup(&set);
+        return false;
+    }
+
+    while(result_res && module_redis_command_helper_set_iter(snapshot->db, &set, &iter, &member, &member_length)) {
+        result_res = module_redis_replication_snapshot_batch_append(
+                snapshot,
+                "SADD",
+                entry,
+                member,
+                member_length,
+                true);
+    }
+
+    module_redis_command_helper_set_iter_cleanup(&iter);
+    module_redis_command_helper_set_cleanup(&set);
+
+    return result_res && module_redis_replication_snapshot_batch_flush(snapshot, "SADD", entry);
+}
+
+static bool module_redis_replication_snapshot_serialize_sorted_set(
+        module_redis_replication_snapshot_t *snapshot,
+        module_redis_replication_snapshot_entry_t *entry) {
+    bool result_res = false;
+    double score;
+    char *member;
+    size_t member_length;
+    char score_str[32];
+    module_redis_command_helper_sorted_set_t sorted_set = { 0 };
+    module_redis_command_helper_sorted_set_iter_t iter = { 0 };
+
+    if (unlikely(!module_redis_command_helper_sorted_set_load(snapshot->db, entry->entry_index, &sorted_set))) {
+        goto end;
+    }
+
+    if (unlikely(!module_redis_command_helper_sorted_set_iter_init(snapshot->db, &sorted_set, 0, &iter))) {
+        goto end;
+    }
+
+    for(uint64_t index = 0; index < sorted_set.count; index++) {
+        if (unlikely(!module_redis_command_helper_sorted_set_iter_next(
+                snapshot->db,
+                &iter,
+                &score,
+                &member,
+                &member_length))) {
+            goto end;
+        }
+
+        // The scores are formatted with enough digits to be parsed back to the same double
+        int score_str_length = snprintf(score_str, sizeof(score_str), "%.17g", score);
+
+        if (unlikely(!module_redis_replication_snapshot_batch_append(
+                snapshot,
+                "ZADD",
+                entry,
+                score_str,
+                score_str_length,
+                false))) {
+            goto end;
+        }
+
+        if (unlikely(!module_redis_replication_snapshot_batch_append(
+                snapshot,
+                "ZADD",
+                entry,
+                member,
+                member_length,
+                true))) {
+            goto end;
+        }
+    }
+
+    result_res = module_redis_replication_snapshot_batch_flush(snapshot, "ZADD", entry);
+
+end:
+    module_redis_command_helper_sorted_set_iter_cleanup(&iter);
+    module_redis_command_helper_sorted_set_cleanup(&sorted_set);
+
+    return result_res;
+}
+
+static bool module_redis_replication_snapshot_serialize_entry(
+        module_redis_replication_snapshot_t *snapshot,
+        module_redis_replication_snapshot_entry_t *entry) {
+    bool result_res;
+    storage_db_entry_index_t *entry_index = entry->entry_index;
+
+    // The migrated keys replace the ones with the same name on the target node
+    if (snapshot->migrate && unlikely(!module_redis_replication_snapshot_append_command(
+            snapshot,
+            "DEL",
+            entry,
+            0,
+            "",
+            0))) {
+        return false;
+    }
+
+    switch(entry_index->value_type) {
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING:
+            result_res = module_redis_replication_snapshot_serialize_string(snapshot, entry);
+            break;
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST:
+            result_res = module_redis_replication_snapshot_serialize_list(snapshot, entry);
+            break;
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET:
+            result_res = module_redis_replication_snapshot_serialize_hash(snapshot, entry);
+            break;
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET:
+            result_res = module_redis_replication_snapshot_serialize_set(snapshot, entry);
+            break;
+        case STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET:
+            result_res = module_redis_replication_snapshot_serialize_sorted_set(snapshot, entry);
+            break;
+        default:
+            LOG_W(TAG, "Unable to replicate a key with value type <%d>", entry_index->value_type);
+            return true;
+    }
+
+    if (unlikely(!result_res)) {
+        return false;
+    }
+
+    if (entry_index->expiry_time_ms != STORAGE_DB_ENTRY_NO_EXPIRY) {
+        char expiry_time_ms_str[32];
+        int expiry_time_ms_str_length = snprintf(
+                expiry_time_ms_str,
+                sizeof(expiry_time_ms_str),
+                "%ld",
+                (int64_t)entry_index->expiry_time_ms);
+
+        if (unlikely(!module_redis_replication_buffer_append_blob(
+                &snapshot->batch,
+                &snapshot->batch_length,
+                &snapshot->batch_size,
+                expiry_time_ms_str,
+                expiry_time_ms_str_length))) {
+            return false;
+        }
+
+        snapshot->batch_elements_count = 1;
+
+        return module_redis_replication_snapshot_batch_flush(snapshot, "PEXPIREAT", entry);
+    }
+
+    return true;
+}
+
+static bool module_redis_replication_snapshot_network_write(
+        void *user_data,
+        char *data,
+        size_t data_length) {
+    return network_send_buffered(user_data, data, data_length) == NETWORK_OP_RESULT_OK;
+}
+
+bool module_redis_replication_snapshot_serialize(
+        storage_db_t *db,
+        module_redis_replication_snapshot_write_fp_t *write_fp,
+        void *write_user_data,
+        uint64_t *entries_count) {
+    bool result_res = false;
+    module_redis_replication_snapshot_entry_t entry;
+    uint32_t scripts_count = 0;
+    module_redis_script_registry_entry_t **scripts = NULL;
+    module_redis_replication_snapshot_t snapshot = {
+            .write_fp = write_fp,
+            .write_user_data = write_user_data,
+            .db = db,
+    };
+
+    // The data are dropped before loading the snapshot
+    if (unlikely(!module_redis_replication_buffer_append(
+            &snapshot.buffer,
+            &snapshot.buffer_length,
+            &snapshot.buffer_size,
+            "*1\r\n$7\r\nFLUSHDB\r\n",
+            strlen("*1\r\n$7\r\nFLUSHDB\r\n")))) {
+        goto end;
+    }
+
+    // The scripts are loaded as well so EVALSHA can be replicated as is
+    scripts = module_redis_script_copy_entries(&scripts_count);
+    for(uint32_t index = 0; index < scripts_count; index++) {
+        if (unlikely(!module_redis_replication_buffer_append(
+                &snapshot.buffer,
+                &snapshot.buffer_length,
+                &snapshot.buffer_size,
+                "*3\r\n$6\r\nSCRIPT\r\n$4\r\nLOAD\r\n",
+                strlen("*3\r\n$6\r\nSCRIPT\r\n$4\r\nLOAD\r\n")))) {
+            goto end;
+        }
+
+        if (unlikely(!module_redis_replication_buffer_append_blob(
+                &snapshot.buffer,
+                &snapshot.buffer_length,
+                &snapshot.buffer_size,
+                scripts[index]->source,
+                scripts[index]->source_length))) {
+            goto end;
+        }
+    }
+
+    // The entries are pinned one at a time and released as soon as they are serialized
+    *entries_count = 0;
+    while(storage_db_snapshot_next(db, &entry)) {
+        bool serialized = module_redis_replication_snapshot_serialize_entry(&snapshot, &entry);
+        storage_db_snapshot_entry_release(&entry);
+
+        if (unlikely(!serialized)) {
+            goto end;
+        }
+
+        (*entries_count)++;
+    }
+
+    result_res = module_redis_replication_snapshot_flush_buffer(&snapshot, true);
+
+end:
+    module_redis_script_free_entries(scripts, scripts_count);
+
+    if (snapshot.buffer) {
+        module_redis_command_helper_buffer_free(snapshot.buffer, snapshot.buffer_size);
+    }
+
+    if (snapshot.batch) {
+        module_redis_command_helper_buffer_free(snapshot.batch, snapshot.batch_size);
+    }
+
+    return result_res;
+}
+
+bool module_redis_replication_snapshot_serialize_migrate(
+        storage_db_t *db,
+        module_redis_replication_snapshot_entry_t *entries,
+        uint64_t entries_count,
+        module_redis_replication_snapshot_write_fp_t *write_fp,
+        void *write_user_data,
+        uint64_t *commands_count) {
+    bool result_res = false;
+    module_redis_replication_snapshot_t snapshot = {
+            .write_fp = write_fp,
+            .write_user_data = write_user_data,
+            .db = db,
+            .migrate = true,
+    };
+
+    // Unlike the snapshot sent to the replicas the data of the target node aren't dropped, only the passed entries
+    // are serialized and the caller has to read a reply for each command
+    for(uint64_t index = 0; index < entries_count; index++) {
+        if (unlikely(!module_redis_replication_snapshot_serialize_entry(&snapshot, &entries[index]))) {
+            goto end;
+        }
+    }
+
+    result_res = module_redis_replication_snapshot_flush_buffer(&snapshot, true);
+    *commands_count = snapshot.commands_count;
+
+end:
+    if (snapshot.buffer) {
+        module_redis_command_helper_buffer_free(snapshot.buffer, snapshot.buffer_size);
+    }
+
+    if (snapshot.batch) {
+        module_redis_command_helper_buffer_free(snapshot.batch, snapshot.batch_size);
+    }
+
+    return result_res;
+}
+
+static bool module_redis_replication_stream_backlogs(
+        module_redis_connection_context_t *connection_context,
+        uint64_t *offsets,
+        uint32_t workers_count) {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    network_channel_t *network_channel = connection_context->network_channel;
+    int64_t last_send_time_ms = clock_monotonic_int64_ms();
+
+    do {
+        bool data_sent = false;
+
+        for(uint32_t worker_index = 0; worker_index < workers_count; worker_index++) {
+            module_redis_replication_worker_t *worker =
+                    __atomic_load_n(&registry->workers[worker_index], __ATOMIC_ACQUIRE);
+
+            if (worker == NULL) {
+                continue;
+            }
+
+            // The commands are appended as a whole, reading till the end of the backlog ensures that the stream of
+            // each worker is switched only at the boundaries of the commands
+            uint64_t offset_end = __atomic_load_n(&worker->backlog.offset_end, __ATOMIC_ACQUIRE);
+
+            while(offsets[worker_index] < offset_end) {
+                size_t length = MIN(offset_end - offsets[worker_index], network_channel->buffers.send.length);
+                network_channel_buffer_data_t *send_buffer = network_send_buffer_acquire_slice(
+                        network_channel,
+                        length);
+
+                if (unlikely(send_buffer == NULL)) {
+                    return false;
+                }
+
+                if (unlikely(!module_redis_replication_backlog_read(
+                        &worker->backlog,
+                        offsets[worker_index],
+                        send_buffer,
+                        length))) {
+                    network_send_buffer_release_slice(network_channel, 0);
+                    LOG_I(
+                            TAG,
+                            "The replica <%s> is too far behind, closing the connection",
+                            network_channel->address.str);
+                    return false;
+                }
+
+                network_send_buffer_release_slice(network_channel, length);
+                offsets[worker_index] += length;
+                data_sent = true;
+            }
+        }
+
+        // The heartbeat allows the replica to notice when the primary is gone
+        if (!data_sent &&
+            clock_monotonic_int64_ms() - last_send_time_ms >= MODULE_REDIS_REPLICATION_HEARTBEAT_INTERVAL_MS) {
+            if (unlikely(network_send_buffered(
+                    network_channel,
+                    "*1\r\n$4\r\nPING\r\n",
+                    strlen("*1\r\n$4\r\nPING\r\n")) != NETWORK_OP_RESULT_OK)) {
+                return false;
+            }
+
+            data_sent = true;
+        }
+
+        if (data_sent) {
+            if (unlikely(network_flush_send_buffer(network_channel) != NETWORK_OP_RESULT_OK)) {
+                return false;
+            }
+
+            last_send_time_ms = clock_monotonic_int64_ms();
+            continue;
+        }
+    } while(worker_op_timer(0, MODULE_REDIS_REPLICATION_STREAM_WAIT_NS));
+
+    return false;
+}
+
+bool module_redis_replication_snapshot_take(
+        storage_db_t *db,
+        module_redis_replication_snapshot_quiesced_fp_t *quiesced_fp,
+        void *quiesced_user_data) {
+    bool result_res = false;
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+
+    // Only one snapshot at a time can be taken, the snapshot is running till module_redis_replication_snapshot_end
+    // is invoked
+    while(!__sync_bool_compare_and_swap(&registry->snapshot_running, false, true)) {
+        if (!worker_op_timer(0, MODULE_REDIS_REPLICATION_BUSY_WAIT_NS)) {
+            return false;
+        }
+    }
+
+    // Ensures that the registry exists
+    module_redis_replication_worker_get_or_create();
+
+    // From now on all the write commands are staged, the ones that haven't been staged have to complete before pausing
+    // the writes
+    __atomic_store_n(&registry->active, true, __ATOMIC_SEQ_CST);
+    if (likely(module_redis_replication_wait_pending_writes(false))) {
+        __atomic_store_n(&registry->snapshot_barrier, true, __ATOMIC_SEQ_CST);
+
+        // Only the snapshot begins under the barrier, the entries are visited once the writes have been resumed
+        if (likely(module_redis_replication_wait_pending_writes(true))) {
+            quiesced_fp(quiesced_user_data);
+            storage_db_snapshot_begin(db);
+            result_res = true;
+        }
+
+        __atomic_store_n(&registry->snapshot_barrier, false, __ATOMIC_SEQ_CST);
+    }
+
+    if (unlikely(!result_res)) {
+        __atomic_store_n(&registry->snapshot_running, false, __ATOMIC_RELEASE);
+    }
+
+    return result_res;
+}
+
+void module_redis_replication_snapshot_end(
+        storage_db_t *db) {
+    storage_db_snapshot_end(db);
+    __atomic_store_n(&module_redis_replication_registry.snapshot_running, false, __ATOMIC_RELEASE);
+}
+
+void module_redis_replication_enable_staging() {
+    __atomic_store_n(&module_redis_replication_registry.active, true, __ATOMIC_SEQ_CST);
+}
+
+static void module_redis_replication_sync_quiesced(
+        void *user_data) {
+    uint64_t *offsets = user_data;
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+
+    // The backlogs are filled from now on, the commands appended before this point are part of the snapshot
+    __atomic_store_n(&registry->streaming, true, __ATOMIC_SEQ_CST);
+
+    for(uint32_t worker_index = 0; worker_index < registry->workers_count; worker_index++) {
+        module_redis_replication_worker_t *worker =
+                __atomic_load_n(&registry->workers[worker_index], __ATOMIC_ACQUIRE);
+
+        offsets[worker_index] = worker == NULL
+                ? 0
+                : __atomic_load_n(&worker->backlog.offset_end, __ATOMIC_ACQUIRE);
+    }
+}
+
+bool module_redis_replication_sync(
+        module_redis_connection_context_t *connection_context) {
+    bool result_res;
+    uint32_t workers_count;
+    uint64_t *offsets = NULL;
+    uint64_t entries_count = 0;
+    network_channel_t *network_channel = connection_context->network_channel;
+
+    LOG_I(TAG, "Replica <%s> synchronizing", network_channel->address.str);
+
+    // Ensures that the registry exists before allocating the offsets
+    module_redis_replication_worker_get_or_create();
+    workers_count = module_redis_replication_registry.workers_count;
+    offsets = ffma_mem_alloc_zero(sizeof(uint64_t) * workers_count);
+
+    if (unlikely(!module_redis_replication_snapshot_take(
+            connection_context->db,
+            module_redis_replication_sync_quiesced,
+            offsets))) {
+        goto end;
+    }
+
+    result_res =
+            module_redis_replication_snapshot_serialize(
+                    connection_context->db,
+                    module_redis_replication_snapshot_network_write,
+                    network_channel,
+                    &entries_count) &&
+            network_flush_send_buffer(network_channel) == NETWORK_OP_RESULT_OK;
+
+    module_redis_replication_snapshot_end(connection_context->db);
+
+    if (likely(result_res)) {
+        LOG_I(TAG, "Sent <%lu> keys to the replica <%s>", entries_count, network_channel->address.str);
+        module_redis_replication_stream_backlogs(connection_context, offsets, workers_count);
+    }
+
+    LOG_I(TAG, "Replica <%s> disconnected", network_channel->address.str);
+
+end:
+    ffma_mem_free(offsets);
+
+    // The connection is always closed once the replica goes away
+    return false;
+}
+
+static void module_redis_replication_link_process(
+        module_redis_replication_link_t *link,
+        network_channel_t *network_channel) {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    network_channel_t capture_network_channel = { 0 };
+    module_redis_connection_context_t connection_context = { 0 };
+
+    // The primary sends a heartbeat when idle, if nothing is received for a while the primary is considered gone
+    network_channel->timeout.read.sec = MODULE_REDIS_REPLICATION_LINK_READ_TIMEOUT_SEC;
+    network_channel->timeout.read.nsec = 0;
+
+    if (unlikely(network_send_buffered(
+            network_channel,
+            "*1\r\n$4\r\nSYNC\r\n",
+            strlen("*1\r\n$4\r\nSYNC\r\n")) != NETWORK_OP_RESULT_OK)) {
+        return;
+    }
+
+    if (unlikely(network_flush_send_buffer(network_channel) != NETWORK_OP_RESULT_OK)) {
+        return;
+    }
+
+    // The commands received are applied as if they were sent by a client, the replies are captured and dropped
+    network_channel_init(NETWORK_CHANNEL_TYPE_CAPTURE, &capture_network_channel);
+    capture_network_channel.module_config = link->module_config;
+
+    module_redis_connection_context_init(
+            &connection_context,
+            link->db,
+            &capture_network_channel,
+            link->module_config);
+    module_redis_replication_client_get_or_new(&connection_context)->is_link = true;
+
+    do {
+        if (unlikely(!network_buffer_has_enough_space(
+                &connection_context.read_buffer,
+                NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
+            break;
+        }
+
+        if (unlikely(network_buffer_needs_rewind(
+                &connection_context.read_buffer,
+                NETWORK_CHANNEL_MAX_PACKET_SIZE))) {
+            network_buffer_rewind(&connection_context.read_buffer);
+        }
+
+        if (network_receive(
+                network_channel,
+                &connection_context.read_buffer,
+                NETWORK_CHANNEL_MAX_PACKET_SIZE) != NETWORK_OP_RESULT_OK) {
+            break;
+        }
+
+        if (unlikely(link->generation != registry->link_generation)) {
+            break;
+        }
+
+        if (!module_redis_process_data(&connection_context, &connection_context.read_buffer)) {
+            break;
+        }
+
+        network_channel_capture_reset(&capture_network_channel);
+    } while(true);
+
+    module_redis_command_process_try_free(&connection_context);
+    module_redis_multi_free(&connection_context);
+    module_redis_replication_client_free(&connection_context);
+    module_redis_connection_context_reset(&connection_context);
+    module_redis_connection_context_cleanup(&connection_context);
+    network_channel_cleanup(&capture_network_channel);
+}
+
+static void module_redis_replication_link_fiber_entrypoint(
+        void *user_data) {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    module_redis_replication_link_t *link = user_data;
+
+    // The fiber terminates when the replica is promoted or pointed to another primary
+    while(link->generation == registry->link_generation) {
+        network_channel_t *network_channel = worker_op_network_connect(
+                &link->address.base,
+                link->address_size,
+                link->module_config);
+
+        if (network_channel) {
+            LOG_I(TAG, "Connected to the primary <%s>", network_channel->address.str);
+
+            module_redis_replication_link_process(link, network_channel);
+            if (network_channel->status != NETWORK_CHANNEL_STATUS_CLOSED) {
+                worker_op_network_close(network_channel, true);
+            }
+
+            LOG_I(TAG, "Disconnected from the primary");
+        }
+
+        if (link->generation != registry->link_generation ||
+            !worker_op_timer(0, MODULE_REDIS_REPLICATION_LINK_RETRY_WAIT_NS)) {
+            break;
+        }
+    }
+
+    ffma_mem_free(link);
+    fiber_scheduler_terminate_current_fiber();
+}
+
+bool module_redis_replication_replicaof(
+        module_redis_connection_context_t *connection_context,
+        struct sockaddr *address,
+        socklen_t address_size) {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    module_redis_replication_link_t *link = ffma_mem_alloc_zero(sizeof(module_redis_replication_link_t));
+
+    if (unlikely(link == NULL)) {
+        return false;
+    }
+
+    memcpy(&link->address, address, address_size);
+    link->address_size = address_size;
+    link->db = connection_context->db;
+    link->module_config = connection_context->network_channel->module_config;
+
+    // Bumping the generation stops the link to the previous primary, if any
+    registry->role = MODULE_REDIS_REPLICATION_ROLE_REPLICA;
+    link->generation = __atomic_add_fetch(&registry->link_generation, 1, __ATOMIC_ACQ_REL);
+
+    fiber_scheduler_new_fiber(
+            "worker-redis-replication-link",
+            strlen("worker-redis-replication-link"),
+            module_redis_replication_link_fiber_entrypoint,
+            link);
+
+    return true;
+}
+
+void module_redis_replication_replicaof_no_one() {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+
+    registry->role = MODULE_REDIS_REPLICATION_ROLE_PRIMARY;
+    __atomic_add_fetch(&registry->link_generation, 1, __ATOMIC_ACQ_REL);
+}
+
+static void module_redis_replication_registry_free() {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+
+    for(uint32_t worker_index = 0; worker_index < registry->workers_count; worker_index++) {
+        module_redis_replication_worker_t *worker = registry->workers[worker_index];
+
+        if (worker == NULL) {
+            continue;
+        }
+
+        if (worker->backlog.data) {
+            xalloc_free(worker->backlog.data);
+        }
+
+        xalloc_free(worker);
+    }
+
+    xalloc_free(registry->workers);
+    registry->workers = NULL;
+    registry->workers_count = 0;
+    registry->active = false;
+    registry->streaming = false;
+    registry->role = MODULE_REDIS_REPLICATION_ROLE_PRIMARY;
+}
+
+void module_redis_replication_worker_cleanup() {
+    module_redis_replication_registry_t *registry = &module_redis_replication_registry;
+    module_redis_replication_worker_t *worker = module_redis_replication_worker;
+
+    if (!worker) {
+        return;
+    }
+
+    // The state of the workers can be read by the fibers streaming the backlogs, it's freed only when the last worker
+    // terminates
+    spinlock_lock(&registry->lock);
+
+    registry->workers_registered_count--;
+
+    if (registry->workers_registered_count == 0) {
+        module_redis_replication_registry_free();
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    module_redis_replication_worker = NULL;
+}
@@ -0,0 +1,200 @@
+#ifndef CACHEGRAND_MODULE_REDIS_REPLICATION_H
+#define CACHEGRAND_MODULE_REDIS_REPLICATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The replication is asynchronous, the write commands are executed locally and then appended, in the same format used
+// by the clients, to a bounded backlog owned by the worker that executed them, so the write path never touches shared
+// state other than the backlog of its own worker.
+// The commands are staged in a buffer of the connection while being parsed, nothing is staged until a replica invokes
+// SYNC for the first time, from then on the backlogs are always filled. The staged commands are also appended to the
+// append only file, if enabled.
+//
+// SYNC waits for the write commands already being parsed to be completed, briefly pauses the writes, records the end of
+// each backlog and begins a snapshot of the storage db, the pause doesn't depend on the amount of keys. Once the writes
+// are resumed the snapshot visits the entries incrementally, pinning the version current when the snapshot began (the
+// writers hand over the versions they replace before the snapshot visits them), serializes them as commands (SET,
+// RPUSH, HSET, SADD, ZADD, PEXPIREAT) and sends them to the replica followed by the content of the backlogs starting
+// from the recorded offsets. The ordering of the commands is guaranteed only within the stream of each worker.
+// If a replica falls behind and the commands it has to receive are overwritten in a backlog the connection is closed
+// and the replica will reconnect and synchronize again.
+//
+// REPLICAOF spawns a fiber on the worker that connects to the primary, invokes SYNC and applies the received commands
+// using module_redis_process_data, the replicas refuse the write commands sent by the clients.
+#define MODULE_REDIS_REPLICATION_BACKLOG_SIZE (4 * 1024 * 1024)
+#define MODULE_REDIS_REPLICATION_STAGING_MIN_SIZE (1024)
+#define MODULE_REDIS_REPLICATION_BUSY_WAIT_NS (100 * 1000)
+#define MODULE_REDIS_REPLICATION_STREAM_WAIT_NS (1 * 1000 * 1000)
+#define MODULE_REDIS_REPLICATION_HEARTBEAT_INTERVAL_MS (1000)
+#define MODULE_REDIS_REPLICATION_LINK_RETRY_WAIT_NS (1000 * 1000 * 1000)
+#define MODULE_REDIS_REPLICATION_LINK_READ_TIMEOUT_SEC (5)
+#define MODULE_REDIS_REPLICATION_SNAPSHOT_BATCH_MAX_ELEMENTS (64)
+#define MODULE_REDIS_REPLICATION_SNAPSHOT_BATCH_MAX_LENGTH (4 * 1024)
+
+enum module_redis_replication_role {
+    MODULE_REDIS_REPLICATION_ROLE_PRIMARY,
+    MODULE_REDIS_REPLICATION_ROLE_REPLICA,
+};
+typedef enum module_redis_replication_role module_redis_replication_role_t;
+
+typedef struct module_redis_replication_backlog module_redis_replication_backlog_t;
+struct module_redis_replication_backlog {
+    // The offsets are monotonic, the writer moves the start before overwriting the data and the readers validate the
+    // data they have copied checking that the start hasn't moved past their position
+    uint64_volatile_t offset_start;
+    uint64_volatile_t offset_end;
+    char *data;
+    size_t size;
+};
+
+typedef struct module_redis_replication_worker module_redis_replication_worker_t;
+struct module_redis_replication_worker {
+    uint32_t worker_index;
+    uint32_volatile_t writes_in_flight;
+    uint32_volatile_t writes_unstaged;
+    module_redis_replication_backlog_t backlog;
+};
+
+typedef struct module_redis_replication_registry module_redis_replication_registry_t;
+struct module_redis_replication_registry {
+    spinlock_lock_volatile_t lock;
+    uint32_t workers_count;
+    uint32_t workers_registered_count;
+    module_redis_replication_worker_t **workers;
+    bool_volatile_t active;
+    bool_volatile_t streaming;
+    bool_volatile_t snapshot_running;
+    bool_volatile_t snapshot_barrier;
+    module_redis_replication_role_t role;
+    uint32_volatile_t link_generation;
+};
+
+struct module_redis_replication_client {
+    char *staging;
+    size_t staging_length;
+    size_t staging_size;
+    size_t command_start;
+    size_t multi_start;
+    uint32_t multi_commands_count;
+    bool staging_command;
+    bool staging_multi;
+    bool write_unstaged;
+    bool write_in_flight;
+    bool is_link;
+};
+
+typedef storage_db_snapshot_entry_t module_redis_replication_snapshot_entry_t;
+
+typedef bool (module_redis_replication_snapshot_write_fp_t)(
+        void *user_data,
+        char *data,
+        size_t data_length);
+
+typedef void (module_redis_replication_snapshot_quiesced_fp_t)(
+        void *user_data);
+
+typedef struct module_redis_replication_snapshot module_redis_replication_snapshot_t;
+struct module_redis_replication_snapshot {
+    module_redis_replication_snapshot_write_fp_t *write_fp;
+    void *write_user_data;
+    storage_db_t *db;
+    char *buffer;
+    size_t buffer_length;
+    size_t buffer_size;
+    char *batch;
+    size_t batch_length;
+    size_t batch_size;
+    uint32_t batch_elements_count;
+    bool migrate;
+    uint64_t commands_count;
+};
+
+typedef struct module_redis_replication_link module_redis_replication_link_t;
+struct module_redis_replication_link {
+    uint32_t generation;
+    storage_db_t *db;
+    config_module_t *module_config;
+    union {
+        struct sockaddr base;
+        struct sockaddr_in ipv4;
+        struct sockaddr_in6 ipv6;
+    } address;
+    socklen_t address_size;
+};
+
+static inline __attribute__((always_inline)) bool module_redis_replication_is_staging(
+        module_redis_connection_context_t *connection_context) {
+    return unlikely(connection_context->replication != NULL) && connection_context->replication->staging_command;
+}
+
+bool module_redis_replication_command_begin(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_replication_stage_argument_begin(
+        module_redis_connection_context_t *connection_context,
+        size_t length);
+
+bool module_redis_replication_stage_argument_data(
+        module_redis_connection_context_t *connection_context,
+        char *data,
+        size_t data_length);
+
+bool module_redis_replication_stage_argument_end(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_replication_command_execute_begin(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_replication_command_end(
+        module_redis_connection_context_t *connection_context);
+
+void module_redis_replication_client_free(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_replication_snapshot_take(
+        storage_db_t *db,
+        module_redis_replication_snapshot_quiesced_fp_t *quiesced_fp,
+        void *quiesced_user_data);
+
+bool module_redis_replication_snapshot_serialize(
+        storage_db_t *db,
+        module_redis_replication_snapshot_write_fp_t *write_fp,
+        void *write_user_data,
+        uint64_t *entries_count);
+
+void module_redis_replication_snapshot_end(
+        storage_db_t *db);
+
+bool module_redis_replication_snapshot_serialize_migrate(
+        storage_db_t *db,
+        module_redis_replication_snapshot_entry_t *entries,
+        uint64_t entries_count,
+        module_redis_replication_snapshot_write_fp_t *write_fp,
+        void *write_user_data,
+        uint64_t *commands_count);
+
+void module_redis_replication_snapshot_release(
+        module_redis_replication_snapshot_entry_t *entries,
+        uint64_t entries_count);
+
+void module_redis_replication_enable_staging();
+
+bool module_redis_replication_sync(
+        module_redis_connection_context_t *connection_context);
+
+bool module_redis_replication_replicaof(
+        module_redis_connection_context_t *connection_context,
+        struct sockaddr *address,
+        socklen_t address_size);
+
+void module_redis_replication_replicaof_no_one();
+
+void module_redis_replication_worker_cleanup();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_REPLICATION_H
@@ -0,0 +1,1266 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <arpa/inet.h>
+#include <assert.h>
+#include <mbedtls/sha1.h>
+#include <lua.h>
+#include <lauxlib.h>
+#include <lualib.h>
+#include <luajit.h>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "xalloc.h"
+#include "log/log.h"
+#include "clock.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "config.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "network/channel/network_channel.h"
+#include "network/network.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "worker/worker_op.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_command.h"
+#include "module/redis/command/helpers/module_redis_command_helper_buffer.h"
+
+#include "module_redis_script.h"
+
+#define TAG "module_redis_script"
+
+static module_redis_script_registry_t module_redis_script_registry = { 0 };
+static thread_local module_redis_script_worker_t *module_redis_script_worker = NULL;
+
+static void module_redis_script_sha1_hex(
+        const char *data,
+        size_t data_length,
+        char *sha1) {
+    static const char hex_chars[] = "0123456789abcdef";
+    unsigned char digest[20];
+
+    mbedtls_sha1_ret((const unsigned char *)data, data_length, digest);
+
+    for(int index = 0; index < sizeof(digest); index++) {
+        sha1[index * 2] = hex_chars[digest[index] >> 4];
+        sha1[(index * 2) + 1] = hex_chars[digest[index] & 0x0F];
+    }
+}
+
+static bool module_redis_script_sha1_normalize(
+        char *sha1,
+        size_t sha1_length,
+        char *sha1_normalized) {
+    if (sha1_length != MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH) {
+        return false;
+    }
+
+    for(int index = 0; index < MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH; index++) {
+        sha1_normalized[index] = (char)tolower(sha1[index]);
+    }
+
+    return true;
+}
+
+static void module_redis_script_registry_free() {
+    void *value;
+    hashtable_spsc_bucket_index_t bucket_index = 0;
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+
+    while((value = hashtable_spsc_op_iter(registry->scripts, &bucket_index)) != NULL) {
+        xalloc_free(value);
+        bucket_index++;
+    }
+
+    hashtable_spsc_free(registry->scripts);
+    registry->scripts = NULL;
+}
+
+static bool module_redis_script_registry_add(
+        char *sha1,
+        const char *source,
+        size_t source_length) {
+    bool result_res = true;
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+
+    // The entries are shared by all the workers and any of them can flush the registry, so they are allocated with
+    // xalloc, the source is stored in the same allocation
+    module_redis_script_registry_entry_t *entry = xalloc_alloc(
+            sizeof(module_redis_script_registry_entry_t) + source_length);
+    memcpy(entry->sha1, sha1, MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH);
+    memcpy(entry->source, source, source_length);
+    entry->source_length = source_length;
+
+    spinlock_lock(&registry->lock);
+
+    if (hashtable_spsc_op_get_cs(registry->scripts, sha1, MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH) != NULL) {
+        spinlock_unlock(&registry->lock);
+        xalloc_free(entry);
+        return true;
+    }
+
+    while(!hashtable_spsc_op_try_set_cs(
+            registry->scripts,
+            entry->sha1,
+            MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH,
+            entry)) {
+        hashtable_spsc_t *scripts_new = hashtable_spsc_upsize_cs(registry->scripts);
+
+        if (unlikely(scripts_new == NULL)) {
+            result_res = false;
+            break;
+        }
+
+        hashtable_spsc_free(registry->scripts);
+        registry->scripts = scripts_new;
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    if (unlikely(!result_res)) {
+        xalloc_free(entry);
+    }
+
+    return result_res;
+}
+
+static char *module_redis_script_registry_get_source(
+        char *sha1,
+        size_t *source_length) {
+    char *source = NULL;
+    module_redis_script_registry_entry_t *entry;
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+
+    spinlock_lock(&registry->lock);
+
+    if (registry->scripts != NULL) {
+        entry = hashtable_spsc_op_get_cs(registry->scripts, sha1, MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH);
+
+        // The source is copied as the entry can be freed by a SCRIPT FLUSH invoked by another worker
+        if (entry != NULL) {
+            source = ffma_mem_alloc(entry->source_length);
+            memcpy(source, entry->source, entry->source_length);
+            *source_length = entry->source_length;
+        }
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    return source;
+}
+
+static bool module_redis_script_push_long_string(
+        lua_State *lua,
+        storage_db_t *db,
+        module_redis_long_string_t *string) {
+    luaL_Buffer buffer;
+    bool allocated_new_buffer = false;
+    storage_db_chunk_sequence_t *chunk_sequence = string->chunk_sequence;
+
+    luaL_buffinit(lua, &buffer);
+
+    for(storage_db_chunk_index_t chunk_index = 0; chunk_index < chunk_sequence->count; chunk_index++) {
+        storage_db_chunk_info_t *chunk_info = storage_db_chunk_sequence_get(chunk_sequence, chunk_index);
+
+        char *chunk_data = storage_db_get_chunk_data(
+                db,
+                chunk_info,
+                &allocated_new_buffer);
+        if (unlikely(chunk_data == NULL)) {
+            return false;
+        }
+
+        luaL_addlstring(&buffer, chunk_data, chunk_info->chunk_length);
+
+        if (allocated_new_buffer) {
+            ffma_mem_free(chunk_data);
+            allocated_new_buffer = false;
+        }
+    }
+
+    luaL_pushresult(&buffer);
+
+    return true;
+}
+
+static bool module_redis_script_is_command_allowed(
+        module_redis_command_info_t *command_info) {
+    switch(command_info->command) {
+        case MODULE_REDIS_COMMAND_EVAL:
+        case MODULE_REDIS_COMMAND_EVALSHA:
+        case MODULE_REDIS_COMMAND_SCRIPT:
+        case MODULE_REDIS_COMMAND_MULTI:
+        case MODULE_REDIS_COMMAND_EXEC:
+        case MODULE_REDIS_COMMAND_DISCARD:
+        case MODULE_REDIS_COMMAND_WATCH:
+        case MODULE_REDIS_COMMAND_UNWATCH:
+        case MODULE_REDIS_COMMAND_SUBSCRIBE:
+        case MODULE_REDIS_COMMAND_UNSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_PUNSUBSCRIBE:
+        case MODULE_REDIS_COMMAND_HELLO:
+        case MODULE_REDIS_COMMAND_QUIT:
+        case MODULE_REDIS_COMMAND_SHUTDOWN:
+            return false;
+        default:
+            return true;
+    }
+}
+
+static void module_redis_script_command_execute(
+        lua_State *lua,
+        module_redis_connection_context_t *connection_context) {
+    size_t command_length;
+    const char *command_data;
+    int arguments_count = lua_gettop(lua);
+
+    if (unlikely(arguments_count == 0)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Please specify at least one argument for this redis lib call");
+        return;
+    }
+
+    for(int index = 1; index <= arguments_count; index++) {
+        int type = lua_type(lua, index);
+        if (unlikely(type != LUA_TSTRING && type != LUA_TNUMBER)) {
+            module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR Lua redis lib command arguments must be strings or integers");
+            return;
+        }
+    }
+
+    command_data = lua_tolstring(lua, 1, &command_length);
+    connection_context->command.info = hashtable_spsc_op_get_ci(
+            module_redis_commands_hashtable,
+            command_data,
+            command_length);
+
+    if (unlikely(connection_context->command.info == NULL)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Unknown Redis command called from script");
+        return;
+    }
+
+    if (unlikely(!module_redis_script_is_command_allowed(connection_context->command.info))) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR This Redis command is not allowed from script");
+        return;
+    }
+
+    connection_context->command.arguments_count = arguments_count;
+
+    if (unlikely(connection_context->command.info->required_arguments_count > arguments_count - 1)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR wrong number of arguments for '%s' command",
+                connection_context->command.info->string);
+        return;
+    }
+
+    if (unlikely(!module_redis_command_process_begin(connection_context))) {
+        goto failed;
+    }
+
+    // The arguments are passed to the parser as the network parser does, the data are already available in full so
+    // the streamed arguments get all the data in one go
+    for(int index = 2; index <= arguments_count && !connection_context->command.skip; index++) {
+        size_t argument_length;
+        const char *argument_data = lua_tolstring(lua, index, &argument_length);
+
+        if (unlikely(!module_redis_command_process_argument_begin(connection_context, argument_length))) {
+            goto failed;
+        }
+
+        if (connection_context->command.skip) {
+            break;
+        }
+
+        if (module_redis_command_process_argument_require_stream(connection_context)) {
+            if (unlikely(!module_redis_command_process_argument_stream_data(
+                    connection_context,
+                    (char *)argument_data,
+                    argument_length))) {
+                goto failed;
+            }
+
+            if (unlikely(!module_redis_command_process_argument_stream_end(connection_context))) {
+                goto failed;
+            }
+        } else {
+            if (unlikely(!module_redis_command_process_argument_full(
+                    connection_context,
+                    (char *)argument_data,
+                    argument_length))) {
+                goto failed;
+            }
+        }
+
+        if (unlikely(!module_redis_command_process_argument_end(connection_context))) {
+            goto failed;
+        }
+    }
+
+    if (!connection_context->command.skip) {
+        if (unlikely(!module_redis_command_process_end(connection_context))) {
+            goto failed;
+        }
+    }
+
+    return;
+
+failed:
+    if (!module_redis_connection_has_error(connection_context)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Error running the command '%s' from script",
+                connection_context->command.info->string);
+    }
+}
+
+static char *module_redis_script_push_reply(
+        lua_State *lua,
+        char *data,
+        char *data_end,
+        int depth) {
+    char *line_end;
+    int64_t length;
+
+    if (unlikely(depth > MODULE_REDIS_SCRIPT_REPLY_MAX_DEPTH || !lua_checkstack(lua, 4))) {
+        return NULL;
+    }
+
+    if (unlikely(data >= data_end || (line_end = memchr(data, '\r', data_end - data)) == NULL)) {
+        return NULL;
+    }
+
+    if (unlikely(line_end + 2 > data_end)) {
+        return NULL;
+    }
+
+    // The commands invoked by the scripts always reply using RESP2
+    switch(*data) {
+        case '+':
+        case '-':
+            lua_newtable(lua);
+            lua_pushlstring(lua, data + 1, line_end - data - 1);
+            lua_setfield(lua, -2, *data == '+' ? "ok" : "err");
+            return line_end + 2;
+
+        case ':':
+            lua_pushnumber(lua, (lua_Number)strtoll(data + 1, NULL, 10));
+            return line_end + 2;
+
+        case '$':
+            length = strtoll(data + 1, NULL, 10);
+            data = line_end + 2;
+
+            if (length < 0) {
+                lua_pushboolean(lua, 0);
+                return data;
+            }
+
+            if (unlikely(data + length + 2 > data_end)) {
+                return NULL;
+            }
+
+            lua_pushlstring(lua, data, length);
+            return data + length + 2;
+
+        case '*':
+            length = strtoll(data + 1, NULL, 10);
+            data = line_end + 2;
+
+            if (length < 0) {
+                lua_pushboolean(lua, 0);
+                return data;
+            }
+
+            lua_createtable(lua, (int)length, 0);
+            for(int64_t index = 1; index <= length; index++) {
+                if (unlikely((data = module_redis_script_push_reply(lua, data, data_end, depth + 1)) == NULL)) {
+                    return NULL;
+                }
+
+                lua_rawseti(lua, -2, (int)index);
+            }
+
+            return data;
+
+        default:
+            return NULL;
+    }
+}
+
+static int module_redis_script_lua_call_internal(
+        lua_State *lua,
+        bool raise_error) {
+    module_redis_script_worker_t *worker = module_redis_script_worker;
+    module_redis_connection_context_t *connection_context = &worker->connection_context;
+    network_channel_t *network_channel = &worker->network_channel;
+
+    module_redis_script_command_execute(lua, connection_context);
+
+    // Moves what is left in the send buffer in the capture buffer so the whole reply is available in one place
+    if (unlikely(network_flush_send_buffer(network_channel) != NETWORK_OP_RESULT_OK &&
+            !module_redis_connection_has_error(connection_context))) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Error running the command '%s' from script",
+                connection_context->command.info->string);
+    }
+
+    module_redis_command_process_try_free(connection_context);
+
+    if (module_redis_connection_has_error(connection_context)) {
+        lua_newtable(lua);
+        lua_pushstring(lua, connection_context->error.message);
+        lua_setfield(lua, -2, "err");
+    } else if (unlikely(module_redis_script_push_reply(
+            lua,
+            network_channel->buffers.capture.data,
+            network_channel->buffers.capture.data + network_channel->buffers.capture.data_size,
+            0) == NULL)) {
+        lua_newtable(lua);
+        lua_pushstring(lua, "ERR Unable to parse the reply of the command");
+        lua_setfield(lua, -2, "err");
+        raise_error = true;
+    } else {
+        // The commands replying with an error are raised only by redis.call
+        raise_error = raise_error &&
+                network_channel->buffers.capture.data_size > 0 &&
+                network_channel->buffers.capture.data[0] == '-';
+    }
+
+    // Everything has to be released before raising the error as lua_error doesn't return
+    module_redis_connection_context_reset_command(connection_context);
+    network_channel_capture_reset(network_channel);
+
+    if (raise_error) {
+        return lua_error(lua);
+    }
+
+    return 1;
+}
+
+static int module_redis_script_lua_call(
+        lua_State *lua) {
+    return module_redis_script_lua_call_internal(lua, true);
+}
+
+static int module_redis_script_lua_pcall(
+        lua_State *lua) {
+    return module_redis_script_lua_call_internal(lua, false);
+}
+
+static int module_redis_script_lua_reply(
+        lua_State *lua,
+        const char *field) {
+    size_t length;
+    const char *string = luaL_checklstring(lua, 1, &length);
+
+    lua_newtable(lua);
+    lua_pushlstring(lua, string, length);
+    lua_setfield(lua, -2, field);
+
+    return 1;
+}
+
+static int module_redis_script_lua_error_reply(
+        lua_State *lua) {
+    return module_redis_script_lua_reply(lua, "err");
+}
+
+static int module_redis_script_lua_status_reply(
+        lua_State *lua) {
+    return module_redis_script_lua_reply(lua, "ok");
+}
+
+static int module_redis_script_lua_sha1hex(
+        lua_State *lua) {
+    size_t length;
+    char sha1[MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH];
+    const char *string = luaL_checklstring(lua, 1, &length);
+
+    module_redis_script_sha1_hex(string, length, sha1);
+    lua_pushlstring(lua, sha1, sizeof(sha1));
+
+    return 1;
+}
+
+static void module_redis_script_lua_open_library(
+        lua_State *lua,
+        const char *name,
+        lua_CFunction function) {
+    lua_pushcfunction(lua, function);
+    lua_pushstring(lua, name);
+    lua_call(lua, 1, 0);
+}
+
+static void module_redis_script_lua_setup(
+        lua_State *lua) {
+    // Only the libraries that can't reach the filesystem or the process are loaded
+    module_redis_script_lua_open_library(lua, "", luaopen_base);
+    module_redis_script_lua_open_library(lua, LUA_TABLIBNAME, luaopen_table);
+    module_redis_script_lua_open_library(lua, LUA_STRLIBNAME, luaopen_string);
+    module_redis_script_lua_open_library(lua, LUA_MATHLIBNAME, luaopen_math);
+    module_redis_script_lua_open_library(lua, LUA_BITLIBNAME, luaopen_bit);
+
+    lua_pushnil(lua);
+    lua_setglobal(lua, "dofile");
+    lua_pushnil(lua);
+    lua_setglobal(lua, "loadfile");
+
+    lua_newtable(lua);
+    lua_pushcfunction(lua, module_redis_script_lua_call);
+    lua_setfield(lua, -2, "call");
+    lua_pushcfunction(lua, module_redis_script_lua_pcall);
+    lua_setfield(lua, -2, "pcall");
+    lua_pushcfunction(lua, module_redis_script_lua_error_reply);
+    lua_setfield(lua, -2, "error_reply");
+    lua_pushcfunction(lua, module_redis_script_lua_status_reply);
+    lua_setfield(lua, -2, "status_reply");
+    lua_pushcfunction(lua, module_redis_script_lua_sha1hex);
+    lua_setfield(lua, -2, "sha1hex");
+    lua_setglobal(lua, "redis");
+}
+
+static module_redis_script_worker_t *module_redis_script_worker_get_or_create() {
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+    module_redis_script_worker_t *worker;
+
+    if (likely(module_redis_script_worker)) {
+        return module_redis_script_worker;
+    }
+
+    worker = ffma_mem_alloc_zero(sizeof(module_redis_script_worker_t));
+
+    if ((worker->lua = luaL_newstate()) == NULL) {
+        LOG_E(TAG, "Unable to create the Lua state");
+        ffma_mem_free(worker);
+        return NULL;
+    }
+
+    module_redis_script_lua_setup(worker->lua);
+
+    lua_newtable(worker->lua);
+    worker->scripts_cache_ref = luaL_ref(worker->lua, LUA_REGISTRYINDEX);
+
+    network_channel_init(NETWORK_CHANNEL_TYPE_CAPTURE, &worker->network_channel);
+    worker->connection_context.resp_version = PROTOCOL_REDIS_RESP_VERSION_2;
+    worker->connection_context.network_channel = &worker->network_channel;
+
+    spinlock_lock(&registry->lock);
+
+    // The registry is allocated by the first worker running a script and freed by the last one terminating
+    if (registry->scripts == NULL) {
+        registry->scripts = hashtable_spsc_new(
+                MODULE_REDIS_SCRIPT_REGISTRY_INITIAL_BUCKETS_COUNT,
+                HASHTABLE_SPSC_DEFAULT_MAX_RANGE,
+                false,
+                false);
+    }
+
+    registry->workers_registered_count++;
+    worker->epoch = registry->epoch;
+
+    spinlock_unlock(&registry->lock);
+
+    module_redis_script_worker = worker;
+
+    return worker;
+}
+
+static bool module_redis_script_worker_acquire(
+        module_redis_script_worker_t *worker) {
+    // The Lua state can't be used by two fibers at the same time, a script might be waiting for the storage while
+    // another client of the worker wants to run a script
+    while(unlikely(worker->busy)) {
+        if (!worker_op_timer(0, MODULE_REDIS_SCRIPT_BUSY_WAIT_NS)) {
+            return false;
+        }
+    }
+
+    worker->busy = true;
+
+    // If the registry has been flushed the compiled scripts are dropped
+    if (unlikely(worker->epoch != module_redis_script_registry.epoch)) {
+        worker->epoch = module_redis_script_registry.epoch;
+        lua_newtable(worker->lua);
+        lua_rawseti(worker->lua, LUA_REGISTRYINDEX, worker->scripts_cache_ref);
+    }
+
+    return true;
+}
+
+static void module_redis_script_worker_release(
+        module_redis_script_worker_t *worker) {
+    worker->busy = false;
+}
+
+static bool module_redis_script_compile(
+        module_redis_connection_context_t *connection_context,
+        module_redis_script_worker_t *worker,
+        char *sha1,
+        const char *source,
+        size_t source_length) {
+    lua_State *lua = worker->lua;
+
+    if (luaL_loadbuffer(lua, source, source_length, "@user_script") != 0) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Error compiling script (new function): %s",
+                lua_tostring(lua, -1));
+        lua_pop(lua, 1);
+        return false;
+    }
+
+    // Caches the compiled function leaving it on the top of the stack
+    lua_rawgeti(lua, LUA_REGISTRYINDEX, worker->scripts_cache_ref);
+    lua_pushlstring(lua, sha1, MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH);
+    lua_pushvalue(lua, -3);
+    lua_rawset(lua, -3);
+    lua_pop(lua, 1);
+
+    return true;
+}
+
+static bool module_redis_script_get_cached(
+        module_redis_script_worker_t *worker,
+        char *sha1) {
+    lua_State *lua = worker->lua;
+
+    lua_rawgeti(lua, LUA_REGISTRYINDEX, worker->scripts_cache_ref);
+    lua_pushlstring(lua, sha1, MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH);
+    lua_rawget(lua, -2);
+
+    // Removes the cache table leaving only the function, if found, on the top of the stack
+    if (lua_isnil(lua, -1)) {
+        lua_pop(lua, 2);
+        return false;
+    }
+
+    lua_remove(lua, -2);
+
+    return true;
+}
+
+static void module_redis_script_set_error_from_lua(
+        module_redis_connection_context_t *connection_context,
+        const char *prefix,
+        const char *message,
+        size_t message_length) {
+    module_redis_connection_error_message_printf_noncritical(
+            connection_context,
+            "%s%.*s",
+            prefix,
+            (int)message_length,
+            message);
+
+    // The errors are sent as simple errors, they can't contain new lines
+    for(char *c = connection_context->error.message; c != NULL && *c != 0; c++) {
+        if (*c == '\r' || *c == '\n') {
+            *c = ' ';
+        }
+    }
+}
+
+static bool module_redis_script_send_value(
+        module_redis_connection_context_t *connection_context,
+        lua_State *lua,
+        int depth) {
+    size_t length;
+    const char *string;
+    int count;
+
+    switch(lua_type(lua, -1)) {
+        case LUA_TNUMBER:
+            return module_redis_connection_send_number(connection_context, (int64_t)lua_tonumber(lua, -1));
+
+        case LUA_TSTRING:
+            string = lua_tolstring(lua, -1, &length);
+            return module_redis_connection_send_blob_string(connection_context, (char *)string, length);
+
+        case LUA_TBOOLEAN:
+            return lua_toboolean(lua, -1)
+                ? module_redis_connection_send_number(connection_context, 1)
+                : module_redis_connection_send_string_null(connection_context);
+
+        case LUA_TTABLE:
+            if (unlikely(depth >= MODULE_REDIS_SCRIPT_REPLY_MAX_DEPTH || !lua_checkstack(lua, 4))) {
+                module_redis_connection_error_message_printf_noncritical(
+                        connection_context,
+                        "ERR reached lua stack limit");
+                return module_redis_connection_send_error(connection_context);
+            }
+
+            lua_getfield(lua, -1, "err");
+            if (lua_type(lua, -1) == LUA_TSTRING) {
+                string = lua_tolstring(lua, -1, &length);
+                module_redis_script_set_error_from_lua(connection_context, "", string, length);
+                lua_pop(lua, 1);
+                return module_redis_connection_send_error(connection_context);
+            }
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "ok");
+            if (lua_type(lua, -1) == LUA_TSTRING) {
+                string = lua_tolstring(lua, -1, &length);
+                bool res = module_redis_connection_send_simple_string(connection_context, (char *)string, length);
+                lua_pop(lua, 1);
+                return res;
+            }
+            lua_pop(lua, 1);
+
+            // As in Redis, the array stops at the first nil
+            for(count = 0; ; count++) {
+                lua_rawgeti(lua, -1, count + 1);
+                bool is_nil = lua_isnil(lua, -1);
+                lua_pop(lua, 1);
+
+                if (is_nil) {
+                    break;
+                }
+            }
+
+            if (unlikely(!module_redis_connection_send_array_header(connection_context, count))) {
+                return false;
+            }
+
+            for(int index = 1; index <= count; index++) {
+                lua_rawgeti(lua, -1, index);
+                bool res = module_redis_script_send_value(connection_context, lua, depth + 1);
+                lua_pop(lua, 1);
+
+                if (unlikely(!res)) {
+                    return false;
+                }
+            }
+
+            return true;
+
+        default:
+            return module_redis_connection_send_string_null(connection_context);
+    }
+}
+
+static bool module_redis_script_reply_send(
+        module_redis_connection_context_t *connection_context,
+        network_channel_t *reply_network_channel,
+        bool return_res) {
+    // The capture channel is initialized only if the script has been executed
+    if (reply_network_channel->status != NETWORK_CHANNEL_STATUS_CONNECTED) {
+        return return_res;
+    }
+
+    // Moves what is left in the send buffer in the capture buffer and sends the whole reply to the client
+    if (unlikely(network_flush_send_buffer(reply_network_channel) != NETWORK_OP_RESULT_OK)) {
+        return_res = false;
+    } else if (return_res && reply_network_channel->buffers.capture.data_size > 0 && unlikely(network_send_direct(
+            connection_context->network_channel,
+            reply_network_channel->buffers.capture.data,
+            reply_network_channel->buffers.capture.data_size) != NETWORK_OP_RESULT_OK)) {
+        return_res = false;
+    }
+
+    network_channel_cleanup(reply_network_channel);
+
+    return return_res;
+}
+
+static bool module_redis_script_run(
+        module_redis_connection_context_t *connection_context,
+        module_redis_script_worker_t *worker,
+        network_channel_t *reply_network_channel,
+        int64_t numkeys,
+        module_redis_long_string_t *keys_and_args,
+        int keys_and_args_count) {
+    bool return_res = false;
+    bool transaction_acquired = false;
+    lua_State *lua = worker->lua;
+    transaction_t transaction = { 0 };
+    transaction_t *parent_transaction = NULL;
+    storage_db_key_and_key_length_t *keys = NULL;
+    network_channel_t *network_channel = connection_context->network_channel;
+
+    // The compiled function is expected on the top of the stack
+    if (numkeys > 0) {
+        keys = ffma_mem_alloc(sizeof(storage_db_key_and_key_length_t) * numkeys);
+    }
+
+    lua_createtable(lua, (int)numkeys, 0);
+    for(int64_t index = 0; index < numkeys; index++) {
+        if (unlikely(!module_redis_script_push_long_string(lua, connection_context->db, &keys_and_args[index]))) {
+            goto end;
+        }
+
+        // The strings are referenced by the KEYS table that is referenced by the stack, they stay valid till the
+        // chunks have been locked
+        keys[index].key = (char *)lua_tolstring(lua, -1, &keys[index].key_size);
+        lua_rawseti(lua, -2, (int)index + 1);
+    }
+    lua_pushvalue(lua, -1);
+    lua_setglobal(lua, "KEYS");
+
+    lua_createtable(lua, keys_and_args_count - (int)numkeys, 0);
+    for(int index = (int)numkeys; index < keys_and_args_count; index++) {
+        if (unlikely(!module_redis_script_push_long_string(lua, connection_context->db, &keys_and_args[index]))) {
+            goto end;
+        }
+
+        lua_rawseti(lua, -2, index - (int)numkeys + 1);
+    }
+    lua_setglobal(lua, "ARGV");
+
+    // Locks the chunks of the keys, as EXEC does, the commands invoked by the script run in child transactions sharing
+    // the same id so they can operate on the chunks already locked
+    transaction_acquire(&transaction);
+    transaction_acquired = true;
+
+    if (numkeys > 0 && unlikely(!storage_db_op_lock_keys(
+            connection_context->db,
+            &transaction,
+            keys,
+            (uint32_t)numkeys))) {
+        return_res = module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR unable to lock the keys of the script");
+        goto end;
+    }
+
+    // The KEYS table isn't needed anymore on the stack, the function is on the top again
+    lua_pop(lua, 1);
+
+    worker->network_channel.module_config = connection_context->network_channel->module_config;
+    worker->connection_context.db = connection_context->db;
+
+    parent_transaction = transaction_get_parent_transaction();
+    transaction_set_parent_transaction(&transaction);
+    int pcall_res = lua_pcall(lua, 0, 1, 0);
+    transaction_set_parent_transaction(parent_transaction);
+
+    if (pcall_res != 0) {
+        size_t message_length;
+        const char *message;
+
+        // redis.call raises the error replies of the commands as tables
+        if (lua_istable(lua, -1)) {
+            lua_getfield(lua, -1, "err");
+            message = lua_tolstring(lua, -1, &message_length);
+            if (message != NULL) {
+                module_redis_script_set_error_from_lua(connection_context, "", message, message_length);
+            }
+            lua_pop(lua, 1);
+        } else {
+            message = lua_tolstring(lua, -1, &message_length);
+            module_redis_script_set_error_from_lua(
+                    connection_context,
+                    "ERR Error running script: ",
+                    message ? message : "unknown error",
+                    message ? message_length : strlen("unknown error"));
+        }
+
+        if (!module_redis_connection_has_error(connection_context)) {
+            module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "ERR Error running script");
+        }
+
+        return_res = true;
+        goto end;
+    }
+
+    // The reply is collected by a capture channel and sent by the caller once the locks and the Lua state have been
+    // released, sending it while they are held could yield waiting for the client to read it
+    network_channel_init(NETWORK_CHANNEL_TYPE_CAPTURE, reply_network_channel);
+    reply_network_channel->module_config = network_channel->module_config;
+
+    connection_context->network_channel = reply_network_channel;
+    return_res = module_redis_script_send_value(connection_context, lua, 0);
+    connection_context->network_channel = network_channel;
+
+end:
+    if (transaction_acquired) {
+        transaction_release(&transaction);
+    }
+
+    if (keys) {
+        ffma_mem_free(keys);
+    }
+
+    return return_res;
+}
+
+static bool module_redis_script_validate_numkeys(
+        module_redis_connection_context_t *connection_context,
+        int64_t numkeys,
+        int keys_and_args_count) {
+    if (unlikely(numkeys < 0)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Number of keys can't be negative");
+        return false;
+    }
+
+    if (unlikely(numkeys > keys_and_args_count)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR Number of keys can't be greater than number of args");
+        return false;
+    }
+
+    return true;
+}
+
+bool module_redis_script_eval(
+        module_redis_connection_context_t *connection_context,
+        module_redis_long_string_t *script,
+        int64_t numkeys,
+        module_redis_long_string_t *keys_and_args,
+        int keys_and_args_count) {
+    bool return_res;
+    int stack_top;
+    size_t source_length;
+    const char *source;
+    char sha1[MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH];
+    network_channel_t reply_network_channel = { 0 };
+    module_redis_script_worker_t *worker;
+
+    if (!module_redis_script_validate_numkeys(connection_context, numkeys, keys_and_args_count)) {
+        return true;
+    }
+
+    if (unlikely((worker = module_redis_script_worker_get_or_create()) == NULL)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR unable to initialize the scripting engine");
+    }
+
+    if (unlikely(!module_redis_script_worker_acquire(worker))) {
+        return false;
+    }
+
+    stack_top = lua_gettop(worker->lua);
+
+    if (unlikely(!module_redis_script_push_long_string(worker->lua, connection_context->db, script))) {
+        return_res = false;
+        goto end;
+    }
+
+    source = lua_tolstring(worker->lua, -1, &source_length);
+    module_redis_script_sha1_hex(source, source_length, sha1);
+
+    // The script is compiled only if the worker has never seen it, it's also added to the shared registry to let
+    // EVALSHA work on any worker
+    if (!module_redis_script_get_cached(worker, sha1)) {
+        if (!module_redis_script_compile(connection_context, worker, sha1, source, source_length)) {
+            return_res = true;
+            goto end;
+        }
+
+        if (unlikely(!module_redis_script_registry_add(sha1, source, source_length))) {
+            return_res = false;
+            goto end;
+        }
+    }
+
+    return_res = module_redis_script_run(
+            connection_context,
+            worker,
+            &reply_network_channel,
+            numkeys,
+            keys_and_args,
+            keys_and_args_count);
+
+end:
+    lua_settop(worker->lua, stack_top);
+    module_redis_script_worker_release(worker);
+
+    return module_redis_script_reply_send(connection_context, &reply_network_channel, return_res);
+}
+
+bool module_redis_script_evalsha(
+        module_redis_connection_context_t *connection_context,
+        char *sha1,
+        size_t sha1_length,
+        int64_t numkeys,
+        module_redis_long_string_t *keys_and_args,
+        int keys_and_args_count) {
+    bool return_res;
+    int stack_top;
+    char sha1_normalized[MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH];
+    network_channel_t reply_network_channel = { 0 };
+    module_redis_script_worker_t *worker;
+
+    if (!module_redis_script_validate_numkeys(connection_context, numkeys, keys_and_args_count)) {
+        return true;
+    }
+
+    if (!module_redis_script_sha1_normalize(sha1, sha1_length, sha1_normalized)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "NOSCRIPT No matching script. Please use EVAL.");
+    }
+
+    if (unlikely((worker = module_redis_script_worker_get_or_create()) == NULL)) {
+        return module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR unable to initialize the scripting engine");
+    }
+
+    if (unlikely(!module_redis_script_worker_acquire(worker))) {
+        return false;
+    }
+
+    stack_top = lua_gettop(worker->lua);
+
+    // On a cache miss the source is fetched from the shared registry, the script might have been loaded by another
+    // worker
+    if (!module_redis_script_get_cached(worker, sha1_normalized)) {
+        size_t source_length;
+        char *source = module_redis_script_registry_get_source(sha1_normalized, &source_length);
+
+        if (source == NULL) {
+            return_res = module_redis_connection_error_message_printf_noncritical(
+                    connection_context,
+                    "NOSCRIPT No matching script. Please use EVAL.");
+            goto end;
+        }
+
+        bool compiled = module_redis_script_compile(
+                connection_context,
+                worker,
+                sha1_normalized,
+                source,
+                source_length);
+        ffma_mem_free(source);
+
+        if (!compiled) {
+            return_res = true;
+            goto end;
+        }
+    }
+
+    return_res = module_redis_script_run(
+            connection_context,
+            worker,
+            &reply_network_channel,
+            numkeys,
+            keys_and_args,
+            keys_and_args_count);
+
+end:
+    lua_settop(worker->lua, stack_top);
+    module_redis_script_worker_release(worker);
+
+    return module_redis_script_reply_send(connection_context, &reply_network_channel, return_res);
+}
+
+bool module_redis_script_load(
+        module_redis_connection_context_t *connection_context,
+        module_redis_long_string_t *script,
+        char *sha1) {
+    bool return_res = false;
+    int stack_top;
+    size_t source_length;
+    const char *source;
+    module_redis_script_worker_t *worker;
+
+    if (unlikely((worker = module_redis_script_worker_get_or_create()) == NULL)) {
+        module_redis_connection_error_message_printf_noncritical(
+                connection_context,
+                "ERR unable to initialize the scripting engine");
+        return false;
+    }
+
+    if (unlikely(!module_redis_script_worker_acquire(worker))) {
+        return false;
+    }
+
+    stack_top = lua_gettop(worker->lua);
+
+    if (unlikely(!module_redis_script_push_long_string(worker->lua, connection_context->db, script))) {
+        goto end;
+    }
+
+    source = lua_tolstring(worker->lua, -1, &source_length);
+    module_redis_script_sha1_hex(source, source_length, sha1);
+
+    // The script is compiled right away to report the syntax errors
+    if (!module_redis_script_get_cached(worker, sha1)) {
+        if (!module_redis_script_compile(connection_context, worker, sha1, source, source_length)) {
+            goto end;
+        }
+    }
+
+    return_res = module_redis_script_registry_add(sha1, source, source_length);
+
+end:
+    lua_settop(worker->lua, stack_top);
+    module_redis_script_worker_release(worker);
+
+    return return_res;
+}
+
+bool module_redis_script_exists(
+        char *sha1,
+        size_t sha1_length) {
+    bool exists = false;
+    char sha1_normalized[MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH];
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+
+    if (!module_redis_script_sha1_normalize(sha1, sha1_length, sha1_normalized)) {
+        return false;
+    }
+
+    spinlock_lock(&registry->lock);
+
+    if (registry->scripts != NULL) {
+        exists = hashtable_spsc_op_get_cs(
+                registry->scripts,
+                sha1_normalized,
+                MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH) != NULL;
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    return exists;
+}
+
+module_redis_script_registry_entry_t **module_redis_script_copy_entries(
+        uint32_t *entries_count) {
+    void *value;
+    uint32_t entries_size = 0;
+    hashtable_spsc_bucket_index_t bucket_index = 0;
+    module_redis_script_registry_entry_t **entries = NULL;
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+
+    *entries_count = 0;
+
+    spinlock_lock(&registry->lock);
+
+    if (registry->scripts == NULL) {
+        spinlock_unlock(&registry->lock);
+        return NULL;
+    }
+
+    while((value = hashtable_spsc_op_iter(registry->scripts, &bucket_index)) != NULL) {
+        module_redis_script_registry_entry_t *entry = value;
+        size_t entry_size = sizeof(module_redis_script_registry_entry_t) + entry->source_length;
+
+        if (*entries_count == entries_size) {
+            size_t entries_size_new = entries_size == 0 ? 8 : entries_size * 2;
+            entries = entries == NULL
+                    ? ffma_mem_alloc(sizeof(module_redis_script_registry_entry_t*) * entries_size_new)
+                    : ffma_mem_realloc(
+                            entries,
+                            sizeof(module_redis_script_registry_entry_t*) * entries_size,
+                            sizeof(module_redis_script_registry_entry_t*) * entries_size_new,
+                            false);
+            entries_size = entries_size_new;
+        }
+
+        // The entries are copied as they can be freed by a SCRIPT FLUSH invoked by another worker
+        entries[*entries_count] = module_redis_command_helper_buffer_alloc(entry_size);
+        memcpy(entries[*entries_count], entry, entry_size);
+        (*entries_count)++;
+
+        bucket_index++;
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    return entries;
+}
+
+void module_redis_script_free_entries(
+        module_redis_script_registry_entry_t **entries,
+        uint32_t entries_count) {
+    for(uint32_t index = 0; index < entries_count; index++) {
+        module_redis_command_helper_buffer_free(
+                entries[index],
+                sizeof(module_redis_script_registry_entry_t) + entries[index]->source_length);
+    }
+
+    if (entries) {
+        ffma_mem_free(entries);
+    }
+}
+
+void module_redis_script_flush() {
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+
+    spinlock_lock(&registry->lock);
+
+    if (registry->scripts != NULL) {
+        module_redis_script_registry_free();
+        registry->scripts = hashtable_spsc_new(
+                MODULE_REDIS_SCRIPT_REGISTRY_INITIAL_BUCKETS_COUNT,
+                HASHTABLE_SPSC_DEFAULT_MAX_RANGE,
+                false,
+                false);
+    }
+
+    // The workers drop the compiled scripts the next time they run a script
+    registry->epoch++;
+
+    spinlock_unlock(&registry->lock);
+}
+
+void module_redis_script_worker_cleanup() {
+    module_redis_script_registry_t *registry = &module_redis_script_registry;
+    module_redis_script_worker_t *worker = module_redis_script_worker;
+
+    if (!worker) {
+        return;
+    }
+
+    spinlock_lock(&registry->lock);
+
+    registry->workers_registered_count--;
+
+    if (registry->workers_registered_count == 0) {
+        module_redis_script_registry_free();
+    }
+
+    spinlock_unlock(&registry->lock);
+
+    lua_close(worker->lua);
+    module_redis_connection_context_reset_command(&worker->connection_context);
+    network_channel_cleanup(&worker->network_channel);
+    ffma_mem_free(worker);
+
+    module_redis_script_worker = NULL;
+}
@@ -0,0 +1,91 @@
+#ifndef CACHEGRAND_MODULE_REDIS_SCRIPT_H
+#define CACHEGRAND_MODULE_REDIS_SCRIPT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Each worker runs its own LuaJIT state, created when the worker executes the first script, so the scripts never
+// need locks to run. The compiled functions are cached per worker in a table of the Lua registry indexed by the sha1
+// of the script, the sources are also stored in a registry shared by all the workers, protected by a spinlock, so
+// EVALSHA works regardless of the worker handling the connection and a worker compiles a script only the first time
+// it sees it. SCRIPT FLUSH bumps the epoch of the registry and the workers drop their cache when they notice it.
+//
+// redis.call and redis.pcall feed the arguments straight to the command parser, as the network parser does, and
+// invoke the command with a connection context bound to a capture channel of the worker, the reply is then converted
+// to Lua values.
+//
+// The chunks of the keys passed to the script are locked, as EXEC does, for the whole duration of the script so its
+// operations are atomic for the other workers.
+#define MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH 40
+#define MODULE_REDIS_SCRIPT_REGISTRY_INITIAL_BUCKETS_COUNT 64
+#define MODULE_REDIS_SCRIPT_BUSY_WAIT_NS (100 * 1000)
+#define MODULE_REDIS_SCRIPT_REPLY_MAX_DEPTH 64
+
+struct lua_State;
+
+typedef struct module_redis_script_registry_entry module_redis_script_registry_entry_t;
+struct module_redis_script_registry_entry {
+    char sha1[MODULE_REDIS_SCRIPT_SHA1_HEX_LENGTH];
+    size_t source_length;
+    char source[];
+};
+
+typedef struct module_redis_script_registry module_redis_script_registry_t;
+struct module_redis_script_registry {
+    spinlock_lock_volatile_t lock;
+    uint32_t workers_registered_count;
+    uint32_volatile_t epoch;
+    hashtable_spsc_t *scripts;
+};
+
+typedef struct module_redis_script_worker module_redis_script_worker_t;
+struct module_redis_script_worker {
+    struct lua_State *lua;
+    int scripts_cache_ref;
+    uint32_t epoch;
+    bool busy;
+    network_channel_t network_channel;
+    module_redis_connection_context_t connection_context;
+};
+
+bool module_redis_script_eval(
+        module_redis_connection_context_t *connection_context,
+        module_redis_long_string_t *script,
+        int64_t numkeys,
+        module_redis_long_string_t *keys_and_args,
+        int keys_and_args_count);
+
+bool module_redis_script_evalsha(
+        module_redis_connection_context_t *connection_context,
+        char *sha1,
+        size_t sha1_length,
+        int64_t numkeys,
+        module_redis_long_string_t *keys_and_args,
+        int keys_and_args_count);
+
+bool module_redis_script_load(
+        module_redis_connection_context_t *connection_context,
+        module_redis_long_string_t *script,
+        char *sha1);
+
+bool module_redis_script_exists(
+        char *sha1,
+        size_t sha1_length);
+
+module_redis_script_registry_entry_t **module_redis_script_copy_entries(
+        uint32_t *entries_count);
+
+void module_redis_script_free_entries(
+        module_redis_script_registry_entry_t **entries,
+        uint32_t entries_count);
+
+void module_redis_script_flush();
+
+void module_redis_script_worker_cleanup();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CACHEGRAND_MODULE_REDIS_SCRIPT_H
@@ -90,20 +90,67 @@ bool network_channel_init(
     channel->timeout.write.sec = -1;
     channel->timeout.write.nsec = -1;
 
-    if (channel->type == NETWORK_CHANNEL_TYPE_CLIENT) {
+    if (channel->type == NETWORK_CHANNEL_TYPE_CLIENT || channel->type == NETWORK_CHANNEL_TYPE_CAPTURE) {
         channel->buffers.send.length = NETWORK_CHANNEL_SEND_BUFFER_SIZE;
         channel->buffers.send.data = ffma_mem_alloc(channel->buffers.send.length);
     }
 
+    // The capture channels are always connected, the capture buffer is allocated when the first data are appended
+    if (channel->type == NETWORK_CHANNEL_TYPE_CAPTURE) {
+        channel->status = NETWORK_CHANNEL_STATUS_CONNECTED;
+    }
+
     return true;
 }
 
 void network_channel_cleanup(
         network_channel_t *channel) {
-    if (channel->type == NETWORK_CHANNEL_TYPE_CLIENT) {
+    if (channel->type == NETWORK_CHANNEL_TYPE_CLIENT || channel->type == NETWORK_CHANNEL_TYPE_CAPTURE) {
         ffma_mem_free(channel->buffers.send.data);
         channel->buffers.send.data = NULL;
     }
+
+    if (channel->type == NETWORK_CHANNEL_TYPE_CAPTURE && channel->buffers.capture.data) {
+        ffma_mem_free(channel->buffers.capture.data);
+        channel->buffers.capture.data = NULL;
+    }
+}
+
+bool network_channel_capture_append(
+        network_channel_t *channel,
+        network_channel_buffer_data_t *data,
+        size_t data_length) {
+    network_channel_buffer_t *capture = &channel->buffers.capture;
+
+    assert(channel->type == NETWORK_CHANNEL_TYPE_CAPTURE);
+
+    if (unlikely(capture->data_size + data_length > capture->length)) {
+        size_t new_length = capture->length > 0 ? capture->length : NETWORK_CHANNEL_SEND_BUFFER_SIZE;
+        while(new_length < capture->data_size + data_length) {
+            new_length *= 2;
+        }
+
+        network_channel_buffer_data_t *new_data = capture->data == NULL
+                ? ffma_mem_alloc(new_length)
+                : ffma_mem_realloc(capture->data, capture->length, new_length, false);
+        if (unlikely(new_data == NULL)) {
+            return false;
+        }
+
+        capture->data = new_data;
+        capture->length = new_length;
+    }
+
+    memcpy(capture->data + capture->data_size, data, data_length);
+    capture->data_size += data_length;
+
+    return true;
+}
+
+void network_channel_capture_reset(
+        network_channel_t *channel) {
+    channel->buffers.capture.data_size = 0;
+    channel->buffers.capture.data_offset = 0;
 }
 
 bool network_channel_listener_new_callback(
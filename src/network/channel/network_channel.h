@@ -14,6 +14,9 @@ typedef char network_channel_buffer_data_t;
 enum network_channel_type {
     NETWORK_CHANNEL_TYPE_LISTENER,
     NETWORK_CHANNEL_TYPE_CLIENT,
+    // The data sent over a capture channel are appended to its capture buffer instead of being sent to a socket, it's
+    // used internally to collect the output of the commands
+    NETWORK_CHANNEL_TYPE_CAPTURE,
 };
 typedef enum network_channel_type network_channel_type_t;
 
@@ -60,6 +63,7 @@ struct network_channel {
     network_channel_status_t status;
     struct {
         network_channel_buffer_t send;
+        network_channel_buffer_t capture;
 #if DEBUG == 1
         size_t send_slice_acquired_length;
 #endif
@@ -81,6 +85,10 @@ struct network_channel {
             int64_t nsec;
         } write;
     } timeout;
+    struct {
+        struct fiber *fiber;
+        bool interrupted;
+    } receive;
 };
 
 typedef struct network_create_lister_new_user_data network_channel_listener_new_callback_user_data_t;
@@ -106,6 +114,14 @@ bool network_channel_init(
 void network_channel_cleanup(
         network_channel_t *channel);
 
+bool network_channel_capture_append(
+        network_channel_t *channel,
+        network_channel_buffer_data_t *data,
+        size_t data_length);
+
+void network_channel_capture_reset(
+        network_channel_t *channel);
+
 bool network_channel_listener_new_callback(
         int family,
         struct sockaddr *socket_address,
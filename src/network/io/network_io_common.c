@@ -17,6 +17,7 @@
 #include <linux/filter.h>
 
 #include "misc.h"
+#include "xalloc.h"
 #include "log/log.h"
 
 #include "module/module.h"
@@ -55,33 +56,63 @@ bool network_io_common_socket_set_reuse_port(
 }
 
 bool network_io_common_socket_attach_reuseport_cbpf(
-        network_io_common_fd_t fd) {
-    static struct sock_filter filter[] = {
-            // Pulls out the SKF_AD_CPU (raw_smp_processor_id()) field from the skf socket struct and store it in A
-            //
-            // Documentation (jump to filter machine section)
-            // https://www.freebsd.org/cgi/man.cgi?query=bpf&sektion=4
-            // https://sites.uclouvain.be/SystInfo/usr/include/linux/filter.h.html
-            //
-            // Examples
-            // https://elixir.bootlin.com/linux/latest/source/tools/testing/selftests/net/reuseport_bpf_cpu.c#L81
-            // Code = Load Word (4 bytes) from Absolute Address, Address = SKF absolute address offset + cpu offset
-            {BPF_LD | BPF_W | BPF_ABS, 0, 0, SKF_AD_OFF + SKF_AD_CPU},
-
-            // Returns the registry A
-            {BPF_RET | BPF_A, 0, 0, 0}
-    };
-    static struct sock_fprog val = {
-            .len = ARRAY_SIZE(filter),
-            .filter = filter
-    };
-
-    return network_io_common_socket_set_option(
+        network_io_common_fd_t fd,
+        uint32_t *cpus_to_socket_index_map,
+        uint32_t cpus_count) {
+    bool res;
+    uint32_t filter_length;
+    struct sock_filter *filter;
+    struct sock_fprog val;
+
+    // Without a map the cpu handling the incoming packet is used as index of the socket, otherwise the program compares
+    // the cpu with each entry of the map and returns the index of the socket mapped to it. If no entry matches the cpu
+    // is returned as-is, the kernel falls back to the hash based selection if it's not a valid socket index.
+    // The amount of cpus in the map is limited by the max length of a cBPF program, 2 instructions are needed per cpu.
+    if (cpus_to_socket_index_map == NULL) {
+        cpus_count = 0;
+    } else if (cpus_count > (BPF_MAXINSNS - 2) / 2) {
+        cpus_count = (BPF_MAXINSNS - 2) / 2;
+    }
+
+    filter_length = 2 + (cpus_count * 2);
+    filter = xalloc_alloc_zero(sizeof(struct sock_filter) * filter_length);
+
+    // Pulls out the SKF_AD_CPU (raw_smp_processor_id()) field from the skf socket struct and store it in A
+    //
+    // Documentation (jump to filter machine section)
+    // https://www.freebsd.org/cgi/man.cgi?query=bpf&sektion=4
+    // https://sites.uclouvain.be/SystInfo/usr/include/linux/filter.h.html
+    //
+    // Examples
+    // https://elixir.bootlin.com/linux/latest/source/tools/testing/selftests/net/reuseport_bpf_cpu.c#L81
+    // Code = Load Word (4 bytes) from Absolute Address, Address = SKF absolute address offset + cpu offset
+    filter[0] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, SKF_AD_OFF + SKF_AD_CPU);
+
+    for(uint32_t cpu_index = 0; cpu_index < cpus_count; cpu_index++) {
+        // If A is equal to the cpu index doesn't skip the next instruction, which returns the mapped socket index,
+        // otherwise skips it and moves to the next comparison
+        filter[1 + (cpu_index * 2)] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, cpu_index, 0, 1);
+        filter[2 + (cpu_index * 2)] = (struct sock_filter)BPF_STMT(
+                BPF_RET | BPF_K,
+                cpus_to_socket_index_map[cpu_index]);
+    }
+
+    // Returns the registry A
+    filter[filter_length - 1] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_A, 0);
+
+    val.len = filter_length;
+    val.filter = filter;
+
+    res = network_io_common_socket_set_option(
             fd,
             SOL_SOCKET,
             SO_ATTACH_REUSEPORT_CBPF,
             &val,
             sizeof(val));
+
+    xalloc_free(filter);
+
+    return res;
 }
 
 bool network_io_common_socket_set_nodelay(
@@ -33,7 +33,9 @@ bool network_io_common_socket_set_reuse_port(
         network_io_common_fd_t fd,
         bool enable);
 bool network_io_common_socket_attach_reuseport_cbpf(
-        network_io_common_fd_t fd);
+        network_io_common_fd_t fd,
+        uint32_t *cpus_to_socket_index_map,
+        uint32_t cpus_count);
 bool network_io_common_socket_set_nodelay(
         network_io_common_fd_t fd,
         bool enable);
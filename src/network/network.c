@@ -105,6 +105,10 @@ network_op_result_t network_receive(
         return NETWORK_OP_RESULT_CLOSE_SOCKET;
     }
 
+    // Keep track of the fiber waiting for the data to allow other fibers to interrupt the receive operation
+    channel->receive.fiber = fiber_scheduler_get_current();
+    channel->receive.interrupted = false;
+
     network_op_result_t res;
     if (network_channel_tls_uses_mbedtls(channel)) {
         res = (int32_t)network_tls_receive_internal(
@@ -120,6 +124,8 @@ network_op_result_t network_receive(
                 &received_length);
     }
 
+    channel->receive.fiber = NULL;
+
     if (likely(res == NETWORK_OP_RESULT_OK)) {
         // Increase the amount of actual data (data_size) in the buffer
         buffer->data_size += received_length;
@@ -166,6 +172,15 @@ network_op_result_t network_receive_internal(
 
         return NETWORK_OP_RESULT_CLOSE_SOCKET;
     } else if (unlikely(res == -ECANCELED)) {
+        if (channel->receive.interrupted) {
+            LOG_D(
+                    TAG,
+                    "[FD:%5d][RECV] Receive from client <%s> interrupted",
+                    channel->fd,
+                    channel->address.str);
+            return NETWORK_OP_RESULT_INTERRUPTED;
+        }
+
         LOG_I(
                 TAG,
                 "[FD:%5d][ERROR CLIENT] Receive timeout from client <%s>",
@@ -190,6 +205,23 @@ network_op_result_t network_receive_internal(
     return NETWORK_OP_RESULT_OK;
 }
 
+bool network_receive_interrupt(
+        network_channel_t *channel) {
+    // The receive can be interrupted only if a fiber is actually waiting for it, the fiber will get back
+    // NETWORK_OP_RESULT_INTERRUPTED, a receive already completed is not affected
+    if (channel->receive.fiber == NULL || channel->receive.interrupted) {
+        return false;
+    }
+
+    if (!worker_op_network_receive_cancel(channel)) {
+        return false;
+    }
+
+    channel->receive.interrupted = true;
+
+    return true;
+}
+
 bool network_should_flush_send_buffer(
         network_channel_t *channel) {
     return channel->status == NETWORK_CHANNEL_STATUS_CONNECTED && channel->buffers.send.data_size > 0;
@@ -270,6 +302,12 @@ network_op_result_t network_send_direct_wrapper(
     size_t sent_length;
     network_op_result_t res;
 
+    if (unlikely(channel->type == NETWORK_CHANNEL_TYPE_CAPTURE)) {
+        return network_channel_capture_append(channel, buffer, buffer_length)
+            ? NETWORK_OP_RESULT_OK
+            : NETWORK_OP_RESULT_ERROR;
+    }
+
     if (network_channel_tls_uses_mbedtls(channel)) {
         res = (int32_t) network_tls_send_direct_internal(
                 channel,
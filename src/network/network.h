@@ -9,6 +9,7 @@ enum network_op_result {
     NETWORK_OP_RESULT_OK,
     NETWORK_OP_RESULT_CLOSE_SOCKET,
     NETWORK_OP_RESULT_ERROR,
+    NETWORK_OP_RESULT_INTERRUPTED,
 };
 typedef enum network_op_result network_op_result_t;
 
@@ -28,6 +29,9 @@ network_op_result_t network_receive(
         network_channel_buffer_t *buffer,
         size_t receive_length);
 
+bool network_receive_interrupt(
+        network_channel_t *channel);
+
 network_op_result_t network_receive_internal(
         network_channel_t *channel,
         network_channel_buffer_data_t *buffer,
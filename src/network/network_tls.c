@@ -389,6 +389,15 @@ network_op_result_t network_tls_receive_internal(
 
             return NETWORK_OP_RESULT_CLOSE_SOCKET;
         } else if (res == -ECANCELED) {
+            if (channel->receive.interrupted) {
+                LOG_D(
+                        TAG,
+                        "[FD:%5d][RECV] Receive from client <%s> interrupted",
+                        channel->fd,
+                        channel->address.str);
+                return NETWORK_OP_RESULT_INTERRUPTED;
+            }
+
             LOG_I(
                     TAG,
                     "[FD:%5d][ERROR CLIENT] Send timeout to client <%s>",
@@ -434,46 +443,51 @@ network_op_result_t network_tls_send_direct_internal(
         return NETWORK_OP_RESULT_CLOSE_SOCKET;
     }
 
-    while((res = mbedtls_ssl_write(
-            channel->tls.context,
-            (unsigned char*)buffer,
-            buffer_length)) <= 0) {
-        if (res == MBEDTLS_ERR_SSL_WANT_READ || res == MBEDTLS_ERR_SSL_WANT_WRITE) {
-            continue;
+    *sent_length = 0;
+
+    // mbedtls writes at most a record per call, the data are sent in a loop to allow large buffers to be sent in one go
+    do {
+        while((res = mbedtls_ssl_write(
+                channel->tls.context,
+                (unsigned char*)buffer + *sent_length,
+                buffer_length - *sent_length)) <= 0) {
+            if (res == MBEDTLS_ERR_SSL_WANT_READ || res == MBEDTLS_ERR_SSL_WANT_WRITE) {
+                continue;
+            }
+
+            if (res == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || res == MBEDTLS_ERR_NET_CONN_RESET || res == 0) {
+                LOG_D(
+                        TAG,
+                        "[FD:%5d][RECV] The client <%s> closed the connection",
+                        channel->fd,
+                        channel->address.str);
+
+                return NETWORK_OP_RESULT_CLOSE_SOCKET;
+            } else if (res == -ECANCELED) {
+                LOG_I(
+                        TAG,
+                        "[FD:%5d][ERROR CLIENT] Send timeout to client <%s>",
+                        channel->fd,
+                        channel->address.str);
+                return NETWORK_OP_RESULT_ERROR;
+            } else {
+                char errbuf[256] = { 0 };
+                mbedtls_strerror(res, errbuf, sizeof(errbuf) - 1);
+
+                LOG_I(
+                        TAG,
+                        "[FD:%5d][ERROR CLIENT] Error <%s (%d)> from client <%s>",
+                        channel->fd,
+                        errbuf,
+                        -res,
+                        channel->address.str);
+
+                return NETWORK_OP_RESULT_ERROR;
+            }
         }
 
-        if (res == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || res == MBEDTLS_ERR_NET_CONN_RESET || res == 0) {
-            LOG_D(
-                    TAG,
-                    "[FD:%5d][RECV] The client <%s> closed the connection",
-                    channel->fd,
-                    channel->address.str);
-
-            return NETWORK_OP_RESULT_CLOSE_SOCKET;
-        } else if (res == -ECANCELED) {
-            LOG_I(
-                    TAG,
-                    "[FD:%5d][ERROR CLIENT] Send timeout to client <%s>",
-                    channel->fd,
-                    channel->address.str);
-            return NETWORK_OP_RESULT_ERROR;
-        } else {
-            char errbuf[256] = { 0 };
-            mbedtls_strerror(res, errbuf, sizeof(errbuf) - 1);
-
-            LOG_I(
-                    TAG,
-                    "[FD:%5d][ERROR CLIENT] Error <%s (%d)> from client <%s>",
-                    channel->fd,
-                    errbuf,
-                    -res,
-                    channel->address.str);
-
-            return NETWORK_OP_RESULT_ERROR;
-        }
-    }
-
-    *sent_length = res;
+        *sent_length += res;
+    } while(*sent_length < buffer_length);
 
     return NETWORK_OP_RESULT_OK;
 }
@@ -112,6 +112,7 @@ bool program_epoch_gc_workers_initialize(
         program_context_t *program_context) {
 
     int epoch_gc_workers_count = (int)EPOCH_GC_OBJECT_TYPE_MAX;
+    program_context->epoch_gc_workers_count = epoch_gc_workers_count;
     program_context->epoch_gc_workers_context =
             xalloc_alloc_zero(epoch_gc_workers_count * sizeof(epoch_gc_worker_context_t));
 
@@ -168,7 +169,8 @@ worker_context_t* program_workers_initialize_context(
                 worker_index,
                 terminate_event_loop,
                 program_context->config,
-                program_context->db);
+                program_context->db,
+                program_context->epoch_gc_workers_context);
 
         LOG_V(TAG, "Setting up worker <%u>", worker_index);
 
@@ -618,6 +620,14 @@ bool program_config_setup_storage_db(
 
     config->max_keys = program_context->config->database->max_keys;
 
+    // The amount of keys per hash slot is tracked only if the cluster mode is enabled in any module
+    for(uint8_t module_index = 0; module_index < program_context->config->modules_count; module_index++) {
+        config_module_t *module = &program_context->config->modules[module_index];
+        if (module->type == CONFIG_MODULE_TYPE_REDIS && module->redis && module->redis->cluster) {
+            config->track_keys_slots = true;
+        }
+    }
+
     if (program_context->config->database->backend == CONFIG_DATABASE_BACKEND_FILE) {
         config->backend.file.shard_size_mb = program_context->config->database->file->shard_size_mb;
         config->backend.file.basedir_path = program_context->config->database->file->path;
@@ -670,11 +680,8 @@ void program_cleanup(
         xalloc_free(program_context->signal_handler_thread_context);
     }
 
-    if (program_context->db) {
-        storage_db_close(program_context->db);
-        storage_db_free(program_context->db, program_context->workers_count);
-    }
-
+    // The epoch gc workers have to be terminated before freeing up the db as they free up the entry indexes staged by
+    // the workers
     if (program_context->epoch_gc_workers_context) {
         program_epoch_gc_workers_cleanup(
                 program_context->epoch_gc_workers_context,
@@ -682,6 +689,11 @@ void program_cleanup(
         xalloc_free(program_context->epoch_gc_workers_context);
     }
 
+    if (program_context->db) {
+        storage_db_close(program_context->db);
+        storage_db_free(program_context->db, program_context->workers_count);
+    }
+
     if (program_context->fast_memory_allocator_initialized) {
         hugepage_cache_free();
     }
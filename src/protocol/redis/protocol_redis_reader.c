@@ -13,10 +13,369 @@
 #include <assert.h>
 
 #include "misc.h"
+#include "utils_string.h"
 #include "protocol_redis.h"
 
 #include "protocol_redis_reader.h"
 
+typedef struct protocol_redis_reader_newlines_index protocol_redis_reader_newlines_index_t;
+struct protocol_redis_reader_newlines_index {
+    uint32_t newlines[PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE];
+    uint32_t count;
+    uint32_t cursor;
+    size_t base_offset;
+    size_t end_offset;
+};
+
+IFUNC_WRAPPER_RESOLVE(PROTOCOL_REDIS_READER_NAME_IFUNC(index_newlines)) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1
+    if (__builtin_cpu_supports("avx512bw")) {
+        return PROTOCOL_REDIS_READER_NAME_IMPL(index_newlines, avx512bw);
+    }
+#endif
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")) {
+        return PROTOCOL_REDIS_READER_NAME_IMPL(index_newlines, avx2);
+    }
+#else
+#warning "missing optimized protocol redis reader function for the current architecture"
+#endif
+
+    return PROTOCOL_REDIS_READER_NAME_IMPL(index_newlines, sw);
+}
+
+uint32_t IFUNC_WRAPPER(PROTOCOL_REDIS_READER_NAME_IFUNC(index_newlines), (
+        const char *buffer, size_t length, uint32_t *newlines, uint32_t newlines_size, size_t *scanned_length));
+
+static inline char *protocol_redis_reader_newlines_index_find(
+        protocol_redis_reader_newlines_index_t *newlines_index,
+        char *buffer,
+        size_t length,
+        size_t offset) {
+    do {
+        // Skip the new lines indexed before the requested offset, they belong to the lines already parsed or to the
+        // argument data
+        while(newlines_index->cursor < newlines_index->count) {
+            size_t new_line_offset =
+                    newlines_index->base_offset + newlines_index->newlines[newlines_index->cursor];
+
+            if (likely(new_line_offset >= offset)) {
+                return buffer + new_line_offset;
+            }
+
+            newlines_index->cursor++;
+        }
+
+        // The index has been consumed, if there are data not yet scanned it gets refilled starting from the requested
+        // offset or from the end of the previous scan, whichever comes later
+        size_t scan_offset = MAX(offset, newlines_index->end_offset);
+        if (scan_offset >= length) {
+            return NULL;
+        }
+
+        size_t scanned_length = 0;
+        newlines_index->count = protocol_redis_reader_index_newlines(
+                buffer + scan_offset,
+                MIN(length - scan_offset, PROTOCOL_REDIS_READER_NEWLINES_INDEX_WINDOW_SIZE),
+                newlines_index->newlines,
+                PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE,
+                &scanned_length);
+        newlines_index->cursor = 0;
+        newlines_index->base_offset = scan_offset;
+        newlines_index->end_offset = scan_offset + scanned_length;
+    } while(true);
+}
+
+static inline bool protocol_redis_reader_parse_length(
+        char *start,
+        char *end,
+        long *value) {
+    long result = 0;
+
+    // Only non-negative numbers are accepted and 18 digits are always enough to avoid overflowing a long
+    if (unlikely(start == end || end - start > 18)) {
+        return false;
+    }
+
+    for(; start < end; start++) {
+        if (unlikely(*start < '0' || *start > '9')) {
+            return false;
+        }
+
+        result = (result * 10) + (*start - '0');
+    }
+
+    *value = result;
+    return true;
+}
+
+static inline bool protocol_redis_reader_inline_is_space(
+        char c) {
+    return c == ' ' || c == '\t';
+}
+
+static inline size_t protocol_redis_reader_inline_skip_empty_lines(
+        char *buffer,
+        size_t length) {
+    size_t skipped_length = 0;
+
+    while(skipped_length < length) {
+        char c = buffer[skipped_length];
+        if (!protocol_redis_reader_inline_is_space(c) && c != '\r' && c != '\n') {
+            break;
+        }
+
+        skipped_length++;
+    }
+
+    return skipped_length;
+}
+
+static inline bool protocol_redis_reader_inline_is_hex_digit(
+        char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static inline char protocol_redis_reader_inline_hex_digit_to_int(
+        char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+
+    return c - 'A' + 10;
+}
+
+static bool protocol_redis_reader_inline_parse_argument(
+        char *start,
+        char *end,
+        bool decode,
+        char **argument_end,
+        size_t *data_length) {
+    char *read_ptr = start;
+    char *write_ptr = start;
+    char quote_char = *start;
+
+    // Arguments without quotes are returned as they are, no decoding is needed
+    if (quote_char != '"' && quote_char != '\'') {
+        while(read_ptr < end && !protocol_redis_reader_inline_is_space(*read_ptr)) {
+            read_ptr++;
+        }
+
+        *argument_end = read_ptr;
+        *data_length = read_ptr - start;
+        return true;
+    }
+
+    // The quoted arguments are decoded in place, the decoded data are always shorter than the raw data so they are
+    // written starting from the opening quote and the argument can still be referenced by offset (zero-copy).
+    // The escaping rules are the same used by redis, double quotes support \xHH and the common escape sequences
+    // while single quotes only support \'
+    read_ptr++;
+    do {
+        char c;
+
+        if (unlikely(read_ptr == end)) {
+            return false;
+        }
+
+        if (quote_char == '"' &&
+            *read_ptr == '\\' &&
+            end - read_ptr >= 4 &&
+            *(read_ptr + 1) == 'x' &&
+            protocol_redis_reader_inline_is_hex_digit(*(read_ptr + 2)) &&
+            protocol_redis_reader_inline_is_hex_digit(*(read_ptr + 3))) {
+            c = (char)((protocol_redis_reader_inline_hex_digit_to_int(*(read_ptr + 2)) << 4) |
+                    protocol_redis_reader_inline_hex_digit_to_int(*(read_ptr + 3)));
+            read_ptr += 4;
+        } else if (quote_char == '"' && *read_ptr == '\\' && end - read_ptr >= 2) {
+            switch(*(read_ptr + 1)) {
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'b': c = '\b'; break;
+                case 'a': c = '\a'; break;
+                default: c = *(read_ptr + 1); break;
+            }
+            read_ptr += 2;
+        } else if (quote_char == '\'' && *read_ptr == '\\' && end - read_ptr >= 2 && *(read_ptr + 1) == '\'') {
+            c = '\'';
+            read_ptr += 2;
+        } else if (*read_ptr == quote_char) {
+            read_ptr++;
+
+            // The closing quote must be followed by a space or by the end of the line
+            if (unlikely(read_ptr < end && !protocol_redis_reader_inline_is_space(*read_ptr))) {
+                return false;
+            }
+
+            break;
+        } else {
+            c = *read_ptr;
+            read_ptr++;
+        }
+
+        if (decode) {
+            *write_ptr = c;
+        }
+        write_ptr++;
+    } while(true);
+
+    *argument_end = read_ptr;
+    *data_length = write_ptr - start;
+    return true;
+}
+
+static inline char *protocol_redis_reader_inline_line_end(
+        char *line_ptr,
+        char *new_line_ptr) {
+    // The \r before the \n is optional with the inline protocol
+    if (new_line_ptr > line_ptr && *(new_line_ptr - 1) == '\r') {
+        return new_line_ptr - 1;
+    }
+
+    return new_line_ptr;
+}
+
+static bool protocol_redis_reader_read_inline_command_begin(
+        char *buffer,
+        size_t *read_offset,
+        size_t skipped_length,
+        char *new_line_ptr,
+        protocol_redis_reader_context_t *context,
+        protocol_redis_reader_op_t *ops,
+        uint8_t *op_index) {
+    char *line_ptr = buffer + *read_offset + skipped_length;
+    char *line_end_ptr = protocol_redis_reader_inline_line_end(line_ptr, new_line_ptr);
+    char *argument_ptr = line_ptr;
+    uint32_t arguments_count = 0;
+
+    if (unlikely(new_line_ptr - line_ptr > PROTOCOL_REDIS_READER_INLINE_MAX_LENGTH)) {
+        context->error = PROTOCOL_REDIS_READER_ERROR_INLINE_COMMAND_TOO_LONG;
+        return false;
+    }
+
+    // The amount of arguments has to be known upfront so the line is tokenized once without decoding the arguments,
+    // the empty lines have already been skipped so there is always at least one argument
+    do {
+        size_t data_length;
+
+        while(argument_ptr < line_end_ptr && protocol_redis_reader_inline_is_space(*argument_ptr)) {
+            argument_ptr++;
+        }
+
+        if (argument_ptr == line_end_ptr) {
+            break;
+        }
+
+        if (unlikely(!protocol_redis_reader_inline_parse_argument(
+                argument_ptr,
+                line_end_ptr,
+                false,
+                &argument_ptr,
+                &data_length))) {
+            context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES;
+            return false;
+        }
+
+        arguments_count++;
+    } while(true);
+
+    assert(arguments_count > 0);
+
+    // The empty lines skipped are accounted in the command begin op
+    *read_offset += skipped_length;
+
+    context->arguments.count = arguments_count;
+    context->protocol_type = PROTOCOL_REDIS_READER_PROTOCOL_TYPE_INLINE;
+    context->state = PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT;
+    context->arguments.current.index = -1;
+    context->arguments.current.beginning = true;
+    context->arguments.current.length = 0;
+
+    ops[*op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN;
+    ops[*op_index].data_read_len = (off_t)skipped_length;
+    ops[*op_index].data.command.arguments_count = context->arguments.count;
+    (*op_index)++;
+
+    return true;
+}
+
+static bool protocol_redis_reader_read_inline_argument(
+        char *buffer,
+        size_t *read_offset,
+        char *new_line_ptr,
+        protocol_redis_reader_context_t *context,
+        protocol_redis_reader_op_t *ops,
+        uint8_t *op_index) {
+    char *line_ptr = buffer + *read_offset;
+    char *line_end_ptr = protocol_redis_reader_inline_line_end(line_ptr, new_line_ptr);
+    char *argument_ptr = line_ptr;
+    char *argument_end_ptr;
+    size_t data_length;
+
+    while(argument_ptr < line_end_ptr && protocol_redis_reader_inline_is_space(*argument_ptr)) {
+        argument_ptr++;
+    }
+
+    // The line has already been tokenized when the command began, the checks are carried out again only for safety
+    if (unlikely(argument_ptr == line_end_ptr || !protocol_redis_reader_inline_parse_argument(
+            argument_ptr,
+            line_end_ptr,
+            true,
+            &argument_end_ptr,
+            &data_length))) {
+        context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES;
+        return false;
+    }
+
+    context->arguments.current.index++;
+    context->arguments.current.length = data_length;
+    context->arguments.current.received_length = data_length;
+
+    // The whole argument is always available, the same sequence of ops of a RESP argument is emitted to let the
+    // caller process both the protocols in the same way, the data of the argument start at the offset of the
+    // argument in the buffer, quotes and escape sequences have already been decoded
+    ops[*op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN;
+    ops[*op_index].data_read_len = (off_t)(argument_ptr - line_ptr);
+    ops[*op_index].data.argument.index = context->arguments.current.index;
+    ops[*op_index].data.argument.length = data_length;
+    (*op_index)++;
+
+    ops[*op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA;
+    ops[*op_index].data_read_len = (off_t)(argument_end_ptr - argument_ptr);
+    ops[*op_index].data.argument.index = context->arguments.current.index;
+    ops[*op_index].data.argument.length = data_length;
+    ops[*op_index].data.argument.offset = argument_ptr - buffer;
+    ops[*op_index].data.argument.data_length = data_length;
+    (*op_index)++;
+
+    ops[*op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END;
+    ops[*op_index].data_read_len = 0;
+    ops[*op_index].data.argument.index = context->arguments.current.index;
+    ops[*op_index].data.argument.length = data_length;
+    ops[*op_index].data.argument.offset = argument_end_ptr - buffer;
+    (*op_index)++;
+
+    *read_offset = argument_end_ptr - buffer;
+
+    if (context->arguments.current.index == context->arguments.count - 1) {
+        context->state = PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED;
+
+        // The trailing spaces and the new line are accounted in the command end op
+        ops[*op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END;
+        ops[*op_index].data_read_len = (off_t)(new_line_ptr + 1 - argument_end_ptr);
+        ops[*op_index].data.command.arguments_count = context->arguments.count;
+        (*op_index)++;
+
+        *read_offset = new_line_ptr + 1 - buffer;
+    }
+
+    return true;
+}
+
 void protocol_redis_reader_context_reset(
         protocol_redis_reader_context_t* context) {
     memset(context, 0, sizeof(protocol_redis_reader_context_t));
@@ -31,11 +390,8 @@ int32_t protocol_redis_reader_read(
     size_t read_offset = 0;
     uint8_t op_index = 0;
 
-    // TODO: the function can be optimized to process the entire buffer till ops is filled but this requires (1) the
-    //       ability to terminate the parsing once ops is full and (2) the ability to loop over the entire buffer that
-    //       means basically wrapping all the code into this function in a giant while loop that terminates if (2.1) ops
-    //       is full, (2.2) if the entire buffer has been processed (read_offset == length or buffer == buffer_end_ptr)
-    //       or (2.3) if there is a parser error (i.e. all the various return -1 represent a non recoverable error)
+    // This function parses at most one argument per invocation, protocol_redis_reader_read_batch processes the entire
+    // buffer till ops is filled and should be preferred when the data are coming from the network
 
     // Ensure there is going to be enough space to hold the maximum amount of data that can be processed
     assert(ops_size >= 6);
@@ -54,259 +410,116 @@ int32_t protocol_redis_reader_read(
     // The reader has first to check if the state is BEGIN, it needs to identify if the command is resp (RESP3)
     // or if it is inlined checking the first byte.
     if (unlikely(context->state == PROTOCOL_REDIS_READER_STATE_BEGIN)) {
-        char first_byte = *(char*)buffer;
-        bool is_inline = first_byte != PROTOCOL_REDIS_TYPE_ARRAY;
+        size_t skipped_length = 0;
+
+        // Empty lines between the commands are skipped, as redis does, and are accounted in the command begin op
+        if (unlikely(*buffer != PROTOCOL_REDIS_TYPE_ARRAY)) {
+            skipped_length = protocol_redis_reader_inline_skip_empty_lines(buffer, length);
+            if (unlikely(skipped_length == length)) {
+                return op_index;
+            }
+        }
+
+        bool is_inline = buffer[skipped_length] != PROTOCOL_REDIS_TYPE_ARRAY;
 
         if (unlikely(is_inline)) {
-            context->error = PROTOCOL_REDIS_READER_ERROR_INLINE_PROTOCOL_NOT_SUPPORTED;
-            return -1;
-//            context->protocol_type = PROTOCOL_REDIS_READER_PROTOCOL_TYPE_INLINE;
-//            context->state = PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT;
-//            context->arguments.count = 0;
+            char *new_line_ptr = memchr(buffer + skipped_length, '\n', length - skipped_length);
+            if (unlikely(new_line_ptr == NULL)) {
+                // The inline commands are parsed only when the entire line has been received
+                if (unlikely(length - skipped_length > PROTOCOL_REDIS_READER_INLINE_MAX_LENGTH)) {
+                    context->error = PROTOCOL_REDIS_READER_ERROR_INLINE_COMMAND_TOO_LONG;
+                    return -1;
+                }
+
+                return op_index;
+            }
+
+            if (unlikely(!protocol_redis_reader_read_inline_command_begin(
+                    buffer,
+                    &read_offset,
+                    skipped_length,
+                    new_line_ptr,
+                    context,
+                    ops,
+                    &op_index))) {
+                return -1;
+            }
+
+            buffer += skipped_length;
+            length -= skipped_length;
+        } else {
+            read_offset += skipped_length;
+            buffer += skipped_length;
+            length -= skipped_length;
+
+            char *new_line_ptr = memchr(buffer, '\n', length);
+            if (unlikely(new_line_ptr == NULL)) {
+                // If the new line can't be found, it means that we received partial data and need to wait for more
+                // before trying to parse again, the state is not changed on purpose.
+                return op_index;
+            }
+
+            // Ensure that there is at least 1 character and the \r before the found \n
+            if (unlikely(new_line_ptr - buffer < 2 || *(new_line_ptr - 1) != '\r')) {
+                context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH;
+                return -1;
+            }
+
+            // Convert the argument count to a number
+            char *args_count_end_ptr = NULL;
+            long args_count = strtol(buffer + 1, &args_count_end_ptr, 10);
+
+            if (new_line_ptr - 1 != args_count_end_ptr ||
+                args_count <= 0) {
+                context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH;
+                return -1;
+            }
+
+            // Update context arguments count and allocates the memory for the arguments
+            context->arguments.count = args_count;
+
+            // Update the amount of processed data
+            unsigned long move_offset = new_line_ptr - buffer + 1;
+            read_offset += move_offset;
+            buffer += move_offset;
+            length -= move_offset;
+
+            // Update the internal state
+            context->protocol_type = PROTOCOL_REDIS_READER_PROTOCOL_TYPE_RESP;
+            context->state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_LENGTH;
+            context->arguments.current.index = -1;
+            context->arguments.current.beginning = true;
+            context->arguments.current.length = 0;
+
+            // Update the ops list
+            ops[op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN;
+            ops[op_index].data_read_len = (off_t)(skipped_length + move_offset);
+            ops[op_index].data.command.arguments_count = context->arguments.count;
+            op_index++;
         }
+    }
 
+    // PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT is inline protocol only, the entire line is always available
+    // so one argument is parsed per invocation as it's done with the RESP protocol
+    if (unlikely(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT)) {
         char *new_line_ptr = memchr(buffer, '\n', length);
         if (unlikely(new_line_ptr == NULL)) {
-            // If the new line can't be found, it means that we received partial data and need to wait for more
-            // before trying to parse again, the state is not changed on purpose.
             return op_index;
         }
 
-        // Ensure that there is at least 1 character and the \r before the found \n
-        if (unlikely(new_line_ptr - buffer < 2 || *(new_line_ptr - 1) != '\r')) {
-            context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH;
-            return -1;
-        }
-
-        // Convert the argument count to a number
-        char *args_count_end_ptr = NULL;
-        long args_count = strtol(buffer + 1, &args_count_end_ptr, 10);
-
-        if (new_line_ptr - 1 != args_count_end_ptr ||
-            args_count <= 0) {
-            context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH;
+        if (unlikely(!protocol_redis_reader_read_inline_argument(
+                buffer - read_offset,
+                &read_offset,
+                new_line_ptr,
+                context,
+                ops,
+                &op_index))) {
             return -1;
         }
 
-        // Update context arguments count and allocates the memory for the arguments
-        context->arguments.count = args_count;
-
-        // Update the amount of processed data
-        unsigned long move_offset = new_line_ptr - buffer + 1;
-        read_offset += move_offset;
-        buffer += move_offset;
-        length -= move_offset;
-
-        // Update the internal state
-        context->protocol_type = PROTOCOL_REDIS_READER_PROTOCOL_TYPE_RESP;
-        context->state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_LENGTH;
-        context->arguments.current.index = -1;
-        context->arguments.current.beginning = true;
-        context->arguments.current.length = 0;
-
-        // Update the ops list
-        ops[op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN;
-        ops[op_index].data_read_len = (off_t)move_offset;
-        ops[op_index].data.command.arguments_count = context->arguments.count;
-        op_index++;
+        return op_index;
     }
 
-    // The INLINE protocol parser has been disabled, supporting this variant of the protocol is not a priority as it is
-    // unused in production systems and it's barely used for manual development / testing purposes (as it's just easier
-    // to use redis-cli which properly supports RESP3)
-//    // PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT is inline protocol only
-//    // Set this as unlikely to give priority to the other code paths
-//    if (unlikely(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT)) {
-//        bool is_arg_end_newline = false;
-//        bool arg_end_char_found = false;
-//        char* arg_start_char_ptr = buffer;
-//        char* arg_end_char_ptr;
-//        unsigned long data_length;
-//
-//        // Check if the string starts with a single or double quote.
-//        // If double quotes, need to parse chars in hex format \xHH
-//        // Every time a new argument is found, the array needs to be realloc and the counter incremented
-//        // TODO: improve it, it's crap
-//
-//        // Check if it's the beginning of the command parsing
-//        if (context->arguments.current.beginning) {
-//            // Skip any additional space character
-//            do {
-//                if (*arg_start_char_ptr != ' ') {
-//                    break;
-//                }
-//            } while (arg_start_char_ptr++ && arg_start_char_ptr < buffer_end_ptr);
-//
-//            // TODO: the parser has to be refactored to do not make assumption, the loop above may get on buffer_end_ptr
-//            //       and arg_start_char_ptr be not initialized!
-//            char first_byte = *arg_start_char_ptr;
-//            if (first_byte == '\'' || first_byte == '"') {
-//                context->arguments.inline_protocol.current.quote_char = first_byte;
-//                context->arguments.inline_protocol.current.decode_escaped_chars = first_byte == '"';
-//
-//                arg_start_char_ptr++;
-//            } else {
-//                context->arguments.inline_protocol.current.quote_char = 0;
-//                context->arguments.inline_protocol.current.decode_escaped_chars = false;
-//            }
-//        }
-//
-//        arg_end_char_ptr = arg_start_char_ptr;
-//        char arg_search_char = (context->arguments.inline_protocol.current.quote_char != 0)
-//                ? context->arguments.inline_protocol.current.quote_char
-//                : ' ';
-//        do {
-//            // Would be much better to use memchr but it's not possible to search for multiple characters. The do/while
-//            // loop below is slower than memchr but the inline_protocol (inline) protocol should be used only for debugging
-//            // or the simple HELLO/PING commands so doesn't matter
-//            do {
-//                // Check if it has found the end of the argument
-//                if (*arg_end_char_ptr == '\n' || *arg_end_char_ptr == arg_search_char) {
-//                    arg_end_char_found = true;
-//                    break;
-//                }
-//            } while (arg_end_char_ptr++ && arg_end_char_ptr < buffer_end_ptr);
-//
-//            // Check if it has found the end char
-//            if (arg_end_char_found) {
-//                // Ensure that if a quote is expected the argument end char is not a new line, multiline commands are
-//                // not allowed in inline_protocol (inline) mode in redis
-//                if (context->arguments.inline_protocol.current.quote_char != 0 && *arg_end_char_ptr == '\n') {
-//                    context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES;
-//                    return -1;
-//                }
-//
-//                // If the argument is wrapped in double quotes ensure that the quote found is not escaped
-//                if (context->arguments.inline_protocol.current.quote_char != 0 &&
-//                    context->arguments.inline_protocol.current.decode_escaped_chars) {
-//                    // Count the number of backslashes, if any
-//                    char* backslash_char_ptr = arg_end_char_ptr;
-//                    uint64_t backslash_count = 0;
-//                    while(*--backslash_char_ptr == '\\') {
-//                        backslash_count++;
-//                    }
-//
-//                    // If found
-//                    if (backslash_count > 0) {
-//                        if ((backslash_count % 2) == 1) {
-//                            // The quote char is escaped, it's not the end of the string, has to keep searching
-//                            arg_end_char_found = false;
-//                            arg_end_char_ptr++;
-//                        }
-//                    }
-//                }
-//            }
-//        } while (arg_end_char_found == false && arg_end_char_ptr < buffer_end_ptr);
-//
-//        // Calculate the read offset, includes any space and new line if present to avoid useless operations afterwards
-//        char *read_offset_arg_end_char_ptr = arg_end_char_ptr;
-//
-//        if (arg_end_char_found) {
-//            if (context->arguments.inline_protocol.current.quote_char != 0) {
-//                read_offset_arg_end_char_ptr++;
-//            }
-//
-//            // Count in the read offset any empty space after the arg end char
-//            do {
-//                if (*read_offset_arg_end_char_ptr != ' ') {
-//                    break;
-//                }
-//            } while (read_offset_arg_end_char_ptr++ && read_offset_arg_end_char_ptr < buffer_end_ptr);
-//
-//            is_arg_end_newline = *read_offset_arg_end_char_ptr == '\n';
-//
-//            // If the argument doesn't end with a new line, check if it's followed by one to avoid useless operations
-//            if (!is_arg_end_newline) {
-//                // Check both \n and \r\n after the end of the
-//                for (int newlinechars = 2; newlinechars > 0; newlinechars--) {
-//                    if (read_offset_arg_end_char_ptr + newlinechars < buffer_end_ptr &&
-//                        *(read_offset_arg_end_char_ptr + newlinechars) == '\n') {
-//                        read_offset_arg_end_char_ptr += newlinechars;
-//                        is_arg_end_newline = true;
-//                        break;
-//                    }
-//                }
-//            }
-//
-//            // If a new line has been found, move over the new line
-//            if (is_arg_end_newline) {
-//                read_offset_arg_end_char_ptr++;
-//            }
-//        }
-//
-//        // Update the read offset, move forward the initial point of the buffer and update the length
-//        read_offset += read_offset_arg_end_char_ptr - buffer;
-//        buffer += read_offset;
-//        length -= read_offset;
-//
-//        // Calculate the data length but first remove any carriage feed if present
-//        if (arg_end_char_found && *(arg_end_char_ptr - 1) == '\r') {
-//            arg_end_char_ptr--;
-//        }
-//
-//        data_length = arg_end_char_ptr - arg_start_char_ptr;
-//
-//        // If the data length is 0, it's just a new line and can be skipped
-//        if (data_length > 0) {
-//            // Update the context, if the flag beginning is set to true the system has also take care of allocating
-//            // the necessary memory
-//            if (context->arguments.current.beginning) {
-//                // Increments the counter of the arguments and reallocate the memory. Because of this late initialization
-//                // count starts from 0 and current.index starts from -1
-//                context->arguments.count++;
-//                context->arguments.current.index++;
-//
-//                // Set the data length
-//                context->arguments.current.length = data_length;
-//
-//                // Increase the size of the list and update the new element
-//                context->arguments.list = ffma_mem_realloc(
-//                        context->arguments.list,
-//                        sizeof(protocol_redis_reader_context_argument_t) * (context->arguments.count - 1),
-//                        sizeof(protocol_redis_reader_context_argument_t) * context->arguments.count,
-//                        true);
-//                context->arguments.list[context->arguments.current.index].value = arg_start_char_ptr;
-//                context->arguments.list[context->arguments.current.index].length = context->arguments.current.length;
-//                context->arguments.list[context->arguments.current.index].copied_from_buffer = false;
-//                context->arguments.list[context->arguments.current.index].all_read = false;
-//
-//                // Mark that it's not the beginning of the parsing of the current argument anymore
-//                context->arguments.current.beginning = false;
-//            } else {
-//                // If the data are not from the buffer, it needs to resize the allocated memory and copy the new data
-//                if (context->arguments.list[context->arguments.current.index].copied_from_buffer) {
-//                    context->arguments.list[context->arguments.current.index].value = ffma_mem_realloc(
-//                            context->arguments.list[context->arguments.current.index].value,
-//                            context->arguments.current.length,
-//                            context->arguments.current.length + data_length,
-//                            true);
-//
-//                    char* value_dest =
-//                            context->arguments.list[context->arguments.current.index].value +
-//                                    context->arguments.current.length;
-//                    memcpy(value_dest, arg_start_char_ptr, data_length);
-//                }
-//
-//                // Updates the length
-//                context->arguments.current.length += data_length;
-//                context->arguments.list[context->arguments.current.index].length = context->arguments.current.length;
-//            }
-//        }
-//
-//        if (arg_end_char_found) {
-//            if (context->arguments.current.index > -1) {
-//                context->arguments.list[context->arguments.current.index].all_read = true;
-//            }
-//
-//            context->arguments.current.length = 0;
-//            context->arguments.current.beginning = true;
-//
-//            if (is_arg_end_newline) {
-//                context->state = PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED;
-//            }
-//        }
-//    }
-
     if (length > 0 && context->state == PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_LENGTH) {
         // Only blob strings are allowed when making a request
         if (unlikely(*buffer != PROTOCOL_REDIS_TYPE_BLOB_STRING)) {
@@ -435,3 +648,265 @@ int32_t protocol_redis_reader_read(
 
     return op_index;
 }
+
+int32_t protocol_redis_reader_read_batch(
+        char* buffer,
+        size_t length,
+        protocol_redis_reader_context_t* context,
+        protocol_redis_reader_op_t* ops,
+        uint8_t ops_size) {
+    size_t read_offset = 0;
+    uint8_t op_index = 0;
+    uint8_t ops_commands_parsed = 0;
+    protocol_redis_reader_newlines_index_t newlines_index;
+
+    // Ensure there is going to be enough space to hold the maximum amount of data that can be processed
+    assert(ops_size >= 6);
+
+    // Ensure that there no errors reported in the context and there are data to parse
+    if (unlikely(context->error != 0)) {
+        return -1;
+    } else if (unlikely(length == 0)) {
+        context->error = PROTOCOL_REDIS_READER_ERROR_NO_DATA;
+        return -1;
+    }
+
+    // The new lines are indexed lazily, the first time a header has to be parsed
+    newlines_index.count = 0;
+    newlines_index.cursor = 0;
+    newlines_index.base_offset = 0;
+    newlines_index.end_offset = 0;
+
+    while(read_offset < length && ops_size - op_index >= PROTOCOL_REDIS_READER_BATCH_MIN_FREE_OPS) {
+        size_t iteration_read_offset = read_offset;
+        uint8_t iteration_op_index = op_index;
+
+        // If the previous command has been parsed, by this invocation or by the previous one, and there are more data
+        // the context is reset to process the next command
+        if (context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED) {
+            protocol_redis_reader_context_reset(context);
+        }
+
+        if (context->state == PROTOCOL_REDIS_READER_STATE_BEGIN) {
+            char *line_ptr = buffer + read_offset;
+            size_t skipped_length = 0;
+
+            // Empty lines between the commands are skipped, as redis does, and are accounted in the command begin op
+            if (unlikely(*line_ptr != PROTOCOL_REDIS_TYPE_ARRAY)) {
+                skipped_length = protocol_redis_reader_inline_skip_empty_lines(line_ptr, length - read_offset);
+                if (unlikely(skipped_length == length - read_offset)) {
+                    break;
+                }
+
+                line_ptr += skipped_length;
+            }
+
+            char *new_line_ptr = protocol_redis_reader_newlines_index_find(
+                    &newlines_index,
+                    buffer,
+                    length,
+                    read_offset + skipped_length);
+
+            bool is_inline = *line_ptr != PROTOCOL_REDIS_TYPE_ARRAY;
+
+            if (unlikely(is_inline)) {
+                if (unlikely(new_line_ptr == NULL)) {
+                    // The inline commands are parsed only when the entire line has been received
+                    if (unlikely(length - read_offset - skipped_length > PROTOCOL_REDIS_READER_INLINE_MAX_LENGTH)) {
+                        context->error = PROTOCOL_REDIS_READER_ERROR_INLINE_COMMAND_TOO_LONG;
+                        goto fail;
+                    }
+
+                    break;
+                }
+
+                if (unlikely(!protocol_redis_reader_read_inline_command_begin(
+                        buffer,
+                        &read_offset,
+                        skipped_length,
+                        new_line_ptr,
+                        context,
+                        ops,
+                        &op_index))) {
+                    goto fail;
+                }
+            } else {
+                if (unlikely(new_line_ptr == NULL)) {
+                    // Partial data, the state is not changed on purpose
+                    break;
+                }
+
+                // Ensure that there is at least 1 character and the \r before the found \n
+                long args_count = 0;
+                if (unlikely(new_line_ptr - line_ptr < 2 || *(new_line_ptr - 1) != '\r' ||
+                    !protocol_redis_reader_parse_length(line_ptr + 1, new_line_ptr - 1, &args_count) ||
+                    args_count <= 0)) {
+                    context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH;
+                    goto fail;
+                }
+
+                unsigned long move_offset = skipped_length + (new_line_ptr - line_ptr) + 1;
+                read_offset += move_offset;
+
+                context->arguments.count = args_count;
+                context->protocol_type = PROTOCOL_REDIS_READER_PROTOCOL_TYPE_RESP;
+                context->state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_LENGTH;
+                context->arguments.current.index = -1;
+                context->arguments.current.beginning = true;
+                context->arguments.current.length = 0;
+
+                ops[op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN;
+                ops[op_index].data_read_len = (off_t)move_offset;
+                ops[op_index].data.command.arguments_count = context->arguments.count;
+                op_index++;
+            }
+        }
+
+        // The inline commands are parsed only when the entire line has been received so the new line is always
+        // available and, as the line has already been tokenized, the lookup hits the new lines index
+        if (unlikely(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT)) {
+            char *new_line_ptr = protocol_redis_reader_newlines_index_find(
+                    &newlines_index,
+                    buffer,
+                    length,
+                    read_offset);
+            if (unlikely(new_line_ptr == NULL)) {
+                break;
+            }
+
+            if (unlikely(!protocol_redis_reader_read_inline_argument(
+                    buffer,
+                    &read_offset,
+                    new_line_ptr,
+                    context,
+                    ops,
+                    &op_index))) {
+                goto fail;
+            }
+
+            if (context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED) {
+                ops_commands_parsed = op_index;
+            }
+        }
+
+        if (read_offset < length && context->state == PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_LENGTH) {
+            char *line_ptr = buffer + read_offset;
+
+            // Only blob strings are allowed when making a request
+            if (unlikely(*line_ptr != PROTOCOL_REDIS_TYPE_BLOB_STRING)) {
+                context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_EXPECTED;
+                goto fail;
+            }
+
+            char *new_line_ptr = protocol_redis_reader_newlines_index_find(
+                    &newlines_index,
+                    buffer,
+                    length,
+                    read_offset);
+            if (unlikely(new_line_ptr == NULL)) {
+                break;
+            }
+
+            // Ensure that there is at least 1 charater and the \r before the found \n
+            if (unlikely(new_line_ptr - line_ptr < 2 || *(new_line_ptr - 1) != '\r')) {
+                context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH;
+                goto fail;
+            }
+
+            long data_length = 0;
+            if (unlikely(!protocol_redis_reader_parse_length(line_ptr + 1, new_line_ptr - 1, &data_length))) {
+                context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_INVALID_LENGTH;
+                goto fail;
+            }
+
+            unsigned long move_offset = new_line_ptr - line_ptr + 1;
+            read_offset += move_offset;
+
+            context->arguments.current.index++;
+            context->arguments.current.length = data_length;
+            context->arguments.current.received_length = 0;
+
+            ops[op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN;
+            ops[op_index].data_read_len = (off_t)move_offset;
+            ops[op_index].data.argument.index = context->arguments.current.index;
+            ops[op_index].data.argument.length = data_length;
+            op_index++;
+
+            context->state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA;
+        }
+
+        if (read_offset < length && context->state == PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA) {
+            size_t data_length;
+            size_t available_length = length - read_offset;
+            size_t argument_waiting_data_length =
+                    context->arguments.current.length -
+                    context->arguments.current.received_length;
+
+            // The argument data are not scanned at all, the new lines index will skip over them
+            if (available_length < argument_waiting_data_length) {
+                data_length = available_length;
+            } else {
+                data_length = argument_waiting_data_length;
+                context->state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA_END;
+            }
+
+            context->arguments.current.received_length += data_length;
+
+            ops[op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA;
+            ops[op_index].data_read_len = (off_t)data_length;
+            ops[op_index].data.argument.index = context->arguments.current.index;
+            ops[op_index].data.argument.length = context->arguments.current.length;
+            ops[op_index].data.argument.offset = read_offset;
+            ops[op_index].data.argument.data_length = data_length;
+            op_index++;
+
+            read_offset += data_length;
+        }
+
+        if (read_offset < length && context->state == PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_DATA_END) {
+            size_t waiting_data_length = 2;
+
+            if (likely(length - read_offset >= waiting_data_length)) {
+                if (unlikely(buffer[read_offset] != '\r' || buffer[read_offset + 1] != '\n')) {
+                    context->error = PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_MISSING_END_SIGNATURE;
+                    goto fail;
+                }
+
+                read_offset += waiting_data_length;
+                context->arguments.current.received_length += waiting_data_length;
+
+                ops[op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END;
+                ops[op_index].data_read_len = (off_t)waiting_data_length;
+                ops[op_index].data.argument.index = context->arguments.current.index;
+                ops[op_index].data.argument.length = context->arguments.current.length;
+                ops[op_index].data.argument.offset = read_offset - waiting_data_length;
+                op_index++;
+
+                if (context->arguments.current.index == context->arguments.count - 1) {
+                    context->state = PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED;
+
+                    ops[op_index].type = PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END;
+                    ops[op_index].data_read_len = 0;
+                    ops[op_index].data.command.arguments_count = context->arguments.count;
+                    op_index++;
+
+                    ops_commands_parsed = op_index;
+                } else {
+                    context->state = PROTOCOL_REDIS_READER_STATE_RESP_WAITING_ARGUMENT_LENGTH;
+                }
+            }
+        }
+
+        // If nothing has been processed more data are needed
+        if (iteration_read_offset == read_offset && iteration_op_index == op_index) {
+            break;
+        }
+    }
+
+    return op_index;
+
+fail:
+    // The commands parsed before the error are returned to let the caller process them, the error is kept in the
+    // context and will be reported by the next invocation
+    return ops_commands_parsed > 0 ? ops_commands_parsed : -1;
+}
@@ -5,6 +5,29 @@
 extern "C" {
 #endif
 
+#define PROTOCOL_REDIS_READER_NAME_IFUNC(NAME) protocol_redis_reader_##NAME
+#define PROTOCOL_REDIS_READER_SIGNATURE_IFUNC(NAME, ARGS) PROTOCOL_REDIS_READER_NAME_IFUNC(NAME) ARGS
+
+#define PROTOCOL_REDIS_READER_NAME_IMPL(NAME, METHOD) protocol_redis_reader_##NAME##_##METHOD
+#define PROTOCOL_REDIS_READER_SIGNATURE_IMPL(NAME, METHOD, ARGS) PROTOCOL_REDIS_READER_NAME_IMPL(NAME, METHOD) ARGS
+
+// Amount of new lines the batch reader indexes in one go, the index is refilled every time the parser goes past the
+// last indexed new line
+#define PROTOCOL_REDIS_READER_NEWLINES_INDEX_SIZE 64
+
+// Maximum amount of bytes scanned every time the new lines index is refilled, it avoids scanning ahead big chunks of
+// argument data that will be skipped anyway
+#define PROTOCOL_REDIS_READER_NEWLINES_INDEX_WINDOW_SIZE 2048
+
+// Minimum amount of free ops needed by the batch reader to start processing a new argument or command, it matches the
+// maximum amount of ops that can be emitted in one iteration (command begin, argument begin, argument data, argument
+// end and command end)
+#define PROTOCOL_REDIS_READER_BATCH_MIN_FREE_OPS 5
+
+// Maximum length of a command sent using the inline protocol, the entire line has to be received before it can be
+// parsed, same limit used by redis
+#define PROTOCOL_REDIS_READER_INLINE_MAX_LENGTH (64 * 1024)
+
 enum protocol_redis_reader_errors {
     PROTOCOL_REDIS_READER_ERROR_OK,
     PROTOCOL_REDIS_READER_ERROR_NO_DATA,
@@ -15,6 +38,7 @@ enum protocol_redis_reader_errors {
     PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_EXPECTED,
     PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_INVALID_LENGTH,
     PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_MISSING_END_SIGNATURE,
+    PROTOCOL_REDIS_READER_ERROR_INLINE_COMMAND_TOO_LONG,
 };
 typedef enum protocol_redis_reader_errors protocol_redis_reader_errors_t;
 
@@ -84,6 +108,22 @@ int32_t protocol_redis_reader_read(
         protocol_redis_reader_op_t* ops,
         uint8_t ops_size);
 
+int32_t protocol_redis_reader_read_batch(
+        char* buffer,
+        size_t length,
+        protocol_redis_reader_context_t* context,
+        protocol_redis_reader_op_t* ops,
+        uint8_t ops_size);
+
+uint32_t PROTOCOL_REDIS_READER_SIGNATURE_IFUNC(index_newlines, (
+        const char *buffer, size_t length, uint32_t *newlines, uint32_t newlines_size, size_t *scanned_length));
+uint32_t PROTOCOL_REDIS_READER_SIGNATURE_IMPL(index_newlines, sw, (
+        const char *buffer, size_t length, uint32_t *newlines, uint32_t newlines_size, size_t *scanned_length));
+uint32_t PROTOCOL_REDIS_READER_SIGNATURE_IMPL(index_newlines, avx2, (
+        const char *buffer, size_t length, uint32_t *newlines, uint32_t newlines_size, size_t *scanned_length));
+uint32_t PROTOCOL_REDIS_READER_SIGNATURE_IMPL(index_newlines, avx512bw, (
+        const char *buffer, size_t length, uint32_t *newlines, uint32_t newlines_size, size_t *scanned_length));
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,65 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <immintrin.h>
+
+#include "misc.h"
+#include "protocol_redis.h"
+
+#include "protocol_redis_reader.h"
+
+uint32_t PROTOCOL_REDIS_READER_SIGNATURE_IMPL(index_newlines, avx2, (
+        const char *buffer,
+        size_t length,
+        uint32_t *newlines,
+        uint32_t newlines_size,
+        size_t *scanned_length)) {
+    size_t offset = 0;
+    uint32_t newlines_count = 0;
+    __m256i new_line_vector = _mm256_set1_epi8('\n');
+
+    assert(newlines_size > 0);
+
+    // Compare 32 bytes per iteration and convert the result in a bitmask, every bit set is a new line
+    for(; offset + 32 <= length; offset += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(buffer + offset));
+        uint32_t new_lines_mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, new_line_vector));
+
+        while(new_lines_mask) {
+            if (unlikely(newlines_count == newlines_size)) {
+                *scanned_length = newlines[newlines_count - 1] + 1;
+                return newlines_count;
+            }
+
+            newlines[newlines_count++] = offset + _tzcnt_u32(new_lines_mask);
+            new_lines_mask = _blsr_u32(new_lines_mask);
+        }
+    }
+
+    // Process the tail byte by byte, it's always shorter than 32 bytes
+    for(; offset < length; offset++) {
+        if (buffer[offset] != '\n') {
+            continue;
+        }
+
+        if (unlikely(newlines_count == newlines_size)) {
+            *scanned_length = newlines[newlines_count - 1] + 1;
+            return newlines_count;
+        }
+
+        newlines[newlines_count++] = offset;
+    }
+
+    *scanned_length = length;
+    return newlines_count;
+}
@@ -0,0 +1,61 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <immintrin.h>
+
+#include "misc.h"
+#include "protocol_redis.h"
+
+#include "protocol_redis_reader.h"
+
+uint32_t PROTOCOL_REDIS_READER_SIGNATURE_IMPL(index_newlines, avx512bw, (
+        const char *buffer,
+        size_t length,
+        uint32_t *newlines,
+        uint32_t newlines_size,
+        size_t *scanned_length)) {
+    size_t offset = 0;
+    uint32_t newlines_count = 0;
+    __m512i new_line_vector = _mm512_set1_epi8('\n');
+
+    assert(newlines_size > 0);
+
+    // Compare 64 bytes per iteration, the tail is loaded with a masked load to avoid reading past the end of the
+    // buffer so there is no need for a scalar loop
+    for(; offset < length; offset += 64) {
+        __m512i block;
+        size_t block_length = length - offset;
+
+        if (likely(block_length >= 64)) {
+            block = _mm512_loadu_si512((const void*)(buffer + offset));
+        } else {
+            block = _mm512_maskz_loadu_epi8(_bzhi_u64(UINT64_MAX, block_length), buffer + offset);
+        }
+
+        // The masked out bytes are zeroed therefore they will never match the new line
+        uint64_t new_lines_mask = _mm512_cmpeq_epi8_mask(block, new_line_vector);
+
+        while(new_lines_mask) {
+            if (unlikely(newlines_count == newlines_size)) {
+                *scanned_length = newlines[newlines_count - 1] + 1;
+                return newlines_count;
+            }
+
+            newlines[newlines_count++] = offset + _tzcnt_u64(new_lines_mask);
+            new_lines_mask = _blsr_u64(new_lines_mask);
+        }
+    }
+
+    *scanned_length = length;
+    return newlines_count;
+}
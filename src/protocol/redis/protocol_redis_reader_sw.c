@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "misc.h"
+#include "protocol_redis.h"
+
+#include "protocol_redis_reader.h"
+
+uint32_t PROTOCOL_REDIS_READER_SIGNATURE_IMPL(index_newlines, sw, (
+        const char *buffer,
+        size_t length,
+        uint32_t *newlines,
+        uint32_t newlines_size,
+        size_t *scanned_length)) {
+    uint32_t newlines_count = 0;
+    const char *buffer_start = buffer;
+    const char *buffer_end = buffer + length;
+
+    assert(newlines_size > 0);
+
+    while(buffer < buffer_end) {
+        char *new_line_ptr = memchr(buffer, '\n', buffer_end - buffer);
+        if (new_line_ptr == NULL) {
+            break;
+        }
+
+        if (unlikely(newlines_count == newlines_size)) {
+            *scanned_length = newlines[newlines_count - 1] + 1;
+            return newlines_count;
+        }
+
+        newlines[newlines_count++] = new_line_ptr - buffer_start;
+        buffer = new_line_ptr + 1;
+    }
+
+    *scanned_length = length;
+    return newlines_count;
+}
@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <limits.h>
+#include <math.h>
 
 #include "exttypes.h"
 #include "misc.h"
@@ -23,6 +24,27 @@
 
 #define TAG "protocol_redis_writer"
 
+static protocol_redis_writer_precomputed_number_t
+        protocol_redis_writer_precomputed_numbers[PROTOCOL_REDIS_WRITER_PRECOMPUTED_NUMBERS_COUNT];
+
+__attribute__((constructor))
+static void protocol_redis_writer_precomputed_numbers_init() {
+    for(uint64_t number = 0; number < PROTOCOL_REDIS_WRITER_PRECOMPUTED_NUMBERS_COUNT; number++) {
+        protocol_redis_writer_precomputed_number_t *precomputed_number =
+                &protocol_redis_writer_precomputed_numbers[number];
+        size_t number_str_length = protocol_redis_writer_uint64_str_length(number);
+
+        protocol_redis_writer_uint64_to_str(
+                number,
+                number_str_length,
+                precomputed_number->data,
+                sizeof(precomputed_number->data));
+        precomputed_number->data[number_str_length] = '\r';
+        precomputed_number->data[number_str_length + 1] = '\n';
+        precomputed_number->length = number_str_length + 2;
+    }
+}
+
 bool protocol_redis_writer_enough_space_in_buffer(
         size_t length,
         size_t requested_size) {
@@ -223,6 +245,14 @@ char* protocol_redis_writer_write_argument_double(
         size_t buffer_length,
         double number) {
     size_t integer_part_length, fraction_part_length;
+
+    // Infinite and NaN can't be converted by protocol_redis_writer_double_to_str, they are written as they are
+    // represented in RESP3
+    if (unlikely(isnan(number) || isinf(number))) {
+        char *string = isnan(number) ? "nan" : (number > 0 ? "inf" : "-inf");
+        return protocol_redis_writer_write_argument_string(buffer, buffer_length, string, strlen(string));
+    }
+
     size_t number_size = protocol_redis_writer_double_str_length(
             number,
             15,
@@ -303,20 +333,36 @@ char* protocol_redis_writer_write_argument_eol(
     return buffer;
 }
 
-char* protocol_redis_writer_write_argument_blob_start(
+char* protocol_redis_writer_write_argument_header(
         char* buffer,
         size_t buffer_length,
-        bool is_error,
-        int64_t string_length) {
+        protocol_redis_types_t type,
+        int64_t number) {
     char* buffer_start = buffer;
 
+    // The small numbers are the most common case (e.g. the length of the values or the amount of items in the arrays)
+    // and their representation is precomputed
+    if (likely(number >= 0 && number < PROTOCOL_REDIS_WRITER_PRECOMPUTED_NUMBERS_COUNT)) {
+        protocol_redis_writer_precomputed_number_t *precomputed_number =
+                &protocol_redis_writer_precomputed_numbers[number];
+
+        if (!protocol_redis_writer_enough_space_in_buffer(buffer_length, precomputed_number->length + 1)) {
+            return NULL;
+        }
+
+        *buffer++ = type;
+        memcpy(buffer, precomputed_number->data, precomputed_number->length);
+
+        return buffer + precomputed_number->length;
+    }
+
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
         protocol_redis_writer_write_argument_type,
-        is_error ? PROTOCOL_REDIS_TYPE_BLOB_ERROR : PROTOCOL_REDIS_TYPE_BLOB_STRING)
+        type)
 
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
             protocol_redis_writer_write_argument_number,
-            string_length)
+            number)
 
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
         protocol_redis_writer_write_argument_eol)
@@ -324,6 +370,18 @@ char* protocol_redis_writer_write_argument_blob_start(
     return buffer;
 }
 
+char* protocol_redis_writer_write_argument_blob_start(
+        char* buffer,
+        size_t buffer_length,
+        bool is_error,
+        int64_t string_length) {
+    return protocol_redis_writer_write_argument_header(
+            buffer,
+            buffer_length,
+            is_error ? PROTOCOL_REDIS_TYPE_BLOB_ERROR : PROTOCOL_REDIS_TYPE_BLOB_STRING,
+            string_length);
+}
+
 char* protocol_redis_writer_write_argument_blob_end(
         char* buffer,
         size_t buffer_length) {
@@ -343,6 +401,28 @@ char* protocol_redis_writer_write_argument_blob(
         int64_t string_length) {
     char* buffer_start = buffer;
 
+    // Fast path for the small strings, the space required is checked once and the header is precomputed
+    if (likely(string_length >= 0 && string_length < PROTOCOL_REDIS_WRITER_PRECOMPUTED_NUMBERS_COUNT)) {
+        protocol_redis_writer_precomputed_number_t *precomputed_number =
+                &protocol_redis_writer_precomputed_numbers[string_length];
+
+        if (!protocol_redis_writer_enough_space_in_buffer(
+                buffer_length,
+                1 + precomputed_number->length + string_length + 2)) {
+            return NULL;
+        }
+
+        *buffer++ = is_error ? PROTOCOL_REDIS_TYPE_BLOB_ERROR : PROTOCOL_REDIS_TYPE_BLOB_STRING;
+        memcpy(buffer, precomputed_number->data, precomputed_number->length);
+        buffer += precomputed_number->length;
+        memcpy(buffer, string, string_length);
+        buffer += string_length;
+        *buffer++ = '\r';
+        *buffer++ = '\n';
+
+        return buffer;
+    }
+
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
         protocol_redis_writer_write_argument_blob_start,
         is_error,
@@ -407,7 +487,21 @@ char* protocol_redis_writer_write_argument_simple_printf(
     return buffer;
 }
 
-PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_NULL, null, (), {})
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(null, ()) {
+    return protocol_redis_writer_write_argument_string(
+            buffer,
+            buffer_length,
+            PROTOCOL_REDIS_WRITER_REPLY_NULL,
+            sizeof(PROTOCOL_REDIS_WRITER_REPLY_NULL) - 1);
+}
+
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(ok, ()) {
+    return protocol_redis_writer_write_argument_string(
+            buffer,
+            buffer_length,
+            PROTOCOL_REDIS_WRITER_REPLY_OK,
+            sizeof(PROTOCOL_REDIS_WRITER_REPLY_OK) - 1);
+}
 
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_BOOLEAN, boolean, (bool is_true), {
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
@@ -420,7 +514,19 @@ PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(blob_string, (char* string, int string_len
 }
 
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(blob_string_null, ()) {
-    return protocol_redis_writer_write_argument_blob(buffer, buffer_length, false, NULL, -1);
+    return protocol_redis_writer_write_argument_string(
+            buffer,
+            buffer_length,
+            PROTOCOL_REDIS_WRITER_REPLY_BLOB_STRING_NULL,
+            sizeof(PROTOCOL_REDIS_WRITER_REPLY_BLOB_STRING_NULL) - 1);
+}
+
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(array_null, ()) {
+    return protocol_redis_writer_write_argument_string(
+            buffer,
+            buffer_length,
+            PROTOCOL_REDIS_WRITER_REPLY_ARRAY_NULL,
+            sizeof(PROTOCOL_REDIS_WRITER_REPLY_ARRAY_NULL) - 1);
 }
 
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(blob_error, (char* string, int string_length)) {
@@ -443,11 +549,9 @@ PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(simple_error_printf, (char* string, ...))
     return res;
 }
 
-PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_NUMBER, number, (long number), {
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_number,
-        number)
-})
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(number, (long number)) {
+    return protocol_redis_writer_write_argument_header(buffer, buffer_length, PROTOCOL_REDIS_TYPE_NUMBER, number);
+}
 
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_DOUBLE, double, (double number), {
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
@@ -456,45 +560,32 @@ PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_DOUBLE, double, (do
 })
 
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_BIG_NUMBER, big_number, (char* bignumber, int bignumber_length), {
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_number,
-        bignumber_length)
-
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_eol)
-
     PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
         protocol_redis_writer_write_argument_string,
         bignumber,
         bignumber_length);
 })
 
-PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_ARRAY, array, (uint32_t array_count), {
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_number,
-        array_count)
-})
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(array, (uint32_t array_count)) {
+    return protocol_redis_writer_write_argument_header(buffer, buffer_length, PROTOCOL_REDIS_TYPE_ARRAY, array_count);
+}
 
-PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_MAP, map, (uint32_t items_count), {
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_number,
-        items_count)
-})
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(map, (uint32_t items_count)) {
+    return protocol_redis_writer_write_argument_header(buffer, buffer_length, PROTOCOL_REDIS_TYPE_MAP, items_count);
+}
 
-PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_SET, set, (uint32_t set_count), {
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_number,
-        set_count)
-})
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(set, (uint32_t set_count)) {
+    return protocol_redis_writer_write_argument_header(buffer, buffer_length, PROTOCOL_REDIS_TYPE_SET, set_count);
+}
 
-PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_ATTRIBUTE, attribute, (uint32_t attributes_count), {
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_number,
-        attributes_count)
-})
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(attribute, (uint32_t attributes_count)) {
+    return protocol_redis_writer_write_argument_header(
+            buffer,
+            buffer_length,
+            PROTOCOL_REDIS_TYPE_ATTRIBUTE,
+            attributes_count);
+}
 
-PROTOCOL_REDIS_WRITER_WRITE_FUNC_WRAPPER(PROTOCOL_REDIS_TYPE_PUSH, push, (uint32_t messages_count), {
-    PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_COMMON_VARS(
-        protocol_redis_writer_write_argument_number,
-        messages_count)
-})
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(push, (uint32_t messages_count)) {
+    return protocol_redis_writer_write_argument_header(buffer, buffer_length, PROTOCOL_REDIS_TYPE_PUSH, messages_count);
+}
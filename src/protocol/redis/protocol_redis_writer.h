@@ -6,6 +6,27 @@
 extern "C" {
 #endif
 
+// Amount of numbers, starting from 0, for which the "<number>\r\n" representation is precomputed, it's used to write
+// the header of the blob strings, the arrays, the maps, etc. and the small numbers with a single copy
+#define PROTOCOL_REDIS_WRITER_PRECOMPUTED_NUMBERS_COUNT 1024
+
+// The replies shared by many commands are written as they are
+#define PROTOCOL_REDIS_WRITER_REPLY_OK "+OK\r\n"
+#define PROTOCOL_REDIS_WRITER_REPLY_NULL "_\r\n"
+#define PROTOCOL_REDIS_WRITER_REPLY_BLOB_STRING_NULL "$-1\r\n"
+#define PROTOCOL_REDIS_WRITER_REPLY_ARRAY_NULL "*-1\r\n"
+
+// The longest framing of a blob string, the "$<length>\r\n" header with the length of a size_t and the "\r\n" after
+// the data, it's the space to reserve in a buffer in addition to the data of the blob string
+#define PROTOCOL_REDIS_WRITER_BLOB_STRING_FRAMING_MAX_LENGTH \
+    ((sizeof("$18446744073709551615\r\n") - 1) + (sizeof("\r\n") - 1))
+
+typedef struct protocol_redis_writer_precomputed_number protocol_redis_writer_precomputed_number_t;
+struct protocol_redis_writer_precomputed_number {
+    uint8_t length;
+    char data[7];
+};
+
 #define PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER_WRITE_FUNC_VA_ARGS(...) , ##__VA_ARGS__
 
 #define PROTOCOL_REDIS_WRITER_WRITE_ARGUMENT_WRAPPER(BUFFER, BUFFER_LENGTH, BUFFER_START, WRITE_FUNC, ...) { \
@@ -52,9 +73,11 @@ extern "C" {
     }
 
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(null, ());
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(ok, ());
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(boolean, (bool is_true));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(blob_string, (char* string, int string_length));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(blob_string_null, ());
+PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(array_null, ());
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(blob_error, (char* string, int string_length));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(simple_string, (char* string, int string_length));
 PROTOCOL_REDIS_WRITER_WRITE_FUNC_NAME(simple_error, (char* string, int string_length));
@@ -140,6 +163,12 @@ char* protocol_redis_writer_write_argument_eol(
         char* buffer,
         size_t buffer_length);
 
+char* protocol_redis_writer_write_argument_header(
+        char* buffer,
+        size_t buffer_length,
+        protocol_redis_types_t type,
+        int64_t number);
+
 char* protocol_redis_writer_write_argument_blob_start(
         char* buffer,
         size_t buffer_length,
@@ -17,18 +17,22 @@
 #include <stdatomic.h>
 #include <assert.h>
 #include <ctype.h>
+#include <numa.h>
 
 #include "misc.h"
 #include "exttypes.h"
 #include "clock.h"
 #include "memory_fences.h"
+#include "intrinsics.h"
 #include "spinlock.h"
 #include "transaction.h"
 #include "transaction_spinlock.h"
 #include "utils_string.h"
+#include "utils_numa.h"
 #include "xalloc.h"
-#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
+#include "epoch_gc.h"
 #include "data_structures/hashtable/mcmp/hashtable.h"
 #include "data_structures/hashtable/mcmp/hashtable_config.h"
 #include "data_structures/hashtable/mcmp/hashtable_data.h"
@@ -39,9 +43,12 @@
 #include "data_structures/hashtable/mcmp/hashtable_op_iter.h"
 #include "data_structures/hashtable/mcmp/hashtable_op_rmw.h"
 #include "data_structures/hashtable/mcmp/hashtable_op_get_random_key.h"
+#include "data_structures/hashtable/mcmp/hashtable_support_hash.h"
 #include "data_structures/hashtable/mcmp/hashtable_thread_counters.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/art_spsc/art_spsc.h"
 #include "memory_allocator/ffma.h"
+#include "hash/hash_crc16.h"
 #include "fiber/fiber.h"
 #include "fiber/fiber_scheduler.h"
 #include "log/log.h"
@@ -56,6 +63,20 @@
 
 #define TAG "storage_db"
 
+// The keys of each slot are kept in a tree, as the tree requires that no key is the prefix of another one they are
+// prefixed by their length
+struct storage_db_keys_slot {
+    spinlock_lock_volatile_t spinlock;
+    art_tree keys;
+};
+
+typedef struct storage_db_keys_slot_key storage_db_keys_slot_key_t;
+struct storage_db_keys_slot_key {
+    uint16_t slot;
+    unsigned char *data;
+    size_t length;
+};
+
 char *storage_db_shard_build_path(
         char *basedir_path,
         storage_db_shard_index_t shard_index) {
@@ -97,6 +118,20 @@ void storage_db_config_free(
     ffma_mem_free(config);
 }
 
+static void storage_db_keys_slots_free(
+        storage_db_t *db) {
+    if (db->keys_slots == NULL) {
+        return;
+    }
+
+    for(uint32_t slot = 0; slot < STORAGE_DB_KEYS_SLOTS_COUNT; slot++) {
+        art_tree_destroy(&db->keys_slots[slot].keys);
+    }
+
+    xalloc_free(db->keys_slots);
+    db->keys_slots = NULL;
+}
+
 storage_db_t* storage_db_new(
         storage_db_config_t *config,
         uint32_t workers_count) {
@@ -114,6 +149,13 @@ storage_db_t* storage_db_new(
     hashtable_config->can_auto_resize = false;
     hashtable_config->initial_size = pow2_next(config->max_keys);
 
+    // The hashtable is shared by the workers running on all the numa nodes, the memory is interleaved across them to
+    // spread the accesses instead of having all of them hitting the node of the thread that touched a page first
+    if (utils_numa_is_available() && utils_numa_node_configured_count() > 1) {
+        hashtable_config->numa_aware = true;
+        hashtable_config->numa_nodes_bitmask = numa_all_nodes_ptr;
+    }
+
     // Initialize the hashtable
     hashtable = hashtable_mcmp_init(hashtable_config);
     if (!hashtable) {
@@ -130,20 +172,10 @@ storage_db_t* storage_db_new(
 
     // Initialize the per worker needed information
     for(uint32_t worker_index = 0; worker_index < workers_count; worker_index++) {
-        ring_bounded_queue_spsc_voidptr_t *deleted_entry_index_ring_buffer =
-                ring_bounded_queue_spsc_voidptr_init(STORAGE_DB_WORKER_ENTRY_INDEX_RING_BUFFER_SIZE);
-
-        if (!deleted_entry_index_ring_buffer) {
-            LOG_E(TAG, "Unable to allocate memory for the deleted entry index ring buffer per worker");
-            goto fail;
-        }
-
-        workers[worker_index].deleted_entry_index_ring_buffer = deleted_entry_index_ring_buffer;
-
         double_linked_list_t *deleting_entry_index_list = double_linked_list_init();
 
         if (!deleting_entry_index_list) {
-            LOG_E(TAG, "Unable to allocate memory for the deleting entry index ring buffer per worker");
+            LOG_E(TAG, "Unable to allocate memory for the deleting entry index list per worker");
             goto fail;
         }
 
@@ -162,6 +194,19 @@ storage_db_t* storage_db_new(
     db->workers = workers;
     db->hashtable = hashtable;
 
+    if (config->track_keys_slots) {
+        db->keys_slots = xalloc_alloc_zero(sizeof(storage_db_keys_slot_t) * STORAGE_DB_KEYS_SLOTS_COUNT);
+
+        for(uint32_t slot = 0; slot < STORAGE_DB_KEYS_SLOTS_COUNT; slot++) {
+            spinlock_init(&db->keys_slots[slot].spinlock);
+            art_tree_init(&db->keys_slots[slot].keys);
+        }
+    }
+
+    spinlock_init(&db->snapshot.spinlock);
+
+    storage_db_epoch_gc_register_object_types_destructor_cb(db);
+
     // Sets up the shards only if it has to write to the disk
     if (config->backend_type != STORAGE_DB_BACKEND_TYPE_MEMORY) {
         db->shards.new_index = 0;
@@ -187,10 +232,6 @@ fail:
 
     if (workers) {
         for(uint32_t worker_index = 0; worker_index < workers_count; worker_index++) {
-            if (workers[worker_index].deleted_entry_index_ring_buffer) {
-                ring_bounded_queue_spsc_voidptr_free(workers[worker_index].deleted_entry_index_ring_buffer);
-            }
-
             if (workers[worker_index].deleting_entry_index_list) {
                 double_linked_list_free(workers[worker_index].deleting_entry_index_list);
             }
@@ -206,6 +247,8 @@ fail:
             double_linked_list_free(db->shards.opened_shards);
         }
 
+        storage_db_keys_slots_free(db);
+
         ffma_mem_free(db);
     }
 
@@ -237,14 +280,6 @@ storage_db_shard_t *storage_db_worker_active_shard(
     return db->workers[worker_index].active_shard;
 }
 
-ring_bounded_queue_spsc_voidptr_t *storage_db_worker_deleted_entry_index_ring_buffer(
-        storage_db_t *db) {
-    worker_context_t *worker_context = worker_context_get();
-    uint32_t worker_index = worker_context->worker_index;
-
-    return db->workers[worker_index].deleted_entry_index_ring_buffer;
-}
-
 double_linked_list_t *storage_db_worker_deleting_entry_index_list(
         storage_db_t *db) {
     worker_context_t *worker_context = worker_context_get();
@@ -266,6 +301,7 @@ bool storage_db_chunk_data_pre_allocate(
     chunk_info->chunk_length = chunk_length;
 
     if (db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY) {
+        chunk_info->memory.chunk_data_shared_counter = NULL;
         chunk_info->memory.chunk_data = ffma_mem_alloc(chunk_length);
         if (!chunk_info->memory.chunk_data) {
             LOG_E(
@@ -321,12 +357,73 @@ void storage_db_chunk_data_free(
         storage_db_t *db,
         storage_db_chunk_info_t *chunk_info) {
     if (db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY) {
+        // The data of the embedded chunks are freed together with the sequence
+        if (storage_db_chunk_info_is_embedded(chunk_info)) {
+            return;
+        }
+
+        if (unlikely(chunk_info->memory.chunk_data_shared_counter)) {
+            if (__sync_sub_and_fetch(chunk_info->memory.chunk_data_shared_counter, 1) > 0) {
+                return;
+            }
+
+            ffma_mem_free((void*)chunk_info->memory.chunk_data_shared_counter);
+        }
+
         ffma_mem_free(chunk_info->memory.chunk_data);
     } else {
         // TODO: currently not implemented, the data on the disk should be collected by a garbage collector
     }
 }
 
+bool storage_db_chunk_data_share(
+        storage_db_t *db,
+        storage_db_chunk_info_t *chunk_info_source,
+        storage_db_chunk_info_t *chunk_info_destination) {
+    // The data on disk is never freed, it's enough to copy the chunk info
+    if (db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY) {
+        // The data of an embedded chunk go away with its sequence so they can't be shared, being small they are copied
+        if (storage_db_chunk_info_is_embedded(chunk_info_source)) {
+            if (unlikely(!storage_db_chunk_data_pre_allocate(
+                    db,
+                    chunk_info_destination,
+                    chunk_info_source->chunk_length))) {
+                return false;
+            }
+
+            memcpy(
+                    chunk_info_destination->memory.chunk_data,
+                    chunk_info_source->memory.chunk_data,
+                    chunk_info_source->chunk_length);
+
+            return true;
+        }
+
+        // The source chunk can be accessed concurrently only by readers, which don't care about the counter, and can't
+        // be freed as the caller must hold a reader lock on the entry index owning it
+        if (!chunk_info_source->memory.chunk_data_shared_counter) {
+            uint32_volatile_t *chunk_data_shared_counter = ffma_mem_alloc(sizeof(uint32_volatile_t));
+
+            if (unlikely(!chunk_data_shared_counter)) {
+                LOG_E(
+                        TAG,
+                        "Unable to allocate the shared counter of a chunk");
+
+                return false;
+            }
+
+            *chunk_data_shared_counter = 1;
+            chunk_info_source->memory.chunk_data_shared_counter = chunk_data_shared_counter;
+        }
+
+        __sync_add_and_fetch(chunk_info_source->memory.chunk_data_shared_counter, 1);
+    }
+
+    *chunk_info_destination = *chunk_info_source;
+
+    return true;
+}
+
 storage_db_shard_t* storage_db_shard_new(
         storage_db_shard_index_t index,
         char *path,
@@ -436,23 +533,6 @@ bool storage_db_close(
     return true;
 }
 
-void storage_db_deleted_entry_ring_buffer_per_worker_free(
-        storage_db_t *db,
-        uint32_t worker_index) {
-    storage_db_entry_index_t *entry_index = NULL;
-    ring_bounded_queue_spsc_voidptr_t *rb = db->workers[worker_index].deleted_entry_index_ring_buffer;
-
-    if (!rb) {
-        return;
-    }
-
-    while((entry_index = ring_bounded_queue_spsc_voidptr_dequeue(rb)) != NULL) {
-        storage_db_entry_index_free(db, entry_index);
-    }
-
-    ring_bounded_queue_spsc_voidptr_free(rb);
-}
-
 void storage_db_deleting_entry_index_list_per_worker_free(
         storage_db_t *db,
         uint32_t worker_index) {
@@ -479,7 +559,6 @@ void storage_db_free(
         uint32_t workers_count) {
     // Free up the per_worker allocated memory
     for(uint32_t worker_index = 0; worker_index < workers_count; worker_index++) {
-        storage_db_deleted_entry_ring_buffer_per_worker_free(db, worker_index);
         storage_db_deleting_entry_index_list_per_worker_free(db, worker_index);
     }
 
@@ -501,60 +580,219 @@ void storage_db_free(
     hashtable_mcmp_free(db->hashtable);
     storage_db_config_free(db->config);
     ffma_mem_free(db->workers);
+
+    storage_db_keys_slots_free(db);
+
+    storage_db_epoch_gc_unregister_object_types_destructor_cb();
+
     ffma_mem_free(db);
 }
 
-storage_db_entry_index_t *storage_db_entry_index_ring_buffer_new(
-        storage_db_t *db) {
+void storage_db_entry_index_touch(
+        storage_db_entry_index_t *entry_index) {
+    storage_db_last_access_time_ms_t now_ms = clock_monotonic_int64_ms();
+
+    // The entry index of a hot key is read by all the workers, the store is skipped when the value wouldn't change to
+    // avoid having the cache line bouncing between the cores on every read
+    if (entry_index->last_access_time_ms != now_ms) {
+        entry_index->last_access_time_ms = now_ms;
+    }
+}
+
+storage_db_entry_index_t *storage_db_entry_index_new() {
+    storage_db_entry_index_t *entry_index = ffma_mem_alloc_zero(sizeof(storage_db_entry_index_t));
+
+    if (likely(entry_index)) {
+        entry_index->created_time_ms = clock_monotonic_int64_ms();
+    }
+
+    return entry_index;
+}
+
+static bool storage_db_entry_index_can_embed_value(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *value_chunk_sequence) {
+    return
+            db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY &&
+            value_chunk_sequence &&
+            value_chunk_sequence->count == 1 &&
+            value_chunk_sequence->size > 0 &&
+            value_chunk_sequence->size <= STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE &&
+            storage_db_chunk_sequence_get(value_chunk_sequence, 0)->chunk_length == value_chunk_sequence->size;
+}
+
+static storage_db_chunk_sequence_t *storage_db_entry_index_embedded_value_init(
+        storage_db_entry_index_t *entry_index,
+        size_t size,
+        bool entry_index_value) {
+    storage_db_entry_index_embedded_value_t *embedded_value = (storage_db_entry_index_embedded_value_t*)(entry_index + 1);
+    embedded_value->chunk_sequence.count = 1;
+    embedded_value->chunk_sequence.entry_index_value = entry_index_value;
+    embedded_value->chunk_sequence.size = size;
+    embedded_value->chunk_sequence.sequence = &embedded_value->chunk_info;
+    embedded_value->chunk_info.memory.chunk_data = (void*)(&embedded_value->chunk_info + 1);
+    embedded_value->chunk_info.memory.chunk_data_shared_counter = NULL;
+    embedded_value->chunk_info.chunk_length = size;
+
+    return &embedded_value->chunk_sequence;
+}
+
+static storage_db_entry_index_t *storage_db_chunk_sequence_entry_index_value_get_entry_index(
+        storage_db_chunk_sequence_t *value_chunk_sequence) {
+    // The chunk sequence is the first member of the embedded value that follows the entry index
+    return ((storage_db_entry_index_t*)value_chunk_sequence) - 1;
+}
+
+static storage_db_entry_index_t *storage_db_entry_index_new_with_value(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *value_chunk_sequence) {
     storage_db_entry_index_t *entry_index;
-    // The storage_db_entry_indexes are stored into the hashtable and used as reference to keep track of the
-    // key and chunks of the value mapped to the index.
-    // When the entry on the hashtable is updated, the existing one can't free right away even if the readers_counter
-    // is set to zero because potentially one of the workers running on a different core might just have
-    // fetched the pointer trying to access it.
-    // To avoid a potential issue all the storage_db_entry_index are fetched from a ring buffer which is large.
-    // The ring buffer is used in a bit of an odd way, the entries are fetched from it only if the underlying
-    // circular queue is full, because this will guarantee that enough time will have passed for any context
-    // switch happened in between reading the value from the hashtable and checking if the value is still viable.
-    // The size of the ring buffer (so when it's full) is dictated by having enough room to allow any CPU that
-    // might be trying to access the value stored in the hashtable to be checked.
-    // if the queue is not full then a new entry_index is allocated
-
-    ring_bounded_queue_spsc_voidptr_t *rb = storage_db_worker_deleted_entry_index_ring_buffer(db);
-
-    if (ring_bounded_queue_spsc_voidptr_is_full(rb)) {
-        entry_index = ring_bounded_queue_spsc_voidptr_dequeue(rb);
-        entry_index->status._cas_wrapper = 0;
-    } else {
+
+    if (value_chunk_sequence && value_chunk_sequence->entry_index_value) {
+        // The value has been written straight into the entry index allocated with it, the entry index is reset as it
+        // might have never been initialized or have been used by a previous attempt that failed
+        entry_index = storage_db_chunk_sequence_entry_index_value_get_entry_index(value_chunk_sequence);
+        memset(entry_index, 0, sizeof(storage_db_entry_index_t));
+        entry_index->created_time_ms = clock_monotonic_int64_ms();
+        entry_index->value = value_chunk_sequence;
+
+        return entry_index;
+    }
+
+    if (!storage_db_entry_index_can_embed_value(db, value_chunk_sequence)) {
         entry_index = storage_db_entry_index_new();
+
+        if (likely(entry_index)) {
+            entry_index->value = value_chunk_sequence;
+        }
+
+        return entry_index;
+    }
+
+    // The value is copied, the chunk sequence passed is still owned by the caller and, once the entry index has been
+    // stored, it has to be freed with storage_db_entry_index_embedded_value_source_free as it's not referenced anymore
+    entry_index = ffma_mem_alloc_zero(
+            sizeof(storage_db_entry_index_t) +
+            sizeof(storage_db_entry_index_embedded_value_t) +
+            value_chunk_sequence->size);
+
+    if (unlikely(!entry_index)) {
+        return NULL;
     }
 
     entry_index->created_time_ms = clock_monotonic_int64_ms();
+    entry_index->value = storage_db_entry_index_embedded_value_init(entry_index, value_chunk_sequence->size, false);
+
+    memcpy(
+            entry_index->value->sequence->memory.chunk_data,
+            storage_db_chunk_sequence_get(value_chunk_sequence, 0)->memory.chunk_data,
+            value_chunk_sequence->size);
 
     return entry_index;
 }
 
-void storage_db_entry_index_touch(
+static bool storage_db_entry_index_new_with_value_copied(
+        storage_db_entry_index_t *entry_index,
+        storage_db_chunk_sequence_t *value_chunk_sequence) {
+    return entry_index->value != value_chunk_sequence;
+}
+
+static void storage_db_entry_index_free_keep_value(
+        storage_db_t *db,
         storage_db_entry_index_t *entry_index) {
-    entry_index->last_access_time_ms = clock_monotonic_int64_ms();
+    // The caller keeps the ownership of the value, if the entry index has been allocated together with the value it
+    // belongs to the value and it's freed with it
+    if (storage_db_entry_index_has_embedded_value(entry_index) && entry_index->value->entry_index_value) {
+        return;
+    }
+
+    entry_index->value = NULL;
+    storage_db_entry_index_free(db, entry_index);
 }
 
-void storage_db_entry_index_ring_buffer_free(
+static void storage_db_entry_index_embedded_value_source_free(
         storage_db_t *db,
+        storage_db_chunk_sequence_t *value_chunk_sequence) {
+    storage_db_chunk_sequence_free(db, value_chunk_sequence);
+    ffma_mem_free(value_chunk_sequence);
+}
+
+static epoch_gc_object_type_t storage_db_entry_index_epoch_gc_object_type(
         storage_db_entry_index_t *entry_index) {
-    ring_bounded_queue_spsc_voidptr_t *rb = storage_db_worker_deleted_entry_index_ring_buffer(db);
+    size_t value_size = entry_index->value ? entry_index->value->size : 0;
 
-    // If the queue is full, the entry in the head can be dequeued and freed because it means it has lived enough
-    if (ring_bounded_queue_spsc_voidptr_is_full(rb)) {
-        storage_db_entry_index_t *entry_index_to_free = ring_bounded_queue_spsc_voidptr_dequeue(rb);
-        storage_db_entry_index_free(db, entry_index_to_free);
+    if (value_size <= STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE) {
+        return EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+    } else if (value_size < 64 * 1024) {
+        return EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_SMALL;
+    } else if (value_size < 1024 * 1024) {
+        return EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_MEDIUM;
+    } else if (value_size < 16 * 1024 * 1024) {
+        return EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE;
     }
 
-    ring_bounded_queue_spsc_voidptr_enqueue(rb, entry_index);
+    return EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
 }
 
-storage_db_entry_index_t *storage_db_entry_index_new() {
-    return ffma_mem_alloc_zero(sizeof(storage_db_entry_index_t));
+static void storage_db_epoch_gc_object_type_entry_index_destructor_cb(
+        uint8_t staged_objects_count,
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data) {
+    storage_db_t *db = user_data;
+
+    for(uint8_t index = 0; index < staged_objects_count; index++) {
+        storage_db_entry_index_t *entry_index = staged_objects[index].data.object;
+        storage_db_entry_index_free(db, entry_index);
+    }
+}
+
+void storage_db_epoch_gc_register_object_types_destructor_cb(
+        storage_db_t *db) {
+    // The db owning the staged entry indexes is passed to the destructors, the object types are global so only one db
+    // per process can stage entry indexes
+    for(
+            epoch_gc_object_type_t object_type = EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+            object_type <= EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
+            object_type++) {
+        epoch_gc_register_object_type_destructor_cb(
+                object_type,
+                storage_db_epoch_gc_object_type_entry_index_destructor_cb,
+                db);
+    }
+}
+
+void storage_db_epoch_gc_unregister_object_types_destructor_cb() {
+    for(
+            epoch_gc_object_type_t object_type = EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+            object_type <= EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
+            object_type++) {
+        epoch_gc_unregister_object_type_destructor_cb(object_type);
+    }
+}
+
+void storage_db_entry_index_stage_free(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    // The entry index has already been removed from the hashtable and has no readers but a worker running on a
+    // different core might just have fetched the pointer and be about to check its status, therefore it can't be freed
+    // right away.
+    // The entry index, together with its chunks, is staged in the epoch gc of the current thread and it will be freed
+    // by the epoch gc worker once all the workers have moved past the current point in time, that is once all of them
+    // have completed the loop iteration during which the pointer might have been fetched.
+    // The epoch used is the current tsc and not the epoch of the thread, that is set at the beginning of the loop
+    // iteration, as a worker might have started a new iteration, and fetched the pointer, in between.
+    // If the current thread has no epoch gc (e.g. it's not a worker) the entry index is freed immediately.
+    epoch_gc_object_type_t object_type = storage_db_entry_index_epoch_gc_object_type(entry_index);
+
+    if (unlikely(!epoch_gc_thread_is_registered_local(object_type))) {
+        storage_db_entry_index_free(db, entry_index);
+        return;
+    }
+
+    if (unlikely(!epoch_gc_stage_object_with_epoch(object_type, entry_index, intrinsics_tsc()))) {
+        LOG_E(TAG, "Unable to stage the entry index in the epoch gc, freeing it immediately");
+        storage_db_entry_index_free(db, entry_index);
+    }
 }
 
 size_t storage_db_chunk_sequence_calculate_chunk_count(
@@ -585,6 +823,13 @@ storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate(
     storage_db_chunk_index_t allocated_chunks_count = 0;
     uint32_t chunk_count = storage_db_chunk_sequence_calculate_chunk_count(size);
     size_t remaining_length = size;
+    size_t chunk_max_size = STORAGE_DB_CHUNK_MAX_SIZE;
+
+    // With the memory backend the value is always stored in a single chunk, to be read or sent in one go
+    if (db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY && size > 0) {
+        chunk_count = 1;
+        chunk_max_size = size;
+    }
 
     storage_db_chunk_sequence_t *chunk_sequence = ffma_mem_alloc(sizeof(storage_db_chunk_sequence_t));
 
@@ -597,8 +842,21 @@ storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate(
 
     chunk_sequence->size = size;
     chunk_sequence->count = chunk_count;
+    chunk_sequence->entry_index_value = false;
+
+    if (db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY &&
+        size > 0 && size <= STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE) {
+        // The data are embedded, allocated together with the only chunk info of the sequence
+        chunk_sequence->sequence = ffma_mem_alloc(sizeof(storage_db_chunk_info_t) + size);
+
+        if (unlikely(!chunk_sequence->sequence)) {
+            goto end;
+        }
 
-    if (likely(size > 0)) {
+        chunk_sequence->sequence->memory.chunk_data = (void*)(chunk_sequence->sequence + 1);
+        chunk_sequence->sequence->memory.chunk_data_shared_counter = NULL;
+        chunk_sequence->sequence->chunk_length = size;
+    } else if (likely(size > 0)) {
         chunk_sequence->sequence = ffma_mem_alloc(sizeof(storage_db_chunk_info_t) * chunk_count);
 
         if (unlikely(!chunk_sequence->sequence)) {
@@ -611,11 +869,11 @@ storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate(
             if (!storage_db_chunk_data_pre_allocate(
                     db,
                     chunk_info,
-                    MIN(remaining_length, STORAGE_DB_CHUNK_MAX_SIZE))) {
+                    MIN(remaining_length, chunk_max_size))) {
                 goto end;
             }
 
-            remaining_length -= STORAGE_DB_CHUNK_MAX_SIZE;
+            remaining_length -= MIN(remaining_length, chunk_max_size);
             allocated_chunks_count++;
         }
     } else {
@@ -642,9 +900,109 @@ end:
     return chunk_sequence;
 }
 
+storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate_entry_index_value(
+        storage_db_t *db,
+        size_t size) {
+    if (db->config->backend_type != STORAGE_DB_BACKEND_TYPE_MEMORY ||
+        size == 0 || size > STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE) {
+        return storage_db_chunk_sequence_allocate(db, size);
+    }
+
+    // The small values are allocated as the embedded value of an entry index, the data are written straight into their
+    // final location and, if the value gets stored, storage_db_entry_index_new_with_value picks up the entry index
+    // instead of copying them. The sequence is part of the entry index allocation, it has to be freed only via
+    // storage_db_chunk_sequence_free.
+    storage_db_entry_index_t *entry_index = ffma_mem_alloc(
+            sizeof(storage_db_entry_index_t) +
+            sizeof(storage_db_entry_index_embedded_value_t) +
+            size);
+
+    if (unlikely(!entry_index)) {
+        LOG_E(
+                TAG,
+                "Failed to allocate a chunk sequence");
+        return NULL;
+    }
+
+    // The entry index itself is initialized only when the value gets stored
+    return storage_db_entry_index_embedded_value_init(entry_index, size, true);
+}
+
+storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate_like(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence_source) {
+    storage_db_chunk_index_t allocated_chunks_count = 0;
+    storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_new(chunk_sequence_source->count);
+
+    if (unlikely(!chunk_sequence)) {
+        return NULL;
+    }
+
+    // The chunks are allocated with the same length of the source ones, the data types that map their internal
+    // structure on the chunks (e.g. the lists) rely on it
+    for(; allocated_chunks_count < chunk_sequence->count; allocated_chunks_count++) {
+        storage_db_chunk_info_t *chunk_info_source = storage_db_chunk_sequence_get(
+                chunk_sequence_source,
+                allocated_chunks_count);
+
+        if (!storage_db_chunk_data_pre_allocate(
+                db,
+                storage_db_chunk_sequence_get(chunk_sequence, allocated_chunks_count),
+                chunk_info_source->chunk_length)) {
+            break;
+        }
+    }
+
+    if (unlikely(allocated_chunks_count < chunk_sequence->count)) {
+        chunk_sequence->count = allocated_chunks_count;
+        storage_db_chunk_sequence_free(db, chunk_sequence);
+        ffma_mem_free(chunk_sequence);
+
+        return NULL;
+    }
+
+    chunk_sequence->size = chunk_sequence_source->size;
+
+    return chunk_sequence;
+}
+
+storage_db_chunk_sequence_t *storage_db_chunk_sequence_new(
+        storage_db_chunk_index_t chunks_count) {
+    storage_db_chunk_sequence_t *chunk_sequence = ffma_mem_alloc(sizeof(storage_db_chunk_sequence_t));
+
+    if (unlikely(!chunk_sequence)) {
+        LOG_E(
+                TAG,
+                "Failed to allocate a chunk sequence");
+        return NULL;
+    }
+
+    chunk_sequence->size = 0;
+    chunk_sequence->count = chunks_count;
+    chunk_sequence->entry_index_value = false;
+    chunk_sequence->sequence = NULL;
+
+    if (likely(chunks_count > 0)) {
+        chunk_sequence->sequence = ffma_mem_alloc_zero(sizeof(storage_db_chunk_info_t) * chunks_count);
+
+        if (unlikely(!chunk_sequence->sequence)) {
+            ffma_mem_free(chunk_sequence);
+            return NULL;
+        }
+    }
+
+    return chunk_sequence;
+}
+
 void storage_db_chunk_sequence_free(
         storage_db_t *db,
         storage_db_chunk_sequence_t *sequence) {
+    // The value allocated together with an entry index that hasn't been stored is freed with it
+    if (sequence->entry_index_value) {
+        ffma_mem_free(storage_db_chunk_sequence_entry_index_value_get_entry_index(sequence));
+        return;
+    }
+
     for (
             storage_db_chunk_index_t chunk_index = 0;
             chunk_index < sequence->count;
@@ -669,7 +1027,8 @@ void storage_db_entry_index_chunks_free(
         }
     }
 
-    if (entry_index->value) {
+    // The embedded value is freed together with the entry index
+    if (entry_index->value && !storage_db_entry_index_has_embedded_value(entry_index)) {
         storage_db_chunk_sequence_free(db, entry_index->value);
     }
 }
@@ -842,6 +1201,16 @@ void storage_db_entry_index_status_increase_readers_counter(
     }
 }
 
+bool storage_db_entry_index_status_try_increase_readers_counter(
+        storage_db_entry_index_t* entry_index) {
+    storage_db_entry_index_status_t old_status;
+
+    storage_db_entry_index_status_increase_readers_counter(entry_index, &old_status);
+
+    // If the entry index has been marked as deleted the readers counter has already been decreased
+    return !old_status.deleted;
+}
+
 void storage_db_entry_index_status_decrease_readers_counter(
         storage_db_entry_index_t* entry_index,
         storage_db_entry_index_status_t *old_status) {
@@ -893,13 +1262,79 @@ void storage_db_worker_garbage_collect_deleting_entry_index_when_no_readers(
             double_linked_list_remove_item(list, item);
             double_linked_list_item_free(item);
 
-            // Free the memory
-            storage_db_entry_index_chunks_free(db, entry_index);
+            // Stage the entry index, and its chunks, to be freed
+            storage_db_entry_index_stage_free(db, entry_index);
+        }
+    }
+}
+
+// A snapshot visits the entries incrementally while the writes go on, each snapshot has its own generation and the
+// entry indexes are tagged with the generation of the snapshot that has visited them. The new entry indexes are
+// tagged with the current generation so they are skipped by a running snapshot, the entry indexes replaced or deleted
+// before being visited are instead claimed by the writer and handed over to the snapshot.
+static inline __attribute__((always_inline)) void storage_db_snapshot_entry_index_tag(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    entry_index->snapshot_generation = __atomic_load_n(&db->snapshot.generation, __ATOMIC_ACQUIRE);
+}
+
+static inline __attribute__((always_inline)) bool storage_db_snapshot_entry_index_claim(
+        storage_db_t *db,
+        storage_db_entry_index_t *entry_index) {
+    uint8_t generation = __atomic_load_n(&db->snapshot.generation, __ATOMIC_ACQUIRE);
+    uint8_t entry_index_generation = __atomic_load_n(&entry_index->snapshot_generation, __ATOMIC_ACQUIRE);
+
+    // Either the snapshot or the writer replacing the entry index claims it, never both
+    return entry_index_generation != generation && __sync_bool_compare_and_swap(
+            &entry_index->snapshot_generation,
+            entry_index_generation,
+            generation);
+}
+
+static void storage_db_snapshot_preserve_entry_index(
+        storage_db_t *db,
+        char *key,
+        size_t key_length,
+        storage_db_entry_index_t *entry_index) {
+    char *snapshot_key;
+    storage_db_snapshot_entry_t *snapshot_entry;
+
+    if (likely(!__atomic_load_n(&db->snapshot.running, __ATOMIC_ACQUIRE)) || key == NULL || entry_index == NULL) {
+        return;
+    }
+
+    // The snapshot waits for the writers handing over an entry index before checking the preserved entries for the
+    // last time
+    __atomic_add_fetch(&db->snapshot.preserving, 1, __ATOMIC_SEQ_CST);
+
+    // An entry index already marked as deleted isn't part of the data anymore
+    if (likely(__atomic_load_n(&db->snapshot.running, __ATOMIC_SEQ_CST)) &&
+        !entry_index->status.deleted &&
+        storage_db_snapshot_entry_index_claim(db, entry_index)) {
+        storage_db_entry_index_status_increase_readers_counter(entry_index, NULL);
 
-            // Add the item to the ring buffer
-            storage_db_entry_index_ring_buffer_free(db, entry_index);
+        snapshot_key = xalloc_alloc(key_length);
+        memcpy(snapshot_key, key, key_length);
+
+        spinlock_lock(&db->snapshot.spinlock);
+
+        if (unlikely(db->snapshot.preserved_entries_count == db->snapshot.preserved_entries_size)) {
+            db->snapshot.preserved_entries_size = MAX(db->snapshot.preserved_entries_size * 2, 64);
+            db->snapshot.preserved_entries = xalloc_realloc(
+                    db->snapshot.preserved_entries,
+                    sizeof(storage_db_snapshot_entry_t) * db->snapshot.preserved_entries_size);
         }
+
+        snapshot_entry = &db->snapshot.preserved_entries[db->snapshot.preserved_entries_count];
+        snapshot_entry->key = snapshot_key;
+        snapshot_entry->key_length = key_length;
+        snapshot_entry->entry_index = entry_index;
+        db->snapshot.preserved_entries_count++;
+
+        spinlock_unlock(&db->snapshot.spinlock);
     }
+
+    __atomic_sub_fetch(&db->snapshot.preserving, 1, __ATOMIC_SEQ_CST);
 }
 
 void storage_db_worker_mark_deleted_or_deleting_previous_entry_index(
@@ -908,15 +1343,15 @@ void storage_db_worker_mark_deleted_or_deleting_previous_entry_index(
     // hashtable_mcmp_op_set and hashtable_mcmp_op_delete use a lock so there will never be a case with the current
     // implementation where to different invocations of these 2 commands will be returning the same
     // previous_entry_index pointer therefore it's safe to assume that the current thread is the one that is
-    // going to do the delete operation moving the entry_index into the deleting list or the deleted ring buffer.
+    // going to do the delete operation moving the entry_index into the deleting list or staging it to be freed.
     storage_db_entry_index_status_t old_status;
     storage_db_entry_index_status_set_deleted(
             previous_entry_index,
             true,
             &old_status);
 
-    // if readers counter is set to zero, the entry_index can be enqueued to the ring buffer, for future use, but
-    // if there are readers, the entry index can't be freed or reused until readers_counter gets down to zero
+    // if readers counter is set to zero, the entry_index can be staged to be freed, together with its chunks, but if
+    // there are readers, the entry index can't be freed until readers_counter gets down to zero
 
     if (old_status.readers_counter == 0) {
         storage_db_entry_index_status_set_deleted(
@@ -924,9 +1359,7 @@ void storage_db_worker_mark_deleted_or_deleting_previous_entry_index(
                 true,
                 NULL);
 
-        storage_db_entry_index_chunks_free(db, previous_entry_index);
-
-        storage_db_entry_index_ring_buffer_free(db, previous_entry_index);
+        storage_db_entry_index_stage_free(db, previous_entry_index);
     } else {
         double_linked_list_item_t *item = double_linked_list_item_init();
         item->data = previous_entry_index;
@@ -962,18 +1395,81 @@ storage_db_entry_index_t *storage_db_get_entry_index(
     return entry_index;
 }
 
-bool storage_db_entry_index_is_expired(
-        storage_db_entry_index_t *entry_index) {
-    if (entry_index && entry_index->expiry_time_ms > 0) {
-        if (unlikely(clock_realtime_coarse_int64_ms() > entry_index->expiry_time_ms)) {
-            return true;
-        }
-    }
-
-    return false;
+void storage_db_entry_index_prefetch(
+        storage_db_t *db,
+        char *key,
+        size_t key_length) {
+    hashtable_mcmp_op_get_prefetch(
+            db->hashtable,
+            hashtable_mcmp_support_hash_calculate(key, key_length));
 }
 
-int64_t storage_db_entry_index_ttl_ms(
+void storage_db_op_get_multi(
+        storage_db_t *db,
+        storage_db_key_and_key_length_t *keys,
+        uint32_t keys_count,
+        storage_db_entry_index_t **entry_indexes) {
+    hashtable_hash_t hashes[STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE];
+
+    // The keys are processed in batches, within each batch the hashes are calculated and the hashtable chunks are
+    // prefetched upfront, then the hashtable is searched and the entry indexes found prefetched before being prepared
+    // for read, so the cache misses of the keys in the same batch overlap instead of being serialized.
+    for(uint32_t batch_start = 0; batch_start < keys_count; batch_start += STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE) {
+        uint32_t batch_count = MIN(STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE, keys_count - batch_start);
+        storage_db_key_and_key_length_t *batch_keys = keys + batch_start;
+        storage_db_entry_index_t **batch_entry_indexes = entry_indexes + batch_start;
+
+        for(uint32_t index = 0; index < batch_count; index++) {
+            hashes[index] = hashtable_mcmp_support_hash_calculate(batch_keys[index].key, batch_keys[index].key_size);
+            hashtable_mcmp_op_get_prefetch(db->hashtable, hashes[index]);
+        }
+
+        for(uint32_t index = 0; index < batch_count; index++) {
+            hashtable_value_data_t memptr = 0;
+
+            batch_entry_indexes[index] = NULL;
+            if (!hashtable_mcmp_op_get_by_hash(
+                    db->hashtable,
+                    hashes[index],
+                    batch_keys[index].key,
+                    batch_keys[index].key_size,
+                    &memptr)) {
+                continue;
+            }
+
+            batch_entry_indexes[index] = (storage_db_entry_index_t *)memptr;
+
+            // The entry index is going to be written to update the access time and the readers counter
+            __builtin_prefetch(batch_entry_indexes[index], 1, 3);
+        }
+
+        for(uint32_t index = 0; index < batch_count; index++) {
+            if (!batch_entry_indexes[index]) {
+                continue;
+            }
+
+            storage_db_entry_index_touch(batch_entry_indexes[index]);
+            batch_entry_indexes[index] = storage_db_get_entry_index_for_read_prep(
+                    db,
+                    batch_keys[index].key,
+                    batch_keys[index].key_size,
+                    batch_entry_indexes[index]);
+        }
+    }
+}
+
+bool storage_db_entry_index_is_expired(
+        storage_db_entry_index_t *entry_index) {
+    if (entry_index && entry_index->expiry_time_ms > 0) {
+        if (unlikely(clock_realtime_coarse_int64_ms() > entry_index->expiry_time_ms)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int64_t storage_db_entry_index_ttl_ms(
         storage_db_entry_index_t *entry_index) {
     if (entry_index->expiry_time_ms == STORAGE_DB_ENTRY_NO_EXPIRY) {
         return -1;
@@ -1053,14 +1549,140 @@ storage_db_entry_index_t *storage_db_get_entry_index_for_read(
     return entry_index;
 }
 
+bool storage_db_can_read_unpinned(
+        storage_db_t *db) {
+    // The entry indexes can be read without increasing the readers counter only if they are reclaimed via the epoch
+    // gc, which is the case only for the workers, and if reading the data doesn't require any I/O
+    return db->config->backend_type == STORAGE_DB_BACKEND_TYPE_MEMORY &&
+        epoch_gc_thread_is_registered_local(EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL);
+}
+
+storage_db_entry_index_t *storage_db_get_entry_index_for_read_unpinned(
+        storage_db_t *db,
+        char *key,
+        size_t key_length) {
+    // The returned entry index is not pinned, the readers counter is not increased to avoid having the cache line
+    // bouncing between the cores reading the same key, it's instead protected by the epoch of the worker: when it gets
+    // deleted it's staged in the epoch gc and it can't be freed until the worker starts a new loop iteration.
+    // The entry index, and its chunks, can be accessed only until the current fiber yields, if it's necessary to keep
+    // it longer it has to be pinned with storage_db_entry_index_status_try_increase_readers_counter.
+    // The caller has to check with storage_db_can_read_unpinned that this kind of read is possible.
+    storage_db_entry_index_t *entry_index = storage_db_get_entry_index(db, key, key_length);
+
+    if (unlikely(!entry_index)) {
+        return NULL;
+    }
+
+    MEMORY_FENCE_LOAD();
+    if (unlikely(entry_index->status.deleted)) {
+        return NULL;
+    }
+
+    if (unlikely(storage_db_entry_index_is_expired(entry_index))) {
+        // The expired entry index has to be deleted, the pinned path takes care of it
+        entry_index = storage_db_get_entry_index_for_read_prep(db, key, key_length, entry_index);
+
+        if (entry_index) {
+            storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+        }
+    }
+
+    return entry_index;
+}
+
+uint16_t storage_db_key_slot(
+        char *key,
+        size_t key_length) {
+    // As in Redis Cluster, if the key contains a non-empty hash tag, the part between the first { and the following },
+    // only the hash tag is hashed so the keys sharing it are mapped to the same slot
+    char *hash_tag_start = memchr(key, '{', key_length);
+
+    if (hash_tag_start != NULL) {
+        size_t hash_tag_offset = hash_tag_start - key + 1;
+        char *hash_tag_end = memchr(key + hash_tag_offset, '}', key_length - hash_tag_offset);
+
+        if (hash_tag_end != NULL && hash_tag_end > key + hash_tag_offset) {
+            key += hash_tag_offset;
+            key_length = hash_tag_end - key;
+        }
+    }
+
+    return hash_crc16(key, key_length) & (STORAGE_DB_KEYS_SLOTS_COUNT - 1);
+}
+
+static inline __attribute__((always_inline)) void storage_db_keys_slot_key_init(
+        storage_db_t *db,
+        char *key,
+        size_t key_length,
+        storage_db_keys_slot_key_t *slot_key) {
+    uint32_t slot_key_prefix = (uint32_t)key_length;
+
+    slot_key->data = NULL;
+
+    if (likely(db->keys_slots == NULL)) {
+        return;
+    }
+
+    // The slot key has to be built before changing the hashtable, the key passed to the hashtable is freed if it's
+    // already present or if it's inlined and, once stored, it's freed if the key gets deleted by another worker
+    slot_key->slot = storage_db_key_slot(key, key_length);
+    slot_key->length = sizeof(slot_key_prefix) + key_length;
+    slot_key->data = xalloc_alloc(slot_key->length);
+    memcpy(slot_key->data, &slot_key_prefix, sizeof(slot_key_prefix));
+    memcpy(slot_key->data + sizeof(slot_key_prefix), key, key_length);
+}
+
+static void storage_db_keys_slot_key_sync(
+        storage_db_t *db,
+        storage_db_keys_slot_key_t *slot_key) {
+    hashtable_value_data_t value;
+
+    if (likely(slot_key->data == NULL)) {
+        return;
+    }
+
+    storage_db_keys_slot_t *keys_slot = &db->keys_slots[slot_key->slot];
+
+    // The key is added or removed depending on whether it's in the hashtable, the lookup is carried out holding the
+    // lock of the slot so if the key is set and deleted concurrently the last one updating the index sees its final
+    // state
+    spinlock_lock(&keys_slot->spinlock);
+
+    if (hashtable_mcmp_op_get(
+            db->hashtable,
+            (char*)slot_key->data + sizeof(uint32_t),
+            slot_key->length - sizeof(uint32_t),
+            &value)) {
+        art_insert(&keys_slot->keys, slot_key->data, slot_key->length, NULL);
+    } else {
+        art_delete(&keys_slot->keys, slot_key->data, slot_key->length);
+    }
+
+    spinlock_unlock(&keys_slot->spinlock);
+
+    xalloc_free(slot_key->data);
+    slot_key->data = NULL;
+}
+
 bool storage_db_set_entry_index(
         storage_db_t *db,
         char *key,
         size_t key_length,
         storage_db_entry_index_t *entry_index) {
+    char *snapshot_key = NULL;
+    storage_db_keys_slot_key_t slot_key;
     storage_db_entry_index_t *previous_entry_index = NULL;
 
     storage_db_entry_index_touch(entry_index);
+    storage_db_snapshot_entry_index_tag(db, entry_index);
+    storage_db_keys_slot_key_init(db, key, key_length, &slot_key);
+
+    // The hashtable frees the key if it's already present, a running snapshot needs a copy to preserve the previous
+    // entry index
+    if (unlikely(__atomic_load_n(&db->snapshot.running, __ATOMIC_ACQUIRE))) {
+        snapshot_key = xalloc_alloc(key_length);
+        memcpy(snapshot_key, key, key_length);
+    }
 
     bool res = hashtable_mcmp_op_set(
             db->hashtable,
@@ -1070,13 +1692,24 @@ bool storage_db_set_entry_index(
             (uintptr_t*)&previous_entry_index);
 
     if (res && previous_entry_index != NULL) {
+        storage_db_snapshot_preserve_entry_index(db, snapshot_key, key_length, previous_entry_index);
         storage_db_worker_mark_deleted_or_deleting_previous_entry_index(db, previous_entry_index);
+    } else if (res) {
+        storage_db_keys_slot_key_sync(db, &slot_key);
+    }
+
+    if (slot_key.data) {
+        xalloc_free(slot_key.data);
+    }
+
+    if (snapshot_key) {
+        xalloc_free(snapshot_key);
     }
 
     return res;
 }
 
-bool storage_db_op_set(
+storage_db_entry_index_t *storage_db_op_set_entry_index_new(
         storage_db_t *db,
         char *key,
         size_t key_length,
@@ -1085,7 +1718,7 @@ bool storage_db_op_set(
         storage_db_expiry_time_ms_t expiry_time_ms) {
     bool result_res = false;
 
-    storage_db_entry_index_t *entry_index = storage_db_entry_index_ring_buffer_new(db);
+    storage_db_entry_index_t *entry_index = storage_db_entry_index_new_with_value(db, value_chunk_sequence);
     if (!entry_index) {
         LOG_E(TAG, "Unable to allocate the database index entry in memory");
         goto end;
@@ -1116,34 +1749,300 @@ bool storage_db_op_set(
     }
 
     // Fetch a new entry and assign the key and the value as needed
-    entry_index->value = value_chunk_sequence;
+    entry_index->value_type = value_type;
     entry_index->expiry_time_ms = expiry_time_ms;
 
+    result_res = true;
+
+end:
+
+    if (!result_res) {
+        if (entry_index) {
+            storage_db_entry_index_free_keep_value(db, entry_index);
+            entry_index = NULL;
+        }
+    }
+
+    return entry_index;
+}
+
+bool storage_db_op_set(
+        storage_db_t *db,
+        char *key,
+        size_t key_length,
+        storage_db_entry_index_value_type_t value_type,
+        storage_db_chunk_sequence_t *value_chunk_sequence,
+        storage_db_expiry_time_ms_t expiry_time_ms) {
+    storage_db_entry_index_t *entry_index = storage_db_op_set_entry_index_new(
+            db,
+            key,
+            key_length,
+            value_type,
+            value_chunk_sequence,
+            expiry_time_ms);
+
+    if (!entry_index) {
+        return false;
+    }
+
+    // Once stored the entry index might be replaced and staged for deletion at any time, it can't be accessed anymore
+    bool value_copied = storage_db_entry_index_new_with_value_copied(entry_index, value_chunk_sequence);
+
     // Try to store the entry index in the database
     if (!storage_db_set_entry_index(
             db,
             key,
             key_length,
             entry_index)) {
-        // As the operation failed while getting ownership of the value, it gets set back to null as to let the caller
-        // handle the memory free as necessary
-        entry_index->value = NULL;
+        // As the operation failed while getting ownership of the value, the caller handles the memory free as necessary
+        storage_db_entry_index_free_keep_value(db, entry_index);
+
+        return false;
+    }
+
+    if (value_copied) {
+        storage_db_entry_index_embedded_value_source_free(db, value_chunk_sequence);
+    }
+
+    return true;
+}
+
+static int storage_db_op_set_multi_key_compare(
+        const void *a,
+        const void *b) {
+    storage_db_key_and_key_length_t *key_a = *(storage_db_key_and_key_length_t**)a;
+    storage_db_key_and_key_length_t *key_b = *(storage_db_key_and_key_length_t**)b;
+
+    if (key_a->key_size != key_b->key_size) {
+        return key_a->key_size < key_b->key_size ? -1 : 1;
+    }
+
+    int res = memcmp(key_a->key, key_b->key, key_a->key_size);
+    if (res != 0) {
+        return res;
+    }
+
+    // The occurrences of the same key are sorted by position, the last one is always the last of the group
+    return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+bool storage_db_op_set_multi(
+        storage_db_t *db,
+        storage_db_key_and_key_length_t *keys,
+        storage_db_chunk_sequence_t **values_chunk_sequences,
+        uint32_t keys_count,
+        storage_db_entry_index_value_type_t value_type,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        uint32_t *keys_set_count) {
+    bool result_res = false;
+    uint32_t entry_indexes_count = 0;
+    transaction_t transaction = { 0 };
+
+    *keys_set_count = 0;
+
+    hashtable_hash_t *hashes = ffma_mem_alloc(sizeof(hashtable_hash_t) * keys_count);
+    storage_db_entry_index_t **entry_indexes = ffma_mem_alloc_zero(sizeof(storage_db_entry_index_t*) * keys_count);
+    hashtable_mcmp_op_rmw_status_t *rmw_statuses =
+            ffma_mem_alloc(sizeof(hashtable_mcmp_op_rmw_status_t) * keys_count);
+    bool *keys_superseded = ffma_mem_alloc_zero(sizeof(bool) * keys_count);
+    bool *values_copied = ffma_mem_alloc_zero(sizeof(bool) * keys_count);
+
+    // The hashes are calculated upfront and the chunks prefetched while the entry indexes are being prepared, the
+    // memory accesses to the hashtable will overlap with the work carried out on the entry indexes
+    for(uint32_t index = 0; index < keys_count; index++) {
+        hashes[index] = hashtable_mcmp_support_hash_calculate(keys[index].key, keys[index].key_size);
+        hashtable_mcmp_op_get_prefetch(db->hashtable, hashes[index]);
+    }
+
+    for(; entry_indexes_count < keys_count; entry_indexes_count++) {
+        entry_indexes[entry_indexes_count] = storage_db_op_set_entry_index_new(
+                db,
+                keys[entry_indexes_count].key,
+                keys[entry_indexes_count].key_size,
+                value_type,
+                values_chunk_sequences[entry_indexes_count],
+                expiry_time_ms);
+
+        if (!entry_indexes[entry_indexes_count]) {
+            goto end;
+        }
+
+        values_copied[entry_indexes_count] = storage_db_entry_index_new_with_value_copied(
+                entry_indexes[entry_indexes_count],
+                values_chunk_sequences[entry_indexes_count]);
+        storage_db_entry_index_touch(entry_indexes[entry_indexes_count]);
+        storage_db_snapshot_entry_index_tag(db, entry_indexes[entry_indexes_count]);
+    }
+
+    // If a key is repeated only its last occurrence is stored, the slots are reserved before being updated so the
+    // previous occurrences wouldn't be found by the search and the key would end up being inserted multiple times
+    if (keys_count > 1) {
+        storage_db_key_and_key_length_t **keys_sorted =
+                ffma_mem_alloc(sizeof(storage_db_key_and_key_length_t*) * keys_count);
+
+        for(uint32_t index = 0; index < keys_count; index++) {
+            keys_sorted[index] = &keys[index];
+        }
+
+        qsort(
+                keys_sorted,
+                keys_count,
+                sizeof(storage_db_key_and_key_length_t*),
+                storage_db_op_set_multi_key_compare);
+
+        for(uint32_t index = 0; index < keys_count - 1; index++) {
+            if (keys_sorted[index]->key_size == keys_sorted[index + 1]->key_size &&
+                memcmp(keys_sorted[index]->key, keys_sorted[index + 1]->key, keys_sorted[index]->key_size) == 0) {
+                keys_superseded[keys_sorted[index] - keys] = true;
+            }
+        }
+
+        ffma_mem_free(keys_sorted);
+    }
+
+    // The probe windows of all the keys are locked upfront, in ascending order, so the keys can be updated atomically
+    transaction_acquire(&transaction);
+
+    if (unlikely(!hashtable_mcmp_op_set_lock_chunks_by_hashes(
+            db->hashtable,
+            &transaction,
+            hashes,
+            keys_count))) {
+        transaction_release(&transaction);
         goto end;
     }
 
+    // The slots of all the keys are looked up, or reserved, before updating any of them, if one of the keys can't be
+    // stored the operations carried out so far are aborted and the hashtable is left untouched
+    for(uint32_t index = 0; index < keys_count; index++) {
+        if (keys_superseded[index]) {
+            continue;
+        }
+
+        if (unlikely(!hashtable_mcmp_op_rmw_begin(
+                db->hashtable,
+                &transaction,
+                &rmw_statuses[index],
+                keys[index].key,
+                keys[index].key_size,
+                NULL))) {
+            for(uint32_t abort_index = index; abort_index > 0; abort_index--) {
+                if (!keys_superseded[abort_index - 1]) {
+                    hashtable_mcmp_op_rmw_abort(&rmw_statuses[abort_index - 1]);
+                }
+            }
+
+            transaction_release(&transaction);
+            goto end;
+        }
+    }
+
+    for(uint32_t index = 0; index < keys_count; index++) {
+        if (keys_superseded[index]) {
+            continue;
+        }
+
+        // The key is freed by the hashtable if it's already present or if it's inlined
+        if (rmw_statuses[index].current_value != 0) {
+            storage_db_snapshot_preserve_entry_index(
+                    db,
+                    keys[index].key,
+                    keys[index].key_size,
+                    (storage_db_entry_index_t *)rmw_statuses[index].current_value);
+
+            hashtable_mcmp_op_rmw_commit_update(&rmw_statuses[index], (uintptr_t)entry_indexes[index]);
+        } else {
+            storage_db_keys_slot_key_t slot_key;
+            storage_db_keys_slot_key_init(db, keys[index].key, keys[index].key_size, &slot_key);
+
+            hashtable_mcmp_op_rmw_commit_update(&rmw_statuses[index], (uintptr_t)entry_indexes[index]);
+
+            storage_db_keys_slot_key_sync(db, &slot_key);
+        }
+    }
+
+    transaction_release(&transaction);
+
+    *keys_set_count = keys_count;
+
+    // The previous entry indexes are marked as deleted only once the chunks have been unlocked, the superseded entry
+    // indexes have never been visible so they can be freed together with their keys and values right away
+    for(uint32_t index = 0; index < keys_count; index++) {
+        if (values_copied[index]) {
+            storage_db_entry_index_embedded_value_source_free(db, values_chunk_sequences[index]);
+        }
+
+        if (keys_superseded[index]) {
+            storage_db_entry_index_free(db, entry_indexes[index]);
+            xalloc_free(keys[index].key);
+        } else if (rmw_statuses[index].current_value != 0) {
+            storage_db_worker_mark_deleted_or_deleting_previous_entry_index(
+                    db,
+                    (storage_db_entry_index_t *)rmw_statuses[index].current_value);
+        }
+    }
+
     result_res = true;
 
 end:
 
-    if (!result_res) {
-        if (entry_index) {
-            storage_db_entry_index_free(db, entry_index);
-        }
+    // The entry indexes that haven't been stored give back the ownership of the value to the caller
+    for(uint32_t index = *keys_set_count; index < entry_indexes_count; index++) {
+        storage_db_entry_index_free_keep_value(db, entry_indexes[index]);
     }
 
+    ffma_mem_free(hashes);
+    ffma_mem_free(entry_indexes);
+    ffma_mem_free(rmw_statuses);
+    ffma_mem_free(keys_superseded);
+    ffma_mem_free(values_copied);
+
     return result_res;
 }
 
+bool storage_db_op_lock_keys(
+        storage_db_t *db,
+        transaction_t *transaction,
+        storage_db_key_and_key_length_t *keys,
+        uint32_t keys_count) {
+    assert(transaction->transaction_id.id != TRANSACTION_ID_NOT_ACQUIRED);
+
+    hashtable_hash_t *hashes = ffma_mem_alloc(sizeof(hashtable_hash_t) * keys_count);
+
+    for(uint32_t index = 0; index < keys_count; index++) {
+        hashes[index] = hashtable_mcmp_support_hash_calculate(keys[index].key, keys[index].key_size);
+    }
+
+    // The chunks are locked in ascending order, the locks are released when the transaction is released
+    bool res = hashtable_mcmp_op_set_lock_chunks_by_hashes(
+            db->hashtable,
+            transaction,
+            hashes,
+            keys_count);
+
+    ffma_mem_free(hashes);
+
+    return res;
+}
+
+void storage_db_op_get_key_version(
+        storage_db_t *db,
+        char *key,
+        size_t key_length,
+        storage_db_key_version_t *key_version) {
+    hashtable_mcmp_op_version_t version = { 0 };
+
+    hashtable_mcmp_op_get_version(
+            db->hashtable,
+            key,
+            key_length,
+            &version);
+
+    key_version->chunk_index = version.chunk_index;
+    key_version->changes_counter = version.changes_counter;
+    key_version->entry_index = (storage_db_entry_index_t *)version.value;
+}
+
 bool storage_db_op_rmw_begin(
         storage_db_t *db,
         transaction_t *transaction,
@@ -1213,8 +2112,10 @@ bool storage_db_op_rmw_commit_update(
         storage_db_chunk_sequence_t *value_chunk_sequence,
         storage_db_expiry_time_ms_t expiry_time_ms) {
     bool result_res = false;
+    bool value_copied = false;
+    storage_db_keys_slot_key_t slot_key;
 
-    storage_db_entry_index_t *entry_index = storage_db_entry_index_ring_buffer_new(db);
+    storage_db_entry_index_t *entry_index = storage_db_entry_index_new_with_value(db, value_chunk_sequence);
     if (!entry_index) {
         LOG_E(TAG, "Unable to allocate the database index entry in memory");
         goto end;
@@ -1247,10 +2148,24 @@ bool storage_db_op_rmw_commit_update(
     }
 
     // Fetch a new entry and assign the key and the value as needed
-    entry_index->value = value_chunk_sequence;
+    entry_index->value_type = value_type;
     entry_index->expiry_time_ms = expiry_time_ms;
 
     storage_db_entry_index_touch(entry_index);
+    storage_db_snapshot_entry_index_tag(db, entry_index);
+
+    value_copied = storage_db_entry_index_new_with_value_copied(entry_index, value_chunk_sequence);
+
+    // The key is freed by the hashtable if it's already present or if it's inlined
+    if (rmw_status->hashtable.current_value != 0) {
+        storage_db_snapshot_preserve_entry_index(
+                db,
+                rmw_status->hashtable.key,
+                rmw_status->hashtable.key_size,
+                (storage_db_entry_index_t *)rmw_status->hashtable.current_value);
+    } else {
+        storage_db_keys_slot_key_init(db, rmw_status->hashtable.key, rmw_status->hashtable.key_size, &slot_key);
+    }
 
     hashtable_mcmp_op_rmw_commit_update(
             &rmw_status->hashtable,
@@ -1260,6 +2175,12 @@ bool storage_db_op_rmw_commit_update(
         storage_db_worker_mark_deleted_or_deleting_previous_entry_index(
                 db,
                 (storage_db_entry_index_t *)rmw_status->hashtable.current_value);
+    } else {
+        storage_db_keys_slot_key_sync(db, &slot_key);
+    }
+
+    if (value_copied) {
+        storage_db_entry_index_embedded_value_source_free(db, value_chunk_sequence);
     }
 
     result_res = true;
@@ -1267,7 +2188,9 @@ bool storage_db_op_rmw_commit_update(
 end:
 
     if (!result_res) {
-        storage_db_entry_index_free(db, entry_index);
+        if (entry_index) {
+            storage_db_entry_index_free_keep_value(db, entry_index);
+        }
 
         // Abort the underlying rmw operation in the hashtable if the commit fails
         hashtable_mcmp_op_rmw_abort(&rmw_status->hashtable);
@@ -1280,6 +2203,36 @@ void storage_db_op_rmw_commit_rename(
         storage_db_t *db,
         storage_db_op_rmw_status_t *rmw_status_source,
         storage_db_op_rmw_status_t *rmw_status_destination) {
+    storage_db_keys_slot_key_t slot_key_source, slot_key_destination = { 0 };
+
+    // The entry index is moved to the destination key, if a running snapshot hasn't visited it yet it's handed over
+    // with the source key, the tag prevents the snapshot from visiting it again once moved
+    storage_db_snapshot_preserve_entry_index(
+            db,
+            rmw_status_source->hashtable.key,
+            rmw_status_source->hashtable.key_size,
+            rmw_status_source->current_entry_index);
+
+    if (rmw_status_destination->hashtable.current_value != 0) {
+        storage_db_snapshot_preserve_entry_index(
+                db,
+                rmw_status_destination->hashtable.key,
+                rmw_status_destination->hashtable.key_size,
+                (storage_db_entry_index_t *)rmw_status_destination->hashtable.current_value);
+    } else {
+        storage_db_keys_slot_key_init(
+                db,
+                rmw_status_destination->hashtable.key,
+                rmw_status_destination->hashtable.key_size,
+                &slot_key_destination);
+    }
+
+    storage_db_keys_slot_key_init(
+            db,
+            rmw_status_source->hashtable.key,
+            rmw_status_source->hashtable.key_size,
+            &slot_key_source);
+
     hashtable_mcmp_op_rmw_commit_update(
             &rmw_status_destination->hashtable,
             (uintptr_t)rmw_status_source->current_entry_index);
@@ -1292,6 +2245,9 @@ void storage_db_op_rmw_commit_rename(
 
     hashtable_mcmp_op_rmw_commit_delete(&rmw_status_source->hashtable);
 
+    storage_db_keys_slot_key_sync(db, &slot_key_destination);
+    storage_db_keys_slot_key_sync(db, &slot_key_source);
+
     if (rmw_status_source->current_entry_index && !rmw_status_source->delete_entry_index_on_abort) {
         storage_db_entry_index_touch(rmw_status_source->current_entry_index);
     }
@@ -1300,11 +2256,24 @@ void storage_db_op_rmw_commit_rename(
 void storage_db_op_rmw_commit_delete(
         storage_db_t *db,
         storage_db_op_rmw_status_t *rmw_status) {
+    storage_db_keys_slot_key_t slot_key = { 0 };
+
+    storage_db_snapshot_preserve_entry_index(
+            db,
+            rmw_status->hashtable.key,
+            rmw_status->hashtable.key_size,
+            (storage_db_entry_index_t *)rmw_status->hashtable.current_value);
     storage_db_worker_mark_deleted_or_deleting_previous_entry_index(
             db,
             (storage_db_entry_index_t *)rmw_status->hashtable.current_value);
 
+    if (rmw_status->hashtable.current_value != 0) {
+        storage_db_keys_slot_key_init(db, rmw_status->hashtable.key, rmw_status->hashtable.key_size, &slot_key);
+    }
+
     hashtable_mcmp_op_rmw_commit_delete(&rmw_status->hashtable);
+
+    storage_db_keys_slot_key_sync(db, &slot_key);
 }
 
 void storage_db_op_rmw_abort(
@@ -1330,7 +2299,14 @@ bool storage_db_op_delete(
             (uintptr_t*)&current_entry_index);
 
     if (res && current_entry_index != NULL) {
+        storage_db_keys_slot_key_t slot_key;
+
+        storage_db_snapshot_preserve_entry_index(db, key, key_length, current_entry_index);
         storage_db_worker_mark_deleted_or_deleting_previous_entry_index(db, current_entry_index);
+
+        // The key belongs to the caller, it can be used after the deletion
+        storage_db_keys_slot_key_init(db, key, key_length, &slot_key);
+        storage_db_keys_slot_key_sync(db, &slot_key);
     }
 
     return res;
@@ -1365,14 +2341,22 @@ bool storage_db_op_flush_sync(
     // implemented without having dealt with the flush
     assert(db->hashtable->ht_old == NULL);
     int64_t deletion_start_ms = clock_monotonic_int64_ms();
+    fiber_scheduler_yield_budget_t yield_budget;
 
-    // Iterates over the hashtable to free up the entry index
+    // Flushing a large database takes time, the fiber yields periodically to let the other fibers of the worker run
+    fiber_scheduler_yield_budget_init(&yield_budget, STORAGE_DB_OP_YIELD_BUDGET_CHECK_INTERVAL);
+
+    // Iterates over the hashtable to free up the entry index, the fiber might yield only before fetching the entry index
+    // as, once the fiber yields, the entry index can be deleted and freed by another worker
     hashtable_bucket_index_t bucket_index = 0;
-    for(
-            void *data = hashtable_mcmp_op_iter(db->hashtable, &bucket_index);
-            data;
-            ++bucket_index && (data = hashtable_mcmp_op_iter(db->hashtable, &bucket_index))) {
-        storage_db_entry_index_t *entry_index = data;
+    for(;; bucket_index++) {
+        fiber_scheduler_yield_budget_check(&yield_budget);
+
+        storage_db_entry_index_t *entry_index = hashtable_mcmp_op_iter(db->hashtable, &bucket_index);
+
+        if (entry_index == NULL) {
+            break;
+        }
 
         if (entry_index->created_time_ms <= deletion_start_ms) {
             hashtable_key_data_t *key;
@@ -1424,9 +2408,16 @@ storage_db_key_and_key_length_t *storage_db_op_get_keys(
     // implemented without having dealt with the flush
     assert(db->hashtable->ht_old == NULL);
     int64_t scan_start_ms = clock_monotonic_int64_ms();
+    fiber_scheduler_yield_budget_t yield_budget;
+
+    // KEYS and SCAN with a large count can iterate over the whole hashtable, the fiber yields periodically to let the
+    // other fibers of the worker run
+    fiber_scheduler_yield_budget_init(&yield_budget, STORAGE_DB_OP_YIELD_BUDGET_CHECK_INTERVAL);
 
     // Iterates over the hashtable to free up the entry index
     do {
+        fiber_scheduler_yield_budget_check(&yield_budget);
+
         entry_index = hashtable_mcmp_op_iter(db->hashtable, &bucket_index);
 
         if (unlikely(entry_index == NULL)) {
@@ -1469,6 +2460,71 @@ storage_db_key_and_key_length_t *storage_db_op_get_keys(
     return keys;
 }
 
+uint32_t storage_db_op_count_keys_in_slot(
+        storage_db_t *db,
+        uint16_t slot) {
+    if (db->keys_slots == NULL) {
+        return 0;
+    }
+
+    return (uint32_t)__atomic_load_n(&art_size(&db->keys_slots[slot].keys), __ATOMIC_RELAXED);
+}
+
+typedef struct storage_db_op_get_keys_in_slot_iter_data storage_db_op_get_keys_in_slot_iter_data_t;
+struct storage_db_op_get_keys_in_slot_iter_data {
+    storage_db_key_and_key_length_t *keys;
+    uint64_t keys_count;
+    uint64_t count;
+};
+
+static int storage_db_op_get_keys_in_slot_iter_cb(
+        void *data,
+        const unsigned char *slot_key,
+        uint32_t slot_key_length,
+        void *value) {
+    storage_db_op_get_keys_in_slot_iter_data_t *iter_data = data;
+    storage_db_key_and_key_length_t *key = &iter_data->keys[iter_data->keys_count];
+
+    key->key_size = slot_key_length - sizeof(uint32_t);
+    key->key = xalloc_alloc(key->key_size);
+    memcpy(key->key, slot_key + sizeof(uint32_t), key->key_size);
+    iter_data->keys_count++;
+
+    return iter_data->keys_count == iter_data->count ? 1 : 0;
+}
+
+storage_db_key_and_key_length_t *storage_db_op_get_keys_in_slot(
+        storage_db_t *db,
+        uint16_t slot,
+        uint64_t count,
+        uint64_t *keys_count) {
+    storage_db_keys_slot_t *keys_slot;
+    storage_db_op_get_keys_in_slot_iter_data_t iter_data = { 0 };
+
+    *keys_count = 0;
+
+    if (db->keys_slots == NULL) {
+        return NULL;
+    }
+
+    keys_slot = &db->keys_slots[slot];
+
+    // Only the keys of the slot are visited, the amount of keys can't change while the lock is held
+    spinlock_lock(&keys_slot->spinlock);
+
+    iter_data.count = MIN(count, art_size(&keys_slot->keys));
+    if (iter_data.count > 0) {
+        iter_data.keys = xalloc_alloc(sizeof(storage_db_key_and_key_length_t) * iter_data.count);
+        art_iter(&keys_slot->keys, storage_db_op_get_keys_in_slot_iter_cb, &iter_data);
+    }
+
+    spinlock_unlock(&keys_slot->spinlock);
+
+    *keys_count = iter_data.keys_count;
+
+    return iter_data.keys;
+}
+
 void storage_db_free_key_and_key_length_list(
         storage_db_key_and_key_length_t *keys,
         uint64_t keys_count) {
@@ -1477,3 +2533,125 @@ void storage_db_free_key_and_key_length_list(
     }
     xalloc_free(keys);
 }
+
+void storage_db_snapshot_begin(
+        storage_db_t *db) {
+    // The writes have to be paused by the caller, the entry indexes created from now on are tagged with the new
+    // generation, the ones already existing are tagged with the generation of an older snapshot
+    db->snapshot.bucket_index = 0;
+    db->snapshot.iter_completed = false;
+    __atomic_add_fetch(&db->snapshot.generation, 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&db->snapshot.running, true, __ATOMIC_SEQ_CST);
+}
+
+static bool storage_db_snapshot_pop_preserved_entry(
+        storage_db_t *db,
+        storage_db_snapshot_entry_t *snapshot_entry) {
+    bool found = false;
+
+    if (likely(__atomic_load_n(&db->snapshot.preserved_entries_count, __ATOMIC_ACQUIRE) == 0)) {
+        return false;
+    }
+
+    spinlock_lock(&db->snapshot.spinlock);
+
+    if (db->snapshot.preserved_entries_count > 0) {
+        db->snapshot.preserved_entries_count--;
+        *snapshot_entry = db->snapshot.preserved_entries[db->snapshot.preserved_entries_count];
+        found = true;
+    }
+
+    spinlock_unlock(&db->snapshot.spinlock);
+
+    return found;
+}
+
+bool storage_db_snapshot_next(
+        storage_db_t *db,
+        storage_db_snapshot_entry_t *snapshot_entry) {
+    hashtable_key_data_t *key;
+    hashtable_key_size_t key_size;
+    hashtable_bucket_index_t bucket_index;
+    storage_db_entry_index_t *entry_index;
+    fiber_scheduler_yield_budget_t yield_budget;
+
+    // Most of the entries visited might have been created after the snapshot began, the fiber yields periodically to
+    // let the other fibers of the worker run
+    fiber_scheduler_yield_budget_init(&yield_budget, STORAGE_DB_OP_YIELD_BUDGET_CHECK_INTERVAL);
+
+    do {
+        // The entries handed over by the writers are returned first to release them as soon as possible
+        if (storage_db_snapshot_pop_preserved_entry(db, snapshot_entry)) {
+            return true;
+        }
+
+        if (db->snapshot.iter_completed) {
+            return false;
+        }
+
+        fiber_scheduler_yield_budget_check(&yield_budget);
+
+        bucket_index = db->snapshot.bucket_index;
+        if (hashtable_mcmp_op_iter(db->hashtable, &bucket_index) == NULL) {
+            // All the entry indexes have been visited or handed over, once the writers handing over an entry index
+            // are done the preserved entries are checked for the last time
+            __atomic_store_n(&db->snapshot.running, false, __ATOMIC_SEQ_CST);
+            while(__atomic_load_n(&db->snapshot.preserving, __ATOMIC_SEQ_CST) > 0) {
+                // do nothing
+            }
+
+            db->snapshot.iter_completed = true;
+            continue;
+        }
+
+        db->snapshot.bucket_index = bucket_index + 1;
+
+        // The bucket might have been deleted in the meantime so get_key has to return true
+        if (unlikely(!hashtable_mcmp_op_get_key(db->hashtable, bucket_index, &key, &key_size))) {
+            continue;
+        }
+
+        // The entry index is pinned before being claimed, if it's claimed by a writer in the meantime it will be found
+        // among the preserved entries
+        entry_index = storage_db_get_entry_index_for_read(db, key, key_size);
+        if (unlikely(entry_index == NULL)) {
+            xalloc_free(key);
+            continue;
+        }
+
+        if (!storage_db_snapshot_entry_index_claim(db, entry_index)) {
+            storage_db_entry_index_status_decrease_readers_counter(entry_index, NULL);
+            xalloc_free(key);
+            continue;
+        }
+
+        snapshot_entry->key = key;
+        snapshot_entry->key_length = key_size;
+        snapshot_entry->entry_index = entry_index;
+
+        return true;
+    } while(true);
+}
+
+void storage_db_snapshot_entry_release(
+        storage_db_snapshot_entry_t *snapshot_entry) {
+    storage_db_entry_index_status_decrease_readers_counter(snapshot_entry->entry_index, NULL);
+    xalloc_free(snapshot_entry->key);
+}
+
+void storage_db_snapshot_end(
+        storage_db_t *db) {
+    storage_db_snapshot_entry_t snapshot_entry;
+
+    // If the snapshot has been interrupted the remaining entries have still to be visited, otherwise they would keep
+    // the generation of an older snapshot and, once the generation wraps around, they would be skipped
+    while(storage_db_snapshot_next(db, &snapshot_entry)) {
+        storage_db_snapshot_entry_release(&snapshot_entry);
+    }
+
+    if (db->snapshot.preserved_entries) {
+        xalloc_free(db->snapshot.preserved_entries);
+        db->snapshot.preserved_entries = NULL;
+        db->snapshot.preserved_entries_size = 0;
+    }
+}
@@ -10,16 +10,31 @@ extern "C" {
 //#define STORAGE_DB_SHARD_MAGIC_NUMBER_LOW  0x5241000000000000
 
 #define STORAGE_DB_SHARD_VERSION 1
+// With the file backend the values are split in chunks of up to this size, with the memory backend the values are
+// stored in a single chunk, the values larger than FFMA_OBJECT_SIZE_EXTENT_MAX are allocated in a run of contiguous
+// hugepages. The data types mapping their internal structure on the chunks still use this size for their chunks.
 #define STORAGE_DB_CHUNK_MAX_SIZE ((64 * 1024) - 1)
 
-// This magic value defines the size of the ring buffer used to keep in memory data long enough to be sure they are not
-// being in use anymore.
-#define STORAGE_DB_WORKER_ENTRY_INDEX_RING_BUFFER_SIZE 512
-
 #define STORAGE_DB_ENTRY_NO_EXPIRY (0)
 
+// Amount of keys looked up together by the multi-key operations, the hashtable chunks and the entry indexes of the keys
+// in a batch are prefetched together so the cache misses overlap, a larger batch would start to evict the prefetched
+// data before it gets used
+#define STORAGE_DB_OP_MULTI_PREFETCH_BATCH_SIZE 16
+
+// Amount of buckets iterated by the operations scanning the whole hashtable (e.g. flush, keys, scan) between the checks
+// of the time budget after which the fiber yields
+#define STORAGE_DB_OP_YIELD_BUDGET_CHECK_INTERVAL 256
+
+// Amount of slots the keys are mapped to when the keys are counted per slot, the same used by Redis Cluster
+#define STORAGE_DB_KEYS_SLOTS_COUNT 16384
+
+// With the memory backend the values up to this size are embedded, their data is allocated together with the chunk
+// info, saving an allocation and a pointer dereference for the common case of small strings
+#define STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE 256
+
 typedef uint16_t storage_db_chunk_index_t;
-typedef uint16_t storage_db_chunk_length_t;
+typedef uint32_t storage_db_chunk_length_t;
 typedef uint32_t storage_db_chunk_offset_t;
 typedef uint32_t storage_db_shard_index_t;
 typedef uint64_t storage_db_create_time_ms_t;
@@ -38,7 +53,8 @@ enum storage_db_entry_index_value_type {
     STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING = 2,
     STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_LIST = 3,
     STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_HASHSET = 4,
-    STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET = 5
+    STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SORTEDSET = 5,
+    STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_SET = 6
 };
 typedef enum storage_db_entry_index_value_type storage_db_entry_index_value_type_t;
 
@@ -48,6 +64,7 @@ typedef struct storage_db_config storage_db_config_t;
 struct storage_db_config {
     storage_db_backend_type_t backend_type;
     hashtable_bucket_count_t max_keys;
+    bool track_keys_slots;
     union {
         struct {
             char *basedir_path;
@@ -70,10 +87,12 @@ struct storage_db_shard {
 typedef struct storage_db_worker storage_db_worker_t;
 struct storage_db_worker {
     storage_db_shard_t *active_shard;
-    ring_bounded_queue_spsc_voidptr_t *deleted_entry_index_ring_buffer;
     double_linked_list_t *deleting_entry_index_list;
 };
 
+typedef struct storage_db_snapshot_entry storage_db_snapshot_entry_t;
+typedef struct storage_db_keys_slot storage_db_keys_slot_t;
+
 // contains the necessary information to manage the db, holds a pointer to storage_db_config required during the
 // the initialization
 typedef struct storage_db storage_db_t;
@@ -87,6 +106,20 @@ struct storage_db {
     hashtable_t *hashtable;
     storage_db_config_t *config;
     storage_db_worker_t *workers;
+    // Allocated only if track_keys_slots is set, holds the keys stored in each slot
+    storage_db_keys_slot_t *keys_slots;
+    // Only one snapshot at a time can be taken, see storage_db_snapshot_begin
+    struct {
+        spinlock_lock_volatile_t spinlock;
+        storage_db_snapshot_entry_t *preserved_entries;
+        uint32_t preserved_entries_count;
+        uint32_t preserved_entries_size;
+        uint32_volatile_t preserving;
+        uint8_volatile_t generation;
+        bool_volatile_t running;
+        bool iter_completed;
+        hashtable_bucket_index_t bucket_index;
+    } snapshot;
 };
 
 typedef struct storage_db_chunk_info storage_db_chunk_info_t;
@@ -98,6 +131,9 @@ struct storage_db_chunk_info {
         } file;
         struct {
             void *chunk_data;
+            // Allocated only when the chunk data is shared between chunk sequences (e.g. two versions of the same
+            // list), it counts the chunks pointing to the data which is freed when the last one goes away
+            uint32_volatile_t *chunk_data_shared_counter;
         } memory;
     };
     storage_db_chunk_length_t chunk_length;
@@ -115,14 +151,26 @@ union storage_db_entry_index_status {
 typedef struct storage_db_chunk_sequence storage_db_chunk_sequence_t;
 struct storage_db_chunk_sequence {
     storage_db_chunk_index_t count;
+    // The sequence has been allocated as the embedded value of an entry index, see
+    // storage_db_chunk_sequence_allocate_entry_index_value
+    bool entry_index_value;
     storage_db_chunk_info_t *sequence;
     size_t size;
 };
 
+static inline __attribute__((always_inline)) bool storage_db_chunk_info_is_embedded(
+        storage_db_chunk_info_t *chunk_info) {
+    // The data of an embedded chunk follow right after the chunk info, as the data are owned by the allocation of the
+    // sequence a chunk info copied elsewhere is never considered embedded
+    return chunk_info->memory.chunk_data == (void*)(chunk_info + 1);
+}
+
 typedef struct storage_db_entry_index storage_db_entry_index_t;
 struct storage_db_entry_index {
     storage_db_entry_index_status_t status;
     storage_db_entry_index_value_type_t value_type:8;
+    // The generation of the last snapshot that has visited the entry, see storage_db_snapshot_begin
+    uint8_volatile_t snapshot_generation;
     storage_db_create_time_ms_t created_time_ms;
     storage_db_expiry_time_ms_t expiry_time_ms;
     storage_db_last_access_time_ms_t last_access_time_ms;
@@ -130,6 +178,20 @@ struct storage_db_entry_index {
     storage_db_chunk_sequence_t *value;
 };
 
+// With the memory backend the values up to STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE are stored right after the entry index,
+// together with their chunk sequence and chunk info, so reading a small value touches only the entry index allocation
+typedef struct storage_db_entry_index_embedded_value storage_db_entry_index_embedded_value_t;
+struct storage_db_entry_index_embedded_value {
+    storage_db_chunk_sequence_t chunk_sequence;
+    // The data follow the chunk info, as for the embedded chunks, so storage_db_chunk_info_is_embedded holds
+    storage_db_chunk_info_t chunk_info;
+};
+
+static inline __attribute__((always_inline)) bool storage_db_entry_index_has_embedded_value(
+        storage_db_entry_index_t *entry_index) {
+    return entry_index->value == &((storage_db_entry_index_embedded_value_t*)(entry_index + 1))->chunk_sequence;
+}
+
 typedef struct storage_db_op_rmw_transaction storage_db_op_rmw_status_t;
 struct storage_db_op_rmw_transaction {
     hashtable_mcmp_op_rmw_status_t hashtable;
@@ -138,12 +200,27 @@ struct storage_db_op_rmw_transaction {
     bool delete_entry_index_on_abort;
 };
 
+// An entry of a snapshot, the entry index is pinned and the key is owned by the snapshot entry, both are released via
+// storage_db_snapshot_entry_release
+struct storage_db_snapshot_entry {
+    char *key;
+    size_t key_length;
+    storage_db_entry_index_t *entry_index;
+};
+
 typedef struct storage_db_key_and_key_length storage_db_key_and_key_length_t;
 struct storage_db_key_and_key_length {
     char *key;
     size_t key_size;
 };
 
+typedef struct storage_db_key_version storage_db_key_version_t;
+struct storage_db_key_version {
+    hashtable_chunk_index_t chunk_index;
+    uint8_t changes_counter;
+    storage_db_entry_index_t *entry_index;
+};
+
 char *storage_db_shard_build_path(
         char *basedir_path,
         storage_db_shard_index_t shard_index);
@@ -186,9 +263,6 @@ void storage_db_free(
 storage_db_shard_t *storage_db_worker_active_shard(
         storage_db_t *db);
 
-ring_bounded_queue_spsc_voidptr_t *storage_db_worker_deleted_entry_index_ring_buffer(
-        storage_db_t *db);
-
 void storage_db_worker_garbage_collect_deleting_entry_index_when_no_readers(
         storage_db_t *db);
 
@@ -208,6 +282,11 @@ void storage_db_chunk_data_free(
         storage_db_t *db,
         storage_db_chunk_info_t *chunk_info);
 
+bool storage_db_chunk_data_share(
+        storage_db_t *db,
+        storage_db_chunk_info_t *chunk_info_source,
+        storage_db_chunk_info_t *chunk_info_destination);
+
 storage_db_entry_index_t *storage_db_entry_index_new();
 
 void storage_db_entry_index_chunks_free(
@@ -221,10 +300,12 @@ void storage_db_entry_index_free(
 void storage_db_entry_index_touch(
         storage_db_entry_index_t *entry_index);
 
-storage_db_entry_index_t *storage_db_entry_index_ring_buffer_new(
+void storage_db_epoch_gc_register_object_types_destructor_cb(
         storage_db_t *db);
 
-void storage_db_entry_index_ring_buffer_free(
+void storage_db_epoch_gc_unregister_object_types_destructor_cb();
+
+void storage_db_entry_index_stage_free(
         storage_db_t *db,
         storage_db_entry_index_t *entry_index);
 
@@ -262,6 +343,17 @@ storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate(
         storage_db_t *db,
         size_t size);
 
+storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate_entry_index_value(
+        storage_db_t *db,
+        size_t size);
+
+storage_db_chunk_sequence_t *storage_db_chunk_sequence_allocate_like(
+        storage_db_t *db,
+        storage_db_chunk_sequence_t *chunk_sequence_source);
+
+storage_db_chunk_sequence_t *storage_db_chunk_sequence_new(
+        storage_db_chunk_index_t chunks_count);
+
 storage_db_chunk_info_t *storage_db_chunk_sequence_get(
         storage_db_chunk_sequence_t *chunk_sequence,
         storage_db_chunk_index_t chunk_index);
@@ -279,6 +371,9 @@ void storage_db_entry_index_status_increase_readers_counter(
         storage_db_entry_index_t* entry_index,
         storage_db_entry_index_status_t *old_status);
 
+bool storage_db_entry_index_status_try_increase_readers_counter(
+        storage_db_entry_index_t* entry_index);
+
 void storage_db_entry_index_status_decrease_readers_counter(
         storage_db_entry_index_t* entry_index,
         storage_db_entry_index_status_t *old_status);
@@ -293,6 +388,17 @@ storage_db_entry_index_t *storage_db_get_entry_index(
         char *key,
         size_t key_length);
 
+void storage_db_entry_index_prefetch(
+        storage_db_t *db,
+        char *key,
+        size_t key_length);
+
+void storage_db_op_get_multi(
+        storage_db_t *db,
+        storage_db_key_and_key_length_t *keys,
+        uint32_t keys_count,
+        storage_db_entry_index_t **entry_indexes);
+
 bool storage_db_entry_index_is_expired(
         storage_db_entry_index_t *entry_index);
 
@@ -310,6 +416,14 @@ storage_db_entry_index_t *storage_db_get_entry_index_for_read(
         char *key,
         size_t key_length);
 
+bool storage_db_can_read_unpinned(
+        storage_db_t *db);
+
+storage_db_entry_index_t *storage_db_get_entry_index_for_read_unpinned(
+        storage_db_t *db,
+        char *key,
+        size_t key_length);
+
 bool storage_db_set_entry_index(
         storage_db_t *db,
         char *key,
@@ -324,6 +438,44 @@ bool storage_db_op_set(
         storage_db_chunk_sequence_t *value_chunk_sequence,
         storage_db_expiry_time_ms_t expiry_time_ms);
 
+storage_db_entry_index_t *storage_db_op_set_entry_index_new(
+        storage_db_t *db,
+        char *key,
+        size_t key_length,
+        storage_db_entry_index_value_type_t value_type,
+        storage_db_chunk_sequence_t *value_chunk_sequence,
+        storage_db_expiry_time_ms_t expiry_time_ms);
+
+bool storage_db_op_set_multi(
+        storage_db_t *db,
+        storage_db_key_and_key_length_t *keys,
+        storage_db_chunk_sequence_t **values_chunk_sequences,
+        uint32_t keys_count,
+        storage_db_entry_index_value_type_t value_type,
+        storage_db_expiry_time_ms_t expiry_time_ms,
+        uint32_t *keys_set_count);
+
+bool storage_db_op_lock_keys(
+        storage_db_t *db,
+        transaction_t *transaction,
+        storage_db_key_and_key_length_t *keys,
+        uint32_t keys_count);
+
+void storage_db_op_get_key_version(
+        storage_db_t *db,
+        char *key,
+        size_t key_length,
+        storage_db_key_version_t *key_version);
+
+static inline __attribute__((always_inline)) bool storage_db_key_version_equals(
+        storage_db_key_version_t *key_version_a,
+        storage_db_key_version_t *key_version_b) {
+    return
+            key_version_a->chunk_index == key_version_b->chunk_index &&
+            key_version_a->changes_counter == key_version_b->changes_counter &&
+            key_version_a->entry_index == key_version_b->entry_index;
+}
+
 bool storage_db_op_rmw_begin(
         storage_db_t *db,
         transaction_t *transaction,
@@ -385,10 +537,37 @@ storage_db_key_and_key_length_t *storage_db_op_get_keys(
         uint64_t *keys_count,
         uint64_t *cursor_next);
 
+uint16_t storage_db_key_slot(
+        char *key,
+        size_t key_length);
+
+uint32_t storage_db_op_count_keys_in_slot(
+        storage_db_t *db,
+        uint16_t slot);
+
+storage_db_key_and_key_length_t *storage_db_op_get_keys_in_slot(
+        storage_db_t *db,
+        uint16_t slot,
+        uint64_t count,
+        uint64_t *keys_count);
+
 void storage_db_free_key_and_key_length_list(
         storage_db_key_and_key_length_t *keys,
         uint64_t keys_count);
 
+void storage_db_snapshot_begin(
+        storage_db_t *db);
+
+bool storage_db_snapshot_next(
+        storage_db_t *db,
+        storage_db_snapshot_entry_t *snapshot_entry);
+
+void storage_db_snapshot_entry_release(
+        storage_db_snapshot_entry_t *snapshot_entry);
+
+void storage_db_snapshot_end(
+        storage_db_t *db);
+
 #ifdef __cplusplus
 }
 #endif
@@ -180,6 +180,25 @@ bool io_uring_support_sqe_enqueue_link_timeout(
     return true;
 }
 
+bool io_uring_support_sqe_enqueue_cancel(
+        io_uring_t *ring,
+        uint64_t user_data_to_cancel,
+        uint8_t sqe_flags,
+        uint64_t user_data) {
+    io_uring_sqe_t *sqe = io_uring_support_get_sqe(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+
+    // The operation to cancel is identified by its user_data, the canceled operation will complete with -ECANCELED
+    io_uring_prep_rw(IORING_OP_ASYNC_CANCEL, sqe, -1, NULL, 0, 0);
+    sqe->addr = user_data_to_cancel;
+    io_uring_sqe_set_flags(sqe, sqe_flags);
+    sqe->user_data = user_data;
+
+    return true;
+}
+
 bool io_uring_support_sqe_enqueue_nop(
         io_uring_t *ring,
         uint8_t sqe_flags,
@@ -235,6 +254,25 @@ bool io_uring_support_sqe_enqueue_accept(
     return true;
 }
 
+bool io_uring_support_sqe_enqueue_connect(
+        io_uring_t *ring,
+        int fd,
+        struct sockaddr *socket_address,
+        socklen_t socket_address_size,
+        uint8_t sqe_flags,
+        uint64_t user_data) {
+    io_uring_sqe_t *sqe = io_uring_support_get_sqe(ring);
+    if (sqe == NULL) {
+        return false;
+    }
+
+    io_uring_prep_connect(sqe, fd, socket_address, socket_address_size);
+    io_uring_sqe_set_flags(sqe, sqe_flags);
+    sqe->user_data = user_data;
+
+    return true;
+}
+
 bool io_uring_support_sqe_enqueue_recv(
         io_uring_t *ring,
         int fd,
@@ -59,6 +59,12 @@ bool io_uring_support_sqe_enqueue_link_timeout(
         uint8_t sqe_flags,
         uint64_t user_data);
 
+bool io_uring_support_sqe_enqueue_cancel(
+        io_uring_t *ring,
+        uint64_t user_data_to_cancel,
+        uint8_t sqe_flags,
+        uint64_t user_data);
+
 bool io_uring_support_sqe_enqueue_nop(
         io_uring_t *ring,
         uint8_t sqe_flags,
@@ -73,6 +79,14 @@ bool io_uring_support_sqe_enqueue_accept(
         uint8_t sqe_flags,
         uint64_t user_data);
 
+bool io_uring_support_sqe_enqueue_connect(
+        io_uring_t *ring,
+        int fd,
+        struct sockaddr *socket_address,
+        socklen_t socket_address_size,
+        uint8_t sqe_flags,
+        uint64_t user_data);
+
 bool io_uring_support_sqe_enqueue_recv(
         io_uring_t *ring,
         int fd,
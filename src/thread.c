@@ -49,18 +49,21 @@ long thread_current_get_id() {
     return syscall(SYS_gettid);
 }
 
+uint32_t thread_get_logical_core_index(
+        uint32_t thread_index) {
+    if (internal_selected_cpus == NULL) {
+        return thread_index % utils_cpu_count();
+    }
+
+    return internal_selected_cpus[thread_index % internal_selected_cpus_count];
+}
+
 uint32_t thread_current_set_affinity(
         uint32_t thread_index) {
     int res;
     cpu_set_t cpuset;
     pthread_t thread;
-    uint32_t logical_core_index;
-
-    if (internal_selected_cpus == NULL) {
-        logical_core_index = thread_index % utils_cpu_count();
-    } else {
-        logical_core_index = internal_selected_cpus[thread_index % internal_selected_cpus_count];
-    }
+    uint32_t logical_core_index = thread_get_logical_core_index(thread_index);
 
     CPU_ZERO(&cpuset);
     CPU_SET(logical_core_index, &cpuset);
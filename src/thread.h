@@ -9,6 +9,9 @@ void thread_flush_cached_core_index_and_numa_node_index();
 
 long thread_current_get_id();
 
+uint32_t thread_get_logical_core_index(
+        uint32_t thread_index);
+
 uint32_t thread_current_set_affinity(
         uint32_t thread_index);
 
@@ -16,6 +16,7 @@
 #include "clock.h"
 #include "config.h"
 #include "fiber/fiber.h"
+#include "fiber/fiber_scheduler.h"
 #include "worker/worker_stats.h"
 #include "worker/worker_context.h"
 #include "worker/worker.h"
@@ -31,6 +32,7 @@
 
 thread_local uint32_t transaction_manager_worker_index = 0;
 thread_local uint16_t transaction_manager_transaction_index = 0;
+thread_local transaction_t *transaction_manager_parent_transaction = NULL;
 pthread_once_t transaction_manager_init_once_control = PTHREAD_ONCE_INIT;
 
 void transaction_set_worker_index(
@@ -61,19 +63,45 @@ uint16_t transaction_peek_current_thread_index() {
     return transaction_manager_transaction_index;
 }
 
+static inline __attribute__((always_inline)) transaction_t **transaction_manager_parent_transaction_slot() {
+    // The fibers can yield while the parent transaction is set, if it were per thread the transactions acquired by the
+    // other fibers in the meantime would become children of it, outside of a fiber the execution can't be switched
+    if (fiber_scheduler_can_yield()) {
+        return &fiber_scheduler_get_current()->parent_transaction;
+    }
+
+    return &transaction_manager_parent_transaction;
+}
+
+void transaction_set_parent_transaction(
+        transaction_t *transaction) {
+    *transaction_manager_parent_transaction_slot() = transaction;
+}
+
+transaction_t *transaction_get_parent_transaction() {
+    return *transaction_manager_parent_transaction_slot();
+}
+
 bool transaction_acquire(
         transaction_t *transaction) {
     pthread_once(&transaction_manager_init_once_control, transaction_manager_init);
 
-    transaction_manager_transaction_index++;
-
-    if (unlikely(transaction_manager_worker_index == 0 &&
-        transaction_manager_transaction_index == TRANSACTION_ID_NOT_ACQUIRED)) {
+    // The transactions acquired while a parent transaction is set share its id so they can operate on the locks already
+    // owned by the parent, the locks acquired on top of these are still tracked and released by the child transaction
+    transaction_t *parent_transaction = transaction_get_parent_transaction();
+    if (unlikely(parent_transaction != NULL)) {
+        transaction->transaction_id.id = parent_transaction->transaction_id.id;
+    } else {
         transaction_manager_transaction_index++;
-    }
 
-    transaction->transaction_id.worker_index = transaction_manager_worker_index;
-    transaction->transaction_id.transaction_index = transaction_manager_transaction_index;
+        if (unlikely(transaction_manager_worker_index == 0 &&
+            transaction_manager_transaction_index == TRANSACTION_ID_NOT_ACQUIRED)) {
+            transaction_manager_transaction_index++;
+        }
+
+        transaction->transaction_id.worker_index = transaction_manager_worker_index;
+        transaction->transaction_id.transaction_index = transaction_manager_transaction_index;
+    }
 
     transaction->locks.count = 0;
     transaction->locks.size = 8;
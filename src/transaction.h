@@ -37,6 +37,11 @@ bool transaction_expand_locks_list(
 
 uint16_t transaction_peek_current_thread_index();
 
+void transaction_set_parent_transaction(
+        transaction_t *transaction);
+
+transaction_t *transaction_get_parent_transaction();
+
 bool transaction_acquire(
         transaction_t* transaction);
 
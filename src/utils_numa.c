@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <numa.h>
+#include <numaif.h>
 #include <sched.h>
 
 #include "misc.h"
@@ -84,3 +85,36 @@ uint32_t utils_numa_cpu_current_index() {
 
     return cpu_index;
 }
+
+uint32_t utils_numa_node_index_by_cpu(
+        uint32_t cpu_index) {
+    int numa_node_index = -1;
+
+    if (utils_numa_is_available()) {
+#if defined(__linux__)
+        numa_node_index = numa_node_of_cpu((int)cpu_index);
+#else
+#error Platform not supported
+#endif
+    }
+
+    return numa_node_index < 0 ? 0 : numa_node_index;
+}
+
+uint32_t utils_numa_node_index_by_memptr(
+        void *memptr) {
+    int numa_node_index = -1;
+
+    // The memory has to be already faulted in, if it's not the kernel reports the numa node of the current cpu
+    if (utils_numa_is_available()) {
+#if defined(__linux__)
+        if (get_mempolicy(&numa_node_index, NULL, 0, memptr, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+            numa_node_index = -1;
+        }
+#else
+#error Platform not supported
+#endif
+    }
+
+    return numa_node_index < 0 ? 0 : numa_node_index;
+}
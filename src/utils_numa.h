@@ -18,6 +18,12 @@ bool utils_numa_cpu_allowed(
 
 uint32_t utils_numa_cpu_current_index();
 
+uint32_t utils_numa_node_index_by_cpu(
+        uint32_t cpu_index);
+
+uint32_t utils_numa_node_index_by_memptr(
+        void *memptr);
+
 #ifdef __cplusplus
 }
 #endif
@@ -290,6 +290,103 @@ network_channel_t* worker_network_iouring_op_network_accept(
     return new_channel;
 }
 
+network_channel_t* worker_network_iouring_op_network_connect(
+        struct sockaddr *address,
+        socklen_t address_size,
+        config_module_t *module_config) {
+    network_io_common_fd_t fd;
+    worker_iouring_context_t *context = worker_iouring_context_get();
+
+    fiber_scheduler_reset_error();
+
+    if (address->sa_family == AF_INET6) {
+        fd = network_io_common_socket_tcp6_new(0);
+    } else {
+        fd = network_io_common_socket_tcp4_new(0);
+    }
+
+    if (unlikely(fd < 0)) {
+        fiber_scheduler_set_error(errno);
+        return NULL;
+    }
+
+    network_channel_iouring_t *new_channel = network_channel_iouring_new(NETWORK_CHANNEL_TYPE_CLIENT);
+    new_channel->fd = new_channel->wrapped_channel.fd = fd;
+    new_channel->wrapped_channel.protocol = module_config->type;
+    new_channel->wrapped_channel.module_config = module_config;
+    memcpy(&new_channel->wrapped_channel.address.socket.base, address, address_size);
+    new_channel->wrapped_channel.address.size = address_size;
+
+    network_io_common_socket_address_str(
+            &new_channel->wrapped_channel.address.socket.base,
+            new_channel->wrapped_channel.address.str,
+            sizeof(new_channel->wrapped_channel.address.str));
+
+    // The fd is not mapped yet so the connect can't use the registered files
+    if (unlikely(!io_uring_support_sqe_enqueue_connect(
+            context->ring,
+            fd,
+            &new_channel->wrapped_channel.address.socket.base,
+            new_channel->wrapped_channel.address.size,
+            0,
+            (uintptr_t) fiber_scheduler_get_current()))) {
+        fiber_scheduler_set_error(ENOMEM);
+        worker_network_iouring_op_network_close((network_channel_t *)new_channel, true);
+        return NULL;
+    }
+
+    // Switch the execution back to the scheduler
+    fiber_scheduler_switch_back();
+
+    // When the fiber continues the execution, it has to fetch the return value
+    io_uring_cqe_t *cqe = (io_uring_cqe_t*)((fiber_scheduler_get_current())->ret.ptr_value);
+
+    if (unlikely(worker_iouring_cqe_is_error_any(cqe))) {
+        fiber_scheduler_set_error(-cqe->res);
+        LOG_V(
+                TAG,
+                "Unable to connect to <%s>",
+                new_channel->wrapped_channel.address.str);
+
+        worker_network_iouring_op_network_close((network_channel_t *)new_channel, true);
+        return NULL;
+    }
+
+    if (unlikely(network_channel_client_setup(fd, context->core_index) == false)) {
+        fiber_scheduler_set_error(errno);
+        LOG_E(
+                TAG,
+                "Unable to setup the connection to <%s>",
+                new_channel->wrapped_channel.address.str);
+
+        worker_network_iouring_op_network_close((network_channel_t *)new_channel, true);
+        return NULL;
+    }
+
+    if (unlikely(!worker_iouring_fds_map_add_and_enqueue_files_update(
+            context->ring,
+            new_channel->fd,
+            &new_channel->has_mapped_fd,
+            &new_channel->base_sqe_flags,
+            &new_channel->wrapped_channel.fd))) {
+        LOG_E(
+                TAG,
+                "Unable to setup the connection to <%s>, unable to find a free fds slot",
+                new_channel->wrapped_channel.address.str);
+
+        worker_network_iouring_op_network_close((network_channel_t *)new_channel, true);
+        return NULL;
+    }
+
+    new_channel->wrapped_channel.status = NETWORK_CHANNEL_STATUS_CONNECTED;
+    new_channel->wrapped_channel.timeout.read.sec = -1;
+    new_channel->wrapped_channel.timeout.read.nsec = -1;
+    new_channel->wrapped_channel.timeout.write.sec = -1;
+    new_channel->wrapped_channel.timeout.write.nsec = -1;
+
+    return (network_channel_t*)new_channel;
+}
+
 bool worker_network_iouring_op_network_close(
         network_channel_t *channel,
         bool shutdown_may_fail) {
@@ -374,6 +471,25 @@ int32_t worker_network_iouring_op_network_receive(
     return res;
 }
 
+bool worker_network_iouring_op_network_receive_cancel(
+        network_channel_t *channel) {
+    worker_iouring_context_t *context = worker_iouring_context_get();
+
+    // The receive operation is identified by the fiber waiting for it, the cancel operation doesn't have a fiber to
+    // resume so the user_data is set to 0 to get the cqe skipped.
+    if (unlikely(!io_uring_support_sqe_enqueue_cancel(
+            context->ring,
+            (uintptr_t)channel->receive.fiber,
+            0,
+            0))) {
+        return false;
+    }
+
+    // The cancel is submitted right away, if it would be submitted together with the other sqes the fiber might have
+    // been resumed in the meantime and the cancel might hit a different operation issued by the same fiber
+    return io_uring_support_sqe_submit(context->ring);
+}
+
 int32_t worker_network_iouring_op_network_send(
         network_channel_t *channel,
         char* buffer,
@@ -494,7 +610,9 @@ bool worker_network_iouring_op_register() {
     worker_op_network_channel_size = worker_network_iouring_op_network_channel_size;
     worker_op_network_channel_free = worker_network_iouring_network_channel_free;
     worker_op_network_accept = worker_network_iouring_op_network_accept;
+    worker_op_network_connect = worker_network_iouring_op_network_connect;
     worker_op_network_receive = worker_network_iouring_op_network_receive;
+    worker_op_network_receive_cancel = worker_network_iouring_op_network_receive_cancel;
     worker_op_network_send = worker_network_iouring_op_network_send;
     worker_op_network_close = worker_network_iouring_op_network_close;
 
@@ -17,6 +17,11 @@ network_channel_t* worker_network_iouring_op_network_accept_setup_new_channel(
 network_channel_t* worker_network_iouring_op_network_accept(
         network_channel_t *listener_channel);
 
+network_channel_t* worker_network_iouring_op_network_connect(
+        struct sockaddr *address,
+        socklen_t address_size,
+        config_module_t *module_config);
+
 bool worker_network_iouring_op_network_close(
         network_channel_t *channel,
         bool shutdown_may_fail);
@@ -26,6 +31,9 @@ int32_t worker_network_iouring_op_network_receive(
         char* buffer,
         size_t buffer_length);
 
+bool worker_network_iouring_op_network_receive_cancel(
+        network_channel_t *channel);
+
 int32_t worker_network_iouring_op_network_send(
         network_channel_t *channel,
         char* buffer,
@@ -23,6 +23,8 @@
 #include <mbedtls/ssl_internal.h>
 
 #include "misc.h"
+#include "thread.h"
+#include "utils_numa.h"
 #include "exttypes.h"
 #include "clock.h"
 #include "spinlock.h"
@@ -57,6 +59,10 @@
 #include "protocol/redis/protocol_redis.h"
 #include "protocol/redis/protocol_redis_reader.h"
 #include "module/redis/module_redis.h"
+#include "module/redis/module_redis_pubsub.h"
+#include "module/redis/module_redis_script.h"
+#include "module/redis/module_redis_replication.h"
+#include "module/redis/module_redis_aof.h"
 #include "module/prometheus/module_prometheus.h"
 
 #include "worker_network_op.h"
@@ -70,7 +76,9 @@ worker_op_network_channel_multi_get_fp_t* worker_op_network_channel_multi_get;
 worker_op_network_channel_size_fp_t* worker_op_network_channel_size;
 worker_op_network_channel_free_fp_t* worker_op_network_channel_free;
 worker_op_network_accept_fp_t* worker_op_network_accept;
+worker_op_network_connect_fp_t* worker_op_network_connect;
 worker_op_network_receive_fp_t* worker_op_network_receive;
+worker_op_network_receive_cancel_fp_t* worker_op_network_receive_cancel;
 worker_op_network_send_fp_t* worker_op_network_send;
 worker_op_network_close_fp_t* worker_op_network_close;
 
@@ -117,6 +125,9 @@ worker_module_context_t *worker_module_contexts_initialize(
         worker_module_context[module_index].network_tls_config = network_tls_config;
     }
 
+    // The append only file, if enabled, has to be loaded before the listeners start to accept connections
+    module_redis_aof_worker_initialize(config);
+
     result_ret = true;
 end:
 
@@ -139,6 +150,13 @@ end:
 void worker_module_context_free(
         config_t *config,
         worker_module_context_t *worker_module_context) {
+    // The pub/sub, the scripting and the replication state of the worker are allocated only if a client has subscribed
+    // to a channel or a pattern, has run a script or has executed a write command
+    module_redis_pubsub_worker_cleanup();
+    module_redis_script_worker_cleanup();
+    module_redis_replication_worker_cleanup();
+    module_redis_aof_worker_cleanup();
+
     for (int module_index = 0; module_index < config->modules_count; module_index++) {
         if (worker_module_context[module_index].network_tls_config == NULL) {
             continue;
@@ -149,20 +167,101 @@ void worker_module_context_free(
     ffma_mem_free(worker_module_context);
 }
 
+/**
+ * Maps the cpus handling the incoming connections to the workers that will accept them, the reuse port group of a
+ * listener contains the sockets in the same order as the workers, so the index of the worker is also the index of the
+ * socket.
+ * A cpu is mapped to the worker pinned on it, if there isn't any it's mapped, in round robin, to the workers running
+ * on the same numa node, so the connections received by a nic are accepted by workers local to it, and only if there
+ * are no workers on that numa node to all the workers.
+ */
+static uint32_t *worker_network_listeners_cpus_to_worker_index_map_new(
+        uint32_t workers_count,
+        uint32_t *cpus_count) {
+    uint32_t round_robin_counter = 0;
+    uint32_t numa_node_count = utils_numa_node_configured_count();
+    uint32_t *numa_nodes_round_robin_counters = ffma_mem_alloc_zero(sizeof(uint32_t) * numa_node_count);
+
+    *cpus_count = utils_numa_cpu_configured_count();
+    uint32_t *cpus_to_worker_index_map = ffma_mem_alloc(sizeof(uint32_t) * *cpus_count);
+
+    for(uint32_t cpu_index = 0; cpu_index < *cpus_count; cpu_index++) {
+        bool found = false;
+        uint32_t numa_node_workers_count = 0;
+        uint32_t numa_node_index = utils_numa_node_index_by_cpu(cpu_index);
+
+        if (numa_node_index >= numa_node_count) {
+            numa_node_index = 0;
+        }
+
+        for(uint32_t worker_index = 0; worker_index < workers_count; worker_index++) {
+            uint32_t worker_cpu_index = thread_get_logical_core_index(worker_index);
+            if (worker_cpu_index == cpu_index) {
+                cpus_to_worker_index_map[cpu_index] = worker_index;
+                found = true;
+                break;
+            }
+
+            if (utils_numa_node_index_by_cpu(worker_cpu_index) == numa_node_index) {
+                numa_node_workers_count++;
+            }
+        }
+
+        if (found) {
+            continue;
+        }
+
+        if (numa_node_workers_count == 0) {
+            cpus_to_worker_index_map[cpu_index] = round_robin_counter++ % workers_count;
+            continue;
+        }
+
+        // Picks the nth worker running on the numa node
+        uint32_t numa_node_worker_nth =
+                numa_nodes_round_robin_counters[numa_node_index]++ % numa_node_workers_count;
+        for(uint32_t worker_index = 0; worker_index < workers_count; worker_index++) {
+            if (utils_numa_node_index_by_cpu(thread_get_logical_core_index(worker_index)) != numa_node_index) {
+                continue;
+            }
+
+            if (numa_node_worker_nth == 0) {
+                cpus_to_worker_index_map[cpu_index] = worker_index;
+                break;
+            }
+
+            numa_node_worker_nth--;
+        }
+    }
+
+    ffma_mem_free(numa_nodes_round_robin_counters);
+
+    return cpus_to_worker_index_map;
+}
+
 // TODO: the listener and accept operations should be refactored to split them in an user frontend operation and in an
 //       internal operation like for all the other ops (recv, send, close, etc.)
 bool worker_network_listeners_initialize(
         uint32_t worker_index,
+        uint32_t workers_count,
         uint8_t core_index,
         config_t *config,
         worker_module_context_t *worker_module_context,
         network_channel_t **listeners,
         uint8_t *listeners_count) {
     bool return_res = false;
+    uint32_t cpus_count = 0;
+    uint32_t *cpus_to_worker_index_map = NULL;
     network_channel_listener_new_callback_user_data_t listener_new_cb_user_data = { 0 };
 
     listener_new_cb_user_data.core_index = core_index;
 
+    // The cBPF program for reuse port is attached only once, the worker with index 0 will always be initialized
+    if (worker_index == 0) {
+        cpus_to_worker_index_map = worker_network_listeners_cpus_to_worker_index_map_new(
+                workers_count,
+                &cpus_count);
+    }
+
     // With listeners = NULL, the number of needed listeners will be enumerated and listeners_count
     // increased as needed
     listener_new_cb_user_data.listeners = NULL;
@@ -249,9 +348,13 @@ bool worker_network_listeners_initialize(
 
                 // Attach the cBPF program for reuse port only once, the worker with index 0 will always be initialized
                 if (worker_index == 0) {
-                    if (!network_io_common_socket_attach_reuseport_cbpf(channel_listener->fd)) {
+                    if (!network_io_common_socket_attach_reuseport_cbpf(
+                            channel_listener->fd,
+                            cpus_to_worker_index_map,
+                            cpus_count)) {
                         LOG_E(TAG, "Failed to attach the reuse port cbpf program to the listener");
-                        return false;
+                        return_res = false;
+                        goto end;
                     }
                 }
             }
@@ -261,6 +364,10 @@ bool worker_network_listeners_initialize(
     return_res = true;
 
 end:
+    if (cpus_to_worker_index_map) {
+        ffma_mem_free(cpus_to_worker_index_map);
+    }
+
     *listeners = listener_new_cb_user_data.listeners;
     *listeners_count = listener_new_cb_user_data.listeners_count;
 
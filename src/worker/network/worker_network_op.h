@@ -27,6 +27,11 @@ typedef void (worker_op_network_channel_free_fp_t)(
 typedef network_channel_t* (worker_op_network_accept_fp_t)(
         network_channel_t *listener_channel);
 
+typedef network_channel_t* (worker_op_network_connect_fp_t)(
+        struct sockaddr *address,
+        socklen_t address_size,
+        config_module_t *module_config);
+
 typedef bool (worker_op_network_close_fp_t)(
         network_channel_t *channel,
         bool shutdown_may_fail);
@@ -36,6 +41,9 @@ typedef int32_t (worker_op_network_receive_fp_t)(
         char* buffer,
         size_t buffer_length);
 
+typedef bool (worker_op_network_receive_cancel_fp_t)(
+        network_channel_t *channel);
+
 typedef int32_t (worker_op_network_send_fp_t)(
         network_channel_t *channel,
         char* buffer,
@@ -52,6 +60,7 @@ void worker_module_context_free(
 
 bool worker_network_listeners_initialize(
         uint32_t worker_index,
+        uint32_t workers_count,
         uint8_t core_index,
         config_t *config,
         worker_module_context_t *worker_module_context,
@@ -72,7 +81,9 @@ extern worker_op_network_channel_multi_new_fp_t* worker_op_network_channel_multi
 extern worker_op_network_channel_multi_get_fp_t* worker_op_network_channel_multi_get;
 extern worker_op_network_channel_free_fp_t* worker_op_network_channel_free;
 extern worker_op_network_accept_fp_t* worker_op_network_accept;
+extern worker_op_network_connect_fp_t* worker_op_network_connect;
 extern worker_op_network_receive_fp_t* worker_op_network_receive;
+extern worker_op_network_receive_cancel_fp_t* worker_op_network_receive_cancel;
 extern worker_op_network_send_fp_t* worker_op_network_send;
 extern worker_op_network_close_fp_t* worker_op_network_close;
 extern worker_op_network_channel_size_fp_t* worker_op_network_channel_size;
@@ -45,7 +45,10 @@
 #include "support/io_uring/io_uring_capabilities.h"
 #include "data_structures/hashtable/mcmp/hashtable.h"
 #include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
 #include "support/simple_file_io.h"
 #include "module/module.h"
 #include "network/io/network_io_common.h"
@@ -99,12 +102,14 @@ void worker_setup_context(
         uint32_t worker_index,
         bool_volatile_t *terminate_event_loop,
         config_t *config,
-        storage_db_t *db) {
+        storage_db_t *db,
+        epoch_gc_worker_context_t *epoch_gc_workers_context) {
     worker_context->workers_count = workers_count;
     worker_context->worker_index = worker_index;
     worker_context->terminate_event_loop = terminate_event_loop;
     worker_context->config = config;
     worker_context->db = db;
+    worker_context->epoch_gc_workers_context = epoch_gc_workers_context;
     worker_context->aborted = false;
     worker_context->running = false;
 
@@ -178,7 +183,9 @@ bool worker_initialize_storage(
         worker_context_t* worker_context) {
     // TODO: the workers should be map the their func ops in a struct and these should be used
     //       below, can't keep doing ifs :/
-    if (worker_context->config->database->backend == CONFIG_DATABASE_BACKEND_FILE) {
+    // The storage operations are also used to write the append only file
+    if (worker_context->config->database->backend == CONFIG_DATABASE_BACKEND_FILE ||
+        worker_context->config->database->aof != NULL) {
         if (!worker_storage_iouring_initialize(worker_context)) {
             LOG_E(TAG, "io_uring worker storage initialization failed, terminating");
             worker_iouring_cleanup(worker_context);
@@ -221,7 +228,8 @@ void worker_cleanup_network(
 void worker_cleanup_storage(
         worker_context_t* worker_context) {
     // TODO: should use a struct with fp pointers, not ifs
-    if (worker_context->config->database->backend == CONFIG_DATABASE_BACKEND_FILE) {
+    if (worker_context->config->database->backend == CONFIG_DATABASE_BACKEND_FILE ||
+        worker_context->config->database->aof != NULL) {
         worker_storage_iouring_cleanup(worker_context); // lgtm [cpp/useless-expression]
     }
 
@@ -292,6 +300,69 @@ void worker_set_aborted(
     MEMORY_FENCE_STORE();
 }
 
+void worker_epoch_gc_threads_initialize(
+        worker_context_t *worker_context) {
+    // The epoch gc workers are not available when the worker is started on its own (e.g. in the tests), in this case
+    // the deleted entry indexes are freed immediately
+    if (worker_context->epoch_gc_workers_context == NULL) {
+        return;
+    }
+
+    for(
+            epoch_gc_object_type_t object_type = EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+            object_type <= EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
+            object_type++) {
+        epoch_gc_thread_t *epoch_gc_thread = epoch_gc_thread_init();
+        epoch_gc_thread_advance_epoch_tsc(epoch_gc_thread);
+
+        epoch_gc_thread_register_global(
+                worker_context->epoch_gc_workers_context[object_type].epoch_gc,
+                epoch_gc_thread);
+        epoch_gc_thread_register_local(epoch_gc_thread);
+    }
+}
+
+void worker_epoch_gc_threads_advance_epoch() {
+    epoch_gc_t *epoch_gc;
+    epoch_gc_thread_t *epoch_gc_thread;
+
+    // The loop iterations are the quiescent points of the worker, a pointer fetched from the hashtable without
+    // increasing the readers counter is never kept across them, therefore once all the workers have advanced their
+    // epoch the entry indexes staged before can be freed
+    for(
+            epoch_gc_object_type_t object_type = EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+            object_type <= EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
+            object_type++) {
+        if (unlikely(!epoch_gc_thread_is_registered_local(object_type))) {
+            return;
+        }
+
+        epoch_gc_thread_get_instance(object_type, &epoch_gc, &epoch_gc_thread);
+        epoch_gc_thread_advance_epoch_tsc(epoch_gc_thread);
+    }
+}
+
+void worker_epoch_gc_threads_cleanup() {
+    epoch_gc_t *epoch_gc;
+    epoch_gc_thread_t *epoch_gc_thread;
+
+    for(
+            epoch_gc_object_type_t object_type = EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+            object_type <= EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
+            object_type++) {
+        if (!epoch_gc_thread_is_registered_local(object_type)) {
+            continue;
+        }
+
+        // Once marked as terminated the epoch gc thread is collected and freed by the epoch gc worker, it has to be
+        // unregistered locally before
+        epoch_gc_thread_get_instance(object_type, &epoch_gc, &epoch_gc_thread);
+        epoch_gc_thread_advance_epoch_tsc(epoch_gc_thread);
+        epoch_gc_thread_unregister_local(epoch_gc_thread);
+        epoch_gc_thread_terminate(epoch_gc_thread);
+    }
+}
+
 void worker_initialize_storage_db_fiber_entrypoint(
         void* user_data) {
     worker_context_t *worker_context = worker_context_get();
@@ -335,6 +406,8 @@ void worker_cleanup(
     worker_cleanup_storage(worker_context);
     worker_cleanup_general(worker_context);
     fiber_scheduler_free();
+    fiber_stack_pool_free();
+    worker_epoch_gc_threads_cleanup();
 
     xalloc_free(log_producer_early_prefix_thread);
 
@@ -392,6 +465,8 @@ void* worker_thread_func(
         goto end;
     }
 
+    worker_epoch_gc_threads_initialize(worker_context);
+
     if ((worker_module_contexts = worker_module_contexts_initialize(
             worker_context->config)) == NULL) {
         LOG_E(TAG, "Unable to initialize the listeners, can't continue!");
@@ -400,6 +475,7 @@ void* worker_thread_func(
 
     if (!worker_network_listeners_initialize(
             worker_context->worker_index,
+            worker_context->workers_count,
             worker_context->core_index,
             worker_context->config,
             worker_module_contexts,
@@ -435,6 +511,8 @@ void* worker_thread_func(
     //       a maximum timeout or X seconds and an error message should be reported pointing out what a fiber is doing
     //       and where.
     do {
+        worker_epoch_gc_threads_advance_epoch();
+
         if (worker_context->config->network->backend == CONFIG_NETWORK_BACKEND_IO_URING ||
             worker_context->config->database->backend == CONFIG_DATABASE_BACKEND_FILE) {
             res = worker_iouring_process_events_loop(worker_context);
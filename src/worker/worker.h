@@ -17,7 +17,8 @@ void worker_setup_context(
         uint32_t worker_index,
         volatile bool *terminate_event_loop,
         config_t *config,
-        storage_db_t *db);
+        storage_db_t *db,
+        epoch_gc_worker_context_t *epoch_gc_workers_context);
 
 bool worker_should_terminate(
         worker_context_t *worker_context);
@@ -39,6 +40,13 @@ void worker_set_aborted(
         worker_context_t *worker_context,
         bool aborted);
 
+void worker_epoch_gc_threads_initialize(
+        worker_context_t *worker_context);
+
+void worker_epoch_gc_threads_advance_epoch();
+
+void worker_epoch_gc_threads_cleanup();
+
 void* worker_thread_func(
         void* user_data);
 
@@ -9,6 +9,7 @@ extern "C" {
 
 // Circular dependency between the storage_db and the worker_context
 typedef struct storage_db storage_db_t;
+typedef struct epoch_gc_worker_context epoch_gc_worker_context_t;
 
 typedef struct worker_context worker_context_t;
 struct worker_context {
@@ -21,6 +22,7 @@ struct worker_context {
     uint32_t core_index;
     config_t *config;
     storage_db_t *db;
+    epoch_gc_worker_context_t *epoch_gc_workers_context;
     struct {
         worker_stats_t internal;
         worker_stats_volatile_t shared;
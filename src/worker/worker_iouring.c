@@ -278,7 +278,12 @@ bool worker_iouring_process_events_loop(
 
     context = worker_iouring_context_get();
 
-    io_uring_support_sqe_submit_and_wait(context->ring, 1);
+    // If there are fibers ready to be resumed the loop can't wait for the events
+    if (unlikely(fiber_scheduler_has_ready_fibers())) {
+        io_uring_support_sqe_submit(context->ring);
+    } else {
+        io_uring_support_sqe_submit_and_wait(context->ring, 1);
+    }
 
     io_uring_for_each_cqe(context->ring, head, cqe) {
         count++;
@@ -308,6 +313,8 @@ bool worker_iouring_process_events_loop(
 
     io_uring_support_cq_advance(context->ring, count);
 
+    fiber_scheduler_resume_ready_fibers();
+
     return true;
 }
 
@@ -21,6 +21,8 @@
 #include "data_structures/hashtable/mcmp/hashtable.h"
 #include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
 #include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
 #include "config.h"
 #include "module/module.h"
 #include "network/io/network_io_common.h"
@@ -47,6 +49,14 @@ void worker_timer_fiber_entrypoint(
         if (worker_context->db) {
             storage_db_worker_garbage_collect_deleting_entry_index_when_no_readers(worker_context->db);
         }
+
+        // Pass the objects freed by this worker but owned by other workers to the owners, the batches would otherwise
+        // be held until full
+        ffma_thread_cache_different_thread_batches_flush();
+
+        // The pages of the pooled fiber stacks are released here and not when the fibers terminate, to keep the
+        // madvise off the accept and close path
+        fiber_stack_pool_release_pages();
     }
 }
 
@@ -29,6 +29,7 @@
 #include "data_structures/hashtable/mcmp/hashtable.h"
 #include "data_structures/hashtable/mcmp/hashtable_config.h"
 #include "data_structures/hashtable/mcmp/hashtable_support_index.h"
+#include "data_structures/hashtable/mcmp/hashtable_op_get.h"
 #include "data_structures/hashtable/mcmp/hashtable_op_set.h"
 
 #include "../../../support.h"
@@ -532,6 +533,86 @@ TEST_CASE("hashtable/hashtable_mcmp_op_set.c", "[hashtable][hashtable_op][hashta
             }
         }
 
+        SECTION("set 2 keys by hash in transaction - chunks locked upfront") {
+            HASHTABLE(0x7FFF, false, {
+                transaction_t transaction = { 0 };
+                hashtable_value_data_t value = 0;
+                hashtable_hash_t hashes[] = { test_key_2_hash, test_key_1_hash, test_key_2_hash };
+
+                hashtable_half_hashes_chunk_volatile_t *half_hashes_chunk_1 =
+                        &hashtable->ht_current->half_hashes_chunk[HASHTABLE_TO_CHUNK_INDEX(
+                                hashtable_mcmp_support_index_from_hash(
+                                        hashtable->ht_current->buckets_count,
+                                        test_key_1_hash))];
+                hashtable_half_hashes_chunk_volatile_t *half_hashes_chunk_2 =
+                        &hashtable->ht_current->half_hashes_chunk[HASHTABLE_TO_CHUNK_INDEX(
+                                hashtable_mcmp_support_index_from_hash(
+                                        hashtable->ht_current->buckets_count,
+                                        test_key_2_hash))];
+
+                char *test_key_1_alloc = (char*)xalloc_alloc(test_key_1_len + 1);
+                strncpy(test_key_1_alloc, test_key_1, test_key_1_len + 1);
+                char *test_key_2_alloc = (char*)xalloc_alloc(test_key_2_len + 1);
+                strncpy(test_key_2_alloc, test_key_2, test_key_2_len + 1);
+
+                transaction_acquire(&transaction);
+
+                REQUIRE(hashtable_mcmp_op_set_lock_chunks_by_hashes(
+                        hashtable,
+                        &transaction,
+                        hashes,
+                        sizeof(hashes) / sizeof(hashtable_hash_t)));
+
+                // The whole probe window of each key is locked, the overlapping chunks and the duplicated hash must
+                // not lock the chunks twice
+                hashtable_chunk_index_t chunk_index_distance = half_hashes_chunk_1 > half_hashes_chunk_2
+                        ? half_hashes_chunk_1 - half_hashes_chunk_2
+                        : half_hashes_chunk_2 - half_hashes_chunk_1;
+                REQUIRE(transaction.locks.count ==
+                    HASHTABLE_HALF_HASHES_CHUNK_SEARCH_MAX +
+                    MIN(chunk_index_distance, HASHTABLE_HALF_HASHES_CHUNK_SEARCH_MAX));
+                REQUIRE(transaction_spinlock_is_owned_by_transaction(&half_hashes_chunk_1->write_lock, &transaction));
+                REQUIRE(transaction_spinlock_is_owned_by_transaction(&half_hashes_chunk_2->write_lock, &transaction));
+                REQUIRE(transaction_spinlock_is_owned_by_transaction(
+                        &half_hashes_chunk_1[HASHTABLE_HALF_HASHES_CHUNK_SEARCH_MAX - 1].write_lock,
+                        &transaction));
+                REQUIRE(transaction_spinlock_is_owned_by_transaction(
+                        &half_hashes_chunk_2[HASHTABLE_HALF_HASHES_CHUNK_SEARCH_MAX - 1].write_lock,
+                        &transaction));
+
+                REQUIRE(hashtable_mcmp_op_set_by_hash_in_transaction(
+                        hashtable,
+                        &transaction,
+                        test_key_1_hash,
+                        test_key_1_alloc,
+                        test_key_1_len,
+                        test_value_1,
+                        nullptr));
+                REQUIRE(hashtable_mcmp_op_set_by_hash_in_transaction(
+                        hashtable,
+                        &transaction,
+                        test_key_2_hash,
+                        test_key_2_alloc,
+                        test_key_2_len,
+                        test_value_2,
+                        nullptr));
+
+                // The chunks have to be kept locked until the transaction is released
+                REQUIRE(transaction_spinlock_is_locked(&half_hashes_chunk_1->write_lock));
+                REQUIRE(transaction_spinlock_is_locked(&half_hashes_chunk_2->write_lock));
+
+                transaction_release(&transaction);
+
+                REQUIRE(!transaction_spinlock_is_locked(&half_hashes_chunk_1->write_lock));
+                REQUIRE(!transaction_spinlock_is_locked(&half_hashes_chunk_2->write_lock));
+
+                REQUIRE(hashtable_mcmp_op_get(hashtable, test_key_1, test_key_1_len, &value));
+                REQUIRE(value == test_value_1);
+                REQUIRE(hashtable_mcmp_op_get(hashtable, test_key_2, test_key_2_len, &value));
+                REQUIRE(value == test_value_2);
+            })
+        }
+
 //        SECTION("parallel inserts - check storage") {
 //            HASHTABLE(1000000, false, {
 //                for(uint32_t i = 0; i < HASHTABLE_MCMP_HALF_HASHES_CHUNK_SLOTS_COUNT; i++) {
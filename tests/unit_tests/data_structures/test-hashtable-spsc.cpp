@@ -809,4 +809,37 @@ TEST_CASE("data_structures/hashtable/spsc/hashtable_spsc.c", "[data_structures][
 
         hashtable_spsc_free(hashtable);
     }
+
+    SECTION("hashtable_spsc_upsize_cs") {
+        char *value1 = "first value";
+        hashtable_spsc_t *hashtable = hashtable_spsc_new(
+                1,
+                1,
+                false,
+                false);
+
+        SECTION("empty hashtable") {
+            hashtable_spsc_t *hashtable_new = hashtable_spsc_upsize_cs(hashtable);
+
+            REQUIRE(hashtable_new != NULL);
+            REQUIRE(hashtable_new->buckets_count == 2);
+            REQUIRE(hashtable_new->max_range == hashtable->max_range);
+            REQUIRE(hashtable_new->stop_on_not_set == hashtable->stop_on_not_set);
+
+            hashtable_spsc_free(hashtable_new);
+        }
+
+        SECTION("entries moved") {
+            REQUIRE(hashtable_spsc_op_try_set_cs(hashtable, key, key_length, value1));
+
+            hashtable_spsc_t *hashtable_new = hashtable_spsc_upsize_cs(hashtable);
+            REQUIRE(hashtable_new != NULL);
+            REQUIRE(hashtable_new->buckets_count > hashtable->buckets_count);
+            REQUIRE(hashtable_spsc_op_get_cs(hashtable_new, key, key_length) == value1);
+
+            hashtable_spsc_free(hashtable_new);
+        }
+
+        hashtable_spsc_free(hashtable);
+    }
 }
@@ -296,6 +296,54 @@ TEST_CASE("data_structures/queue_mpmc/queue_mpmc.c", "[data_structures][queue_mp
         queue_mpmc_free(queue_mpmc);
     }
 
+    SECTION("queue_mpmc_push_nodes") {
+        queue_mpmc_t *queue_mpmc = queue_mpmc_init();
+        queue_mpmc_node_t node1 = { .data = &test_queue_mpmc_value1, .next = nullptr };
+        queue_mpmc_node_t node2 = { .data = &test_queue_mpmc_value2, .next = &node1 };
+
+        SECTION("one node") {
+            queue_mpmc_push_nodes(queue_mpmc, &node1, &node1, 1);
+
+            REQUIRE(queue_mpmc->head.data.length == 1);
+            REQUIRE(queue_mpmc->head.data.version == 1);
+            REQUIRE(queue_mpmc->head.data.node == &node1);
+            REQUIRE(queue_mpmc->head.data.node->next == nullptr);
+        }
+
+        SECTION("two nodes") {
+            queue_mpmc_push_nodes(queue_mpmc, &node2, &node1, 2);
+
+            REQUIRE(queue_mpmc->head.data.length == 2);
+            REQUIRE(queue_mpmc->head.data.version == 1);
+            REQUIRE(queue_mpmc->head.data.node == &node2);
+            REQUIRE(queue_mpmc->head.data.node->next == &node1);
+            REQUIRE(queue_mpmc->head.data.node->next->next == nullptr);
+        }
+
+        SECTION("two nodes on top of a value") {
+            REQUIRE(queue_mpmc_push(queue_mpmc, &test_queue_mpmc_value1));
+            queue_mpmc_node_t *node_pushed = (queue_mpmc_node_t*)queue_mpmc->head.data.node;
+
+            queue_mpmc_push_nodes(queue_mpmc, &node2, &node1, 2);
+
+            REQUIRE(queue_mpmc->head.data.length == 3);
+            REQUIRE(queue_mpmc->head.data.version == 2);
+            REQUIRE(queue_mpmc->head.data.node == &node2);
+            REQUIRE(node1.next == node_pushed);
+
+            // Restore the pushed node as the head to free it via queue_mpmc_free
+            node1.next = nullptr;
+            queue_mpmc->head.data.node = node_pushed;
+        }
+
+        // The nodes are owned by the test and can't be freed by queue_mpmc_free
+        if (queue_mpmc->head.data.node == &node1 || queue_mpmc->head.data.node == &node2) {
+            queue_mpmc->head.data.node = nullptr;
+        }
+
+        queue_mpmc_free(queue_mpmc);
+    }
+
     SECTION("queue_mpmc_pop") {
         queue_mpmc_t *queue_mpmc = queue_mpmc_init();
 
@@ -334,6 +382,53 @@ TEST_CASE("data_structures/queue_mpmc/queue_mpmc.c", "[data_structures][queue_mp
         queue_mpmc_free(queue_mpmc);
     }
 
+    SECTION("queue_mpmc_pop_all") {
+        queue_mpmc_t *queue_mpmc = queue_mpmc_init();
+
+        SECTION("no values") {
+            queue_mpmc_node_t *nodes = queue_mpmc_pop_all(queue_mpmc);
+
+            REQUIRE(queue_mpmc->head.data.length == 0);
+            REQUIRE(queue_mpmc->head.data.version == 0);
+            REQUIRE(queue_mpmc->head.data.node == NULL);
+            REQUIRE(nodes == NULL);
+        }
+
+        SECTION("one value") {
+            queue_mpmc_push(queue_mpmc, &test_queue_mpmc_value1);
+            queue_mpmc_node_t *nodes = queue_mpmc_pop_all(queue_mpmc);
+
+            REQUIRE(queue_mpmc->head.data.length == 0);
+            REQUIRE(queue_mpmc->head.data.version == 2);
+            REQUIRE(queue_mpmc->head.data.node == NULL);
+            REQUIRE(nodes != NULL);
+            REQUIRE(nodes->data == &test_queue_mpmc_value1);
+            REQUIRE(nodes->next == NULL);
+
+            queue_mpmc_node_free(nodes);
+        }
+
+        SECTION("two values") {
+            queue_mpmc_push(queue_mpmc, &test_queue_mpmc_value1);
+            queue_mpmc_push(queue_mpmc, &test_queue_mpmc_value2);
+            queue_mpmc_node_t *nodes = queue_mpmc_pop_all(queue_mpmc);
+
+            REQUIRE(queue_mpmc->head.data.length == 0);
+            REQUIRE(queue_mpmc->head.data.version == 3);
+            REQUIRE(queue_mpmc->head.data.node == NULL);
+            REQUIRE(nodes != NULL);
+            REQUIRE(nodes->data == &test_queue_mpmc_value1);
+            REQUIRE(nodes->next != NULL);
+            REQUIRE(nodes->next->data == &test_queue_mpmc_value2);
+            REQUIRE(nodes->next->next == NULL);
+
+            queue_mpmc_node_free(nodes->next);
+            queue_mpmc_node_free(nodes);
+        }
+
+        queue_mpmc_free(queue_mpmc);
+    }
+
     SECTION("queue_mpmc_peek") {
         queue_mpmc_t *queue_mpmc = queue_mpmc_init();
 
@@ -0,0 +1,27 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include "misc.h"
+#include "hash/hash_crc16.h"
+
+TEST_CASE("hash/hash_crc16.c", "[hash][hash_crc16]") {
+    SECTION("check value") {
+        REQUIRE(hash_crc16("123456789", 9) == 0x31C3);
+    }
+
+    SECTION("empty data") {
+        REQUIRE(hash_crc16("", 0) == 0);
+    }
+
+    SECTION("redis cluster hash slots") {
+        REQUIRE((hash_crc16("foo", 3) & 16383) == 12182);
+        REQUIRE((hash_crc16("bar", 3) & 16383) == 5061);
+    }
+}
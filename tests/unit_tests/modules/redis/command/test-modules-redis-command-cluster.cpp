@@ -0,0 +1,194 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "memory_allocator/ffma.h"
+#include "network/channel/network_channel.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_cluster.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - CLUSTER", "[redis][command][CLUSTER]") {
+    SECTION("Cluster disabled") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"CLUSTER", "MYID"},
+                "-ERR This instance has cluster support disabled\r\n"));
+    }
+
+    SECTION("Cluster enabled") {
+        config_module_redis_cluster_t config_module_redis_cluster = {
+                .announce_address = "127.0.0.1",
+                .announce_port = 6379,
+        };
+
+        // The registry is global, it's initialized again for each test
+        module_redis_cluster_registry.initialized = false;
+        module_redis_cluster_registry.nodes_count = 0;
+        config_module_redis.cluster = &config_module_redis_cluster;
+
+        SECTION("Unknown subcommand") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLUSTER", "UNKNOWN"},
+                    "-ERR unknown subcommand 'UNKNOWN'. Try CLUSTER HELP.\r\n"));
+        }
+
+        SECTION("KEYSLOT") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLUSTER", "KEYSLOT", "foo"},
+                    ":12182\r\n"));
+
+            SECTION("Hash tag") {
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"CLUSTER", "KEYSLOT", "{foo}x"},
+                        ":12182\r\n"));
+
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"CLUSTER", "KEYSLOT", "a{b}{c}"},
+                        ":3300\r\n"));
+            }
+
+            SECTION("Empty hash tag") {
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"CLUSTER", "KEYSLOT", "foo{}"},
+                        ":5542\r\n"));
+            }
+        }
+
+        SECTION("ADDSLOTS") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLUSTER", "ADDSLOTS", "12182"},
+                    "+OK\r\n"));
+
+            SECTION("Slot already busy") {
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"CLUSTER", "ADDSLOTS", "12182"},
+                        "-ERR Slot 12182 is already busy\r\n"));
+            }
+
+            SECTION("Invalid slot") {
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"CLUSTER", "ADDSLOTS", "16384"},
+                        "-ERR Invalid or out of range slot\r\n"));
+            }
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLUSTER", "DELSLOTS", "12182"},
+                    "+OK\r\n"));
+        }
+
+        SECTION("Slot served") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"CLUSTER", "ADDSLOTS", "12182"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "foo", "value"},
+                    "+OK\r\n"));
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "{foo}x"},
+                    "$-1\r\n"));
+
+            SECTION("Slot being migrated") {
+                uint16_t node_index = module_redis_cluster_node_meet("127.0.0.2", 7000);
+                module_redis_cluster_slot_set_migrating(12182, node_index);
+
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"GET", "foo"},
+                        "$5\r\nvalue\r\n"));
+
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"GET", "{foo}x"},
+                        "-ASK 12182 127.0.0.2:7000\r\n"));
+
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"MGET", "foo", "{foo}x"},
+                        "-TRYAGAIN Multiple keys request during rehashing of slot\r\n"));
+            }
+        }
+
+        SECTION("Slot not served") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "bar"},
+                    "-CLUSTERDOWN Hash slot not served\r\n"));
+        }
+
+        SECTION("Slot served by another node") {
+            uint16_t node_index = module_redis_cluster_node_meet("127.0.0.2", 7000);
+            module_redis_cluster_slot_set_node(5061, node_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "bar"},
+                    "-MOVED 5061 127.0.0.2:7000\r\n"));
+
+            SECTION("Slot being imported") {
+                module_redis_cluster_slot_set_importing(5061, node_index);
+
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"ASKING"},
+                        "+OK\r\n"));
+
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"GET", "bar"},
+                        "$-1\r\n"));
+
+                // ASKING is valid only for the next command
+                REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                        std::vector<std::string>{"GET", "bar"},
+                        "-MOVED 5061 127.0.0.2:7000\r\n"));
+            }
+
+            module_redis_cluster_slot_set_node(5061, MODULE_REDIS_CLUSTER_NODE_NONE);
+        }
+
+        SECTION("Keys in different slots") {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"MGET", "foo", "bar"},
+                    "-CROSSSLOT Keys in request don't hash to the same slot\r\n"));
+        }
+    }
+}
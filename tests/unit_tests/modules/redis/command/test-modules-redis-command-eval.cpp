@@ -0,0 +1,234 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - EVAL", "[redis][command][EVAL]") {
+    SECTION("Return integer") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return 1", "0"},
+                ":1\r\n"));
+    }
+
+    SECTION("Return string") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return 'hello'", "0"},
+                "$5\r\nhello\r\n"));
+    }
+
+    SECTION("Return nil") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return nil", "0"},
+                "$-1\r\n"));
+    }
+
+    SECTION("Return KEYS and ARGV") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return {KEYS[1], KEYS[2], ARGV[1]}", "2", "a_key", "b_key", "c_arg"},
+                "*3\r\n$5\r\na_key\r\n$5\r\nb_key\r\n$5\r\nc_arg\r\n"));
+    }
+
+    SECTION("Return status and error replies") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return redis.status_reply('DONE')", "0"},
+                "+DONE\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return redis.error_reply('ERR failed')", "0"},
+                "-ERR failed\r\n"));
+    }
+
+    SECTION("Call SET and GET") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{
+                    "EVAL",
+                    "redis.call('SET', KEYS[1], ARGV[1]); return redis.call('GET', KEYS[1])",
+                    "1",
+                    "a_key",
+                    "b_value"},
+                "$7\r\nb_value\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "$7\r\nb_value\r\n"));
+    }
+
+    SECTION("Call returning a status") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return redis.call('SET', KEYS[1], 'b_value')", "1", "a_key"},
+                "+OK\r\n"));
+    }
+
+    SECTION("Call INCR") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{
+                    "EVAL",
+                    "redis.call('INCR', KEYS[1]); return redis.call('INCRBY', KEYS[1], 10)",
+                    "1",
+                    "a_key"},
+                ":11\r\n"));
+    }
+
+    SECTION("Call missing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return redis.call('GET', KEYS[1]) == false", "1", "a_key"},
+                ":1\r\n"));
+    }
+
+    SECTION("Call with error") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return redis.call('INCR', KEYS[1])", "1", "a_key"},
+                "-ERR value is not an integer or out of range\r\n"));
+    }
+
+    SECTION("PCall with error") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{
+                    "EVAL",
+                    "local reply = redis.pcall('INCR', KEYS[1]); return reply['err'] ~= nil",
+                    "1",
+                    "a_key"},
+                ":1\r\n"));
+    }
+
+    SECTION("Call unknown command") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return redis.call('UNKNOWN')", "0"},
+                "-ERR Unknown Redis command called from script\r\n"));
+    }
+
+    SECTION("Call not allowed command") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return redis.call('MULTI')", "0"},
+                "-ERR This Redis command is not allowed from script\r\n"));
+    }
+
+    SECTION("Filesystem access not allowed") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return io == nil and os == nil and loadfile == nil", "0"},
+                ":1\r\n"));
+    }
+
+    SECTION("Negative number of keys") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return 1", "-1"},
+                "-ERR Number of keys can't be negative\r\n"));
+    }
+
+    SECTION("Too many keys") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return 1", "2", "a_key"},
+                "-ERR Number of keys can't be greater than number of args\r\n"));
+    }
+
+    SECTION("Compilation error") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EVAL", "return (", "0"},
+                "-ERR Error compiling script (new function): user_script:1: unexpected symbol near '<eof>'\r\n"));
+    }
+
+    SECTION("Other clients not blocked while the reply is sent") {
+        char buffer[256] = { 0 };
+        char *get_command = "*2\r\n$3\r\nGET\r\n$5\r\na_key\r\n";
+        char *incr_command = "*2\r\n$4\r\nINCR\r\n$5\r\na_key\r\n";
+        char *expected_header = "$8388608\r\n";
+        size_t reply_length = strlen(expected_header) + 8388608 + 2;
+        size_t reply_received_length = 0;
+        struct timeval timeout = { .tv_sec = 5, .tv_usec = 0 };
+
+        // The reply is bigger than the socket buffers and the client doesn't read it until the other connection has
+        // accessed the key, if the reply were sent while the script still holds the locks the other connection would
+        // wait forever
+        buffer_send_data_len = build_resp_command(
+                buffer_send,
+                sizeof(buffer_send),
+                std::vector<std::string>{
+                        "EVAL",
+                        "redis.call('SET', KEYS[1], '10'); return string.rep('a', 8388608)",
+                        "1",
+                        "a_key"});
+        REQUIRE(send(client_fd, buffer_send, buffer_send_data_len, 0) == buffer_send_data_len);
+
+        int other_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(setsockopt(other_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0);
+        REQUIRE(connect(other_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+
+        // The script may have not been executed yet, wait for the SET to be visible
+        do {
+            REQUIRE(send(other_fd, get_command, strlen(get_command), 0) == strlen(get_command));
+            REQUIRE(recv(other_fd, buffer, sizeof(buffer), 0) > 0);
+        } while (strncmp(buffer, "$2\r\n10\r\n", strlen("$2\r\n10\r\n")) != 0);
+
+        REQUIRE(send(other_fd, incr_command, strlen(incr_command), 0) == strlen(incr_command));
+        REQUIRE(recv(other_fd, buffer, sizeof(buffer), 0) == strlen(":11\r\n"));
+        REQUIRE(strncmp(buffer, ":11\r\n", strlen(":11\r\n")) == 0);
+
+        close(other_fd);
+
+        char *reply = (char*)malloc(reply_length);
+        while(reply_received_length < reply_length) {
+            ssize_t received_length = recv(
+                    client_fd,
+                    reply + reply_received_length,
+                    reply_length - reply_received_length,
+                    0);
+            REQUIRE(received_length > 0);
+            reply_received_length += received_length;
+        }
+
+        REQUIRE(strncmp(reply, expected_header, strlen(expected_header)) == 0);
+        REQUIRE(reply[strlen(expected_header)] == 'a');
+        REQUIRE(strncmp(reply + reply_length - 2, "\r\n", 2) == 0);
+
+        free(reply);
+    }
+}
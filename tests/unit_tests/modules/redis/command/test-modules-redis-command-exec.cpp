@@ -0,0 +1,204 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - EXEC", "[redis][command][EXEC]") {
+    SECTION("Without MULTI") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXEC"},
+                "-ERR EXEC without MULTI\r\n"));
+    }
+
+    SECTION("No commands") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MULTI"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXEC"},
+                "*0\r\n"));
+    }
+
+    SECTION("Multiple commands") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MULTI"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"INCR", "b_key"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"INCRBY", "b_key", "10"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXEC"},
+                "*4\r\n+OK\r\n:1\r\n:11\r\n$7\r\nb_value\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "b_key"},
+                "$2\r\n11\r\n"));
+    }
+
+    SECTION("Multiple keys per command") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MULTI"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MSET", "a_key", "b_value", "b_key", "value_z"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"DEL", "a_key"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MGET", "a_key", "b_key"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXEC"},
+                "*3\r\n+OK\r\n:1\r\n*2\r\n$-1\r\n$7\r\nvalue_z\r\n"));
+    }
+
+    SECTION("Error in a command") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MULTI"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"INCR", "a_key"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "b_key", "value_z"},
+                "+QUEUED\r\n"));
+
+        // The errors are reported as replies and don't stop the execution of the other commands
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXEC"},
+                "*2\r\n-ERR value is not an integer or out of range\r\n+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "b_key"},
+                "$7\r\nvalue_z\r\n"));
+    }
+
+    SECTION("Executed atomically") {
+        char buffer[256] = { 0 };
+        char *incr_command = "*2\r\n$4\r\nINCR\r\n$5\r\na_key\r\n";
+
+        // Another connection increments the same key while the transaction is queued, the increment is either
+        // applied before or after the transaction
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MULTI"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"INCR", "a_key"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"INCR", "a_key"},
+                "+QUEUED\r\n"));
+
+        int other_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(connect(other_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+
+        REQUIRE(send(other_fd, incr_command, strlen(incr_command), 0) == strlen(incr_command));
+        REQUIRE(recv(other_fd, buffer, sizeof(buffer), 0) == strlen(":1\r\n"));
+        REQUIRE(strncmp(buffer, ":1\r\n", strlen(":1\r\n")) == 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXEC"},
+                "*2\r\n:2\r\n:3\r\n"));
+
+        close(other_fd);
+    }
+
+    SECTION("RESP3 - Watched key changed") {
+        // Switch to RESP3, the response of HELLO isn't relevant for this test
+        snprintf(buffer_send, sizeof(buffer_send) - 1, "*2\r\n$5\r\nHELLO\r\n$1\r\n3\r\n");
+        buffer_send_data_len = strlen(buffer_send);
+
+        REQUIRE(send(client_fd, buffer_send, buffer_send_data_len, 0) == buffer_send_data_len);
+        REQUIRE(recv(client_fd, buffer_recv, sizeof(buffer_recv), 0) > 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"WATCH", "a_key"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MULTI"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "value_z"},
+                "+QUEUED\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXEC"},
+                "_\r\n"));
+    }
+}
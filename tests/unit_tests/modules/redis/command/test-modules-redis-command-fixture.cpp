@@ -54,8 +54,7 @@
 #pragma GCC diagnostic ignored "-Wwrite-strings"
 
 TestModulesRedisCommandFixture::TestModulesRedisCommandFixture() {
-    terminate_event_loop = false;
-    char* cpus[] = { "0" };
+    static char* cpus[] = { "0" };
 
     config_module_network_binding = {
             .host = "127.0.0.1",
@@ -108,6 +107,16 @@ TestModulesRedisCommandFixture::TestModulesRedisCommandFixture() {
 
     workers_count = config.cpus_count * config.workers_per_cpus;
 
+    program_start();
+};
+
+TestModulesRedisCommandFixture::~TestModulesRedisCommandFixture() {
+    program_stop();
+}
+
+void TestModulesRedisCommandFixture::program_start() {
+    terminate_event_loop = false;
+
     db_config = storage_db_config_new();
     db_config->backend_type = STORAGE_DB_BACKEND_TYPE_MEMORY;
     db_config->max_keys = 1000;
@@ -137,9 +146,9 @@ TestModulesRedisCommandFixture::TestModulesRedisCommandFixture() {
     address.sin_addr.s_addr = inet_addr(config_module_network_binding.host);
 
     REQUIRE(connect(client_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
-};
+}
 
-TestModulesRedisCommandFixture::~TestModulesRedisCommandFixture() {
+void TestModulesRedisCommandFixture::program_stop() {
     close(client_fd);
 
     terminate_event_loop = true;
@@ -37,6 +37,12 @@ protected:
 
     program_context_t *program_context;
 
+    // The program is started by the constructor and stopped by the destructor, a test can stop it and start it
+    // again, e.g. to change the configuration
+    void program_start();
+
+    void program_stop();
+
     static size_t build_resp_command(
             char *buffer,
             size_t buffer_size,
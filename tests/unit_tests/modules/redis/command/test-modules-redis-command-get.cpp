@@ -87,6 +87,58 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - GET", "[redi
         REQUIRE(strncmp(buffer_recv, buffer_recv_expected_start, strlen(buffer_recv_expected_start)) == 0);
     }
 
+    SECTION("Existing and non-existing keys - pipelining") {
+        char buffer_recv_expected[1024] = { 0 };
+        char *buffer_send_start = buffer_send;
+        char *buffer_recv_expected_start = buffer_recv_expected;
+
+        for(int index = 0; index < 32; index += 2) {
+            char key[16] = { 0 };
+            char value[16] = { 0 };
+            snprintf(key, sizeof(key), "a_key_%02d", index);
+            snprintf(value, sizeof(value), "b_value_%02d", index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", key, value},
+                    "+OK\r\n"));
+        }
+
+        // The keys are requested in reverse order and half of them don't exist, the responses have to be sent in the
+        // same order of the commands
+        for(int index = 31; index >= 0; index--) {
+            buffer_send_start += snprintf(
+                    buffer_send_start,
+                    sizeof(buffer_send) - (buffer_send_start - buffer_send) - 1,
+                    "*2\r\n$3\r\nGET\r\n$8\r\na_key_%02d\r\n",
+                    index);
+
+            if (index % 2 == 0) {
+                buffer_recv_expected_start += snprintf(
+                        buffer_recv_expected_start,
+                        sizeof(buffer_recv_expected) - (buffer_recv_expected_start - buffer_recv_expected) - 1,
+                        "$10\r\nb_value_%02d\r\n",
+                        index);
+            } else {
+                buffer_recv_expected_start += snprintf(
+                        buffer_recv_expected_start,
+                        sizeof(buffer_recv_expected) - (buffer_recv_expected_start - buffer_recv_expected) - 1,
+                        "$-1\r\n");
+            }
+        }
+        buffer_send_data_len = strlen(buffer_send);
+        size_t buffer_recv_expected_len = strlen(buffer_recv_expected);
+
+        REQUIRE(send(client_fd, buffer_send, buffer_send_data_len, 0) == buffer_send_data_len);
+
+        size_t recv_len = 0;
+        do {
+            recv_len += recv(client_fd, buffer_recv + recv_len, sizeof(buffer_recv) - recv_len, 0);
+        } while(recv_len < buffer_recv_expected_len);
+
+        REQUIRE(recv_len == buffer_recv_expected_len);
+        REQUIRE(strncmp(buffer_recv, buffer_recv_expected, buffer_recv_expected_len) == 0);
+    }
+
     SECTION("Non-existing key") {
         REQUIRE(send_recv_resp_command_text_and_validate_recv(
                 std::vector<std::string>{"GET", "a_key"},
@@ -131,6 +183,11 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - GET", "[redi
                 std::vector<std::string>{"SET", "a_key", long_value},
                 "+OK\r\n"));
 
+        // With the memory backend the value is stored in a single chunk
+        storage_db_entry_index_t *entry_index = storage_db_get_entry_index(db, "a_key", strlen("a_key"));
+        REQUIRE(entry_index->value->count == 1);
+        REQUIRE(entry_index->value->sequence[0].chunk_length == long_value_length);
+
         REQUIRE(send_recv_resp_command_multi_recv_and_validate_recv(
                 std::vector<std::string>{"GET", "a_key"},
                 expected_response,
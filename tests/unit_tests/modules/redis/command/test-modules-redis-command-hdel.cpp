@@ -0,0 +1,128 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HDEL", "[redis][command][HDEL]") {
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key", "a_field"},
+                ":0\r\n"));
+    }
+
+    SECTION("Existing and non-existent fields") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value", "b_field", "value_z"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key", "a_field", "c_field", "a_field"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$-1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "b_field"},
+                "$7\r\nvalue_z\r\n"));
+    }
+
+    SECTION("Delete all the fields") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value", "b_field", "value_z"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key", "a_field", "b_field"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Delete from multiple nodes") {
+        // The nodes left empty are dropped, the others are rewritten without the deleted fields
+        int field_count = 2048;
+
+        for(int field_index = 0; field_index < field_count; field_index++) {
+            char buffer1[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "a_field_%05d", field_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", buffer1, "b_value"},
+                    ":1\r\n"));
+        }
+
+        for(int field_index = 0; field_index < field_count; field_index += 2) {
+            char buffer1[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "a_field_%05d", field_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HDEL", "a_key", buffer1},
+                    ":1\r\n"));
+        }
+
+        for(int field_index = 0; field_index < field_count; field_index++) {
+            char buffer1[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "a_field_%05d", field_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HGET", "a_key", buffer1},
+                    field_index % 2 == 0 ? "$-1\r\n" : "$7\r\nb_value\r\n"));
+        }
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key", "a_field"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing parameters - field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HDEL", "a_key"},
+                "-ERR wrong number of arguments for 'hdel' command\r\n"));
+    }
+}
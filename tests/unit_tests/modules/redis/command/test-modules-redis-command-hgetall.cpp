@@ -0,0 +1,92 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HGETALL", "[redis][command][HGETALL]") {
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGETALL", "a_key"},
+                "*0\r\n"));
+    }
+
+    SECTION("Existing key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value", "b_field", "value_z"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGETALL", "a_key"},
+                "*4\r\n$7\r\na_field\r\n$7\r\nb_value\r\n$7\r\nb_field\r\n$7\r\nvalue_z\r\n"));
+    }
+
+    SECTION("Existing key - RESP3") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value"},
+                ":1\r\n"));
+
+        // Switch to RESP3, the response of HELLO isn't relevant for this test
+        snprintf(buffer_send, sizeof(buffer_send) - 1, "*2\r\n$5\r\nHELLO\r\n$1\r\n3\r\n");
+        buffer_send_data_len = strlen(buffer_send);
+
+        REQUIRE(send(client_fd, buffer_send, buffer_send_data_len, 0) == buffer_send_data_len);
+        REQUIRE(recv(client_fd, buffer_recv, sizeof(buffer_recv), 0) > 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGETALL", "a_key"},
+                "%1\r\n$7\r\na_field\r\n$7\r\nb_value\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGETALL", "a_key"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing parameters - key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGETALL"},
+                "-ERR wrong number of arguments for 'hgetall' command\r\n"));
+    }
+}
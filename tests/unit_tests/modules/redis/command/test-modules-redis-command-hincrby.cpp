@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HINCRBY", "[redis][command][HINCRBY]") {
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "a_field", "5"},
+                ":5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$1\r\n5\r\n"));
+    }
+
+    SECTION("Existing field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "10", "b_field", "b_value"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "a_field", "-15"},
+                ":-5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$2\r\n-5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "b_field"},
+                "$7\r\nb_value\r\n"));
+    }
+
+    SECTION("Value not an integer") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "a_field", "1"},
+                "-ERR hash value is not an integer\r\n"));
+    }
+
+    SECTION("Overflow") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "9223372036854775807"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "a_field", "1"},
+                "-ERR increment or decrement would overflow\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "1"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "a_field", "1"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing parameters - increment") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HINCRBY", "a_key", "a_field"},
+                "-ERR wrong number of arguments for 'hincrby' command\r\n"));
+    }
+}
@@ -0,0 +1,199 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - HSET", "[redis][command][HSET]") {
+    SECTION("New key - 1 field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$7\r\nb_value\r\n"));
+    }
+
+    SECTION("New key - 2 fields") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value", "b_field", "value_z"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$7\r\nb_value\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "b_field"},
+                "$7\r\nvalue_z\r\n"));
+    }
+
+    SECTION("New key - 2 fields - same field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value", "a_field", "value_z"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$7\r\nvalue_z\r\n"));
+    }
+
+    SECTION("Existing key - overwrite field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "value_z", "b_field", "b_value"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$7\r\nvalue_z\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "b_field"},
+                "$7\r\nb_value\r\n"));
+    }
+
+    SECTION("Long value") {
+        std::string long_value(4096, 'a');
+        std::string expected_response =
+                "$" + std::to_string(long_value.length()) + "\r\n" + long_value + "\r\n";
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value", "b_field", long_value},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "b_field"},
+                (char*)expected_response.c_str()));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$7\r\nb_value\r\n"));
+    }
+
+    SECTION("Split in multiple nodes") {
+        // The fields are spread over multiple nodes, every update rewrites only the node containing the field
+        int field_count = 2048;
+
+        for(int field_index = 0; field_index < field_count; field_index++) {
+            char buffer1[32] = { 0 };
+            char buffer2[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "a_field_%05d", field_index);
+            snprintf(buffer2, sizeof(buffer2), "b_value_%05d", field_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", buffer1, buffer2},
+                    ":1\r\n"));
+        }
+
+        for(int field_index = 0; field_index < field_count; field_index++) {
+            char buffer1[32] = { 0 };
+            char expected_response[64] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "a_field_%05d", field_index);
+            snprintf(expected_response, sizeof(expected_response), "$13\r\nb_value_%05d\r\n", field_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HGET", "a_key", buffer1},
+                    expected_response));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field_not_existing"},
+                "$-1\r\n"));
+    }
+
+    SECTION("Hash bigger than a chunk") {
+        // The serialized hash spans over multiple chunks and is bigger than the biggest object ffma can allocate
+        int field_count = 4096;
+
+        for(int field_index = 0; field_index < field_count; field_index++) {
+            char buffer1[32] = { 0 };
+            char buffer2[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "a_field_%05d", field_index);
+            snprintf(buffer2, sizeof(buffer2), "b_value_%05d", field_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"HSET", "a_key", buffer1, buffer2},
+                    ":1\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field_03000"},
+                "$13\r\nb_value_03000\r\n"));
+    }
+
+    SECTION("Field and value too large") {
+        // Every field and value has to fit in a chunk
+        std::string long_value(64 * 1024, 'a');
+        config_module_redis.max_command_length = long_value.length() + 1024;
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", long_value},
+                "-ERR field and value too large\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HGET", "a_key", "a_field"},
+                "$-1\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field", "b_value"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing parameters - field") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key"},
+                "-ERR wrong number of arguments for 'hset' command\r\n"));
+    }
+
+    SECTION("Missing parameters - value") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"HSET", "a_key", "a_field"},
+                "-ERR wrong number of arguments for 'hset' command\r\n"));
+    }
+}
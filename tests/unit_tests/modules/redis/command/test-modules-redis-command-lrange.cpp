@@ -0,0 +1,126 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - LRANGE", "[redis][command][LRANGE]") {
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                "*0\r\n"));
+    }
+
+    SECTION("Positive and negative indexes") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b", "c", "d", "e"},
+                ":5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "1", "2"},
+                "*2\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "-2", "-1"},
+                "*2\r\n$1\r\nd\r\n$1\r\ne\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "-100", "0"},
+                "*1\r\n$1\r\na\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "3", "100"},
+                "*2\r\n$1\r\nd\r\n$1\r\ne\r\n"));
+    }
+
+    SECTION("Empty ranges") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b", "c"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "2", "1"},
+                "*0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "5", "10"},
+                "*0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "0", "-10"},
+                "*0\r\n"));
+    }
+
+    SECTION("Range across multiple nodes") {
+        int element_count = 2000;
+        std::string expected_response;
+
+        for(int element_index = 0; element_index < element_count; element_index++) {
+            char buffer1[32] = { 0 };
+            char buffer2[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "element_%05d", element_index);
+            snprintf(buffer2, sizeof(buffer2), ":%d\r\n", element_index + 1);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"RPUSH", "a_key", buffer1},
+                    buffer2));
+        }
+
+        expected_response = "*1000\r\n";
+        for(int element_index = 500; element_index < 1500; element_index++) {
+            char buffer1[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "$13\r\nelement_%05d\r\n", element_index);
+            expected_response += buffer1;
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "500", "1499"},
+                (char*)expected_response.c_str()));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
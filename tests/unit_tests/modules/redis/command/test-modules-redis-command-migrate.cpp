@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - MIGRATE", "[redis][command][MIGRATE]") {
+    SECTION("Key not existing") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MIGRATE", "127.0.0.1", "6379", "a_key", "0", "1000"},
+                "+NOKEY\r\n"));
+    }
+
+    SECTION("Keys not existing") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MIGRATE", "127.0.0.1", "6379", "", "0", "1000", "KEYS", "a_key", "b_key"},
+                "+NOKEY\r\n"));
+    }
+
+    SECTION("Key and KEYS") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MIGRATE", "127.0.0.1", "6379", "a_key", "0", "1000", "KEYS", "b_key"},
+                "-ERR When using MIGRATE KEYS option, the key argument must be set to the empty string\r\n"));
+    }
+
+    SECTION("Database not supported") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MIGRATE", "127.0.0.1", "6379", "a_key", "1", "1000"},
+                "-ERR DB index is out of range\r\n"));
+    }
+
+    SECTION("Invalid address") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MIGRATE", "localhost", "6379", "a_key", "0", "1000"},
+                "-ERR Invalid target address, only IP addresses are supported\r\n"));
+    }
+}
@@ -64,6 +64,38 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - MSET", "[red
                 "$7\r\nvalue_z\r\n"));
     }
 
+    SECTION("2 keys - same key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MSET", "a_key", "b_value", "a_key", "value_z"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "$7\r\nvalue_z\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"DBSIZE"},
+                ":1\r\n"));
+    }
+
+    SECTION("2 keys - overwrite existing keys") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MSET", "a_key", "value_z", "b_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "$7\r\nvalue_z\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "b_key"},
+                "$7\r\nb_value\r\n"));
+    }
+
     SECTION("Set 64 keys") {
         int key_count = 64;
         std::vector<std::string> arguments = std::vector<std::string>();
@@ -9,6 +9,7 @@
 #include <catch2/catch.hpp>
 
 #include <cstdbool>
+#include <cstring>
 #include <memory>
 
 #include <netinet/in.h>
@@ -51,4 +52,22 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - PING", "[red
                 std::vector<std::string>{"PING", "a test"},
                 "$6\r\na test\r\n"));
     }
+
+    SECTION("Inline protocol - pipelining") {
+        char expected_response[] = "+PONG\r\n$6\r\na test\r\n";
+        size_t expected_response_length = strlen(expected_response);
+
+        snprintf(buffer_send, sizeof(buffer_send) - 1, "PING\r\nPING \"a test\"\r\n");
+        buffer_send_data_len = strlen(buffer_send);
+
+        REQUIRE(send(client_fd, buffer_send, buffer_send_data_len, 0) == buffer_send_data_len);
+
+        size_t recv_len = 0;
+        do {
+            recv_len += recv(client_fd, buffer_recv + recv_len, sizeof(buffer_recv) - recv_len, 0);
+        } while(recv_len < expected_response_length);
+
+        REQUIRE(recv_len == expected_response_length);
+        REQUIRE(strncmp(buffer_recv, expected_response, expected_response_length) == 0);
+    }
 }
@@ -0,0 +1,149 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - PUBLISH", "[redis][command][PUBLISH]") {
+    SECTION("No subscribers") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBLISH", "a_channel", "b_value"},
+                ":0\r\n"));
+    }
+
+    SECTION("Channel and pattern subscribers") {
+        char buffer[256] = { 0 };
+        char *subscribe_command = "*2\r\n$9\r\nSUBSCRIBE\r\n$9\r\na_channel\r\n";
+        char *psubscribe_command = "*2\r\n$10\r\nPSUBSCRIBE\r\n$3\r\na_*\r\n";
+        char *expected_message = "*3\r\n$7\r\nmessage\r\n$9\r\na_channel\r\n$7\r\nb_value\r\n";
+        char *expected_pmessage = "*4\r\n$8\r\npmessage\r\n$3\r\na_*\r\n$9\r\na_channel\r\n$7\r\nb_value\r\n";
+
+        int subscriber_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(connect(subscriber_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+
+        REQUIRE(send(subscriber_fd, subscribe_command, strlen(subscribe_command), 0) == strlen(subscribe_command));
+        REQUIRE(recv(subscriber_fd, buffer, sizeof(buffer), 0) > 0);
+        REQUIRE(send(subscriber_fd, psubscribe_command, strlen(psubscribe_command), 0) == strlen(psubscribe_command));
+        REQUIRE(recv(subscriber_fd, buffer, sizeof(buffer), 0) > 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBLISH", "a_channel", "b_value"},
+                ":2\r\n"));
+
+        size_t expected_length = strlen(expected_message) + strlen(expected_pmessage);
+        size_t received_length = 0;
+        memset(buffer, 0, sizeof(buffer));
+        while(received_length < expected_length) {
+            ssize_t recv_length = recv(
+                    subscriber_fd,
+                    buffer + received_length,
+                    sizeof(buffer) - received_length,
+                    0);
+            REQUIRE(recv_length > 0);
+            received_length += recv_length;
+        }
+
+        REQUIRE(received_length == expected_length);
+        REQUIRE(strncmp(buffer, expected_message, strlen(expected_message)) == 0);
+        REQUIRE(strncmp(
+                buffer + strlen(expected_message),
+                expected_pmessage,
+                strlen(expected_pmessage)) == 0);
+
+        close(subscriber_fd);
+    }
+
+    SECTION("Pattern not matching") {
+        char buffer[256] = { 0 };
+        char *psubscribe_command = "*2\r\n$10\r\nPSUBSCRIBE\r\n$3\r\nb_*\r\n";
+
+        int subscriber_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(connect(subscriber_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+
+        REQUIRE(send(subscriber_fd, psubscribe_command, strlen(psubscribe_command), 0) == strlen(psubscribe_command));
+        REQUIRE(recv(subscriber_fd, buffer, sizeof(buffer), 0) > 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBLISH", "a_channel", "b_value"},
+                ":0\r\n"));
+
+        close(subscriber_fd);
+    }
+
+    SECTION("Long message") {
+        char buffer[256] = { 0 };
+        char *subscribe_command = "*2\r\n$9\r\nSUBSCRIBE\r\n$9\r\na_channel\r\n";
+        std::string long_value(8 * 1024, 'a');
+        std::string expected_message =
+                "*3\r\n$7\r\nmessage\r\n$9\r\na_channel\r\n$" +
+                std::to_string(long_value.length()) + "\r\n" + long_value + "\r\n";
+
+        int subscriber_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(connect(subscriber_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+
+        REQUIRE(send(subscriber_fd, subscribe_command, strlen(subscribe_command), 0) == strlen(subscribe_command));
+        REQUIRE(recv(subscriber_fd, buffer, sizeof(buffer), 0) > 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBLISH", "a_channel", long_value},
+                ":1\r\n"));
+
+        std::string received_message;
+        while(received_message.length() < expected_message.length()) {
+            ssize_t recv_length = recv(subscriber_fd, buffer, sizeof(buffer), 0);
+            REQUIRE(recv_length > 0);
+            received_message.append(buffer, recv_length);
+        }
+
+        REQUIRE(received_message == expected_message);
+
+        close(subscriber_fd);
+    }
+
+    SECTION("Missing parameters - message") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUBLISH", "a_channel"},
+                "-ERR wrong number of arguments for 'publish' command\r\n"));
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - PUNSUBSCRIBE", "[redis][command][PUNSUBSCRIBE]") {
+    SECTION("No subscriptions") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUNSUBSCRIBE"},
+                "*3\r\n$12\r\npunsubscribe\r\n$-1\r\n:0\r\n"));
+    }
+
+    SECTION("One pattern") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PSUBSCRIBE", "a_*", "b_*"},
+                "*3\r\n$10\r\npsubscribe\r\n$3\r\na_*\r\n:1\r\n"
+                "*3\r\n$10\r\npsubscribe\r\n$3\r\nb_*\r\n:2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUNSUBSCRIBE", "a_*"},
+                "*3\r\n$12\r\npunsubscribe\r\n$3\r\na_*\r\n:1\r\n"));
+    }
+
+    SECTION("All patterns") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PSUBSCRIBE", "a_*", "b_*"},
+                "*3\r\n$10\r\npsubscribe\r\n$3\r\na_*\r\n:1\r\n"
+                "*3\r\n$10\r\npsubscribe\r\n$3\r\nb_*\r\n:2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUNSUBSCRIBE"},
+                "*3\r\n$12\r\npunsubscribe\r\n$3\r\na_*\r\n:1\r\n"
+                "*3\r\n$12\r\npunsubscribe\r\n$3\r\nb_*\r\n:0\r\n"));
+    }
+
+    SECTION("Channels are kept") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PSUBSCRIBE", "a_*"},
+                "*3\r\n$10\r\npsubscribe\r\n$3\r\na_*\r\n:2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PUNSUBSCRIBE"},
+                "*3\r\n$12\r\npunsubscribe\r\n$3\r\na_*\r\n:1\r\n"));
+    }
+}
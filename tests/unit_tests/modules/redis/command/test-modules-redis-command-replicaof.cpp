@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - REPLICAOF", "[redis][command][REPLICAOF]") {
+    SECTION("Invalid address") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"REPLICAOF", "localhost", "12346"},
+                "-ERR Invalid master address, only IP addresses are supported\r\n"));
+    }
+
+    SECTION("Invalid port") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"REPLICAOF", "127.0.0.1", "a_port"},
+                "-ERR Invalid master port\r\n"));
+    }
+
+    SECTION("Replicate from primary") {
+        char buffer[256] = { 0 };
+        char *expected_sync_command = "*1\r\n$4\r\nSYNC\r\n";
+        char *snapshot =
+                "*1\r\n$7\r\nFLUSHDB\r\n"
+                "*3\r\n$3\r\nSET\r\n$5\r\na_key\r\n$7\r\nb_value\r\n";
+        struct sockaddr_in primary_address = { 0 };
+        size_t received_length = 0;
+        int enable = 1;
+        bool replicated = false;
+
+        primary_address.sin_family = AF_INET;
+        primary_address.sin_port = htons(12346);
+        primary_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        int primary_listener_fd = socket(AF_INET, SOCK_STREAM, 0);
+        REQUIRE(setsockopt(primary_listener_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) == 0);
+        REQUIRE(bind(primary_listener_fd, (struct sockaddr *) &primary_address, sizeof(primary_address)) == 0);
+        REQUIRE(listen(primary_listener_fd, 1) == 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"REPLICAOF", "127.0.0.1", "12346"},
+                "+OK\r\n"));
+
+        int primary_fd = accept(primary_listener_fd, NULL, NULL);
+        REQUIRE(primary_fd >= 0);
+
+        while(received_length < strlen(expected_sync_command)) {
+            ssize_t recv_length = recv(
+                    primary_fd,
+                    buffer + received_length,
+                    sizeof(buffer) - received_length,
+                    0);
+            REQUIRE(recv_length > 0);
+            received_length += recv_length;
+        }
+
+        REQUIRE(strncmp(buffer, expected_sync_command, strlen(expected_sync_command)) == 0);
+        REQUIRE(send(primary_fd, snapshot, strlen(snapshot), 0) == strlen(snapshot));
+
+        // The commands are applied asynchronously by the replica
+        for(int attempt = 0; attempt < 100 && !replicated; attempt++) {
+            replicated = send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "a_key"},
+                    "$7\r\nb_value\r\n");
+
+            if (!replicated) {
+                usleep(10000);
+            }
+        }
+
+        REQUIRE(replicated);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "b_key", "c_value"},
+                "-READONLY You can't write against a read only replica.\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"REPLICAOF", "NO", "ONE"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "b_key", "c_value"},
+                "+OK\r\n"));
+
+        close(primary_fd);
+        close(primary_listener_fd);
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - RPOP", "[redis][command][RPOP]") {
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key"},
+                "$-1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key", "2"},
+                "*-1\r\n"));
+    }
+
+    SECTION("Pop one element") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b", "c", "d", "e"},
+                ":5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key"},
+                "$1\r\ne\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LLEN", "a_key"},
+                ":4\r\n"));
+    }
+
+    SECTION("Pop with count") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b", "c", "d", "e"},
+                ":5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key", "0"},
+                "*0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key", "1"},
+                "*1\r\n$1\r\ne\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key", "2"},
+                "*2\r\n$1\r\nd\r\n$1\r\nc\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"LRANGE", "a_key", "0", "-1"},
+                "*2\r\n$1\r\na\r\n$1\r\nb\r\n"));
+    }
+
+    SECTION("Pop all the elements deletes the key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a", "b"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key", "10"},
+                "*2\r\n$1\r\nb\r\n$1\r\na\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Pop across multiple nodes") {
+        int element_count = 2000;
+
+        for(int element_index = 0; element_index < element_count; element_index++) {
+            char buffer1[32] = { 0 };
+            char buffer2[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "element_%05d", element_index);
+            snprintf(buffer2, sizeof(buffer2), ":%d\r\n", element_index + 1);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"RPUSH", "a_key", buffer1},
+                    buffer2));
+        }
+
+        for(int element_index = 0; element_index < element_count; element_index++) {
+            char buffer1[32] = { 0 };
+            snprintf(
+                    buffer1,
+                    sizeof(buffer1),
+                    "$13\r\nelement_%05d\r\n",
+                    element_count - element_index - 1);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"RPOP", "a_key"},
+                    buffer1));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"EXISTS", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Negative count") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPUSH", "a_key", "a"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key", "-1"},
+                "-ERR value is out of range, must be positive\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"RPOP", "a_key"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
@@ -0,0 +1,224 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SADD", "[redis][command][SADD]") {
+    SECTION("New key - 1 member") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SMEMBERS", "a_key"},
+                "*1\r\n$8\r\na_member\r\n"));
+    }
+
+    SECTION("New key - 2 members - same member") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member", "a_member"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCARD", "a_key"},
+                ":1\r\n"));
+    }
+
+    SECTION("Existing key - add existing and new members") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member", "b_member"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "b_member", "c_member"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member"},
+                ":0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SMEMBERS", "a_key"},
+                "*3\r\n$8\r\na_member\r\n$8\r\nb_member\r\n$8\r\nc_member\r\n"));
+    }
+
+    SECTION("Integers") {
+        // The sets containing only integers are stored sorted
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "30", "-5", "100", "0", "30"},
+                ":4\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SMEMBERS", "a_key"},
+                "*4\r\n$2\r\n-5\r\n$1\r\n0\r\n$2\r\n30\r\n$3\r\n100\r\n"));
+    }
+
+    SECTION("Integers - limits") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "9223372036854775807", "-9223372036854775808"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SMEMBERS", "a_key"},
+                "*2\r\n$20\r\n-9223372036854775808\r\n$19\r\n9223372036854775807\r\n"));
+    }
+
+    SECTION("Integers - convert to hashtable encoding") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "3", "1", "2"},
+                ":3\r\n"));
+
+        // The non canonical integers are stored as strings
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "01", "1", "a_member"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SMEMBERS", "a_key"},
+                "*5\r\n$1\r\n1\r\n$1\r\n2\r\n$1\r\n3\r\n$2\r\n01\r\n$8\r\na_member\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SISMEMBER", "a_key", "2"},
+                ":1\r\n"));
+    }
+
+    SECTION("Integers - more than an intset can contain") {
+        // The intsets are always contained in a chunk, the bigger sets are converted to the hashtable encoding
+        int member_count = 10000;
+        int batch_size = 500;
+
+        for(int batch_start = 0; batch_start < member_count; batch_start += batch_size) {
+            std::vector<std::string> arguments = {"SADD", "a_key"};
+            for(int member_index = batch_start; member_index < batch_start + batch_size; member_index++) {
+                arguments.push_back(std::to_string(member_index));
+            }
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    arguments,
+                    ":500\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCARD", "a_key"},
+                ":10000\r\n"));
+
+        for(int member_index = 0; member_index < member_count; member_index += 999) {
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SISMEMBER", "a_key", std::to_string(member_index)},
+                    ":1\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SISMEMBER", "a_key", "10000"},
+                ":0\r\n"));
+    }
+
+    SECTION("Split in multiple nodes") {
+        // The members are spread over multiple nodes, every update rewrites only the node containing the member
+        int member_count = 4096;
+        int batch_size = 256;
+
+        for(int batch_start = 0; batch_start < member_count; batch_start += batch_size) {
+            std::vector<std::string> arguments = {"SADD", "a_key"};
+            for(int member_index = batch_start; member_index < batch_start + batch_size; member_index++) {
+                char buffer[32] = { 0 };
+                snprintf(buffer, sizeof(buffer), "a_member_%05d", member_index);
+                arguments.push_back(buffer);
+            }
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    arguments,
+                    ":256\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member_00000", "a_member_04095", "a_member_04096"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCARD", "a_key"},
+                ":4097\r\n"));
+
+        for(int member_index = 0; member_index <= member_count; member_index++) {
+            char buffer[32] = { 0 };
+            snprintf(buffer, sizeof(buffer), "a_member_%05d", member_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SISMEMBER", "a_key", buffer},
+                    ":1\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SISMEMBER", "a_key", "a_member_not_existing"},
+                ":0\r\n"));
+    }
+
+    SECTION("Member too large") {
+        // Every member has to fit in a chunk
+        std::string long_member(64 * 1024, 'a');
+        config_module_redis.max_key_length = long_member.length() + 1024;
+        config_module_redis.max_command_length = long_member.length() + 1024;
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", long_member},
+                "-ERR member too large\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCARD", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing parameters - member") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key"},
+                "-ERR wrong number of arguments for 'sadd' command\r\n"));
+    }
+}
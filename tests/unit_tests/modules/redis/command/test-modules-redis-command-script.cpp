@@ -0,0 +1,100 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SCRIPT", "[redis][command][SCRIPT]") {
+    SECTION("LOAD") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "LOAD", "return 1"},
+                "$40\r\ne0e1f9fabfc9d4800c877a703b823ac0578ff8db\r\n"));
+    }
+
+    SECTION("LOAD - compilation error") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "LOAD", "return ("},
+                "-ERR Error compiling script (new function): user_script:1: unexpected symbol near '<eof>'\r\n"));
+    }
+
+    SECTION("LOAD - wrong number of arguments") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "LOAD"},
+                "-ERR wrong number of arguments for 'script|load' command\r\n"));
+    }
+
+    SECTION("EXISTS") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "LOAD", "return 1"},
+                "$40\r\ne0e1f9fabfc9d4800c877a703b823ac0578ff8db\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{
+                    "SCRIPT",
+                    "EXISTS",
+                    "e0e1f9fabfc9d4800c877a703b823ac0578ff8db",
+                    "d006f1a90249474274c76f5be725b8f5804a346b",
+                    "not_a_sha1"},
+                "*3\r\n:1\r\n:0\r\n:0\r\n"));
+    }
+
+    SECTION("FLUSH") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "LOAD", "return 1"},
+                "$40\r\ne0e1f9fabfc9d4800c877a703b823ac0578ff8db\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "FLUSH"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "EXISTS", "e0e1f9fabfc9d4800c877a703b823ac0578ff8db"},
+                "*1\r\n:0\r\n"));
+    }
+
+    SECTION("Unknown subcommand") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCRIPT", "UNKNOWN"},
+                "-ERR unknown subcommand 'UNKNOWN'. Try SCRIPT HELP.\r\n"));
+    }
+}
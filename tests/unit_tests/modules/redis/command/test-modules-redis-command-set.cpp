@@ -68,6 +68,48 @@ TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SET", "[redi
         REQUIRE(strncmp((char *) entry_index->value->sequence[0].memory.chunk_data, value, strlen(value)) == 0);
     }
 
+    SECTION("New key - embedded") {
+        char *key = "a_key";
+        std::string value(STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE, 'x');
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", key, value},
+                "+OK\r\n"));
+
+        storage_db_entry_index_t *entry_index = storage_db_get_entry_index(db, key, strlen(key));
+        REQUIRE(entry_index->value->count == 1);
+        REQUIRE(storage_db_entry_index_has_embedded_value(entry_index));
+        REQUIRE(storage_db_chunk_info_is_embedded(&entry_index->value->sequence[0]));
+        REQUIRE(entry_index->value->sequence[0].chunk_length == value.length());
+        REQUIRE(strncmp(
+                (char *) entry_index->value->sequence[0].memory.chunk_data,
+                value.c_str(),
+                value.length()) == 0);
+
+        std::string expected_response = "$" + std::to_string(value.length()) + "\r\n" + value + "\r\n";
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", key},
+                (char *) expected_response.c_str()));
+    }
+
+    SECTION("New key - too long to be embedded") {
+        char *key = "a_key";
+        std::string value(STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE + 1, 'x');
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", key, value},
+                "+OK\r\n"));
+
+        storage_db_entry_index_t *entry_index = storage_db_get_entry_index(db, key, strlen(key));
+        REQUIRE(!storage_db_entry_index_has_embedded_value(entry_index));
+        REQUIRE(!storage_db_chunk_info_is_embedded(&entry_index->value->sequence[0]));
+        REQUIRE(entry_index->value->sequence[0].chunk_length == value.length());
+        REQUIRE(strncmp(
+                (char *) entry_index->value->sequence[0].memory.chunk_data,
+                value.c_str(),
+                value.length()) == 0);
+    }
+
     SECTION("Overwrite key") {
         char *key = "a_key";
         char *value1 = "b_value";
@@ -0,0 +1,193 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SINTER", "[redis][command][SINTER]") {
+    // The members are added in batches to keep the commands within the size of the send buffer
+    auto sadd_range = [this](const char *key, int first_member, int last_member, int step) {
+        int batch_size = 500;
+
+        for(int batch_start = first_member; batch_start <= last_member; batch_start += batch_size * step) {
+            std::vector<std::string> arguments = {"SADD", key};
+            for(int member = batch_start;
+                member <= last_member && member < batch_start + batch_size * step;
+                member += step) {
+                arguments.push_back(std::to_string(member));
+            }
+
+            std::string expected_response = ":" + std::to_string(arguments.size() - 2) + "\r\n";
+            if (!send_recv_resp_command_text_and_validate_recv(arguments, (char*)expected_response.c_str())) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    auto expected_range = [](int first_member, int last_member, int step) {
+        int count = 0;
+        std::string members;
+
+        for(int member = first_member; member <= last_member; member += step) {
+            std::string member_str = std::to_string(member);
+            members += "$" + std::to_string(member_str.length()) + "\r\n" + member_str + "\r\n";
+            count++;
+        }
+
+        return "*" + std::to_string(count) + "\r\n" + members;
+    };
+
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key"},
+                "*0\r\n"));
+    }
+
+    SECTION("Existing key and non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member", "b_member"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key", "b_key"},
+                "*0\r\n"));
+    }
+
+    SECTION("Single key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member", "b_member"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key"},
+                "*2\r\n$8\r\na_member\r\n$8\r\nb_member\r\n"));
+    }
+
+    SECTION("Hashtables") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member", "b_member", "c_member"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "b_key", "c_member", "d_member", "a_member", "e_member"},
+                ":4\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key", "b_key"},
+                "*2\r\n$8\r\na_member\r\n$8\r\nc_member\r\n"));
+    }
+
+    SECTION("Intsets") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "1", "2", "3", "4", "5"},
+                ":5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "b_key", "5", "3", "1", "7"},
+                ":4\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "c_key", "3", "5", "9"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key", "b_key", "c_key"},
+                "*2\r\n$1\r\n3\r\n$1\r\n5\r\n"));
+    }
+
+    SECTION("Intset and hashtable") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "1", "2", "3"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "b_key", "a_member", "3", "01", "1", "b_member"},
+                ":5\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key", "b_key"},
+                "*2\r\n$1\r\n1\r\n$1\r\n3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "b_key", "a_key"},
+                "*2\r\n$1\r\n1\r\n$1\r\n3\r\n"));
+    }
+
+    SECTION("Large intsets") {
+        REQUIRE(sadd_range("a_key", 0, 7999, 1));
+        REQUIRE(sadd_range("b_key", 7900, 15899, 1));
+
+        std::string expected_response = expected_range(7900, 7999, 1);
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key", "b_key"},
+                (char*)expected_response.c_str()));
+    }
+
+    SECTION("Large hashtable and intset") {
+        // The first set contains more integers than an intset can contain and is converted to the hashtable encoding
+        REQUIRE(sadd_range("a_key", 0, 9999, 1));
+        REQUIRE(sadd_range("b_key", 0, 19999, 100));
+
+        std::string expected_response = expected_range(0, 9999, 100);
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key", "b_key"},
+                (char*)expected_response.c_str()));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "b_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER", "a_key", "b_key"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing parameters - key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SINTER"},
+                "-ERR wrong number of arguments for 'sinter' command\r\n"));
+    }
+}
@@ -0,0 +1,150 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SREM", "[redis][command][SREM]") {
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SREM", "a_key", "a_member"},
+                ":0\r\n"));
+    }
+
+    SECTION("Existing key - remove members") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member", "b_member", "c_member"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SREM", "a_key", "a_member", "c_member", "d_member"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SMEMBERS", "a_key"},
+                "*1\r\n$8\r\nb_member\r\n"));
+    }
+
+    SECTION("Existing key - intset") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "1", "2", "3"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SREM", "a_key", "2", "a_member"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SMEMBERS", "a_key"},
+                "*2\r\n$1\r\n1\r\n$1\r\n3\r\n"));
+    }
+
+    SECTION("Existing key - remove all members") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SADD", "a_key", "a_member", "1"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SREM", "a_key", "a_member", "1"},
+                ":2\r\n"));
+
+        // The empty sets are deleted
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "$-1\r\n"));
+    }
+
+    SECTION("Existing key - remove from multiple nodes") {
+        int member_count = 4096;
+        int batch_size = 256;
+
+        for(int batch_start = 0; batch_start < member_count; batch_start += batch_size) {
+            std::vector<std::string> arguments = {"SADD", "a_key"};
+            for(int member_index = batch_start; member_index < batch_start + batch_size; member_index++) {
+                char buffer[32] = { 0 };
+                snprintf(buffer, sizeof(buffer), "a_member_%05d", member_index);
+                arguments.push_back(buffer);
+            }
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    arguments,
+                    ":256\r\n"));
+        }
+
+        // Only the nodes containing the members removed are rewritten, the others are shared with the previous version
+        for(int member_index = 0; member_index < member_count; member_index += 2) {
+            char buffer[32] = { 0 };
+            snprintf(buffer, sizeof(buffer), "a_member_%05d", member_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SREM", "a_key", buffer},
+                    ":1\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SCARD", "a_key"},
+                ":2048\r\n"));
+
+        for(int member_index = 0; member_index < member_count; member_index++) {
+            char buffer[32] = { 0 };
+            snprintf(buffer, sizeof(buffer), "a_member_%05d", member_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SISMEMBER", "a_key", buffer},
+                    member_index % 2 == 0 ? ":0\r\n" : ":1\r\n"));
+        }
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SREM", "a_key", "a_member"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+
+    SECTION("Missing parameters - member") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SREM", "a_key"},
+                "-ERR wrong number of arguments for 'srem' command\r\n"));
+    }
+}
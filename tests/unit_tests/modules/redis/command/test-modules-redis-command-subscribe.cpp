@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SUBSCRIBE", "[redis][command][SUBSCRIBE]") {
+    SECTION("One channel") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+    }
+
+    SECTION("Two channels") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel", "b_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\nb_channel\r\n:2\r\n"));
+    }
+
+    SECTION("Same channel twice") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+    }
+
+    SECTION("Receive message") {
+        char buffer[256] = { 0 };
+        char *expected_message = "*3\r\n$7\r\nmessage\r\n$9\r\na_channel\r\n$7\r\nb_value\r\n";
+        char *publish_command = "*3\r\n$7\r\nPUBLISH\r\n$9\r\na_channel\r\n$7\r\nb_value\r\n";
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        // The message is published from a second connection while the subscriber is waiting for data
+        int publisher_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(connect(publisher_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+
+        REQUIRE(send(publisher_fd, publish_command, strlen(publish_command), 0) == strlen(publish_command));
+        REQUIRE(recv(publisher_fd, buffer, sizeof(buffer), 0) == strlen(":1\r\n"));
+        REQUIRE(strncmp(buffer, ":1\r\n", strlen(":1\r\n")) == 0);
+
+        memset(buffer, 0, sizeof(buffer));
+        REQUIRE(recv(client_fd, buffer, sizeof(buffer), 0) == strlen(expected_message));
+        REQUIRE(strncmp(buffer, expected_message, strlen(expected_message)) == 0);
+
+        close(publisher_fd);
+    }
+
+    SECTION("Command not allowed") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "-ERR Can't execute 'get': only (P|S)SUBSCRIBE / (P|S)UNSUBSCRIBE / PING / QUIT / RESET are allowed in "
+                "this context\r\n"));
+    }
+
+    SECTION("PING") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PING"},
+                "*2\r\n$4\r\npong\r\n$0\r\n\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"PING", "a_message"},
+                "*2\r\n$4\r\npong\r\n$9\r\na_message\r\n"));
+    }
+
+    SECTION("RESP3 - Commands allowed") {
+        // Switch to RESP3, the response of HELLO isn't relevant for this test
+        snprintf(buffer_send, sizeof(buffer_send) - 1, "*2\r\n$5\r\nHELLO\r\n$1\r\n3\r\n");
+        buffer_send_data_len = strlen(buffer_send);
+
+        REQUIRE(send(client_fd, buffer_send, buffer_send_data_len, 0) == buffer_send_data_len);
+        REQUIRE(recv(client_fd, buffer_recv, sizeof(buffer_recv), 0) > 0);
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                ">3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+    }
+
+    SECTION("Missing parameters - channel") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE"},
+                "-ERR wrong number of arguments for 'subscribe' command\r\n"));
+    }
+}
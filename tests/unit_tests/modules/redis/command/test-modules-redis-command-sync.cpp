@@ -0,0 +1,228 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <map>
+#include <algorithm>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - SYNC", "[redis][command][SYNC]") {
+    SECTION("Snapshot and stream") {
+        char buffer[256] = { 0 };
+        char *sync_command = "*1\r\n$4\r\nSYNC\r\n";
+        std::string expected_snapshot =
+                "*1\r\n$7\r\nFLUSHDB\r\n"
+                "*3\r\n$3\r\nSET\r\n$5\r\na_key\r\n$7\r\nb_value\r\n";
+        std::string expected_stream =
+                "*3\r\n$3\r\nset\r\n$5\r\nb_key\r\n$7\r\nc_value\r\n";
+        std::string received_data;
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        int replica_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(connect(replica_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+        REQUIRE(send(replica_fd, sync_command, strlen(sync_command), 0) == strlen(sync_command));
+
+        while(received_data.length() < expected_snapshot.length()) {
+            ssize_t recv_length = recv(replica_fd, buffer, sizeof(buffer), 0);
+            REQUIRE(recv_length > 0);
+            received_data.append(buffer, recv_length);
+        }
+
+        REQUIRE(received_data == expected_snapshot);
+
+        // The write commands executed after the snapshot are streamed to the replica
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "b_key", "c_value"},
+                "+OK\r\n"));
+
+        received_data.clear();
+        while(received_data.find(expected_stream) == std::string::npos) {
+            ssize_t recv_length = recv(replica_fd, buffer, sizeof(buffer), 0);
+            REQUIRE(recv_length > 0);
+            received_data.append(buffer, recv_length);
+        }
+
+        // The read commands are not streamed
+        REQUIRE(received_data.find("get") == std::string::npos);
+
+        close(replica_fd);
+    }
+
+    SECTION("Writes during a large snapshot") {
+        char buffer[64 * 1024] = { 0 };
+        char *sync_command = "*1\r\n$4\r\nSYNC\r\n";
+        std::string value(64 * 1024, 'a');
+        std::string received_data;
+        size_t received_data_offset = 0;
+        std::vector<std::string> arguments;
+        std::map<std::string, std::string> replica_data;
+        std::map<std::string, std::string> expected_data;
+        struct timeval timeout = { .tv_sec = 5, .tv_usec = 0 };
+
+        // Parses a command sent to the replica, returns false if it hasn't been received entirely
+        auto parse_command = [&]() -> bool {
+            size_t offset = received_data_offset;
+            size_t line_end;
+            long arguments_count;
+
+            arguments.clear();
+
+            if ((line_end = received_data.find("\r\n", offset)) == std::string::npos) {
+                return false;
+            }
+
+            REQUIRE(received_data[offset] == '*');
+            arguments_count = strtol(received_data.c_str() + offset + 1, nullptr, 10);
+            offset = line_end + 2;
+
+            for(long index = 0; index < arguments_count; index++) {
+                if ((line_end = received_data.find("\r\n", offset)) == std::string::npos) {
+                    return false;
+                }
+
+                REQUIRE(received_data[offset] == '$');
+                size_t length = strtol(received_data.c_str() + offset + 1, nullptr, 10);
+                offset = line_end + 2;
+
+                if (received_data.length() < offset + length + 2) {
+                    return false;
+                }
+
+                arguments.push_back(received_data.substr(offset, length));
+                offset += length + 2;
+            }
+
+            received_data_offset = offset;
+
+            return true;
+        };
+
+        // The snapshot is bigger than the socket buffers so it can't be sent entirely until the replica reads it
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{
+                        "EVAL",
+                        "for i = 1, 512 do redis.call('SET', 'key_' .. i, string.rep('a', 65536)) end return 1",
+                        "0"},
+                ":1\r\n"));
+
+        for(int index = 1; index <= 512; index++) {
+            expected_data["key_" + std::to_string(index)] = value;
+        }
+
+        int replica_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(setsockopt(replica_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0);
+        REQUIRE(connect(replica_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+        REQUIRE(send(replica_fd, sync_command, strlen(sync_command), 0) == strlen(sync_command));
+
+        // Once the snapshot has begun the replica stops reading
+        while(received_data.length() < strlen("*1\r\n$7\r\nFLUSHDB\r\n")) {
+            ssize_t recv_length = recv(replica_fd, buffer, sizeof(buffer), 0);
+            REQUIRE(recv_length > 0);
+            received_data.append(buffer, recv_length);
+        }
+
+        // The writes aren't paused while the snapshot is being sent, the keys changed have to be part of the snapshot
+        // with the value they had when the snapshot began as the write commands are streamed afterwards, APPEND
+        // would otherwise be applied twice
+        for(int index = 1; index <= 512; index += 64) {
+            std::string key = "key_" + std::to_string(index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"APPEND", key, "b"},
+                    ":65537\r\n"));
+            expected_data[key] += "b";
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"DEL", "key_2"},
+                ":1\r\n"));
+        expected_data.erase("key_2");
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "key_3", "b_value"},
+                "+OK\r\n"));
+        expected_data["key_3"] = "b_value";
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "new_key", "c_value"},
+                "+OK\r\n"));
+        expected_data["new_key"] = "c_value";
+
+        // The replica applies the snapshot and the stream till it matches the data
+        while(replica_data != expected_data) {
+            while(parse_command()) {
+                std::string command = arguments[0];
+                std::transform(command.begin(), command.end(), command.begin(), ::tolower);
+
+                if (command == "flushdb") {
+                    replica_data.clear();
+                } else if (command == "set") {
+                    replica_data[arguments[1]] = arguments[2];
+                } else if (command == "append") {
+                    replica_data[arguments[1]] += arguments[2];
+                } else if (command == "del") {
+                    replica_data.erase(arguments[1]);
+                } else {
+                    REQUIRE(command == "ping");
+                }
+            }
+
+            received_data.erase(0, received_data_offset);
+            received_data_offset = 0;
+
+            if (replica_data == expected_data) {
+                break;
+            }
+
+            ssize_t recv_length = recv(replica_fd, buffer, sizeof(buffer), 0);
+            REQUIRE(recv_length > 0);
+            received_data.append(buffer, recv_length);
+        }
+
+        close(replica_fd);
+    }
+}
@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+#include <cstring>
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - UNSUBSCRIBE", "[redis][command][UNSUBSCRIBE]") {
+    SECTION("No subscriptions") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"UNSUBSCRIBE"},
+                "*3\r\n$11\r\nunsubscribe\r\n$-1\r\n:0\r\n"));
+    }
+
+    SECTION("One channel") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel", "b_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\nb_channel\r\n:2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"UNSUBSCRIBE", "a_channel"},
+                "*3\r\n$11\r\nunsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+    }
+
+    SECTION("Channel not subscribed") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"UNSUBSCRIBE", "b_channel"},
+                "*3\r\n$11\r\nunsubscribe\r\n$9\r\nb_channel\r\n:1\r\n"));
+    }
+
+    SECTION("All channels") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel", "b_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\nb_channel\r\n:2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"UNSUBSCRIBE"},
+                "*3\r\n$11\r\nunsubscribe\r\n$9\r\na_channel\r\n:1\r\n"
+                "*3\r\n$11\r\nunsubscribe\r\n$9\r\nb_channel\r\n:0\r\n"));
+
+        // Once all the subscriptions are removed all the commands are allowed again
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "$-1\r\n"));
+    }
+
+    SECTION("Stop receiving messages") {
+        char buffer[256] = { 0 };
+        char *publish_command = "*3\r\n$7\r\nPUBLISH\r\n$9\r\na_channel\r\n$7\r\nb_value\r\n";
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SUBSCRIBE", "a_channel"},
+                "*3\r\n$9\r\nsubscribe\r\n$9\r\na_channel\r\n:1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"UNSUBSCRIBE", "a_channel"},
+                "*3\r\n$11\r\nunsubscribe\r\n$9\r\na_channel\r\n:0\r\n"));
+
+        int publisher_fd = network_io_common_socket_tcp4_new(0);
+        REQUIRE(connect(publisher_fd, (struct sockaddr *) &address, sizeof(address)) == 0);
+
+        REQUIRE(send(publisher_fd, publish_command, strlen(publish_command), 0) == strlen(publish_command));
+        REQUIRE(recv(publisher_fd, buffer, sizeof(buffer), 0) == strlen(":0\r\n"));
+        REQUIRE(strncmp(buffer, ":0\r\n", strlen(":0\r\n")) == 0);
+
+        close(publisher_fd);
+    }
+}
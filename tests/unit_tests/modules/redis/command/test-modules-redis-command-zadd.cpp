@@ -0,0 +1,157 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - ZADD", "[redis][command][ZADD]") {
+    SECTION("New key - one member") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "a"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZSCORE", "a_key", "a"},
+                "$1\r\n1\r\n"));
+    }
+
+    SECTION("New key - multiple members") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "3", "c", "1", "a", "2", "b"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGE", "a_key", "0", "-1"},
+                "*3\r\n$1\r\na\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+    }
+
+    SECTION("Existing key - update score") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "a", "2", "b"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "3", "a", "4", "c"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGE", "a_key", "0", "-1", "WITHSCORES"},
+                "*6\r\n$1\r\nb\r\n$1\r\n2\r\n$1\r\na\r\n$1\r\n3\r\n$1\r\nc\r\n$1\r\n4\r\n"));
+    }
+
+    SECTION("Same score - ordered by member") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "c", "1", "a", "1", "b"},
+                ":3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGE", "a_key", "0", "-1"},
+                "*3\r\n$1\r\na\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+    }
+
+    SECTION("Infinite scores") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "+inf", "b", "-inf", "a"},
+                ":2\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGE", "a_key", "0", "-1", "WITHSCORES"},
+                "*4\r\n$1\r\na\r\n$4\r\n-inf\r\n$1\r\nb\r\n$3\r\ninf\r\n"));
+    }
+
+    SECTION("Many members - tree encoding") {
+        int member_count = 5000;
+
+        for(int member_index = 0; member_index < member_count; member_index++) {
+            char buffer1[32] = { 0 };
+            char buffer2[32] = { 0 };
+            snprintf(buffer1, sizeof(buffer1), "%d", member_count - member_index);
+            snprintf(buffer2, sizeof(buffer2), "member_%05d", member_index);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"ZADD", "a_key", buffer1, buffer2},
+                    ":1\r\n"));
+        }
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZCARD", "a_key"},
+                ":5000\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZSCORE", "a_key", "member_01234"},
+                "$4\r\n3766\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANK", "a_key", "member_01234"},
+                ":3765\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "0", "member_01234"},
+                ":0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANK", "a_key", "member_01234"},
+                ":0\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZCARD", "a_key"},
+                ":5000\r\n"));
+    }
+
+    SECTION("Invalid score") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "nan", "a"},
+                "-ERR value is not a valid float\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZCARD", "a_key"},
+                ":0\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "a"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
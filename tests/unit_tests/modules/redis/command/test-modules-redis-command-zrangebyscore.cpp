@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <memory>
+
+#include <netinet/in.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+
+#include "program.h"
+
+#include "test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - command - ZRANGEBYSCORE", "[redis][command][ZRANGEBYSCORE]") {
+    SECTION("Non-existent key") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "-inf", "+inf"},
+                "*0\r\n"));
+    }
+
+    SECTION("Inclusive and exclusive bounds") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "a", "2", "b", "3", "c", "4", "d"},
+                ":4\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "-inf", "+inf"},
+                "*4\r\n$1\r\na\r\n$1\r\nb\r\n$1\r\nc\r\n$1\r\nd\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "2", "3", "WITHSCORES"},
+                "*4\r\n$1\r\nb\r\n$1\r\n2\r\n$1\r\nc\r\n$1\r\n3\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "(1", "(4"},
+                "*2\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "(2", "(3"},
+                "*0\r\n"));
+    }
+
+    SECTION("Limit") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "a", "2", "b", "3", "c", "4", "d"},
+                ":4\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "-inf", "+inf", "LIMIT", "1", "2"},
+                "*2\r\n$1\r\nb\r\n$1\r\nc\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "-inf", "+inf", "LIMIT", "2", "-1"},
+                "*2\r\n$1\r\nc\r\n$1\r\nd\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "-inf", "+inf", "LIMIT", "10", "2"},
+                "*0\r\n"));
+    }
+
+    SECTION("Invalid bounds") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZADD", "a_key", "1", "a"},
+                ":1\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "a", "+inf"},
+                "-ERR min or max is not a float\r\n"));
+    }
+
+    SECTION("Wrong type") {
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"ZRANGEBYSCORE", "a_key", "-inf", "+inf"},
+                "-WRONGTYPE Operation against a key holding the wrong kind of value\r\n"));
+    }
+}
@@ -0,0 +1,413 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+
+#include <cstdbool>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/stat.h>
+
+#include "clock.h"
+#include "exttypes.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_voidptr.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "data_structures/hashtable/spsc/hashtable_spsc.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "memory_allocator/ffma.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+#include "module/module.h"
+#include "network/io/network_io_common.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "network/channel/network_channel.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "signal_handler_thread.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+#include "epoch_gc.h"
+#include "epoch_gc_worker.h"
+#include "module/redis/module_redis.h"
+#include "module/redis/module_redis_connection.h"
+#include "module/redis/module_redis_replication.h"
+#include "module/redis/module_redis_aof.h"
+
+#include "program.h"
+
+#include "command/test-modules-redis-command-fixture.hpp"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+#define TEST_MODULE_REDIS_AOF_WAIT_MAX_MS 5000
+#define TEST_MODULE_REDIS_AOF_WAIT_STEP_MS 10
+
+std::string test_module_redis_aof_path(
+        const char *aof_path,
+        const char *filename) {
+    return std::string(aof_path) + "/" + filename;
+}
+
+std::string test_module_redis_aof_read_file(
+        const std::string& path) {
+    std::string data;
+    char buffer[4096];
+    ssize_t read_length;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return data;
+    }
+
+    while((read_length = read(fd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, read_length);
+    }
+
+    close(fd);
+
+    return data;
+}
+
+void test_module_redis_aof_write_file(
+        const std::string& path,
+        const std::string& data) {
+    int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
+    REQUIRE(fd >= 0);
+    REQUIRE(write(fd, data.c_str(), data.length()) == (ssize_t)data.length());
+    close(fd);
+}
+
+void test_module_redis_aof_remove_directory(
+        const char *aof_path) {
+    struct dirent *dir_entry;
+    DIR *dir = opendir(aof_path);
+
+    if (dir == nullptr) {
+        return;
+    }
+
+    while((dir_entry = readdir(dir)) != nullptr) {
+        if (strcmp(dir_entry->d_name, ".") != 0 && strcmp(dir_entry->d_name, "..") != 0) {
+            unlink(test_module_redis_aof_path(aof_path, dir_entry->d_name).c_str());
+        }
+    }
+
+    closedir(dir);
+    rmdir(aof_path);
+}
+
+std::string test_module_redis_aof_record(
+        uint64_t sequence,
+        const std::string& command) {
+    module_redis_aof_record_header_t record_header = {
+            .sequence = sequence,
+            .length = (uint32_t)command.length(),
+    };
+
+    return std::string((char*)&record_header, sizeof(record_header)) + command;
+}
+
+// Waits for the file to contain the expected data, the records are written by the flush fiber of the worker
+bool test_module_redis_aof_wait_for_file(
+        const std::string& path,
+        const std::string& expected) {
+    for(int waited_ms = 0; waited_ms < TEST_MODULE_REDIS_AOF_WAIT_MAX_MS; waited_ms += TEST_MODULE_REDIS_AOF_WAIT_STEP_MS) {
+        if (test_module_redis_aof_read_file(path) == expected) {
+            return true;
+        }
+
+        usleep(TEST_MODULE_REDIS_AOF_WAIT_STEP_MS * 1000);
+    }
+
+    return test_module_redis_aof_read_file(path) == expected;
+}
+
+bool test_module_redis_aof_wait_for_file_exists(
+        const std::string& path,
+        bool exists) {
+    for(int waited_ms = 0; waited_ms < TEST_MODULE_REDIS_AOF_WAIT_MAX_MS; waited_ms += TEST_MODULE_REDIS_AOF_WAIT_STEP_MS) {
+        if ((access(path.c_str(), F_OK) == 0) == exists) {
+            return true;
+        }
+
+        usleep(TEST_MODULE_REDIS_AOF_WAIT_STEP_MS * 1000);
+    }
+
+    return (access(path.c_str(), F_OK) == 0) == exists;
+}
+
+TEST_CASE_METHOD(TestModulesRedisCommandFixture, "Redis - append only file", "[redis][aof]") {
+    char aof_path[] = "/tmp/cachegrand-tests-aof-XXXXXX";
+    REQUIRE(mkdtemp(aof_path) != nullptr);
+
+    config_database_aof_t config_database_aof = {
+            .path = aof_path,
+            .fsync = CONFIG_DATABASE_AOF_FSYNC_ALWAYS,
+            .rewrite_percentage = 0,
+            .rewrite_min_size_mb = 0,
+    };
+
+    std::string set_a_key_command = "*3\r\n$3\r\nset\r\n$5\r\na_key\r\n$7\r\nb_value\r\n";
+    std::string append_a_key_command = "*3\r\n$6\r\nappend\r\n$5\r\na_key\r\n$7\r\nc_value\r\n";
+    std::string segment_path = test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "1.0");
+    std::string base_path = test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_BASE_FILENAME);
+
+    // The commands are refused while the append only file is being loaded
+    auto wait_for_loaded = [&]() {
+        size_t out_buffer_recv_length;
+
+        for(int waited_ms = 0; waited_ms < TEST_MODULE_REDIS_AOF_WAIT_MAX_MS; waited_ms += TEST_MODULE_REDIS_AOF_WAIT_STEP_MS) {
+            REQUIRE(send_recv_resp_command(
+                    std::vector<std::string>{"PING"},
+                    buffer_recv,
+                    sizeof(buffer_recv),
+                    &out_buffer_recv_length,
+                    1));
+
+            if (strncmp(buffer_recv, "-LOADING", strlen("-LOADING")) != 0) {
+                break;
+            }
+
+            usleep(TEST_MODULE_REDIS_AOF_WAIT_STEP_MS * 1000);
+        }
+
+        REQUIRE(strncmp(buffer_recv, "+PONG\r\n", strlen("+PONG\r\n")) == 0);
+    };
+
+    auto program_restart = [&]() {
+        program_stop();
+        config_database.aof = &config_database_aof;
+        program_start();
+        wait_for_loaded();
+    };
+
+    SECTION("Append encoding") {
+        program_restart();
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"APPEND", "a_key", "c_value"},
+                ":14\r\n"));
+
+        // The commands not changing the data are not appended
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"GET", "a_key"},
+                "$14\r\nb_valuec_value\r\n"));
+
+        // Every record is the sequence and the length of the command followed by the command encoded in RESP, the
+        // segments are named after the generation and the index of the worker
+        REQUIRE(test_module_redis_aof_read_file(segment_path) ==
+                test_module_redis_aof_record(1, set_a_key_command) +
+                test_module_redis_aof_record(2, append_a_key_command));
+    }
+
+    SECTION("Fsync policies") {
+        std::string expected_segment = test_module_redis_aof_record(1, set_a_key_command);
+
+        SECTION("Always") {
+            config_database_aof.fsync = CONFIG_DATABASE_AOF_FSYNC_ALWAYS;
+            program_restart();
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+
+            // The reply is sent only once the record has been written and synced
+            REQUIRE(test_module_redis_aof_read_file(segment_path) == expected_segment);
+        }
+
+        SECTION("Everysec") {
+            config_database_aof.fsync = CONFIG_DATABASE_AOF_FSYNC_EVERYSEC;
+            program_restart();
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+
+            // The reply doesn't wait for the record to be written, the flush fiber writes and syncs it within a second
+            REQUIRE(test_module_redis_aof_wait_for_file(segment_path, expected_segment));
+        }
+
+        SECTION("No") {
+            config_database_aof.fsync = CONFIG_DATABASE_AOF_FSYNC_NO;
+            program_restart();
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+
+            // The record is still written by the flush fiber, the sync is left to the kernel
+            REQUIRE(test_module_redis_aof_wait_for_file(segment_path, expected_segment));
+        }
+
+        SECTION("Records written on shutdown") {
+            config_database_aof.fsync = CONFIG_DATABASE_AOF_FSYNC_NO;
+            program_restart();
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+
+            // The records still buffered are written when the worker terminates
+            program_stop();
+            REQUIRE(test_module_redis_aof_read_file(segment_path) == expected_segment);
+
+            config_database.aof = nullptr;
+            program_start();
+        }
+    }
+
+    SECTION("Replay") {
+        SECTION("Records merged by sequence") {
+            // The records of the segments of the different workers are interleaved, the commands have to be applied
+            // following the sequence to get the right value
+            test_module_redis_aof_write_file(
+                    test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "1.0"),
+                    test_module_redis_aof_record(1, "*3\r\n$3\r\nset\r\n$5\r\na_key\r\n$1\r\na\r\n") +
+                    test_module_redis_aof_record(3, "*3\r\n$6\r\nappend\r\n$5\r\na_key\r\n$1\r\nc\r\n") +
+                    test_module_redis_aof_record(4, "*3\r\n$3\r\nset\r\n$5\r\nb_key\r\n$1\r\nd\r\n"));
+            test_module_redis_aof_write_file(
+                    test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "1.1"),
+                    test_module_redis_aof_record(2, "*3\r\n$6\r\nappend\r\n$5\r\na_key\r\n$1\r\nb\r\n") +
+                    test_module_redis_aof_record(5, "*2\r\n$3\r\ndel\r\n$5\r\nb_key\r\n") +
+                    test_module_redis_aof_record(6, "*3\r\n$6\r\nappend\r\n$5\r\na_key\r\n$1\r\nd\r\n"));
+
+            program_restart();
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "a_key"},
+                    "$4\r\nabcd\r\n"));
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"EXISTS", "b_key"},
+                    ":0\r\n"));
+
+            // Once loaded the segments are compacted in the base and deleted, the new records get the next sequence
+            // and are written to the segment of the next generation
+            REQUIRE(access(base_path.c_str(), F_OK) == 0);
+            REQUIRE(access(segment_path.c_str(), F_OK) != 0);
+            REQUIRE(access(
+                    test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "1.1").c_str(),
+                    F_OK) != 0);
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+            REQUIRE(test_module_redis_aof_read_file(
+                    test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "3.0")) ==
+                    test_module_redis_aof_record(7, set_a_key_command));
+        }
+
+        SECTION("Truncated tail") {
+            std::string truncated_record = test_module_redis_aof_record(
+                    3,
+                    "*3\r\n$6\r\nappend\r\n$5\r\na_key\r\n$1\r\nz\r\n");
+            std::string truncated_header = test_module_redis_aof_record(
+                    4,
+                    "*3\r\n$6\r\nappend\r\n$5\r\na_key\r\n$1\r\nz\r\n");
+
+            // The last record of a segment might have been written only partially, both when the header and when
+            // the command have been cut it has to be ignored
+            test_module_redis_aof_write_file(
+                    test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "1.0"),
+                    test_module_redis_aof_record(1, "*3\r\n$3\r\nset\r\n$5\r\na_key\r\n$1\r\na\r\n") +
+                    truncated_record.substr(0, truncated_record.length() - 5));
+            test_module_redis_aof_write_file(
+                    test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "1.1"),
+                    test_module_redis_aof_record(2, "*3\r\n$6\r\nappend\r\n$5\r\na_key\r\n$1\r\nb\r\n") +
+                    truncated_header.substr(0, sizeof(module_redis_aof_record_header_t) - 4));
+
+            program_restart();
+
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"GET", "a_key"},
+                    "$2\r\nab\r\n"));
+
+            // The sequence restarts from the last record applied
+            REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                    std::vector<std::string>{"SET", "a_key", "b_value"},
+                    "+OK\r\n"));
+            REQUIRE(test_module_redis_aof_read_file(
+                    test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "3.0")) ==
+                    test_module_redis_aof_record(3, set_a_key_command));
+        }
+    }
+
+    SECTION("BGREWRITEAOF") {
+        module_redis_aof_base_header_t base_header = { 0 };
+
+        program_restart();
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "a_key", "b_value"},
+                "+OK\r\n"));
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "b_key", "c_value"},
+                "+OK\r\n"));
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"BGREWRITEAOF"},
+                "+Background append only file rewriting started\r\n"));
+
+        // The base is renamed in place only once it has been entirely written and synced
+        REQUIRE(test_module_redis_aof_wait_for_file_exists(base_path, true));
+
+        std::string base = test_module_redis_aof_read_file(base_path);
+        REQUIRE(base.length() > sizeof(base_header));
+        memcpy(&base_header, base.c_str(), sizeof(base_header));
+
+        // The base contains the commands to rebuild the data up to the sequence recorded in the header
+        REQUIRE(strncmp(base_header.magic, MODULE_REDIS_AOF_BASE_MAGIC, sizeof(base_header.magic)) == 0);
+        REQUIRE(base_header.sequence == 2);
+        REQUIRE(base_header.generation == 2);
+        REQUIRE(base.compare(
+                sizeof(base_header),
+                strlen("*1\r\n$7\r\nFLUSHDB\r\n"),
+                "*1\r\n$7\r\nFLUSHDB\r\n") == 0);
+        REQUIRE(base.find("$5\r\na_key\r\n$7\r\nb_value\r\n") != std::string::npos);
+        REQUIRE(base.find("$5\r\nb_key\r\n$7\r\nc_value\r\n") != std::string::npos);
+
+        // The new records go to the segments of the new generation, the old segments are deleted by the next flush
+        // once the rewrite has been completed
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"SET", "c_key", "d_value"},
+                "+OK\r\n"));
+        REQUIRE(test_module_redis_aof_read_file(
+                test_module_redis_aof_path(aof_path, MODULE_REDIS_AOF_SEGMENT_FILENAME_PREFIX "2.0")) ==
+                test_module_redis_aof_record(3, "*3\r\n$3\r\nset\r\n$5\r\nc_key\r\n$7\r\nd_value\r\n"));
+        REQUIRE(test_module_redis_aof_wait_for_file_exists(segment_path, false));
+
+        // The base and the segments are loaded when restarting
+        program_restart();
+
+        REQUIRE(send_recv_resp_command_text_and_validate_recv(
+                std::vector<std::string>{"MGET", "a_key", "b_key", "c_key"},
+                "*3\r\n$7\r\nb_value\r\n$7\r\nc_value\r\n$7\r\nd_value\r\n"));
+    }
+
+    program_stop();
+    config_database.aof = nullptr;
+    program_start();
+
+    test_module_redis_aof_remove_directory(aof_path);
+}
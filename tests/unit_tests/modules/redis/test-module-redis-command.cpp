@@ -33,6 +33,7 @@
 #include "storage/db/storage_db.h"
 #include "protocol/redis/protocol_redis.h"
 #include "protocol/redis/protocol_redis_reader.h"
+#include "protocol/redis/protocol_redis_writer.h"
 #include "module/redis/module_redis.h"
 #include "module/redis/module_redis_connection.h"
 
@@ -178,6 +178,36 @@ TEST_CASE("network/io/network_io_common.c", "[network][network_io][network_io_co
         }
     }
 
+    SECTION("network_io_common_socket_attach_reuseport_cbpf") {
+        SECTION("without cpus map") {
+            int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+            REQUIRE(fd > 0);
+            REQUIRE(network_io_common_socket_set_reuse_port(fd, true));
+            REQUIRE(network_io_common_socket_attach_reuseport_cbpf(fd, NULL, 0));
+
+            close(fd);
+        }
+
+        SECTION("with cpus map") {
+            uint32_t cpus_to_socket_index_map[] = { 1, 0, 1, 0 };
+            int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+            REQUIRE(fd > 0);
+            REQUIRE(network_io_common_socket_set_reuse_port(fd, true));
+            REQUIRE(network_io_common_socket_attach_reuseport_cbpf(
+                    fd,
+                    cpus_to_socket_index_map,
+                    sizeof(cpus_to_socket_index_map) / sizeof(uint32_t)));
+
+            close(fd);
+        }
+
+        SECTION("invalid socket fd") {
+            REQUIRE(!network_io_common_socket_attach_reuseport_cbpf(-1, NULL, 0));
+        }
+    }
+
     SECTION("network_io_common_socket_set_nodelay") {
         SECTION("valid socket fd") {
             int val;
@@ -6,797 +6,335 @@
  * of the BSD license.  See the LICENSE file for details.
  **/
 
-//#include <catch2/catch.hpp>
-//#include <cstring>
-//
-//#include "protocol/redis/protocol_redis_reader.h"
-//
-//
-//TEST_CASE("protocols/redis/protocol_redis_reader.c/inline", "[protocols][redis][protocol_redis_reader][inline]") {
-//    SECTION("protocol_redis_reader_read") {
-//        SECTION("empty command, new line") {
-//            char buffer[] = "\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == strlen(buffer));
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == -1);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("empty command, no new line") {
-//            char buffer[] = "";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, 0, context);
-//
-//            REQUIRE(data_read_len == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_NO_DATA);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("error in context maintained") {
-//            char buffer[] = "HELLO\r\n";
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len1 = protocol_redis_reader_read(buffer_read, 0, context);
-//
-//            REQUIRE(data_read_len1 == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_NO_DATA);
-//
-//            long data_read_len2 = protocol_redis_reader_read(buffer_read, 0, context);
-//
-//            REQUIRE(data_read_len2 == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_NO_DATA);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, no quotes, with new line") {
-//            char buffer[] = "HELLO\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == strlen(buffer));
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 1);
-//            REQUIRE(context->arguments.list[0].length == strlen(buffer) - 2);
-//            REQUIRE(strncmp(context->arguments.list[0].value, buffer, context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, no quotes, without new line") {
-//            char buffer[] = "HELLO";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == strlen(buffer));
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 1);
-//            REQUIRE(context->arguments.list[0].length == strlen(buffer));
-//            REQUIRE(strncmp(context->arguments.list[0].value, buffer, context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.current.beginning == false);
-//            // No new line, the current length is not reset-ed to zero and beginning is not reset-ed to true
-//            REQUIRE(context->arguments.current.length == strlen(buffer));
-//            REQUIRE(context->arguments.current.index == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, single quotes, with new line") {
-//            char buffer[] = "'HELLO'\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == strlen(buffer));
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 1);
-//            REQUIRE(context->arguments.list[0].length == strlen(buffer) - 4);
-//            REQUIRE(strncmp(context->arguments.list[0].value, buffer + 1, context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.index == 0);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.inline_protocol.current.quote_char == '\'');
-//            REQUIRE(context->arguments.inline_protocol.current.decode_escaped_chars == false);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, double quotes, with new line") {
-//            char buffer[] = "\"HELLO\"\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == strlen(buffer));
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 1);
-//            REQUIRE(context->arguments.list[0].length == strlen(buffer) - 4);
-//            REQUIRE(strncmp(context->arguments.list[0].value, buffer + 1, context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == 0);
-//            REQUIRE(context->arguments.inline_protocol.current.quote_char == '"');
-//            REQUIRE(context->arguments.inline_protocol.current.decode_escaped_chars == true);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, double quotes with backslashes, with new line") {
-//            char buffer[] = "\"HELLO\\\"\"\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == strlen(buffer));
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 1);
-//            REQUIRE(context->arguments.list[0].length == strlen(buffer) - 4);
-//            REQUIRE(strncmp(context->arguments.list[0].value, buffer + 1, context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == 0);
-//            REQUIRE(context->arguments.inline_protocol.current.quote_char == '"');
-//            REQUIRE(context->arguments.inline_protocol.current.decode_escaped_chars == true);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, single unbalanced quotes (1), with new line") {
-//            char buffer[] = "'HELLO\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
-//            REQUIRE(context->arguments.count == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == -1);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, single unbalanced quotes (2), with new line") {
-//            char buffer[] = "'HELLO\"\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
-//            REQUIRE(context->arguments.count == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == -1);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, double unbalanced quotes (1), with new line") {
-//            char buffer[] = "\"HELLO\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
-//            REQUIRE(context->arguments.count == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == -1);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, double unbalanced quotes (2), with new line") {
-//            char buffer[] = "\"HELLO'\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
-//            REQUIRE(context->arguments.count == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == -1);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("one argument, double unbalanced quotes with backslashes (2), with new line") {
-//            char buffer[] = "\"HELLO\\\"\r\n";
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len = protocol_redis_reader_read(buffer, strlen(buffer), context);
-//
-//            REQUIRE(data_read_len == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
-//            REQUIRE(context->arguments.count == 0);
-//            REQUIRE(context->arguments.current.beginning == true);
-//            REQUIRE(context->arguments.current.length == 0);
-//            REQUIRE(context->arguments.current.index == -1);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument, no quotes, with new line") {
-//            char buffer[] = "SET mykey myvalue\r\n";
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read1_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read1_len == 4);
-//            // No need to check everything again, already tested
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read1_len;
-//            long data_read2_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read2_len == 6);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 2);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read2_len;
-//            long data_read3_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read3_len == 9);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument, no quotes, without new line") {
-//            char buffer[] = "SET mykey myvalue";
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read1_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read1_len == 4);
-//            // No need to check everything again, already tested
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read1_len;
-//            long data_read2_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read2_len == 6);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 2);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read2_len;
-//            long data_read3_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read3_len == 7);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument, single quotes (1), with new line") {
-//            char buffer[] = "SET 'mykey' myvalue\r\n";
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read1_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read1_len == 4);
-//            // No need to check everything again, already tested
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read1_len;
-//            long data_read2_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read2_len == 8);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 2);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read2_len;
-//            long data_read3_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read3_len == 9);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument, single quotes (2), with new line") {
-//            char buffer[] = "SET 'mykey' 'myvalue'\r\n";
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read1_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read1_len == 4);
-//            // No need to check everything again, already tested
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read1_len;
-//            long data_read2_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read2_len == 8);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 2);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read2_len;
-//            long data_read3_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read3_len == 11);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument, double quotes (1), with new line") {
-//            char buffer[] = "SET \"mykey\" myvalue\r\n";
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read1_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read1_len == 4);
-//            // No need to check everything again, already tested
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read1_len;
-//            long data_read2_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read2_len == 8);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 2);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read2_len;
-//            long data_read3_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read3_len == 9);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument, double quotes (2), with new line") {
-//            char buffer[] = "SET \"mykey\" \"myvalue\"\r\n";
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read1_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read1_len == 4);
-//            // No need to check everything again, already tested
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read1_len;
-//            long data_read2_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read2_len == 8);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 2);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_INLINE_WAITING_ARGUMENT);
-//
-//            buffer_read += data_read2_len;
-//            long data_read3_len = protocol_redis_reader_read(buffer_read, strlen(buffer_read), context);
-//
-//            REQUIRE(data_read3_len == 11);
-//            REQUIRE(context->error == 0);
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument 1 byte at time, no quotes, with new line") {
-//            char buffer[] = "SET mykey myvalue\r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            char* buffer_new = (char*)malloc(buffer_length + 1);
-//            memset(buffer_new, 0, buffer_length + 1);
-//            long buffer_new_length = 0;
-//            long buffer_new_offset = 0;
-//            for(int i = 0; i < buffer_length; i++) {
-//                buffer_new[i] = buffer[i];
-//                buffer_new_length++;
-//
-//                long data_read_len = protocol_redis_reader_read(buffer_new + buffer_new_offset, buffer_new_length - buffer_new_offset, context);
-//                buffer_new_offset += data_read_len;
-//            }
-//
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//            free(buffer_new);
-//        }
-//
-////        SECTION("multiple argument 1 byte at time, no quotes, with new line, clone data") {
-////            // TODO: This test covers an edge case not managed by the parser where the command is sent in very small
-////            //       chunks and the data are not from the buffer, it will try to copy some extra bytes at the end
-////            //       past the end of the buffer.
-////            //       This behaviour is wrong and requires a fix as may trigger a segfault but being a very edgy case
-////            //       can be left on a side and fixed within the next iterations.
-////            char buffer[] = "SET mykey myvalue\r\n";
-////            int buffer_length = strlen(buffer);
-////            char* buffer_read = buffer;
-////
-////            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-////
-////            char* buffer_new = (char*)malloc(buffer_length + 1);
-////            memset(buffer_new, 0, buffer_length + 1);
-////            long buffer_new_length = 0;
-////            long buffer_new_offset = 0;
-////            for(int i = 0; i < buffer_length; i++) {
-////                buffer_new[i] = buffer[i];
-////                buffer_new_length++;
-////
-////                long data_read_len = protocol_redis_reader_read(buffer_new + buffer_new_offset, buffer_new_length - buffer_new_offset, context);
-////                buffer_new_offset += data_read_len;
-////
-////                if (!context->arguments.list[context->arguments.current.index].copied_from_buffer) {
-////                    protocol_redis_reader_context_arguments_clone_current(context);
-////                }
-////            }
-////
-////            REQUIRE(context->arguments.count == 3);
-////            REQUIRE(context->arguments.list[0].length == 3);
-////            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-////            REQUIRE(context->arguments.list[1].length == 5);
-////            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-////            REQUIRE(context->arguments.list[2].length == 7);
-////            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-////            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-////
-////            protocol_redis_reader_context_free(context);
-////            free(buffer_new);
-////        }
-//
-//        SECTION("multiple argument with spaces, no quotes, with new line") {
-//            char buffer[] = " SET   mykey  myvalue   \r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            // The expectation is that the command contained in the buffer will be fully parsed with 3 iterations
-//            // as all the spaces and new lines will be preemptively found and skipped to avoid useless calls.
-//            long buffer_offset = 0;
-//            for(int i = 0; i < 3; i++) {
-//                long data_read_len = protocol_redis_reader_read(
-//                        buffer_read + buffer_offset,
-//                        buffer_length - buffer_offset,
-//                        context);
-//                buffer_offset += data_read_len;
-//            }
-//
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument with spaces, single quotes (1), with new line") {
-//            char buffer[] = " SET   'mykey'  myvalue   \r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            // The expectation is that the command contained in the buffer will be fully parsed with 3 iterations
-//            // as all the spaces and new lines will be preemptively found and skipped to avoid useless calls.
-//            long buffer_offset = 0;
-//            for(int i = 0; i < 3; i++) {
-//                long data_read_len = protocol_redis_reader_read(
-//                        buffer_read + buffer_offset,
-//                        buffer_length - buffer_offset,
-//                        context);
-//                buffer_offset += data_read_len;
-//            }
-//
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument with spaces, single quotes (2), with new line") {
-//            char buffer[] = " SET   'mykey'  'myvalue'   \r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            // The expectation is that the command contained in the buffer will be fully parsed with 3 iterations
-//            // as all the spaces and new lines will be preemptively found and skipped to avoid useless calls.
-//            long buffer_offset = 0;
-//            for(int i = 0; i < 3; i++) {
-//                long data_read_len = protocol_redis_reader_read(
-//                        buffer_read + buffer_offset,
-//                        buffer_length - buffer_offset,
-//                        context);
-//                buffer_offset += data_read_len;
-//            }
-//
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument with spaces, double quotes (1), with new line") {
-//            char buffer[] = " SET   \"mykey\"  myvalue   \r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            // The expectation is that the command contained in the buffer will be fully parsed with 3 iterations
-//            // as all the spaces and new lines will be preemptively found and skipped to avoid useless calls.
-//            long buffer_offset = 0;
-//            for(int i = 0; i < 3; i++) {
-//                long data_read_len = protocol_redis_reader_read(
-//                        buffer_read + buffer_offset,
-//                        buffer_length - buffer_offset,
-//                        context);
-//                buffer_offset += data_read_len;
-//            }
-//
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("multiple argument with spaces, double quotes (2), with new line") {
-//            char buffer[] = " SET   \"mykey\"  \"myvalue\"   \r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            // The expectation is that the command contained in the buffer will be fully parsed with 3 iterations
-//            // as all the spaces and new lines will be preemptively found and skipped to avoid useless calls.
-//            long buffer_offset = 0;
-//            for(int i = 0; i < 3; i++) {
-//                long data_read_len = protocol_redis_reader_read(
-//                        buffer_read + buffer_offset,
-//                        buffer_length - buffer_offset,
-//                        context);
-//                buffer_offset += data_read_len;
-//            }
-//
-//            REQUIRE(context->arguments.count == 3);
-//            REQUIRE(context->arguments.list[0].length == 3);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->arguments.list[1].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-//            REQUIRE(context->arguments.list[2].length == 7);
-//            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-////        SECTION("multiple argument with spaces, 1 byte at time, no quotes, with new line") {
-////            // TODO: This test covers an edge case not managed by the parser where the command has multiple spaces and
-////            //       it's not received in one read, in this case the parser will treat the spaces as data to read and
-////            //       create items in the argument list.
-////            //       This behaviour is wrong and requires a fix but being a very edgy case can be left on a side and
-////            //       fixed within the next iterations.
-////
-////            char buffer[] = " SET   mykey    myvalue      \r\n";
-////            int buffer_length = strlen(buffer);
-////
-////            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-////
-////            char* buffer_new = (char*)malloc(buffer_length + 1);
-////            memset(buffer_new, 0, buffer_length + 1);
-////            unsigned long buffer_new_length = 0;
-////            unsigned long buffer_new_offset = 0;
-////            for(int i = 0; i < buffer_length; i++) {
-////                buffer_new[i] = buffer[i];
-////                buffer_new_length++;
-////
-////                long data_read_len = protocol_redis_reader_read(buffer_new + buffer_new_offset, buffer_new_length - buffer_new_offset, context);
-////                buffer_new_offset += data_read_len;
-////            }
-////
-////            REQUIRE(context->arguments.count == 3);
-////            REQUIRE(context->arguments.list[0].length == 3);
-////            REQUIRE(strncmp(context->arguments.list[0].value, "SET", context->arguments.list[0].length) == 0);
-////            REQUIRE(context->arguments.list[1].length == 5);
-////            REQUIRE(strncmp(context->arguments.list[1].value, "mykey", context->arguments.list[1].length) == 0);
-////            REQUIRE(context->arguments.list[2].length == 7);
-////            REQUIRE(strncmp(context->arguments.list[2].value, "myvalue", context->arguments.list[2].length) == 0);
-////            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-////
-////            protocol_redis_reader_context_free(context);
-////        }
-//
-//        SECTION("single argument, no quotes, with new line, multiple commands") {
-//            char buffer[] = "HELLO\r\nWORLD\r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len1 = protocol_redis_reader_read(buffer_read, buffer_length, context);
-//
-//            REQUIRE(context->arguments.count == 1);
-//            REQUIRE(context->arguments.list[0].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "HELLO", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_reset(context);
-//
-//            protocol_redis_reader_read(buffer_read + data_read_len1, buffer_length, context);
-//
-//            REQUIRE(context->arguments.count == 1);
-//            REQUIRE(context->arguments.list[0].length == 5);
-//            REQUIRE(strncmp(context->arguments.list[0].value, "WORLD", context->arguments.list[0].length) == 0);
-//            REQUIRE(context->state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("single argument, no quotes, with new line, multiple commands, no reset") {
-//            char buffer[] = "HELLO\r\nWORLD\r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            long data_read_len1 = protocol_redis_reader_read(buffer_read, buffer_length, context);
-//            protocol_redis_reader_read(buffer_read + data_read_len1, buffer_length, context);
-//
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_COMMAND_ALREADY_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//
-//        SECTION("error, no quotes, with new line, multiple commands, no reset") {
-//            char buffer[] = "HELLO\r\nWORLD\r\n";
-//            int buffer_length = strlen(buffer);
-//            char* buffer_read = buffer;
-//
-//            protocol_redis_reader_context_t* context = protocol_redis_reader_context_init();
-//
-//            protocol_redis_reader_read(buffer_read, buffer_length, context);
-//            long data_read_len2 = protocol_redis_reader_read(buffer_read, buffer_length, context);
-//
-//            REQUIRE(data_read_len2 == -1);
-//            REQUIRE(context->error == PROTOCOL_REDIS_READER_ERROR_COMMAND_ALREADY_PARSED);
-//
-//            protocol_redis_reader_context_free(context);
-//        }
-//    }
-//}
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <string>
+
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE("protocols/redis/protocol_redis_reader.c/inline", "[protocols][redis][protocol_redis_reader][inline]") {
+    SECTION("protocol_redis_reader_read") {
+        protocol_redis_reader_context_t context;
+        protocol_redis_reader_op_t ops[8] = { };
+        int32_t ops_size = 8;
+
+        memset(&context, 0, sizeof(context));
+
+        SECTION("one argument") {
+            char buffer[] = "PING\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 5);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(context.protocol_type == PROTOCOL_REDIS_READER_PROTOCOL_TYPE_INLINE);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+            REQUIRE(ops[0].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(ops[0].data.command.arguments_count == 1);
+            REQUIRE(ops[1].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN);
+            REQUIRE(ops[1].data.argument.length == 4);
+            REQUIRE(ops[2].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA);
+            REQUIRE(ops[2].data.argument.offset == 0);
+            REQUIRE(ops[2].data.argument.data_length == 4);
+            REQUIRE(ops[3].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END);
+            REQUIRE(ops[4].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+
+            off_t data_read_len = 0;
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                data_read_len += ops[op_index].data_read_len;
+            }
+
+            REQUIRE(data_read_len == strlen(buffer));
+        }
+
+        SECTION("one argument, no carriage return") {
+            char buffer[] = "PING\n";
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 5);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(ops[2].data.argument.data_length == 4);
+            REQUIRE(ops[4].data_read_len == 1);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("multiple arguments, one per invocation") {
+            char buffer[] = "  SET  a_key   b_value  \r\n";
+            const char *expected_arguments[] = { "SET", "a_key", "b_value" };
+            size_t buffer_offset = 0;
+
+            for(int argument_index = 0; argument_index < 3; argument_index++) {
+                int32_t ops_found = protocol_redis_reader_read(
+                        buffer + buffer_offset,
+                        strlen(buffer) - buffer_offset,
+                        &context,
+                        ops,
+                        ops_size);
+
+                REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+
+                for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                    if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN) {
+                        REQUIRE(ops[op_index].data.command.arguments_count == 3);
+                    } else if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA) {
+                        REQUIRE(ops[op_index].data.argument.index == argument_index);
+                        REQUIRE(ops[op_index].data.argument.data_length == strlen(expected_arguments[argument_index]));
+                        REQUIRE(strncmp(
+                                buffer + buffer_offset + ops[op_index].data.argument.offset,
+                                expected_arguments[argument_index],
+                                ops[op_index].data.argument.data_length) == 0);
+                    }
+                }
+
+                for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                    buffer_offset += ops[op_index].data_read_len;
+                }
+            }
+
+            REQUIRE(buffer_offset == strlen(buffer));
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("partial line") {
+            char buffer[] = "GET a_key";
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 0);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_BEGIN);
+        }
+
+        SECTION("empty lines") {
+            char buffer[] = "\r\n \r\n";
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 0);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_BEGIN);
+        }
+
+        SECTION("empty lines before a resp command") {
+            char buffer[] = "\r\n*1\r\n$4\r\nPING\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(context.protocol_type == PROTOCOL_REDIS_READER_PROTOCOL_TYPE_RESP);
+            REQUIRE(ops[0].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(ops[0].data_read_len == 6);
+            REQUIRE(ops[2].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA);
+            REQUIRE(strncmp(buffer + ops[2].data.argument.offset, "PING", ops[2].data.argument.data_length) == 0);
+        }
+
+        SECTION("unbalanced quotes") {
+            char buffer[] = "SET a_key \"b_value\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
+        }
+
+        SECTION("closing quote not followed by a space") {
+            char buffer[] = "SET a_key \"b_value\"c\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
+        }
+
+        SECTION("command too long") {
+            std::string buffer = "SET a_key ";
+            buffer.append(PROTOCOL_REDIS_READER_INLINE_MAX_LENGTH, 'a');
+
+            int32_t ops_found = protocol_redis_reader_read(
+                    (char*)buffer.c_str(),
+                    buffer.length(),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_INLINE_COMMAND_TOO_LONG);
+        }
+    }
+
+    SECTION("protocol_redis_reader_read_batch") {
+        protocol_redis_reader_context_t context;
+        protocol_redis_reader_op_t ops[64] = { };
+        int32_t ops_size = 64;
+
+        memset(&context, 0, sizeof(context));
+
+        SECTION("multiple arguments") {
+            char buffer[] = "SET a_key b_value\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 11);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(ops[0].data.command.arguments_count == 3);
+            REQUIRE(strncmp(buffer + ops[2].data.argument.offset, "SET", ops[2].data.argument.data_length) == 0);
+            REQUIRE(strncmp(buffer + ops[5].data.argument.offset, "a_key", ops[5].data.argument.data_length) == 0);
+            REQUIRE(strncmp(buffer + ops[8].data.argument.offset, "b_value", ops[8].data.argument.data_length) == 0);
+            REQUIRE(ops[10].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("quotes and escape sequences") {
+            char buffer[] = "SET \"a key\" \"b\\x41\\n\\\"c\\\"\" 'd\\'e' \"\"\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 17);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(ops[0].data.command.arguments_count == 5);
+
+            // The arguments are decoded in place, the offsets point to the decoded data
+            REQUIRE(ops[5].data.argument.data_length == 5);
+            REQUIRE(strncmp(buffer + ops[5].data.argument.offset, "a key", 5) == 0);
+            REQUIRE(ops[8].data.argument.data_length == 6);
+            REQUIRE(strncmp(buffer + ops[8].data.argument.offset, "bA\n\"c\"", 6) == 0);
+            REQUIRE(ops[11].data.argument.data_length == 3);
+            REQUIRE(strncmp(buffer + ops[11].data.argument.offset, "d'e", 3) == 0);
+            REQUIRE(ops[14].data.argument.data_length == 0);
+
+            off_t data_read_len = 0;
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                data_read_len += ops[op_index].data_read_len;
+            }
+
+            REQUIRE(data_read_len == strlen(buffer));
+        }
+
+        SECTION("pipelined commands and empty lines") {
+            char buffer[] = "GET a\r\n\r\nGET b\n  \r\nPING\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 21);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(strncmp(buffer + ops[5].data.argument.offset, "a", ops[5].data.argument.data_length) == 0);
+            REQUIRE(ops[8].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(strncmp(buffer + ops[13].data.argument.offset, "b", ops[13].data.argument.data_length) == 0);
+            REQUIRE(ops[16].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(strncmp(buffer + ops[18].data.argument.offset, "PING", ops[18].data.argument.data_length) == 0);
+            REQUIRE(ops[20].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+
+            off_t data_read_len = 0;
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                data_read_len += ops[op_index].data_read_len;
+            }
+
+            REQUIRE(data_read_len == strlen(buffer));
+        }
+
+        SECTION("multiple commands, 1 byte at time") {
+            char buffer[] = "GET a\r\nSET b 'c d'\r\n";
+            size_t buffer_length = strlen(buffer);
+            size_t buffer_offset = 0;
+            uint32_t commands_end_found = 0;
+            uint32_t arguments_end_found = 0;
+
+            for(size_t buffer_available = 1; buffer_available <= buffer_length; buffer_available++) {
+                int32_t ops_found = protocol_redis_reader_read_batch(
+                        buffer + buffer_offset,
+                        buffer_available - buffer_offset,
+                        &context,
+                        ops,
+                        ops_size);
+
+                REQUIRE(ops_found != -1);
+                REQUIRE(context.error == 0);
+
+                for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                    buffer_offset += ops[op_index].data_read_len;
+
+                    if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END) {
+                        arguments_end_found++;
+                    } else if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END) {
+                        commands_end_found++;
+                    }
+                }
+            }
+
+            REQUIRE(buffer_offset == buffer_length);
+            REQUIRE(arguments_end_found == 5);
+            REQUIRE(commands_end_found == 2);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("multiple commands, error in the second command") {
+            char buffer[] = "GET a\r\nGET 'b\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            // The ops of the first command are returned, the error is reported by the next invocation
+            REQUIRE(ops_found == 8);
+            REQUIRE(ops[7].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_INLINE_UNBALANCED_QUOTES);
+        }
+    }
+}
@@ -0,0 +1,378 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+#include <cstring>
+
+#include "misc.h"
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_reader.h"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+#define TEST_PROTOCOL_REDIS_READER_INDEX_NEWLINES_PLATFORM_DEPENDENT(SUFFIX) \
+    SECTION("protocol_redis_reader_index_newlines" STRINGIZE(SUFFIX)) { \
+        uint32_t newlines[8] = { 0 }; \
+        size_t scanned_length = 0; \
+        \
+        SECTION("no new lines") { \
+            char buffer[] = "no new lines in this buffer, it has to be longer than 64 bytes to use the vectors"; \
+            REQUIRE(protocol_redis_reader_index_newlines##SUFFIX( \
+                    buffer, strlen(buffer), newlines, 8, &scanned_length) == 0); \
+            REQUIRE(scanned_length == strlen(buffer)); \
+        } \
+        \
+        SECTION("new lines in the vectors and in the tail") { \
+            char buffer[] = "*2\r\n$3\r\nGET\r\n$5\r\nHELLO\r\n................................................\n...\n"; \
+            REQUIRE(protocol_redis_reader_index_newlines##SUFFIX( \
+                    buffer, strlen(buffer), newlines, 8, &scanned_length) == 7); \
+            REQUIRE(scanned_length == strlen(buffer)); \
+            REQUIRE(newlines[0] == 3); \
+            REQUIRE(newlines[1] == 7); \
+            REQUIRE(newlines[2] == 12); \
+            REQUIRE(newlines[3] == 16); \
+            REQUIRE(newlines[4] == 23); \
+            REQUIRE(newlines[5] == 72); \
+            REQUIRE(newlines[6] == 76); \
+        } \
+        \
+        SECTION("more new lines than the index size") { \
+            char buffer[] = "\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n"; \
+            REQUIRE(protocol_redis_reader_index_newlines##SUFFIX( \
+                    buffer, strlen(buffer), newlines, 8, &scanned_length) == 8); \
+            REQUIRE(scanned_length == 8); \
+            for(uint32_t index = 0; index < 8; index++) { \
+                REQUIRE(newlines[index] == index); \
+            } \
+        } \
+    }
+
+TEST_CASE("protocols/redis/protocol_redis_reader.c/resp-batch", "[protocols][redis][protocol_redis_reader][resp]") {
+#if defined(__x86_64__)
+#if CACHEGRAND_CMAKE_CONFIG_ENABLE_SUPPORT_AVX512F == 1 && CACHEGRAND_CMAKE_CONFIG_HOST_HAS_AVX512F == 1
+    TEST_PROTOCOL_REDIS_READER_INDEX_NEWLINES_PLATFORM_DEPENDENT(_avx512bw)
+#endif
+#if CACHEGRAND_CMAKE_CONFIG_HOST_HAS_AVX2 == 1
+    TEST_PROTOCOL_REDIS_READER_INDEX_NEWLINES_PLATFORM_DEPENDENT(_avx2)
+#endif
+#endif
+    TEST_PROTOCOL_REDIS_READER_INDEX_NEWLINES_PLATFORM_DEPENDENT(_sw)
+    TEST_PROTOCOL_REDIS_READER_INDEX_NEWLINES_PLATFORM_DEPENDENT()
+
+    SECTION("protocol_redis_reader_read_batch") {
+        protocol_redis_reader_context_t context;
+        protocol_redis_reader_op_t ops[64] = { };
+        int32_t ops_size = 64;
+
+        memset(&context, 0, sizeof(context));
+
+        SECTION("empty array") {
+            char buffer[] = "*0\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH);
+        }
+
+        SECTION("invalid length array") {
+            char buffer[] = "*+1\r\n$5\r\nHELLO\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_ARRAY_INVALID_LENGTH);
+        }
+
+        SECTION("inline command followed by a resp command") {
+            char buffer[] = "PING\r\n*1\r\n$4\r\nPING\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == 10);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_OK);
+            REQUIRE(context.protocol_type == PROTOCOL_REDIS_READER_PROTOCOL_TYPE_RESP);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+
+            REQUIRE(ops[0].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(ops[2].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA);
+            REQUIRE(ops[2].data.argument.offset == 0);
+            REQUIRE(ops[2].data.argument.data_length == 4);
+            REQUIRE(ops[4].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+            REQUIRE(ops[4].data_read_len == 2);
+            REQUIRE(ops[5].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(ops[7].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA);
+            REQUIRE(ops[7].data.argument.offset == 14);
+            REQUIRE(ops[9].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+        }
+
+        SECTION("one argument, malformed, argument negative length") {
+            char buffer[] = "*1\r\n$-1\r\nHELLO\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_INVALID_LENGTH);
+        }
+
+        SECTION("one argument, malformed, argument incorrect length wrong signature") {
+            char buffer[] = "*1\r\n$3\r\nHELLO\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_MISSING_END_SIGNATURE);
+        }
+
+        SECTION("one argument, all the ops in one invocation") {
+            char buffer[] = "*2\r\n$5\r\nHELLO\r\n$8\r\nNEWWORLD\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            off_t data_read_len = 0;
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                data_read_len += ops[op_index].data_read_len;
+            }
+
+            REQUIRE(context.error == 0);
+            REQUIRE(ops_found == 8);
+            REQUIRE(data_read_len == strlen(buffer));
+            REQUIRE(ops[0].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(ops[0].data.command.arguments_count == 2);
+            REQUIRE(ops[2].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA);
+            REQUIRE(strncmp(buffer + ops[2].data.argument.offset, "HELLO", ops[2].data.argument.length) == 0);
+            REQUIRE(ops[5].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA);
+            REQUIRE(strncmp(buffer + ops[5].data.argument.offset, "NEWWORLD", ops[5].data.argument.length) == 0);
+            REQUIRE(ops[7].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("multiple commands in one invocation") {
+            char buffer[] = "*2\r\n$5\r\nFIRST\r\n$8\r\nARGUMENT\r\n*3\r\n$3\r\nFOR\r\n$2\r\nAN\r\n$12\r\nHELLO WORLD!\r\n";
+            protocol_redis_reader_op_type_t expected_op_types[] = {
+                    PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END,
+                    PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END,
+                    PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_BEGIN,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA,
+                    PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END,
+                    PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END,
+            };
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(context.error == 0);
+            REQUIRE(ops_found == sizeof(expected_op_types) / sizeof(protocol_redis_reader_op_type_t));
+
+            off_t data_read_len = 0;
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                REQUIRE(ops[op_index].type == expected_op_types[op_index]);
+                data_read_len += ops[op_index].data_read_len;
+            }
+
+            REQUIRE(data_read_len == strlen(buffer));
+            REQUIRE(ops[8].data.command.arguments_count == 3);
+            REQUIRE(strncmp(buffer + ops[13].data.argument.offset, "AN", ops[13].data.argument.length) == 0);
+            REQUIRE(strncmp(buffer + ops[16].data.argument.offset, "HELLO WORLD!", ops[16].data.argument.length) == 0);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("multiple commands, ops full") {
+            char buffer[] = "*2\r\n$3\r\nGET\r\n$1\r\na\r\n*2\r\n$3\r\nGET\r\n$1\r\nb\r\n";
+            protocol_redis_reader_op_t ops_small[10] = { };
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops_small,
+                    10);
+
+            // The first command is parsed entirely, the second is not started as there isn't enough space
+            REQUIRE(context.error == 0);
+            REQUIRE(ops_found == 8);
+            REQUIRE(ops_small[7].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+
+            off_t data_read_len = 0;
+            for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                data_read_len += ops_small[op_index].data_read_len;
+            }
+
+            // The context is reset automatically when the next command is parsed
+            ops_found = protocol_redis_reader_read_batch(
+                    buffer + data_read_len,
+                    strlen(buffer) - data_read_len,
+                    &context,
+                    ops_small,
+                    10);
+
+            REQUIRE(context.error == 0);
+            REQUIRE(ops_found == 8);
+            REQUIRE(ops_small[0].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_BEGIN);
+            REQUIRE(strncmp(
+                    buffer + data_read_len + ops_small[5].data.argument.offset,
+                    "b",
+                    ops_small[5].data.argument.length) == 0);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("multiple commands, error in the second command") {
+            char buffer[] = "*2\r\n$3\r\nGET\r\n$1\r\na\r\n*2\r\n$3\r\nGET\r\n$1\r\nbc\r\n";
+
+            int32_t ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            // The ops of the first command are returned, the error is reported by the next invocation
+            REQUIRE(ops_found == 8);
+            REQUIRE(ops[7].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END);
+            REQUIRE(context.error == PROTOCOL_REDIS_READER_ERROR_ARGS_BLOB_STRING_MISSING_END_SIGNATURE);
+
+            ops_found = protocol_redis_reader_read_batch(
+                    buffer,
+                    strlen(buffer),
+                    &context,
+                    ops,
+                    ops_size);
+
+            REQUIRE(ops_found == -1);
+        }
+
+        SECTION("multiple commands, 1 byte at time") {
+            char buffer[] = "*2\r\n$3\r\nGET\r\n$1\r\na\r\n*3\r\n$3\r\nSET\r\n$1\r\nb\r\n$2\r\nAN\r\n";
+            size_t buffer_length = strlen(buffer);
+            size_t buffer_offset = 0;
+            uint32_t commands_end_found = 0;
+            uint32_t arguments_end_found = 0;
+
+            for(size_t buffer_available = 1; buffer_available <= buffer_length; buffer_available++) {
+                int32_t ops_found = protocol_redis_reader_read_batch(
+                        buffer + buffer_offset,
+                        buffer_available - buffer_offset,
+                        &context,
+                        ops,
+                        ops_size);
+
+                REQUIRE(ops_found != -1);
+                REQUIRE(context.error == 0);
+
+                for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                    buffer_offset += ops[op_index].data_read_len;
+
+                    if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_END) {
+                        arguments_end_found++;
+                    } else if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END) {
+                        commands_end_found++;
+                    }
+                }
+            }
+
+            REQUIRE(buffer_offset == buffer_length);
+            REQUIRE(arguments_end_found == 5);
+            REQUIRE(commands_end_found == 2);
+            REQUIRE(context.state == PROTOCOL_REDIS_READER_STATE_COMMAND_PARSED);
+        }
+
+        SECTION("many commands, more new lines than the index size") {
+            char command[] = "*2\r\n$3\r\nGET\r\n$5\r\nHELLO\r\n";
+            size_t command_length = strlen(command);
+            uint32_t commands_count = 64;
+            size_t buffer_length = command_length * commands_count;
+            char *buffer = (char*)malloc(buffer_length);
+            size_t buffer_offset = 0;
+            uint32_t commands_end_found = 0;
+
+            for(uint32_t index = 0; index < commands_count; index++) {
+                memcpy(buffer + (command_length * index), command, command_length);
+            }
+
+            while(buffer_offset < buffer_length) {
+                int32_t ops_found = protocol_redis_reader_read_batch(
+                        buffer + buffer_offset,
+                        buffer_length - buffer_offset,
+                        &context,
+                        ops,
+                        ops_size);
+
+                REQUIRE(ops_found > 0);
+                REQUIRE(context.error == 0);
+
+                for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                    if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_ARGUMENT_DATA &&
+                        ops[op_index].data.argument.index == 1) {
+                        REQUIRE(strncmp(
+                                buffer + buffer_offset + ops[op_index].data.argument.offset,
+                                "HELLO",
+                                ops[op_index].data.argument.length) == 0);
+                    } else if (ops[op_index].type == PROTOCOL_REDIS_READER_OP_TYPE_COMMAND_END) {
+                        commands_end_found++;
+                    }
+                }
+
+                for(int32_t op_index = 0; op_index < ops_found; op_index++) {
+                    buffer_offset += ops[op_index].data_read_len;
+                }
+            }
+
+            REQUIRE(commands_end_found == commands_count);
+
+            free(buffer);
+        }
+    }
+}
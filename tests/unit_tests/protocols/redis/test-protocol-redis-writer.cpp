@@ -0,0 +1,180 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <cmath>
+#include <string>
+
+#include "protocol/redis/protocol_redis.h"
+#include "protocol/redis/protocol_redis_writer.h"
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+#define TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(BUFFER, BUFFER_END, EXPECTED) { \
+    REQUIRE(BUFFER_END != nullptr); \
+    REQUIRE(std::string(BUFFER, BUFFER_END - BUFFER) == EXPECTED); \
+}
+
+TEST_CASE("protocols/redis/protocol_redis_writer.c", "[protocols][redis][protocol_redis_writer]") {
+    char buffer[8192] = { 0 };
+    char *buffer_end;
+
+    SECTION("protocol_redis_writer_write_blob_string") {
+        SECTION("empty string") {
+            buffer_end = protocol_redis_writer_write_blob_string(buffer, sizeof(buffer), "", 0);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "$0\r\n\r\n");
+        }
+
+        SECTION("small string, precomputed header") {
+            buffer_end = protocol_redis_writer_write_blob_string(buffer, sizeof(buffer), "b_value", 7);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "$7\r\nb_value\r\n");
+        }
+
+        SECTION("last precomputed header and first not precomputed") {
+            std::string string_precomputed(PROTOCOL_REDIS_WRITER_PRECOMPUTED_NUMBERS_COUNT - 1, 'a');
+            std::string string_not_precomputed(PROTOCOL_REDIS_WRITER_PRECOMPUTED_NUMBERS_COUNT, 'a');
+
+            buffer_end = protocol_redis_writer_write_blob_string(
+                    buffer,
+                    sizeof(buffer),
+                    (char*)string_precomputed.c_str(),
+                    (int)string_precomputed.length());
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(
+                    buffer,
+                    buffer_end,
+                    "$" + std::to_string(string_precomputed.length()) + "\r\n" + string_precomputed + "\r\n");
+
+            buffer_end = protocol_redis_writer_write_blob_string(
+                    buffer,
+                    sizeof(buffer),
+                    (char*)string_not_precomputed.c_str(),
+                    (int)string_not_precomputed.length());
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(
+                    buffer,
+                    buffer_end,
+                    "$" + std::to_string(string_not_precomputed.length()) + "\r\n" + string_not_precomputed + "\r\n");
+        }
+
+        SECTION("not enough space") {
+            REQUIRE(protocol_redis_writer_write_blob_string(buffer, 12, "b_value", 7) == nullptr);
+            REQUIRE(protocol_redis_writer_write_blob_string(buffer, 14, "b_value", 7) != nullptr);
+        }
+    }
+
+    SECTION("protocol_redis_writer_write_blob_string_null") {
+        buffer_end = protocol_redis_writer_write_blob_string_null(buffer, sizeof(buffer));
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "$-1\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_array_null") {
+        buffer_end = protocol_redis_writer_write_array_null(buffer, sizeof(buffer));
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "*-1\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_null") {
+        buffer_end = protocol_redis_writer_write_null(buffer, sizeof(buffer));
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "_\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_ok") {
+        buffer_end = protocol_redis_writer_write_ok(buffer, sizeof(buffer));
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "+OK\r\n");
+
+        REQUIRE(protocol_redis_writer_write_ok(buffer, 5) == nullptr);
+    }
+
+    SECTION("protocol_redis_writer_write_number") {
+        SECTION("zero") {
+            buffer_end = protocol_redis_writer_write_number(buffer, sizeof(buffer), 0);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ":0\r\n");
+        }
+
+        SECTION("small number") {
+            buffer_end = protocol_redis_writer_write_number(buffer, sizeof(buffer), 42);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ":42\r\n");
+        }
+
+        SECTION("big number") {
+            buffer_end = protocol_redis_writer_write_number(buffer, sizeof(buffer), 1234567890123);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ":1234567890123\r\n");
+        }
+
+        SECTION("negative number") {
+            buffer_end = protocol_redis_writer_write_number(buffer, sizeof(buffer), -42);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ":-42\r\n");
+        }
+    }
+
+    SECTION("protocol_redis_writer_write_array") {
+        buffer_end = protocol_redis_writer_write_array(buffer, sizeof(buffer), 3);
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "*3\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_map") {
+        buffer_end = protocol_redis_writer_write_map(buffer, sizeof(buffer), 7);
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "%7\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_set") {
+        buffer_end = protocol_redis_writer_write_set(buffer, sizeof(buffer), 100000);
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "~100000\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_push") {
+        buffer_end = protocol_redis_writer_write_push(buffer, sizeof(buffer), 3);
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ">3\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_attribute") {
+        buffer_end = protocol_redis_writer_write_attribute(buffer, sizeof(buffer), 1);
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "|1\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_boolean") {
+        buffer_end = protocol_redis_writer_write_boolean(buffer, sizeof(buffer), true);
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, "#t\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_big_number") {
+        buffer_end = protocol_redis_writer_write_big_number(
+                buffer,
+                sizeof(buffer),
+                "3492890328409238509324850943850943825024385",
+                43);
+        TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(
+                buffer,
+                buffer_end,
+                "(3492890328409238509324850943850943825024385\r\n");
+    }
+
+    SECTION("protocol_redis_writer_write_double") {
+        SECTION("integer") {
+            buffer_end = protocol_redis_writer_write_double(buffer, sizeof(buffer), 10);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ",10\r\n");
+        }
+
+        SECTION("with fraction") {
+            buffer_end = protocol_redis_writer_write_double(buffer, sizeof(buffer), 1.5);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ",1.5\r\n");
+        }
+
+        SECTION("infinite") {
+            buffer_end = protocol_redis_writer_write_double(buffer, sizeof(buffer), INFINITY);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ",inf\r\n");
+
+            buffer_end = protocol_redis_writer_write_double(buffer, sizeof(buffer), -INFINITY);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ",-inf\r\n");
+        }
+
+        SECTION("nan") {
+            buffer_end = protocol_redis_writer_write_double(buffer, sizeof(buffer), NAN);
+            TEST_PROTOCOL_REDIS_WRITER_REQUIRE_WRITTEN(buffer, buffer_end, ",nan\r\n");
+        }
+    }
+}
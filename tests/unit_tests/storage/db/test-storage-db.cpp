@@ -0,0 +1,346 @@
+/**
+ * Copyright (C) 2018-2022 Daniele Salvatore Albano
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ **/
+
+#include <catch2/catch.hpp>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "misc.h"
+#include "exttypes.h"
+#include "clock.h"
+#include "xalloc.h"
+#include "spinlock.h"
+#include "transaction.h"
+#include "transaction_spinlock.h"
+#include "data_structures/ring_bounded_queue_spsc/ring_bounded_queue_spsc_uint128.h"
+#include "data_structures/double_linked_list/double_linked_list.h"
+#include "data_structures/queue_mpmc/queue_mpmc.h"
+#include "data_structures/hashtable/mcmp/hashtable.h"
+#include "memory_allocator/ffma.h"
+#include "epoch_gc.h"
+#include "config.h"
+#include "fiber/fiber.h"
+#include "worker/worker_stats.h"
+#include "worker/worker_context.h"
+#include "storage/io/storage_io_common.h"
+#include "storage/channel/storage_channel.h"
+#include "storage/db/storage_db.h"
+
+bool test_storage_db_set_value(
+        storage_db_t *db,
+        char *key,
+        char *value,
+        storage_db_expiry_time_ms_t expiry_time_ms) {
+    size_t key_length = strlen(key);
+    size_t value_length = strlen(value);
+
+    storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_allocate(db, value_length);
+    if (!chunk_sequence) {
+        return false;
+    }
+
+    if (!storage_db_chunk_write(db, storage_db_chunk_sequence_get(chunk_sequence, 0), 0, value, value_length)) {
+        return false;
+    }
+
+    // The hashtable takes ownership of the key so a copy is passed
+    char *key_copy = (char*)xalloc_alloc(key_length + 1);
+    strncpy(key_copy, key, key_length + 1);
+
+    return storage_db_op_set(
+            db,
+            key_copy,
+            key_length,
+            STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+            chunk_sequence,
+            expiry_time_ms);
+}
+
+void test_storage_db_epoch_gc_threads_register(
+        epoch_gc_t **epoch_gcs,
+        epoch_gc_thread_t **epoch_gc_threads) {
+    for(
+            epoch_gc_object_type_t object_type = EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+            object_type <= EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
+            object_type = (epoch_gc_object_type_t)(object_type + 1)) {
+        epoch_gcs[object_type] = epoch_gc_init(object_type);
+        epoch_gc_threads[object_type] = epoch_gc_thread_init();
+        epoch_gc_thread_advance_epoch_tsc(epoch_gc_threads[object_type]);
+
+        epoch_gc_thread_register_global(epoch_gcs[object_type], epoch_gc_threads[object_type]);
+        epoch_gc_thread_register_local(epoch_gc_threads[object_type]);
+    }
+}
+
+void test_storage_db_epoch_gc_threads_unregister(
+        epoch_gc_t **epoch_gcs,
+        epoch_gc_thread_t **epoch_gc_threads) {
+    for(
+            epoch_gc_object_type_t object_type = EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XSMALL;
+            object_type <= EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE;
+            object_type = (epoch_gc_object_type_t)(object_type + 1)) {
+        // Free the staged entry indexes before getting rid of the epoch gc
+        epoch_gc_thread_advance_epoch_tsc(epoch_gc_threads[object_type]);
+        epoch_gc_thread_collect_all(epoch_gc_threads[object_type]);
+
+        epoch_gc_thread_unregister_local(epoch_gc_threads[object_type]);
+        epoch_gc_thread_unregister_global(epoch_gc_threads[object_type]);
+        epoch_gc_thread_free(epoch_gc_threads[object_type]);
+        epoch_gc_free(epoch_gcs[object_type]);
+    }
+}
+
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+
+TEST_CASE("storage/db/storage_db.c", "[storage][storage_db]") {
+    char key[] = "a_key";
+    char value[] = "a_value";
+    worker_context_t worker_context = { 0 };
+    epoch_gc_t *epoch_gcs[EPOCH_GC_OBJECT_TYPE_MAX] = { nullptr };
+    epoch_gc_thread_t *epoch_gc_threads[EPOCH_GC_OBJECT_TYPE_MAX] = { nullptr };
+
+    worker_context.worker_index = 0;
+    worker_context_set(&worker_context);
+    transaction_set_worker_index(worker_context.worker_index);
+
+    storage_db_config_t *db_config = storage_db_config_new();
+    db_config->max_keys = 1024;
+    db_config->backend_type = STORAGE_DB_BACKEND_TYPE_MEMORY;
+    storage_db_t *db = storage_db_new(db_config, 1);
+    REQUIRE(db != nullptr);
+    REQUIRE(storage_db_open(db));
+
+    SECTION("storage_db_can_read_unpinned") {
+        SECTION("no epoch gc registered") {
+            // The entry indexes would be freed right away when deleted, the readers have to pin them
+            REQUIRE(!storage_db_can_read_unpinned(db));
+        }
+
+        SECTION("epoch gc registered") {
+            test_storage_db_epoch_gc_threads_register(epoch_gcs, epoch_gc_threads);
+
+            REQUIRE(storage_db_can_read_unpinned(db));
+
+            test_storage_db_epoch_gc_threads_unregister(epoch_gcs, epoch_gc_threads);
+        }
+    }
+
+    SECTION("storage_db_get_entry_index_for_read_unpinned") {
+        test_storage_db_epoch_gc_threads_register(epoch_gcs, epoch_gc_threads);
+
+        SECTION("key not found") {
+            REQUIRE(storage_db_get_entry_index_for_read_unpinned(db, key, strlen(key)) == nullptr);
+        }
+
+        SECTION("key found") {
+            REQUIRE(test_storage_db_set_value(db, key, value, STORAGE_DB_ENTRY_NO_EXPIRY));
+
+            storage_db_entry_index_t *entry_index = storage_db_get_entry_index_for_read_unpinned(
+                    db,
+                    key,
+                    strlen(key));
+
+            REQUIRE(entry_index != nullptr);
+            REQUIRE((uint32_t)entry_index->status.readers_counter == 0);
+            REQUIRE(entry_index->value->size == strlen(value));
+            REQUIRE(strncmp(
+                    (char*)storage_db_chunk_sequence_get(entry_index->value, 0)->memory.chunk_data,
+                    value,
+                    strlen(value)) == 0);
+        }
+
+        SECTION("key expired") {
+            REQUIRE(test_storage_db_set_value(db, key, value, clock_realtime_coarse_int64_ms() - 1000));
+
+            REQUIRE(storage_db_get_entry_index_for_read_unpinned(db, key, strlen(key)) == nullptr);
+
+            // The expired key is deleted falling back on the pinned read
+            REQUIRE(storage_db_op_get_size(db) == 0);
+            REQUIRE(storage_db_get_entry_index(db, key, strlen(key)) == nullptr);
+        }
+
+        SECTION("key deleted") {
+            REQUIRE(test_storage_db_set_value(db, key, value, STORAGE_DB_ENTRY_NO_EXPIRY));
+
+            // An entry index already marked as deleted, but still in the hashtable, is never returned
+            storage_db_entry_index_t *entry_index = storage_db_get_entry_index(db, key, strlen(key));
+            REQUIRE(entry_index != nullptr);
+
+            storage_db_entry_index_status_set_deleted(entry_index, true, nullptr);
+            REQUIRE(storage_db_get_entry_index_for_read_unpinned(db, key, strlen(key)) == nullptr);
+            storage_db_entry_index_status_set_deleted(entry_index, false, nullptr);
+        }
+
+        SECTION("pin fallback") {
+            REQUIRE(test_storage_db_set_value(db, key, value, STORAGE_DB_ENTRY_NO_EXPIRY));
+
+            storage_db_entry_index_t *entry_index = storage_db_get_entry_index_for_read_unpinned(
+                    db,
+                    key,
+                    strlen(key));
+            REQUIRE(entry_index != nullptr);
+
+            SECTION("entry index still alive") {
+                // The entry index has to be pinned if the reader might yield
+                REQUIRE(storage_db_entry_index_status_try_increase_readers_counter(entry_index));
+                REQUIRE((uint32_t)entry_index->status.readers_counter == 1);
+
+                storage_db_entry_index_status_decrease_readers_counter(entry_index, nullptr);
+                REQUIRE((uint32_t)entry_index->status.readers_counter == 0);
+            }
+
+            SECTION("entry index deleted in the meantime") {
+                // The entry index can't be pinned anymore, the reader has to treat the key as not found
+                storage_db_entry_index_status_set_deleted(entry_index, true, nullptr);
+                REQUIRE(!storage_db_entry_index_status_try_increase_readers_counter(entry_index));
+                REQUIRE((uint32_t)entry_index->status.readers_counter == 0);
+                storage_db_entry_index_status_set_deleted(entry_index, false, nullptr);
+            }
+        }
+
+        test_storage_db_epoch_gc_threads_unregister(epoch_gcs, epoch_gc_threads);
+    }
+
+    SECTION("storage_db_chunk_sequence_allocate_entry_index_value") {
+        SECTION("small value stored") {
+            storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_allocate_entry_index_value(
+                    db,
+                    strlen(value));
+            REQUIRE(chunk_sequence != nullptr);
+            REQUIRE(chunk_sequence->entry_index_value);
+            REQUIRE(storage_db_chunk_write(
+                    db,
+                    storage_db_chunk_sequence_get(chunk_sequence, 0),
+                    0,
+                    value,
+                    strlen(value)));
+
+            char *key_copy = (char*)xalloc_alloc(strlen(key) + 1);
+            strncpy(key_copy, key, strlen(key) + 1);
+            REQUIRE(storage_db_op_set(
+                    db,
+                    key_copy,
+                    strlen(key),
+                    STORAGE_DB_ENTRY_INDEX_VALUE_TYPE_STRING,
+                    chunk_sequence,
+                    STORAGE_DB_ENTRY_NO_EXPIRY));
+
+            // The entry index allocated together with the value is stored, the value isn't copied
+            storage_db_entry_index_t *entry_index = storage_db_get_entry_index(db, key, strlen(key));
+            REQUIRE(entry_index != nullptr);
+            REQUIRE(entry_index->value == chunk_sequence);
+            REQUIRE(storage_db_entry_index_has_embedded_value(entry_index));
+            REQUIRE(entry_index->value->size == strlen(value));
+            REQUIRE(strncmp(
+                    (char*)storage_db_chunk_sequence_get(entry_index->value, 0)->memory.chunk_data,
+                    value,
+                    strlen(value)) == 0);
+        }
+
+        SECTION("small value not stored") {
+            storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_allocate_entry_index_value(
+                    db,
+                    strlen(value));
+            REQUIRE(chunk_sequence != nullptr);
+
+            // The entry index allocated together with the value is freed with it
+            storage_db_chunk_sequence_free(db, chunk_sequence);
+        }
+
+        SECTION("large value") {
+            storage_db_chunk_sequence_t *chunk_sequence = storage_db_chunk_sequence_allocate_entry_index_value(
+                    db,
+                    STORAGE_DB_CHUNK_EMBEDDED_MAX_SIZE + 1);
+            REQUIRE(chunk_sequence != nullptr);
+            REQUIRE(!chunk_sequence->entry_index_value);
+
+            storage_db_chunk_sequence_free(db, chunk_sequence);
+            ffma_mem_free(chunk_sequence);
+        }
+    }
+
+    storage_db_close(db);
+    storage_db_free(db, 1);
+}
+
+TEST_CASE("storage/db/storage_db.c - keys slots", "[storage][storage_db][keys_slots]") {
+    char value[] = "a_value";
+    worker_context_t worker_context = { 0 };
+
+    worker_context.worker_index = 0;
+    worker_context_set(&worker_context);
+    transaction_set_worker_index(worker_context.worker_index);
+
+    storage_db_config_t *db_config = storage_db_config_new();
+    db_config->max_keys = 1024;
+    db_config->backend_type = STORAGE_DB_BACKEND_TYPE_MEMORY;
+    db_config->track_keys_slots = true;
+    storage_db_t *db = storage_db_new(db_config, 1);
+    REQUIRE(db != nullptr);
+    REQUIRE(storage_db_open(db));
+
+    // The keys sharing the hash tag are mapped to the same slot, a key is also the prefix of the others
+    char *keys[] = { "{a_tag}", "{a_tag}1", "{a_tag}12", "{a_tag}2" };
+    uint16_t slot = storage_db_key_slot(keys[0], strlen(keys[0]));
+
+    auto get_keys_in_slot = [&](uint64_t count) {
+        uint64_t keys_count = 0;
+        std::vector<std::string> keys_found;
+
+        storage_db_key_and_key_length_t *keys_in_slot = storage_db_op_get_keys_in_slot(db, slot, count, &keys_count);
+        for(uint64_t index = 0; index < keys_count; index++) {
+            keys_found.emplace_back(keys_in_slot[index].key, keys_in_slot[index].key_size);
+        }
+
+        if (keys_in_slot) {
+            storage_db_free_key_and_key_length_list(keys_in_slot, keys_count);
+        }
+
+        std::sort(keys_found.begin(), keys_found.end());
+        return keys_found;
+    };
+
+    SECTION("empty") {
+        REQUIRE(storage_db_op_count_keys_in_slot(db, slot) == 0);
+        REQUIRE(get_keys_in_slot(10).empty());
+    }
+
+    SECTION("keys set") {
+        for(auto key: keys) {
+            REQUIRE(test_storage_db_set_value(db, key, value, STORAGE_DB_ENTRY_NO_EXPIRY));
+        }
+
+        // Updating a key doesn't add it twice
+        REQUIRE(test_storage_db_set_value(db, keys[1], value, STORAGE_DB_ENTRY_NO_EXPIRY));
+        REQUIRE(test_storage_db_set_value(db, "another_key", value, STORAGE_DB_ENTRY_NO_EXPIRY));
+
+        REQUIRE(storage_db_op_count_keys_in_slot(db, slot) == 4);
+        REQUIRE(get_keys_in_slot(10) == std::vector<std::string>{ "{a_tag}", "{a_tag}1", "{a_tag}12", "{a_tag}2" });
+        REQUIRE(get_keys_in_slot(2).size() == 2);
+
+        SECTION("keys deleted") {
+            REQUIRE(storage_db_op_delete(db, keys[1], strlen(keys[1])));
+            REQUIRE(!storage_db_op_delete(db, keys[1], strlen(keys[1])));
+
+            REQUIRE(storage_db_op_count_keys_in_slot(db, slot) == 3);
+            REQUIRE(get_keys_in_slot(10) == std::vector<std::string>{ "{a_tag}", "{a_tag}12", "{a_tag}2" });
+        }
+
+        SECTION("keys flushed") {
+            REQUIRE(storage_db_op_flush_sync(db));
+
+            REQUIRE(storage_db_op_count_keys_in_slot(db, slot) == 0);
+            REQUIRE(get_keys_in_slot(10).empty());
+        }
+    }
+
+    storage_db_close(db);
+    storage_db_free(db, 1);
+}
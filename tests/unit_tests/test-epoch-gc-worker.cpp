@@ -26,7 +26,8 @@
 
 void test_epoch_gc_worker_object_destructor_cb_real(
         uint8_t staged_objects_count,
-        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]) {
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data) {
     for(uint64_t i = 0; i < staged_objects_count; i++) {
         free(staged_objects[i].data.object);
     }
@@ -197,7 +198,8 @@ TEST_CASE("epoch_gc_worker.c", "[epoch_gc_worker]") {
     SECTION("fuzzy staging/collecting") {
         epoch_gc_register_object_type_destructor_cb(
                 EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
-                test_epoch_gc_worker_object_destructor_cb_real);
+                test_epoch_gc_worker_object_destructor_cb_real,
+                NULL);
 
         epoch_gc_t *epoch_gc = epoch_gc_init(EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE);
 
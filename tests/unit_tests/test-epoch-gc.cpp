@@ -24,7 +24,8 @@
 
 void test_epoch_gc_object_destructor_cb_test(
         uint8_t staged_objects_count,
-        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]) {
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data) {
     for(uint64_t i = 0; i < staged_objects_count; i++) {
         REQUIRE((uintptr_t)staged_objects[i].data.object == (uintptr_t)(i+1));
     }
@@ -32,7 +33,8 @@ void test_epoch_gc_object_destructor_cb_test(
 
 void test_epoch_gc_object_destructor_cb_real(
         uint8_t staged_objects_count,
-        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE]) {
+        epoch_gc_staged_object_t staged_objects[EPOCH_GC_STAGED_OBJECT_DESTRUCTOR_CB_BATCH_SIZE],
+        void *user_data) {
     for(uint64_t i = 0; i < staged_objects_count; i++) {
         free(staged_objects[i].data.object);
     }
@@ -163,7 +165,12 @@ void *test_epoch_gc_fuzzy_separated_producer_consumer_consumer_thread_func(
             epoch_gc_thread_list_index < epoch_gc_thread_list_length;
             epoch_gc_thread_list_index++) {
         epoch_gc_thread_advance_epoch_tsc(epoch_gc_thread_list_cache[epoch_gc_thread_list_index]);
+    }
 
+    for(
+            epoch_gc_thread_list_index = 0;
+            epoch_gc_thread_list_index < epoch_gc_thread_list_length;
+            epoch_gc_thread_list_index++) {
         thread_data->freed_objects_counter += epoch_gc_thread_collect_all(
                 epoch_gc_thread_list_cache[epoch_gc_thread_list_index]);
     }
@@ -269,7 +276,8 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
         SECTION("valid object type and valid function pointer") {
             epoch_gc_register_object_type_destructor_cb(
                     EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
-                    test_epoch_gc_object_destructor_cb_test);
+                    test_epoch_gc_object_destructor_cb_test,
+                    NULL);
 
             REQUIRE(epoch_gc_get_epoch_gc_staged_object_destructor_cb()[EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE] ==
                     test_epoch_gc_object_destructor_cb_test);
@@ -523,7 +531,7 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
         epoch_gc_thread_t *epoch_gc_thread = epoch_gc_thread_init();
 
         epoch_gc_register_object_type_destructor_cb(
-                EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE, test_epoch_gc_object_destructor_cb_test);
+                EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE, test_epoch_gc_object_destructor_cb_test, NULL);
         epoch_gc_thread_register_global(&epoch_gc, epoch_gc_thread);
 
         epoch_gc_staged_object_t epoch_gc_staged_object_1 = { .data = { .epoch = 100, .object = (void*)1, } };
@@ -549,6 +557,19 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
             REQUIRE(epoch_gc_thread_collect(epoch_gc_thread, 2) == 2);
         }
 
+        SECTION("two pointers, collect 2, 1 collected because of the epoch of another thread") {
+            epoch_gc_thread_t *epoch_gc_thread_other = epoch_gc_thread_init();
+            epoch_gc_thread_register_global(&epoch_gc, epoch_gc_thread_other);
+
+            epoch_gc_thread->epoch = 201;
+            epoch_gc_thread_other->epoch = 101;
+
+            REQUIRE(epoch_gc_thread_collect(epoch_gc_thread, 2) == 1);
+
+            epoch_gc_thread_unregister_global(epoch_gc_thread_other);
+            epoch_gc_thread_free(epoch_gc_thread_other);
+        }
+
         SECTION("two pointers, collect 2, 2 collected because of epoch in two rounds because of max_objects") {
             epoch_gc_thread->epoch = 201;
 
@@ -608,7 +629,8 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
 
         epoch_gc_register_object_type_destructor_cb(
                 EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
-                test_epoch_gc_object_destructor_cb_test);
+                test_epoch_gc_object_destructor_cb_test,
+                NULL);
         epoch_gc_thread_register_global(&epoch_gc, epoch_gc_thread);
 
         epoch_gc_staged_object_t epoch_gc_staged_object_1 = { .data = { .epoch = 100, .object = (void*)1, } };
@@ -679,7 +701,8 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
 
         epoch_gc_register_object_type_destructor_cb(
                 EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
-                test_epoch_gc_object_destructor_cb_test);
+                test_epoch_gc_object_destructor_cb_test,
+                NULL);
         epoch_gc_thread_register_global(&epoch_gc, epoch_gc_thread);
 
         SECTION("terminate") {
@@ -695,7 +718,8 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
     SECTION("epoch_gc_stage_object") {
         epoch_gc_register_object_type_destructor_cb(
                 EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
-                test_epoch_gc_object_destructor_cb_test);
+                test_epoch_gc_object_destructor_cb_test,
+                NULL);
 
         epoch_gc_t epoch_gc = { nullptr };
         epoch_gc.thread_list = double_linked_list_init();
@@ -745,6 +769,27 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
             REQUIRE(staged_object_2.data.epoch == epoch_gc_thread->epoch);
         }
 
+        SECTION("stage 1 object with epoch") {
+            REQUIRE(epoch_gc_stage_object_with_epoch(
+                    EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
+                    (void*)1,
+                    1234) == true);
+
+            REQUIRE(ring_bounded_queue_spsc_uint128_get_length(epoch_gc_thread->staged_objects_ring_last) == 1);
+
+            epoch_gc_staged_object_t staged_object;
+            staged_object._packed =
+                    ring_bounded_queue_spsc_uint128_dequeue(epoch_gc_thread->staged_objects_ring_last, nullptr);
+
+            REQUIRE(staged_object.data.object == (void*)1);
+            REQUIRE(staged_object.data.epoch == 1234);
+        }
+
+        SECTION("epoch_gc_thread_is_registered_local") {
+            REQUIRE(epoch_gc_thread_is_registered_local(EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE));
+            REQUIRE(!epoch_gc_thread_is_registered_local(EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_XLARGE));
+        }
+
         SECTION("fill one ring") {
             ring_bounded_queue_spsc_uint128_t *ring_initial = epoch_gc_thread->staged_objects_ring_last;
 
@@ -790,7 +835,8 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
     SECTION("test workflow end to end") {
         epoch_gc_register_object_type_destructor_cb(
                 EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
-                test_epoch_gc_object_destructor_cb_test);
+                test_epoch_gc_object_destructor_cb_test,
+                NULL);
 
         epoch_gc_t epoch_gc = { nullptr };
         epoch_gc.thread_list = double_linked_list_init();
@@ -839,7 +885,8 @@ TEST_CASE("epoch_gc.c", "[epoch_gc]") {
     SECTION("fuzzy staging/collecting") {
         epoch_gc_register_object_type_destructor_cb(
                 EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE,
-                test_epoch_gc_object_destructor_cb_real);
+                test_epoch_gc_object_destructor_cb_real,
+                NULL);
 
         epoch_gc_t *epoch_gc = epoch_gc_init(EPOCH_GC_OBJECT_TYPE_STORAGEDB_ENTRY_INDEX_LARGE);
 
@@ -167,7 +167,7 @@ void test_ffma_fuzzy_multi_thread_single_size(
 
     uint32_t max_used_slots =
             (use_max_hugepages * HUGEPAGE_SIZE_2MB) /
-            (object_size + sizeof(ffma_slot_t));
+            object_size;
 
     bool can_place_signature_at_end = object_size > (sizeof(test_ffma_fuzzy_test_data_t) * 2);
 
@@ -256,11 +256,11 @@ void test_ffma_fuzzy_single_thread_single_size(
     assert(object_size >= sizeof(test_ffma_fuzzy_test_data_t));
 
     // The calculation for the max slots to use is not 100% correct as it doesn't take into account the header (64
-    // bytes) and the padding placed before the actual data to page-align them so it's critical to ALWAYS have at least
+    // bytes), the os page reserved at the end of the hugepage and the padding placed before the actual data to page-align them so it's critical to ALWAYS have at least
     // 1 hugepage more than the ones passed to this test function
     uint32_t max_used_slots =
             (use_max_hugepages * HUGEPAGE_SIZE_2MB) /
-            (object_size + sizeof(ffma_slot_t));
+            object_size;
 
     // If there is enough space to place the signature of the object ALSO at the end set this flag to true and the code
     // will take care of copying the signature from the beginning of the allocated memory to the end as well for
@@ -343,7 +343,6 @@ TEST_CASE("ffma.c", "[ffma]") {
             REQUIRE(ffma->object_size == 128);
             REQUIRE(ffma->metrics.objects_inuse_count == 0);
             REQUIRE(ffma->metrics.slices_inuse_count == 0);
-            REQUIRE(ffma->slots->count == 0);
             REQUIRE(ffma->slices->count == 0);
 
             REQUIRE(ffma_free(ffma));
@@ -356,7 +355,6 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->object_size == 128);
                 REQUIRE(ffma->metrics.objects_inuse_count == 0);
                 REQUIRE(ffma->metrics.slices_inuse_count == 0);
-                REQUIRE(ffma->slots->count == 0);
                 REQUIRE(ffma->slices->count == 0);
 
                 REQUIRE(ffma_free(ffma));
@@ -373,32 +371,60 @@ TEST_CASE("ffma.c", "[ffma]") {
             }
 
             SECTION("with objects allocated - in free list") {
-                int value = 0;
                 ffma_t* ffma = ffma_init(128);
 
-                REQUIRE(queue_mpmc_push(ffma->free_ffma_slots_queue_from_other_threads, &value));
-                REQUIRE(!ffma_free(ffma));
+                // Simulate an object freed by a different thread
+                void *memptr = ffma_mem_alloc_hugepages(ffma, 128);
+                queue_mpmc_node_t *node = (queue_mpmc_node_t*)memptr;
+                node->data = memptr;
+                queue_mpmc_push_nodes(ffma->free_ffma_slots_queue_from_other_threads, node, node, 1);
 
-                REQUIRE(queue_mpmc_pop(ffma->free_ffma_slots_queue_from_other_threads) != NULL);
+                REQUIRE(ffma->metrics.objects_inuse_count == 1);
                 REQUIRE(ffma_free(ffma));
             }
         }
 
         SECTION("ffma_index_by_object_size") {
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_16 - 1) == 0);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_16) == 0);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_32) == 1);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_64) == 2);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_128) == 3);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_256) == 4);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_512) == 5);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_1024) == 6);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_2048) == 7);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_4096) == 8);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_8192) == 9);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_16384) == 10);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_32768) == 11);
-            REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_65536) == 12);
+            SECTION("predefined object sizes") {
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_16 - 1) == 0);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_16) == 0);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_32) == 1);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_48) == 2);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_64) == 3);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_80) == 4);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_96) == 5);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_112) == 6);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_128) == 7);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_160) == 8);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_32768) == 39);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_40960) == 40);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_65536) == 43);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_81920) == 44);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_1048576) == 59);
+
+                for(int i = 0; i < FFMA_PREDEFINED_OBJECT_SIZES_COUNT; i++) {
+                    REQUIRE(ffma_index_by_object_size(ffma_predefined_object_sizes[i]) == i);
+                }
+            }
+
+            SECTION("in between object sizes") {
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_64 + 1) == 4);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_128 + 1) == 8);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_32768 + 1) == 40);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_57344 + 1) == 43);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_65536 + 1) == 44);
+                REQUIRE(ffma_index_by_object_size(FFMA_OBJECT_SIZE_917504 + 1) == 59);
+            }
+
+            SECTION("smallest fitting object size") {
+                for(uint32_t object_size = 1; object_size <= FFMA_OBJECT_SIZE_EXTENT_MAX; object_size++) {
+                    uint8_t index = ffma_index_by_object_size(object_size);
+                    REQUIRE(ffma_predefined_object_sizes[index] >= object_size);
+                    if (index > 0) {
+                        REQUIRE(ffma_predefined_object_sizes[index - 1] < object_size);
+                    }
+                }
+            }
         }
 
         SECTION("sizeof(ffma_slice_t)") {
@@ -411,41 +437,18 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE((void*)slice.data.ffma == slice.double_linked_list_item.data);
             }
 
-            SECTION("ensure that ffma_slice_t is 64 bytes to allow ffma_slot_t to be cache-aligned") {
+            SECTION("ensure that ffma_slice_t is 64 bytes to fit in a cache line") {
                 REQUIRE(sizeof(ffma_slice_t) == 64);
             }
         }
 
-        SECTION("sizeof(ffma_slot_t)") {
-            SECTION("ensure padding in ffma_slot_t overlaps prev and next in double_linked_list_item") {
-                ffma_slot_t slot = { nullptr };
-                REQUIRE(sizeof(slot.data.padding) ==
-                    (sizeof(slot.double_linked_list_item.prev) + sizeof(slot.double_linked_list_item.next)));
-                REQUIRE(slot.data.padding[0] == slot.double_linked_list_item.prev);
-                REQUIRE(slot.data.padding[1] == slot.double_linked_list_item.next);
-                REQUIRE((void*)slot.data.memptr == slot.double_linked_list_item.data);
-            }
-
-            SECTION("ensure that ffma_slot_t is 32 bytes to be cache-aligned") {
-                REQUIRE(sizeof(ffma_slot_t) == 32);
-            }
-        }
-
         SECTION("ffma_slice_calculate_usable_hugepage_size") {
             REQUIRE(ffma_slice_calculate_usable_hugepage_size() ==
                     HUGEPAGE_SIZE_2MB - xalloc_get_page_size() - sizeof(ffma_slice_t));
         }
 
         SECTION("ffma_slice_calculate_data_offset") {
-            size_t usable_hugepage_size = 4096 * 4;
-            uint32_t object_size = 32;
-            uint32_t slots_count = (int)(usable_hugepage_size / (object_size + sizeof(ffma_slot_t)));
-            size_t data_offset = sizeof(ffma_slice_t) + (slots_count * sizeof(ffma_slot_t));
-            data_offset += xalloc_get_page_size() - (data_offset % xalloc_get_page_size());
-
-            REQUIRE(ffma_slice_calculate_data_offset(
-                    usable_hugepage_size,
-                    object_size) == data_offset);
+            REQUIRE(ffma_slice_calculate_data_offset() == xalloc_get_page_size());
         }
 
         SECTION("ffma_slice_calculate_slots_count") {
@@ -464,9 +467,7 @@ TEST_CASE("ffma.c", "[ffma]") {
             ffma_slice_t* ffma_slice = ffma_slice_init(ffma, memptr);
 
             size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
-            uint32_t data_offset = ffma_slice_calculate_data_offset(
-                    usable_hugepage_size,
-                    ffma->object_size);
+            uint32_t data_offset = ffma_slice_calculate_data_offset();
             uint32_t slots_count = ffma_slice_calculate_slots_count(
                     usable_hugepage_size,
                     data_offset,
@@ -476,59 +477,8 @@ TEST_CASE("ffma.c", "[ffma]") {
             REQUIRE(ffma_slice->data.metrics.objects_total_count == slots_count);
             REQUIRE(ffma_slice->data.metrics.objects_inuse_count == 0);
             REQUIRE(ffma_slice->data.data_addr == (uintptr_t)memptr + data_offset);
-            REQUIRE(ffma_slice->data.available == true);
-
-            ffma_free(ffma);
-            free(memptr);
-        }
-
-        SECTION("ffma_slice_add_slots_to_per_thread_metadata_slots") {
-            size_t slice_size = HUGEPAGE_SIZE_2MB;
-            void* memptr = malloc(slice_size);
-
-            ffma_t* ffma = ffma_init(256);
-            ffma_slice_t* ffma_slice =
-                    ffma_slice_init(ffma, memptr);
-
-            ffma_slice_add_slots_to_per_thread_metadata_slots(
-                    ffma,
-                    ffma_slice);
-
-            REQUIRE(ffma->slots->tail ==
-                    &ffma_slice->data.slots[0].double_linked_list_item);
-            REQUIRE(ffma->slots->head ==
-                    &ffma_slice->data.slots[
-                            ffma_slice->data.metrics.objects_total_count - 1].double_linked_list_item);
-
-            for(int i = 0; i < ffma_slice->data.metrics.objects_total_count; i++) {
-                REQUIRE(ffma_slice->data.slots[i].data.available == true);
-            }
-
-            ffma_free(ffma);
-            free(memptr);
-        }
-
-        SECTION("ffma_slice_remove_slots_from_per_thread_metadata_slots") {
-            size_t slice_size = HUGEPAGE_SIZE_2MB;
-            void* memptr = malloc(slice_size);
-
-            ffma_t* ffma = ffma_init(256);
-            ffma_slice_t* ffma_slice =
-                    ffma_slice_init(
-                        ffma,
-                        memptr);
-
-            ffma_slice_add_slots_to_per_thread_metadata_slots(ffma, ffma_slice);
-            ffma_slice_remove_slots_from_per_thread_metadata_slots(ffma, ffma_slice);
-
-            REQUIRE(ffma->slots->tail == nullptr);
-            REQUIRE(ffma->slots->head == nullptr);
-            REQUIRE(ffma_slice->data.slots[0].data.available == true);
-
-            for(int i = 0; i < ffma_slice->data.metrics.objects_total_count; i++) {
-                REQUIRE(ffma_slice->data.slots[i].double_linked_list_item.next == nullptr);
-                REQUIRE(ffma_slice->data.slots[i].double_linked_list_item.prev == nullptr);
-            }
+            REQUIRE(ffma_slice->data.data_unused_addr == ffma_slice->data.data_addr);
+            REQUIRE(ffma_slice->data.free_list == nullptr);
 
             ffma_free(ffma);
             free(memptr);
@@ -542,12 +492,11 @@ TEST_CASE("ffma.c", "[ffma]") {
 
             ffma_grow(ffma, hugepage_addr);
 
-            REQUIRE(ffma_slice->data.available == false);
+            REQUIRE(ffma->metrics.slices_inuse_count == 1);
             REQUIRE(&ffma->slices->head->data == &ffma_slice->double_linked_list_item.data);
             REQUIRE(&ffma->slices->tail->data == &ffma_slice->double_linked_list_item.data);
-            REQUIRE(ffma->slots->tail == &ffma_slice->data.slots[0].double_linked_list_item);
-            REQUIRE(ffma->slots->head ==
-                    &ffma_slice->data.slots[ffma_slice->data.metrics.objects_total_count - 1].double_linked_list_item);
+            REQUIRE(ffma_slice->data.data_unused_addr == ffma_slice->data.data_addr);
+            REQUIRE(ffma_slice->data.free_list == nullptr);
 
             ffma_free(ffma);
         }
@@ -583,21 +532,16 @@ TEST_CASE("ffma.c", "[ffma]") {
 
                 REQUIRE(ffma->metrics.slices_inuse_count == 1);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->tail->data == memptr);
-                REQUIRE(((ffma_slot_t *) ffma->slots->tail)->data.available == false);
-                REQUIRE(((ffma_slot_t *) ffma->slots->head)->data.available == true);
                 REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.metrics.objects_inuse_count == 1);
-                REQUIRE(((ffma_slot_t *) ffma->slots->head)->data.available == true);
-                REQUIRE(((ffma_slot_t *) ffma->slots->head)->data.available == true);
-                REQUIRE(((ffma_slot_t *) ffma->slots->tail)->data.available == false);
-                REQUIRE(((ffma_slot_t *) ffma->slots->tail)->data.memptr == memptr);
+                REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.data_addr == (uintptr_t)memptr);
+                REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.data_unused_addr ==
+                        (uintptr_t)memptr + ffma->object_size);
+                REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.free_list == nullptr);
             }
 
             SECTION("fill one page") {
                 size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
-                uint32_t data_offset = ffma_slice_calculate_data_offset(
-                        usable_hugepage_size,
-                        ffma->object_size);
+                uint32_t data_offset = ffma_slice_calculate_data_offset();
                 uint32_t slots_count = ffma_slice_calculate_slots_count(
                         usable_hugepage_size,
                         data_offset,
@@ -610,17 +554,13 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->metrics.slices_inuse_count == 1);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
                 REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.metrics.objects_inuse_count == slots_count);
-                REQUIRE(((ffma_slot_t *) ffma->slots->head)->data.available == false);
-                REQUIRE(((ffma_slot_t *) ffma->slots->head->next)->data.available == false);
-                REQUIRE(((ffma_slot_t *) ffma->slots->tail)->data.available == false);
-                REQUIRE(((ffma_slot_t *) ffma->slots->tail->prev)->data.available == false);
+                REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.data_unused_addr ==
+                        ((ffma_slice_t *) ffma->slices->head)->data.data_addr + (slots_count * ffma->object_size));
             }
 
             SECTION("trigger second page creation") {
                 size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
-                uint32_t data_offset = ffma_slice_calculate_data_offset(
-                        usable_hugepage_size,
-                        ffma->object_size);
+                uint32_t data_offset = ffma_slice_calculate_data_offset();
                 uint32_t slots_count = ffma_slice_calculate_slots_count(
                         usable_hugepage_size,
                         data_offset,
@@ -635,12 +575,9 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->slices->head != ffma->slices->tail);
                 REQUIRE(ffma->slices->head->next == ffma->slices->tail);
                 REQUIRE(ffma->slices->head == ffma->slices->tail->prev);
-                REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.metrics.objects_inuse_count == slots_count);
-                REQUIRE(((ffma_slice_t *) ffma->slices->tail)->data.metrics.objects_inuse_count == 1);
-                REQUIRE(((ffma_slot_t *) ffma->slots->head)->data.available == true);
-                REQUIRE(((ffma_slot_t *) ffma->slots->head->next)->data.available == true);
-                REQUIRE(((ffma_slot_t *) ffma->slots->tail)->data.available == false);
-                REQUIRE(((ffma_slot_t *) ffma->slots->tail->prev)->data.available == false);
+                // The slices with free objects are at the head, the full ones at the tail
+                REQUIRE(((ffma_slice_t *) ffma->slices->head)->data.metrics.objects_inuse_count == 1);
+                REQUIRE(((ffma_slice_t *) ffma->slices->tail)->data.metrics.objects_inuse_count == slots_count);
             }
 
             ffma_free(ffma);
@@ -660,16 +597,15 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->metrics.objects_inuse_count == 1);
                 REQUIRE(ffma->metrics.slices_inuse_count == 1);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head->data != memptr);
-                REQUIRE(ffma->slots->tail->data == memptr);
+                REQUIRE(ffma_slice_from_memptr(memptr) == (ffma_slice_t *) ffma->slices->head);
 
                 ffma_mem_free_hugepages(memptr);
 
                 REQUIRE(ffma->metrics.objects_inuse_count == 0);
                 REQUIRE(ffma->metrics.slices_inuse_count == 0);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head == nullptr);
-                REQUIRE(ffma->slots->tail == nullptr);
+                REQUIRE(ffma->slices->head == nullptr);
+                REQUIRE(ffma->slices->tail == nullptr);
             }
 
             SECTION("allocate and free 1 object via different threads") {
@@ -678,23 +614,75 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->metrics.objects_inuse_count == 1);
                 REQUIRE(ffma->metrics.slices_inuse_count == 1);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head->data != memptr);
-                REQUIRE(ffma->slots->tail->data == memptr);
+                REQUIRE(ffma_slice_from_memptr(memptr) == (ffma_slice_t *) ffma->slices->head);
 
                 ffma_mem_free_hugepages(memptr);
 
                 REQUIRE(ffma->metrics.objects_inuse_count == 0);
                 REQUIRE(ffma->metrics.slices_inuse_count == 0);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head == nullptr);
-                REQUIRE(ffma->slots->tail == nullptr);
+                REQUIRE(ffma->slices->head == nullptr);
+                REQUIRE(ffma->slices->tail == nullptr);
             }
 
-            SECTION("fill and free one hugepage") {
+            SECTION("allocate, free and reuse from the free list") {
+                void *memptr1 = ffma_mem_alloc_hugepages(ffma, ffma_predefined_object_sizes[0]);
+                void *memptr2 = ffma_mem_alloc_hugepages(ffma, ffma_predefined_object_sizes[0]);
+                ffma_slice_t *ffma_slice = ffma_slice_from_memptr(memptr1);
+
+                ffma_mem_free_hugepages(memptr1);
+
+                REQUIRE(ffma->metrics.objects_inuse_count == 1);
+                REQUIRE(ffma_slice->data.metrics.objects_inuse_count == 1);
+                REQUIRE(ffma_slice->data.free_list == memptr1);
+
+                void *memptr3 = ffma_mem_alloc_hugepages(ffma, ffma_predefined_object_sizes[0]);
+
+                REQUIRE(memptr3 == memptr1);
+                REQUIRE(ffma_slice->data.free_list == nullptr);
+                REQUIRE(ffma->metrics.objects_inuse_count == 2);
+
+                ffma_mem_free_hugepages(memptr2);
+                ffma_mem_free_hugepages(memptr3);
+
+                REQUIRE(ffma->metrics.objects_inuse_count == 0);
+                REQUIRE(ffma->metrics.slices_inuse_count == 0);
+            }
+
+            SECTION("free in a full slice moves it to the head") {
                 size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
-                uint32_t data_offset = ffma_slice_calculate_data_offset(
+                uint32_t data_offset = ffma_slice_calculate_data_offset();
+                uint32_t slots_count = ffma_slice_calculate_slots_count(
                         usable_hugepage_size,
+                        data_offset,
                         ffma->object_size);
+
+                void** memptrs = (void**)malloc(sizeof(void*) * (slots_count + 1));
+                for(int i = 0; i < slots_count + 1; i++) {
+                    memptrs[i] = ffma_mem_alloc_hugepages(ffma, ffma_predefined_object_sizes[0]);
+                }
+
+                ffma_slice_t *ffma_slice_full = ffma_slice_from_memptr(memptrs[0]);
+                REQUIRE((ffma_slice_t *) ffma->slices->tail == ffma_slice_full);
+
+                ffma_mem_free_hugepages(memptrs[0]);
+
+                REQUIRE((ffma_slice_t *) ffma->slices->head == ffma_slice_full);
+                REQUIRE(ffma_mem_alloc_hugepages(ffma, ffma_predefined_object_sizes[0]) == memptrs[0]);
+                REQUIRE((ffma_slice_t *) ffma->slices->tail == ffma_slice_full);
+
+                for(int i = 0; i < slots_count + 1; i++) {
+                    ffma_mem_free_hugepages(memptrs[i]);
+                }
+                free(memptrs);
+
+                REQUIRE(ffma->metrics.objects_inuse_count == 0);
+                REQUIRE(ffma->metrics.slices_inuse_count == 0);
+            }
+
+            SECTION("fill and free one hugepage") {
+                size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
+                uint32_t data_offset = ffma_slice_calculate_data_offset();
                 uint32_t slots_count = ffma_slice_calculate_slots_count(
                         usable_hugepage_size,
                         data_offset,
@@ -708,8 +696,8 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->metrics.slices_inuse_count == 1);
                 REQUIRE(ffma->metrics.objects_inuse_count == slots_count);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head != nullptr);
-                REQUIRE(ffma->slots->tail != nullptr);
+                REQUIRE(ffma->slices->head != nullptr);
+                REQUIRE(ffma->slices->tail != nullptr);
 
                 for(int i = 0; i < slots_count; i++) {
                     ffma_mem_free_hugepages(memptrs[i]);
@@ -718,15 +706,13 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->metrics.objects_inuse_count == 0);
                 REQUIRE(ffma->metrics.slices_inuse_count == 0);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head == nullptr);
-                REQUIRE(ffma->slots->tail == nullptr);
+                REQUIRE(ffma->slices->head == nullptr);
+                REQUIRE(ffma->slices->tail == nullptr);
             }
 
             SECTION("fill and free one hugepage and one element") {
                 size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
-                uint32_t data_offset = ffma_slice_calculate_data_offset(
-                        usable_hugepage_size,
-                        ffma->object_size);
+                uint32_t data_offset = ffma_slice_calculate_data_offset();
                 uint32_t slots_count = ffma_slice_calculate_slots_count(
                         usable_hugepage_size,
                         data_offset,
@@ -742,8 +728,8 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->metrics.slices_inuse_count == 2);
                 REQUIRE(ffma->metrics.objects_inuse_count == slots_count);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head != nullptr);
-                REQUIRE(ffma->slots->tail != nullptr);
+                REQUIRE(ffma->slices->head != nullptr);
+                REQUIRE(ffma->slices->tail != nullptr);
 
                 for(int i = 0; i < slots_count; i++) {
                     ffma_mem_free_hugepages(
@@ -753,8 +739,8 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma->metrics.objects_inuse_count == 0);
                 REQUIRE(ffma->metrics.slices_inuse_count == 0);
                 REQUIRE(queue_mpmc_get_length(ffma->free_ffma_slots_queue_from_other_threads) == 0);
-                REQUIRE(ffma->slots->head == nullptr);
-                REQUIRE(ffma->slots->tail == nullptr);
+                REQUIRE(ffma->slices->head == nullptr);
+                REQUIRE(ffma->slices->tail == nullptr);
             }
 
             SECTION("free via different ffma") {
@@ -771,14 +757,15 @@ TEST_CASE("ffma.c", "[ffma]") {
                 REQUIRE(ffma2->metrics.slices_inuse_count == 1);
                 REQUIRE(ffma->metrics.slices_inuse_count == 0);
 
+                // The object is batched until the batch is flushed
+                REQUIRE(queue_mpmc_get_length(ffma2->free_ffma_slots_queue_from_other_threads) == 0);
+                ffma_mem_free_hugepages_different_thread_batches_flush(ffma);
                 REQUIRE(queue_mpmc_get_length(ffma2->free_ffma_slots_queue_from_other_threads) == 1);
 
                 // slots from the queue are used if all the items in the hugepages have been used so it's necessary to
                 // fill the hugepage allocated
                 size_t usable_hugepage_size = ffma_slice_calculate_usable_hugepage_size();
-                uint32_t data_offset = ffma_slice_calculate_data_offset(
-                        usable_hugepage_size,
-                        ffma->object_size);
+                uint32_t data_offset = ffma_slice_calculate_data_offset();
                 uint32_t slots_count = ffma_slice_calculate_slots_count(
                         usable_hugepage_size,
                         data_offset,
@@ -789,7 +776,7 @@ TEST_CASE("ffma.c", "[ffma]") {
                     memptrs[i] = ffma_mem_alloc_hugepages(ffma2, ffma_predefined_object_sizes[0]);
                 }
 
-                // All the previous allocation must have come out from the local list of slots
+                // All the previous allocation must have come out from the slice
                 REQUIRE(queue_mpmc_get_length(ffma2->free_ffma_slots_queue_from_other_threads) == 1);
 
                 // This last allocation must come from the free list
@@ -806,6 +793,10 @@ TEST_CASE("ffma.c", "[ffma]") {
                 }
                 ffma_mem_free_hugepages(memptr2);
 
+                // The full batches are passed to the owner right away
+                REQUIRE(queue_mpmc_get_length(ffma2->free_ffma_slots_queue_from_other_threads) ==
+                        slots_count - (slots_count % FFMA_DIFFERENT_THREAD_FREE_BATCH_SIZE));
+                ffma_mem_free_hugepages_different_thread_batches_flush(ffma);
                 REQUIRE(queue_mpmc_get_length(ffma2->free_ffma_slots_queue_from_other_threads) == slots_count);
 
                 REQUIRE(ffma_free(ffma2));
@@ -836,6 +827,76 @@ TEST_CASE("ffma.c", "[ffma]") {
             ffma_enable(false);
         }
 
+        SECTION("ffma_mem_alloc_large") {
+            ffma_enable(true);
+            ffma_thread_cache_set(ffma_thread_cache_init());
+
+            SECTION("ffma_mem_alloc_large_calculate_hugepages_count") {
+                REQUIRE(ffma_mem_alloc_large_calculate_hugepages_count(FFMA_OBJECT_SIZE_EXTENT_MAX + 1) == 1);
+                REQUIRE(ffma_mem_alloc_large_calculate_hugepages_count(
+                        HUGEPAGE_SIZE_2MB - ffma_slice_calculate_data_offset()) == 1);
+                REQUIRE(ffma_mem_alloc_large_calculate_hugepages_count(
+                        HUGEPAGE_SIZE_2MB - ffma_slice_calculate_data_offset() + 1) == 2);
+                REQUIRE(ffma_mem_alloc_large_calculate_hugepages_count(10 * 1024 * 1024) == 6);
+            }
+
+            SECTION("allocate and free an object spanning multiple hugepages") {
+                size_t size = (4 * 1024 * 1024) + 1;
+                char *memptr = (char*)ffma_mem_alloc(size);
+                ffma_slice_t *ffma_slice = ffma_slice_from_memptr(memptr);
+
+                REQUIRE(memptr != nullptr);
+                REQUIRE(ffma_slice->data.ffma == nullptr);
+                REQUIRE(ffma_slice->data.data_addr == (uintptr_t)memptr);
+                REQUIRE(ffma_slice->data.data_unused_addr ==
+                        (uintptr_t)ffma_slice->data.page_addr + (3 * HUGEPAGE_SIZE_2MB));
+                REQUIRE(ffma_slice->data.metrics.objects_inuse_count == 1);
+
+                // The whole object must be writable
+                memset(memptr, 'a', size);
+                REQUIRE(memptr[size - 1] == 'a');
+
+                ffma_mem_free(memptr);
+
+                // The run is cached and reused for an object needing the same amount of hugepages
+                char *memptr2 = (char*)ffma_mem_alloc(size);
+                REQUIRE(memptr2 == memptr);
+
+                ffma_mem_free(memptr2);
+            }
+
+            SECTION("objects up to the extent max size are allocated from the extent classes") {
+                char *memptr = (char*)ffma_mem_alloc(FFMA_OBJECT_SIZE_MAX + 1);
+                char *memptr2 = (char*)ffma_mem_alloc(FFMA_OBJECT_SIZE_MAX + 1);
+                ffma_slice_t *ffma_slice = ffma_slice_from_memptr(memptr);
+
+                REQUIRE(memptr != nullptr);
+                REQUIRE(ffma_slice->data.ffma != nullptr);
+                REQUIRE(ffma_slice->data.ffma->object_size == FFMA_OBJECT_SIZE_81920);
+
+                // The objects share the slice
+                REQUIRE(ffma_slice_from_memptr(memptr2) == ffma_slice);
+                REQUIRE(ffma_slice->data.metrics.objects_inuse_count == 2);
+
+                ffma_mem_free(memptr);
+                ffma_mem_free(memptr2);
+
+                memptr = (char*)ffma_mem_alloc(FFMA_OBJECT_SIZE_EXTENT_MAX);
+                REQUIRE(memptr != nullptr);
+                REQUIRE(ffma_slice_from_memptr(memptr)->data.ffma != nullptr);
+                REQUIRE(ffma_slice_from_memptr(memptr)->data.ffma->object_size == FFMA_OBJECT_SIZE_EXTENT_MAX);
+
+                // The whole object must be writable
+                memset(memptr, 'a', FFMA_OBJECT_SIZE_EXTENT_MAX);
+
+                ffma_mem_free(memptr);
+            }
+
+            ffma_thread_cache_free(ffma_thread_cache_get());
+            ffma_thread_cache_set(nullptr);
+            ffma_enable(false);
+        }
+
         SECTION("ffma alloc and free - fuzzy - single thread") {
             uint32_t min_used_slots = 2500;
             uint32_t use_max_hugepages = 100;
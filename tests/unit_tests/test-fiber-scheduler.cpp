@@ -71,6 +71,14 @@ void test_fiber_scheduler_fiber_switch_to_test_entrypoint(fiber_t *from, fiber_t
     fiber_scheduler_switch_back();
 }
 
+bool test_fiber_scheduler_yield_resumed = false;
+void test_fiber_scheduler_fiber_yield_entrypoint(fiber_t *from, fiber_t *to) {
+    fiber_scheduler_yield();
+    test_fiber_scheduler_yield_resumed = true;
+
+    fiber_scheduler_switch_back();
+}
+
 TEST_CASE("fiber_scheduler.c", "[fiber_scheduler]") {
     size_t page_size = getpagesize();
     size_t stack_size = page_size * 8;
@@ -276,6 +284,71 @@ TEST_CASE("fiber_scheduler.c", "[fiber_scheduler]") {
         fiber_scheduler_stack.size = 0;
     }
 
+    SECTION("fiber_scheduler_yield") {
+        SECTION("outside of a fiber") {
+            REQUIRE(!fiber_scheduler_can_yield());
+
+            fiber_scheduler_yield();
+
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+        }
+
+        SECTION("yield and resume a fiber") {
+            test_fiber_scheduler_yield_resumed = false;
+            fiber_t *fiber = fiber_new(
+                    test_fiber_scheduler_fixture_fiber_name,
+                    test_fiber_scheduler_fixture_fiber_name_leb,
+                    stack_size,
+                    test_fiber_scheduler_fiber_yield_entrypoint,
+                    NULL);
+
+            fiber_scheduler_switch_to(fiber);
+
+            REQUIRE(!test_fiber_scheduler_yield_resumed);
+            REQUIRE(fiber_scheduler_has_ready_fibers());
+
+            fiber_scheduler_resume_ready_fibers();
+
+            REQUIRE(test_fiber_scheduler_yield_resumed);
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+
+            fiber_free(fiber);
+        }
+
+        xalloc_free(fiber_scheduler_stack.list);
+        fiber_scheduler_stack.list = NULL;
+        fiber_scheduler_stack.index = -1;
+        fiber_scheduler_stack.size = 0;
+    }
+
+    SECTION("fiber_scheduler_yield_budget_check") {
+        fiber_scheduler_yield_budget_t yield_budget;
+
+        SECTION("check interval not reached") {
+            fiber_scheduler_yield_budget_init(&yield_budget, 2);
+            yield_budget.started_at_ms -= FIBER_SCHEDULER_YIELD_BUDGET_MS * 2;
+
+            REQUIRE(!fiber_scheduler_yield_budget_check(&yield_budget));
+            REQUIRE(yield_budget.iterations == 1);
+        }
+
+        SECTION("budget not exhausted") {
+            fiber_scheduler_yield_budget_init(&yield_budget, 1);
+            yield_budget.started_at_ms += 1000;
+
+            REQUIRE(!fiber_scheduler_yield_budget_check(&yield_budget));
+            REQUIRE(yield_budget.iterations == 0);
+        }
+
+        SECTION("budget exhausted outside of a fiber") {
+            fiber_scheduler_yield_budget_init(&yield_budget, 1);
+            yield_budget.started_at_ms -= FIBER_SCHEDULER_YIELD_BUDGET_MS * 2;
+
+            REQUIRE(!fiber_scheduler_yield_budget_check(&yield_budget));
+            REQUIRE(!fiber_scheduler_has_ready_fibers());
+        }
+    }
+
     SECTION("fiber_scheduler_new_fiber") {
         SECTION("new fiber") {
             fiber_t *fiber = fiber_scheduler_new_fiber(
@@ -54,7 +54,7 @@ void test_fiber_context_swap_update_user_data_and_swap_back(fiber_t *fiber_from,
     fiber_context_swap(fiber_to, fiber_from);
 }
 
-int test_fiber_stack_protection_find_memory_protection(void *start_address, void* end_address) {
+int test_fiber_find_memory_protection(void *start_address, void* end_address) {
     FILE *fp;
     int prot_return = -1;
     char line[1024], start_address_str[17] = { 0 }, end_address_str[17] = { 0 };
@@ -98,47 +98,6 @@ TEST_CASE("fiber.c", "[fiber]") {
     size_t page_size = getpagesize();
     size_t stack_size = page_size * 8;
 
-    SECTION("fiber_stack_protection") {
-        SECTION("test enabling the memory protection") {
-            int protection_flags = -1;
-            fiber_t fiber = { 0 };
-            fiber.stack_base = aligned_alloc(page_size, page_size);
-
-            // Enable stack fiber protection
-            fiber_stack_protection(&fiber, true);
-
-            // Retrieve the protection flags of the memory page
-            protection_flags = test_fiber_stack_protection_find_memory_protection(
-                    fiber.stack_base, (char*)fiber.stack_base + page_size);
-
-            REQUIRE(protection_flags == PROT_NONE);
-
-            mprotect(fiber.stack_base, page_size, PROT_READ | PROT_WRITE);
-            free(fiber.stack_base);
-        }
-
-        SECTION("test disabling the memory protection") {
-            int protection_flags = -1;
-            fiber_t fiber = { 0 };
-            fiber.stack_base = aligned_alloc(page_size, page_size);
-
-            // Enable and disable the stack protection
-            fiber_stack_protection(&fiber, true);
-            fiber_stack_protection(&fiber, false);
-
-            // Check if the page is listed in /proc/self/maps
-            protection_flags = test_fiber_stack_protection_find_memory_protection(
-                    fiber.stack_base, (char*)fiber.stack_base + page_size);
-
-            // The protection flags for the allocated should be entirely missing as fiber_stack_protection resets them
-            // to PROT_READ | PROT_WRITE that are the default ones.
-            // This behaviour may change in the future as it's depends on the OS.
-            REQUIRE(protection_flags == -1);
-
-            free(fiber.stack_base);
-        }
-    }
-
     SECTION("fiber_new") {
         SECTION("allocate a new fiber") {
             int user_data = 0;
@@ -166,10 +125,8 @@ TEST_CASE("fiber.c", "[fiber]") {
             REQUIRE(fiber->start_fp_user_data == &user_data);
             REQUIRE((uintptr_t)fiber->stack_pointer == stack_pointer);
 
-            // The fiber memory is protected, the memory protection has to be disabled before freeing the memory
-            mprotect(fiber->stack_base, page_size, PROT_READ | PROT_WRITE);
-            xalloc_free(fiber->stack_base);
-            xalloc_free(fiber);
+            fiber_free(fiber);
+            fiber_stack_pool_free();
         }
 
         SECTION("fail to allocate a new fiber without an entrypoint") {
@@ -207,6 +164,116 @@ TEST_CASE("fiber.c", "[fiber]") {
         }
     }
 
+    SECTION("fiber stack pool") {
+        SECTION("reuse the stack of a freed fiber") {
+            fiber_t *fiber = fiber_new(
+                    test_fiber_name,
+                    test_fiber_name_len,
+                    stack_size,
+                    test_fiber_new_empty,
+                    NULL);
+            void *stack_base = fiber->stack_base;
+            fiber_free(fiber);
+
+            fiber = fiber_new(
+                    test_fiber_name,
+                    test_fiber_name_len,
+                    stack_size,
+                    test_fiber_new_empty,
+                    NULL);
+            REQUIRE(fiber->stack_base == stack_base);
+
+            fiber_free(fiber);
+            fiber_stack_pool_free();
+        }
+
+        SECTION("don't reuse a stack of a different size") {
+            fiber_t *fiber = fiber_new(
+                    test_fiber_name,
+                    test_fiber_name_len,
+                    stack_size,
+                    test_fiber_new_empty,
+                    NULL);
+            void *stack_base = fiber->stack_base;
+            fiber_free(fiber);
+
+            fiber = fiber_new(
+                    test_fiber_name,
+                    test_fiber_name_len,
+                    stack_size * 2,
+                    test_fiber_new_empty,
+                    NULL);
+            REQUIRE(fiber->stack_base != stack_base);
+
+            fiber_free(fiber);
+            fiber_stack_pool_free();
+        }
+
+        SECTION("the pages used by a pooled stack are kept committed") {
+            void *stack_base = fiber_stack_alloc(stack_size);
+            memset((char*)stack_base + page_size, 0xAA, stack_size - (page_size * 2));
+            fiber_stack_free(stack_base, stack_size);
+
+            REQUIRE(fiber_stack_pool.committed_count == 1);
+
+            // Below the threshold the pages are not released
+            fiber_stack_pool_release_pages();
+            REQUIRE(fiber_stack_pool.committed_count == 1);
+
+            REQUIRE(fiber_stack_alloc(stack_size) == stack_base);
+            REQUIRE(fiber_stack_pool.committed_count == 0);
+            REQUIRE(((char*)stack_base)[page_size] == (char)0xAA);
+
+            fiber_stack_free(stack_base, stack_size);
+            fiber_stack_pool_free();
+        }
+
+        SECTION("the pages used by the pooled stacks over the threshold are released") {
+            void *stacks_base[FIBER_STACK_POOL_COMMITTED_MAX_SIZE + 1];
+
+            for(int index = 0; index < FIBER_STACK_POOL_COMMITTED_MAX_SIZE + 1; index++) {
+                stacks_base[index] = fiber_stack_alloc(stack_size);
+                memset((char*)stacks_base[index] + page_size, 0xAA, stack_size - (page_size * 2));
+            }
+
+            for(int index = 0; index < FIBER_STACK_POOL_COMMITTED_MAX_SIZE + 1; index++) {
+                fiber_stack_free(stacks_base[index], stack_size);
+            }
+
+            REQUIRE(fiber_stack_pool.committed_count == FIBER_STACK_POOL_COMMITTED_MAX_SIZE + 1);
+
+            fiber_stack_pool_release_pages();
+            REQUIRE(fiber_stack_pool.committed_count == FIBER_STACK_POOL_COMMITTED_MAX_SIZE);
+
+            // The first stack freed is the last one to be reused, its pages are released and zero-filled on the next
+            // touch, the others are kept as they are
+            bool zero_filled = true;
+            for(size_t offset = page_size; offset < stack_size - page_size && zero_filled; offset++) {
+                zero_filled = ((char*)stacks_base[0])[offset] == 0;
+            }
+            REQUIRE(zero_filled);
+            REQUIRE(((char*)stacks_base[1])[page_size] == (char)0xAA);
+
+            fiber_stack_pool_free();
+        }
+
+        SECTION("the guard page of a pooled stack is still protected") {
+            fiber_t *fiber = fiber_new(
+                    test_fiber_name,
+                    test_fiber_name_len,
+                    stack_size,
+                    test_fiber_new_empty,
+                    NULL);
+            void *stack_base = fiber->stack_base;
+            fiber_free(fiber);
+
+            REQUIRE(test_fiber_find_memory_protection(
+                    stack_base, (char*)stack_base + page_size) == PROT_NONE);
+
+            fiber_stack_pool_free();
+        }
+    }
+
     SECTION("fiber_context_get") {
         SECTION("get fiber context from executing function") {
             fiber_t *fiber = fiber_new(
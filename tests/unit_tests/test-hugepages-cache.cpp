@@ -8,6 +8,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <string.h>
+
 #include "exttypes.h"
 #include "data_structures/queue_mpmc/queue_mpmc.h"
 #include "utils_numa.h"
@@ -151,6 +153,58 @@ TEST_CASE("hugepage_cache.c", "[hugepage_cache]") {
 
             hugepage_cache_free();
         }
+
+        SECTION("hugepage_cache_pop_run / hugepage_cache_push_run") {
+            uint32_t numa_node_index = thread_get_current_numa_node_index();
+            hugepage_cache_t* hugepage_cache_per_numa_node = hugepage_cache_init();
+
+            SECTION("pop and push a run of one hugepage") {
+                void* run_addr = hugepage_cache_pop_run(1);
+                hugepage_cache_push_run(run_addr, 1);
+
+                REQUIRE(queue_mpmc_get_length(hugepage_cache_per_numa_node[numa_node_index].free_queue) == 1);
+                REQUIRE(queue_mpmc_peek(hugepage_cache_per_numa_node[numa_node_index].free_queue) == run_addr);
+            }
+
+            SECTION("pop and push a run of three hugepages") {
+                void* run_addr = hugepage_cache_pop_run(3);
+
+                REQUIRE(run_addr != nullptr);
+                REQUIRE((uintptr_t)run_addr % HUGEPAGE_SIZE_2MB == 0);
+
+                // The hugepages of the run are contiguous
+                memset(run_addr, 0, HUGEPAGE_SIZE_2MB * 3);
+
+                hugepage_cache_push_run(run_addr, 3);
+
+                REQUIRE(queue_mpmc_get_length(hugepage_cache_per_numa_node[numa_node_index].free_queue) == 0);
+                REQUIRE(queue_mpmc_get_length(
+                        hugepage_cache_per_numa_node[numa_node_index].free_runs_queues[3 - 1]) == 1);
+                REQUIRE(hugepage_cache_per_numa_node[numa_node_index].free_runs_hugepages_count == 3);
+                REQUIRE(hugepage_cache_pop_run(3) == run_addr);
+                REQUIRE(hugepage_cache_per_numa_node[numa_node_index].free_runs_hugepages_count == 0);
+
+                hugepage_cache_push_run(run_addr, 3);
+            }
+
+            SECTION("push a run of three hugepages over the budget") {
+                void* run_addr = hugepage_cache_pop_run(3);
+                REQUIRE(run_addr != nullptr);
+
+                hugepage_cache_per_numa_node[numa_node_index].free_runs_hugepages_count =
+                        HUGEPAGE_CACHE_RUNS_HUGEPAGES_COUNT_BUDGET - 1;
+
+                // The run is unmapped and not cached
+                hugepage_cache_push_run(run_addr, 3);
+
+                REQUIRE(queue_mpmc_get_length(
+                        hugepage_cache_per_numa_node[numa_node_index].free_runs_queues[3 - 1]) == 0);
+                REQUIRE(hugepage_cache_per_numa_node[numa_node_index].free_runs_hugepages_count ==
+                        HUGEPAGE_CACHE_RUNS_HUGEPAGES_COUNT_BUDGET - 1);
+            }
+
+            hugepage_cache_free();
+        }
     } else {
         WARN("Can't test fast fixed memory allocator, hugepages not enabled or not enough hugepages for testing, at least 128 2mb hugepages are required");
     }
@@ -18,6 +18,29 @@ TEST_CASE("thread.c", "[thread]") {
         REQUIRE(thread_current_get_id() == syscall(SYS_gettid));
     }
 
+    SECTION("thread_get_logical_core_index") {
+        uint32_t cpus_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+        SECTION("with selected cpus") {
+            uint16_t selected_cpus[] = { 3, 1 };
+            thread_affinity_set_selected_cpus(selected_cpus, 2);
+
+            REQUIRE(thread_get_logical_core_index(0) == 1);
+            REQUIRE(thread_get_logical_core_index(1) == 3);
+            REQUIRE(thread_get_logical_core_index(2) == 1);
+
+            thread_affinity_set_selected_cpus(NULL, 0);
+        }
+
+        SECTION("without selected cpus") {
+            thread_affinity_set_selected_cpus(NULL, 0);
+
+            REQUIRE(thread_get_logical_core_index(0) == 0);
+            REQUIRE(thread_get_logical_core_index(cpus_count) == 0);
+            REQUIRE(thread_get_logical_core_index(cpus_count + 1) == 1 % cpus_count);
+        }
+    }
+
     SECTION("thread_current_set_affinity") {
         uint32_t cpus_count = sysconf(_SC_NPROCESSORS_ONLN);
 
@@ -33,6 +33,22 @@
 #include "worker/worker_context.h"
 #include "worker/worker.h"
 
+char test_transaction_fiber_name[] = "test-fiber";
+transaction_t test_transaction_parent_transaction = { 0 };
+transaction_t test_transaction_child_transaction = { 0 };
+
+void test_transaction_parent_transaction_fiber_entrypoint(fiber_t *from, fiber_t *to) {
+    transaction_set_parent_transaction(&test_transaction_parent_transaction);
+
+    // The other fibers run while this one is yielding, they must not see the parent transaction
+    fiber_scheduler_yield();
+
+    transaction_acquire(&test_transaction_child_transaction);
+    transaction_set_parent_transaction(NULL);
+
+    fiber_scheduler_switch_back();
+}
+
 TEST_CASE("transaction.c", "[transaction]") {
     worker_context_t worker_context = { 0 };
     worker_context.worker_index = UINT16_MAX;
@@ -167,6 +183,58 @@ TEST_CASE("transaction.c", "[transaction]") {
         }
     }
 
+    SECTION("transaction_set_parent_transaction") {
+        SECTION("Outside of a fiber") {
+            transaction_t parent_transaction = { 0 };
+            transaction_t child_transaction = { 0 };
+
+            REQUIRE(transaction_acquire(&parent_transaction));
+            transaction_set_parent_transaction(&parent_transaction);
+            REQUIRE(transaction_get_parent_transaction() == &parent_transaction);
+
+            REQUIRE(transaction_acquire(&child_transaction));
+            REQUIRE(child_transaction.transaction_id.id == parent_transaction.transaction_id.id);
+
+            transaction_set_parent_transaction(NULL);
+            REQUIRE(transaction_get_parent_transaction() == nullptr);
+
+            ffma_mem_free(parent_transaction.locks.list);
+            ffma_mem_free(child_transaction.locks.list);
+        }
+
+        SECTION("Kept per fiber") {
+            transaction_t other_transaction = { 0 };
+
+            REQUIRE(transaction_acquire(&test_transaction_parent_transaction));
+
+            fiber_t *fiber = fiber_new(
+                    test_transaction_fiber_name,
+                    sizeof(test_transaction_fiber_name),
+                    getpagesize() * 8,
+                    test_transaction_parent_transaction_fiber_entrypoint,
+                    NULL);
+            fiber_scheduler_switch_to(fiber);
+
+            REQUIRE(fiber_scheduler_has_ready_fibers());
+            REQUIRE(transaction_get_parent_transaction() == nullptr);
+
+            REQUIRE(transaction_acquire(&other_transaction));
+            REQUIRE(other_transaction.transaction_id.id != test_transaction_parent_transaction.transaction_id.id);
+
+            fiber_scheduler_resume_ready_fibers();
+
+            REQUIRE(test_transaction_child_transaction.transaction_id.id ==
+                test_transaction_parent_transaction.transaction_id.id);
+
+            fiber_free(fiber);
+            fiber_scheduler_free();
+
+            ffma_mem_free(test_transaction_parent_transaction.locks.list);
+            ffma_mem_free(test_transaction_child_transaction.locks.list);
+            ffma_mem_free(other_transaction.locks.list);
+        }
+    }
+
     SECTION("transaction_release") {
         transaction_t transaction = { 0 };
         REQUIRE(transaction_acquire(&transaction));
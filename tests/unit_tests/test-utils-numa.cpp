@@ -10,6 +10,7 @@
 
 #include <unistd.h>
 #include <numa.h>
+#include <numaif.h>
 
 #include "utils_numa.h"
 
@@ -43,4 +44,24 @@ TEST_CASE("utils_numa.c", "[utils_numa]") {
 
         REQUIRE(utils_numa_cpu_current_index() == cpu_index);
     }
+
+    SECTION("utils_numa_node_index_by_cpu") {
+        uint32_t cpu_index, numa_node_index;
+        getcpu(&cpu_index, &numa_node_index);
+
+        REQUIRE(utils_numa_node_index_by_cpu(cpu_index) == numa_node_index);
+    }
+
+    SECTION("utils_numa_node_index_by_memptr") {
+        int numa_node_index = 0;
+        volatile char memory[64] = { 0 };
+        memory[0] = 1;
+
+        if (numa_available() != -1) {
+            REQUIRE(get_mempolicy(
+                    &numa_node_index, NULL, 0, (void*)memory, MPOL_F_NODE | MPOL_F_ADDR) == 0);
+        }
+
+        REQUIRE(utils_numa_node_index_by_memptr((void*)memory) == (uint32_t)numa_node_index);
+    }
 }
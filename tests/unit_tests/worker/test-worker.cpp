@@ -193,7 +193,8 @@ TEST_CASE("worker/worker.c", "[worker][worker]") {
                 1,
                 &terminate_event_loop,
                 &config,
-                &storage_db);
+                &storage_db,
+                nullptr);
 
         REQUIRE(worker_user_data.workers_count == 1);
         REQUIRE(worker_user_data.worker_index == 1);
@@ -7,6 +7,9 @@ import logging
 
 
 class Program:
+    _WRITE_KEY_ACCESS_FLAGS = ["READ_WRITE", "WRITE_ONLY", "DELETE"]
+    _KEYLESS_WRITE_COMMANDS = ["FLUSHDB", "EVAL", "EVALSHA", "SCRIPT"]
+
     def __init__(
             self):
         self._setup_argument_parser()
@@ -428,6 +431,21 @@ class Program:
 
             self._write_header_footer(fp, "CACHEGRAND_MODULE_REDIS_AUTOGENERATED_COMMANDS_ARGUMENTS_H")
 
+    def _command_is_write(
+            self,
+            command_info: dict) -> bool:
+        # The commands changing the data without having keys (or without declaring them) can't be identified using the
+        # key specs
+        if command_info["command_string"] in self._KEYLESS_WRITE_COMMANDS:
+            return True
+
+        for key_spec in command_info["key_specs"]:
+            for key_access_flag in key_spec["key_access_flags"]:
+                if key_access_flag in self._WRITE_KEY_ACCESS_FLAGS:
+                    return True
+
+        return False
+
     def _generate_commands_module_redis_autogenerated_commands_info_map_h_header(
             self,
             commands_info: list):
@@ -446,14 +464,16 @@ class Program:
                     "{command_callback_name}, "
                     "{required_arguments_count}, "
                     "{has_variable_arguments}, "
-                    "{arguments_count}" 
+                    "{arguments_count}, "
+                    "{is_write}"
                     "),".format(
                         command_callback_name_uppercase=command_info["command_callback_name"].upper(),
                         command_string=command_info["command_string"].lower(),
                         command_callback_name=command_info["command_callback_name"],
                         required_arguments_count=command_info["required_arguments_count"],
                         has_variable_arguments="true" if command_info["has_variable_arguments"] else "false",
-                        arguments_count=len(command_info["arguments"])),
+                        arguments_count=len(command_info["arguments"]),
+                        is_write="true" if self._command_is_write(command_info) else "false"),
                     "\n",
                 ])
 